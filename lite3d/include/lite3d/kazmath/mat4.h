@@ -59,6 +59,8 @@ LITE3D_CEXPORT int kmMat4IsIdentity(const kmMat4* pIn);
 
 LITE3D_CEXPORT kmMat4* kmMat4Transpose(kmMat4* pOut, const kmMat4* pIn);
 LITE3D_CEXPORT kmMat4* kmMat4Multiply(kmMat4* pOut, const kmMat4* pM1, const kmMat4* pM2);
+/* pOut[i] = pM1[i] * pM2[i], SSE if available, pOut may alias pM1 or pM2 */
+LITE3D_CEXPORT kmMat4* kmMat4MultiplyArray(kmMat4* pOut, const kmMat4* pM1, const kmMat4* pM2, size_t count);
 
 LITE3D_CEXPORT kmMat4* kmMat4Assign(kmMat4* pOut, const kmMat4* pIn);
 LITE3D_CEXPORT kmMat4* kmMat4AssignMat3(kmMat4* pOut, const struct kmMat3* pIn);
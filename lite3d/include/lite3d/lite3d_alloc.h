@@ -48,19 +48,62 @@
 #define LITE3D_POOL_NO3             0x03
 #define LITE3D_POOL_NO4             0x04
 #define LITE3D_POOL_NO5             0x05
+/* Memory statistic slot for lite3d_malloc/lite3d_calloc, not a real pool */
+#define LITE3D_POOL_HEAP            LITE3D_POOL_MAX
+
+/* Allocations are accounted to the current thread tag, see lite3d_memory_set_tag */
+#define LITE3D_MEMORY_TAG_MAX       16
+#define LITE3D_MEMORY_TAG_DEFAULT   0
+
+/* Frame arena blocks are aligned to this boundary */
+#define LITE3D_FRAME_ARENA_ALIGN    16
+#define LITE3D_FRAME_ARENA_BLOCK    (64 * 1024)
 
 typedef void *(*lite3d_mallocf)(size_t size);
 typedef void (*lite3d_freef)(void *);
+typedef void *(*lite3d_reallocf)(void *p, size_t size);
 typedef struct lite3d_alloca_f
 {
     lite3d_mallocf mallocf;
     lite3d_freef freef;
+    /* Optional, lite3d_realloc returns NULL if not set */
+    lite3d_reallocf reallocf;
 } lite3d_alloca_f;
 
+typedef struct lite3d_frame_arena_stats
+{
+    /* frames counted by lite3d_frame_arena_next */
+    int32_t frameNo;
+    /* bytes allocated by all threads in the current frame */
+    size_t frameBytes;
+    /* bytes allocated by all threads in the previous frame */
+    size_t lastFrameBytes;
+    /* max bytes allocated in a single frame */
+    size_t highWaterBytes;
+    /* memory held by all arenas */
+    size_t reservedBytes;
+    /* blocks requested by arenas from the heap, stays constant in steady state */
+    int32_t heapAllocations;
+} lite3d_frame_arena_stats;
+
+typedef struct lite3d_memory_stats
+{
+    /* bytes requested by live allocations */
+    size_t usedBytes;
+    size_t peakBytes;
+    /* memory taken by the pool from the system, zero for the heap and tags */
+    size_t reservedBytes;
+    uint64_t allocations;
+    uint64_t frees;
+    /* allocations done during the previous frame */
+    uint32_t frameAllocations;
+} lite3d_memory_stats;
+
 
 LITE3D_CEXPORT void lite3d_set_allocator(lite3d_alloca_f *alloca);
 LITE3D_CEXPORT void *lite3d_malloc(size_t size);
 LITE3D_CEXPORT void *lite3d_calloc(size_t size);
+LITE3D_CEXPORT void *lite3d_realloc(void *p, size_t size);
 LITE3D_CEXPORT void lite3d_free(void *p);
 
 LITE3D_CEXPORT void *lite3d_malloc_pooled(uint8_t pollNo, size_t size);
@@ -72,5 +115,40 @@ LITE3D_CEXPORT void lite3d_memory_cleanup(void);
 
 LITE3D_CEXPORT char *lite3d_strdup(const char *str);
 
+/* Memory statistic, available if built with LITE3D_WITH_MEMORY_STATS, 
+ * otherwise getters return LITE3D_FALSE and the rest are noop */
+LITE3D_CEXPORT int lite3d_memory_get_pool_stats(uint8_t poolNo, lite3d_memory_stats *stats);
+LITE3D_CEXPORT int lite3d_memory_get_tag_stats(uint8_t tag, lite3d_memory_stats *stats);
+/* Returns previous tag of the current thread */
+LITE3D_CEXPORT uint8_t lite3d_memory_set_tag(uint8_t tag);
+/* Keep live allocations with call sites, leaks are reported by lite3d_memory_cleanup */
+LITE3D_CEXPORT void lite3d_memory_track_leaks(int enable);
+/* Frame boundary, called by the render loop */
+LITE3D_CEXPORT void lite3d_memory_stats_frame(void);
+LITE3D_CEXPORT void lite3d_memory_stats_write_to_log(void);
+
+#ifdef LITE3D_WITH_MEMORY_STATS
+LITE3D_CEXPORT void *lite3d_malloc_track(size_t size, const char *file, int line);
+LITE3D_CEXPORT void *lite3d_calloc_track(size_t size, const char *file, int line);
+LITE3D_CEXPORT void *lite3d_malloc_pooled_track(uint8_t pollNo, size_t size, const char *file, int line);
+LITE3D_CEXPORT void *lite3d_calloc_pooled_track(uint8_t pollNo, size_t size, const char *file, int line);
+
+/* Capture call sites everywhere except the allocator itself */
+#ifndef LITE3D_ALLOC_IMPLEMENTATION
+#define lite3d_malloc(size)                 lite3d_malloc_track(size, __FILE__, __LINE__)
+#define lite3d_calloc(size)                 lite3d_calloc_track(size, __FILE__, __LINE__)
+#define lite3d_malloc_pooled(pollNo, size)  lite3d_malloc_pooled_track(pollNo, size, __FILE__, __LINE__)
+#define lite3d_calloc_pooled(pollNo, size)  lite3d_calloc_pooled_track(pollNo, size, __FILE__, __LINE__)
+#endif
+#endif
+
+/* Per-thread linear allocator for transient data. Memory is never freed explicitly,  
+ * it remains valid during the current and the next frame and is reused after that. */
+LITE3D_CEXPORT void *lite3d_frame_alloc(size_t size);
+LITE3D_CEXPORT void *lite3d_frame_calloc(size_t size);
+/* Frame boundary, called by the render loop */
+LITE3D_CEXPORT void lite3d_frame_arena_next(void);
+LITE3D_CEXPORT void lite3d_frame_arena_get_stats(lite3d_frame_arena_stats *stats);
+
 #endif	/* ALLOC_H */
 
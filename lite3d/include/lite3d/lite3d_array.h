@@ -37,14 +37,32 @@ typedef struct lite3d_array
     size_t size;
     size_t elemSize;
     size_t capacity;
+    /* Small buffer supplied by owner, never freed, used while elements fit in */
+    void *inlineData;
+    size_t inlineCapacity;
+    /* Storage taken from the frame arena, never freed */
+    uint8_t frameData;
 } lite3d_array;
 
 typedef int (*lite3d_array_compare_t)(const void*, const void*);
 
 LITE3D_CEXPORT void lite3d_array_init(lite3d_array *a, size_t elemSize, size_t capacity);
+/* Init array over external storage, heap is used only when capacity is exceeded */
+LITE3D_CEXPORT void lite3d_array_init_inline(lite3d_array *a, size_t elemSize, void *storage, size_t capacity);
+/* Init array over the frame arena, elements stay valid until the end of the next frame. 
+ * Array must be initialized again every frame, purge does not free anything */
+LITE3D_CEXPORT int lite3d_array_init_frame(lite3d_array *a, size_t elemSize, size_t capacity);
+/* Drop all elements but keep allocated memory */
 LITE3D_CEXPORT void lite3d_array_clean(lite3d_array *a);
 LITE3D_CEXPORT void lite3d_array_purge(lite3d_array *a);
+/* Make sure the array can hold at least capacity elements without reallocation */
+LITE3D_CEXPORT int lite3d_array_reserve(lite3d_array *a, size_t capacity);
+/* Release unused memory, returns to inline storage if elements fit in */
+LITE3D_CEXPORT int lite3d_array_shrink(lite3d_array *a);
 LITE3D_CEXPORT void *lite3d_array_add(lite3d_array *a);
+/* Append count elements at once, if data is NULL the new elements are left uninitialized, 
+ * returns pointer to the first appended element */
+LITE3D_CEXPORT void *lite3d_array_append(lite3d_array *a, const void *data, size_t count);
 LITE3D_CEXPORT void *lite3d_array_get(lite3d_array *a, size_t index);
 LITE3D_CEXPORT void lite3d_array_remove(lite3d_array *a, size_t index);
 LITE3D_CEXPORT void lite3d_array_qsort(lite3d_array *a, lite3d_array_compare_t comparator);
@@ -94,6 +94,9 @@ LITE3D_CEXPORT void lite3d_camera_move(lite3d_camera *camera, const kmVec3 *valu
 LITE3D_CEXPORT void lite3d_camera_move_relative(lite3d_camera *camera, const kmVec3 *value);
 /* point задан в мировой системе координат */
 LITE3D_CEXPORT float lite3d_camera_distance(const lite3d_camera *camera, const kmVec3 *point);
+/* Радиус проекции сферы (center в мировой системе координат) в долях высоты экрана, 
+ * FLT_MAX если камера внутри сферы */
+LITE3D_CEXPORT float lite3d_camera_projected_radius(const lite3d_camera *camera, const kmVec3 *center, float radius);
 /* Получение позиции и вращения в мировой системе координат */
 LITE3D_CEXPORT void lite3d_camera_world_position(const lite3d_camera *camera, kmVec3 *pos);
 LITE3D_CEXPORT void lite3d_camera_world_rotation(const lite3d_camera *camera, kmQuaternion *q);
@@ -0,0 +1,90 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef LITE3D_GL_STATE_H
+#define	LITE3D_GL_STATE_H
+
+#include <lite3d/lite3d_common.h>
+#include <lite3d/lite3d_array.h>
+
+/*
+ * Shadow copy of GL bindings and uniform values, calls which do not
+ * change GL state are filtered before they reach the driver.
+ */
+
+#define LITE3D_GL_STATE_TEXTURE_UNITS_MAX       96
+#define LITE3D_GL_STATE_BUFFER_BINDINGS_MAX     96
+/* uniforms with bigger location are not cached */
+#define LITE3D_GL_STATE_UNIFORM_LOCATION_MAX    1024
+#define LITE3D_GL_STATE_UNIFORM_VALUE_MAX       64
+
+#define LITE3D_GL_STATE_BUFFER_UNIFORM          0x0
+#define LITE3D_GL_STATE_BUFFER_STORAGE          0x1
+
+/* GL calls issued by the state cache, could be replaced to record calls in tests */
+typedef struct lite3d_gl_state_backend
+{
+    void (*activeTexture)(uint32_t unit);
+    void (*bindTexture)(uint32_t target, uint32_t textureID);
+    void (*bindBufferBase)(uint8_t kind, uint32_t index, uint32_t bufferID);
+} lite3d_gl_state_backend;
+
+typedef struct lite3d_gl_state_stats
+{
+    int32_t textureBinds;
+    int32_t textureBindsAvoided;
+    int32_t bufferBinds;
+    int32_t bufferBindsAvoided;
+    int32_t uniforms;
+    int32_t uniformsAvoided;
+    int32_t stateChanges;
+    int32_t stateChangesAvoided;
+} lite3d_gl_state_stats;
+
+/* last value sent to uniform location of a program, zero size means unknown */
+typedef struct lite3d_gl_uniform_value
+{
+    uint8_t size;
+    uint8_t value[LITE3D_GL_STATE_UNIFORM_VALUE_MAX];
+} lite3d_gl_uniform_value;
+
+/* NULL restores GL backend, shadow state is invalidated */
+LITE3D_CEXPORT void lite3d_gl_state_set_backend(const lite3d_gl_state_backend *backend);
+/* Forget everything, use after GL state was changed bypassing the cache */
+LITE3D_CEXPORT void lite3d_gl_state_invalidate(void);
+
+LITE3D_CEXPORT void lite3d_gl_state_bind_texture(uint16_t unit, uint32_t target, uint32_t textureID);
+/* Bind texture to currently active unit, e.g. to upload data */
+LITE3D_CEXPORT void lite3d_gl_state_bind_texture_active(uint32_t target, uint32_t textureID);
+LITE3D_CEXPORT void lite3d_gl_state_bind_buffer_base(uint8_t kind, uint32_t index, uint32_t bufferID);
+/* Object is deleted, GL resets its bindings, id may be reused by new object */
+LITE3D_CEXPORT void lite3d_gl_state_forget_texture(uint32_t textureID);
+LITE3D_CEXPORT void lite3d_gl_state_forget_buffer(uint32_t bufferID);
+
+/*
+ * Returns true if value must be sent to location, cache is array of lite3d_gl_uniform_value
+ * owned by the program. Cache must be cleaned when program is relinked.
+ */
+LITE3D_CEXPORT int lite3d_gl_state_uniform_changed(lite3d_array *cache, int32_t location,
+    const void *value, size_t size);
+/* Account fixed function state switch done or avoided by caller */
+LITE3D_CEXPORT void lite3d_gl_state_count_state(uint8_t applied);
+
+LITE3D_CEXPORT void lite3d_gl_state_get_stats(lite3d_gl_state_stats *stats);
+LITE3D_CEXPORT void lite3d_gl_state_stats_reset(void);
+
+#endif	/* LITE3D_GL_STATE_H */
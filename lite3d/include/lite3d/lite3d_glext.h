@@ -53,6 +53,7 @@ int lite3d_check_bindless_texture(void);
 int lite3d_check_shader_draw_parameters(void);
 int lite3d_check_multi_draw_indirect(void);
 int lite3d_check_compute_shader(void);
+int lite3d_check_copy_image(void);
 
 /* stub functions */
 void glTexSubImage3D_stub(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels);
@@ -90,6 +91,7 @@ GLsync glFenceSync_stub(GLenum condition, GLbitfield flags);
 GLenum glClientWaitSync_stub(GLsync sync, GLbitfield flags, GLuint64 timeout);
 void glDeleteSync_stub(GLsync sync);
 void glGetIntegeri_v_stub(GLenum target, GLuint index, GLint *data);
+void glCopyImageSubData_stub(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
 
 #ifdef GLES
 
@@ -535,4 +537,8 @@ extern PFNGLMULTIDRAWELEMENTSINDIRECTEXTPROC glMultiDrawElementsIndirectPtr;
 #   define glGetIntegeri_v glGetIntegeri_v_stub
 #endif
 
+#if defined(WITH_GLES2) || defined(WITH_GLES3) || defined(WITH_GLES31)
+#   define glCopyImageSubData glCopyImageSubData_stub
+#endif
+
 #endif
@@ -24,8 +24,32 @@
 #define LITE3D_LOGLEVEL_INFO            0x2
 #define LITE3D_LOGLEVEL_VERBOSE         0x3
 
+/* what producer does when async queue is full */
+#define LITE3D_LOG_OVERFLOW_DROP        0x0
+#define LITE3D_LOG_OVERFLOW_BLOCK       0x1
+
+/* every queue slot holds a whole formatted line, SDL_MAX_LOG_MESSAGE bytes of message */
+#define LITE3D_LOG_QUEUE_DEFAULT        256
+
+typedef struct lite3d_logger_stats
+{
+    int32_t queued;
+    int32_t written;
+    int32_t dropped;
+    /* producer waited for free slot */
+    int32_t blocked;
+} lite3d_logger_stats;
+
 LITE3D_CEXPORT void lite3d_logger_setup(const char *logfile);
 LITE3D_CEXPORT void lite3d_logger_set_logParams(int level, int flushAlways, int muteStd);
+/* 
+ * Messages are queued to MPSC ring and written by background thread.
+ * queueSize is rounded up to power of two, zero means default.
+ */
+LITE3D_CEXPORT int lite3d_logger_start_async(uint32_t queueSize, int overflowPolicy);
+/* Wait until all messages logged before the call are written */
+LITE3D_CEXPORT void lite3d_logger_flush(void);
+LITE3D_CEXPORT void lite3d_logger_get_stats(lite3d_logger_stats *stats);
 LITE3D_CEXPORT void lite3d_logger_release(void);
 
 #endif	/* LOGGER_H */
@@ -0,0 +1,62 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef LITE3D_LUMINANCE_H
+#define	LITE3D_LUMINANCE_H
+
+#include <lite3d/lite3d_common.h>
+
+/*
+ * Log2 luminance histogram of HDR images for auto exposure. Pixels are
+ * binned with SSE2 where available, average is taken over the part of
+ * histogram between two percentiles, so few bright pixels do not move it.
+ */
+
+#define LITE3D_LUMINANCE_BINS               64
+#define LITE3D_LUMINANCE_LOG2_MIN_DEFAULT   -10.0f
+#define LITE3D_LUMINANCE_LOG2_MAX_DEFAULT   10.0f
+
+#define LITE3D_LUMINANCE_RGB_FLOAT          0x1
+#define LITE3D_LUMINANCE_RGBA_FLOAT         0x2
+#define LITE3D_LUMINANCE_RGB_HALF           0x3
+#define LITE3D_LUMINANCE_RGBA_HALF          0x4
+
+typedef struct lite3d_luminance_histogram
+{
+    uint32_t bins[LITE3D_LUMINANCE_BINS];
+    uint32_t count;
+    /* log2 luminance range, values outside are clamped to the first/last bin */
+    float log2Min;
+    float log2Max;
+} lite3d_luminance_histogram;
+
+LITE3D_CEXPORT void lite3d_luminance_histogram_init(lite3d_luminance_histogram *histogram,
+    float log2Min, float log2Max);
+/* replace histogram content by luminance of texels */
+LITE3D_CEXPORT int lite3d_luminance_histogram_build(lite3d_luminance_histogram *histogram,
+    const void *pixels, size_t texels, uint8_t format);
+/*
+ * Geometric mean luminance of texels between low and high percentiles (0..1),
+ * returns zero for empty histogram.
+ */
+LITE3D_CEXPORT float lite3d_luminance_histogram_average(const lite3d_luminance_histogram *histogram,
+    float lowPercentile, float highPercentile);
+/* move current luminance towards target, speed depends on direction, dt in seconds */
+LITE3D_CEXPORT float lite3d_luminance_adapt(float current, float target, float dt,
+    float speedUp, float speedDown);
+
+#endif	/* LITE3D_LUMINANCE_H */
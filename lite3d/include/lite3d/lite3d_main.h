@@ -47,6 +47,10 @@ typedef struct lite3d_global_settings
     int logLevel;
     int logFlushAlways;
     int logMuteStd;
+    /* write log by background thread */
+    int logAsync;
+    uint32_t logQueueSize;
+    int logOverflowPolicy;
     char logFile[50];
 } lite3d_global_settings;
 
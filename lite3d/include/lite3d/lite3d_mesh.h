@@ -24,6 +24,7 @@
 #include <lite3d/lite3d_vbo.h>
 #include <lite3d/lite3d_vao.h>
 #include <lite3d/lite3d_frustum.h>
+#include <lite3d/lite3d_range_alloc.h>
 
 #define LITE3D_INDEX_UNSIGNED_BYTE  0x1401
 #define LITE3D_INDEX_UNSIGNED_SHORT 0x1403
@@ -44,9 +45,39 @@ typedef struct lite3d_mesh
     uint32_t elementsCount;
     lite3d_list chunks;
     lite3d_array drawQueue;
+    /* chunks placement in vertex and index buffers */
+    lite3d_range_allocator vertexRanges;
+    lite3d_range_allocator indexRanges;
+    /* chunk placed lowest in vertex buffer, bound for multidraw, base vertex is counted from it */
+    struct lite3d_mesh_chunk *baseChunk;
     void *userdata;
 } lite3d_mesh;
 
+/* Part of chunk drawn as a whole, its indexes are contiguous in chunk index range */
+typedef struct lite3d_mesh_cluster
+{
+    /* first index and indexes count relative to chunk indexes */
+    uint32_t indexesOffset;
+    uint32_t indexesCount;
+    /* bounding sphere in model space */
+    kmVec3 center;
+    float radius;
+    /* normal cone, cluster is backfacing when dot(normalize(coneApex - eye), coneAxis) >= coneCutoff */
+    kmVec3 coneApex;
+    kmVec3 coneAxis;
+    float coneCutoff;
+} lite3d_mesh_cluster;
+
+/* Simplified level of chunk, its indexes follow chunk indexes and refer the same vertices */
+typedef struct lite3d_mesh_lod
+{
+    /* first index and indexes count relative to chunk indexes */
+    uint32_t indexesOffset;
+    uint32_t indexesCount;
+    /* model space deviation from full detail chunk, largest distance of its vertices to level */
+    float error;
+} lite3d_mesh_lod;
+
 typedef struct lite3d_mesh_chunk
 {
     lite3d_list_node link;
@@ -57,6 +88,12 @@ typedef struct lite3d_mesh_chunk
     uint32_t materialIndex;
     uint8_t hasIndexes;
     lite3d_bounding_vol boundingVol;
+    /* optional, loaded from .m cluster section */
+    lite3d_mesh_cluster *clusters;
+    uint32_t clustersCount;
+    /* optional, loaded from .m lod section, levels from 1 ordered by growing error */
+    lite3d_mesh_lod *lods;
+    uint32_t lodsCount;
     lite3d_mesh *mesh;
 } lite3d_mesh_chunk;
 
@@ -65,6 +102,20 @@ LITE3D_CEXPORT int lite3d_mesh_init(struct lite3d_mesh *mesh, uint16_t usage);
 LITE3D_CEXPORT void lite3d_mesh_purge(struct lite3d_mesh *mesh);
 LITE3D_CEXPORT int lite3d_mesh_extend(struct lite3d_mesh *mesh, 
     size_t verticesSize, size_t indexesSize);
+/* 
+ * Find place for new chunk data, buffers grow at least twice when there is no free range,
+ * vertices offset is aligned to the stride so the chunk can be drawn with base vertex.
+ */
+LITE3D_CEXPORT int lite3d_mesh_alloc_chunk_space(struct lite3d_mesh *mesh,
+    size_t verticesSize, uint32_t stride, size_t indexesSize,
+    size_t *verticesOffset, size_t *indexesOffset);
+/* Buffers content was replaced, first bytes are used by chunks */
+LITE3D_CEXPORT void lite3d_mesh_reset_chunk_space(struct lite3d_mesh *mesh,
+    size_t verticesUsed, size_t indexesUsed);
+/* Remove chunk and release its space in buffers for reuse */
+LITE3D_CEXPORT void lite3d_mesh_chunk_remove(struct lite3d_mesh_chunk *meshChunk);
+/* Move chunks data to the start of buffers in list order, free space becomes single range at the end */
+LITE3D_CEXPORT int lite3d_mesh_compact(struct lite3d_mesh *mesh);
 
 LITE3D_CEXPORT lite3d_mesh_chunk *lite3d_mesh_append_chunk(struct lite3d_mesh *mesh,
     const struct lite3d_vao_layout *layout,
@@ -82,6 +133,9 @@ LITE3D_CEXPORT void lite3d_mesh_chunk_purge(struct lite3d_mesh_chunk *meshChunk)
 LITE3D_CEXPORT void lite3d_mesh_chunk_bind(struct lite3d_mesh_chunk *meshChunk);
 LITE3D_CEXPORT void lite3d_mesh_chunk_draw(struct lite3d_mesh_chunk *meshChunk);
 LITE3D_CEXPORT void lite3d_mesh_chunk_draw_instanced(struct lite3d_mesh_chunk *meshChunk, uint32_t instancesCount);
+/* Draw part of chunk indexes, offset is relative to chunk, instancesCount 1 draws without instancing */
+LITE3D_CEXPORT void lite3d_mesh_chunk_draw_range(struct lite3d_mesh_chunk *meshChunk, 
+    uint32_t indexesOffset, uint32_t indexesCount, uint32_t instancesCount);
 LITE3D_CEXPORT void lite3d_mesh_chunk_unbind(void);
 LITE3D_CEXPORT lite3d_mesh_chunk *lite3d_mesh_chunk_get_by_material_index(struct lite3d_mesh *mesh, 
     uint32_t materialIndex);
@@ -95,6 +149,9 @@ LITE3D_CEXPORT void lite3d_mesh_queue_draw(struct lite3d_mesh *mesh);
 //
 LITE3D_CEXPORT void lite3d_mesh_queue_chunk(struct lite3d_mesh_chunk *meshChunk);
 LITE3D_CEXPORT void lite3d_mesh_queue_chunk_add_instance(struct lite3d_mesh_chunk *meshChunk);
+// Добавление части индексов чанка, смещение задано в индексах относительно начала чанка
+LITE3D_CEXPORT void lite3d_mesh_queue_chunk_range(struct lite3d_mesh_chunk *meshChunk, 
+    uint32_t indexesOffset, uint32_t indexesCount);
 // Очистка буфера команд для рисования 
 LITE3D_CEXPORT void lite3d_mesh_queue_clean(struct lite3d_mesh *mesh);
 
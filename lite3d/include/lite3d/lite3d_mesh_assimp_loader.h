@@ -71,6 +71,29 @@ LITE3D_CEXPORT int lite3d_assimp_mesh_load(lite3d_mesh *mesh, const lite3d_file
 LITE3D_CEXPORT int lite3d_assimp_mesh_load_recursive(const lite3d_file *resource, 
     lite3d_assimp_loader_ctx ctx, uint32_t flags);
 
+struct aiScene;
+
+/*
+    note:
+        import and postprocess scene from memory, touches no GL state and 
+        may be called from any thread, result must be released by 
+        lite3d_assimp_scene_release
+*/
+LITE3D_CEXPORT const struct aiScene *lite3d_assimp_scene_import(const void *data, size_t size, 
+    const char *name, uint32_t flags);
+
+/*
+    note:
+        recursive load all meshes from imported *scene*, meshes are created 
+        in GL buffers, so call it from the render thread
+*/
+LITE3D_CEXPORT int lite3d_assimp_scene_load_recursive(const struct aiScene *scene, 
+    lite3d_assimp_loader_ctx ctx);
+LITE3D_CEXPORT void lite3d_assimp_scene_release(const struct aiScene *scene);
+
+/* extension with leading dot, for example ".fbx" */
+LITE3D_CEXPORT int lite3d_assimp_extension_supported(const char *extension);
+
 LITE3D_CEXPORT void lite3d_assimp_logging_init(void);
 LITE3D_CEXPORT void lite3d_assimp_logging_level(int8_t level);
 LITE3D_CEXPORT void lite3d_assimp_logging_release(void);
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef LITE3D_MESH_CLUSTER_H
+#define	LITE3D_MESH_CLUSTER_H
+
+#include <lite3d/lite3d_common.h>
+#include <lite3d/lite3d_array.h>
+#include <lite3d/lite3d_mesh.h>
+
+/* Defaults fit mesh shader limits: 64 vertices and 124 triangles (372 indexes) per cluster */
+#define LITE3D_CLUSTER_MAX_VERTICES     64
+#define LITE3D_CLUSTER_MAX_TRIANGLES    124
+#define LITE3D_CLUSTER_VERTICES_LIMIT   256
+
+/* Continuous range of chunk indexes to draw, offset is relative to chunk */
+typedef struct lite3d_mesh_index_range
+{
+    uint32_t indexesOffset;
+    uint32_t indexesCount;
+} lite3d_mesh_index_range;
+
+/* Returns LITE3D_FALSE if world space sphere is fully occluded */
+typedef int (*lite3d_mesh_cluster_occlusion_test)(const kmVec3 *center, float radius, void *userdata);
+
+typedef struct lite3d_mesh_cluster_cull_params
+{
+    /* world space frustum, NULL - no frustum test */
+    const lite3d_frustum *frustum;
+    /* model to world matrix, NULL - identity */
+    const kmMat4 *worldMatrix;
+    /* world space eye position, NULL - no backface cone test */
+    const kmVec3 *eyePosition;
+    /* NULL - no occlusion test */
+    lite3d_mesh_cluster_occlusion_test occlusionTest;
+    void *userdata;
+} lite3d_mesh_cluster_cull_params;
+
+typedef struct lite3d_mesh_cluster_cull_stats
+{
+    uint32_t clustersTested;
+    uint32_t frustumCulled;
+    uint32_t backfaceCulled;
+    uint32_t occlusionCulled;
+    uint32_t rangesCount;
+    uint32_t indexesVisible;
+} lite3d_mesh_cluster_cull_stats;
+
+/*
+ * Splits triangle list to clusters of at most maxVertices unique vertices and maxTriangles triangles,
+ * clusters grow over shared vertices so they stay compact. Indexes are reordered in place so that
+ * triangles of each cluster are contiguous, lite3d_mesh_cluster elements are appended to clusters.
+ * positions points to position of the first vertex, stride is distance between vertices in bytes.
+ */
+LITE3D_CEXPORT int lite3d_mesh_clusters_build(const void *positions, uint32_t stride, uint32_t verticesCount,
+    uint32_t *indexes, uint32_t indexesCount, uint32_t maxVertices, uint32_t maxTriangles, lite3d_array *clusters);
+
+/* Bounding sphere and normal cone of triangles indexes[0..indexesCount) */
+LITE3D_CEXPORT void lite3d_mesh_cluster_compute_bounds(lite3d_mesh_cluster *cluster, const void *positions,
+    uint32_t stride, const uint32_t *indexes, uint32_t indexesCount);
+
+/*
+ * Conservative culling: cluster is rejected only if it is out of frustum, all its triangles face 
+ * away from the eye or the occlusion test rejects it. Visible clusters adjacent in index buffer are 
+ * merged, resulting lite3d_mesh_index_range elements are appended to ranges. 
+ * Returns number of visible clusters.
+ */
+LITE3D_CEXPORT uint32_t lite3d_mesh_clusters_cull(const lite3d_mesh_cluster *clusters, uint32_t clustersCount,
+    const lite3d_mesh_cluster_cull_params *params, lite3d_array *ranges, lite3d_mesh_cluster_cull_stats *stats);
+
+#endif	/* LITE3D_MESH_CLUSTER_H */
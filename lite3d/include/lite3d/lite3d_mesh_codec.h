@@ -52,14 +52,84 @@
     BINARY
     -----------------------------------
 
+    Cluster section (optional):
+    -----------------------------------
+    SIG | COUNT | CHUNK | OFFSET | COUNT | bounds | cone | ...
+    -----------------------------------
+
+    LOD section (optional), indexes of levels follow chunk 
+    indexes inside chunk index range:
+    -----------------------------------
+    SIG | COUNT | CHUNK | OFFSET | COUNT | ERROR | ...
+    -----------------------------------
+
+*/
+
+typedef struct lite3d_mesh_m_geometry_chunk
+{
+    /* first vertex of chunk in positions array, indexes of chunk are relative to it */
+    uint32_t verticesOffset;
+    uint32_t verticesCount;
+    /* first index of chunk in indexes array, indexes of levels of detail follow indexesCount of LOD0 */
+    uint32_t indexesOffset;
+    uint32_t indexesCount;
+    uint32_t materialIndex;
+    lite3d_bounding_vol boundingVol;
+    /* first cluster of chunk in clusters array */
+    uint32_t clustersOffset;
+    uint32_t clustersCount;
+    /* first level of chunk in lods array, offsets of levels are relative to chunk indexesOffset */
+    uint32_t lodsOffset;
+    uint32_t lodsCount;
+} lite3d_mesh_m_geometry_chunk;
+
+/*
+    Host copy of .m file geometry: only vertex positions (3 floats per vertex, 
+    tightly packed) and indexes, no GL objects are created. Suitable for 
+    collision meshes and loading in worker threads.
 */
+typedef struct lite3d_mesh_m_geometry
+{
+    uint32_t chunksCount;
+    lite3d_mesh_m_geometry_chunk *chunks;
+    uint32_t verticesCount;
+    float *positions;
+    uint32_t indexesCount;
+    uint32_t *indexes;
+    uint32_t clustersCount;
+    lite3d_mesh_cluster *clusters;
+    uint32_t lodsCount;
+    lite3d_mesh_lod *lods;
+} lite3d_mesh_m_geometry;
 
 LITE3D_CEXPORT int lite3d_mesh_m_decode(lite3d_mesh *mesh, 
     const void *buffer, size_t size);
+LITE3D_CEXPORT int lite3d_mesh_m_decode_geometry(lite3d_mesh_m_geometry *geometry, 
+    const void *buffer, size_t size);
+LITE3D_CEXPORT void lite3d_mesh_m_geometry_purge(lite3d_mesh_m_geometry *geometry);
 
 LITE3D_CEXPORT size_t lite3d_mesh_m_encode_size(lite3d_mesh *mesh);
 LITE3D_CEXPORT int lite3d_mesh_m_encode(lite3d_mesh *mesh, 
     void *buffer, size_t size);
 
+/*
+    Splits index list of every chunk to clusters (see lite3d_mesh_clusters_build), 
+    output is a copy of .m file with reordered indexes and new cluster section,
+    released by lite3d_free. Works on host memory only.
+*/
+LITE3D_CEXPORT int lite3d_mesh_m_build_clusters(const void *buffer, size_t size, 
+    uint32_t maxVertices, uint32_t maxTriangles, void **out, size_t *outSize);
+
+/*
+    Generates up to levelsCount simplified levels of every chunk (see lite3d_mesh_simplify), 
+    each one has about reduction part of triangles of previous level. maxError is relative to 
+    chunk bounding radius, levels with larger error or not much smaller than previous are not
+    made. Error of level is measured deviation (see lite3d_mesh_deviation), not the estimate of
+    simplifier, so level selection can rely on it. Output is a copy of .m file with levels appended to chunk index ranges and new LOD 
+    section, previous levels are replaced, released by lite3d_free. Works on host memory only.
+*/
+LITE3D_CEXPORT int lite3d_mesh_m_build_lods(const void *buffer, size_t size, 
+    uint32_t levelsCount, float reduction, float maxError, void **out, size_t *outSize);
+
 #endif	/* LITE3D_M_CODEC_H */
 
@@ -0,0 +1,65 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef LITE3D_MESH_LOD_H
+#define	LITE3D_MESH_LOD_H
+
+#include <lite3d/lite3d_common.h>
+#include <lite3d/lite3d_mesh.h>
+
+#define LITE3D_LOD_MAX_LEVELS           8
+/* Each level keeps this part of triangles of previous one */
+#define LITE3D_LOD_DEFAULT_REDUCTION    0.5f
+/* Simplification stops at this error relative to chunk bounding radius */
+#define LITE3D_LOD_DEFAULT_MAX_ERROR    0.05f
+
+/*
+ * Quadric error metric edge collapse simplification of triangle list. Vertices are never moved or
+ * created: collapsed vertex is replaced by its neighbour, so result uses the same vertex buffer.
+ * Vertices on open borders and attribute seams (several vertices at one position) are locked, so
+ * mesh does not get holes. Collapses flipping triangles are rejected. Stops when result has at most 
+ * targetIndexesCount indexes or next collapse error exceeds targetError. 
+ * out must have space for indexesCount indexes, resultError (optional) gets the largest error of 
+ * applied collapses: RMS distance in model units to planes of original triangles around collapsed 
+ * vertex. It is an estimate, real deviation of surface may be a few times larger, see 
+ * lite3d_mesh_deviation.
+ */
+LITE3D_CEXPORT int lite3d_mesh_simplify(const void *positions, uint32_t stride, uint32_t verticesCount,
+    const uint32_t *indexes, uint32_t indexesCount, uint32_t targetIndexesCount, float targetError,
+    uint32_t *out, uint32_t *resultIndexesCount, float *resultError);
+
+/*
+ * Largest distance in model units from vertices of source triangle list to surface of simplified 
+ * one made by lite3d_mesh_simplify from it. Kept vertices are skipped, the nearest triangle of 
+ * collapsed vertex is found on uniform grid of simplified triangles.
+ */
+LITE3D_CEXPORT int lite3d_mesh_deviation(const void *positions, uint32_t stride, uint32_t verticesCount,
+    const uint32_t *indexes, uint32_t indexesCount, const uint32_t *simplified, uint32_t simplifiedCount,
+    float *deviation);
+
+/*
+ * Chooses level of chunk with bounding sphere of model space radius which projection covers
+ * projectedRadius of screen height (see lite3d_camera_projected_radius). Level 0 is chunk itself, 
+ * level i is lods[i - 1], errors of levels must grow. Projected error of level is its error scaled 
+ * as radius to projectedRadius, the coarsest level with projected error below maxError is wanted.
+ * To avoid popping near threshold current level is kept while its error is below maxError and 
+ * coarser level is taken only when its error is below maxError * (1 - hysteresis).
+ */
+LITE3D_CEXPORT uint32_t lite3d_mesh_lod_select(const lite3d_mesh_lod *lods, uint32_t lodsCount,
+    float radius, float projectedRadius, float maxError, float hysteresis, uint32_t currentLevel);
+
+#endif	/* LITE3D_MESH_LOD_H */
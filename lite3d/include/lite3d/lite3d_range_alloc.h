@@ -0,0 +1,61 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef LITE3D_RANGE_ALLOC_H
+#define	LITE3D_RANGE_ALLOC_H
+
+#include <lite3d/lite3d_common.h>
+#include <lite3d/lite3d_array.h>
+
+/*
+ * Sub-allocator of offsets inside a linear storage (e.g. GPU buffer),
+ * it does not own any memory, only tracks free ranges.
+ */
+typedef struct lite3d_range
+{
+    size_t offset;
+    size_t size;
+} lite3d_range;
+
+typedef struct lite3d_range_allocator
+{
+    /* free ranges sorted by offset, neighbours are always coalesced */
+    lite3d_array freeRanges;
+    size_t capacity;
+    size_t usedBytes;
+    /* bytes moved by storage reallocation and compaction */
+    size_t bytesCopied;
+    uint32_t grows;
+    uint32_t compactions;
+} lite3d_range_allocator;
+
+LITE3D_CEXPORT void lite3d_range_allocator_init(lite3d_range_allocator *a);
+LITE3D_CEXPORT void lite3d_range_allocator_purge(lite3d_range_allocator *a);
+/* First fit, align is not required to be power of two, so vertex stride can be used as is */
+LITE3D_CEXPORT int lite3d_range_alloc(lite3d_range_allocator *a, size_t size, size_t align, size_t *offset);
+LITE3D_CEXPORT void lite3d_range_free(lite3d_range_allocator *a, size_t offset, size_t size);
+/* Capacity to grow storage to when allocation of size is failed, at least doubles current capacity */
+LITE3D_CEXPORT size_t lite3d_range_allocator_grow_capacity(const lite3d_range_allocator *a,
+    size_t size, size_t align);
+/* Storage was reallocated to newCapacity with content preserved */
+LITE3D_CEXPORT int lite3d_range_allocator_grow(lite3d_range_allocator *a, size_t newCapacity);
+/* Storage content was replaced (loaded or compacted), first used bytes are busy, the rest is free */
+LITE3D_CEXPORT int lite3d_range_allocator_reset(lite3d_range_allocator *a, size_t capacity, size_t used);
+/* Size of the biggest free range */
+LITE3D_CEXPORT size_t lite3d_range_allocator_max_free(const lite3d_range_allocator *a);
+
+#endif	/* LITE3D_RANGE_ALLOC_H */
@@ -0,0 +1,111 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef LITE3D_READBACK_H
+#define	LITE3D_READBACK_H
+
+#include <lite3d/lite3d_common.h>
+#include <lite3d/lite3d_texture_unit.h>
+#include <lite3d/lite3d_framebuffer.h>
+
+/*
+ * Asynchronous readback of textures and framebuffers. Pixels are copied
+ * into one of pixel pack buffers of the ring and fenced, poll picks up
+ * copies which GPU has finished, so CPU never waits for the GPU.
+ */
+
+#define LITE3D_READBACK_DEPTH_MAX       8
+#define LITE3D_READBACK_DEPTH_DEFAULT   3
+
+/* what to copy, either texture level or framebuffer attachment */
+typedef struct lite3d_readback_source
+{
+    const lite3d_texture_unit *texture;
+    int8_t level;
+    lite3d_framebuffer *framebuffer;
+    uint16_t index;
+    uint16_t format;
+    size_t size;
+} lite3d_readback_source;
+
+/* GL calls issued by the readback ring, could be replaced in tests */
+typedef struct lite3d_readback_backend
+{
+    uint32_t (*bufferCreate)(size_t size);
+    void (*bufferDelete)(uint32_t bufferID);
+    /* start copy of source into buffer, must not wait for GPU */
+    int (*copy)(const lite3d_readback_source *source, uint32_t bufferID);
+    void *(*fenceInsert)(void);
+    /* must not block */
+    int (*fenceSignaled)(void *fence);
+    void (*fenceDelete)(void *fence);
+    int (*bufferRead)(uint32_t bufferID, void *data, size_t size);
+} lite3d_readback_backend;
+
+typedef struct lite3d_readback_slot
+{
+    uint32_t bufferID;
+    size_t capacity;
+    size_t size;
+    void *fence;
+    uint32_t requestNo;
+    uint32_t pollNo;
+} lite3d_readback_slot;
+
+typedef struct lite3d_readback
+{
+    lite3d_readback_slot slots[LITE3D_READBACK_DEPTH_MAX];
+    uint8_t depth;
+    uint8_t first;
+    uint8_t pending;
+    /* latest completed copy */
+    void *result;
+    size_t resultSize;
+    size_t resultCapacity;
+    uint32_t resultRequestNo;
+    /* counters */
+    uint32_t requested;
+    uint32_t completed;
+    uint32_t skipped;
+    uint32_t polls;
+    /* polls between request and completion of latest result */
+    uint32_t latency;
+} lite3d_readback;
+
+/* NULL restores GL backend */
+LITE3D_CEXPORT void lite3d_readback_set_backend(const lite3d_readback_backend *backend);
+
+/* returns false if pixel pack buffers or fences are not supported, use synchronous read then */
+LITE3D_CEXPORT int lite3d_readback_init(lite3d_readback *readback, uint8_t depth);
+LITE3D_CEXPORT void lite3d_readback_purge(lite3d_readback *readback);
+
+/* returns false if ring is full, request is skipped then */
+LITE3D_CEXPORT int lite3d_readback_request(lite3d_readback *readback, const lite3d_readback_source *source);
+LITE3D_CEXPORT int lite3d_readback_request_texture(lite3d_readback *readback,
+    const lite3d_texture_unit *texture, int8_t level);
+LITE3D_CEXPORT int lite3d_readback_request_framebuffer(lite3d_readback *readback,
+    lite3d_framebuffer *fb, uint16_t index, uint16_t format);
+
+/*
+ * Take finished copies in request order, only the newest one is read back.
+ * Returns true if result was updated.
+ */
+LITE3D_CEXPORT int lite3d_readback_poll(lite3d_readback *readback);
+/* latest completed result or NULL if nothing completed yet */
+LITE3D_CEXPORT const void *lite3d_readback_result(const lite3d_readback *readback, size_t *size);
+
+#endif	/* LITE3D_READBACK_H */
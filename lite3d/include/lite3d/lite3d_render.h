@@ -68,6 +68,7 @@ typedef struct lite3d_render_stats
     int32_t textureBinds;
     int32_t bufferBinds;
     int32_t drawSubCommands;
+    int32_t culledClusters;
     int64_t framesCount;
     int32_t vboCount;
     int32_t vaoCount;
@@ -76,6 +77,15 @@ typedef struct lite3d_render_stats
     int32_t uboCount;
     int32_t indirectCount;
     int32_t queryCount;
+    size_t frameArenaBytes;
+    size_t frameArenaHighWater;
+    /* GL calls filtered by state cache */
+    int32_t textureBindsAvoided;
+    int32_t bufferBindsAvoided;
+    int32_t uniformsSent;
+    int32_t uniformsAvoided;
+    int32_t stateChanges;
+    int32_t stateChangesAvoided;
 } lite3d_render_stats;
 
 typedef struct lite3d_render_target
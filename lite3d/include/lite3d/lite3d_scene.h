@@ -22,6 +22,8 @@
 #include <lite3d/lite3d_camera.h>
 #include <lite3d/lite3d_list.h>
 #include <lite3d/lite3d_mesh.h>
+#include <lite3d/lite3d_mesh_cluster.h>
+#include <lite3d/lite3d_mesh_lod.h>
 #include <lite3d/lite3d_material.h>
 #include <lite3d/lite3d_array.h>
 #include <lite3d/lite3d_lighting.h>
@@ -48,6 +50,12 @@
 #define LITE3D_RENDER_SORT_TRANSPARENT_TO_NEAR      ((uint32_t)0x1 << 15)
 #define LITE3D_RENDER_SORT_OPAQUE_FROM_NEAR         ((uint32_t)0x1 << 16)
 #define LITE3D_RENDER_SORT_TRANSPARENT_FROM_NEAR    ((uint32_t)0x1 << 17)
+// Multirender only: chunks with clusters are drawn by visible clusters, back faces are rejected
+// by normal cones, so targets drawing back faces (shadow maps with front face culling) must not use it
+#define LITE3D_RENDER_CLUSTER_CULLING               ((uint32_t)0x1 << 18)
+// Chunks with levels of detail are drawn by level chosen by projected size of bounding sphere,
+// targets without the flag use the last level chosen for the node, so shadows and prepasses match
+#define LITE3D_RENDER_LOD                           ((uint32_t)0x1 << 19)
 // Scene features
 #define LITE3D_SCENE_FEATURE_MULTIRENDER                   ((uint32_t)0x1)
 
@@ -68,6 +76,8 @@ typedef struct lite3d_scene_stats
     int32_t bufferBinds;
     int32_t materialsSwitch;
     int32_t drawSubCommands;
+    int32_t culledClusters;
+    int32_t lodDrawn;
 } lite3d_scene_stats;
 
 typedef struct lite3d_scene
@@ -83,8 +93,11 @@ typedef struct lite3d_scene
     lite3d_vbo *invocationBufferGPU;       // GPU Буфер с инфо по каждой draw команде (матрицы, индексы материалов и тд)
     lite3d_array invocationIndexBufferCPU;     // CPU Буфер с индексами draw команд
     lite3d_vbo *invocationIndexBufferGPU;       // GPU Буфер с индексами draw команд
+    lite3d_array clusterRanges;                 // Видимые диапазоны индексов текущего чанка
     lite3d_camera *currentCamera;
     uint32_t features;
+    float lodMaxError;                          // Допустимая ошибка уровня детализации в долях высоты экрана
+    float lodHysteresis;                        // Запас ошибки для перехода на более грубый уровень, 0..1
     void *userdata;
 
     int (*beginDrawBatch)(struct lite3d_scene *scene, 
@@ -101,6 +114,8 @@ typedef struct lite3d_scene
         struct lite3d_scene_node *node, struct lite3d_mesh_chunk *meshChunk, 
         struct lite3d_material *material, struct lite3d_bounding_vol *boundingVol,
         struct lite3d_camera *camera);
+    /* optional, called by LITE3D_RENDER_CLUSTER_CULLING for clusters passed frustum and cone tests */
+    lite3d_mesh_cluster_occlusion_test clusterOcclusionTest;
     void (*beforeUpdateNodes)(struct lite3d_scene *scene, struct lite3d_camera *camera);
     int (*beginSceneRender)(struct lite3d_scene *scene, struct lite3d_camera *camera);
     void (*endSceneRender)(struct lite3d_scene *scene, struct lite3d_camera *camera);
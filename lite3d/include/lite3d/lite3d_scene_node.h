@@ -50,6 +50,8 @@ typedef struct  lite3d_scene_node
     uint8_t visible;
     uint8_t frustumTest;
     int32_t skeletonTransformIndex;
+    // Множитель допустимой ошибки при выборе уровня детализации, 0 - всегда полная детализация
+    float lodBias;
     struct lite3d_scene_node *baseNode;
     struct lite3d_list childNodes;
     void *scene;
@@ -61,6 +63,7 @@ LITE3D_CEXPORT void lite3d_scene_node_set_position(lite3d_scene_node *node, cons
 LITE3D_CEXPORT void lite3d_scene_node_move(lite3d_scene_node *node, const kmVec3 *position);
 LITE3D_CEXPORT void lite3d_scene_node_move_relative(lite3d_scene_node *node, const kmVec3 *vec);
 LITE3D_CEXPORT void lite3d_scene_node_set_rotation(lite3d_scene_node *node, const kmQuaternion *quat);
+LITE3D_CEXPORT void lite3d_scene_node_set_transform(lite3d_scene_node *node, const kmVec3 *position, const kmQuaternion *quat);
 LITE3D_CEXPORT void lite3d_scene_node_rotate(lite3d_scene_node *node, const kmQuaternion *quat);
 LITE3D_CEXPORT void lite3d_scene_node_rotate_angle(lite3d_scene_node *node, const kmVec3 *axis, float angle);
 LITE3D_CEXPORT void lite3d_scene_node_set_scale(lite3d_scene_node *node, const kmVec3 *scale);
@@ -22,6 +22,7 @@
 #include <lite3d/lite3d_texture_unit.h>
 #include <lite3d/lite3d_rb_tree.h>
 #include <lite3d/lite3d_list.h>
+#include <lite3d/lite3d_array.h>
 #include <lite3d/lite3d_kazmath.h>
 
 #define LITE3D_SHADER_PARAMETER_MAX_NAME            128
@@ -79,6 +80,8 @@ typedef struct lite3d_shader_parameter_container
     lite3d_list_node parameterLink;
     lite3d_shader_parameter *parameter;
     lite3d_shader_binding_context *bindContext;
+    /* hash of parameter name, calculated when parameter added */
+    uint32_t nameHash;
     /* uniform location in shader program attached to this pass */
     int32_t location;
     int16_t binding;
@@ -89,6 +92,13 @@ typedef struct lite3d_shader_parameters
     lite3d_shader_binding_context bindContext;
     /* list lite3d_shader_parameter_container */
     lite3d_list parameters;
+    /* 
+     * dense array of lite3d_shader_parameter_container* with resolved locations,
+     * compiled for program when parameters applied first time 
+     */
+    lite3d_array applyTable;
+    struct lite3d_shader_program *compiledProgram;
+    uint32_t compiledLinkId;
 } lite3d_shader_parameters;
 
 typedef struct lite3d_global_parameters
@@ -113,6 +123,8 @@ LITE3D_CEXPORT void lite3d_shader_parameter_purge(
     lite3d_shader_parameter *param);
 
 
+LITE3D_CEXPORT uint32_t lite3d_shader_parameter_name_hash(const char *name);
+
 LITE3D_CEXPORT void lite3d_shader_parameters_init(lite3d_shader_parameters *params);
 
 LITE3D_CEXPORT void lite3d_shader_parameters_add(lite3d_shader_parameters *params,
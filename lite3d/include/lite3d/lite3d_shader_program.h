@@ -21,10 +21,30 @@
 #include <lite3d/lite3d_common.h>
 #include <lite3d/lite3d_shader.h>
 #include <lite3d/lite3d_shader_params.h>
+#include <lite3d/lite3d_gl_state.h>
 
 #define LITE3D_SHADER_PROGRAM_TYPE_COMMON_PIPELINE  0x1
 #define LITE3D_SHADER_PROGRAM_TYPE_COMPUTE          0x2
 
+#define LITE3D_SHADER_BINDING_UNIFORM               0x0
+#define LITE3D_SHADER_BINDING_UNIFORM_BLOCK         0x1
+#define LITE3D_SHADER_BINDING_STORAGE_BLOCK         0x2
+/* several names of program have the same hash, location must be queried by name */
+#define LITE3D_SHADER_BINDING_COLLISION             -3
+
+/* active uniform or block of linked program */
+typedef struct lite3d_shader_binding
+{
+    uint32_t nameHash;
+    /* uniform location or block index */
+    int32_t location;
+    /* GL type of uniform, zero for blocks */
+    uint32_t type;
+    /* array size of uniform */
+    int32_t size;
+    uint8_t kind;
+} lite3d_shader_binding;
+
 typedef struct lite3d_shader_program
 {
     uint32_t programID;
@@ -33,6 +53,11 @@ typedef struct lite3d_shader_program
     uint8_t validated;
     uint8_t type;
     uint32_t syncFlags;
+    /* lite3d_shader_binding sorted by name hash, rebuilt after link */
+    lite3d_array bindings;
+    uint32_t linkId;
+    /* last values of uniforms by location, lite3d_gl_uniform_value */
+    lite3d_array uniformCache;
     /* userdata */
     void *userdata;
 } lite3d_shader_program;
@@ -67,6 +92,15 @@ LITE3D_CEXPORT void lite3d_shader_program_compute_dispatch(struct lite3d_shader_
 LITE3D_CEXPORT void lite3d_shader_program_compute_dispatch_sync(struct lite3d_shader_program *program, uint32_t numGroupsX,
     uint32_t numGroupsY, uint32_t numGroupsZ);
 
+/* name may have array suffix "[0]", it is dropped like glGetUniformLocation does */
+LITE3D_CEXPORT int lite3d_shader_program_add_binding(struct lite3d_shader_program *program,
+    const char *name, uint8_t kind, int32_t location, uint32_t type, int32_t size);
+LITE3D_CEXPORT const lite3d_shader_binding *lite3d_shader_program_find_binding(
+    const struct lite3d_shader_program *program, uint32_t nameHash, uint8_t kind);
+/* resolve locations of parameters by program binding table, no string lookups after that */
+LITE3D_CEXPORT void lite3d_shader_program_compile_parameters(struct lite3d_shader_program *program, 
+    struct lite3d_shader_parameters *params);
+
 LITE3D_CEXPORT void lite3d_shader_program_apply_parameters(struct lite3d_shader_program *program, 
     struct lite3d_shader_parameters *params, uint8_t changed);
 
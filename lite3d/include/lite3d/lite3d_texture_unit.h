@@ -250,6 +250,10 @@ LITE3D_CEXPORT int lite3d_texture_unit_get_compressed_level_size(const lite3d_te
     int8_t level, uint8_t cubeface, size_t *size);
 /* regenerate mipmaps */
 LITE3D_CEXPORT int lite3d_texture_unit_generate_mipmaps(lite3d_texture_unit *textureUnit);
+LITE3D_CEXPORT int lite3d_texture_unit_copy_support(void);
+/* copy layers of level between textures with the same target, format and size, without CPU roundtrip */
+LITE3D_CEXPORT int lite3d_texture_unit_copy_layers(const lite3d_texture_unit *source, lite3d_texture_unit *dest,
+    int8_t level, int32_t srcLayer, int32_t dstLayer, int32_t count);
 
 LITE3D_CEXPORT void lite3d_texture_unit_purge(lite3d_texture_unit *texture);
 LITE3D_CEXPORT void lite3d_texture_unit_bind(lite3d_texture_unit *texture, uint16_t layer);
@@ -78,6 +78,9 @@ LITE3D_CEXPORT void lite3d_vao_bind(struct lite3d_vao *vao);
 LITE3D_CEXPORT void lite3d_vao_draw_indexed(struct lite3d_vao *vao);
 LITE3D_CEXPORT void lite3d_vao_multidraw_indexed(size_t offset, size_t count);
 LITE3D_CEXPORT void lite3d_vao_draw_indexed_instanced(struct lite3d_vao *vao, uint32_t count);
+/* Part of vao indexes, offset in indexes relative to vao indexes, may exceed indexesCount up to indexesSize */
+LITE3D_CEXPORT void lite3d_vao_draw_indexed_range(struct lite3d_vao *vao, uint32_t indexesOffset, 
+    uint32_t indexesCount, uint32_t instancesCount);
 LITE3D_CEXPORT void lite3d_vao_draw(struct lite3d_vao *vao);
 LITE3D_CEXPORT void lite3d_vao_multidraw(size_t offset, size_t count);
 LITE3D_CEXPORT void lite3d_vao_draw_instanced(struct lite3d_vao *vao, uint32_t count);
@@ -31,6 +31,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 
 #include "utility.h"
+
+#if !defined(USE_DOUBLE_PRECISION) && (defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define KM_MAT4_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "vec3.h"
 #include "mat4.h"
 #include "mat3.h"
@@ -264,6 +271,46 @@ kmMat4* kmMat4Multiply(kmMat4* pOut, const kmMat4* pM1, const kmMat4* pM2)
     return pOut;
 }
 
+/**
+ * Multiplies count pairs of matrices, pOut[i] = pM1[i] * pM2[i], returns pOut
+ */
+kmMat4* kmMat4MultiplyArray(kmMat4* pOut, const kmMat4* pM1, const kmMat4* pM2, size_t count)
+{
+    size_t i;
+#ifdef KM_MAT4_SSE
+    for (i = 0; i < count; ++i)
+    {
+        const kmScalar *m1 = pM1[i].mat, *m2 = pM2[i].mat;
+        __m128 c0 = _mm_loadu_ps(m1), c1 = _mm_loadu_ps(m1 + 4),
+            c2 = _mm_loadu_ps(m1 + 8), c3 = _mm_loadu_ps(m1 + 12);
+        __m128 r[4];
+        int j;
+
+        /* column j of result is a combination of pM1 columns by column j of pM2 */
+        for (j = 0; j < 4; ++j)
+        {
+            r[j] = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(c0, _mm_set1_ps(m2[j * 4])),
+                _mm_mul_ps(c1, _mm_set1_ps(m2[j * 4 + 1]))),
+                _mm_mul_ps(c2, _mm_set1_ps(m2[j * 4 + 2]))),
+                _mm_mul_ps(c3, _mm_set1_ps(m2[j * 4 + 3])));
+        }
+
+        _mm_storeu_ps(pOut[i].mat, r[0]);
+        _mm_storeu_ps(pOut[i].mat + 4, r[1]);
+        _mm_storeu_ps(pOut[i].mat + 8, r[2]);
+        _mm_storeu_ps(pOut[i].mat + 12, r[3]);
+    }
+#else
+    for (i = 0; i < count; ++i)
+    {
+        kmMat4Multiply(&pOut[i], &pM1[i], &pM2[i]);
+    }
+#endif
+
+    return pOut;
+}
+
 /**
  * Assigns the value of pIn to pOut
  */
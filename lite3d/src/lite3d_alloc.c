@@ -19,13 +19,287 @@
 #include <string.h>
 #include <SDL_log.h>
 #include <SDL_assert.h>
+#include <SDL_atomic.h>
+#include <SDL_thread.h>
 
+#define LITE3D_ALLOC_IMPLEMENTATION
 #include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_list.h>
+#include <lite3d/lite3d_metrics.h>
 #include <lite3d/lite3d_nedmalloc.h>
 
-lite3d_alloca_f gAlloca_f = {NULL, NULL};
+typedef struct _frame_arena_block
+{
+    struct _frame_arena_block *next;
+    size_t size;
+    size_t used;
+} _frame_arena_block;
+
+#define LITE3D_FRAME_ARENA_HEADER LITE3D_ALIGN_SIZE(sizeof(_frame_arena_block), LITE3D_FRAME_ARENA_ALIGN)
+
+typedef struct _frame_arena
+{
+    lite3d_list_node link;
+    /* Two buffers, odd and even frames, the head block is the current one */
+    _frame_arena_block *blocks[2];
+    int32_t frameNo;
+    uint8_t orphaned;
+    /* Memory cleaned up while owning thread is alive, the thread frees the arena on exit */
+    uint8_t detached;
+} _frame_arena;
+
+lite3d_alloca_f gAlloca_f = {NULL, NULL, NULL};
 nedpool *globalMemPools[LITE3D_POOL_MAX] = {NULL, NULL, NULL, NULL, NULL, NULL};
 
+static SDL_TLSID gFrameArenaTls = 0;
+static SDL_SpinLock gFrameArenaLock = 0;
+static lite3d_list gFrameArenas = {{&gFrameArenas.l, &gFrameArenas.l}};
+static SDL_atomic_t gFrameNo = {0};
+static SDL_atomic_t gFrameBytes = {0};
+static SDL_atomic_t gFrameReserved = {0};
+static SDL_atomic_t gFrameHeapAllocations = {0};
+static size_t gLastFrameBytes = 0;
+static size_t gFrameHighWater = 0;
+
+#ifdef LITE3D_WITH_MEMORY_STATS
+/* Prefix of every heap or pooled allocation */
+typedef struct _alloc_header
+{
+    lite3d_list_node link;
+    const char *file;
+    int32_t line;
+    uint8_t poolNo;
+    uint8_t tag;
+    uint8_t tracked;
+    size_t size;
+} _alloc_header;
+
+#define LITE3D_ALLOC_HEADER LITE3D_ALIGN_SIZE(sizeof(_alloc_header), 16)
+
+typedef struct _alloc_counters
+{
+    size_t usedBytes;
+    size_t peakBytes;
+    uint64_t allocations;
+    uint64_t frees;
+    uint32_t frameAllocations;
+    uint32_t lastFrameAllocations;
+} _alloc_counters;
+
+static SDL_SpinLock gStatsLock = 0;
+static SDL_TLSID gMemoryTagTls = 0;
+static int gTrackLeaks = LITE3D_FALSE;
+/* pools and the heap at LITE3D_POOL_HEAP */
+static _alloc_counters gPoolCounters[LITE3D_POOL_MAX + 1];
+static _alloc_counters gTagCounters[LITE3D_MEMORY_TAG_MAX];
+static lite3d_list gLiveAllocations = {{&gLiveAllocations.l, &gLiveAllocations.l}};
+
+static uint8_t memory_current_tag(void)
+{
+    return gMemoryTagTls ? (uint8_t)(uintptr_t)SDL_TLSGet(gMemoryTagTls) : LITE3D_MEMORY_TAG_DEFAULT;
+}
+
+static void counters_add(_alloc_counters *counters, size_t size)
+{
+    counters->usedBytes += size;
+    if (counters->usedBytes > counters->peakBytes)
+        counters->peakBytes = counters->usedBytes;
+    counters->allocations++;
+    counters->frameAllocations++;
+}
+
+static void counters_sub(_alloc_counters *counters, size_t size)
+{
+    counters->usedBytes -= size;
+    counters->frees++;
+}
+
+static void counters_fill(const _alloc_counters *counters, lite3d_memory_stats *stats)
+{
+    stats->usedBytes = counters->usedBytes;
+    stats->peakBytes = counters->peakBytes;
+    stats->reservedBytes = 0;
+    stats->allocations = counters->allocations;
+    stats->frees = counters->frees;
+    stats->frameAllocations = counters->lastFrameAllocations;
+}
+
+static void *stats_register(_alloc_header *header, uint8_t poolNo, size_t size, 
+    uint8_t tag, const char *file, int line)
+{
+    if (!header)
+        return NULL;
+
+    header->file = file;
+    header->line = line;
+    header->poolNo = poolNo;
+    header->tag = tag;
+    header->tracked = LITE3D_FALSE;
+    header->size = size;
+
+    SDL_AtomicLock(&gStatsLock);
+    counters_add(&gPoolCounters[poolNo], size);
+    counters_add(&gTagCounters[tag], size);
+    if (gTrackLeaks)
+    {
+        lite3d_list_link_init(&header->link);
+        lite3d_list_add_last_link(&header->link, &gLiveAllocations);
+        header->tracked = LITE3D_TRUE;
+    }
+    SDL_AtomicUnlock(&gStatsLock);
+
+    return (uint8_t *)header + LITE3D_ALLOC_HEADER;
+}
+
+static _alloc_header *stats_unregister(void *p)
+{
+    _alloc_header *header = (_alloc_header *)((uint8_t *)p - LITE3D_ALLOC_HEADER);
+
+    SDL_AtomicLock(&gStatsLock);
+    counters_sub(&gPoolCounters[header->poolNo], header->size);
+    counters_sub(&gTagCounters[header->tag], header->size);
+    if (header->tracked)
+        lite3d_list_unlink_link(&header->link);
+    SDL_AtomicUnlock(&gStatsLock);
+
+    return header;
+}
+
+static void memory_report_leaks(void)
+{
+    lite3d_list_node *node;
+    size_t leakedBytes = 0, leaksCount = 0;
+
+    SDL_AtomicLock(&gStatsLock);
+    for (node = gLiveAllocations.l.next; node != &gLiveAllocations.l; node = lite3d_list_next(node))
+    {
+        _alloc_header *header = LITE3D_MEMBERCAST(_alloc_header, node, link);
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: leaked %lu bytes at %s:%d (pool %d, tag %d)",
+            LITE3D_CURRENT_FUNCTION, (unsigned long)header->size, header->file ? header->file : "<unknown>",
+            header->line, header->poolNo, header->tag);
+
+        leakedBytes += header->size;
+        leaksCount++;
+        /* may be freed after cleanup, e.g. by thread exit, the list is dropped below */
+        header->tracked = LITE3D_FALSE;
+    }
+
+    lite3d_list_init(&gLiveAllocations);
+    gTrackLeaks = LITE3D_FALSE;
+    SDL_AtomicUnlock(&gStatsLock);
+
+    if (leaksCount > 0)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: %lu allocations leaked, %lu bytes total",
+            LITE3D_CURRENT_FUNCTION, (unsigned long)leaksCount, (unsigned long)leakedBytes);
+    }
+}
+#endif
+
+static void frame_arena_free_blocks(_frame_arena_block *block)
+{
+    _frame_arena_block *next;
+    for (; block; block = next)
+    {
+        next = block->next;
+        SDL_AtomicAdd(&gFrameReserved, -(int)block->size);
+        lite3d_free(block);
+    }
+}
+
+static _frame_arena_block *frame_arena_new_block(size_t size, _frame_arena_block *next)
+{
+    _frame_arena_block *block = lite3d_malloc(LITE3D_FRAME_ARENA_HEADER + size);
+    if (!block)
+        return NULL;
+
+    block->next = next;
+    block->size = size;
+    block->used = 0;
+    SDL_AtomicAdd(&gFrameReserved, (int)size);
+    SDL_AtomicIncRef(&gFrameHeapAllocations);
+    return block;
+}
+
+static void frame_arena_free(_frame_arena *arena)
+{
+    frame_arena_free_blocks(arena->blocks[0]);
+    frame_arena_free_blocks(arena->blocks[1]);
+    lite3d_free(arena);
+}
+
+static void frame_arena_thread_exit(void *arena)
+{
+    _frame_arena *threadArena = (_frame_arena *)arena;
+    int detached;
+
+    /* Thread gone, the arena will be adopted by another thread or freed at cleanup */
+    SDL_AtomicLock(&gFrameArenaLock);
+    threadArena->orphaned = LITE3D_TRUE;
+    detached = threadArena->detached;
+    SDL_AtomicUnlock(&gFrameArenaLock);
+
+    /* Not in the arenas list anymore, nobody else can reach it */
+    if (detached)
+        frame_arena_free(threadArena);
+}
+
+static _frame_arena *frame_arena_get(void)
+{
+    _frame_arena *arena;
+    lite3d_list_node *node;
+
+    if ((arena = SDL_TLSGet(gFrameArenaTls)) != NULL)
+        return arena;
+
+    SDL_AtomicLock(&gFrameArenaLock);
+    for (node = gFrameArenas.l.next; node != &gFrameArenas.l; node = lite3d_list_next(node))
+    {
+        _frame_arena *orphan = LITE3D_MEMBERCAST(_frame_arena, node, link);
+        if (orphan->orphaned)
+        {
+            orphan->orphaned = LITE3D_FALSE;
+            arena = orphan;
+            break;
+        }
+    }
+
+    if (!arena && (arena = lite3d_calloc(sizeof(_frame_arena))) != NULL)
+    {
+        lite3d_list_link_init(&arena->link);
+        lite3d_list_add_last_link(&arena->link, &gFrameArenas);
+        arena->frameNo = SDL_AtomicGet(&gFrameNo);
+    }
+    SDL_AtomicUnlock(&gFrameArenaLock);
+
+    if (arena)
+        SDL_TLSSet(gFrameArenaTls, arena, frame_arena_thread_exit);
+    return arena;
+}
+
+static void frame_arena_reset(_frame_arena_block **head)
+{
+    _frame_arena_block *block = *head;
+    size_t total = 0;
+
+    if (!block)
+        return;
+
+    /* Buffer overflowed during its frame, replace the chain with one block of the total size
+     * so the next frames of the same size do not touch the heap */
+    if (block->next)
+    {
+        for (; block; block = block->next)
+            total += block->size;
+
+        frame_arena_free_blocks(*head);
+        *head = frame_arena_new_block(total, NULL);
+        return;
+    }
+
+    block->used = 0;
+}
+
 void lite3d_memory_init(lite3d_alloca_f *allocator)
 {
     int i;
@@ -38,8 +312,16 @@ void lite3d_memory_init(lite3d_alloca_f *allocator)
     {
         gAlloca_f.mallocf = malloc;
         gAlloca_f.freef = free;
+        gAlloca_f.reallocf = realloc;
     }
 
+    if (!gFrameArenaTls)
+        gFrameArenaTls = SDL_TLSCreate();
+#ifdef LITE3D_WITH_MEMORY_STATS
+    if (!gMemoryTagTls)
+        gMemoryTagTls = SDL_TLSCreate();
+#endif
+
     for (i = 0; i < LITE3D_POOL_MAX; ++i)
     {
         if (!globalMemPools[i])
@@ -50,6 +332,30 @@ void lite3d_memory_init(lite3d_alloca_f *allocator)
 void lite3d_memory_cleanup(void)
 {
     int i;
+    lite3d_list_node *node;
+    _frame_arena *ownArena;
+
+    ownArena = gFrameArenaTls ? SDL_TLSGet(gFrameArenaTls) : NULL;
+    SDL_AtomicLock(&gFrameArenaLock);
+    while ((node = lite3d_list_remove_first_link(&gFrameArenas)) != NULL)
+    {
+        _frame_arena *arena = LITE3D_MEMBERCAST(_frame_arena, node, link);
+        /* Arena of other live thread is freed by the thread exit destructor */
+        if (arena->orphaned || arena == ownArena)
+            frame_arena_free(arena);
+        else
+            arena->detached = LITE3D_TRUE;
+    }
+    SDL_AtomicUnlock(&gFrameArenaLock);
+
+    if (ownArena)
+        SDL_TLSSet(gFrameArenaTls, NULL, NULL);
+
+#ifdef LITE3D_WITH_MEMORY_STATS
+    /* Report before pools destroyed, headers of leaked chunks live there */
+    memory_report_leaks();
+#endif
+
     for (i = 0; i < LITE3D_POOL_MAX; ++i)
     {
         if (globalMemPools[i])
@@ -60,7 +366,7 @@ void lite3d_memory_cleanup(void)
     }
 }
 
-void *lite3d_malloc(size_t size)
+static void *heap_malloc(size_t size)
 {
     void *newmem = NULL;
     if (gAlloca_f.mallocf)
@@ -75,6 +381,45 @@ void *lite3d_malloc(size_t size)
     return newmem;
 }
 
+static void *heap_realloc(void *p, size_t size)
+{
+    void *newmem = NULL;
+    /* Custom allocator may not support realloc, caller must fallback to malloc/copy */
+    if (gAlloca_f.reallocf)
+    {
+        if ((newmem = gAlloca_f.reallocf(p, size)) == NULL)
+        {
+            SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION,
+                "%s: out of memory, failed to reallocate %lu bytes", LITE3D_CURRENT_FUNCTION, size);
+        }
+    }
+
+    return newmem;
+}
+
+static void *pool_malloc(uint8_t pollNo, size_t size)
+{
+    void *newmem = NULL;
+    SDL_assert(pollNo < LITE3D_POOL_MAX);
+
+    if ((newmem = nedpmalloc(globalMemPools[pollNo], size)) == NULL)
+    {
+        SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION,
+            "%s: out of memory at pool %d, failed to allocate %lu bytes", LITE3D_CURRENT_FUNCTION, pollNo, size);
+    }
+
+    return newmem;
+}
+
+void *lite3d_malloc(size_t size)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    return lite3d_malloc_track(size, NULL, 0);
+#else
+    return heap_malloc(size);
+#endif
+}
+
 void *lite3d_calloc(size_t size)
 {
     void *mem = NULL;
@@ -87,30 +432,109 @@ void *lite3d_calloc(size_t size)
     return mem;
 }
 
+void *lite3d_realloc(void *p, size_t size)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    _alloc_header *header, prev;
+    void *newmem;
+
+    if (!gAlloca_f.reallocf)
+        return NULL;
+    if (!p)
+        return lite3d_malloc_track(size, NULL, 0);
+
+    header = stats_unregister(p);
+    prev = *header;
+    if ((newmem = heap_realloc(header, LITE3D_ALLOC_HEADER + size)) == NULL)
+    {
+        /* old block is still valid */
+        stats_register(header, LITE3D_POOL_HEAP, prev.size, prev.tag, prev.file, prev.line);
+        return NULL;
+    }
+
+    return stats_register(newmem, LITE3D_POOL_HEAP, size, prev.tag, prev.file, prev.line);
+#else
+    return heap_realloc(p, size);
+#endif
+}
+
 void lite3d_free(void *p)
 {
     if (gAlloca_f.freef && p)
+    {
+#ifdef LITE3D_WITH_MEMORY_STATS
+        _alloc_header *header = stats_unregister(p);
+        SDL_assert(header->poolNo == LITE3D_POOL_HEAP);
+        p = header;
+#endif
         gAlloca_f.freef(p);
+    }
 }
 
 void *lite3d_malloc_pooled(uint8_t pollNo, size_t size)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    return lite3d_malloc_pooled_track(pollNo, size, NULL, 0);
+#else
+    return pool_malloc(pollNo, size);
+#endif
+}
+
+void *lite3d_calloc_pooled(uint8_t pollNo, size_t size)
 {
     void *newmem = NULL;
+    if ((newmem = lite3d_malloc_pooled(pollNo, size)) == NULL)
+    {
+        return NULL;
+    }
+
+    memset(newmem, 0, size);
+    return newmem;
+}
+
+void lite3d_free_pooled(uint8_t pollNo, void *p)
+{
     SDL_assert(pollNo < LITE3D_POOL_MAX);
+#ifdef LITE3D_WITH_MEMORY_STATS
+    if (p)
+    {
+        _alloc_header *header = stats_unregister(p);
+        SDL_assert(header->poolNo == pollNo);
+        p = header;
+    }
+#endif
+    nedpfree(globalMemPools[pollNo], p);
+}
 
-    if ((newmem = nedpmalloc(globalMemPools[pollNo], size)) == NULL)
+#ifdef LITE3D_WITH_MEMORY_STATS
+void *lite3d_malloc_track(size_t size, const char *file, int line)
+{
+    return stats_register(heap_malloc(LITE3D_ALLOC_HEADER + size), LITE3D_POOL_HEAP, size,
+        memory_current_tag(), file, line);
+}
+
+void *lite3d_calloc_track(size_t size, const char *file, int line)
+{
+    void *mem = NULL;
+    if ((mem = lite3d_malloc_track(size, file, line)) == NULL)
     {
-        SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION,
-            "%s: out of memory at pool %d, failed to allocate %lu bytes", LITE3D_CURRENT_FUNCTION, pollNo, size);
+        return NULL;
     }
 
-    return newmem;
+    memset(mem, 0, size);
+    return mem;
 }
 
-void *lite3d_calloc_pooled(uint8_t pollNo, size_t size)
+void *lite3d_malloc_pooled_track(uint8_t pollNo, size_t size, const char *file, int line)
+{
+    return stats_register(pool_malloc(pollNo, LITE3D_ALLOC_HEADER + size), pollNo, size,
+        memory_current_tag(), file, line);
+}
+
+void *lite3d_calloc_pooled_track(uint8_t pollNo, size_t size, const char *file, int line)
 {
     void *newmem = NULL;
-    if ((newmem = lite3d_malloc_pooled(pollNo, size)) == NULL)
+    if ((newmem = lite3d_malloc_pooled_track(pollNo, size, file, line)) == NULL)
     {
         return NULL;
     }
@@ -118,11 +542,139 @@ void *lite3d_calloc_pooled(uint8_t pollNo, size_t size)
     memset(newmem, 0, size);
     return newmem;
 }
+#endif
 
-void lite3d_free_pooled(uint8_t pollNo, void *p)
+int lite3d_memory_get_pool_stats(uint8_t poolNo, lite3d_memory_stats *stats)
 {
-    SDL_assert(pollNo < LITE3D_POOL_MAX);
-    nedpfree(globalMemPools[pollNo], p);
+#ifdef LITE3D_WITH_MEMORY_STATS
+    SDL_assert(stats);
+    if (poolNo > LITE3D_POOL_HEAP)
+        return LITE3D_FALSE;
+
+    SDL_AtomicLock(&gStatsLock);
+    counters_fill(&gPoolCounters[poolNo], stats);
+    SDL_AtomicUnlock(&gStatsLock);
+
+    if (poolNo < LITE3D_POOL_MAX && globalMemPools[poolNo])
+        stats->reservedBytes = nedpmalloc_footprint(globalMemPools[poolNo]);
+    return LITE3D_TRUE;
+#else
+    return LITE3D_FALSE;
+#endif
+}
+
+int lite3d_memory_get_tag_stats(uint8_t tag, lite3d_memory_stats *stats)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    SDL_assert(stats);
+    if (tag >= LITE3D_MEMORY_TAG_MAX)
+        return LITE3D_FALSE;
+
+    SDL_AtomicLock(&gStatsLock);
+    counters_fill(&gTagCounters[tag], stats);
+    SDL_AtomicUnlock(&gStatsLock);
+    return LITE3D_TRUE;
+#else
+    return LITE3D_FALSE;
+#endif
+}
+
+uint8_t lite3d_memory_set_tag(uint8_t tag)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    uint8_t prev = memory_current_tag();
+    SDL_assert(tag < LITE3D_MEMORY_TAG_MAX);
+    if (gMemoryTagTls)
+        SDL_TLSSet(gMemoryTagTls, (void *)(uintptr_t)tag, NULL);
+    return prev;
+#else
+    return LITE3D_MEMORY_TAG_DEFAULT;
+#endif
+}
+
+void lite3d_memory_track_leaks(int enable)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    SDL_AtomicLock(&gStatsLock);
+    gTrackLeaks = enable;
+    SDL_AtomicUnlock(&gStatsLock);
+#endif
+}
+
+void lite3d_memory_stats_frame(void)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    int i;
+#ifdef LITE3D_WITH_METRICS
+    static const char *poolMetrics[LITE3D_POOL_MAX + 1] = {
+        "memory_pool0_allocs", "memory_pool1_allocs", "memory_pool2_allocs",
+        "memory_pool3_allocs", "memory_pool4_allocs", "memory_pool5_allocs",
+        "memory_heap_allocs"
+    };
+    uint32_t frameAllocations[LITE3D_POOL_MAX + 1];
+#endif
+
+    SDL_AtomicLock(&gStatsLock);
+    for (i = 0; i <= LITE3D_POOL_HEAP; ++i)
+    {
+#ifdef LITE3D_WITH_METRICS
+        frameAllocations[i] = gPoolCounters[i].frameAllocations;
+#endif
+        gPoolCounters[i].lastFrameAllocations = gPoolCounters[i].frameAllocations;
+        gPoolCounters[i].frameAllocations = 0;
+    }
+
+    for (i = 0; i < LITE3D_MEMORY_TAG_MAX; ++i)
+    {
+        gTagCounters[i].lastFrameAllocations = gTagCounters[i].frameAllocations;
+        gTagCounters[i].frameAllocations = 0;
+    }
+    SDL_AtomicUnlock(&gStatsLock);
+
+#ifdef LITE3D_WITH_METRICS
+    /* Metrics lock nothing and allocate, so insert them outside of the stats lock */
+    for (i = 0; i <= LITE3D_POOL_HEAP; ++i)
+        lite3d_metrics_global_insert(poolMetrics[i], frameAllocations[i]);
+#endif
+#endif
+}
+
+void lite3d_memory_stats_write_to_log(void)
+{
+#ifdef LITE3D_WITH_MEMORY_STATS
+    int i;
+    char name[8];
+    lite3d_memory_stats stats;
+
+    SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%-6s %12s %12s %12s %12s %12s",
+        "POOL", "USED", "PEAK", "RESERVED", "ALLOCS", "FREES");
+    for (i = 0; i <= LITE3D_POOL_HEAP; ++i)
+    {
+        lite3d_memory_get_pool_stats((uint8_t)i, &stats);
+        if (i == LITE3D_POOL_HEAP)
+            SDL_strlcpy(name, "heap", sizeof(name));
+        else
+            SDL_snprintf(name, sizeof(name), "%d", i);
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%-6s %12lu %12lu %12lu %12llu %12llu",
+            name, (unsigned long)stats.usedBytes,
+            (unsigned long)stats.peakBytes, (unsigned long)stats.reservedBytes,
+            (unsigned long long)stats.allocations, (unsigned long long)stats.frees);
+    }
+
+    SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%-6s %12s %12s %12s %12s",
+        "TAG", "USED", "PEAK", "ALLOCS", "FREES");
+    for (i = 0; i < LITE3D_MEMORY_TAG_MAX; ++i)
+    {
+        lite3d_memory_get_tag_stats((uint8_t)i, &stats);
+        if (stats.allocations == 0)
+            continue;
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%-6d %12lu %12lu %12llu %12llu",
+            i, (unsigned long)stats.usedBytes, (unsigned long)stats.peakBytes,
+            (unsigned long long)stats.allocations, (unsigned long long)stats.frees);
+    }
+#endif
 }
 
 char *lite3d_strdup(const char *str)
@@ -136,3 +688,68 @@ char *lite3d_strdup(const char *str)
     strcpy(strmem, str);
     return strmem;
 }
+
+void *lite3d_frame_alloc(size_t size)
+{
+    _frame_arena *arena;
+    _frame_arena_block **head;
+    int32_t frameNo = SDL_AtomicGet(&gFrameNo);
+    void *mem;
+
+    if (!(arena = frame_arena_get()))
+        return NULL;
+
+    head = &arena->blocks[frameNo & 1];
+    /* First allocation in the new frame, data of the frame before previous is not needed anymore */
+    if (arena->frameNo != frameNo)
+    {
+        frame_arena_reset(head);
+        arena->frameNo = frameNo;
+    }
+
+    size = LITE3D_ALIGN_SIZE(size, LITE3D_FRAME_ARENA_ALIGN);
+    if (!*head || (*head)->used + size > (*head)->size)
+    {
+        size_t blockSize = *head ? (*head)->size << 1 : LITE3D_FRAME_ARENA_BLOCK;
+        _frame_arena_block *block = frame_arena_new_block(LITE3D_MAX(blockSize, size), *head);
+        if (!block)
+            return NULL;
+
+        *head = block;
+    }
+
+    mem = (char *)(*head) + LITE3D_FRAME_ARENA_HEADER + (*head)->used;
+    (*head)->used += size;
+    SDL_AtomicAdd(&gFrameBytes, (int)size);
+    return mem;
+}
+
+void *lite3d_frame_calloc(size_t size)
+{
+    void *mem = NULL;
+    if ((mem = lite3d_frame_alloc(size)) == NULL)
+    {
+        return NULL;
+    }
+
+    memset(mem, 0, size);
+    return mem;
+}
+
+void lite3d_frame_arena_next(void)
+{
+    gLastFrameBytes = (size_t)SDL_AtomicSet(&gFrameBytes, 0);
+    gFrameHighWater = LITE3D_MAX(gFrameHighWater, gLastFrameBytes);
+    SDL_AtomicIncRef(&gFrameNo);
+}
+
+void lite3d_frame_arena_get_stats(lite3d_frame_arena_stats *stats)
+{
+    SDL_assert(stats);
+    stats->frameNo = SDL_AtomicGet(&gFrameNo);
+    stats->frameBytes = (size_t)SDL_AtomicGet(&gFrameBytes);
+    stats->lastFrameBytes = gLastFrameBytes;
+    stats->highWaterBytes = LITE3D_MAX(gFrameHighWater, stats->frameBytes);
+    stats->reservedBytes = (size_t)SDL_AtomicGet(&gFrameReserved);
+    stats->heapAllocations = SDL_AtomicGet(&gFrameHeapAllocations);
+}
@@ -23,18 +23,124 @@
 #include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_array.h>
 
+static int array_set_capacity(lite3d_array *a, size_t capacity)
+{
+    void *pnew;
+    SDL_assert(capacity >= a->size);
+
+    if (capacity == a->capacity)
+        return LITE3D_TRUE;
+
+    /* Elements fit into the inline storage, move back */
+    if (a->inlineData && capacity <= a->inlineCapacity)
+    {
+        if (a->data != a->inlineData)
+        {
+            memcpy(a->inlineData, a->data, a->size * a->elemSize);
+            lite3d_free(a->data);
+            a->data = a->inlineData;
+            a->capacity = a->inlineCapacity;
+        }
+
+        return LITE3D_TRUE;
+    }
+
+    /* Old block stays in the arena until the frame is over */
+    if (a->frameData)
+    {
+        if (!(pnew = lite3d_frame_alloc(LITE3D_MAX(capacity, 1) * a->elemSize)))
+            return LITE3D_FALSE;
+
+        if (a->size)
+            memcpy(pnew, a->data, a->size * a->elemSize);
+
+        a->data = pnew;
+        a->capacity = capacity;
+        return LITE3D_TRUE;
+    }
+
+    if (capacity == 0)
+    {
+        lite3d_free(a->data);
+        a->data = NULL;
+        a->capacity = 0;
+        return LITE3D_TRUE;
+    }
+
+    if (a->data && a->data != a->inlineData)
+    {
+        /* Try to grow in place first */
+        if ((pnew = lite3d_realloc(a->data, capacity * a->elemSize)) != NULL)
+        {
+            a->data = pnew;
+            a->capacity = capacity;
+            return LITE3D_TRUE;
+        }
+    }
+
+    if (!(pnew = lite3d_malloc(capacity * a->elemSize)))
+        return LITE3D_FALSE;
+
+    if (a->size)
+        memcpy(pnew, a->data, a->size * a->elemSize);
+    if (a->data != a->inlineData)
+        lite3d_free(a->data);
+
+    a->data = pnew;
+    a->capacity = capacity;
+    return LITE3D_TRUE;
+}
+
+static int array_grow(lite3d_array *a, size_t required)
+{
+    size_t capacity = a->capacity ? a->capacity : 1;
+    while (capacity < required)
+        capacity <<= 1;
+
+    return array_set_capacity(a, capacity);
+}
+
 void lite3d_array_init(lite3d_array *a, size_t elemSize, size_t capacity)
 {
     SDL_assert(a);
+    memset(a, 0, sizeof(lite3d_array));
+    a->elemSize = elemSize;
+
     if (!capacity)
         return;
 
     a->data = lite3d_malloc(elemSize * capacity);
     SDL_assert_release(a->data);
+    a->capacity = capacity;
+}
+
+void lite3d_array_init_inline(lite3d_array *a, size_t elemSize, void *storage, size_t capacity)
+{
+    SDL_assert(a);
+    SDL_assert(storage);
 
+    a->data = a->inlineData = storage;
+    a->capacity = a->inlineCapacity = capacity;
     a->elemSize = elemSize;
     a->size = 0;
+    a->frameData = LITE3D_FALSE;
+}
+
+int lite3d_array_init_frame(lite3d_array *a, size_t elemSize, size_t capacity)
+{
+    SDL_assert(a);
+    memset(a, 0, sizeof(lite3d_array));
+    a->elemSize = elemSize;
+    a->frameData = LITE3D_TRUE;
+
+    if (!capacity)
+        return LITE3D_TRUE;
+
+    if (!(a->data = lite3d_frame_alloc(elemSize * capacity)))
+        return LITE3D_FALSE;
+
     a->capacity = capacity;
+    return LITE3D_TRUE;
 }
 
 void lite3d_array_clean(lite3d_array *a)
@@ -47,34 +153,56 @@ void lite3d_array_purge(lite3d_array *a)
 {
     SDL_assert(a);
 
-    lite3d_free(a->data);
+    if (a->data != a->inlineData && !a->frameData)
+        lite3d_free(a->data);
+
+    a->data = a->inlineData;
+    a->capacity = a->inlineCapacity;
+    a->size = 0;
+}
+
+int lite3d_array_reserve(lite3d_array *a, size_t capacity)
+{
+    SDL_assert(a);
+    if (capacity <= a->capacity)
+        return LITE3D_TRUE;
 
-    a->data = NULL;
-    a->capacity = a->size = 0;
+    return array_set_capacity(a, capacity);
+}
+
+int lite3d_array_shrink(lite3d_array *a)
+{
+    SDL_assert(a);
+    return array_set_capacity(a, a->size);
 }
 
 void *lite3d_array_add(lite3d_array *a)
 {
     SDL_assert(a);
     /* Is it necessary to expand the array? */
-    if (a->size == a->capacity)
-    {
-        void *pnew;
-        size_t s = a->capacity << 1;
-        
-        if (!(pnew = lite3d_malloc(s * a->elemSize)))
-            return NULL;
-
-        memcpy(pnew, a->data, a->size * a->elemSize);
-        lite3d_free(a->data);
-        a->data = pnew;
-        a->capacity = s;
-    }
+    if (a->size == a->capacity && !array_grow(a, a->size + 1))
+        return NULL;
 
     a->size++;
     return lite3d_array_get(a, a->size - 1);
 }
 
+void *lite3d_array_append(lite3d_array *a, const void *data, size_t count)
+{
+    void *first;
+    SDL_assert(a);
+
+    if (a->size + count > a->capacity && !array_grow(a, a->size + count))
+        return NULL;
+
+    first = ((char *) a->data) + (a->size * a->elemSize);
+    if (data && count)
+        memcpy(first, data, count * a->elemSize);
+
+    a->size += count;
+    return first;
+}
+
 void *lite3d_array_get(lite3d_array *a, size_t index)
 {
     SDL_assert(a);
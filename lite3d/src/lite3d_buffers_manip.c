@@ -19,6 +19,7 @@
 #include <SDL_log.h>
 #include <lite3d/lite3d_gl.h>
 #include <lite3d/lite3d_glext.h>
+#include <lite3d/lite3d_gl_state.h>
 
 #include <lite3d/lite3d_buffers_manip.h>
 
@@ -49,6 +50,7 @@ static GLenum cullfaceModeEnum[] = {
 
 void lite3d_depth_test(uint8_t on)
 {
+    lite3d_gl_state_count_state(on != gDepthTestOn);
     if (on != gDepthTestOn)
     {
         on == LITE3D_TRUE ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
@@ -58,6 +60,7 @@ void lite3d_depth_test(uint8_t on)
 
 void lite3d_depth_test_func(uint8_t func)
 {
+    lite3d_gl_state_count_state(func != gDeptTestFunc);
     if (func != gDeptTestFunc)
     {
         glDepthFunc(testFuncEnum[func]);
@@ -67,6 +70,7 @@ void lite3d_depth_test_func(uint8_t func)
 
 void lite3d_stencil_test(uint8_t on)
 {
+    lite3d_gl_state_count_state(on != gStencilTestOn);
     if (on != gStencilTestOn)
     {
         on == LITE3D_TRUE ? glEnable(GL_STENCIL_TEST) : glDisable(GL_STENCIL_TEST);
@@ -81,6 +85,7 @@ void lite3d_stencil_test_func(uint8_t func, int32_t refValue)
 
 void lite3d_depth_output(uint8_t on)
 {
+    lite3d_gl_state_count_state(on != gDepthOutOn);
     if (on != gDepthOutOn)
     {
         glDepthMask(on == LITE3D_TRUE ? GL_TRUE : GL_FALSE);
@@ -95,6 +100,7 @@ uint8_t lite3d_depth_output_get(void)
 
 void lite3d_color_output(uint8_t on)
 {
+    lite3d_gl_state_count_state(on != gColorOutOn);
     if (on != gColorOutOn)
     {
         if (on)
@@ -108,6 +114,7 @@ void lite3d_color_output(uint8_t on)
 
 void lite3d_stencil_output(uint8_t on)
 {
+    lite3d_gl_state_count_state(on != gStencilOutOn);
     if (on != gStencilOutOn)
     {
         glStencilMask(on == LITE3D_TRUE ? 0xFF : 0x00);
@@ -188,6 +195,7 @@ static void blending_mode_rgba_linear_source_alpha(void)
 
 void lite3d_blending(uint8_t on)
 {
+    lite3d_gl_state_count_state(on != gBlendingOn);
     if (on != gBlendingOn)
     {
         on == LITE3D_TRUE ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
@@ -205,6 +213,7 @@ void lite3d_blending_mode_set(uint8_t mode)
 {
     SDL_assert(mode < (sizeof(gBlendModes)/sizeof(lite3d_blend_mode_t)));
 
+    lite3d_gl_state_count_state(mode != gBlendigMode);
     if (mode != gBlendigMode)
     {
         gBlendModes[mode]();
@@ -216,6 +225,7 @@ void lite3d_polygon_mode(uint8_t mode)
 {
     /* In OpenGL ES, GL_FILL is the only available polygon mode. */
 #ifndef GLES
+    lite3d_gl_state_count_state(gPolygonMode != mode);
     if (gPolygonMode != mode)
     {
         glPolygonMode(GL_FRONT_AND_BACK, polygonModeEnum[mode]);
@@ -228,6 +238,7 @@ void lite3d_polygon_mode(uint8_t mode)
 
 void lite3d_backface_culling(uint8_t mode)
 {
+    lite3d_gl_state_count_state(gBackFaceCullingOn != mode);
     if (gBackFaceCullingOn != mode)
     {
         if (mode != LITE3D_CULLFACE_NEVER)
@@ -16,6 +16,8 @@
  *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
  *******************************************************************************/
 #include <string.h>
+#include <float.h>
+#include <math.h>
 #include <SDL_assert.h>
 
 #include <lite3d/lite3d_gl.h>
@@ -269,6 +271,26 @@ float lite3d_camera_distance(const lite3d_camera *camera,
     return kmVec3Length(&pointDir);
 }
 
+float lite3d_camera_projected_radius(const lite3d_camera *camera, 
+    const kmVec3 *center, float radius)
+{
+    float distance;
+    SDL_assert(camera);
+    SDL_assert(center);
+
+    /* mat[5] - масштаб по вертикали: 2 / (top - bottom) для ortho, ctg(fovy / 2) для perspective */
+    if (camera->isOrtho)
+        return radius * camera->projectionMatrix.mat[5] * 0.5f;
+
+    distance = lite3d_camera_distance(camera, center);
+    if (distance <= radius)
+        return FLT_MAX;
+
+    /* угловой радиус сферы, а не радиус/расстояние, иначе вблизи размер занижается */
+    return radius / sqrtf(distance * distance - radius * radius) * 
+        camera->projectionMatrix.mat[5] * 0.5f;
+}
+
 void lite3d_camera_world_direction(const lite3d_camera *camera, kmVec3 *vec)
 {
     kmMat3 worldRotation;
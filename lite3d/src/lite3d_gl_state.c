@@ -0,0 +1,258 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <string.h>
+#include <SDL_assert.h>
+
+#include <lite3d/lite3d_gl.h>
+#include <lite3d/lite3d_gl_state.h>
+
+#define UNKNOWN_ID 0xffffffff
+
+typedef struct texture_binding
+{
+    uint32_t target;
+    uint32_t textureID;
+} texture_binding;
+
+static void gl_active_texture(uint32_t unit)
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+static void gl_bind_texture(uint32_t target, uint32_t textureID)
+{
+    glBindTexture(target, textureID);
+}
+
+static void gl_bind_buffer_base(uint8_t kind, uint32_t index, uint32_t bufferID)
+{
+#ifndef GLES
+    if (kind == LITE3D_GL_STATE_BUFFER_STORAGE)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, bufferID);
+        return;
+    }
+#endif
+#ifndef WITH_GLES2
+    if (kind == LITE3D_GL_STATE_BUFFER_UNIFORM)
+    {
+        glBindBufferBase(GL_UNIFORM_BUFFER, index, bufferID);
+    }
+#endif
+}
+
+static const lite3d_gl_state_backend gGLBackend = {
+    gl_active_texture,
+    gl_bind_texture,
+    gl_bind_buffer_base
+};
+
+static lite3d_gl_state_backend gBackend = {
+    gl_active_texture,
+    gl_bind_texture,
+    gl_bind_buffer_base
+};
+
+static int32_t gActiveUnit = -1;
+static texture_binding gTextures[LITE3D_GL_STATE_TEXTURE_UNITS_MAX];
+static uint32_t gBuffers[2][LITE3D_GL_STATE_BUFFER_BINDINGS_MAX];
+static uint8_t gStateValid = LITE3D_FALSE;
+static lite3d_gl_state_stats gStats;
+
+static void gl_state_check(void)
+{
+    if (!gStateValid)
+        lite3d_gl_state_invalidate();
+}
+
+void lite3d_gl_state_set_backend(const lite3d_gl_state_backend *backend)
+{
+    gBackend = backend ? *backend : gGLBackend;
+    lite3d_gl_state_invalidate();
+}
+
+void lite3d_gl_state_invalidate(void)
+{
+    int i;
+
+    gActiveUnit = -1;
+    for (i = 0; i < LITE3D_GL_STATE_TEXTURE_UNITS_MAX; ++i)
+    {
+        gTextures[i].target = 0;
+        gTextures[i].textureID = UNKNOWN_ID;
+    }
+
+    for (i = 0; i < LITE3D_GL_STATE_BUFFER_BINDINGS_MAX; ++i)
+    {
+        gBuffers[LITE3D_GL_STATE_BUFFER_UNIFORM][i] = UNKNOWN_ID;
+        gBuffers[LITE3D_GL_STATE_BUFFER_STORAGE][i] = UNKNOWN_ID;
+    }
+
+    gStateValid = LITE3D_TRUE;
+}
+
+static void gl_state_active_texture(uint16_t unit)
+{
+    if (gActiveUnit != unit)
+    {
+        gBackend.activeTexture(unit);
+        gActiveUnit = unit;
+    }
+}
+
+void lite3d_gl_state_bind_texture(uint16_t unit, uint32_t target, uint32_t textureID)
+{
+    gl_state_check();
+
+    if (unit >= LITE3D_GL_STATE_TEXTURE_UNITS_MAX)
+    {
+        gl_state_active_texture(unit);
+        gBackend.bindTexture(target, textureID);
+        gStats.textureBinds++;
+        return;
+    }
+
+    if (gTextures[unit].target == target && gTextures[unit].textureID == textureID)
+    {
+        gStats.textureBindsAvoided++;
+        return;
+    }
+
+    gl_state_active_texture(unit);
+    gBackend.bindTexture(target, textureID);
+    gTextures[unit].target = target;
+    gTextures[unit].textureID = textureID;
+    gStats.textureBinds++;
+}
+
+void lite3d_gl_state_bind_texture_active(uint32_t target, uint32_t textureID)
+{
+    gl_state_check();
+
+    if (gActiveUnit < 0 || gActiveUnit >= LITE3D_GL_STATE_TEXTURE_UNITS_MAX)
+    {
+        gBackend.bindTexture(target, textureID);
+        return;
+    }
+
+    lite3d_gl_state_bind_texture((uint16_t)gActiveUnit, target, textureID);
+}
+
+void lite3d_gl_state_bind_buffer_base(uint8_t kind, uint32_t index, uint32_t bufferID)
+{
+    SDL_assert(kind <= LITE3D_GL_STATE_BUFFER_STORAGE);
+    gl_state_check();
+
+    if (index < LITE3D_GL_STATE_BUFFER_BINDINGS_MAX)
+    {
+        if (gBuffers[kind][index] == bufferID)
+        {
+            gStats.bufferBindsAvoided++;
+            return;
+        }
+
+        gBuffers[kind][index] = bufferID;
+    }
+
+    gBackend.bindBufferBase(kind, index, bufferID);
+    gStats.bufferBinds++;
+}
+
+void lite3d_gl_state_forget_texture(uint32_t textureID)
+{
+    int i;
+    for (i = 0; i < LITE3D_GL_STATE_TEXTURE_UNITS_MAX; ++i)
+    {
+        if (gTextures[i].textureID == textureID)
+            gTextures[i].textureID = UNKNOWN_ID;
+    }
+}
+
+void lite3d_gl_state_forget_buffer(uint32_t bufferID)
+{
+    int i;
+    for (i = 0; i < LITE3D_GL_STATE_BUFFER_BINDINGS_MAX; ++i)
+    {
+        if (gBuffers[LITE3D_GL_STATE_BUFFER_UNIFORM][i] == bufferID)
+            gBuffers[LITE3D_GL_STATE_BUFFER_UNIFORM][i] = UNKNOWN_ID;
+        if (gBuffers[LITE3D_GL_STATE_BUFFER_STORAGE][i] == bufferID)
+            gBuffers[LITE3D_GL_STATE_BUFFER_STORAGE][i] = UNKNOWN_ID;
+    }
+}
+
+int lite3d_gl_state_uniform_changed(lite3d_array *cache, int32_t location,
+    const void *value, size_t size)
+{
+    lite3d_gl_uniform_value *cached;
+    SDL_assert(cache);
+    SDL_assert(value);
+
+    if (location < 0 || location >= LITE3D_GL_STATE_UNIFORM_LOCATION_MAX ||
+        size == 0 || size > LITE3D_GL_STATE_UNIFORM_VALUE_MAX)
+    {
+        gStats.uniforms++;
+        return LITE3D_TRUE;
+    }
+
+    if (cache->elemSize == 0)
+        lite3d_array_init(cache, sizeof(lite3d_gl_uniform_value), 16);
+
+    if ((size_t)location >= cache->size)
+    {
+        size_t count = location + 1 - cache->size;
+        lite3d_gl_uniform_value *added = lite3d_array_append(cache, NULL, count);
+        if (!added)
+        {
+            gStats.uniforms++;
+            return LITE3D_TRUE;
+        }
+
+        memset(added, 0, count * sizeof(lite3d_gl_uniform_value));
+    }
+
+    cached = lite3d_array_get(cache, location);
+    if (cached->size == size && memcmp(cached->value, value, size) == 0)
+    {
+        gStats.uniformsAvoided++;
+        return LITE3D_FALSE;
+    }
+
+    cached->size = (uint8_t)size;
+    memcpy(cached->value, value, size);
+    gStats.uniforms++;
+    return LITE3D_TRUE;
+}
+
+void lite3d_gl_state_count_state(uint8_t applied)
+{
+    if (applied)
+        gStats.stateChanges++;
+    else
+        gStats.stateChangesAvoided++;
+}
+
+void lite3d_gl_state_get_stats(lite3d_gl_state_stats *stats)
+{
+    SDL_assert(stats);
+    *stats = gStats;
+}
+
+void lite3d_gl_state_stats_reset(void)
+{
+    memset(&gStats, 0, sizeof(gStats));
+}
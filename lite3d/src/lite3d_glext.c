@@ -393,6 +393,17 @@ int lite3d_check_compute_shader(void)
 #endif
 }
 
+int lite3d_check_copy_image(void)
+{
+#if defined(WITH_GLES2) || defined(WITH_GLES3) || defined(WITH_GLES31)
+    return LITE3D_FALSE;
+#elif defined(WITH_GLES32)
+    return LITE3D_TRUE;
+#else
+    return GLEW_ARB_copy_image || GLEW_VERSION_4_3;
+#endif
+}
+
 #ifdef __GNUC__
 #   pragma GCC diagnostic push
 #   pragma GCC diagnostic ignored "-Wpedantic"
@@ -766,3 +777,12 @@ void glGetIntegeri_v_stub(GLenum target, GLuint index, GLint *data)
         "%s: glGetIntegeri_v is not supported..", LITE3D_CURRENT_FUNCTION);
     lite3d_misc_gl_set_not_supported();
 }
+
+void glCopyImageSubData_stub(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+    GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+    GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth)
+{
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+        "%s: glCopyImageSubData is not supported..", LITE3D_CURRENT_FUNCTION);
+    lite3d_misc_gl_set_not_supported();
+}
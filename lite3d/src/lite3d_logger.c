@@ -18,25 +18,77 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <signal.h>
 
 #include <SDL_log.h>
+#include <SDL_assert.h>
 #include <SDL_timer.h>
+#include <SDL_atomic.h>
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
 
+#ifdef PLATFORM_Windows
+#include <io.h>
+#define log_write_fd(fd, buf, len)  _write(fd, buf, (unsigned int)(len))
+#else
+#include <unistd.h>
+#define log_write_fd(fd, buf, len)  write(fd, buf, len)
+#endif
+
+#include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_logger.h>
 #include <lite3d/lite3d_mesh_assimp_loader.h>
 
+#define LOG_YIELD_WAITS             100
+/* "[ticks]:priority:category : " prefix and line end */
+#define LOG_LINE_MAX                (SDL_MAX_LOG_MESSAGE + 64)
+#define LOG_STDOUT_FD               1
+#define LOG_STDERR_FD               2
+
+typedef struct log_slot
+{
+    /* equal to position when slot is free, position + 1 when message is ready */
+    SDL_atomic_t sequence;
+    SDL_LogPriority priority;
+    /* formatted by producer, crash handler writes it as is */
+    size_t length;
+    char line[LOG_LINE_MAX];
+} log_slot;
+
+typedef struct log_queue
+{
+    log_slot *slots;
+    uint32_t mask;
+    int overflowPolicy;
+    SDL_atomic_t enqueuePos;
+    /* changed by writer thread only */
+    SDL_atomic_t dequeuePos;
+    SDL_atomic_t running;
+    SDL_atomic_t writerSleeping;
+    SDL_sem *wake;
+    SDL_Thread *writer;
+} log_queue;
+
 static int gFlushAlways = LITE3D_FALSE;
 static FILE *gOutFile = NULL;
+static int gOutFd = -1;
 static int gMuteStd = LITE3D_FALSE;
+static log_queue gQueue;
+static SDL_atomic_t gAsync;
+static SDL_atomic_t gQueued;
+static SDL_atomic_t gWritten;
+static SDL_atomic_t gDropped;
+static SDL_atomic_t gBlocked;
+/* producers inside async output function, queue memory is released when none left */
+static SDL_atomic_t gProducers;
+static const int gCrashSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+static void (*gPrevSignalHandlers[sizeof(gCrashSignals) / sizeof(gCrashSignals[0])])(int);
 
-static void log_to_file(FILE *desc, int category,
+static size_t log_format(char *line, uint32_t ticks, int category,
     SDL_LogPriority priority, const char* message)
 {
-    if (!desc)
-        return;
-
-    fprintf(desc, "[%10d]:%s:%s : %s\n",
-        SDL_GetTicks(),
+    int length = SDL_snprintf(line, LOG_LINE_MAX, "[%10d]:%s:%s : %s\n",
+        ticks,
         (priority == SDL_LOG_PRIORITY_VERBOSE ? "note" :
         (priority == SDL_LOG_PRIORITY_DEBUG ? "debug" :
         (priority == SDL_LOG_PRIORITY_INFO ? "info" :
@@ -45,28 +97,230 @@ static void log_to_file(FILE *desc, int category,
         category == SDL_LOG_CATEGORY_APPLICATION ? "app" : "sdl",
         message);
 
-    if (gFlushAlways)
-        fflush(desc);
+    if (length < 0)
+        return 0;
+    if (length >= LOG_LINE_MAX)
+    {
+        /* keep line end on truncated line */
+        line[LOG_LINE_MAX - 2] = '\n';
+        return LOG_LINE_MAX - 1;
+    }
+
+    return (size_t)length;
 }
 
-static void std_output_function(void* userdata, int category,
+static void log_flush_outputs(void)
+{
+    if (!gMuteStd)
+    {
+        fflush(stdout);
+        fflush(stderr);
+    }
+
+    if (gOutFile)
+        fflush(gOutFile);
+}
+
+static void log_line(SDL_LogPriority priority, const char *line, size_t length)
+{
+    if (!gMuteStd)
+        fwrite(line, 1, length, priority >= SDL_LOG_PRIORITY_ERROR ? stderr : stdout);
+    if (gOutFile)
+        fwrite(line, 1, length, gOutFile);
+}
+
+static void sync_output_function(void* userdata, int category,
     SDL_LogPriority priority, const char* message)
 {
-    FILE *outdesc = stdout;
-    if (gMuteStd)
-        return;
+    char line[LOG_LINE_MAX];
+    log_line(priority, line, log_format(line, SDL_GetTicks(), category, priority, message));
+    if (gFlushAlways)
+        log_flush_outputs();
+}
 
-    if (priority >= SDL_LOG_PRIORITY_ERROR)
-        outdesc = stderr;
+static void log_queue_wake_writer(void)
+{
+    if (SDL_AtomicCAS(&gQueue.writerSleeping, 1, 0))
+        SDL_SemPost(gQueue.wake);
+}
 
-    log_to_file(outdesc, category, priority, message);
+static int log_queue_push(int category, SDL_LogPriority priority, const char* message)
+{
+    log_slot *slot;
+    uint32_t pos = (uint32_t)SDL_AtomicGet(&gQueue.enqueuePos);
+    int waits = 0;
+
+    for (;;)
+    {
+        int32_t diff;
+        slot = &gQueue.slots[pos & gQueue.mask];
+        diff = (int32_t)((uint32_t)SDL_AtomicGet(&slot->sequence) - pos);
+
+        if (diff == 0)
+        {
+            /* slot is free, try to reserve it */
+            if (SDL_AtomicCAS(&gQueue.enqueuePos, (int)pos, (int)(pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* queue is full */
+            if (gQueue.overflowPolicy == LITE3D_LOG_OVERFLOW_DROP || !SDL_AtomicGet(&gQueue.running))
+            {
+                SDL_AtomicIncRef(&gDropped);
+                return LITE3D_FALSE;
+            }
+
+            if (!waits)
+                SDL_AtomicIncRef(&gBlocked);
+
+            log_queue_wake_writer();
+            /* writer usually frees slots soon, yield first, sleep later */
+            SDL_Delay(waits++ < LOG_YIELD_WAITS ? 0 : 1);
+        }
+
+        pos = (uint32_t)SDL_AtomicGet(&gQueue.enqueuePos);
+    }
+
+    slot->priority = priority;
+    slot->length = log_format(slot->line, SDL_GetTicks(), category, priority, message);
+    /* publish message */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&slot->sequence, (int)(pos + 1));
+    SDL_AtomicIncRef(&gQueued);
+
+    if (SDL_AtomicGet(&gQueue.writerSleeping))
+        log_queue_wake_writer();
+    return LITE3D_TRUE;
+}
+
+static int log_queue_ready(void)
+{
+    uint32_t pos = (uint32_t)SDL_AtomicGet(&gQueue.dequeuePos);
+    log_slot *slot = &gQueue.slots[pos & gQueue.mask];
+    return (uint32_t)SDL_AtomicGet(&slot->sequence) == pos + 1;
+}
+
+static int log_queue_pop(void)
+{
+    uint32_t pos = (uint32_t)SDL_AtomicGet(&gQueue.dequeuePos);
+    log_slot *slot = &gQueue.slots[pos & gQueue.mask];
+
+    if ((uint32_t)SDL_AtomicGet(&slot->sequence) != pos + 1)
+        return LITE3D_FALSE;
+
+    SDL_MemoryBarrierAcquire();
+    log_line(slot->priority, slot->line, slot->length);
+    /* slot is free for the next round */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&slot->sequence, (int)(pos + gQueue.mask + 1));
+    SDL_AtomicSet(&gQueue.dequeuePos, (int)(pos + 1));
+    SDL_AtomicIncRef(&gWritten);
+    return LITE3D_TRUE;
+}
+
+static int log_writer_thread(void *userdata)
+{
+    for (;;)
+    {
+        int written = 0;
+        while (log_queue_pop())
+            written++;
+
+        /* flush by batches, not every line */
+        if (written && gFlushAlways)
+            log_flush_outputs();
+
+        if (!SDL_AtomicGet(&gQueue.running))
+            break;
+
+        SDL_AtomicSet(&gQueue.writerSleeping, 1);
+        /* message could be published before the flag was set */
+        if (!log_queue_ready())
+            SDL_SemWaitTimeout(gQueue.wake, 100);
+        SDL_AtomicSet(&gQueue.writerSleeping, 0);
+    }
+
+    log_flush_outputs();
+    return 0;
 }
 
-static void file_output_function(void* userdata, int category,
+static void async_output_function(void* userdata, int category,
     SDL_LogPriority priority, const char* message)
 {
-    std_output_function(userdata, category, priority, message);
-    log_to_file(gOutFile, category, priority, message);
+    SDL_AtomicIncRef(&gProducers);
+    /* logger is stopping, queue may be released as soon as producers counter drops */
+    if (SDL_AtomicGet(&gQueue.running))
+        log_queue_push(category, priority, message);
+    else
+        sync_output_function(userdata, category, priority, message);
+    SDL_AtomicAdd(&gProducers, -1);
+}
+
+/* wait until writer passes given position */
+static int log_queue_wait(uint32_t target)
+{
+    while ((int32_t)((uint32_t)SDL_AtomicGet(&gQueue.dequeuePos) - target) < 0)
+    {
+        if (!SDL_AtomicGet(&gQueue.running))
+            return LITE3D_FALSE;
+
+        log_queue_wake_writer();
+        SDL_Delay(1);
+    }
+
+    return LITE3D_TRUE;
+}
+
+static void log_crash_write(int fd, const char *line, size_t length)
+{
+    while (length > 0)
+    {
+        int written = (int)log_write_fd(fd, line, length);
+        if (written <= 0)
+            return;
+        line += written;
+        length -= (size_t)written;
+    }
+}
+
+/* 
+ * Only async-signal-safe calls here: lines not taken by writer yet are already formatted,
+ * they are written to descriptors directly. Lines buffered by stdio are lost.
+ */
+static void log_crash_handler(int sig)
+{
+    size_t i;
+
+    if (SDL_AtomicGet(&gAsync) && SDL_AtomicGet(&gQueue.running))
+    {
+        uint32_t pos = (uint32_t)SDL_AtomicGet(&gQueue.dequeuePos);
+        uint32_t end = (uint32_t)SDL_AtomicGet(&gQueue.enqueuePos);
+
+        for (; pos != end; ++pos)
+        {
+            log_slot *slot = &gQueue.slots[pos & gQueue.mask];
+            if ((uint32_t)SDL_AtomicGet(&slot->sequence) != pos + 1)
+                continue;
+
+            if (!gMuteStd)
+                log_crash_write(slot->priority >= SDL_LOG_PRIORITY_ERROR ? LOG_STDERR_FD : LOG_STDOUT_FD,
+                    slot->line, slot->length);
+            if (gOutFd >= 0)
+                log_crash_write(gOutFd, slot->line, slot->length);
+        }
+    }
+
+    for (i = 0; i < sizeof(gCrashSignals) / sizeof(gCrashSignals[0]); ++i)
+    {
+        if (gCrashSignals[i] == sig)
+        {
+            signal(sig, gPrevSignalHandlers[i] != SIG_ERR ? gPrevSignalHandlers[i] : SIG_DFL);
+            break;
+        }
+    }
+
+    raise(sig);
 }
 
 void lite3d_logger_set_logParams(int level, int flushAlways, int muteStd)
@@ -83,7 +337,7 @@ void lite3d_logger_set_logParams(int level, int flushAlways, int muteStd)
 
 static void lite3d_logger_setup_stdout(void)
 {
-    SDL_LogSetOutputFunction(std_output_function, NULL);
+    SDL_LogSetOutputFunction(sync_output_function, NULL);
 
 #ifdef INCLUDE_ASSIMP
     lite3d_assimp_logging_init();
@@ -93,10 +347,16 @@ static void lite3d_logger_setup_stdout(void)
 
 static void lite3d_logger_setup_file(const char *logfile)
 {
-    SDL_LogSetOutputFunction(file_output_function, NULL);
+    SDL_LogSetOutputFunction(sync_output_function, NULL);
     if ((gOutFile = fopen(logfile, "a")) == NULL)
         SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: Could not open log file: %s",
         LITE3D_CURRENT_FUNCTION, strerror(errno));
+    else
+#ifdef PLATFORM_Windows
+        gOutFd = _fileno(gOutFile);
+#else
+        gOutFd = fileno(gOutFile);
+#endif
 
 #ifdef INCLUDE_ASSIMP
     lite3d_assimp_logging_init();
@@ -114,16 +374,110 @@ void lite3d_logger_setup(const char *logfile)
     lite3d_logger_setup_stdout();
 }
 
+int lite3d_logger_start_async(uint32_t queueSize, int overflowPolicy)
+{
+    uint32_t capacity = 1, i;
+
+    if (SDL_AtomicGet(&gAsync))
+        return LITE3D_TRUE;
+
+    if (!queueSize)
+        queueSize = LITE3D_LOG_QUEUE_DEFAULT;
+    while (capacity < queueSize)
+        capacity <<= 1;
+
+    memset(&gQueue, 0, sizeof(gQueue));
+    if ((gQueue.slots = (log_slot *)lite3d_malloc(capacity * sizeof(log_slot))) == NULL)
+        return LITE3D_FALSE;
+
+    for (i = 0; i < capacity; ++i)
+        SDL_AtomicSet(&gQueue.slots[i].sequence, (int)i);
+
+    gQueue.mask = capacity - 1;
+    gQueue.overflowPolicy = overflowPolicy;
+    SDL_AtomicSet(&gQueue.running, 1);
+
+    if ((gQueue.wake = SDL_CreateSemaphore(0)) == NULL ||
+        (gQueue.writer = SDL_CreateThread(log_writer_thread, "lite3d_logger", NULL)) == NULL)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: Could not start log writer: %s",
+            LITE3D_CURRENT_FUNCTION, SDL_GetError());
+        if (gQueue.wake)
+            SDL_DestroySemaphore(gQueue.wake);
+        lite3d_free(gQueue.slots);
+        memset(&gQueue, 0, sizeof(gQueue));
+        return LITE3D_FALSE;
+    }
+
+    for (i = 0; i < sizeof(gCrashSignals) / sizeof(gCrashSignals[0]); ++i)
+        gPrevSignalHandlers[i] = signal(gCrashSignals[i], log_crash_handler);
+
+    SDL_AtomicSet(&gAsync, 1);
+    SDL_LogSetOutputFunction(async_output_function, NULL);
+    return LITE3D_TRUE;
+}
+
+static void lite3d_logger_stop_async(void)
+{
+    size_t i;
+
+    if (!SDL_AtomicGet(&gAsync))
+        return;
+
+    /* messages logged from now are written directly */
+    SDL_LogSetOutputFunction(sync_output_function, NULL);
+    SDL_AtomicSet(&gQueue.running, 0);
+    /* producers which got async output function before may still write to the queue */
+    while (SDL_AtomicGet(&gProducers) > 0)
+        SDL_Delay(0);
+
+    SDL_SemPost(gQueue.wake);
+    SDL_WaitThread(gQueue.writer, NULL);
+    /* writer could exit before the last producers published their messages */
+    while (log_queue_pop())
+        ;
+    log_flush_outputs();
+    SDL_AtomicSet(&gAsync, 0);
+
+    for (i = 0; i < sizeof(gCrashSignals) / sizeof(gCrashSignals[0]); ++i)
+    {
+        if (gPrevSignalHandlers[i] != SIG_ERR)
+            signal(gCrashSignals[i], gPrevSignalHandlers[i]);
+    }
+
+    SDL_DestroySemaphore(gQueue.wake);
+    lite3d_free(gQueue.slots);
+    memset(&gQueue, 0, sizeof(gQueue));
+}
+
+void lite3d_logger_flush(void)
+{
+    if (SDL_AtomicGet(&gAsync))
+        log_queue_wait((uint32_t)SDL_AtomicGet(&gQueue.enqueuePos));
+    log_flush_outputs();
+}
+
+void lite3d_logger_get_stats(lite3d_logger_stats *stats)
+{
+    SDL_assert(stats);
+    stats->queued = SDL_AtomicGet(&gQueued);
+    stats->written = SDL_AtomicGet(&gWritten);
+    stats->dropped = SDL_AtomicGet(&gDropped);
+    stats->blocked = SDL_AtomicGet(&gBlocked);
+}
+
 void lite3d_logger_release(void)
 {
+    lite3d_logger_stop_async();
+
     if (gOutFile)
     {
         fclose(gOutFile);
         gOutFile = NULL;
+        gOutFd = -1;
     }
 
 #ifdef INCLUDE_ASSIMP
     lite3d_assimp_logging_release();
 #endif
 }
-
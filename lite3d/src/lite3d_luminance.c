@@ -0,0 +1,272 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <math.h>
+#include <string.h>
+#include <SDL_assert.h>
+
+#include <lite3d/lite3d_luminance.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LITE3D_LUMINANCE_SSE
+#include <emmintrin.h>
+#endif
+
+/* Rec. 709 */
+#define LUMA_R              0.2126f
+#define LUMA_G              0.7152f
+#define LUMA_B              0.0722f
+/* smallest normal float, black and NaN texels are clamped to it */
+#define LUMA_MIN            1.17549435e-38f
+/* log2(1 + m) ~ m * (1 + C * (1 - m)) on [0, 1), error is below 0.005 */
+#define LOG2_C              0.346607f
+/* half floats are converted by chunks on stack */
+#define HALF_CHUNK_TEXELS   256
+
+typedef union
+{
+    float f;
+    uint32_t u;
+} float_bits;
+
+static uint32_t luminance_bin(const float *texel, float log2Min, float scale)
+{
+    float_bits v, m;
+    float lum = LUMA_R * texel[0] + LUMA_G * texel[1] + LUMA_B * texel[2], t;
+
+    v.f = lum > LUMA_MIN ? lum : LUMA_MIN;
+    m.u = (v.u & 0x007fffff) | 0x3f800000;
+    m.f -= 1.0f;
+
+    t = (((float)((int32_t)(v.u >> 23) - 127) + m.f * (1.0f + LOG2_C * (1.0f - m.f))) - log2Min) * scale;
+    t = t > 0.0f ? t : 0.0f;
+    t = t < (float)(LITE3D_LUMINANCE_BINS - 1) ? t : (float)(LITE3D_LUMINANCE_BINS - 1);
+    return (uint32_t)t;
+}
+
+/*
+ * Every SIMD lane counts into own copy of bins, so neighbour texels with
+ * the same luminance do not wait for each other increment
+ */
+static void histogram_float(uint32_t bins[4][LITE3D_LUMINANCE_BINS], const float *pixels,
+    size_t texels, size_t stride, float log2Min, float scale)
+{
+    size_t i = 0;
+#ifdef LITE3D_LUMINANCE_SSE
+    const __m128 wr = _mm_set1_ps(LUMA_R), wg = _mm_set1_ps(LUMA_G), wb = _mm_set1_ps(LUMA_B);
+    const __m128 lumMin = _mm_set1_ps(LUMA_MIN), one = _mm_set1_ps(1.0f), c = _mm_set1_ps(LOG2_C);
+    const __m128 vlog2Min = _mm_set1_ps(log2Min), vscale = _mm_set1_ps(scale);
+    const __m128 zero = _mm_setzero_ps(), lastBin = _mm_set1_ps((float)(LITE3D_LUMINANCE_BINS - 1));
+    const __m128i mantissa = _mm_set1_epi32(0x007fffff), oneBits = _mm_set1_epi32(0x3f800000);
+    const __m128i bias = _mm_set1_epi32(127);
+    int32_t index[4];
+
+    for (; i + 4 <= texels; i += 4)
+    {
+        const float *p = pixels + i * stride;
+        __m128 r, g, b, lum, m, t;
+        __m128i v;
+
+        if (stride == 4)
+        {
+            __m128 p0 = _mm_loadu_ps(p), p1 = _mm_loadu_ps(p + 4),
+                p2 = _mm_loadu_ps(p + 8), p3 = _mm_loadu_ps(p + 12);
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+            r = p0; g = p1; b = p2;
+        }
+        else
+        {
+            /* r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3 */
+            __m128 p0 = _mm_loadu_ps(p), p1 = _mm_loadu_ps(p + 4), p2 = _mm_loadu_ps(p + 8);
+            r = _mm_shuffle_ps(p0, _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+            g = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(0, 0, 1, 1)),
+                _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            b = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(1, 1, 2, 2)),
+                _mm_shuffle_ps(p2, p2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+        }
+
+        lum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wr, r), _mm_mul_ps(wg, g)), _mm_mul_ps(wb, b));
+        /* max returns second operand for NaN */
+        v = _mm_castps_si128(_mm_max_ps(lum, lumMin));
+        m = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(v, mantissa), oneBits)), one);
+
+        t = _mm_add_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(v, 23), bias)),
+            _mm_mul_ps(m, _mm_add_ps(one, _mm_mul_ps(c, _mm_sub_ps(one, m)))));
+        t = _mm_mul_ps(_mm_sub_ps(t, vlog2Min), vscale);
+        t = _mm_min_ps(_mm_max_ps(t, zero), lastBin);
+
+        _mm_storeu_si128((__m128i *)index, _mm_cvttps_epi32(t));
+        bins[0][index[0]]++;
+        bins[1][index[1]]++;
+        bins[2][index[2]]++;
+        bins[3][index[3]]++;
+    }
+#endif
+
+    for (; i < texels; ++i)
+    {
+        bins[i & 3][luminance_bin(pixels + i * stride, log2Min, scale)]++;
+    }
+}
+
+static float half_to_float(uint16_t h)
+{
+    float_bits o;
+    /* exponent is rebased by multiplication, denormals come out right */
+    o.u = (uint32_t)(h & 0x7fff) << 13;
+    o.f *= 5.192297e+33f; /* 2^112 */
+    if (o.f >= 65536.0f)
+        o.u |= 0x7f800000;
+    o.u |= (uint32_t)(h & 0x8000) << 16;
+    return o.f;
+}
+
+#ifdef LITE3D_LUMINANCE_SSE
+static __m128 half_to_float4(__m128i h)
+{
+    const __m128i magnitude = _mm_set1_epi32(0x7fff), sign = _mm_set1_epi32(0x8000);
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x77800000));
+    const __m128 infLimit = _mm_set1_ps(65536.0f);
+    const __m128 infExp = _mm_castsi128_ps(_mm_set1_epi32(0x7f800000));
+    __m128 o = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, magnitude), 13)), magic);
+
+    o = _mm_or_ps(o, _mm_and_ps(_mm_cmpge_ps(o, infLimit), infExp));
+    return _mm_or_ps(o, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, sign), 16)));
+}
+#endif
+
+static void halfs_to_floats(const uint16_t *src, float *dst, size_t count)
+{
+    size_t i = 0;
+#ifdef LITE3D_LUMINANCE_SSE
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_ps(dst + i, half_to_float4(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(dst + i + 4, half_to_float4(_mm_unpackhi_epi16(h, zero)));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        dst[i] = half_to_float(src[i]);
+    }
+}
+
+void lite3d_luminance_histogram_init(lite3d_luminance_histogram *histogram,
+    float log2Min, float log2Max)
+{
+    SDL_assert(histogram);
+    SDL_assert(log2Max > log2Min);
+
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->log2Min = log2Min;
+    histogram->log2Max = log2Max;
+}
+
+int lite3d_luminance_histogram_build(lite3d_luminance_histogram *histogram,
+    const void *pixels, size_t texels, uint8_t format)
+{
+    uint32_t bins[4][LITE3D_LUMINANCE_BINS];
+    size_t stride, i;
+    float scale;
+
+    SDL_assert(histogram);
+    SDL_assert(pixels || texels == 0);
+
+    if (format < LITE3D_LUMINANCE_RGB_FLOAT || format > LITE3D_LUMINANCE_RGBA_HALF)
+        return LITE3D_FALSE;
+    if (histogram->log2Max <= histogram->log2Min)
+        return LITE3D_FALSE;
+
+    memset(bins, 0, sizeof(bins));
+    stride = (format == LITE3D_LUMINANCE_RGB_FLOAT || format == LITE3D_LUMINANCE_RGB_HALF) ? 3 : 4;
+    scale = LITE3D_LUMINANCE_BINS / (histogram->log2Max - histogram->log2Min);
+
+    if (format == LITE3D_LUMINANCE_RGB_FLOAT || format == LITE3D_LUMINANCE_RGBA_FLOAT)
+    {
+        histogram_float(bins, (const float *)pixels, texels, stride, histogram->log2Min, scale);
+    }
+    else
+    {
+        float chunk[HALF_CHUNK_TEXELS * 4];
+        const uint16_t *halfs = (const uint16_t *)pixels;
+
+        for (i = 0; i < texels; i += HALF_CHUNK_TEXELS)
+        {
+            size_t count = texels - i < HALF_CHUNK_TEXELS ? texels - i : HALF_CHUNK_TEXELS;
+            halfs_to_floats(halfs + i * stride, chunk, count * stride);
+            histogram_float(bins, chunk, count, stride, histogram->log2Min, scale);
+        }
+    }
+
+    for (i = 0; i < LITE3D_LUMINANCE_BINS; ++i)
+    {
+        histogram->bins[i] = bins[0][i] + bins[1][i] + bins[2][i] + bins[3][i];
+    }
+
+    histogram->count = (uint32_t)texels;
+    return LITE3D_TRUE;
+}
+
+float lite3d_luminance_histogram_average(const lite3d_luminance_histogram *histogram,
+    float lowPercentile, float highPercentile)
+{
+    double low, high, passed = 0.0, weight = 0.0, log2Sum = 0.0;
+    float binSize;
+    int i;
+
+    SDL_assert(histogram);
+    if (histogram->count == 0)
+        return 0.0f;
+
+    low = (double)histogram->count * lowPercentile;
+    high = (double)histogram->count * highPercentile;
+    binSize = (histogram->log2Max - histogram->log2Min) / LITE3D_LUMINANCE_BINS;
+
+    for (i = 0; i < LITE3D_LUMINANCE_BINS; ++i)
+    {
+        /* part of the bin which is inside percentile window */
+        double from = passed > low ? passed : low;
+        double to = passed + histogram->bins[i] < high ? passed + histogram->bins[i] : high;
+
+        if (to > from)
+        {
+            log2Sum += (to - from) * (histogram->log2Min + (i + 0.5f) * binSize);
+            weight += to - from;
+        }
+
+        passed += histogram->bins[i];
+    }
+
+    if (weight <= 0.0)
+        return 0.0f;
+
+    return exp2f((float)(log2Sum / weight));
+}
+
+float lite3d_luminance_adapt(float current, float target, float dt,
+    float speedUp, float speedDown)
+{
+    float speed = target > current ? speedUp : speedDown;
+
+    if (current <= 0.0f || dt <= 0.0f)
+        return current <= 0.0f ? target : current;
+
+    return current + (target - current) * (1.0f - expf(-dt * speed));
+}
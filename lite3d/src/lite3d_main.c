@@ -108,6 +108,11 @@ int lite3d_main(const lite3d_global_settings *settings)
         gGlobalSettings.logFlushAlways,
         gGlobalSettings.logMuteStd);
 
+    if (gGlobalSettings.logAsync)
+    {
+        lite3d_logger_start_async(gGlobalSettings.logQueueSize, gGlobalSettings.logOverflowPolicy);
+    }
+
     if (!lite3d_metrics_global_init())
     {
         goto ret_release_logger;
@@ -185,6 +190,9 @@ int lite3d_main(const lite3d_global_settings *settings)
 #ifdef LITE3D_WITH_METRICS
     lite3d_metrics_global_write_to_log();
 #endif
+#ifdef LITE3D_WITH_MEMORY_STATS
+    lite3d_memory_stats_write_to_log();
+#endif
 
 ret_texture_shut:
     lite3d_texture_technique_shut();
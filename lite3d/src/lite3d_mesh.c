@@ -54,6 +54,8 @@ int lite3d_mesh_init(struct lite3d_mesh *mesh, uint16_t usage)
     memset(mesh, 0, sizeof (lite3d_mesh));
     mesh->version = LITE3D_VERSION_NUM;
     lite3d_list_init(&mesh->chunks);
+    lite3d_range_allocator_init(&mesh->vertexRanges);
+    lite3d_range_allocator_init(&mesh->indexRanges);
 
     if (gAuxGlobalBuffer.vboID != 0)
     {
@@ -101,6 +103,9 @@ void lite3d_mesh_purge(struct lite3d_mesh *mesh)
     lite3d_vbo_purge(&mesh->indexBuffer);
     lite3d_vbo_purge(&mesh->indirectBuffer);
     lite3d_array_purge(&mesh->drawQueue);
+    lite3d_range_allocator_purge(&mesh->vertexRanges);
+    lite3d_range_allocator_purge(&mesh->indexRanges);
+    mesh->baseChunk = NULL;
 }
 
 int lite3d_mesh_extend(struct lite3d_mesh *mesh, size_t verticesSize,
@@ -112,16 +117,219 @@ int lite3d_mesh_extend(struct lite3d_mesh *mesh, size_t verticesSize,
     {
         if (!lite3d_vbo_extend(&mesh->vertexBuffer, verticesSize))
             return LITE3D_FALSE;
+        if (!lite3d_range_allocator_grow(&mesh->vertexRanges, mesh->vertexBuffer.size))
+            return LITE3D_FALSE;
     }
     if (indexesSize > 0)
     {
         if (!lite3d_vbo_extend(&mesh->indexBuffer, indexesSize))
             return LITE3D_FALSE;
+        if (!lite3d_range_allocator_grow(&mesh->indexRanges, mesh->indexBuffer.size))
+            return LITE3D_FALSE;
+    }
+
+    return LITE3D_TRUE;
+}
+
+static int lite3d_mesh_buffer_alloc(lite3d_vbo *buffer, lite3d_range_allocator *ranges,
+    size_t size, size_t align, size_t *offset)
+{
+    size_t capacity;
+
+    /* buffer may be extended directly, e.g. by the buffer wrapper */
+    if (buffer->size > ranges->capacity && !lite3d_range_allocator_grow(ranges, buffer->size))
+        return LITE3D_FALSE;
+
+    if (lite3d_range_alloc(ranges, size, align, offset))
+        return LITE3D_TRUE;
+
+    capacity = lite3d_range_allocator_grow_capacity(ranges, size, align);
+    if (!lite3d_vbo_extend(buffer, capacity - buffer->size))
+        return LITE3D_FALSE;
+
+    SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "MESH: buffer 0x%016llx grown to %zu bytes, %zu bytes used",
+        (unsigned long long)buffer, capacity, ranges->usedBytes);
+
+    if (!lite3d_range_allocator_grow(ranges, capacity))
+        return LITE3D_FALSE;
+
+    return lite3d_range_alloc(ranges, size, align, offset);
+}
+
+int lite3d_mesh_alloc_chunk_space(struct lite3d_mesh *mesh,
+    size_t verticesSize, uint32_t stride, size_t indexesSize,
+    size_t *verticesOffset, size_t *indexesOffset)
+{
+    SDL_assert(mesh);
+    SDL_assert(verticesOffset && indexesOffset);
+
+    if (!lite3d_mesh_buffer_alloc(&mesh->vertexBuffer, &mesh->vertexRanges, verticesSize,
+        stride, verticesOffset))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Unable to allocate %zu bytes in vertex buffer",
+            LITE3D_CURRENT_FUNCTION, verticesSize);
+        return LITE3D_FALSE;
+    }
+
+    if (!lite3d_mesh_buffer_alloc(&mesh->indexBuffer, &mesh->indexRanges, indexesSize,
+        sizeof(uint32_t), indexesOffset))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Unable to allocate %zu bytes in index buffer",
+            LITE3D_CURRENT_FUNCTION, indexesSize);
+        lite3d_range_free(&mesh->vertexRanges, *verticesOffset, verticesSize);
+        return LITE3D_FALSE;
     }
 
     return LITE3D_TRUE;
 }
 
+void lite3d_mesh_reset_chunk_space(struct lite3d_mesh *mesh,
+    size_t verticesUsed, size_t indexesUsed)
+{
+    SDL_assert(mesh);
+    lite3d_range_allocator_reset(&mesh->vertexRanges, mesh->vertexBuffer.size, verticesUsed);
+    lite3d_range_allocator_reset(&mesh->indexRanges, mesh->indexBuffer.size, indexesUsed);
+}
+
+static void lite3d_mesh_update_base_chunk(struct lite3d_mesh *mesh)
+{
+    lite3d_list_node *link;
+    lite3d_mesh_chunk *meshChunk;
+
+    mesh->baseChunk = NULL;
+    for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link))
+    {
+        meshChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link);
+        if (!mesh->baseChunk || meshChunk->vao.verticesOffset < mesh->baseChunk->vao.verticesOffset)
+            mesh->baseChunk = meshChunk;
+    }
+}
+
+void lite3d_mesh_chunk_remove(struct lite3d_mesh_chunk *meshChunk)
+{
+    lite3d_mesh *mesh;
+    SDL_assert(meshChunk);
+    SDL_assert(meshChunk->mesh);
+
+    mesh = meshChunk->mesh;
+    lite3d_list_unlink_link(&meshChunk->link);
+    lite3d_range_free(&mesh->vertexRanges, meshChunk->vao.verticesOffset, meshChunk->vao.verticesSize);
+    if (meshChunk->hasIndexes)
+        lite3d_range_free(&mesh->indexRanges, meshChunk->vao.indexesOffset, meshChunk->vao.indexesSize);
+
+    mesh->verticesCount -= meshChunk->vao.verticesCount;
+    mesh->elementsCount -= meshChunk->vao.indexesCount / 3;
+
+    lite3d_mesh_chunk_purge(meshChunk);
+    lite3d_free_pooled(LITE3D_POOL_NO3, meshChunk);
+
+    if (mesh->baseChunk == meshChunk)
+        lite3d_mesh_update_base_chunk(mesh);
+}
+
+static int lite3d_mesh_buffer_read(lite3d_vbo *buffer, void *data)
+{
+    if (lite3d_check_map_buffer())
+    {
+        void *mapped;
+        if ((mapped = lite3d_vbo_map(buffer, LITE3D_VBO_MAP_READ_ONLY)) == NULL)
+            return LITE3D_FALSE;
+
+        memcpy(data, mapped, buffer->size);
+        lite3d_vbo_unmap(buffer);
+        return LITE3D_TRUE;
+    }
+
+    return lite3d_vbo_get_buffer(buffer, data, 0, buffer->size);
+}
+
+int lite3d_mesh_compact(struct lite3d_mesh *mesh)
+{
+    lite3d_list_node *link;
+    lite3d_mesh_chunk *meshChunk;
+    uint8_t *vertices = NULL, *indexes = NULL;
+    size_t verticesUsed = 0, indexesUsed = 0;
+    int result = LITE3D_FALSE;
+    SDL_assert(mesh);
+
+    if (lite3d_list_is_empty(&mesh->chunks))
+    {
+        lite3d_mesh_reset_chunk_space(mesh, 0, 0);
+        return LITE3D_TRUE;
+    }
+
+    /* 
+     * Chunks data is packed on host side and uploaded back by one call per buffer,
+     * the first half of temporary memory holds buffer content, the second one the packed data
+     */
+    if (mesh->vertexBuffer.size > 0)
+    {
+        if ((vertices = lite3d_malloc(mesh->vertexBuffer.size * 2)) == NULL)
+            goto exit;
+        if (!lite3d_mesh_buffer_read(&mesh->vertexBuffer, vertices))
+            goto exit;
+    }
+
+    if (mesh->indexBuffer.size > 0)
+    {
+        if ((indexes = lite3d_malloc(mesh->indexBuffer.size * 2)) == NULL)
+            goto exit;
+        if (!lite3d_mesh_buffer_read(&mesh->indexBuffer, indexes))
+            goto exit;
+    }
+
+    for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link))
+    {
+        size_t verticesOffset, indexesOffset = 0;
+        meshChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link);
+
+        verticesOffset = verticesUsed % meshChunk->vertexStride ?
+            verticesUsed + meshChunk->vertexStride - verticesUsed % meshChunk->vertexStride : verticesUsed;
+        memcpy(vertices + mesh->vertexBuffer.size + verticesOffset,
+            vertices + meshChunk->vao.verticesOffset, meshChunk->vao.verticesSize);
+        verticesUsed = verticesOffset + meshChunk->vao.verticesSize;
+
+        if (meshChunk->hasIndexes)
+        {
+            indexesOffset = indexesUsed;
+            memcpy(indexes + mesh->indexBuffer.size + indexesOffset,
+                indexes + meshChunk->vao.indexesOffset, meshChunk->vao.indexesSize);
+            indexesUsed += meshChunk->vao.indexesSize;
+        }
+
+        if (!lite3d_vao_init_layout(&mesh->vertexBuffer, &mesh->indexBuffer, mesh->auxBuffer,
+            &meshChunk->vao, meshChunk->layout.data, (uint32_t)meshChunk->layout.size, meshChunk->vertexStride,
+            meshChunk->vao.indexesCount, meshChunk->vao.indexesSize, indexesOffset,
+            meshChunk->vao.verticesCount, meshChunk->vao.verticesSize, verticesOffset))
+            goto exit;
+    }
+
+    if (verticesUsed > 0 && !lite3d_vbo_subbuffer(&mesh->vertexBuffer, vertices + mesh->vertexBuffer.size,
+        0, verticesUsed))
+        goto exit;
+    if (indexesUsed > 0 && !lite3d_vbo_subbuffer(&mesh->indexBuffer, indexes + mesh->indexBuffer.size,
+        0, indexesUsed))
+        goto exit;
+
+    mesh->vertexRanges.bytesCopied += verticesUsed;
+    mesh->vertexRanges.compactions++;
+    mesh->indexRanges.bytesCopied += indexesUsed;
+    mesh->indexRanges.compactions++;
+    lite3d_mesh_reset_chunk_space(mesh, verticesUsed, indexesUsed);
+    lite3d_mesh_update_base_chunk(mesh);
+    result = LITE3D_TRUE;
+
+exit:
+    if (vertices)
+        lite3d_free(vertices);
+    if (indexes)
+        lite3d_free(indexes);
+    if (!result)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Failed to compact mesh 0x%016llx",
+            LITE3D_CURRENT_FUNCTION, (unsigned long long)mesh);
+    return result;
+}
+
 void lite3d_mesh_chunk_draw(struct lite3d_mesh_chunk *meshChunk)
 {
     SDL_assert(meshChunk);
@@ -153,6 +361,22 @@ void lite3d_mesh_chunk_draw_instanced(struct lite3d_mesh_chunk *meshChunk, uint3
     }
 }
 
+void lite3d_mesh_chunk_draw_range(struct lite3d_mesh_chunk *meshChunk, 
+    uint32_t indexesOffset, uint32_t indexesCount, uint32_t instancesCount)
+{
+    SDL_assert(meshChunk);
+    SDL_assert(meshChunk->hasIndexes);
+
+    if (instancesCount == 0)
+        return;
+
+    lite3d_mesh_chunk_bind(meshChunk);
+    if (lite3d_shader_program_validate_current())
+    {
+        lite3d_vao_draw_indexed_range(&meshChunk->vao, indexesOffset, indexesCount, instancesCount);
+    }
+}
+
 void lite3d_mesh_chunk_bind(struct lite3d_mesh_chunk *meshChunk)
 {
     SDL_assert(meshChunk);
@@ -181,6 +405,18 @@ void lite3d_mesh_chunk_purge(struct lite3d_mesh_chunk *meshChunk)
     SDL_assert(meshChunk);
     lite3d_vao_purge(&meshChunk->vao);
     lite3d_array_purge(&meshChunk->layout);
+    if (meshChunk->clusters)
+    {
+        lite3d_free(meshChunk->clusters);
+        meshChunk->clusters = NULL;
+        meshChunk->clustersCount = 0;
+    }
+    if (meshChunk->lods)
+    {
+        lite3d_free(meshChunk->lods);
+        meshChunk->lods = NULL;
+        meshChunk->lodsCount = 0;
+    }
 }
 
 lite3d_mesh_chunk *lite3d_mesh_chunk_get_by_material_index(struct lite3d_mesh *mesh,
@@ -246,6 +482,10 @@ lite3d_mesh_chunk *lite3d_mesh_append_chunk(lite3d_mesh *mesh,
     meshChunk->hasIndexes = indexesCount > 0 && indexesSize > 0 ? LITE3D_TRUE : LITE3D_FALSE;
 
     lite3d_list_add_last_link(&meshChunk->link, &mesh->chunks);
+    /* chunk may take a range freed below the current base chunk */
+    if (!mesh->baseChunk || meshChunk->vao.verticesOffset < mesh->baseChunk->vao.verticesOffset)
+        mesh->baseChunk = meshChunk;
+
     SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "MESH: 0x%016llx: chunk 0x%016llx: %s, cv/ov/sv %d/%zub/%udb, ci/oi %d/%zub",
         (unsigned long long)mesh, 
         (unsigned long long)meshChunk, 
@@ -261,10 +501,11 @@ lite3d_mesh_chunk *lite3d_mesh_append_chunk(lite3d_mesh *mesh,
 
 void lite3d_mesh_queue_draw(struct lite3d_mesh *mesh)
 {
-    lite3d_mesh_chunk *firstchunk;
+    lite3d_mesh_chunk *basechunk;
     SDL_assert(mesh);
+    SDL_assert(mesh->baseChunk);
 
-    firstchunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, lite3d_list_first_link(&mesh->chunks), link);
+    basechunk = mesh->baseChunk;
     if (!lite3d_vbo_buffer_set(&mesh->indirectBuffer, mesh->drawQueue.data, 
         mesh->drawQueue.size * mesh->drawQueue.elemSize))
     {
@@ -273,11 +514,11 @@ void lite3d_mesh_queue_draw(struct lite3d_mesh *mesh)
         return;
     }
 
-    lite3d_mesh_chunk_bind(firstchunk);
+    lite3d_mesh_chunk_bind(basechunk);
     // Проверим впорядке ли шейдер
     if (lite3d_shader_program_validate_current())
     {
-        if (firstchunk->hasIndexes)
+        if (basechunk->hasIndexes)
         {
             lite3d_vao_multidraw_indexed(0, mesh->drawQueue.size);
         }
@@ -288,6 +529,20 @@ void lite3d_mesh_queue_draw(struct lite3d_mesh *mesh)
     }
 }
 
+/* 
+ * Attributes are bound by VAO of the base chunk, the lowest placed one, so vertices are counted
+ * from its offset and base vertex is never negative, whatever free range a chunk was placed in.
+ */
+static uint32_t lite3d_mesh_chunk_base_vertex(struct lite3d_mesh_chunk *meshChunk)
+{
+    lite3d_mesh_chunk *basechunk = meshChunk->mesh->baseChunk;
+    SDL_assert(basechunk);
+    SDL_assert(meshChunk->vao.verticesOffset >= basechunk->vao.verticesOffset);
+
+    return (uint32_t)((meshChunk->vao.verticesOffset - basechunk->vao.verticesOffset) /
+        meshChunk->vertexStride);
+}
+
 void lite3d_mesh_queue_chunk(struct lite3d_mesh_chunk *meshChunk)
 {
     SDL_assert(meshChunk);
@@ -304,7 +559,7 @@ void lite3d_mesh_queue_chunk(struct lite3d_mesh_chunk *meshChunk)
         command->count = meshChunk->vao.indexesCount;
         command->instanceCount = 1;
         command->firstIndex = (uint32_t)(meshChunk->vao.indexesOffset / sizeof(uint32_t));
-        command->baseVertex = (uint32_t)(meshChunk->vao.verticesOffset / meshChunk->vertexStride);
+        command->baseVertex = (int32_t)lite3d_mesh_chunk_base_vertex(meshChunk);
         command->baseInstance = 0;
     }
     else
@@ -317,11 +572,33 @@ void lite3d_mesh_queue_chunk(struct lite3d_mesh_chunk *meshChunk)
         lite3d_multidraw_command *command = lite3d_array_add(&meshChunk->mesh->drawQueue);
         command->count = meshChunk->vao.verticesCount;
         command->instanceCount = 1;
-        command->first = (uint32_t)(meshChunk->vao.verticesOffset / meshChunk->vertexStride);
+        command->first = lite3d_mesh_chunk_base_vertex(meshChunk);
         command->baseInstance = 0;
     }
 }
 
+void lite3d_mesh_queue_chunk_range(struct lite3d_mesh_chunk *meshChunk, 
+    uint32_t indexesOffset, uint32_t indexesCount)
+{
+    SDL_assert(meshChunk);
+    SDL_assert(meshChunk->mesh);
+    SDL_assert(meshChunk->hasIndexes);
+    // Уровни LOD лежат за индексами чанка, в пределах его места в буфере
+    SDL_assert((size_t)(indexesOffset + indexesCount) * sizeof(uint32_t) <= meshChunk->vao.indexesSize);
+
+    if (meshChunk->mesh->drawQueue.capacity == 0)
+    {
+        lite3d_array_init(&meshChunk->mesh->drawQueue, sizeof(lite3d_multidraw_indexed_command), 1);
+    }
+
+    lite3d_multidraw_indexed_command *command = lite3d_array_add(&meshChunk->mesh->drawQueue);
+    command->count = indexesCount;
+    command->instanceCount = 1;
+    command->firstIndex = (uint32_t)(meshChunk->vao.indexesOffset / sizeof(uint32_t)) + indexesOffset;
+    command->baseVertex = (int32_t)lite3d_mesh_chunk_base_vertex(meshChunk);
+    command->baseInstance = 0;
+}
+
 void lite3d_mesh_queue_chunk_add_instance(struct lite3d_mesh_chunk *meshChunk)
 {
     SDL_assert(meshChunk);
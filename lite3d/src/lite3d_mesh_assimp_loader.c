@@ -362,16 +362,14 @@ static int ai_load_materials(const struct aiScene *scene, lite3d_assimp_loader_c
     return LITE3D_TRUE;
 }
 
-static const struct aiScene *ai_load_scene(const lite3d_file *resource, uint32_t flags,
-    struct aiPropertyStore *importProrerties)
+static const struct aiScene *ai_load_scene(const void *data, size_t size, const char *name, 
+    uint32_t flags, struct aiPropertyStore *importProrerties)
 {
     const struct aiScene *scene = NULL;
     struct aiMemoryInfo sceneMemory;
     uint32_t aiflags;
 
-    SDL_assert(resource);
-
-    if (!resource->isLoaded)
+    if (!data || size == 0)
         return NULL;
 
     /* remove this components from loaded scene */
@@ -381,12 +379,12 @@ static const struct aiScene *ai_load_scene(const lite3d_file *resource, uint32_t
         aiComponent_ANIMATIONS |
         aiComponent_BONEWEIGHTS);
     /* parse scene from memory buffered file */
-    scene = aiImportFileFromMemoryWithProperties(resource->fileBuff,
-        (unsigned int)resource->fileSize, aiProcess_RemoveComponent, NULL, importProrerties);
+    scene = aiImportFileFromMemoryWithProperties(data,
+        (unsigned int)size, aiProcess_RemoveComponent, NULL, importProrerties);
     if (!scene)
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MESH: %s import failed.. %s",
-            resource->name, aiGetErrorString());
+            name, aiGetErrorString());
         return NULL;
     }
 
@@ -423,7 +421,8 @@ int lite3d_assimp_mesh_load(lite3d_mesh *mesh, const lite3d_file *resource,
     importProrerties = aiCreatePropertyStore();
     SDL_assert_release(importProrerties);
 
-    if((scene = ai_load_scene(resource, flags, importProrerties)) == NULL)
+    if (!resource->isLoaded || 
+        (scene = ai_load_scene(resource->fileBuff, resource->fileSize, resource->name, flags, importProrerties)) == NULL)
     {
         aiReleasePropertyStore(importProrerties);
         return LITE3D_FALSE;
@@ -476,6 +475,24 @@ int lite3d_assimp_mesh_load(lite3d_mesh *mesh, const lite3d_file *resource,
 
 int lite3d_assimp_mesh_load_recursive(const lite3d_file *resource, 
     lite3d_assimp_loader_ctx ctx, uint32_t flags)
+{
+    const struct aiScene *scene = NULL;
+    int result;
+
+    SDL_assert(resource);
+
+    if (!resource->isLoaded ||
+        (scene = lite3d_assimp_scene_import(resource->fileBuff, resource->fileSize, resource->name, flags)) == NULL)
+        return LITE3D_FALSE;
+
+    result = lite3d_assimp_scene_load_recursive(scene, ctx);
+    lite3d_assimp_scene_release(scene);
+
+    return result;
+}
+
+const struct aiScene *lite3d_assimp_scene_import(const void *data, size_t size, 
+    const char *name, uint32_t flags)
 {
     const struct aiScene *scene = NULL;
     struct aiPropertyStore *importProrerties;
@@ -483,11 +500,15 @@ int lite3d_assimp_mesh_load_recursive(const lite3d_file *resource,
     importProrerties = aiCreatePropertyStore();
     SDL_assert_release(importProrerties);
 
-    if ((scene = ai_load_scene(resource, flags, importProrerties)) == NULL)
-    {
-        aiReleasePropertyStore(importProrerties);
-        return LITE3D_FALSE;
-    }
+    scene = ai_load_scene(data, size, name, flags, importProrerties);
+    aiReleasePropertyStore(importProrerties);
+
+    return scene;
+}
+
+int lite3d_assimp_scene_load_recursive(const struct aiScene *scene, lite3d_assimp_loader_ctx ctx)
+{
+    SDL_assert(scene);
 
     if (ctx.onLevelPush)
         ctx.onLevelPush(ctx.userdata);
@@ -501,12 +522,21 @@ int lite3d_assimp_mesh_load_recursive(const lite3d_file *resource,
     if (ctx.onLevelPop)
         ctx.onLevelPop(ctx.userdata);
 
-    aiReleaseImport(scene);
-    aiReleasePropertyStore(importProrerties);
-
     return LITE3D_TRUE;
 }
 
+void lite3d_assimp_scene_release(const struct aiScene *scene)
+{
+    if (scene)
+        aiReleaseImport(scene);
+}
+
+int lite3d_assimp_extension_supported(const char *extension)
+{
+    SDL_assert(extension);
+    return aiIsExtensionSupported(extension) == AI_TRUE ? LITE3D_TRUE : LITE3D_FALSE;
+}
+
 static void aiLogFunc(const char* message , char* user)
 {
     SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Assimp: %s",
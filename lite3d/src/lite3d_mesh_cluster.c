@@ -0,0 +1,540 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <math.h>
+#include <string.h>
+#include <SDL_log.h>
+#include <SDL_assert.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_mesh_cluster.h>
+
+/* Unused triangles looked ahead in index order when cluster has no connected candidates */
+#define CLUSTER_FALLBACK_LOOKAHEAD  64
+/* Cone is too wide to reject anything when normals spread close to hemisphere */
+#define CLUSTER_CONE_MIN_DOT        0.1f
+
+typedef struct cluster_builder
+{
+    const uint8_t *positions;
+    uint32_t stride;
+    const uint32_t *indexes;
+    uint32_t trianglesCount;
+    /* triangles of each vertex, CSR */
+    uint32_t *adjacencyOffsets;
+    uint32_t *adjacency;
+    /* stamps of cluster the vertex/candidate triangle belongs to, cluster number + 1 */
+    uint32_t *vertexStamp;
+    uint32_t *candidateStamp;
+    uint8_t *used;
+    lite3d_array candidates;
+    uint32_t stamp;
+    uint32_t verticesCount;
+    uint32_t trianglesInCluster;
+    kmVec3 centroidSum;
+} cluster_builder;
+
+static const kmVec3 *cluster_position(const uint8_t *positions, uint32_t stride, uint32_t index)
+{
+    return (const kmVec3 *)(positions + (size_t)index * stride);
+}
+
+static void cluster_triangle_centroid(const cluster_builder *b, uint32_t triangle, kmVec3 *out)
+{
+    const kmVec3 *p0 = cluster_position(b->positions, b->stride, b->indexes[triangle * 3]);
+    const kmVec3 *p1 = cluster_position(b->positions, b->stride, b->indexes[triangle * 3 + 1]);
+    const kmVec3 *p2 = cluster_position(b->positions, b->stride, b->indexes[triangle * 3 + 2]);
+
+    out->x = (p0->x + p1->x + p2->x) / 3.0f;
+    out->y = (p0->y + p1->y + p2->y) / 3.0f;
+    out->z = (p0->z + p1->z + p2->z) / 3.0f;
+}
+
+/* Vertices of triangle not yet in current cluster, repeated indexes of degenerate triangle count once */
+static uint32_t cluster_new_vertices(const cluster_builder *b, uint32_t triangle)
+{
+    const uint32_t *tri = b->indexes + (size_t)triangle * 3;
+    uint32_t count = 0;
+
+    if (b->vertexStamp[tri[0]] != b->stamp)
+        count++;
+    if (b->vertexStamp[tri[1]] != b->stamp && tri[1] != tri[0])
+        count++;
+    if (b->vertexStamp[tri[2]] != b->stamp && tri[2] != tri[0] && tri[2] != tri[1])
+        count++;
+
+    return count;
+}
+
+static int cluster_add_triangle(cluster_builder *b, uint32_t triangle, uint32_t *ordered)
+{
+    uint32_t i, j;
+    kmVec3 centroid;
+
+    b->used[triangle] = LITE3D_TRUE;
+    memcpy(ordered, b->indexes + (size_t)triangle * 3, sizeof(uint32_t) * 3);
+    cluster_triangle_centroid(b, triangle, &centroid);
+    kmVec3Add(&b->centroidSum, &b->centroidSum, &centroid);
+    b->trianglesInCluster++;
+
+    for (i = 0; i < 3; ++i)
+    {
+        uint32_t vertex = b->indexes[(size_t)triangle * 3 + i];
+        if (b->vertexStamp[vertex] == b->stamp)
+            continue;
+
+        b->vertexStamp[vertex] = b->stamp;
+        b->verticesCount++;
+
+        /* neighbours over this vertex become candidates to grow the cluster */
+        for (j = b->adjacencyOffsets[vertex]; j < b->adjacencyOffsets[vertex + 1]; ++j)
+        {
+            uint32_t neighbour = b->adjacency[j];
+            if (b->used[neighbour] || b->candidateStamp[neighbour] == b->stamp)
+                continue;
+
+            b->candidateStamp[neighbour] = b->stamp;
+            if (!lite3d_array_add(&b->candidates))
+                return LITE3D_FALSE;
+            *LITE3D_ARR_GET_LAST(&b->candidates, uint32_t) = neighbour;
+        }
+    }
+
+    return LITE3D_TRUE;
+}
+
+/* 
+ * Prefer triangles bringing less new vertices, then closer to cluster center,
+ * returns trianglesCount if nothing fits in vertex limit.
+ */
+static uint32_t cluster_pick_candidate(cluster_builder *b, uint32_t maxVertices)
+{
+    uint32_t best = b->trianglesCount, bestNew = 4, i = 0;
+    float bestDistance = 0.0f;
+    kmVec3 center, centroid, delta;
+
+    kmVec3Scale(&center, &b->centroidSum, 1.0f / (float)b->trianglesInCluster);
+    while (i < b->candidates.size)
+    {
+        uint32_t triangle = *(uint32_t *)lite3d_array_get(&b->candidates, i);
+        uint32_t newVertices;
+        float distance;
+
+        if (b->used[triangle])
+        {
+            /* swap remove */
+            *(uint32_t *)lite3d_array_get(&b->candidates, i) = *LITE3D_ARR_GET_LAST(&b->candidates, uint32_t);
+            b->candidates.size--;
+            continue;
+        }
+
+        newVertices = cluster_new_vertices(b, triangle);
+        if (b->verticesCount + newVertices <= maxVertices && newVertices <= bestNew)
+        {
+            cluster_triangle_centroid(b, triangle, &centroid);
+            distance = kmVec3LengthSq(kmVec3Subtract(&delta, &centroid, &center));
+            if (newVertices < bestNew || distance < bestDistance)
+            {
+                best = triangle;
+                bestNew = newVertices;
+                bestDistance = distance;
+            }
+        }
+
+        i++;
+    }
+
+    return best;
+}
+
+/* Disconnected pieces (foliage cards etc.) are gathered from the nearest unused triangles in index order */
+static uint32_t cluster_pick_fallback(cluster_builder *b, uint32_t from, uint32_t maxVertices)
+{
+    uint32_t best = b->trianglesCount, looked = 0, triangle;
+    float bestDistance = 0.0f, distance;
+    kmVec3 center, centroid, delta;
+
+    kmVec3Scale(&center, &b->centroidSum, 1.0f / (float)b->trianglesInCluster);
+    for (triangle = from; triangle < b->trianglesCount && looked < CLUSTER_FALLBACK_LOOKAHEAD; ++triangle)
+    {
+        if (b->used[triangle])
+            continue;
+
+        looked++;
+        if (b->verticesCount + cluster_new_vertices(b, triangle) > maxVertices)
+            continue;
+
+        cluster_triangle_centroid(b, triangle, &centroid);
+        distance = kmVec3LengthSq(kmVec3Subtract(&delta, &centroid, &center));
+        if (best == b->trianglesCount || distance < bestDistance)
+        {
+            best = triangle;
+            bestDistance = distance;
+        }
+    }
+
+    return best;
+}
+
+static int cluster_builder_init(cluster_builder *b, const void *positions, uint32_t stride, 
+    uint32_t verticesCount, const uint32_t *indexes, uint32_t indexesCount)
+{
+    uint32_t i;
+
+    memset(b, 0, sizeof(cluster_builder));
+    b->positions = (const uint8_t *)positions;
+    b->stride = stride;
+    b->indexes = indexes;
+    b->trianglesCount = indexesCount / 3;
+    lite3d_array_init(&b->candidates, sizeof(uint32_t), 64);
+
+    if (!(b->adjacencyOffsets = lite3d_calloc(sizeof(uint32_t) * ((size_t)verticesCount + 1))) ||
+        !(b->adjacency = lite3d_malloc(sizeof(uint32_t) * ((size_t)b->trianglesCount * 3 + 1))) ||
+        !(b->vertexStamp = lite3d_calloc(sizeof(uint32_t) * ((size_t)verticesCount + 1))) ||
+        !(b->candidateStamp = lite3d_calloc(sizeof(uint32_t) * ((size_t)b->trianglesCount + 1))) ||
+        !(b->used = lite3d_calloc((size_t)b->trianglesCount + 1)))
+        return LITE3D_FALSE;
+
+    for (i = 0; i < b->trianglesCount * 3; ++i)
+        b->adjacencyOffsets[indexes[i] + 1]++;
+    for (i = 0; i < verticesCount; ++i)
+        b->adjacencyOffsets[i + 1] += b->adjacencyOffsets[i];
+
+    /* vertexStamp is used as fill cursor here, it is cleared after */
+    for (i = 0; i < b->trianglesCount * 3; ++i)
+        b->adjacency[b->adjacencyOffsets[indexes[i]] + b->vertexStamp[indexes[i]]++] = i / 3;
+    memset(b->vertexStamp, 0, sizeof(uint32_t) * ((size_t)verticesCount + 1));
+
+    return LITE3D_TRUE;
+}
+
+static void cluster_builder_purge(cluster_builder *b)
+{
+    if (b->adjacencyOffsets)
+        lite3d_free(b->adjacencyOffsets);
+    if (b->adjacency)
+        lite3d_free(b->adjacency);
+    if (b->vertexStamp)
+        lite3d_free(b->vertexStamp);
+    if (b->candidateStamp)
+        lite3d_free(b->candidateStamp);
+    if (b->used)
+        lite3d_free(b->used);
+    lite3d_array_purge(&b->candidates);
+}
+
+int lite3d_mesh_clusters_build(const void *positions, uint32_t stride, uint32_t verticesCount,
+    uint32_t *indexes, uint32_t indexesCount, uint32_t maxVertices, uint32_t maxTriangles, lite3d_array *clusters)
+{
+    cluster_builder builder;
+    uint32_t *ordered = NULL;
+    uint32_t i, emitted = 0, seed = 0;
+    int result = LITE3D_FALSE;
+
+    SDL_assert(positions);
+    SDL_assert(clusters);
+    SDL_assert(clusters->elemSize == sizeof(lite3d_mesh_cluster));
+
+    if (maxVertices < 3 || maxVertices > LITE3D_CLUSTER_VERTICES_LIMIT || maxTriangles == 0 || 
+        stride < sizeof(kmVec3) || indexesCount % 3 != 0)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Bad cluster limits %u/%u or triangle list of %u indexes",
+            LITE3D_CURRENT_FUNCTION, maxVertices, maxTriangles, indexesCount);
+        return LITE3D_FALSE;
+    }
+
+    for (i = 0; i < indexesCount; ++i)
+    {
+        if (indexes[i] >= verticesCount)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Index %u is out of %u vertices",
+                LITE3D_CURRENT_FUNCTION, i, verticesCount);
+            return LITE3D_FALSE;
+        }
+    }
+
+    if (indexesCount == 0)
+        return LITE3D_TRUE;
+
+    if (!cluster_builder_init(&builder, positions, stride, verticesCount, indexes, indexesCount) ||
+        !(ordered = lite3d_malloc(sizeof(uint32_t) * indexesCount)))
+        goto exit;
+
+    while (emitted < builder.trianglesCount)
+    {
+        lite3d_mesh_cluster *cluster;
+        uint32_t first = emitted, next;
+
+        while (builder.used[seed])
+            seed++;
+
+        builder.stamp++;
+        builder.verticesCount = builder.trianglesInCluster = 0;
+        builder.centroidSum = (kmVec3){ 0.0f, 0.0f, 0.0f };
+        lite3d_array_clean(&builder.candidates);
+
+        next = seed;
+        do
+        {
+            if (!cluster_add_triangle(&builder, next, ordered + (size_t)emitted * 3))
+                goto exit;
+            emitted++;
+
+            if (builder.trianglesInCluster == maxTriangles)
+                break;
+            if ((next = cluster_pick_candidate(&builder, maxVertices)) == builder.trianglesCount)
+                next = cluster_pick_fallback(&builder, seed, maxVertices);
+        } while (next < builder.trianglesCount);
+
+        if (!(cluster = lite3d_array_add(clusters)))
+            goto exit;
+
+        lite3d_mesh_cluster_compute_bounds(cluster, positions, stride, ordered + (size_t)first * 3,
+            (emitted - first) * 3);
+        cluster->indexesOffset = first * 3;
+        cluster->indexesCount = (emitted - first) * 3;
+    }
+
+    memcpy(indexes, ordered, sizeof(uint32_t) * indexesCount);
+    result = LITE3D_TRUE;
+
+exit:
+    cluster_builder_purge(&builder);
+    if (ordered)
+        lite3d_free(ordered);
+    if (!result)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Failed to build clusters of %u triangles",
+            LITE3D_CURRENT_FUNCTION, indexesCount / 3);
+    return result;
+}
+
+void lite3d_mesh_cluster_compute_bounds(lite3d_mesh_cluster *cluster, const void *positions,
+    uint32_t stride, const uint32_t *indexes, uint32_t indexesCount)
+{
+    const uint8_t *data = (const uint8_t *)positions;
+    kmVec3 vmin, vmax, axis = { 0.0f, 0.0f, 0.0f }, edge1, edge2, normal, delta;
+    float minDot = 1.0f, maxT = 0.0f;
+    uint32_t i, normalsCount = 0;
+
+    SDL_assert(cluster);
+    SDL_assert(positions);
+
+    memset(cluster, 0, sizeof(lite3d_mesh_cluster));
+    /* disabled cone never rejects cluster */
+    cluster->coneCutoff = 1.0f;
+    if (indexesCount == 0)
+        return;
+
+    vmin = vmax = *cluster_position(data, stride, indexes[0]);
+    for (i = 1; i < indexesCount; ++i)
+    {
+        const kmVec3 *p = cluster_position(data, stride, indexes[i]);
+        vmin.x = p->x < vmin.x ? p->x : vmin.x;
+        vmin.y = p->y < vmin.y ? p->y : vmin.y;
+        vmin.z = p->z < vmin.z ? p->z : vmin.z;
+        vmax.x = p->x > vmax.x ? p->x : vmax.x;
+        vmax.y = p->y > vmax.y ? p->y : vmax.y;
+        vmax.z = p->z > vmax.z ? p->z : vmax.z;
+    }
+
+    cluster->center.x = (vmin.x + vmax.x) * 0.5f;
+    cluster->center.y = (vmin.y + vmax.y) * 0.5f;
+    cluster->center.z = (vmin.z + vmax.z) * 0.5f;
+    for (i = 0; i < indexesCount; ++i)
+    {
+        float distance = kmVec3Length(kmVec3Subtract(&delta, cluster_position(data, stride, indexes[i]), 
+            &cluster->center));
+        cluster->radius = distance > cluster->radius ? distance : cluster->radius;
+    }
+
+    /* Normal cone, degenerate triangles are invisible and do not limit it */
+    for (i = 0; i + 2 < indexesCount; i += 3)
+    {
+        const kmVec3 *p0 = cluster_position(data, stride, indexes[i]);
+        kmVec3Subtract(&edge1, cluster_position(data, stride, indexes[i + 1]), p0);
+        kmVec3Subtract(&edge2, cluster_position(data, stride, indexes[i + 2]), p0);
+        kmVec3Cross(&normal, &edge1, &edge2);
+        if (kmVec3LengthSq(&normal) <= 0.0f)
+            continue;
+
+        kmVec3Add(&axis, &axis, kmVec3Normalize(&normal, &normal));
+        normalsCount++;
+    }
+
+    if (normalsCount == 0 || kmVec3LengthSq(&axis) <= 0.0f)
+    {
+        cluster->coneApex = cluster->center;
+        return;
+    }
+
+    kmVec3Normalize(&axis, &axis);
+    for (i = 0; i + 2 < indexesCount; i += 3)
+    {
+        const kmVec3 *p0 = cluster_position(data, stride, indexes[i]);
+        float dotAxis, t;
+
+        kmVec3Subtract(&edge1, cluster_position(data, stride, indexes[i + 1]), p0);
+        kmVec3Subtract(&edge2, cluster_position(data, stride, indexes[i + 2]), p0);
+        kmVec3Cross(&normal, &edge1, &edge2);
+        if (kmVec3LengthSq(&normal) <= 0.0f)
+            continue;
+
+        kmVec3Normalize(&normal, &normal);
+        dotAxis = kmVec3Dot(&axis, &normal);
+        minDot = dotAxis < minDot ? dotAxis : minDot;
+        if (dotAxis <= CLUSTER_CONE_MIN_DOT)
+            break;
+
+        /* apex is moved along -axis until it is behind plane of every triangle */
+        t = kmVec3Dot(kmVec3Subtract(&delta, &cluster->center, p0), &normal) / dotAxis;
+        maxT = t > maxT ? t : maxT;
+    }
+
+    cluster->coneAxis = axis;
+    if (minDot <= CLUSTER_CONE_MIN_DOT)
+    {
+        cluster->coneApex = cluster->center;
+        return;
+    }
+
+    kmVec3Scale(&delta, &axis, maxT);
+    kmVec3Subtract(&cluster->coneApex, &cluster->center, &delta);
+    /* eye direction within 90 - acos(minDot) degrees of axis sees back side of every triangle */
+    cluster->coneCutoff = sqrtf(1.0f - minDot * minDot);
+}
+
+static float cluster_max_scale(const kmMat4 *m)
+{
+    float sx = m->mat[0] * m->mat[0] + m->mat[1] * m->mat[1] + m->mat[2] * m->mat[2];
+    float sy = m->mat[4] * m->mat[4] + m->mat[5] * m->mat[5] + m->mat[6] * m->mat[6];
+    float sz = m->mat[8] * m->mat[8] + m->mat[9] * m->mat[9] + m->mat[10] * m->mat[10];
+    float s = sx > sy ? sx : sy;
+    return sqrtf(s > sz ? s : sz);
+}
+
+static float cluster_det3(const kmMat4 *m)
+{
+    return m->mat[0] * (m->mat[5] * m->mat[10] - m->mat[9] * m->mat[6]) -
+        m->mat[4] * (m->mat[1] * m->mat[10] - m->mat[9] * m->mat[2]) +
+        m->mat[8] * (m->mat[1] * m->mat[6] - m->mat[5] * m->mat[2]);
+}
+
+uint32_t lite3d_mesh_clusters_cull(const lite3d_mesh_cluster *clusters, uint32_t clustersCount,
+    const lite3d_mesh_cluster_cull_params *params, lite3d_array *ranges, lite3d_mesh_cluster_cull_stats *stats)
+{
+    lite3d_mesh_cluster_cull_stats localStats;
+    kmMat4 inverse;
+    kmVec3 eyeLocal, center, delta;
+    lite3d_bounding_vol sphere;
+    float scale = 1.0f;
+    int coneTest = LITE3D_FALSE;
+    size_t lastRange = (size_t)-1;
+    uint32_t i, visibleCount = 0;
+
+    SDL_assert(params);
+    SDL_assert(ranges);
+    SDL_assert(ranges->elemSize == sizeof(lite3d_mesh_index_range));
+
+    if (!stats)
+        stats = &localStats;
+    memset(stats, 0, sizeof(lite3d_mesh_cluster_cull_stats));
+
+    if (params->worldMatrix)
+        scale = cluster_max_scale(params->worldMatrix);
+
+    /* 
+     * Cone test is done in model space: eye is moved there instead of transforming every cone, 
+     * side of triangle plane is preserved by any affine transform. Mirroring flips front faces, 
+     * there the test is skipped.
+     */
+    if (params->eyePosition)
+    {
+        if (!params->worldMatrix)
+        {
+            eyeLocal = *params->eyePosition;
+            coneTest = LITE3D_TRUE;
+        }
+        else if (cluster_det3(params->worldMatrix) > 0.0f && kmMat4Inverse(&inverse, params->worldMatrix))
+        {
+            kmVec3Transform(&eyeLocal, params->eyePosition, &inverse);
+            coneTest = LITE3D_TRUE;
+        }
+    }
+
+    for (i = 0; i < clustersCount; ++i)
+    {
+        const lite3d_mesh_cluster *cluster = &clusters[i];
+        lite3d_mesh_index_range *range;
+
+        stats->clustersTested++;
+        if (params->worldMatrix)
+            kmVec3Transform(&center, &cluster->center, params->worldMatrix);
+        else
+            center = cluster->center;
+
+        if (params->frustum)
+        {
+            sphere.sphereCenter = center;
+            sphere.radius = cluster->radius * scale;
+            if (!lite3d_frustum_test_sphere(params->frustum, &sphere))
+            {
+                stats->frustumCulled++;
+                continue;
+            }
+        }
+
+        if (coneTest && cluster->coneCutoff < 1.0f)
+        {
+            float distance = kmVec3Length(kmVec3Subtract(&delta, &cluster->coneApex, &eyeLocal));
+            if (distance > 0.0f && kmVec3Dot(&delta, &cluster->coneAxis) >= cluster->coneCutoff * distance)
+            {
+                stats->backfaceCulled++;
+                continue;
+            }
+        }
+
+        if (params->occlusionTest && !params->occlusionTest(&center, cluster->radius * scale, params->userdata))
+        {
+            stats->occlusionCulled++;
+            continue;
+        }
+
+        visibleCount++;
+        stats->indexesVisible += cluster->indexesCount;
+
+        /* clusters following each other in index buffer are drawn by one command */
+        if (lastRange != (size_t)-1)
+        {
+            range = (lite3d_mesh_index_range *)lite3d_array_get(ranges, lastRange);
+            if (range->indexesOffset + range->indexesCount == cluster->indexesOffset)
+            {
+                range->indexesCount += cluster->indexesCount;
+                continue;
+            }
+        }
+
+        if (!(range = lite3d_array_add(ranges)))
+            break;
+
+        range->indexesOffset = cluster->indexesOffset;
+        range->indexesCount = cluster->indexesCount;
+        lastRange = ranges->size - 1;
+        stats->rangesCount++;
+    }
+
+    return visibleCount;
+}
@@ -25,8 +25,12 @@
 #include <lite3d/lite3d_misc.h>
 #include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_mesh_codec.h>
+#include <lite3d/lite3d_mesh_cluster.h>
+#include <lite3d/lite3d_mesh_lod.h>
 
 #define LITE3D_M_SIGNATURE          0xBEEB0001
+#define LITE3D_M_CLUSTER_SIGNATURE  0xBEEB0C01
+#define LITE3D_M_LOD_SIGNATURE      0xBEEB0D01
 #define CHUNK_LAYOUT_MAX_COUNT      32
 
 #pragma pack(push, 1)
@@ -62,9 +66,41 @@ typedef struct lite3d_m_chunk_layout
     uint8_t count;
 } lite3d_m_chunk_layout;
 
+/* Optional sections follow index section, old readers do not look there */
+typedef struct lite3d_m_section_header
+{
+    uint32_t sig;
+    uint32_t recordsCount;
+} lite3d_m_section_header;
+
+/* Records are sorted by chunk index, indexes offset is relative to chunk */
+typedef struct lite3d_m_cluster
+{
+    uint32_t chunkIndex;
+    uint32_t indexesOffset;
+    uint32_t indexesCount;
+    kmVec3 center;
+    float radius;
+    kmVec3 coneApex;
+    kmVec3 coneAxis;
+    float coneCutoff;
+} lite3d_m_cluster;
+
+/* 
+ * Records are sorted by chunk index and level, indexes offset is relative to chunk, 
+ * levels indexes follow chunk indexes inside chunk index range (indexesSize of chunk) 
+ */
+typedef struct lite3d_m_lod
+{
+    uint32_t chunkIndex;
+    uint32_t indexesOffset;
+    uint32_t indexesCount;
+    float error;
+} lite3d_m_lod;
+
 #pragma pack(pop)
 
-static int lite3d_write_buffer_to_stream(lite3d_vbo *buffer, SDL_RWops *stream)
+static int lite3d_write_buffer_to_stream(lite3d_vbo *buffer, size_t size, SDL_RWops *stream)
 {
     void *vboData;
     
@@ -78,7 +114,7 @@ static int lite3d_write_buffer_to_stream(lite3d_vbo *buffer, SDL_RWops *stream)
             return LITE3D_FALSE;
         }
 
-        if (SDL_RWwrite(stream, vboData, buffer->size, 1) != 1)
+        if (SDL_RWwrite(stream, vboData, size, 1) != 1)
         {
             lite3d_vbo_unmap(buffer);
             return LITE3D_FALSE;
@@ -88,19 +124,19 @@ static int lite3d_write_buffer_to_stream(lite3d_vbo *buffer, SDL_RWops *stream)
     }
     else
     {
-        vboData = lite3d_malloc(buffer->size);
+        vboData = lite3d_malloc(size);
         if (!vboData)
         {
             return LITE3D_FALSE;
         }
 
-        if (!lite3d_vbo_get_buffer(buffer, vboData, 0, buffer->size))
+        if (!lite3d_vbo_get_buffer(buffer, vboData, 0, size))
         {
             lite3d_free(vboData);
             return LITE3D_FALSE;
         }
 
-        if (SDL_RWwrite(stream, vboData, buffer->size, 1) != 1)
+        if (SDL_RWwrite(stream, vboData, size, 1) != 1)
         {
             lite3d_free(vboData);
             return LITE3D_FALSE;
@@ -112,6 +148,221 @@ static int lite3d_write_buffer_to_stream(lite3d_vbo *buffer, SDL_RWops *stream)
     return LITE3D_TRUE;
 }
 
+/* Buffers may have free space at the end, only part used by chunks is stored */
+static void lite3d_mesh_used_size(lite3d_mesh *mesh, size_t *verticesSize, size_t *indexesSize)
+{
+    lite3d_list_node *link;
+    lite3d_mesh_chunk *meshChunk;
+
+    *verticesSize = *indexesSize = 0;
+    for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link))
+    {
+        meshChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link);
+        if (meshChunk->vao.verticesOffset + meshChunk->vao.verticesSize > *verticesSize)
+            *verticesSize = meshChunk->vao.verticesOffset + meshChunk->vao.verticesSize;
+        if (meshChunk->vao.indexesOffset + meshChunk->vao.indexesSize > *indexesSize)
+            *indexesSize = meshChunk->vao.indexesOffset + meshChunk->vao.indexesSize;
+    }
+}
+
+static uint32_t lite3d_mesh_clusters_count(lite3d_mesh *mesh)
+{
+    lite3d_list_node *link;
+    uint32_t count = 0;
+
+    for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link))
+        count += LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link)->clustersCount;
+
+    return count;
+}
+
+static void lite3d_m_cluster_pack(lite3d_m_cluster *mcluster, uint32_t chunkIndex, const lite3d_mesh_cluster *cluster)
+{
+    mcluster->chunkIndex = chunkIndex;
+    mcluster->indexesOffset = cluster->indexesOffset;
+    mcluster->indexesCount = cluster->indexesCount;
+    mcluster->center = cluster->center;
+    mcluster->radius = cluster->radius;
+    mcluster->coneApex = cluster->coneApex;
+    mcluster->coneAxis = cluster->coneAxis;
+    mcluster->coneCutoff = cluster->coneCutoff;
+}
+
+static void lite3d_m_cluster_unpack(lite3d_mesh_cluster *cluster, const lite3d_m_cluster *mcluster)
+{
+    cluster->indexesOffset = mcluster->indexesOffset;
+    cluster->indexesCount = mcluster->indexesCount;
+    cluster->center = mcluster->center;
+    cluster->radius = mcluster->radius;
+    cluster->coneApex = mcluster->coneApex;
+    cluster->coneAxis = mcluster->coneAxis;
+    cluster->coneCutoff = mcluster->coneCutoff;
+}
+
+static uint32_t lite3d_mesh_lods_count(lite3d_mesh *mesh)
+{
+    lite3d_list_node *link;
+    uint32_t count = 0;
+
+    for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link))
+        count += LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link)->lodsCount;
+
+    return count;
+}
+
+static size_t lite3d_m_record_size(uint32_t sig)
+{
+    switch (sig)
+    {
+    case LITE3D_M_CLUSTER_SIGNATURE:
+        return sizeof (lite3d_m_cluster);
+    case LITE3D_M_LOD_SIGNATURE:
+        return sizeof (lite3d_m_lod);
+    default:
+        return 0;
+    }
+}
+
+/* 
+ * Returns records of optional section sig or NULL if file has no valid one, sectionSize (optional) 
+ * gets size of the section with its header. Sections may go in any order, walk stops at unknown one.
+ */
+static const uint8_t *lite3d_m_find_section(const uint8_t *data, size_t size, 
+    const lite3d_m_header *mheader, uint32_t sig, uint32_t *recordsCount, size_t *sectionSize)
+{
+    lite3d_m_section_header sheader;
+    size_t recordSize, offset = sizeof (lite3d_m_header) + (size_t)mheader->chunkSectionSize + 
+        mheader->vertexSectionSize + mheader->indexSectionSize;
+
+    *recordsCount = 0;
+    if (sectionSize)
+        *sectionSize = 0;
+
+    while (offset + sizeof (sheader) <= size)
+    {
+        memcpy(&sheader, data + offset, sizeof (sheader));
+        if ((recordSize = lite3d_m_record_size(sheader.sig)) == 0 ||
+            (size - offset - sizeof (sheader)) / recordSize < sheader.recordsCount)
+            break;
+
+        if (sheader.sig == sig)
+        {
+            *recordsCount = sheader.recordsCount;
+            if (sectionSize)
+                *sectionSize = sizeof (sheader) + recordSize * sheader.recordsCount;
+            return data + offset + sizeof (sheader);
+        }
+
+        offset += sizeof (sheader) + recordSize * sheader.recordsCount;
+    }
+
+    return NULL;
+}
+
+/* 
+ * Copies clusters of chunk chunkIndex starting from *cursor record, cursor is moved past them.
+ * Clusters out of chunk indexes are rejected so broken section can not make draw read foreign indexes.
+ */
+static int lite3d_m_read_chunk_clusters(const uint8_t *records, uint32_t recordsCount, uint32_t *cursor, 
+    uint32_t chunkIndex, uint32_t chunkIndexesCount, lite3d_mesh_cluster **clusters, uint32_t *clustersCount)
+{
+    lite3d_m_cluster mcluster;
+    uint32_t first, i;
+
+    *clusters = NULL;
+    *clustersCount = 0;
+
+    for (; *cursor < recordsCount; (*cursor)++)
+    {
+        memcpy(&mcluster, records + (size_t)*cursor * sizeof (mcluster), sizeof (mcluster));
+        if (mcluster.chunkIndex >= chunkIndex)
+            break;
+    }
+
+    for (first = *cursor; *cursor < recordsCount; (*cursor)++)
+    {
+        memcpy(&mcluster, records + (size_t)*cursor * sizeof (mcluster), sizeof (mcluster));
+        if (mcluster.chunkIndex != chunkIndex)
+            break;
+        if ((uint64_t)mcluster.indexesOffset + mcluster.indexesCount > chunkIndexesCount)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: Chunk %u cluster %u is out of chunk indexes, clusters ignored",
+                LITE3D_CURRENT_FUNCTION, chunkIndex, *cursor - first);
+            return LITE3D_TRUE;
+        }
+    }
+
+    if (*cursor == first)
+        return LITE3D_TRUE;
+
+    if (!(*clusters = lite3d_malloc(sizeof (lite3d_mesh_cluster) * (*cursor - first))))
+        return LITE3D_FALSE;
+
+    for (i = first; i < *cursor; ++i)
+    {
+        memcpy(&mcluster, records + (size_t)i * sizeof (mcluster), sizeof (mcluster));
+        lite3d_m_cluster_unpack(&(*clusters)[i - first], &mcluster);
+    }
+
+    *clustersCount = *cursor - first;
+    return LITE3D_TRUE;
+}
+
+/* 
+ * Copies levels of chunk chunkIndex starting from *cursor record, cursor is moved past them. Levels out of
+ * chunk index range or with decreasing error are rejected, chunk is drawn at full detail then.
+ */
+static int lite3d_m_read_chunk_lods(const uint8_t *records, uint32_t recordsCount, uint32_t *cursor, 
+    uint32_t chunkIndex, uint32_t chunkIndexesCapacity, lite3d_mesh_lod **lods, uint32_t *lodsCount)
+{
+    lite3d_m_lod mlod;
+    uint32_t first, i;
+    float error = 0.0f;
+
+    *lods = NULL;
+    *lodsCount = 0;
+
+    for (; *cursor < recordsCount; (*cursor)++)
+    {
+        memcpy(&mlod, records + (size_t)*cursor * sizeof (mlod), sizeof (mlod));
+        if (mlod.chunkIndex >= chunkIndex)
+            break;
+    }
+
+    for (first = *cursor; *cursor < recordsCount; (*cursor)++)
+    {
+        memcpy(&mlod, records + (size_t)*cursor * sizeof (mlod), sizeof (mlod));
+        if (mlod.chunkIndex != chunkIndex)
+            break;
+        if ((uint64_t)mlod.indexesOffset + mlod.indexesCount > chunkIndexesCapacity || 
+            mlod.indexesCount % 3 != 0 || !(mlod.error >= error))
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: Chunk %u level %u is malformed, levels ignored",
+                LITE3D_CURRENT_FUNCTION, chunkIndex, *cursor - first + 1);
+            return LITE3D_TRUE;
+        }
+
+        error = mlod.error;
+    }
+
+    if (*cursor == first)
+        return LITE3D_TRUE;
+
+    if (!(*lods = lite3d_malloc(sizeof (lite3d_mesh_lod) * (*cursor - first))))
+        return LITE3D_FALSE;
+
+    for (i = first; i < *cursor; ++i)
+    {
+        memcpy(&mlod, records + (size_t)i * sizeof (mlod), sizeof (mlod));
+        (*lods)[i - first].indexesOffset = mlod.indexesOffset;
+        (*lods)[i - first].indexesCount = mlod.indexesCount;
+        (*lods)[i - first].error = mlod.error;
+    }
+
+    *lodsCount = *cursor - first;
+    return LITE3D_TRUE;
+}
+
 static int lite3d_append_buffer_from_stream(lite3d_vbo *buffer, size_t bufferOffset, size_t size, SDL_RWops *stream)
 {
     SDL_assert(buffer);
@@ -172,7 +423,8 @@ static int lite3d_append_buffer_from_stream(lite3d_vbo *buffer, size_t bufferOff
 
 size_t lite3d_mesh_m_encode_size(lite3d_mesh *mesh)
 {
-    size_t result = 0;
+    size_t result = 0, verticesSize, indexesSize;
+    uint32_t clustersCount, lodsCount;
     lite3d_list_node *link;
     lite3d_mesh_chunk *meshChunk;
     SDL_assert(mesh);
@@ -186,8 +438,22 @@ size_t lite3d_mesh_m_encode_size(lite3d_mesh *mesh)
         result += sizeof (lite3d_m_chunk_layout) * meshChunk->layout.size;
     }
 
-    result += mesh->vertexBuffer.size;
-    result += mesh->indexBuffer.size;
+    lite3d_mesh_used_size(mesh, &verticesSize, &indexesSize);
+    result += verticesSize;
+    result += indexesSize;
+
+    if ((clustersCount = lite3d_mesh_clusters_count(mesh)) > 0)
+    {
+        result += sizeof (lite3d_m_section_header);
+        result += sizeof (lite3d_m_cluster) * clustersCount;
+    }
+
+    if ((lodsCount = lite3d_mesh_lods_count(mesh)) > 0)
+    {
+        result += sizeof (lite3d_m_section_header);
+        result += sizeof (lite3d_m_lod) * lodsCount;
+    }
+
     return result;
 }
 
@@ -200,22 +466,16 @@ int lite3d_mesh_m_decode(lite3d_mesh *mesh,
     lite3d_m_chunk_layout layout;
     lite3d_vao_layout meshLayout[CHUNK_LAYOUT_MAX_COUNT];
     register uint32_t i = 0;
-    size_t indicesOffset = 0, initialIndicesOffset = 0;
-    size_t verticesOffset = 0, initialVerticesOffset = 0;
+    size_t initialIndicesOffset = 0;
+    size_t initialVerticesOffset = 0;
     uint32_t chunkSectionOffset = 0;
     lite3d_mesh_chunk *thisChunk = NULL;
+    const uint8_t *clusterRecords = NULL, *lodRecords = NULL;
+    uint32_t clusterRecordsCount = 0, clusterCursor = 0, lodRecordsCount = 0, lodCursor = 0;
     
     SDL_assert(mesh);
     SDL_assert(buffer);
 
-    // Если mesh уже содержит данные то надо корректно вычислить offset от последнего чанка
-    if (!lite3d_list_is_empty(&mesh->chunks))
-    {
-        lite3d_mesh_chunk *lastChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, lite3d_list_last_link(&mesh->chunks), link);
-        initialIndicesOffset = indicesOffset = lastChunk->vao.indexesOffset + lastChunk->vao.indexesSize;
-        initialVerticesOffset = verticesOffset = lastChunk->vao.verticesOffset + lastChunk->vao.verticesSize;
-    }
-
     /* open memory stream */
     stream = SDL_RWFromConstMem(buffer, (int)size);
 
@@ -234,6 +494,10 @@ int lite3d_mesh_m_decode(lite3d_mesh *mesh,
     }
     
     mesh->version = mheader.version;
+    clusterRecords = lite3d_m_find_section((const uint8_t *)buffer, size, &mheader, LITE3D_M_CLUSTER_SIGNATURE, 
+        &clusterRecordsCount, NULL);
+    lodRecords = lite3d_m_find_section((const uint8_t *)buffer, size, &mheader, LITE3D_M_LOD_SIGNATURE, 
+        &lodRecordsCount, NULL);
     for (i = 0; i < mheader.chunkCount; ++i)
     {
         register uint32_t j = 0;
@@ -267,9 +531,18 @@ int lite3d_mesh_m_decode(lite3d_mesh *mesh,
             meshLayout[j].count = layout.count;
         }
 
+        // Место под все секции выделяем разом, смещения чанков в файле считаются от начала секции
+        if (i == 0 && !lite3d_mesh_alloc_chunk_space(mesh, mheader.vertexSectionSize, stride, 
+            mheader.indexSectionSize, &initialVerticesOffset, &initialIndicesOffset))
+        {
+            SDL_RWclose(stream);
+            return LITE3D_FALSE;
+        }
+
         /* append new batch */
         if (!(thisChunk = lite3d_mesh_append_chunk(mesh, meshLayout, mchunk.chunkLayoutCount, stride,
-            mchunk.indexesCount, mchunk.indexesSize, indicesOffset, mchunk.verticesCount, mchunk.verticesSize, verticesOffset)))
+            mchunk.indexesCount, mchunk.indexesSize, initialIndicesOffset + mchunk.indexesOffset, 
+            mchunk.verticesCount, mchunk.verticesSize, initialVerticesOffset + mchunk.verticesOffset)))
         {
             return LITE3D_FALSE;
         }
@@ -278,8 +551,20 @@ int lite3d_mesh_m_decode(lite3d_mesh *mesh,
         thisChunk->materialIndex = mchunk.materialIndex;
         thisChunk->boundingVol = mchunk.boundingVol;
 
-        indicesOffset += mchunk.indexesSize;
-        verticesOffset += mchunk.verticesSize;
+        if (clusterRecords && thisChunk->hasIndexes && !lite3d_m_read_chunk_clusters(clusterRecords, 
+            clusterRecordsCount, &clusterCursor, i, mchunk.indexesCount, &thisChunk->clusters, &thisChunk->clustersCount))
+        {
+            SDL_RWclose(stream);
+            return LITE3D_FALSE;
+        }
+
+        if (lodRecords && thisChunk->hasIndexes && !lite3d_m_read_chunk_lods(lodRecords, lodRecordsCount, 
+            &lodCursor, i, mchunk.indexesSize / sizeof (uint32_t), &thisChunk->lods, &thisChunk->lodsCount))
+        {
+            SDL_RWclose(stream);
+            return LITE3D_FALSE;
+        }
+
         mesh->verticesCount += mchunk.verticesCount;
         mesh->elementsCount += mchunk.indexesCount / 3;
         
@@ -321,6 +606,256 @@ int lite3d_mesh_m_decode(lite3d_mesh *mesh,
     return LITE3D_TRUE;
 }
 
+/* Reads chunk header and finds position attribute, returns chunk size or 0 on error */
+static uint32_t lite3d_read_geometry_chunk(const uint8_t *data, size_t size, size_t offset,
+    lite3d_m_chunk *mchunk, uint32_t *stride, uint32_t *positionOffset)
+{
+    lite3d_m_chunk_layout layout;
+    uint32_t i, attribOffset = 0;
+    int positionFound = LITE3D_FALSE;
+
+    if (offset + sizeof (lite3d_m_chunk) > size)
+        return 0;
+
+    memcpy(mchunk, data + offset, sizeof (lite3d_m_chunk));
+    if (offset + sizeof (lite3d_m_chunk) + mchunk->chunkLayoutCount * sizeof (lite3d_m_chunk_layout) > size)
+        return 0;
+
+    for (i = 0; i < mchunk->chunkLayoutCount && i < CHUNK_LAYOUT_MAX_COUNT; ++i)
+    {
+        memcpy(&layout, data + offset + sizeof (lite3d_m_chunk) + i * sizeof (layout), sizeof (layout));
+        if (!positionFound && layout.binding == LITE3D_BUFFER_BINDING_VERTEX && layout.count >= 3)
+        {
+            *positionOffset = attribOffset;
+            positionFound = LITE3D_TRUE;
+        }
+
+        attribOffset += layout.count * sizeof (float);
+    }
+
+    *stride = attribOffset;
+    return positionFound ? mchunk->chunkSize : 0;
+}
+
+/* LOD0 and levels after it */
+static uint32_t lite3d_m_geometry_chunk_indexes(const lite3d_mesh_m_geometry *geometry, 
+    const lite3d_mesh_m_geometry_chunk *chunk)
+{
+    uint32_t i, count = chunk->indexesCount;
+
+    for (i = 0; i < chunk->lodsCount; ++i)
+    {
+        const lite3d_mesh_lod *lod = &geometry->lods[chunk->lodsOffset + i];
+        if (lod->indexesOffset + lod->indexesCount > count)
+            count = lod->indexesOffset + lod->indexesCount;
+    }
+
+    return count;
+}
+
+int lite3d_mesh_m_decode_geometry(lite3d_mesh_m_geometry *geometry, 
+    const void *buffer, size_t size)
+{
+    const uint8_t *data = (const uint8_t *)buffer;
+    const uint8_t *vertexSection, *indexSection;
+    lite3d_m_header mheader;
+    lite3d_m_chunk mchunk;
+    uint32_t i, j, stride, positionOffset, chunkSize;
+    size_t chunkOffset;
+    const uint8_t *clusterRecords, *lodRecords;
+    uint32_t clusterRecordsCount = 0, clusterCursor = 0, lodRecordsCount = 0, lodCursor = 0;
+
+    SDL_assert(geometry);
+    SDL_assert(buffer);
+
+    memset(geometry, 0, sizeof (lite3d_mesh_m_geometry));
+    if (size < sizeof (mheader))
+        return LITE3D_FALSE;
+
+    memcpy(&mheader, data, sizeof (mheader));
+    if (mheader.sig != LITE3D_M_SIGNATURE)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Signature mismatch: %d vs %d",
+            LITE3D_CURRENT_FUNCTION, mheader.sig, LITE3D_M_SIGNATURE);
+        return LITE3D_FALSE;
+    }
+
+    if ((size_t)mheader.chunkSectionSize + mheader.vertexSectionSize + mheader.indexSectionSize > 
+        size - sizeof (mheader))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Sections exceed buffer size",
+            LITE3D_CURRENT_FUNCTION);
+        return LITE3D_FALSE;
+    }
+
+    vertexSection = data + sizeof (mheader) + mheader.chunkSectionSize;
+    indexSection = vertexSection + mheader.vertexSectionSize;
+
+    if (mheader.chunkCount > 0 && 
+        !(geometry->chunks = lite3d_calloc(sizeof (lite3d_mesh_m_geometry_chunk) * mheader.chunkCount)))
+        return LITE3D_FALSE;
+    geometry->chunksCount = mheader.chunkCount;
+
+    if ((lodRecords = lite3d_m_find_section(data, size, &mheader, LITE3D_M_LOD_SIGNATURE, &lodRecordsCount, NULL)) != NULL &&
+        lodRecordsCount > 0 && !(geometry->lods = lite3d_malloc(sizeof (lite3d_mesh_lod) * lodRecordsCount)))
+    {
+        lite3d_mesh_m_geometry_purge(geometry);
+        return LITE3D_FALSE;
+    }
+
+    /* first pass: validate chunks and count elements */
+    for (i = 0, chunkOffset = sizeof (mheader); i < mheader.chunkCount; ++i, chunkOffset += chunkSize)
+    {
+        lite3d_mesh_m_geometry_chunk *chunk = &geometry->chunks[i];
+        if (!(chunkSize = lite3d_read_geometry_chunk(data, sizeof (mheader) + mheader.chunkSectionSize, 
+            chunkOffset, &mchunk, &stride, &positionOffset)))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Chunk %u is malformed or has no positions",
+                LITE3D_CURRENT_FUNCTION, i);
+            lite3d_mesh_m_geometry_purge(geometry);
+            return LITE3D_FALSE;
+        }
+
+        if ((size_t)mchunk.verticesOffset + (size_t)mchunk.verticesCount * stride > mheader.vertexSectionSize ||
+            (size_t)mchunk.indexesCount * sizeof (uint32_t) > mchunk.indexesSize ||
+            (size_t)mchunk.indexesOffset + mchunk.indexesSize > mheader.indexSectionSize)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Chunk %u data is out of sections",
+                LITE3D_CURRENT_FUNCTION, i);
+            lite3d_mesh_m_geometry_purge(geometry);
+            return LITE3D_FALSE;
+        }
+
+        chunk->verticesOffset = geometry->verticesCount;
+        chunk->verticesCount = mchunk.verticesCount;
+        chunk->indexesOffset = geometry->indexesCount;
+        chunk->indexesCount = mchunk.indexesCount;
+        chunk->materialIndex = mchunk.materialIndex;
+        chunk->boundingVol = mchunk.boundingVol;
+        chunk->lodsOffset = geometry->lodsCount;
+
+        if (geometry->lods && chunk->indexesCount > 0)
+        {
+            lite3d_mesh_lod *lods;
+            if (!lite3d_m_read_chunk_lods(lodRecords, lodRecordsCount, &lodCursor, i, 
+                mchunk.indexesSize / sizeof (uint32_t), &lods, &chunk->lodsCount))
+            {
+                lite3d_mesh_m_geometry_purge(geometry);
+                return LITE3D_FALSE;
+            }
+
+            if (lods)
+            {
+                memcpy(geometry->lods + geometry->lodsCount, lods, sizeof (lite3d_mesh_lod) * chunk->lodsCount);
+                geometry->lodsCount += chunk->lodsCount;
+                lite3d_free(lods);
+            }
+        }
+
+        geometry->verticesCount += mchunk.verticesCount;
+        geometry->indexesCount += lite3d_m_geometry_chunk_indexes(geometry, chunk);
+    }
+
+    if ((geometry->verticesCount > 0 && 
+        !(geometry->positions = lite3d_malloc(sizeof (float) * 3 * geometry->verticesCount))) ||
+        (geometry->indexesCount > 0 && 
+        !(geometry->indexes = lite3d_malloc(sizeof (uint32_t) * geometry->indexesCount))))
+    {
+        lite3d_mesh_m_geometry_purge(geometry);
+        return LITE3D_FALSE;
+    }
+
+    /* second pass: copy position stream and indexes of each chunk */
+    for (i = 0, chunkOffset = sizeof (mheader); i < mheader.chunkCount; ++i, chunkOffset += chunkSize)
+    {
+        lite3d_mesh_m_geometry_chunk *chunk = &geometry->chunks[i];
+        const uint8_t *vertex;
+        float *position = geometry->positions + (size_t)chunk->verticesOffset * 3;
+        uint32_t *index = geometry->indexes + chunk->indexesOffset;
+        uint32_t indexesCount = lite3d_m_geometry_chunk_indexes(geometry, chunk);
+
+        chunkSize = lite3d_read_geometry_chunk(data, sizeof (mheader) + mheader.chunkSectionSize, 
+            chunkOffset, &mchunk, &stride, &positionOffset);
+
+        vertex = vertexSection + mchunk.verticesOffset + positionOffset;
+        for (j = 0; j < chunk->verticesCount; ++j, vertex += stride, position += 3)
+        {
+            memcpy(position, vertex, sizeof (float) * 3);
+        }
+
+        if (indexesCount > 0)
+        {
+            memcpy(index, indexSection + mchunk.indexesOffset, sizeof (uint32_t) * indexesCount);
+        }
+
+        for (j = 0; j < indexesCount; ++j)
+        {
+            if (index[j] >= chunk->verticesCount)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Chunk %u index %u is out of vertices",
+                    LITE3D_CURRENT_FUNCTION, i, j);
+                lite3d_mesh_m_geometry_purge(geometry);
+                return LITE3D_FALSE;
+            }
+        }
+    }
+
+    /* third pass: clusters if file has them */
+    if ((clusterRecords = lite3d_m_find_section(data, size, &mheader, LITE3D_M_CLUSTER_SIGNATURE, 
+        &clusterRecordsCount, NULL)) != NULL &&
+        clusterRecordsCount > 0)
+    {
+        if (!(geometry->clusters = lite3d_malloc(sizeof (lite3d_mesh_cluster) * clusterRecordsCount)))
+        {
+            lite3d_mesh_m_geometry_purge(geometry);
+            return LITE3D_FALSE;
+        }
+
+        for (i = 0; i < geometry->chunksCount; ++i)
+        {
+            lite3d_mesh_m_geometry_chunk *chunk = &geometry->chunks[i];
+            lite3d_mesh_cluster *clusters;
+            uint32_t clustersCount;
+
+            if (!lite3d_m_read_chunk_clusters(clusterRecords, clusterRecordsCount, &clusterCursor, i, 
+                chunk->indexesCount, &clusters, &clustersCount))
+            {
+                lite3d_mesh_m_geometry_purge(geometry);
+                return LITE3D_FALSE;
+            }
+
+            chunk->clustersOffset = geometry->clustersCount;
+            chunk->clustersCount = clustersCount;
+            if (clusters)
+            {
+                memcpy(geometry->clusters + geometry->clustersCount, clusters, sizeof (lite3d_mesh_cluster) * clustersCount);
+                geometry->clustersCount += clustersCount;
+                lite3d_free(clusters);
+            }
+        }
+    }
+
+    return LITE3D_TRUE;
+}
+
+void lite3d_mesh_m_geometry_purge(lite3d_mesh_m_geometry *geometry)
+{
+    SDL_assert(geometry);
+
+    if (geometry->chunks)
+        lite3d_free(geometry->chunks);
+    if (geometry->positions)
+        lite3d_free(geometry->positions);
+    if (geometry->indexes)
+        lite3d_free(geometry->indexes);
+    if (geometry->clusters)
+        lite3d_free(geometry->clusters);
+    if (geometry->lods)
+        lite3d_free(geometry->lods);
+
+    memset(geometry, 0, sizeof (lite3d_mesh_m_geometry));
+}
+
 int lite3d_mesh_m_encode(lite3d_mesh *mesh,
     void *buffer, size_t size)
 {
@@ -329,15 +864,21 @@ int lite3d_mesh_m_encode(lite3d_mesh *mesh,
     lite3d_m_header mheader;
     lite3d_m_chunk mchunk;
     lite3d_m_chunk_layout layout;
+    lite3d_m_section_header sheader;
+    lite3d_m_cluster mcluster;
+    lite3d_m_lod mlod;
+    uint32_t chunkIndex;
     SDL_RWops *stream;
+    size_t verticesSize, indexesSize;
 
     SDL_assert(mesh);
     SDL_assert(buffer);
 
+    lite3d_mesh_used_size(mesh, &verticesSize, &indexesSize);
     mheader.sig = LITE3D_M_SIGNATURE;
     mheader.version = LITE3D_VERSION_NUM;
-    mheader.vertexSectionSize = (uint32_t)mesh->vertexBuffer.size;
-    mheader.indexSectionSize = (uint32_t)mesh->indexBuffer.size;
+    mheader.vertexSectionSize = (uint32_t)verticesSize;
+    mheader.indexSectionSize = (uint32_t)indexesSize;
     mheader.chunkCount = (uint32_t)lite3d_list_count(&mesh->chunks);
     mheader.chunkSectionSize = 0;
 
@@ -396,21 +937,318 @@ int lite3d_mesh_m_encode(lite3d_mesh *mesh,
         }
     }
 
-    if (!lite3d_write_buffer_to_stream(&mesh->vertexBuffer, stream))
+    if (!lite3d_write_buffer_to_stream(&mesh->vertexBuffer, verticesSize, stream))
     {
         SDL_RWclose(stream);
         return LITE3D_FALSE;
     }
 
-    if (mesh->indexBuffer.size > 0)
+    if (indexesSize > 0)
+    {
+        if (!lite3d_write_buffer_to_stream(&mesh->indexBuffer, indexesSize, stream))
+        {
+            SDL_RWclose(stream);
+            return LITE3D_FALSE;
+        }
+    }
+
+    if ((sheader.recordsCount = lite3d_mesh_clusters_count(mesh)) > 0)
+    {
+        sheader.sig = LITE3D_M_CLUSTER_SIGNATURE;
+        if (SDL_RWwrite(stream, &sheader, sizeof (sheader), 1) != 1)
+        {
+            SDL_RWclose(stream);
+            return LITE3D_FALSE;
+        }
+
+        chunkIndex = 0;
+        for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link), ++chunkIndex)
+        {
+            meshChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link);
+            for (uint32_t i = 0; i < meshChunk->clustersCount; ++i)
+            {
+                lite3d_m_cluster_pack(&mcluster, chunkIndex, &meshChunk->clusters[i]);
+                if (SDL_RWwrite(stream, &mcluster, sizeof (mcluster), 1) != 1)
+                {
+                    SDL_RWclose(stream);
+                    return LITE3D_FALSE;
+                }
+            }
+        }
+    }
+
+    if ((sheader.recordsCount = lite3d_mesh_lods_count(mesh)) > 0)
     {
-        if (!lite3d_write_buffer_to_stream(&mesh->indexBuffer, stream))
+        sheader.sig = LITE3D_M_LOD_SIGNATURE;
+        if (SDL_RWwrite(stream, &sheader, sizeof (sheader), 1) != 1)
         {
             SDL_RWclose(stream);
             return LITE3D_FALSE;
         }
+
+        chunkIndex = 0;
+        for (link = mesh->chunks.l.next; link != &mesh->chunks.l; link = lite3d_list_next(link), ++chunkIndex)
+        {
+            meshChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, link, link);
+            for (uint32_t i = 0; i < meshChunk->lodsCount; ++i)
+            {
+                mlod.chunkIndex = chunkIndex;
+                mlod.indexesOffset = meshChunk->lods[i].indexesOffset;
+                mlod.indexesCount = meshChunk->lods[i].indexesCount;
+                mlod.error = meshChunk->lods[i].error;
+                if (SDL_RWwrite(stream, &mlod, sizeof (mlod), 1) != 1)
+                {
+                    SDL_RWclose(stream);
+                    return LITE3D_FALSE;
+                }
+            }
+        }
     }
 
     SDL_RWclose(stream);
     return LITE3D_TRUE;
 }
+
+int lite3d_mesh_m_build_clusters(const void *buffer, size_t size, uint32_t maxVertices, uint32_t maxTriangles,
+    void **out, size_t *outSize)
+{
+    const uint8_t *data = (const uint8_t *)buffer;
+    lite3d_mesh_m_geometry geometry;
+    lite3d_m_header mheader;
+    lite3d_m_chunk mchunk;
+    lite3d_m_section_header sheader;
+    lite3d_m_cluster mcluster;
+    lite3d_array clusters;
+    uint8_t *result = NULL, *indexSection;
+    const uint8_t *lodSection;
+    size_t baseSize, chunkOffset, clusterSectionSize, lodSectionSize;
+    uint32_t lodRecordsCount;
+    uint32_t i, j, stride, positionOffset, chunkSize;
+    int ok = LITE3D_FALSE;
+
+    SDL_assert(buffer);
+    SDL_assert(out);
+    SDL_assert(outSize);
+
+    /* validates sections and indexes, gives aligned copies of positions and indexes */
+    if (!lite3d_mesh_m_decode_geometry(&geometry, buffer, size))
+        return LITE3D_FALSE;
+
+    memcpy(&mheader, data, sizeof (mheader));
+    lite3d_array_init(&clusters, sizeof (lite3d_mesh_cluster), 64);
+    baseSize = sizeof (mheader) + (size_t)mheader.chunkSectionSize + mheader.vertexSectionSize + mheader.indexSectionSize;
+
+    for (i = 0; i < geometry.chunksCount; ++i)
+    {
+        lite3d_mesh_m_geometry_chunk *chunk = &geometry.chunks[i];
+        size_t first = clusters.size;
+
+        chunk->clustersOffset = (uint32_t)first;
+        chunk->clustersCount = 0;
+        /* triangle lists only, chunks without indexes are drawn as a whole */
+        if (chunk->indexesCount == 0 || chunk->indexesCount % 3 != 0)
+            continue;
+
+        if (!lite3d_mesh_clusters_build(geometry.positions + (size_t)chunk->verticesOffset * 3, sizeof (kmVec3), 
+            chunk->verticesCount, geometry.indexes + chunk->indexesOffset, chunk->indexesCount, 
+            maxVertices, maxTriangles, &clusters))
+            goto exit;
+
+        chunk->clustersCount = (uint32_t)(clusters.size - first);
+    }
+
+    /* levels of detail refer to indexes after LOD0 which are not reordered, they are kept as is */
+    lodSection = lite3d_m_find_section(data, size, &mheader, LITE3D_M_LOD_SIGNATURE, &lodRecordsCount, &lodSectionSize);
+    clusterSectionSize = sizeof (sheader) + sizeof (mcluster) * clusters.size;
+    if (!(result = lite3d_malloc(baseSize + clusterSectionSize + lodSectionSize)))
+        goto exit;
+
+    /* previous cluster section is dropped, reordered indexes replace original ones */
+    memcpy(result, data, baseSize);
+    indexSection = result + sizeof (mheader) + mheader.chunkSectionSize + mheader.vertexSectionSize;
+    for (i = 0, chunkOffset = sizeof (mheader); i < geometry.chunksCount; ++i, chunkOffset += chunkSize)
+    {
+        lite3d_mesh_m_geometry_chunk *chunk = &geometry.chunks[i];
+        chunkSize = lite3d_read_geometry_chunk(data, sizeof (mheader) + mheader.chunkSectionSize, 
+            chunkOffset, &mchunk, &stride, &positionOffset);
+
+        memcpy(indexSection + mchunk.indexesOffset, geometry.indexes + chunk->indexesOffset, 
+            sizeof (uint32_t) * chunk->indexesCount);
+    }
+
+    sheader.sig = LITE3D_M_CLUSTER_SIGNATURE;
+    sheader.recordsCount = (uint32_t)clusters.size;
+    memcpy(result + baseSize, &sheader, sizeof (sheader));
+    for (i = 0; i < geometry.chunksCount; ++i)
+    {
+        for (j = 0; j < geometry.chunks[i].clustersCount; ++j)
+        {
+            uint32_t index = geometry.chunks[i].clustersOffset + j;
+            lite3d_m_cluster_pack(&mcluster, i, (lite3d_mesh_cluster *)lite3d_array_get(&clusters, index));
+            memcpy(result + baseSize + sizeof (sheader) + sizeof (mcluster) * index, &mcluster, sizeof (mcluster));
+        }
+    }
+
+    if (lodSection)
+        memcpy(result + baseSize + clusterSectionSize, lodSection - sizeof (sheader), lodSectionSize);
+
+    *out = result;
+    *outSize = baseSize + clusterSectionSize + lodSectionSize;
+    ok = LITE3D_TRUE;
+
+exit:
+    lite3d_array_purge(&clusters);
+    lite3d_mesh_m_geometry_purge(&geometry);
+    return ok;
+}
+
+/* Level removing less than this part of triangles of previous level is not worth its indexes */
+#define LOD_MIN_LEVEL_GAIN  0.9f
+
+int lite3d_mesh_m_build_lods(const void *buffer, size_t size, uint32_t levelsCount, float reduction, 
+    float maxError, void **out, size_t *outSize)
+{
+    const uint8_t *data = (const uint8_t *)buffer;
+    lite3d_mesh_m_geometry geometry;
+    lite3d_m_header mheader;
+    lite3d_m_chunk mchunk;
+    lite3d_m_section_header sheader;
+    lite3d_m_lod *mlod;
+    lite3d_array lods, indexes;
+    uint32_t *simplified = NULL, *chunkRanges = NULL;
+    const uint8_t *clusterSection;
+    uint8_t *result = NULL, *cursor;
+    size_t chunkOffset, clusterSectionSize, lodSectionSize, resultSize;
+    uint32_t i, level, stride, positionOffset, chunkSize, clusterRecordsCount, maxIndexesCount = 0;
+    int ok = LITE3D_FALSE;
+
+    SDL_assert(buffer);
+    SDL_assert(out);
+    SDL_assert(outSize);
+
+    if (levelsCount == 0 || levelsCount > LITE3D_LOD_MAX_LEVELS || !(reduction > 0.0f && reduction < 1.0f))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Bad levels count %u or reduction %f",
+            LITE3D_CURRENT_FUNCTION, levelsCount, reduction);
+        return LITE3D_FALSE;
+    }
+
+    /* validates sections and indexes, gives aligned copies of positions and indexes */
+    if (!lite3d_mesh_m_decode_geometry(&geometry, buffer, size))
+        return LITE3D_FALSE;
+
+    memcpy(&mheader, data, sizeof (mheader));
+    lite3d_array_init(&lods, sizeof (lite3d_m_lod), 16);
+    lite3d_array_init(&indexes, sizeof (uint32_t), geometry.indexesCount + 1);
+
+    for (i = 0; i < geometry.chunksCount; ++i)
+    {
+        if (geometry.chunks[i].indexesCount > maxIndexesCount)
+            maxIndexesCount = geometry.chunks[i].indexesCount;
+    }
+
+    /* new offset and size in indexes of every chunk range */
+    if (!(simplified = lite3d_malloc(sizeof (uint32_t) * ((size_t)maxIndexesCount + 1))) ||
+        !(chunkRanges = lite3d_malloc(sizeof (uint32_t) * 2 * ((size_t)geometry.chunksCount + 1))))
+        goto exit;
+
+    for (i = 0; i < geometry.chunksCount; ++i)
+    {
+        const lite3d_mesh_m_geometry_chunk *chunk = &geometry.chunks[i];
+        const uint32_t *chunkIndexes = geometry.indexes + chunk->indexesOffset;
+        uint32_t previousCount = chunk->indexesCount, resultCount;
+        float previousError = 0.0f, error;
+
+        chunkRanges[i * 2] = (uint32_t)indexes.size;
+        /* LOD0 stays at the start of range, clusters refer to it, old levels are dropped */
+        if (chunk->indexesCount > 0 && !lite3d_array_append(&indexes, chunkIndexes, chunk->indexesCount))
+            goto exit;
+
+        for (level = 1; level <= levelsCount && chunk->indexesCount > 0 && chunk->indexesCount % 3 == 0 &&
+            chunk->boundingVol.radius > 0.0f; ++level)
+        {
+            if (!lite3d_mesh_simplify(geometry.positions + (size_t)chunk->verticesOffset * 3, sizeof (kmVec3),
+                chunk->verticesCount, chunkIndexes, chunk->indexesCount, (uint32_t)(previousCount * reduction), 
+                maxError * chunk->boundingVol.radius, simplified, &resultCount, &error))
+                goto exit;
+
+            if (resultCount == 0 || resultCount > previousCount * LOD_MIN_LEVEL_GAIN)
+                break;
+
+            /* quadric error is RMS estimate, selection compares levels with a hard bound */
+            if (!lite3d_mesh_deviation(geometry.positions + (size_t)chunk->verticesOffset * 3, sizeof (kmVec3),
+                chunk->verticesCount, chunkIndexes, chunk->indexesCount, simplified, resultCount, &error))
+                goto exit;
+            if (error > maxError * chunk->boundingVol.radius)
+                break;
+
+            /* every level is simplified from LOD0, error must not decrease for level selection */
+            if (!(mlod = lite3d_array_add(&lods)))
+                goto exit;
+            mlod->chunkIndex = i;
+            mlod->indexesOffset = (uint32_t)indexes.size - chunkRanges[i * 2];
+            mlod->indexesCount = resultCount;
+            mlod->error = previousError = error > previousError ? error : previousError;
+
+            if (!lite3d_array_append(&indexes, simplified, resultCount))
+                goto exit;
+            previousCount = resultCount;
+        }
+
+        chunkRanges[i * 2 + 1] = (uint32_t)indexes.size - chunkRanges[i * 2];
+    }
+
+    clusterSection = lite3d_m_find_section(data, size, &mheader, LITE3D_M_CLUSTER_SIGNATURE, &clusterRecordsCount, 
+        &clusterSectionSize);
+    lodSectionSize = lods.size > 0 ? sizeof (sheader) + sizeof (lite3d_m_lod) * lods.size : 0;
+    resultSize = sizeof (mheader) + (size_t)mheader.chunkSectionSize + mheader.vertexSectionSize +
+        sizeof (uint32_t) * indexes.size + clusterSectionSize + lodSectionSize;
+    if (!(result = lite3d_malloc(resultSize)))
+        goto exit;
+
+    /* header, chunks and vertices are copied, chunk index ranges are moved */
+    mheader.indexSectionSize = (uint32_t)(sizeof (uint32_t) * indexes.size);
+    memcpy(result, &mheader, sizeof (mheader));
+    memcpy(result + sizeof (mheader), data + sizeof (mheader), 
+        (size_t)mheader.chunkSectionSize + mheader.vertexSectionSize);
+    for (i = 0, chunkOffset = sizeof (mheader); i < geometry.chunksCount; ++i, chunkOffset += chunkSize)
+    {
+        chunkSize = lite3d_read_geometry_chunk(data, sizeof (mheader) + mheader.chunkSectionSize, 
+            chunkOffset, &mchunk, &stride, &positionOffset);
+
+        mchunk.indexesOffset = chunkRanges[i * 2] * (uint32_t)sizeof (uint32_t);
+        mchunk.indexesSize = chunkRanges[i * 2 + 1] * (uint32_t)sizeof (uint32_t);
+        memcpy(result + chunkOffset, &mchunk, sizeof (mchunk));
+    }
+
+    cursor = result + sizeof (mheader) + mheader.chunkSectionSize + mheader.vertexSectionSize;
+    if (indexes.size > 0)
+        memcpy(cursor, indexes.data, sizeof (uint32_t) * indexes.size);
+    cursor += sizeof (uint32_t) * indexes.size;
+
+    if (clusterSection)
+        memcpy(cursor, clusterSection - sizeof (sheader), clusterSectionSize);
+    cursor += clusterSectionSize;
+
+    if (lods.size > 0)
+    {
+        sheader.sig = LITE3D_M_LOD_SIGNATURE;
+        sheader.recordsCount = (uint32_t)lods.size;
+        memcpy(cursor, &sheader, sizeof (sheader));
+        memcpy(cursor + sizeof (sheader), lods.data, sizeof (lite3d_m_lod) * lods.size);
+    }
+
+    *out = result;
+    *outSize = resultSize;
+    ok = LITE3D_TRUE;
+
+exit:
+    if (simplified)
+        lite3d_free(simplified);
+    if (chunkRanges)
+        lite3d_free(chunkRanges);
+    lite3d_array_purge(&lods);
+    lite3d_array_purge(&indexes);
+    lite3d_mesh_m_geometry_purge(&geometry);
+    return ok;
+}
@@ -50,6 +50,7 @@ int lite3d_mesh_indexed_load_from_memory(lite3d_mesh *mesh,
     if (!lite3d_vbo_buffer_alloc(&mesh->indexBuffer, indexes, indexesSize))
         return LITE3D_FALSE;
 
+    lite3d_mesh_reset_chunk_space(mesh, verticesSize, indexesSize);
     /* append new batch */
     if (!lite3d_mesh_append_chunk(mesh, layout, layoutCount, stride, elementsCount * 3,
         indexesSize, 0, verticesCount, verticesSize, 0))
@@ -70,41 +71,28 @@ int lite3d_mesh_indexed_append_from_memory(lite3d_mesh *mesh,
     uint32_t elementsCount)
 {
     size_t verticesSize = 0, indexesSize = 0, offsetVertices = 0, offsetIndexes = 0;
-    size_t verticesExpandSize = 0, indexExpandSize = 0;
     uint32_t stride = 0, i;
 
 
     SDL_assert(mesh && layout);
 
-    if (!lite3d_list_is_empty(&mesh->chunks))
-    {
-        lite3d_mesh_chunk *lastChunk;
-        lastChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, lite3d_list_last_link(&mesh->chunks), link);
-        offsetVertices = lastChunk->vao.verticesOffset + lastChunk->vao.verticesSize;
-        offsetIndexes = lastChunk->vao.indexesOffset + lastChunk->vao.indexesSize;
-    }
-
     /* calculate buffer parameters */
     for (i = 0; i < layoutCount; ++i)
         stride += layout[i].count * sizeof (float);
     verticesSize = (size_t)stride * (size_t)verticesCount;
     indexesSize = 3 * sizeof(uint32_t) * elementsCount;
 
-    /* expand VBOs */
-    verticesExpandSize = offsetVertices + verticesSize > mesh->vertexBuffer.size ? 
-        offsetVertices + verticesSize - mesh->vertexBuffer.size : 0;
-    indexExpandSize = offsetIndexes + indexesSize > mesh->indexBuffer.size ? 
-        offsetIndexes + indexesSize - mesh->indexBuffer.size : 0;
-
-    if (!lite3d_mesh_extend(mesh, verticesExpandSize, indexExpandSize))
+    /* place chunk into free space of VBOs, expand them if needed */
+    if (!lite3d_mesh_alloc_chunk_space(mesh, verticesSize, stride, indexesSize, 
+        &offsetVertices, &offsetIndexes))
         return LITE3D_FALSE;
 
-    /* copy vertices to the end of the vertex buffer */
+    /* copy vertices to the allocated range of the vertex buffer */
     if (!lite3d_vbo_subbuffer(&mesh->vertexBuffer, vertices,
         offsetVertices, verticesSize))
         return LITE3D_FALSE;
 
-    /* copy indexes to the end of the index buffer */
+    /* copy indexes to the allocated range of the index buffer */
     if (!lite3d_vbo_subbuffer(&mesh->indexBuffer, indexes,
         offsetIndexes, indexesSize))
         return LITE3D_FALSE;
@@ -139,6 +127,7 @@ int lite3d_mesh_load_from_memory(lite3d_mesh *mesh,
     if (!lite3d_vbo_buffer_alloc(&mesh->vertexBuffer, vertices, verticesSize))
         return LITE3D_FALSE;
 
+    lite3d_mesh_reset_chunk_space(mesh, verticesSize, 0);
     /* append new batch */
     if (!lite3d_mesh_append_chunk(mesh, layout, layoutCount, stride,
         0, 0, 0, verticesCount, verticesSize, 0))
@@ -155,30 +144,21 @@ int lite3d_mesh_append_from_memory(lite3d_mesh *mesh,
     const lite3d_vao_layout *layout,
     uint32_t layoutCount)
 {
-    size_t verticesSize = 0, offsetVertices = 0;
+    size_t verticesSize = 0, offsetVertices = 0, offsetIndexes = 0;
     uint32_t stride = 0, i;
 
     SDL_assert(mesh && layout);
 
-    if (!lite3d_list_is_empty(&mesh->chunks))
-    {
-        lite3d_mesh_chunk *lastChunk;
-        lastChunk = LITE3D_MEMBERCAST(lite3d_mesh_chunk, lite3d_list_last_link(&mesh->chunks), link);
-        offsetVertices = lastChunk->vao.verticesOffset + lastChunk->vao.verticesSize;
-    }
-
     /* calculate buffer parameters */
     for (i = 0; i < layoutCount; ++i)
         stride += layout[i].count * sizeof (float);
     verticesSize = (size_t)stride * (size_t)verticesCount;
-    /* expand VBO */
-    if (offsetVertices + verticesSize > mesh->vertexBuffer.size)
-    {
-        if (!lite3d_mesh_extend(mesh, offsetVertices + verticesSize - mesh->vertexBuffer.size, 0))
-            return LITE3D_FALSE;
-    }
+    /* place chunk into free space of VBO, expand it if needed */
+    if (!lite3d_mesh_alloc_chunk_space(mesh, verticesSize, stride, 0, 
+        &offsetVertices, &offsetIndexes))
+        return LITE3D_FALSE;
 
-    /* copy vertices to the end of the vertex buffer */
+    /* copy vertices to the allocated range of the vertex buffer */
     if (!lite3d_vbo_subbuffer(&mesh->vertexBuffer, vertices,
         offsetVertices, verticesSize))
         return LITE3D_FALSE;
@@ -0,0 +1,897 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL_log.h>
+#include <SDL_assert.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_array.h>
+#include <lite3d/lite3d_mesh_lod.h>
+
+/* Collapse turning normal of any remaining triangle more than ~75 degrees from its current or 
+ * original direction is rejected, the latter stops folds growing by small steps */
+#define LOD_FLIP_MIN_COS    0.25
+
+#define LOD_EMPTY           UINT32_MAX
+
+/* Cells per axis of grid used to find the nearest triangle of simplified mesh */
+#define LOD_GRID_MAX_CELLS  128
+
+/* Sum of area weighted squared distances to planes: p'Qp, Q is symmetric 4x4 */
+typedef struct lod_quadric
+{
+    double a2, ab, ac, ad;
+    double b2, bc, bd;
+    double c2, cd;
+    double d2;
+    double weight;
+} lod_quadric;
+
+typedef struct lod_collapse
+{
+    uint32_t from;
+    uint32_t to;
+    double cost;
+} lod_collapse;
+
+typedef struct lod_simplifier
+{
+    const uint8_t *positions;
+    uint32_t stride;
+    uint32_t verticesCount;
+    /* current triangles, compacted after every pass */
+    uint32_t *triangles;
+    uint32_t trianglesCount;
+    /* normals of source triangles, zero for degenerate, follow triangles on compaction */
+    kmVec3 *normals;
+    lod_quadric *quadrics;
+    /* vertex the vertex was collapsed to, itself while alive */
+    uint32_t *remap;
+    uint8_t *locked;
+    uint32_t *touched;
+    uint8_t *dead;
+    /* triangles of each vertex, CSR, rebuilt every pass */
+    uint32_t *adjacencyOffsets;
+    uint32_t *adjacency;
+    lite3d_array collapses;
+    uint32_t stamp;
+} lod_simplifier;
+
+static const kmVec3 *lod_position(const lod_simplifier *s, uint32_t index)
+{
+    return (const kmVec3 *)(s->positions + (size_t)index * s->stride);
+}
+
+static uint32_t lod_hash(uint32_t value)
+{
+    /* murmur3 finalizer */
+    value ^= value >> 16;
+    value *= 0x85ebca6bu;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35u;
+    value ^= value >> 16;
+    return value;
+}
+
+static uint32_t lod_hash_position(const kmVec3 *p)
+{
+    /* +0.0f makes -0.0 equal to 0.0 */
+    float coords[3] = { p->x + 0.0f, p->y + 0.0f, p->z + 0.0f };
+    uint32_t bits[3];
+
+    memcpy(bits, coords, sizeof(bits));
+    return lod_hash(bits[0] ^ lod_hash(bits[1] ^ lod_hash(bits[2])));
+}
+
+static uint32_t lod_table_size(size_t count)
+{
+    uint32_t size = 16;
+    while (size < count * 2)
+        size *= 2;
+    return size;
+}
+
+static uint32_t lod_resolve(const lod_simplifier *s, uint32_t vertex)
+{
+    while (s->remap[vertex] != vertex)
+        vertex = s->remap[vertex];
+    return vertex;
+}
+
+static void lod_quadric_add_plane(lod_quadric *q, double a, double b, double c, double d, double weight)
+{
+    q->a2 += weight * a * a; q->ab += weight * a * b; q->ac += weight * a * c; q->ad += weight * a * d;
+    q->b2 += weight * b * b; q->bc += weight * b * c; q->bd += weight * b * d;
+    q->c2 += weight * c * c; q->cd += weight * c * d;
+    q->d2 += weight * d * d;
+    q->weight += weight;
+}
+
+static void lod_quadric_add(lod_quadric *q, const lod_quadric *other)
+{
+    q->a2 += other->a2; q->ab += other->ab; q->ac += other->ac; q->ad += other->ad;
+    q->b2 += other->b2; q->bc += other->bc; q->bd += other->bd;
+    q->c2 += other->c2; q->cd += other->cd;
+    q->d2 += other->d2;
+    q->weight += other->weight;
+}
+
+/* Mean squared distance from p to planes of quadrics q1 + q2 */
+static double lod_collapse_cost(const lod_quadric *q1, const lod_quadric *q2, const kmVec3 *p)
+{
+    lod_quadric q = *q1;
+    double x = p->x, y = p->y, z = p->z, error;
+
+    lod_quadric_add(&q, q2);
+    if (q.weight <= 0.0)
+        return 0.0;
+
+    error = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + 
+        2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z + q.ad * x + q.bd * y + q.cd * z) + q.d2;
+    return error > 0.0 ? error / q.weight : 0.0;
+}
+
+static void lod_triangle_normal(const kmVec3 *p0, const kmVec3 *p1, const kmVec3 *p2, double *n)
+{
+    double e1[3] = { p1->x - p0->x, p1->y - p0->y, p1->z - p0->z };
+    double e2[3] = { p2->x - p0->x, p2->y - p0->y, p2->z - p0->z };
+
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static void lod_init_quadrics(lod_simplifier *s)
+{
+    uint32_t i, j;
+    double n[3], length, d;
+    const kmVec3 *p0;
+
+    for (i = 0; i < s->trianglesCount; ++i)
+    {
+        const uint32_t *tri = s->triangles + (size_t)i * 3;
+        p0 = lod_position(s, tri[0]);
+        lod_triangle_normal(p0, lod_position(s, tri[1]), lod_position(s, tri[2]), n);
+        if ((length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2])) <= 0.0)
+            continue;
+
+        n[0] /= length; n[1] /= length; n[2] /= length;
+        s->normals[i].x = (float)n[0]; s->normals[i].y = (float)n[1]; s->normals[i].z = (float)n[2];
+        d = -(n[0] * p0->x + n[1] * p0->y + n[2] * p0->z);
+        for (j = 0; j < 3; ++j)
+            lod_quadric_add_plane(&s->quadrics[tri[j]], n[0], n[1], n[2], d, length * 0.5);
+    }
+}
+
+/* 
+ * Vertices sharing position with others (uv/normal seams) and vertices of edges which do not have
+ * exactly two triangles (open borders, non manifold) are locked.
+ */
+static int lod_lock_vertices(lod_simplifier *s)
+{
+    uint32_t *positionTable = NULL, *welded = NULL;
+    uint64_t *edgeKeys = NULL;
+    uint32_t *edgeCounts = NULL;
+    uint32_t positionTableSize, edgeTableSize, mask, i, j, slot;
+    int result = LITE3D_FALSE;
+
+    positionTableSize = lod_table_size(s->verticesCount);
+    edgeTableSize = lod_table_size((size_t)s->trianglesCount * 3);
+    if (!(positionTable = lite3d_malloc(sizeof(uint32_t) * positionTableSize)) ||
+        !(welded = lite3d_malloc(sizeof(uint32_t) * ((size_t)s->verticesCount + 1))) ||
+        !(edgeKeys = lite3d_malloc(sizeof(uint64_t) * edgeTableSize)) ||
+        !(edgeCounts = lite3d_calloc(sizeof(uint32_t) * edgeTableSize)))
+        goto exit;
+
+    memset(positionTable, 0xff, sizeof(uint32_t) * positionTableSize);
+    mask = positionTableSize - 1;
+    for (i = 0; i < s->verticesCount; ++i)
+    {
+        const kmVec3 *p = lod_position(s, i);
+        for (slot = lod_hash_position(p) & mask; positionTable[slot] != LOD_EMPTY; slot = (slot + 1) & mask)
+        {
+            const kmVec3 *other = lod_position(s, positionTable[slot]);
+            if (other->x == p->x && other->y == p->y && other->z == p->z)
+                break;
+        }
+
+        if (positionTable[slot] == LOD_EMPTY)
+        {
+            positionTable[slot] = i;
+            welded[i] = i;
+        }
+        else
+        {
+            welded[i] = positionTable[slot];
+            s->locked[i] = s->locked[welded[i]] = LITE3D_TRUE;
+        }
+    }
+
+    /* edges are counted between welded vertices so seams are not taken as borders */
+    mask = edgeTableSize - 1;
+    for (i = 0; i < s->trianglesCount * 3; ++i)
+    {
+        uint32_t a = welded[s->triangles[i]], b = welded[s->triangles[i - i % 3 + (i + 1) % 3]];
+        uint32_t lo = a < b ? a : b, hi = a < b ? b : a;
+        uint64_t key = ((uint64_t)lo << 32) | hi;
+
+        for (slot = lod_hash(lo ^ lod_hash(hi)) & mask; edgeCounts[slot] > 0 && edgeKeys[slot] != key; 
+            slot = (slot + 1) & mask)
+            ;
+
+        edgeKeys[slot] = key;
+        edgeCounts[slot]++;
+    }
+
+    for (i = 0; i < edgeTableSize; ++i)
+    {
+        if (edgeCounts[i] == 0 || edgeCounts[i] == 2)
+            continue;
+
+        for (j = 0; j < 2; ++j)
+        {
+            uint32_t vertex = (uint32_t)(j == 0 ? edgeKeys[i] >> 32 : edgeKeys[i] & 0xffffffffu);
+            s->locked[vertex] = LITE3D_TRUE;
+        }
+    }
+
+    result = LITE3D_TRUE;
+
+exit:
+    if (positionTable)
+        lite3d_free(positionTable);
+    if (welded)
+        lite3d_free(welded);
+    if (edgeKeys)
+        lite3d_free(edgeKeys);
+    if (edgeCounts)
+        lite3d_free(edgeCounts);
+    return result;
+}
+
+static void lod_build_adjacency(lod_simplifier *s)
+{
+    uint32_t i;
+
+    memset(s->adjacencyOffsets, 0, sizeof(uint32_t) * ((size_t)s->verticesCount + 1));
+    for (i = 0; i < s->trianglesCount * 3; ++i)
+        s->adjacencyOffsets[s->triangles[i] + 1]++;
+    for (i = 0; i < s->verticesCount; ++i)
+        s->adjacencyOffsets[i + 1] += s->adjacencyOffsets[i];
+
+    /* touched is used as fill cursor here, stamps start over after */
+    memset(s->touched, 0, sizeof(uint32_t) * ((size_t)s->verticesCount + 1));
+    for (i = 0; i < s->trianglesCount * 3; ++i)
+        s->adjacency[s->adjacencyOffsets[s->triangles[i]] + s->touched[s->triangles[i]]++] = i / 3;
+    memset(s->touched, 0, sizeof(uint32_t) * ((size_t)s->verticesCount + 1));
+    memset(s->dead, 0, (size_t)s->trianglesCount + 1);
+    s->stamp = 0;
+}
+
+static int lod_compare_collapses(const void *a, const void *b)
+{
+    double costA = ((const lod_collapse *)a)->cost;
+    double costB = ((const lod_collapse *)b)->cost;
+    return costA < costB ? -1 : (costA > costB ? 1 : 0);
+}
+
+static int lod_collect_collapses(lod_simplifier *s)
+{
+    uint32_t i, j;
+    lod_collapse *collapse;
+
+    lite3d_array_clean(&s->collapses);
+    for (i = 0; i < s->trianglesCount; ++i)
+    {
+        for (j = 0; j < 3; ++j)
+        {
+            uint32_t a = s->triangles[i * 3 + j], b = s->triangles[i * 3 + (j + 1) % 3];
+            if (!s->locked[a])
+            {
+                if (!(collapse = lite3d_array_add(&s->collapses)))
+                    return LITE3D_FALSE;
+                collapse->from = a;
+                collapse->to = b;
+                collapse->cost = lod_collapse_cost(&s->quadrics[a], &s->quadrics[b], lod_position(s, b));
+            }
+
+            if (!s->locked[b])
+            {
+                if (!(collapse = lite3d_array_add(&s->collapses)))
+                    return LITE3D_FALSE;
+                collapse->from = b;
+                collapse->to = a;
+                collapse->cost = lod_collapse_cost(&s->quadrics[b], &s->quadrics[a], lod_position(s, a));
+            }
+        }
+    }
+
+    lite3d_array_qsort(&s->collapses, lod_compare_collapses);
+    return LITE3D_TRUE;
+}
+
+/* Moving from to position of to must not flip or fold remaining triangles around from */
+static int lod_normal_turns(const double *before, const double *after)
+{
+    double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+    double lengths = sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) *
+        (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+    return dot <= LOD_FLIP_MIN_COS * lengths;
+}
+
+static int lod_collapse_flips(const lod_simplifier *s, uint32_t from, uint32_t to)
+{
+    uint32_t i, j, corners[3];
+    double before[3], after[3], source[3];
+
+    for (i = s->adjacencyOffsets[from]; i < s->adjacencyOffsets[from + 1]; ++i)
+    {
+        uint32_t triangle = s->adjacency[i];
+        int degenerate = LITE3D_FALSE;
+        if (s->dead[triangle])
+            continue;
+
+        for (j = 0; j < 3; ++j)
+        {
+            corners[j] = lod_resolve(s, s->triangles[triangle * 3 + j]);
+            degenerate |= corners[j] == to;
+        }
+
+        /* triangles on collapsed edge disappear */
+        if (degenerate)
+            continue;
+
+        lod_triangle_normal(lod_position(s, corners[0]), lod_position(s, corners[1]), 
+            lod_position(s, corners[2]), before);
+        for (j = 0; j < 3; ++j)
+        {
+            if (corners[j] == from)
+                corners[j] = to;
+        }
+        lod_triangle_normal(lod_position(s, corners[0]), lod_position(s, corners[1]), 
+            lod_position(s, corners[2]), after);
+
+        source[0] = s->normals[triangle].x;
+        source[1] = s->normals[triangle].y;
+        source[2] = s->normals[triangle].z;
+        if (lod_normal_turns(before, after) || 
+            ((source[0] != 0.0 || source[1] != 0.0 || source[2] != 0.0) && lod_normal_turns(source, after)))
+            return LITE3D_TRUE;
+    }
+
+    return LITE3D_FALSE;
+}
+
+/* Returns number of removed triangles */
+static uint32_t lod_apply_collapse(lod_simplifier *s, uint32_t from, uint32_t to)
+{
+    uint32_t i, j, removed = 0;
+
+    s->remap[from] = to;
+    lod_quadric_add(&s->quadrics[to], &s->quadrics[from]);
+    s->touched[from] = s->touched[to] = s->stamp;
+
+    for (i = s->adjacencyOffsets[from]; i < s->adjacencyOffsets[from + 1]; ++i)
+    {
+        uint32_t triangle = s->adjacency[i];
+        if (s->dead[triangle])
+            continue;
+
+        for (j = 0; j < 3; ++j)
+        {
+            if (lod_resolve(s, s->triangles[triangle * 3 + j]) == to && s->triangles[triangle * 3 + j] != from)
+            {
+                s->dead[triangle] = LITE3D_TRUE;
+                removed++;
+                break;
+            }
+        }
+    }
+
+    return removed;
+}
+
+static void lod_compact(lod_simplifier *s)
+{
+    uint32_t i, j, count = 0, corners[3];
+
+    for (i = 0; i < s->trianglesCount; ++i)
+    {
+        if (s->dead[i])
+            continue;
+
+        for (j = 0; j < 3; ++j)
+            corners[j] = lod_resolve(s, s->triangles[i * 3 + j]);
+        if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+            continue;
+
+        memcpy(s->triangles + (size_t)count * 3, corners, sizeof(corners));
+        s->normals[count++] = s->normals[i];
+    }
+
+    s->trianglesCount = count;
+}
+
+static void lod_simplifier_purge(lod_simplifier *s)
+{
+    if (s->triangles)
+        lite3d_free(s->triangles);
+    if (s->normals)
+        lite3d_free(s->normals);
+    if (s->quadrics)
+        lite3d_free(s->quadrics);
+    if (s->remap)
+        lite3d_free(s->remap);
+    if (s->locked)
+        lite3d_free(s->locked);
+    if (s->touched)
+        lite3d_free(s->touched);
+    if (s->dead)
+        lite3d_free(s->dead);
+    if (s->adjacencyOffsets)
+        lite3d_free(s->adjacencyOffsets);
+    if (s->adjacency)
+        lite3d_free(s->adjacency);
+    lite3d_array_purge(&s->collapses);
+}
+
+static int lod_simplifier_init(lod_simplifier *s, const void *positions, uint32_t stride, 
+    uint32_t verticesCount, const uint32_t *indexes, uint32_t indexesCount)
+{
+    uint32_t i;
+
+    memset(s, 0, sizeof(lod_simplifier));
+    s->positions = (const uint8_t *)positions;
+    s->stride = stride;
+    s->verticesCount = verticesCount;
+    lite3d_array_init(&s->collapses, sizeof(lod_collapse), 64);
+
+    if (!(s->triangles = lite3d_malloc(sizeof(uint32_t) * ((size_t)indexesCount + 1))) ||
+        !(s->normals = lite3d_calloc(sizeof(kmVec3) * ((size_t)indexesCount / 3 + 1))) ||
+        !(s->quadrics = lite3d_calloc(sizeof(lod_quadric) * ((size_t)verticesCount + 1))) ||
+        !(s->remap = lite3d_malloc(sizeof(uint32_t) * ((size_t)verticesCount + 1))) ||
+        !(s->locked = lite3d_calloc((size_t)verticesCount + 1)) ||
+        !(s->touched = lite3d_calloc(sizeof(uint32_t) * ((size_t)verticesCount + 1))) ||
+        !(s->dead = lite3d_calloc((size_t)indexesCount / 3 + 1)) ||
+        !(s->adjacencyOffsets = lite3d_calloc(sizeof(uint32_t) * ((size_t)verticesCount + 1))) ||
+        !(s->adjacency = lite3d_malloc(sizeof(uint32_t) * ((size_t)indexesCount + 1))))
+        return LITE3D_FALSE;
+
+    for (i = 0; i < verticesCount; ++i)
+        s->remap[i] = i;
+
+    /* degenerate triangles are dropped at once */
+    for (i = 0; i < indexesCount; i += 3)
+    {
+        if (indexes[i] == indexes[i + 1] || indexes[i + 1] == indexes[i + 2] || indexes[i] == indexes[i + 2])
+            continue;
+        memcpy(s->triangles + (size_t)s->trianglesCount * 3, indexes + i, sizeof(uint32_t) * 3);
+        s->trianglesCount++;
+    }
+
+    lod_init_quadrics(s);
+    return lod_lock_vertices(s);
+}
+
+int lite3d_mesh_simplify(const void *positions, uint32_t stride, uint32_t verticesCount,
+    const uint32_t *indexes, uint32_t indexesCount, uint32_t targetIndexesCount, float targetError,
+    uint32_t *out, uint32_t *resultIndexesCount, float *resultError)
+{
+    lod_simplifier s;
+    uint32_t i, targetTriangles = targetIndexesCount / 3;
+    double maxCost = (double)targetError * targetError, appliedCost = 0.0;
+    int result = LITE3D_FALSE;
+
+    SDL_assert(positions);
+    SDL_assert(out);
+    SDL_assert(resultIndexesCount);
+
+    if (stride < sizeof(kmVec3) || indexesCount % 3 != 0)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Bad stride %u or triangle list of %u indexes",
+            LITE3D_CURRENT_FUNCTION, stride, indexesCount);
+        return LITE3D_FALSE;
+    }
+
+    for (i = 0; i < indexesCount; ++i)
+    {
+        if (indexes[i] >= verticesCount)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Index %u is out of %u vertices",
+                LITE3D_CURRENT_FUNCTION, i, verticesCount);
+            return LITE3D_FALSE;
+        }
+    }
+
+    if (!lod_simplifier_init(&s, positions, stride, verticesCount, indexes, indexesCount))
+        goto exit;
+
+    while (s.trianglesCount > targetTriangles)
+    {
+        lod_collapse *collapse;
+        uint32_t trianglesLeft = s.trianglesCount, applied = 0;
+        /* collapse removes two triangles usually, do not go much further than target in one pass */
+        uint32_t goal = (s.trianglesCount - targetTriangles + 1) / 2;
+
+        lod_build_adjacency(&s);
+        if (!lod_collect_collapses(&s))
+            goto exit;
+
+        /* every vertex takes part in one collapse per pass, so adjacency stays valid */
+        s.stamp++;
+        LITE3D_ARR_FOREACH(&s.collapses, lod_collapse, collapse)
+        {
+            if (collapse->cost > maxCost)
+                break;
+            if (s.touched[collapse->from] == s.stamp || s.touched[collapse->to] == s.stamp)
+                continue;
+            if (lod_collapse_flips(&s, collapse->from, collapse->to))
+                continue;
+
+            trianglesLeft -= lod_apply_collapse(&s, collapse->from, collapse->to);
+            if (collapse->cost > appliedCost)
+                appliedCost = collapse->cost;
+            if (++applied >= goal || trianglesLeft <= targetTriangles)
+                break;
+        }
+
+        lod_compact(&s);
+        if (applied == 0)
+            break;
+    }
+
+    memcpy(out, s.triangles, sizeof(uint32_t) * s.trianglesCount * 3);
+    *resultIndexesCount = s.trianglesCount * 3;
+    if (resultError)
+        *resultError = (float)sqrt(appliedCost);
+    result = LITE3D_TRUE;
+
+exit:
+    lod_simplifier_purge(&s);
+    if (!result)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Failed to simplify %u triangles",
+            LITE3D_CURRENT_FUNCTION, indexesCount / 3);
+    return result;
+}
+
+/* Squared distance from point to triangle by closest point (Ericson, Real-Time Collision Detection) */
+static float lod_point_triangle_distance_sq(const kmVec3 *p, const kmVec3 *a, const kmVec3 *b, const kmVec3 *c)
+{
+    kmVec3 ab, ac, ap, bp, cp, closest, delta;
+    float d1, d2, d3, d4, d5, d6, va, vb, vc, t, denom;
+
+    kmVec3Subtract(&ab, b, a);
+    kmVec3Subtract(&ac, c, a);
+    kmVec3Subtract(&ap, p, a);
+    d1 = kmVec3Dot(&ab, &ap);
+    d2 = kmVec3Dot(&ac, &ap);
+    kmVec3Subtract(&bp, p, b);
+    d3 = kmVec3Dot(&ab, &bp);
+    d4 = kmVec3Dot(&ac, &bp);
+    kmVec3Subtract(&cp, p, c);
+    d5 = kmVec3Dot(&ab, &cp);
+    d6 = kmVec3Dot(&ac, &cp);
+    va = d3 * d6 - d5 * d4;
+    vb = d5 * d2 - d1 * d6;
+    vc = d1 * d4 - d3 * d2;
+
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        closest = *a;
+    else if (d3 >= 0.0f && d4 <= d3)
+        closest = *b;
+    else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        t = d1 / (d1 - d3);
+        kmVec3Scale(&closest, &ab, t);
+        kmVec3Add(&closest, a, &closest);
+    }
+    else if (d6 >= 0.0f && d5 <= d6)
+        closest = *c;
+    else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        t = d2 / (d2 - d6);
+        kmVec3Scale(&closest, &ac, t);
+        kmVec3Add(&closest, a, &closest);
+    }
+    else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        kmVec3Subtract(&closest, c, b);
+        kmVec3Scale(&closest, &closest, t);
+        kmVec3Add(&closest, b, &closest);
+    }
+    else
+    {
+        denom = 1.0f / (va + vb + vc);
+        closest.x = a->x + ab.x * vb * denom + ac.x * vc * denom;
+        closest.y = a->y + ab.y * vb * denom + ac.y * vc * denom;
+        closest.z = a->z + ab.z * vb * denom + ac.z * vc * denom;
+    }
+
+    kmVec3Subtract(&delta, p, &closest);
+    return kmVec3Dot(&delta, &delta);
+}
+
+/* Uniform grid of triangles, triangle is listed in every cell its bounding box touches */
+typedef struct lod_grid
+{
+    kmVec3 min;
+    float cell;
+    uint32_t dims[3];
+    /* triangles of each cell, CSR */
+    uint32_t *offsets;
+    uint32_t *items;
+} lod_grid;
+
+static uint32_t lod_grid_coord(const lod_grid *g, float value, float min, uint32_t axis)
+{
+    float coord = floorf((value - min) / g->cell);
+    if (coord < 0.0f)
+        return 0;
+    return coord >= (float)(g->dims[axis] - 1) ? g->dims[axis] - 1 : (uint32_t)coord;
+}
+
+static void lod_grid_cells(const lod_grid *g, const kmVec3 *lo, const kmVec3 *hi, uint32_t from[3], uint32_t to[3])
+{
+    from[0] = lod_grid_coord(g, lo->x, g->min.x, 0);
+    from[1] = lod_grid_coord(g, lo->y, g->min.y, 1);
+    from[2] = lod_grid_coord(g, lo->z, g->min.z, 2);
+    to[0] = lod_grid_coord(g, hi->x, g->min.x, 0);
+    to[1] = lod_grid_coord(g, hi->y, g->min.y, 1);
+    to[2] = lod_grid_coord(g, hi->z, g->min.z, 2);
+}
+
+static void lod_triangle_bounds(const uint8_t *data, uint32_t stride, const uint32_t *tri, kmVec3 *lo, kmVec3 *hi)
+{
+    uint32_t i;
+    *lo = *hi = *(const kmVec3 *)(data + (size_t)tri[0] * stride);
+    for (i = 1; i < 3; ++i)
+    {
+        const kmVec3 *p = (const kmVec3 *)(data + (size_t)tri[i] * stride);
+        lo->x = p->x < lo->x ? p->x : lo->x; hi->x = p->x > hi->x ? p->x : hi->x;
+        lo->y = p->y < lo->y ? p->y : lo->y; hi->y = p->y > hi->y ? p->y : hi->y;
+        lo->z = p->z < lo->z ? p->z : lo->z; hi->z = p->z > hi->z ? p->z : hi->z;
+    }
+}
+
+static int lod_grid_init(lod_grid *g, const uint8_t *data, uint32_t stride, const uint32_t *indexes, 
+    uint32_t indexesCount, const kmVec3 *min, const kmVec3 *max)
+{
+    uint32_t i, x, y, z, cellsCount, from[3], to[3], *cursor;
+    kmVec3 lo, hi;
+    float extent = 0.0f, size = 0.0f;
+
+    memset(g, 0, sizeof(*g));
+    g->min = *min;
+
+    /* cell about the size of triangle, but not finer than grid limit */
+    for (i = 0; i < indexesCount; i += 3)
+    {
+        lod_triangle_bounds(data, stride, indexes + i, &lo, &hi);
+        size += fmaxf(hi.x - lo.x, fmaxf(hi.y - lo.y, hi.z - lo.z));
+    }
+
+    extent = fmaxf(max->x - min->x, fmaxf(max->y - min->y, max->z - min->z));
+    g->cell = fmaxf(indexesCount > 0 ? size / (indexesCount / 3) : 0.0f, extent / LOD_GRID_MAX_CELLS);
+    if (!(g->cell > 0.0f))
+        g->cell = 1.0f;
+
+    g->dims[0] = (uint32_t)fminf((max->x - min->x) / g->cell + 1.0f, LOD_GRID_MAX_CELLS);
+    g->dims[1] = (uint32_t)fminf((max->y - min->y) / g->cell + 1.0f, LOD_GRID_MAX_CELLS);
+    g->dims[2] = (uint32_t)fminf((max->z - min->z) / g->cell + 1.0f, LOD_GRID_MAX_CELLS);
+    cellsCount = g->dims[0] * g->dims[1] * g->dims[2];
+
+    if (!(g->offsets = lite3d_calloc(sizeof(uint32_t) * ((size_t)cellsCount + 1))))
+        return LITE3D_FALSE;
+
+    for (i = 0; i < indexesCount; i += 3)
+    {
+        lod_triangle_bounds(data, stride, indexes + i, &lo, &hi);
+        lod_grid_cells(g, &lo, &hi, from, to);
+        for (z = from[2]; z <= to[2]; ++z)
+            for (y = from[1]; y <= to[1]; ++y)
+                for (x = from[0]; x <= to[0]; ++x)
+                    g->offsets[(z * g->dims[1] + y) * g->dims[0] + x + 1]++;
+    }
+
+    for (i = 0; i < cellsCount; ++i)
+        g->offsets[i + 1] += g->offsets[i];
+
+    if (!(g->items = lite3d_malloc(sizeof(uint32_t) * ((size_t)g->offsets[cellsCount] + 1))) ||
+        !(cursor = lite3d_calloc(sizeof(uint32_t) * ((size_t)cellsCount + 1))))
+        return LITE3D_FALSE;
+
+    for (i = 0; i < indexesCount; i += 3)
+    {
+        lod_triangle_bounds(data, stride, indexes + i, &lo, &hi);
+        lod_grid_cells(g, &lo, &hi, from, to);
+        for (z = from[2]; z <= to[2]; ++z)
+            for (y = from[1]; y <= to[1]; ++y)
+                for (x = from[0]; x <= to[0]; ++x)
+                {
+                    uint32_t cell = (z * g->dims[1] + y) * g->dims[0] + x;
+                    g->items[g->offsets[cell] + cursor[cell]++] = i;
+                }
+    }
+
+    lite3d_free(cursor);
+    return LITE3D_TRUE;
+}
+
+static void lod_grid_purge(lod_grid *g)
+{
+    if (g->offsets)
+        lite3d_free(g->offsets);
+    if (g->items)
+        lite3d_free(g->items);
+}
+
+/* Squared distance to the nearest triangle. Cells are checked by shells around cell of point, 
+ * triangles out of shell r are at least r cells away, so search stops when nearest is closer */
+static float lod_grid_nearest(const lod_grid *g, const uint8_t *data, uint32_t stride, const uint32_t *indexes, 
+    const kmVec3 *p)
+{
+    uint32_t i, r, maxR, center[3], from[3], to[3], x, y, z;
+    float nearest = FLT_MAX, distance, bound;
+
+    lod_grid_cells(g, p, p, center, to);
+    maxR = g->dims[0] > g->dims[1] ? g->dims[0] : g->dims[1];
+    maxR = maxR > g->dims[2] ? maxR : g->dims[2];
+
+    for (r = 0; r <= maxR; ++r)
+    {
+        for (i = 0; i < 3; ++i)
+        {
+            from[i] = center[i] >= r ? center[i] - r : 0;
+            to[i] = center[i] + r < g->dims[i] ? center[i] + r : g->dims[i] - 1;
+        }
+
+        for (z = from[2]; z <= to[2]; ++z)
+            for (y = from[1]; y <= to[1]; ++y)
+                for (x = from[0]; x <= to[0]; ++x)
+                {
+                    uint32_t cell = (z * g->dims[1] + y) * g->dims[0] + x, k;
+                    /* only the shell, inner cells are done */
+                    if (x + r != center[0] && x != center[0] + r && y + r != center[1] && 
+                        y != center[1] + r && z + r != center[2] && z != center[2] + r)
+                        continue;
+
+                    for (k = g->offsets[cell]; k < g->offsets[cell + 1]; ++k)
+                    {
+                        const uint32_t *tri = indexes + g->items[k];
+                        distance = lod_point_triangle_distance_sq(p, 
+                            (const kmVec3 *)(data + (size_t)tri[0] * stride),
+                            (const kmVec3 *)(data + (size_t)tri[1] * stride),
+                            (const kmVec3 *)(data + (size_t)tri[2] * stride));
+                        if (distance < nearest)
+                            nearest = distance;
+                    }
+                }
+
+        bound = r * g->cell;
+        if (nearest <= bound * bound)
+            break;
+    }
+
+    return nearest;
+}
+
+int lite3d_mesh_deviation(const void *positions, uint32_t stride, uint32_t verticesCount,
+    const uint32_t *indexes, uint32_t indexesCount, const uint32_t *simplified, uint32_t simplifiedCount,
+    float *deviation)
+{
+    const uint8_t *data = (const uint8_t *)positions;
+    uint8_t *used = NULL;
+    lod_grid grid;
+    kmVec3 min, max;
+    uint32_t i;
+    float result = 0.0f, nearest;
+    int ok = LITE3D_FALSE, bounded = LITE3D_FALSE;
+
+    SDL_assert(positions);
+    SDL_assert(deviation);
+
+    memset(&grid, 0, sizeof(grid));
+    if (simplifiedCount == 0)
+    {
+        *deviation = 0.0f;
+        return LITE3D_TRUE;
+    }
+
+    /* 1 - vertex of source, 2 - kept by simplified, vertices are never moved */
+    if (!(used = lite3d_calloc((size_t)verticesCount + 1)))
+        goto exit;
+    for (i = 0; i < indexesCount; ++i)
+        used[indexes[i]] |= 1;
+    for (i = 0; i < simplifiedCount; ++i)
+        used[simplified[i]] |= 2;
+
+    for (i = 0; i < verticesCount; ++i)
+    {
+        const kmVec3 *p = (const kmVec3 *)(data + (size_t)i * stride);
+        if (!used[i])
+            continue;
+        if (!bounded)
+        {
+            min = max = *p;
+            bounded = LITE3D_TRUE;
+            continue;
+        }
+
+        min.x = fminf(min.x, p->x); min.y = fminf(min.y, p->y); min.z = fminf(min.z, p->z);
+        max.x = fmaxf(max.x, p->x); max.y = fmaxf(max.y, p->y); max.z = fmaxf(max.z, p->z);
+    }
+
+    if (!lod_grid_init(&grid, data, stride, simplified, simplifiedCount, &min, &max))
+        goto exit;
+
+    for (i = 0; i < verticesCount; ++i)
+    {
+        if (used[i] != 1)
+            continue;
+
+        nearest = lod_grid_nearest(&grid, data, stride, simplified, (const kmVec3 *)(data + (size_t)i * stride));
+        if (nearest > result)
+            result = nearest;
+    }
+
+    *deviation = sqrtf(result);
+    ok = LITE3D_TRUE;
+
+exit:
+    lod_grid_purge(&grid);
+    if (used)
+        lite3d_free(used);
+    if (!ok)
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Failed to measure deviation of %u triangles",
+            LITE3D_CURRENT_FUNCTION, simplifiedCount / 3);
+    return ok;
+}
+
+uint32_t lite3d_mesh_lod_select(const lite3d_mesh_lod *lods, uint32_t lodsCount,
+    float radius, float projectedRadius, float maxError, float hysteresis, uint32_t currentLevel)
+{
+    uint32_t level;
+    /* projected error of level is error * projectedRadius / radius, compared without division */
+    float allowed = maxError * radius, allowedCoarser;
+
+    SDL_assert(lods || lodsCount == 0);
+
+    if (lodsCount == 0 || radius <= 0.0f || maxError <= 0.0f)
+        return 0;
+
+    hysteresis = hysteresis < 0.0f ? 0.0f : (hysteresis > 1.0f ? 1.0f : hysteresis);
+    allowedCoarser = allowed * (1.0f - hysteresis);
+    if (currentLevel > lodsCount)
+        currentLevel = lodsCount;
+
+    /* current level is too coarse: the coarsest finer level fitting in error */
+    if (currentLevel > 0 && lods[currentLevel - 1].error * projectedRadius > allowed)
+    {
+        for (level = currentLevel - 1; level > 0 && lods[level - 1].error * projectedRadius > allowed; --level)
+            ;
+        return level;
+    }
+
+    for (level = currentLevel; level < lodsCount && lods[level].error * projectedRadius <= allowedCoarser; ++level)
+        ;
+    return level;
+}
@@ -0,0 +1,245 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <string.h>
+#include <SDL_log.h>
+#include <SDL_assert.h>
+
+#include <lite3d/lite3d_range_alloc.h>
+
+#define RANGE_AT(a, i) ((lite3d_range *)lite3d_array_get(&(a)->freeRanges, (i)))
+
+static size_t range_align(size_t offset, size_t align)
+{
+    size_t rem;
+    if (align <= 1)
+        return offset;
+    rem = offset % align;
+    return rem ? offset + (align - rem) : offset;
+}
+
+static lite3d_range *range_insert(lite3d_range_allocator *a, size_t index, size_t offset, size_t size)
+{
+    lite3d_range *range;
+    if (!lite3d_array_add(&a->freeRanges))
+        return NULL;
+
+    range = RANGE_AT(a, index);
+    if (index < a->freeRanges.size - 1)
+        memmove(range + 1, range, (a->freeRanges.size - 1 - index) * sizeof(lite3d_range));
+
+    range->offset = offset;
+    range->size = size;
+    return range;
+}
+
+/* first free range with offset greater than given */
+static size_t range_upper_bound(lite3d_range_allocator *a, size_t offset)
+{
+    size_t lo = 0, hi = a->freeRanges.size;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (RANGE_AT(a, mid)->offset <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+void lite3d_range_allocator_init(lite3d_range_allocator *a)
+{
+    SDL_assert(a);
+    memset(a, 0, sizeof(lite3d_range_allocator));
+    lite3d_array_init(&a->freeRanges, sizeof(lite3d_range), 4);
+}
+
+void lite3d_range_allocator_purge(lite3d_range_allocator *a)
+{
+    SDL_assert(a);
+    lite3d_array_purge(&a->freeRanges);
+    memset(a, 0, sizeof(lite3d_range_allocator));
+}
+
+int lite3d_range_alloc(lite3d_range_allocator *a, size_t size, size_t align, size_t *offset)
+{
+    size_t i;
+    SDL_assert(a && offset);
+
+    if (size == 0)
+    {
+        *offset = 0;
+        return LITE3D_TRUE;
+    }
+
+    for (i = 0; i < a->freeRanges.size; ++i)
+    {
+        lite3d_range *range = RANGE_AT(a, i);
+        size_t aligned = range_align(range->offset, align);
+        size_t padding = aligned - range->offset;
+        size_t tail;
+
+        if (padding + size > range->size)
+            continue;
+
+        tail = range->size - padding - size;
+        if (padding > 0)
+        {
+            /* front gap stays free */
+            range->size = padding;
+            if (tail > 0 && !range_insert(a, i + 1, aligned + size, tail))
+            {
+                RANGE_AT(a, i)->size = padding + size + tail;
+                return LITE3D_FALSE;
+            }
+        }
+        else if (tail > 0)
+        {
+            range->offset += size;
+            range->size = tail;
+        }
+        else
+        {
+            lite3d_array_remove(&a->freeRanges, i);
+        }
+
+        a->usedBytes += size;
+        *offset = aligned;
+        return LITE3D_TRUE;
+    }
+
+    return LITE3D_FALSE;
+}
+
+void lite3d_range_free(lite3d_range_allocator *a, size_t offset, size_t size)
+{
+    size_t index;
+    lite3d_range *prev = NULL, *next = NULL;
+    SDL_assert(a);
+
+    if (size == 0)
+        return;
+
+    SDL_assert(offset + size <= a->capacity);
+    SDL_assert(a->usedBytes >= size);
+
+    index = range_upper_bound(a, offset);
+    if (index > 0)
+    {
+        prev = RANGE_AT(a, index - 1);
+        SDL_assert(prev->offset + prev->size <= offset);
+        if (prev->offset + prev->size != offset)
+            prev = NULL;
+    }
+
+    if (index < a->freeRanges.size)
+    {
+        next = RANGE_AT(a, index);
+        SDL_assert(offset + size <= next->offset);
+        if (offset + size != next->offset)
+            next = NULL;
+    }
+
+    a->usedBytes -= size;
+    if (prev && next)
+    {
+        prev->size += size + next->size;
+        lite3d_array_remove(&a->freeRanges, index);
+    }
+    else if (prev)
+    {
+        prev->size += size;
+    }
+    else if (next)
+    {
+        next->offset = offset;
+        next->size += size;
+    }
+    else if (!range_insert(a, index, offset, size))
+    {
+        /* range is lost until next compaction */
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: free list is out of memory, %zu bytes leaked",
+            LITE3D_CURRENT_FUNCTION, size);
+    }
+}
+
+size_t lite3d_range_allocator_grow_capacity(const lite3d_range_allocator *a,
+    size_t size, size_t align)
+{
+    size_t required, doubled;
+    SDL_assert(a);
+
+    required = range_align(a->capacity, align) + size;
+    doubled = a->capacity * 2;
+    return doubled > required ? doubled : required;
+}
+
+int lite3d_range_allocator_grow(lite3d_range_allocator *a, size_t newCapacity)
+{
+    lite3d_range *last;
+    SDL_assert(a);
+
+    if (newCapacity <= a->capacity)
+        return LITE3D_TRUE;
+
+    last = a->freeRanges.size > 0 ? LITE3D_ARR_GET_LAST(&a->freeRanges, lite3d_range) : NULL;
+    if (last && last->offset + last->size == a->capacity)
+    {
+        last->size += newCapacity - a->capacity;
+    }
+    else if (!range_insert(a, a->freeRanges.size, a->capacity, newCapacity - a->capacity))
+    {
+        return LITE3D_FALSE;
+    }
+
+    /* old content is copied to the new storage */
+    a->bytesCopied += a->capacity;
+    a->capacity = newCapacity;
+    a->grows++;
+    return LITE3D_TRUE;
+}
+
+int lite3d_range_allocator_reset(lite3d_range_allocator *a, size_t capacity, size_t used)
+{
+    SDL_assert(a);
+    SDL_assert(used <= capacity);
+
+    lite3d_array_clean(&a->freeRanges);
+    if (capacity > used && !range_insert(a, 0, used, capacity - used))
+        return LITE3D_FALSE;
+
+    a->capacity = capacity;
+    a->usedBytes = used;
+    return LITE3D_TRUE;
+}
+
+size_t lite3d_range_allocator_max_free(const lite3d_range_allocator *a)
+{
+    const lite3d_range *range;
+    size_t maxFree = 0;
+    SDL_assert(a);
+
+    LITE3D_ARR_FOREACH(&a->freeRanges, const lite3d_range, range)
+    {
+        if (range->size > maxFree)
+            maxFree = range->size;
+    }
+
+    return maxFree;
+}
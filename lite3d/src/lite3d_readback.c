@@ -0,0 +1,301 @@
+/******************************************************************************
+*	This file is part of lite3d (Light-weight 3d engine).
+*	Copyright (C) 2025 Sirius (Korolev Nikita)
+*
+*	Lite3D is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	Lite3D is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <string.h>
+#include <SDL_assert.h>
+#include <SDL_log.h>
+
+#include <lite3d/lite3d_gl.h>
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_misc.h>
+#include <lite3d/lite3d_readback.h>
+
+#ifndef GLES
+
+static uint32_t gl_buffer_create(size_t size)
+{
+    uint32_t bufferID = 0;
+    lite3d_misc_gl_error_stack_clean();
+    glGenBuffers(1, &bufferID);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (LITE3D_CHECK_GL_ERROR)
+    {
+        glDeleteBuffers(1, &bufferID);
+        return 0;
+    }
+
+    return bufferID;
+}
+
+static void gl_buffer_delete(uint32_t bufferID)
+{
+    glDeleteBuffers(1, &bufferID);
+}
+
+static int gl_copy(const lite3d_readback_source *source, uint32_t bufferID)
+{
+    int ret;
+    /* pixels pointer is offset in bound pack buffer */
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+    ret = source->texture ? lite3d_texture_unit_get_pixels(source->texture, source->level, 0, NULL) :
+        lite3d_framebuffer_read(source->framebuffer, source->index, source->format, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return ret;
+}
+
+static void *gl_fence_insert(void)
+{
+    return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static int gl_fence_signaled(void *fence)
+{
+    /* zero timeout, flush makes sure fence will be reached */
+    GLenum status = glClientWaitSync((GLsync)fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+static void gl_fence_delete(void *fence)
+{
+    glDeleteSync((GLsync)fence);
+}
+
+static int gl_buffer_read(uint32_t bufferID, void *data, size_t size)
+{
+    void *mapped;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+    mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (mapped)
+    {
+        memcpy(data, mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return mapped ? LITE3D_TRUE : LITE3D_FALSE;
+}
+
+#define GL_READBACK_BACKEND { \
+    gl_buffer_create, \
+    gl_buffer_delete, \
+    gl_copy, \
+    gl_fence_insert, \
+    gl_fence_signaled, \
+    gl_fence_delete, \
+    gl_buffer_read \
+}
+
+#else
+/* fences are not available, callers use synchronous read */
+#define GL_READBACK_BACKEND { NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+#endif
+
+static const lite3d_readback_backend gGLBackend = GL_READBACK_BACKEND;
+static lite3d_readback_backend gBackend = GL_READBACK_BACKEND;
+
+void lite3d_readback_set_backend(const lite3d_readback_backend *backend)
+{
+    gBackend = backend ? *backend : gGLBackend;
+}
+
+int lite3d_readback_init(lite3d_readback *readback, uint8_t depth)
+{
+    SDL_assert(readback);
+    memset(readback, 0, sizeof(*readback));
+
+    if (!gBackend.fenceInsert)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+            "%s: asynchronous readback is not supported..", LITE3D_CURRENT_FUNCTION);
+        return LITE3D_FALSE;
+    }
+
+    readback->depth = depth == 0 ? LITE3D_READBACK_DEPTH_DEFAULT :
+        (depth > LITE3D_READBACK_DEPTH_MAX ? LITE3D_READBACK_DEPTH_MAX : depth);
+    return LITE3D_TRUE;
+}
+
+void lite3d_readback_purge(lite3d_readback *readback)
+{
+    uint8_t i;
+    SDL_assert(readback);
+
+    for (i = 0; i < readback->depth; ++i)
+    {
+        if (readback->slots[i].fence)
+            gBackend.fenceDelete(readback->slots[i].fence);
+        if (readback->slots[i].bufferID)
+            gBackend.bufferDelete(readback->slots[i].bufferID);
+    }
+
+    if (readback->result)
+        lite3d_free(readback->result);
+
+    memset(readback, 0, sizeof(*readback));
+}
+
+int lite3d_readback_request(lite3d_readback *readback, const lite3d_readback_source *source)
+{
+    lite3d_readback_slot *slot;
+    SDL_assert(readback && source);
+
+    if (readback->depth == 0 || source->size == 0)
+        return LITE3D_FALSE;
+
+    /* GPU is too far behind, do not queue more work */
+    if (readback->pending == readback->depth)
+    {
+        readback->skipped++;
+        return LITE3D_FALSE;
+    }
+
+    slot = &readback->slots[(readback->first + readback->pending) % readback->depth];
+    if (slot->capacity < source->size)
+    {
+        if (slot->bufferID)
+            gBackend.bufferDelete(slot->bufferID);
+
+        slot->capacity = 0;
+        if ((slot->bufferID = gBackend.bufferCreate(source->size)) == 0)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                "%s: failed to create pack buffer of %zu bytes", LITE3D_CURRENT_FUNCTION, source->size);
+            return LITE3D_FALSE;
+        }
+
+        slot->capacity = source->size;
+    }
+
+    if (!gBackend.copy(source, slot->bufferID))
+        return LITE3D_FALSE;
+
+    if ((slot->fence = gBackend.fenceInsert()) == NULL)
+        return LITE3D_FALSE;
+
+    slot->size = source->size;
+    slot->requestNo = ++readback->requested;
+    slot->pollNo = readback->polls;
+    readback->pending++;
+    return LITE3D_TRUE;
+}
+
+int lite3d_readback_request_texture(lite3d_readback *readback,
+    const lite3d_texture_unit *texture, int8_t level)
+{
+    lite3d_readback_source source;
+    SDL_assert(texture);
+
+    memset(&source, 0, sizeof(source));
+    source.texture = texture;
+    source.level = level;
+    if (!lite3d_texture_unit_get_level_size(texture, level, 0, &source.size))
+        return LITE3D_FALSE;
+
+    return lite3d_readback_request(readback, &source);
+}
+
+int lite3d_readback_request_framebuffer(lite3d_readback *readback,
+    lite3d_framebuffer *fb, uint16_t index, uint16_t format)
+{
+    lite3d_readback_source source;
+    SDL_assert(fb);
+
+    memset(&source, 0, sizeof(source));
+    source.framebuffer = fb;
+    source.index = index;
+    source.format = format;
+    source.size = lite3d_framebuffer_size(fb, (uint8_t)format);
+
+    return lite3d_readback_request(readback, &source);
+}
+
+static void readback_release_slot(lite3d_readback *readback)
+{
+    lite3d_readback_slot *slot = &readback->slots[readback->first];
+    gBackend.fenceDelete(slot->fence);
+    slot->fence = NULL;
+    readback->first = (readback->first + 1) % readback->depth;
+    readback->pending--;
+    readback->completed++;
+}
+
+int lite3d_readback_poll(lite3d_readback *readback)
+{
+    lite3d_readback_slot *slot;
+    uint8_t ready = 0;
+    SDL_assert(readback);
+
+    readback->polls++;
+    /* fences are signaled in order of submission */
+    while (ready < readback->pending &&
+        gBackend.fenceSignaled(readback->slots[(readback->first + ready) % readback->depth].fence))
+    {
+        ready++;
+    }
+
+    if (ready == 0)
+        return LITE3D_FALSE;
+
+    /* older copies are outdated already, drop them without mapping */
+    while (ready > 1)
+    {
+        readback_release_slot(readback);
+        ready--;
+    }
+
+    slot = &readback->slots[readback->first];
+    if (readback->resultCapacity < slot->size)
+    {
+        if (readback->result)
+            lite3d_free(readback->result);
+        readback->resultCapacity = 0;
+        readback->resultSize = 0;
+        if ((readback->result = lite3d_malloc(slot->size)) == NULL)
+        {
+            readback_release_slot(readback);
+            return LITE3D_FALSE;
+        }
+
+        readback->resultCapacity = slot->size;
+    }
+
+    if (!gBackend.bufferRead(slot->bufferID, readback->result, slot->size))
+    {
+        readback_release_slot(readback);
+        return LITE3D_FALSE;
+    }
+
+    readback->resultSize = slot->size;
+    readback->resultRequestNo = slot->requestNo;
+    readback->latency = readback->polls - slot->pollNo;
+    readback_release_slot(readback);
+    return LITE3D_TRUE;
+}
+
+const void *lite3d_readback_result(const lite3d_readback *readback, size_t *size)
+{
+    SDL_assert(readback);
+    if (readback->resultRequestNo == 0)
+        return NULL;
+
+    if (size)
+        *size = readback->resultSize;
+    return readback->result;
+}
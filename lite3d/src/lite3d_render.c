@@ -28,6 +28,7 @@
 #include <lite3d/lite3d_render.h>
 #include <lite3d/lite3d_video.h>
 #include <lite3d/lite3d_buffers_manip.h>
+#include <lite3d/lite3d_gl_state.h>
 #include <lite3d/lite3d_misc.h>
 #include <lite3d/lite3d_main.h>
 #include <lite3d/lite3d_metrics.h>
@@ -57,6 +58,7 @@ static uint8_t gRenderActive = LITE3D_TRUE;
 static lite3d_render_stats gRenderStats;
 static lite3d_render_target gScreenRt;
 static lite3d_array gInvalidatedCameras;
+static lite3d_camera *gInvalidatedCamerasInline[8];
 
 static void validate_cameras(void)
 {
@@ -106,6 +108,8 @@ static int validate_renderflags(uint32_t *renderFlags)
 
 static void refresh_render_stats(uint64_t beginFrame, uint64_t endFrame)
 {
+    lite3d_frame_arena_stats arenaStats;
+    lite3d_gl_state_stats glStats;
     gFPSCounter++;
     gRenderStats.framesCount++;
     gRenderStats.lastFrameMs = ((float) (endFrame - beginFrame) / (float) gPerfFreq) * 1000.0;
@@ -124,6 +128,18 @@ static void refresh_render_stats(uint64_t beginFrame, uint64_t endFrame)
 
     gRenderStats.triangleByBatch = gRenderStats.drawCalls ? gRenderStats.trianglesRendered / gRenderStats.drawCalls : 0;
     gRenderStats.triangleMs = gRenderStats.trianglesRendered ? (float) gRenderStats.lastFrameMs / (float) gRenderStats.trianglesRendered : 0;
+
+    lite3d_frame_arena_get_stats(&arenaStats);
+    gRenderStats.frameArenaBytes = arenaStats.frameBytes;
+    gRenderStats.frameArenaHighWater = arenaStats.highWaterBytes;
+
+    lite3d_gl_state_get_stats(&glStats);
+    gRenderStats.textureBindsAvoided = glStats.textureBindsAvoided;
+    gRenderStats.bufferBindsAvoided = glStats.bufferBindsAvoided;
+    gRenderStats.uniformsSent = glStats.uniforms;
+    gRenderStats.uniformsAvoided = glStats.uniformsAvoided;
+    gRenderStats.stateChanges = glStats.stateChanges;
+    gRenderStats.stateChangesAvoided = glStats.stateChangesAvoided;
 }
 
 static void timer_render_stats_tick(lite3d_timer *timer)
@@ -195,6 +211,7 @@ static void update_render_target(lite3d_render_target *target)
             gRenderStats.textureBinds += look->scene->stats.textureBinds;
             gRenderStats.bufferBinds += look->scene->stats.bufferBinds;
             gRenderStats.drawSubCommands += look->scene->stats.drawSubCommands;
+            gRenderStats.culledClusters += look->scene->stats.culledClusters;
         }
     }
 
@@ -268,8 +285,14 @@ int lite3d_render_frame(void)
         gRenderStats.textureBinds =
         gRenderStats.bufferBinds = 
         gRenderStats.drawSubCommands = 
+        gRenderStats.culledClusters = 
         gRenderStats.verticesRendered = 0;
 
+    /* transient data of the frame before previous can be reused */
+    lite3d_frame_arena_next();
+    lite3d_memory_stats_frame();
+    lite3d_gl_state_stats_reset();
+
     if (gRenderActive)
     {
         if (gRenderListeners.preFrame &&
@@ -337,7 +360,8 @@ void lite3d_render_loop(lite3d_render_listeners *callbacks)
 
     lite3d_list_init(&gRenderTargets);
     lite3d_render_target_add(&gScreenRt, 0xFFFFFFF);
-    lite3d_array_init(&gInvalidatedCameras, sizeof(lite3d_camera *), 1);
+    lite3d_array_init_inline(&gInvalidatedCameras, sizeof(lite3d_camera *), gInvalidatedCamerasInline,
+        sizeof(gInvalidatedCamerasInline) / sizeof(gInvalidatedCamerasInline[0]));
 
     /* launch frame statistic compute timer */
     frameStatsTimer = lite3d_timer_add(1000, timer_render_stats_tick, NULL);
@@ -17,6 +17,7 @@
  *******************************************************************************/
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <SDL_assert.h>
 #include <SDL_log.h>
 #include <SDL_timer.h>
@@ -51,9 +52,13 @@ typedef struct _mqr_node
     lite3d_bounding_vol boundingVol;
     float distanceToCamera;
     lite3d_array queries;
+    /* Usually there are only a couple of cameras per node */
+    _query_unit queriesInline[2];
     _query_unit *currentQuery;
     _mqr_unit *matUnit;
     uint32_t invocationIndex;
+    /* Level of detail chosen by the last target with LITE3D_RENDER_LOD, 0 - chunk itself */
+    uint32_t lodLevel;
 } _mqr_node;
 
 #define LITE3D_INVOCATION_NODE_UNUSED          ((uint32_t)0x1)
@@ -112,22 +117,32 @@ static void mqr_node_set_shader_params(lite3d_scene *scene, lite3d_material_pass
     lite3d_shader_program_apply_parameters(pass->program, &pass->parameters, LITE3D_FALSE);
 }
 
-static void mqr_render_mesh_chunk(lite3d_scene *scene, lite3d_mesh_chunk *chunk, uint32_t count)
+static void mqr_render_mesh_chunk(lite3d_scene *scene, lite3d_mesh_chunk *chunk, uint32_t lodLevel, uint32_t count)
 {
     SDL_assert(chunk);
     SDL_assert(scene);
 
-    if (count > 1)
+    if (lodLevel > 0)
+    {
+        const lite3d_mesh_lod *lod = &chunk->lods[lodLevel - 1];
+        LITE3D_METRIC_CALL(lite3d_mesh_chunk_draw_range, (chunk, lod->indexesOffset, lod->indexesCount, count))
+        if (count > 1)
+            scene->stats.drawCallsInstanced += count;
+        scene->stats.trianglesRendered += lod->indexesCount / 3 * count;
+        scene->stats.lodDrawn += count;
+    }
+    else if (count > 1)
     {
         LITE3D_METRIC_CALL(lite3d_mesh_chunk_draw_instanced, (chunk, count))
         scene->stats.drawCallsInstanced += count;
+        scene->stats.trianglesRendered += chunk->vao.elementsCount * count;
     }
     else
     {
         LITE3D_METRIC_CALL(lite3d_mesh_chunk_draw, (chunk))
+        scene->stats.trianglesRendered += chunk->vao.elementsCount;
     }
 
-    scene->stats.trianglesRendered += chunk->vao.elementsCount * count;
     scene->stats.verticesRendered += chunk->vao.verticesCount * count;
     scene->stats.drawCalls++;
 }
@@ -153,7 +168,7 @@ static void mqr_render_batch_draw(lite3d_material_pass *pass, _mqr_node *mqrNode
         if (mqrNode->currentQuery->query.anyPassed)
         {
             // Render full complex batch under occlusion query if the node is visible
-            mqr_render_mesh_chunk(scene, mqrNode->meshChunk, mqrNode->instancesCount);
+            mqr_render_mesh_chunk(scene, mqrNode->meshChunk, mqrNode->lodLevel, mqrNode->instancesCount);
         }
         else
         {
@@ -162,7 +177,7 @@ static void mqr_render_batch_draw(lite3d_material_pass *pass, _mqr_node *mqrNode
             uint8_t depthOutput = lite3d_depth_output_get();
             lite3d_depth_output(LITE3D_FALSE);
             lite3d_backface_culling(LITE3D_CULLFACE_FRONT);
-            mqr_render_mesh_chunk(scene, mqrNode->bbMeshChunk, mqrNode->instancesCount);
+            mqr_render_mesh_chunk(scene, mqrNode->bbMeshChunk, 0, mqrNode->instancesCount);
             lite3d_backface_culling(cullingMode);
             lite3d_depth_output(depthOutput);
         }
@@ -171,7 +186,7 @@ static void mqr_render_batch_draw(lite3d_material_pass *pass, _mqr_node *mqrNode
     }
     else
     {
-        mqr_render_mesh_chunk(scene, mqrNode->meshChunk, mqrNode->instancesCount);
+        mqr_render_mesh_chunk(scene, mqrNode->meshChunk, mqrNode->lodLevel, mqrNode->instancesCount);
     }
 }
 
@@ -199,7 +214,7 @@ static void mqr_render_batch_draw_instanced(lite3d_material_pass *pass, _mqr_nod
         }
 
         mqr_node_set_shader_params(scene, pass, mqrNode);
-        mqr_render_mesh_chunk(scene, mqrNode->meshChunk, continuedId+1);
+        mqr_render_mesh_chunk(scene, mqrNode->meshChunk, mqrNode->lodLevel, continuedId+1);
 
         lite3d_array_clean(&scene->seriesMatrixes);
     }
@@ -406,6 +421,8 @@ static void mqr_unit_queue_render(lite3d_scene *scene, lite3d_array *queue, uint
                 batchCrop = LITE3D_TRUE;
             if ((*mqrNode)->matUnit != (*(mqrNode+1))->matUnit)
                 batchCrop = LITE3D_TRUE;
+            if ((*mqrNode)->lodLevel != (*(mqrNode+1))->lodLevel)
+                batchCrop = LITE3D_TRUE;
         }
 
         LITE3D_METRIC_CALL(mqr_render_node, (matPass, *mqrNode, continuedId, batchCrop, flags))
@@ -414,22 +431,40 @@ static void mqr_unit_queue_render(lite3d_scene *scene, lite3d_array *queue, uint
 }
 
 static void mqr_multirender_queue_command(lite3d_scene *scene, _mqr_node *node, 
-    lite3d_mesh_chunk *chunk)
+    lite3d_mesh_chunk *chunk, uint32_t lodLevel)
 {
     LITE3D_ARR_ADD_ELEM(&scene->invocationIndexBufferCPU, uint32_t, node->invocationIndex);
-    scene->stats.trianglesRendered += chunk->vao.elementsCount;
     scene->stats.verticesRendered += chunk->vao.verticesCount;
 
-    // Добавление команды на отрисовку чанка
-    lite3d_mesh_queue_chunk(chunk);
+    // Добавление команды на отрисовку чанка, уровни детализации - диапазоны индексов того же чанка
+    if (lodLevel > 0)
+    {
+        const lite3d_mesh_lod *lod = &chunk->lods[lodLevel - 1];
+        lite3d_mesh_queue_chunk_range(chunk, lod->indexesOffset, lod->indexesCount);
+        scene->stats.trianglesRendered += lod->indexesCount / 3;
+        scene->stats.lodDrawn++;
+    }
+    else
+    {
+        lite3d_mesh_queue_chunk(chunk);
+        scene->stats.trianglesRendered += chunk->vao.elementsCount;
+    }
     scene->stats.drawSubCommands++;
 }
 
 static void mqr_multirender_queue_command_instance(lite3d_scene *scene, _mqr_node *node, 
-    lite3d_mesh_chunk *chunk)
+    lite3d_mesh_chunk *chunk, uint32_t lodLevel)
 {
     LITE3D_ARR_ADD_ELEM(&scene->invocationIndexBufferCPU, uint32_t, node->invocationIndex);
-    scene->stats.trianglesRendered += chunk->vao.elementsCount;
+    if (lodLevel > 0)
+    {
+        scene->stats.trianglesRendered += chunk->lods[lodLevel - 1].indexesCount / 3;
+        scene->stats.lodDrawn++;
+    }
+    else
+    {
+        scene->stats.trianglesRendered += chunk->vao.elementsCount;
+    }
     scene->stats.verticesRendered += chunk->vao.verticesCount;
 
     // Добавление еще одного инстанса в предидущий чанк
@@ -437,6 +472,44 @@ static void mqr_multirender_queue_command_instance(lite3d_scene *scene, _mqr_nod
     scene->stats.drawCallsInstanced++;
 }
 
+static void mqr_multirender_queue_clusters(lite3d_scene *scene, _mqr_node *node, 
+    lite3d_mesh_chunk *chunk, uint8_t doubleSided)
+{
+    lite3d_mesh_cluster_cull_params params;
+    lite3d_mesh_cluster_cull_stats stats;
+    lite3d_mesh_index_range *range;
+    kmVec3 eye;
+
+    memset(&params, 0, sizeof(params));
+    params.worldMatrix = &node->node->worldMatrix;
+    params.frustum = node->node->frustumTest ? &scene->currentCamera->frustum : NULL;
+    params.occlusionTest = scene->clusterOcclusionTest;
+    params.userdata = scene;
+    // Двусторонние видны с обеих сторон, у ортографической камеры нет точки наблюдения
+    if (!doubleSided && !scene->currentCamera->isOrtho)
+    {
+        lite3d_camera_world_position(scene->currentCamera, &eye);
+        params.eyePosition = &eye;
+    }
+
+    lite3d_array_clean(&scene->clusterRanges);
+    lite3d_mesh_clusters_cull(chunk->clusters, chunk->clustersCount, &params, &scene->clusterRanges, &stats);
+    scene->stats.culledClusters += stats.frustumCulled + stats.backfaceCulled + stats.occlusionCulled;
+    if (scene->clusterRanges.size == 0)
+        return;
+
+    scene->stats.trianglesRendered += stats.indexesVisible / 3;
+    scene->stats.verticesRendered += chunk->vao.verticesCount;
+
+    // Команда на каждый непрерывный диапазон видимых кластеров, индекс вызова повторяется для каждой
+    LITE3D_ARR_FOREACH(&scene->clusterRanges, lite3d_mesh_index_range, range)
+    {
+        LITE3D_ARR_ADD_ELEM(&scene->invocationIndexBufferCPU, uint32_t, node->invocationIndex);
+        lite3d_mesh_queue_chunk_range(chunk, range->indexesOffset, range->indexesCount);
+        scene->stats.drawSubCommands++;
+    }
+}
+
 static int mqr_multirender_set_shader_buffers(lite3d_scene *scene, lite3d_material_pass *matPass)
 {
     lite3d_shader_parameter * pInvocationBuffer = 
@@ -471,6 +544,7 @@ static void mqr_unit_queue_multirender(lite3d_scene *scene, lite3d_array *queue,
     lite3d_mesh *mesh = NULL;
     uint32_t instancesCount = 0;
     lite3d_mesh_chunk *lastChunk = NULL;
+    uint32_t lastLodLevel = 0;
 
     // Render queue is empty 
     if (queue->size == 0)
@@ -483,7 +557,7 @@ static void mqr_unit_queue_multirender(lite3d_scene *scene, lite3d_array *queue,
         matPass = lite3d_material_get_pass((*mqrNode)->matUnit->material, pass);
         SDL_assert(matPass);
 
-        if (lastChunk != (*mqrNode)->meshChunk && instancesCount > 0)
+        if ((lastChunk != (*mqrNode)->meshChunk || lastLodLevel != (*mqrNode)->lodLevel) && instancesCount > 0)
         {
             mqr_multirender_do_batch(scene, mesh, LITE3D_FALSE);
             lastChunk = NULL;
@@ -525,29 +599,38 @@ static void mqr_unit_queue_multirender(lite3d_scene *scene, lite3d_array *queue,
             // Обьект виден, рисуем полноценный обьект
             if ((*mqrNode)->currentQuery->query.anyPassed || !(*mqrNode)->bbMeshChunk)
             {
-                mqr_multirender_queue_command(scene, *mqrNode, (*mqrNode)->meshChunk);
+                mqr_multirender_queue_command(scene, *mqrNode, (*mqrNode)->meshChunk, (*mqrNode)->lodLevel);
                 mqr_multirender_do_batch(scene, mesh, LITE3D_FALSE);
             }
             // Обьект не виден, рисуем лишь его bounding box для проверки видимости
             else 
             {
-                mqr_multirender_queue_command(scene, *mqrNode, (*mqrNode)->bbMeshChunk);
+                mqr_multirender_queue_command(scene, *mqrNode, (*mqrNode)->bbMeshChunk, 0);
                 mqr_multirender_do_batch(scene, (*mqrNode)->bbMeshChunk->mesh, LITE3D_TRUE);
             }
             lite3d_query_end(&(*mqrNode)->currentQuery->query);
         }
+        // Видимые кластеры у каждого узла свои, поэтому инстансинг для таких чанков не применяется,
+        // кластеры построены по полной детализации, упрощенные уровни рисуются целиком
+        else if (flags & LITE3D_RENDER_CLUSTER_CULLING && (*mqrNode)->meshChunk->clustersCount > 0 && 
+            (*mqrNode)->lodLevel == 0)
+        {
+            mqr_multirender_queue_clusters(scene, *mqrNode, (*mqrNode)->meshChunk, doubleSided);
+            lastChunk = NULL;
+        }
         else
         {
-            // Если прошлый чанк такой же, значит будем использовать инстансинг
-            if (lastChunk == (*mqrNode)->meshChunk)
+            // Если прошлый чанк такой же и того же уровня детализации, значит будем использовать инстансинг
+            if (lastChunk == (*mqrNode)->meshChunk && lastLodLevel == (*mqrNode)->lodLevel)
             {
-                mqr_multirender_queue_command_instance(scene, *mqrNode, (*mqrNode)->meshChunk);
+                mqr_multirender_queue_command_instance(scene, *mqrNode, (*mqrNode)->meshChunk, (*mqrNode)->lodLevel);
                 instancesCount++;
             }
             else 
             {
-                mqr_multirender_queue_command(scene, *mqrNode, (*mqrNode)->meshChunk);
+                mqr_multirender_queue_command(scene, *mqrNode, (*mqrNode)->meshChunk, (*mqrNode)->lodLevel);
                 lastChunk = (*mqrNode)->meshChunk;
+                lastLodLevel = (*mqrNode)->lodLevel;
             }
         }
     }
@@ -555,12 +638,55 @@ static void mqr_unit_queue_multirender(lite3d_scene *scene, lite3d_array *queue,
     mqr_multirender_do_batch(scene, mesh, LITE3D_FALSE);
 }
 
+#define LITE3D_MQR_QUEUE_BATCH 64
+
+static void mqr_node_select_lod(lite3d_scene *scene, _mqr_node *mqrNode)
+{
+    const kmMat4 *world = &mqrNode->node->worldMatrix;
+    lite3d_mesh_chunk *chunk = mqrNode->meshChunk;
+    float scale = 0.0f, projectedRadius;
+    int i;
+
+    if (mqrNode->node->lodBias <= 0.0f)
+    {
+        mqrNode->lodLevel = 0;
+        return;
+    }
+
+    // Радиус сферы в мировых координатах по наибольшему масштабу осей
+    for (i = 0; i < 3; ++i)
+    {
+        float axis = world->mat[i * 4] * world->mat[i * 4] + world->mat[i * 4 + 1] * world->mat[i * 4 + 1] + 
+            world->mat[i * 4 + 2] * world->mat[i * 4 + 2];
+        if (axis > scale)
+            scale = axis;
+    }
+
+    projectedRadius = lite3d_camera_projected_radius(scene->currentCamera, &mqrNode->boundingVol.sphereCenter,
+        chunk->boundingVol.radius * sqrtf(scale));
+    mqrNode->lodLevel = lite3d_mesh_lod_select(chunk->lods, chunk->lodsCount, chunk->boundingVol.radius,
+        projectedRadius, scene->lodMaxError * mqrNode->node->lodBias, scene->lodHysteresis, mqrNode->lodLevel);
+}
+
 static void mqr_unit_make_queue(lite3d_scene *scene, _mqr_unit *mqrUnit, uint16_t pass, uint32_t flags)
 {
     _mqr_node *mqrNode;
     lite3d_list_node *mqrListNode;
+    lite3d_array *stage = NULL;
+    _mqr_node *approved[LITE3D_MQR_QUEUE_BATCH];
+    size_t approvedCount = 0;
     SDL_assert(mqrUnit);
 
+    /* All nodes of the unit share the material, so choose the target stage once,
+     * ignore nodes if material pass not exist or empty */
+    if (lite3d_material_get_pass(mqrUnit->material, pass) && !lite3d_material_pass_is_empty(mqrUnit->material, pass))
+    {
+        if (lite3d_material_pass_is_blend(mqrUnit->material, pass))
+            stage = (flags & LITE3D_RENDER_TRANSPARENT) ? &scene->stageTransparent : NULL;
+        else
+            stage = (flags & LITE3D_RENDER_OPAQUE) ? &scene->stageOpague : NULL;
+    }
+
     for (mqrListNode = mqrUnit->nodes.l.next;
         mqrListNode != &mqrUnit->nodes.l; mqrListNode = lite3d_list_next(mqrListNode))
     {
@@ -598,23 +724,27 @@ static void mqr_unit_make_queue(lite3d_scene *scene, _mqr_unit *mqrUnit, uint16_
             mqrNode->distanceToCamera = lite3d_camera_distance(scene->currentCamera, &mqrNode->boundingVol.sphereCenter);
         }
         
-        /* ignore this entry if material pass not exist or empty */
-        if (!lite3d_material_get_pass(mqrUnit->material, pass) || lite3d_material_pass_is_empty(mqrUnit->material, pass))
+        if (!stage || !mqr_node_approve(scene, mqrNode, flags))
             continue;
 
-        if (lite3d_material_pass_is_blend(mqrUnit->material, pass))
-        {
-            if ((flags & LITE3D_RENDER_TRANSPARENT) && mqr_node_approve(scene, mqrNode, flags))
-                /* add to transparent stage */
-                LITE3D_ARR_ADD_ELEM(&scene->stageTransparent, _mqr_node *, mqrNode);
-        }
-        else
+        if (flags & LITE3D_RENDER_LOD && mqrNode->meshChunk->lodsCount > 0)
+            mqr_node_select_lod(scene, mqrNode);
+        else if (mqrNode->lodLevel > mqrNode->meshChunk->lodsCount)
+            mqrNode->lodLevel = 0;
+
+        /* collect approved nodes and add them to the stage by batches */
+        approved[approvedCount++] = mqrNode;
+        if (approvedCount == LITE3D_MQR_QUEUE_BATCH)
         {
-            if ((flags & LITE3D_RENDER_OPAQUE) && mqr_node_approve(scene, mqrNode, flags))
-                /* add to opague stage */
-                LITE3D_ARR_ADD_ELEM(&scene->stageOpague, _mqr_node *, mqrNode);
+            lite3d_array_append(stage, approved, approvedCount);
+            approvedCount = 0;
         }
     }
+
+    if (approvedCount > 0)
+    {
+        lite3d_array_append(stage, approved, approvedCount);
+    }
 }
 
 static void mqr_render_make_queue(struct lite3d_scene *scene, uint16_t pass, uint32_t flags)
@@ -874,6 +1004,11 @@ void lite3d_scene_render(lite3d_scene *scene, lite3d_camera *camera,
         return;
 
     scene->currentCamera = camera;
+    /* storage of the previous render may be already reused by the arena, 
+     * reserve as much as it needed to avoid regrowth */
+    lite3d_array_init_frame(&scene->stageOpague, sizeof(_mqr_node *), scene->stageOpague.capacity);
+    lite3d_array_init_frame(&scene->stageTransparent, sizeof(_mqr_node *), scene->stageTransparent.capacity);
+    lite3d_array_init_frame(&scene->seriesMatrixes, sizeof(kmMat4), scene->seriesMatrixes.capacity);
     LITE3D_METRIC_CALL(mqr_render_make_queue, (scene, pass, flags));
     /* render common objects */
     LITE3D_METRIC_CALL(mqr_render_stage_opaque, (scene, pass, flags))
@@ -893,6 +1028,8 @@ int lite3d_scene_init(lite3d_scene *scene, uint32_t features)
 {
     SDL_assert(scene);
     memset(scene, 0, sizeof (lite3d_scene));
+    scene->lodMaxError = 0.001f;
+    scene->lodHysteresis = 0.25f;
 
     if (features & LITE3D_SCENE_FEATURE_MULTIRENDER)
     {
@@ -916,10 +1053,12 @@ int lite3d_scene_init(lite3d_scene *scene, uint32_t features)
     scene->rootNode.renderable = LITE3D_FALSE;
     lite3d_list_init(&scene->materialRenderUnits);
 
-    lite3d_array_init(&scene->stageOpague, sizeof(_mqr_node *), 2);
-    lite3d_array_init(&scene->stageTransparent, sizeof(_mqr_node *), 2);
+    /* queues of a single render, taken from the frame arena on every render */
+    lite3d_array_init_frame(&scene->stageOpague, sizeof(_mqr_node *), 0);
+    lite3d_array_init_frame(&scene->stageTransparent, sizeof(_mqr_node *), 0);
     lite3d_array_init(&scene->invalidatedUnits, sizeof(lite3d_scene_node *), 2);
-    lite3d_array_init(&scene->seriesMatrixes, sizeof(kmMat4), 10);
+    lite3d_array_init_frame(&scene->seriesMatrixes, sizeof(kmMat4), 0);
+    lite3d_array_init(&scene->clusterRanges, sizeof(lite3d_mesh_index_range), 16);
 
     scene->features = features;
     return LITE3D_TRUE;
@@ -956,6 +1095,7 @@ void lite3d_scene_purge(lite3d_scene *scene)
     lite3d_array_purge(&scene->stageOpague);
     lite3d_array_purge(&scene->stageTransparent);
     lite3d_array_purge(&scene->invalidatedUnits);
+    lite3d_array_purge(&scene->clusterRanges);
     
     if (scene->features & LITE3D_SCENE_FEATURE_MULTIRENDER)
     {
@@ -1133,7 +1273,8 @@ int lite3d_scene_node_touch_material(struct lite3d_scene_node *node,
         if (!mqrNode) return LITE3D_FALSE;
 
         lite3d_list_link_init(&mqrNode->unit);
-        lite3d_array_init(&mqrNode->queries, sizeof(_query_unit), 1);
+        lite3d_array_init_inline(&mqrNode->queries, sizeof(_query_unit), mqrNode->queriesInline, 
+            sizeof(mqrNode->queriesInline) / sizeof(mqrNode->queriesInline[0]));
         mqrNode->node = node;
     }
 
@@ -1143,6 +1284,7 @@ int lite3d_scene_node_touch_material(struct lite3d_scene_node *node,
     mqrNode->bbMeshChunk = bbMeshChunk;
     mqrNode->boundingVol = meshChunk->boundingVol;
     mqrNode->instancesCount = instancesCount == 0 ? 1 : instancesCount;
+    mqrNode->lodLevel = 0;
     mqr_unit_add_node(scene, mqrUnit, mqrNode);
 
     return LITE3D_TRUE;
@@ -40,6 +40,7 @@ void lite3d_scene_node_init(lite3d_scene_node *node)
     node->visible = LITE3D_TRUE;
     node->frustumTest = LITE3D_TRUE;
     node->skeletonTransformIndex = -1;
+    node->lodBias = 1.0f;
     lite3d_list_init(&node->childNodes);
 }
 
@@ -57,6 +58,14 @@ void lite3d_scene_node_set_rotation(lite3d_scene_node *node, const kmQuaternion
     node->recalc = LITE3D_TRUE;
 }
 
+void lite3d_scene_node_set_transform(lite3d_scene_node *node, const kmVec3 *position, const kmQuaternion *quat)
+{
+    SDL_assert(node && position && quat);
+    node->position = *position;
+    node->rotation = *quat;
+    node->recalc = LITE3D_TRUE;
+}
+
 void lite3d_scene_node_move(lite3d_scene_node *node, const kmVec3 *position)
 {
     SDL_assert(node && position);
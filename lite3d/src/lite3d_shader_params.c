@@ -112,13 +112,31 @@ void lite3d_shader_global_parameters_init(void)
     kmMat4Identity(&globalParams.projViewMatrix.parameter.valmat4);
 }
 
+uint32_t lite3d_shader_parameter_name_hash(const char *name)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    SDL_assert(name);
+
+    for (; *name; ++name)
+    {
+        hash ^= (uint8_t)*name;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
 static lite3d_shader_parameter_container *lite3d_shader_parameters_find(
     lite3d_shader_parameters *params, const char *name)
 {
     lite3d_list_node *parameterNode;
     lite3d_shader_parameter_container *parameter;
+    uint32_t nameHash;
     SDL_assert(params);
 
+    nameHash = lite3d_shader_parameter_name_hash(name);
+
     for (parameterNode = params->parameters.l.next;
         parameterNode != &params->parameters.l;
         parameterNode = lite3d_list_next(parameterNode))
@@ -128,7 +146,7 @@ static lite3d_shader_parameter_container *lite3d_shader_parameters_find(
             parameterNode,
             parameterLink);
 
-        if (strcmp(parameter->parameter->name, name) == 0)
+        if (parameter->nameHash == nameHash && strcmp(parameter->parameter->name, name) == 0)
         {
             return parameter;
         }
@@ -155,11 +173,14 @@ void lite3d_shader_parameters_add(lite3d_shader_parameters *params, lite3d_shade
     SDL_assert_release(parameter);
 
     parameter->parameter = param;
+    parameter->nameHash = lite3d_shader_parameter_name_hash(param->name);
     parameter->location = -1; // unknown ??
     parameter->binding = -1; // unknown ??
     parameter->bindContext = &params->bindContext;
     lite3d_list_link_init(&parameter->parameterLink);
     lite3d_list_add_last_link(&parameter->parameterLink, &params->parameters);
+    /* recompile apply table */
+    params->compiledProgram = NULL;
 }
 
 int lite3d_shader_parameters_remove(lite3d_shader_parameters *params, const char *name)
@@ -171,6 +192,7 @@ int lite3d_shader_parameters_remove(lite3d_shader_parameters *params, const char
     {
         lite3d_list_unlink_link(&parameter->parameterLink);
         lite3d_free_pooled(LITE3D_POOL_NO1, parameter);
+        params->compiledProgram = NULL;
 
         return LITE3D_TRUE;
     }
@@ -187,6 +209,9 @@ void lite3d_shader_parameters_remove_all(lite3d_shader_parameters *params)
             LITE3D_MEMBERCAST(lite3d_shader_parameter_container,
             parameterNode, parameterLink));
     }
+
+    lite3d_array_purge(&params->applyTable);
+    params->compiledProgram = NULL;
 }
 
 lite3d_shader_parameter *lite3d_shader_parameters_get(lite3d_shader_parameters *params, const char *name)
@@ -15,6 +15,7 @@
  *	You should have received a copy of the GNU General Public License
  *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
  *******************************************************************************/
+#include <string.h>
 #include <SDL_assert.h>
 #include <SDL_log.h>
 
@@ -27,6 +28,8 @@
 typedef int (*lite3d_uniform_set_func)(lite3d_shader_program *, lite3d_shader_parameter_container *);
 
 static lite3d_shader_program *gActProg = NULL;
+/* unique for every link, programs could be recreated at the same address */
+static uint32_t gLinkCounter = 0;
 static int gMaxGeometryOutputVertices = 0;
 static int gMaxGeometryTotalOutputComponents = 0;
 static int gMaxGeometryOutputComponents = 0;
@@ -138,6 +141,154 @@ int lite3d_shader_program_init(struct lite3d_shader_program *program)
     return LITE3D_TRUE;
 }
 
+static int lite3d_shader_program_binding_cmp(uint32_t nameHash, uint8_t kind, const lite3d_shader_binding *binding)
+{
+    if (nameHash != binding->nameHash)
+        return nameHash < binding->nameHash ? -1 : 1;
+    if (kind != binding->kind)
+        return kind < binding->kind ? -1 : 1;
+    return 0;
+}
+
+/* index of first binding not less than key */
+static size_t lite3d_shader_program_binding_lower_bound(const struct lite3d_shader_program *program,
+    uint32_t nameHash, uint8_t kind)
+{
+    size_t lo = 0, hi = program->bindings.size;
+    const lite3d_shader_binding *bindings = (const lite3d_shader_binding *)program->bindings.data;
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (lite3d_shader_program_binding_cmp(nameHash, kind, &bindings[mid]) > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+int lite3d_shader_program_add_binding(struct lite3d_shader_program *program,
+    const char *name, uint8_t kind, int32_t location, uint32_t type, int32_t size)
+{
+    char baseName[LITE3D_SHADER_PARAMETER_MAX_NAME];
+    lite3d_shader_binding *binding;
+    uint32_t nameHash;
+    size_t nameLength, index;
+
+    SDL_assert(program);
+    SDL_assert(name);
+
+    nameLength = strlen(name);
+    if (nameLength >= sizeof(baseName))
+        return LITE3D_FALSE;
+
+    strcpy(baseName, name);
+    if (nameLength > 3 && strcmp(baseName + nameLength - 3, "[0]") == 0)
+        baseName[nameLength - 3] = 0;
+
+    nameHash = lite3d_shader_parameter_name_hash(baseName);
+    if (program->bindings.elemSize == 0)
+        lite3d_array_init(&program->bindings, sizeof(lite3d_shader_binding), 16);
+
+    index = lite3d_shader_program_binding_lower_bound(program, nameHash, kind);
+    if (index < program->bindings.size)
+    {
+        binding = lite3d_array_get(&program->bindings, index);
+        if (lite3d_shader_program_binding_cmp(nameHash, kind, binding) == 0)
+        {
+            binding->location = LITE3D_SHADER_BINDING_COLLISION;
+            return LITE3D_TRUE;
+        }
+    }
+
+    if (!lite3d_array_add(&program->bindings))
+        return LITE3D_FALSE;
+
+    binding = lite3d_array_get(&program->bindings, index);
+    if (index < program->bindings.size - 1)
+        memmove(binding + 1, binding, (program->bindings.size - 1 - index) * sizeof(lite3d_shader_binding));
+
+    binding->nameHash = nameHash;
+    binding->kind = kind;
+    binding->location = location;
+    binding->type = type;
+    binding->size = size;
+    return LITE3D_TRUE;
+}
+
+const lite3d_shader_binding *lite3d_shader_program_find_binding(
+    const struct lite3d_shader_program *program, uint32_t nameHash, uint8_t kind)
+{
+    const lite3d_shader_binding *binding;
+    size_t index;
+    SDL_assert(program);
+
+    index = lite3d_shader_program_binding_lower_bound(program, nameHash, kind);
+    if (index >= program->bindings.size)
+        return NULL;
+
+    binding = (const lite3d_shader_binding *)program->bindings.data + index;
+    return lite3d_shader_program_binding_cmp(nameHash, kind, binding) == 0 ? binding : NULL;
+}
+
+/* collect active uniforms and blocks once, so parameters are not looked up by name while rendering */
+static void lite3d_shader_program_build_bindings(struct lite3d_shader_program *program)
+{
+    char name[LITE3D_SHADER_PARAMETER_MAX_NAME];
+    GLint count = 0, i;
+
+    glGetProgramiv(program->programID, GL_ACTIVE_UNIFORMS, &count);
+    for (i = 0; i < count; ++i)
+    {
+        GLint size = 0, location;
+        GLenum type = 0;
+        GLsizei length = 0;
+
+        glGetActiveUniform(program->programID, i, sizeof(name), &length, &size, &type, name);
+        /* members of uniform blocks have no location */
+        if (length <= 0 || (location = glGetUniformLocation(program->programID, name)) < 0)
+            continue;
+
+        lite3d_shader_program_add_binding(program, name, LITE3D_SHADER_BINDING_UNIFORM, 
+            location, type, size);
+    }
+
+#ifndef WITH_GLES2
+    if (lite3d_check_uniform_buffer())
+    {
+        count = 0;
+        glGetProgramiv(program->programID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        for (i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(program->programID, i, sizeof(name), &length, name);
+            if (length > 0)
+                lite3d_shader_program_add_binding(program, name, LITE3D_SHADER_BINDING_UNIFORM_BLOCK, i, 0, 1);
+        }
+    }
+#endif
+
+#ifndef GLES
+    if (lite3d_check_ssbo())
+    {
+        count = 0;
+        glGetProgramInterfaceiv(program->programID, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count);
+        for (i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            glGetProgramResourceName(program->programID, GL_SHADER_STORAGE_BLOCK, i, sizeof(name), &length, name);
+            if (length > 0)
+                lite3d_shader_program_add_binding(program, name, LITE3D_SHADER_BINDING_STORAGE_BLOCK, i, 0, 1);
+        }
+    }
+#endif
+
+    SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "shader program(%d) 0x%016llx: %d active uniforms and blocks",
+        program->programID, (unsigned long long)program, (int)program->bindings.size);
+}
+
 int lite3d_shader_program_link(struct lite3d_shader_program *program, lite3d_shader *shaders, size_t count)
 {
     uint32_t i;
@@ -178,8 +329,15 @@ int lite3d_shader_program_link(struct lite3d_shader_program *program, lite3d_sha
     for (i = 0; i < count; ++i)
         glDetachShader(program->programID, shaders[i].shaderID);
 
+    /* uniform locations and values are reset by linking */
+    lite3d_array_clean(&program->uniformCache);
+    lite3d_array_clean(&program->bindings);
+    program->linkId = ++gLinkCounter;
+
     if (program->success)
     {
+        lite3d_shader_program_build_bindings(program);
+
         if (program->statusString)
         {
             SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "shader program(%d) 0x%016llx linked successfully: %s", 
@@ -259,6 +417,9 @@ void lite3d_shader_program_purge(struct lite3d_shader_program *program)
             program->statusString = NULL;
         }
     }
+
+    lite3d_array_purge(&program->uniformCache);
+    lite3d_array_purge(&program->bindings);
 }
 
 void lite3d_shader_program_bind(struct lite3d_shader_program *program)
@@ -278,6 +439,12 @@ void lite3d_shader_program_unbind(struct lite3d_shader_program *program)
     gActProg = NULL;
 }
 
+static void lite3d_shader_program_uniform1i(struct lite3d_shader_program *program, int32_t location, int32_t value)
+{
+    if (lite3d_gl_state_uniform_changed(&program->uniformCache, location, &value, sizeof(value)))
+        glUniform1i(location, value);
+}
+
 static int lite3d_shader_program_sampler_set(struct lite3d_shader_program *program, struct lite3d_shader_parameter_container *p)
 {
     SDL_assert(program);
@@ -302,7 +469,7 @@ static int lite3d_shader_program_sampler_set(struct lite3d_shader_program *progr
     if (p->binding < 0)
         p->binding = p->bindContext->textureBindingsCount++;
     
-    glUniform1i(p->location, p->binding);
+    lite3d_shader_program_uniform1i(program, p->location, p->binding);
     lite3d_texture_unit_bind(p->parameter->parameter.texture, p->binding);
     return LITE3D_TRUE;
 }
@@ -338,7 +505,7 @@ static int lite3d_shader_program_ssbo_set(
         glShaderStorageBlockBinding(program->programID, p->location, p->binding);
     }
     
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, p->binding, p->parameter->parameter.vbo->vboID);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_STORAGE, p->binding, p->parameter->parameter.vbo->vboID);
 
     if (p->parameter->direction == LITE3D_SHADER_PARAMETER_DIRECTION_OUTPUT || 
         p->parameter->direction == LITE3D_SHADER_PARAMETER_DIRECTION_INOUT)
@@ -385,7 +552,7 @@ static int lite3d_shader_program_ubo_set(
         glUniformBlockBinding(program->programID, p->location, p->binding);
     }
     
-    glBindBufferBase(GL_UNIFORM_BUFFER, p->binding, p->parameter->parameter.vbo->vboID);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_UNIFORM, p->binding, p->parameter->parameter.vbo->vboID);
     return LITE3D_TRUE;
 #else
     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
@@ -422,7 +589,7 @@ static int lite3d_shader_program_image_store_set(
     if (p->binding < 0)
         p->binding = p->bindContext->textureImageBindingsCount++;
     
-    glUniform1i(p->location, p->binding);
+    lite3d_shader_program_uniform1i(program, p->location, p->binding);
 
     if (p->parameter->direction == LITE3D_SHADER_PARAMETER_DIRECTION_OUTPUT || 
         p->parameter->direction == LITE3D_SHADER_PARAMETER_DIRECTION_INOUT)
@@ -471,11 +638,13 @@ static int lite3d_shader_program_simple_uniform_set(
     switch (p->parameter->type)
     {
         case LITE3D_SHADER_PARAMETER_INT:
-            glUniform1i(p->location, p->parameter->parameter.valint);
+            lite3d_shader_program_uniform1i(program, p->location, p->parameter->parameter.valint);
             break;
         case LITE3D_SHADER_PARAMETER_UINT:
 #ifndef WITH_GLES2
-            glUniform1ui(p->location, p->parameter->parameter.valuint);
+            if (lite3d_gl_state_uniform_changed(&program->uniformCache, p->location, 
+                &p->parameter->parameter.valuint, sizeof(uint32_t)))
+                glUniform1ui(p->location, p->parameter->parameter.valuint);
 #else
             SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: uniform '%s' type is not supported in program(%d) 0x%016llx",
                 LITE3D_CURRENT_FUNCTION, p->parameter->name, program->programID, (unsigned long long)program);
@@ -483,19 +652,29 @@ static int lite3d_shader_program_simple_uniform_set(
 #endif
             break;
         case LITE3D_SHADER_PARAMETER_FLOAT:
-            glUniform1f(p->location, p->parameter->parameter.valfloat);
+            if (lite3d_gl_state_uniform_changed(&program->uniformCache, p->location, 
+                &p->parameter->parameter.valfloat, sizeof(float)))
+                glUniform1f(p->location, p->parameter->parameter.valfloat);
             break;
         case LITE3D_SHADER_PARAMETER_FLOATV3:
-            glUniform3fv(p->location, 1, &p->parameter->parameter.valvec3.x);
+            if (lite3d_gl_state_uniform_changed(&program->uniformCache, p->location, 
+                &p->parameter->parameter.valvec3, sizeof(kmVec3)))
+                glUniform3fv(p->location, 1, &p->parameter->parameter.valvec3.x);
             break;
         case LITE3D_SHADER_PARAMETER_FLOATV4:
-            glUniform4fv(p->location, 1, &p->parameter->parameter.valvec4.x);
+            if (lite3d_gl_state_uniform_changed(&program->uniformCache, p->location, 
+                &p->parameter->parameter.valvec4, sizeof(kmVec4)))
+                glUniform4fv(p->location, 1, &p->parameter->parameter.valvec4.x);
             break;
         case LITE3D_SHADER_PARAMETER_FLOATM3:
-            glUniformMatrix3fv(p->location, 1, GL_FALSE, p->parameter->parameter.valmat3.mat);
+            if (lite3d_gl_state_uniform_changed(&program->uniformCache, p->location, 
+                &p->parameter->parameter.valmat3, sizeof(kmMat3)))
+                glUniformMatrix3fv(p->location, 1, GL_FALSE, p->parameter->parameter.valmat3.mat);
             break;
         case LITE3D_SHADER_PARAMETER_FLOATM4:
-            glUniformMatrix4fv(p->location, 1, GL_FALSE, p->parameter->parameter.valmat4.mat);
+            if (lite3d_gl_state_uniform_changed(&program->uniformCache, p->location, 
+                &p->parameter->parameter.valmat4, sizeof(kmMat4)))
+                glUniformMatrix4fv(p->location, 1, GL_FALSE, p->parameter->parameter.valmat4.mat);
             break;
         default:
         {
@@ -602,16 +781,36 @@ void lite3d_shader_program_compute_dispatch_sync(struct lite3d_shader_program *p
     glDeleteSync(sync);
 }
 
-void lite3d_shader_program_apply_parameters(struct lite3d_shader_program *program, 
-    struct lite3d_shader_parameters *params, uint8_t changed)
+static uint8_t lite3d_shader_program_binding_kind(uint8_t parameterType)
+{
+    switch (parameterType)
+    {
+        case LITE3D_SHADER_PARAMETER_SSBO:
+            return LITE3D_SHADER_BINDING_STORAGE_BLOCK;
+        case LITE3D_SHADER_PARAMETER_UBO:
+            return LITE3D_SHADER_BINDING_UNIFORM_BLOCK;
+        default:
+            return LITE3D_SHADER_BINDING_UNIFORM;
+    }
+}
+
+void lite3d_shader_program_compile_parameters(struct lite3d_shader_program *program, 
+    struct lite3d_shader_parameters *params)
 {
     lite3d_list_node *parameterNode;
     lite3d_shader_parameter_container *parameter;
+    const lite3d_shader_binding *binding;
 
     SDL_assert(program);
     SDL_assert(params);
 
-    /* check parameters and set it if changed */
+    if (params->applyTable.elemSize == 0)
+        lite3d_array_init(&params->applyTable, sizeof(lite3d_shader_parameter_container *), 16);
+
+    lite3d_array_clean(&params->applyTable);
+    /* bindings are assigned again for new program */
+    memset(&params->bindContext, 0, sizeof(params->bindContext));
+
     for (parameterNode = params->parameters.l.next;
         parameterNode != &params->parameters.l;
         parameterNode = lite3d_list_next(parameterNode))
@@ -619,10 +818,38 @@ void lite3d_shader_program_apply_parameters(struct lite3d_shader_program *progra
         parameter = LITE3D_MEMBERCAST(lite3d_shader_parameter_container,
             parameterNode, parameterLink);
 
-        if (changed || parameter->parameter->changed)
+        binding = lite3d_shader_program_find_binding(program, parameter->nameHash, 
+            lite3d_shader_program_binding_kind(parameter->parameter->type));
+        /* unknown names (e.g. array elements) are queried by name once as before */
+        parameter->location = binding && binding->location != LITE3D_SHADER_BINDING_COLLISION ?
+            binding->location : -1;
+        parameter->binding = -1;
+
+        LITE3D_ARR_ADD_ELEM(&params->applyTable, lite3d_shader_parameter_container *, parameter);
+    }
+
+    params->compiledProgram = program;
+    params->compiledLinkId = program->linkId;
+}
+
+void lite3d_shader_program_apply_parameters(struct lite3d_shader_program *program, 
+    struct lite3d_shader_parameters *params, uint8_t changed)
+{
+    lite3d_shader_parameter_container **parameter;
+
+    SDL_assert(program);
+    SDL_assert(params);
+
+    if (params->compiledProgram != program || params->compiledLinkId != program->linkId)
+        lite3d_shader_program_compile_parameters(program, params);
+
+    /* check parameters and set it if changed */
+    LITE3D_ARR_FOREACH(&params->applyTable, lite3d_shader_parameter_container *, parameter)
+    {
+        if (changed || (*parameter)->parameter->changed)
         {
-            lite3d_shader_program_uniform_set(program, parameter);
-            parameter->parameter->changed = LITE3D_FALSE;
+            uniformsMethodsTable[(*parameter)->parameter->type](program, *parameter);
+            (*parameter)->parameter->changed = LITE3D_FALSE;
         }
     }
 }
@@ -22,6 +22,7 @@
 #include <lite3d/lite3d_glext.h>
 #include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_misc.h>
+#include <lite3d/lite3d_gl_state.h>
 #include <lite3d/lite3d_tbo.h>
 
 extern GLenum textureTargetEnum[];
@@ -103,7 +104,7 @@ int lite3d_texture_buffer_init(lite3d_texture_unit *textureUnit,
         return LITE3D_FALSE;
     
     glGenTextures(1, &textureUnit->textureID);
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     glTexBuffer(textureTargetEnum[textureUnit->textureTarget], bf, textureUnit->tbo.vboID);
     
     if (LITE3D_CHECK_GL_ERROR)
@@ -27,6 +27,7 @@
 #include <lite3d/lite3d_glext.h>
 #include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_misc.h>
+#include <lite3d/lite3d_gl_state.h>
 #include <lite3d/lite3d_texture_unit.h>
 #include <lite3d/lite3d_texture_dds.h>
 
@@ -877,7 +878,7 @@ int lite3d_texture_unit_from_resource(lite3d_texture_unit *textureUnit,
     }
 
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureTarget], textureUnit->textureID);
 
     /* calc saved mipmaps in image */
     textureUnit->loadedMipmaps = ilGetInteger(IL_NUM_MIPMAPS);
@@ -965,7 +966,7 @@ int lite3d_texture_unit_set_pixels(lite3d_texture_unit *textureUnit,
         return LITE3D_FALSE;
     
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     switch (textureUnit->textureTarget)
     {
         case LITE3D_TEXTURE_1D:
@@ -1002,7 +1003,7 @@ int lite3d_texture_unit_set_compressed_pixels(lite3d_texture_unit *textureUnit,
         return LITE3D_FALSE;
     
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
 
 #ifndef GLES
     {
@@ -1015,7 +1016,7 @@ int lite3d_texture_unit_set_compressed_pixels(lite3d_texture_unit *textureUnit,
         {
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s texture level %d is not a compressed format...",
                 LITE3D_CURRENT_FUNCTION, level);
-            glBindTexture(textureTargetEnum[textureUnit->textureTarget], 0);
+            lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], 0);
             return LITE3D_FALSE;
         }
     }
@@ -1100,7 +1101,7 @@ int lite3d_texture_unit_get_compressed_level_size(const lite3d_texture_unit *tex
         return LITE3D_FALSE;
 
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     glGetTexLevelParameteriv(textureUnit->textureTarget == LITE3D_TEXTURE_CUBE ? 
         GL_TEXTURE_CUBE_MAP_POSITIVE_X + cubeface : textureTargetEnum[textureUnit->textureTarget],
         level, GL_TEXTURE_COMPRESSED, &compressed);
@@ -1129,7 +1130,7 @@ int lite3d_texture_unit_get_pixels(const lite3d_texture_unit *textureUnit,
         return LITE3D_FALSE;
 
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     lite3d_misc_gl_error_stack_clean();
 
     glGetTexImage(textureUnit->textureTarget == LITE3D_TEXTURE_CUBE ? 
@@ -1156,7 +1157,7 @@ int lite3d_texture_unit_get_compressed_pixels(const lite3d_texture_unit *texture
         return LITE3D_FALSE;
 
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     lite3d_misc_gl_error_stack_clean();
 
     glGetTexLevelParameteriv(textureUnit->textureTarget == LITE3D_TEXTURE_CUBE ? 
@@ -1182,7 +1183,7 @@ int lite3d_texture_unit_generate_mipmaps(lite3d_texture_unit *textureUnit)
     SDL_assert(textureUnit);
     if(textureUnit->generatedMipmaps > 0)
     {
-        glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+        lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
         glGenerateMipmap(textureTargetEnum[textureUnit->textureTarget]);
         return LITE3D_TRUE;
     }
@@ -1190,6 +1191,49 @@ int lite3d_texture_unit_generate_mipmaps(lite3d_texture_unit *textureUnit)
     return LITE3D_FALSE;
 }
 
+int lite3d_texture_unit_copy_support(void)
+{
+    return lite3d_check_copy_image();
+}
+
+int lite3d_texture_unit_copy_layers(const lite3d_texture_unit *source, lite3d_texture_unit *dest,
+    int8_t level, int32_t srcLayer, int32_t dstLayer, int32_t count)
+{
+    int32_t width, height;
+    SDL_assert(source);
+    SDL_assert(dest);
+
+    if (!lite3d_texture_unit_copy_support())
+        return LITE3D_FALSE;
+
+    /* size taken from unit, no need to query GL every frame */
+    if (source->textureTarget != dest->textureTarget || 
+        source->internalFormat != dest->internalFormat ||
+        source->imageWidth != dest->imageWidth ||
+        source->imageHeight != dest->imageHeight)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: textures 0x%016llx and 0x%016llx are not compatible",
+            LITE3D_CURRENT_FUNCTION, (unsigned long long)source, (unsigned long long)dest);
+        return LITE3D_FALSE;
+    }
+
+    if (srcLayer < 0 || dstLayer < 0 || srcLayer + count > source->imageDepth || dstLayer + count > dest->imageDepth)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: layers range %d..%d is out of texture",
+            LITE3D_CURRENT_FUNCTION, srcLayer, srcLayer + count);
+        return LITE3D_FALSE;
+    }
+
+    width = LITE3D_MAX(source->imageWidth >> level, 1);
+    height = LITE3D_MAX(source->imageHeight >> level, 1);
+
+    lite3d_misc_gl_error_stack_clean();
+    glCopyImageSubData(source->textureID, textureTargetEnum[source->textureTarget], level, 0, 0, srcLayer,
+        dest->textureID, textureTargetEnum[dest->textureTarget], level, 0, 0, dstLayer, width, height, count);
+
+    return LITE3D_CHECK_GL_ERROR ? LITE3D_FALSE : LITE3D_TRUE;
+}
+
 int lite3d_texture_unit_allocate(lite3d_texture_unit *textureUnit,
     uint32_t textureTarget, int8_t filtering, uint8_t wrapping, uint16_t format,
     uint16_t iformat, int32_t width, int32_t height, int32_t depth, int32_t samples)
@@ -1275,7 +1319,7 @@ int lite3d_texture_unit_allocate(lite3d_texture_unit *textureUnit,
     }
 
     /* make texture active */
-    glBindTexture(textureTargetEnum[textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureTarget], textureUnit->textureID);
 
     if (filtering == LITE3D_TEXTURE_FILTER_TRILINEAR && textureTarget < LITE3D_TEXTURE_BUFFER)
     {
@@ -1368,6 +1412,7 @@ int lite3d_texture_unit_allocate(lite3d_texture_unit *textureUnit,
 void lite3d_texture_unit_purge(lite3d_texture_unit *textureUnit)
 {
     SDL_assert(textureUnit);
+    lite3d_gl_state_forget_texture(textureUnit->textureID);
     glDeleteTextures(1, &textureUnit->textureID);
     textureUnit->textureID = 0;
     textureUnit->totalSize = 0;
@@ -1378,8 +1423,7 @@ void lite3d_texture_unit_bind(lite3d_texture_unit *textureUnit, uint16_t layer)
     SDL_assert(textureUnit);
     SDL_assert(layer < maxCombinedTextureImageUnits);
 
-    glActiveTexture(GL_TEXTURE0 + layer);
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture(layer, textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
 }
 
 void lite3d_texture_unit_unbind(lite3d_texture_unit *textureUnit, uint16_t layer)
@@ -1387,8 +1431,7 @@ void lite3d_texture_unit_unbind(lite3d_texture_unit *textureUnit, uint16_t layer
     SDL_assert(textureUnit);
     SDL_assert(layer < maxCombinedTextureImageUnits);
 
-    glActiveTexture(GL_TEXTURE0 + layer);
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], 0);
+    lite3d_gl_state_bind_texture(layer, textureTargetEnum[textureUnit->textureTarget], 0);
 }
 
 void lite3d_texture_unit_compression(uint8_t on)
@@ -1408,7 +1451,7 @@ int32_t lite3d_texture_unit_get_level_width(const lite3d_texture_unit *textureUn
 #ifndef GLES
     int32_t result = 0;
     SDL_assert(textureUnit);
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     glGetTexLevelParameteriv(textureUnit->textureTarget == LITE3D_TEXTURE_CUBE ? 
         GL_TEXTURE_CUBE_MAP_POSITIVE_X + cubeface : textureTargetEnum[textureUnit->textureTarget],
         level, GL_TEXTURE_WIDTH, &result);
@@ -1425,7 +1468,7 @@ int32_t lite3d_texture_unit_get_level_height(const lite3d_texture_unit *textureU
 #ifndef GLES
     int32_t result = 0;
     SDL_assert(textureUnit);
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     glGetTexLevelParameteriv(textureUnit->textureTarget == LITE3D_TEXTURE_CUBE ? 
         GL_TEXTURE_CUBE_MAP_POSITIVE_X + cubeface : textureTargetEnum[textureUnit->textureTarget],
         level, GL_TEXTURE_HEIGHT, &result);
@@ -1442,7 +1485,7 @@ int32_t lite3d_texture_unit_get_level_depth(const lite3d_texture_unit *textureUn
 #ifndef GLES
     int32_t result = 0;
     SDL_assert(textureUnit);
-    glBindTexture(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
+    lite3d_gl_state_bind_texture_active(textureTargetEnum[textureUnit->textureTarget], textureUnit->textureID);
     glGetTexLevelParameteriv(textureUnit->textureTarget == LITE3D_TEXTURE_CUBE ? 
         GL_TEXTURE_CUBE_MAP_POSITIVE_X + cubeface : textureTargetEnum[textureUnit->textureTarget],
         level, GL_TEXTURE_DEPTH, &result);
@@ -121,6 +121,25 @@ void lite3d_vao_draw_indexed_instanced(struct lite3d_vao *vao, uint32_t count)
         GL_UNSIGNED_INT, LITE3D_BUFFER_OFFSET(vao->indexesOffset), count);
 }
 
+void lite3d_vao_draw_indexed_range(struct lite3d_vao *vao, uint32_t indexesOffset, uint32_t indexesCount, 
+    uint32_t instancesCount)
+{
+    SDL_assert(vao);
+    SDL_assert((size_t)(indexesOffset + indexesCount) * sizeof(uint32_t) <= vao->indexesSize);
+
+    if (instancesCount > 1)
+    {
+        SDL_assert(instancingSupport);
+        glDrawElementsInstanced(GL_TRIANGLES, indexesCount, GL_UNSIGNED_INT, 
+            LITE3D_BUFFER_OFFSET(vao->indexesOffset + (size_t)indexesOffset * sizeof(uint32_t)), instancesCount);
+    }
+    else
+    {
+        glDrawElements(GL_TRIANGLES, indexesCount, GL_UNSIGNED_INT, 
+            LITE3D_BUFFER_OFFSET(vao->indexesOffset + (size_t)indexesOffset * sizeof(uint32_t)));
+    }
+}
+
 void lite3d_vao_multidraw_indexed(size_t offset, size_t count)
 {
     /* 
@@ -24,6 +24,7 @@
 #include <lite3d/lite3d_glext.h>
 #include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_misc.h>
+#include <lite3d/lite3d_gl_state.h>
 #include <lite3d/lite3d_render.h>
 #include <lite3d/lite3d_vbo.h>
 
@@ -505,6 +506,7 @@ void lite3d_vbo_purge(struct lite3d_vbo *vbo)
     if (vbo->vboID > 0)
     {
         lite3d_render_stats *s = lite3d_render_stats_get();
+        lite3d_gl_state_forget_buffer(vbo->vboID);
         glDeleteBuffers(1, &vbo->vboID);
         
         s->vboCount--;
@@ -53,7 +53,74 @@ namespace lite3dpp
             stl<std::tuple<Channel, ChannelValue>>::vector channels;
         };
 
-        using FramePair = std::pair<const KeyFrame *, const KeyFrame *>;
+        // Key frames of one animated target (node or bone) compiled to SoA arrays. Key that has no 
+        // some channel takes the value of the nearest key with this channel.
+        struct Track
+        {
+            enum ChannelFlags : uint8_t
+            {
+                HasLocation = 1 << 0,
+                HasRotation = 1 << 1,
+                HasScale = 1 << 2
+            };
+
+            stl<float>::vector times;
+            stl<kmVec3>::vector translations;
+            stl<kmQuaternion>::vector rotations;
+            stl<kmVec3>::vector scales;
+            uint8_t channels = 0;
+
+            // Cursor is the last key not later than time, it is kept by the player and moves 
+            // forward with the time, so sequential playback never searches the keys.
+            // Node may be SceneNode, Bone or something else with set Position Rotation Scale
+            template<class Node>
+            void apply(Node *node, float time, uint32_t &cursor) const
+            {
+                if (times.empty() || channels == 0)
+                    return;
+
+                const uint32_t last = static_cast<uint32_t>(times.size() - 1);
+                // Time went back, cycle restarted 
+                if (cursor > last || times[cursor] > time)
+                    cursor = 0;
+                while (cursor < last && times[cursor + 1] <= time)
+                    cursor++;
+
+                // Before the first key or after the last one the key is taken as is
+                if (cursor == last || times[cursor] > time)
+                {
+                    if (channels & HasLocation)
+                        node->setPosition(translations[cursor]);
+                    if (channels & HasRotation)
+                        node->setRotation(rotations[cursor]);
+                    if (channels & HasScale)
+                        node->setScale(scales[cursor]);
+                    return;
+                }
+
+                float k = (time - times[cursor]) / (times[cursor + 1] - times[cursor]);
+                if (channels & HasLocation)
+                {
+                    kmVec3 interpolated;
+                    kmVec3Lerp(&interpolated, &translations[cursor], &translations[cursor + 1], k);
+                    node->setPosition(interpolated);
+                }
+
+                if (channels & HasRotation)
+                {
+                    kmQuaternion interpolated;
+                    kmQuaternionSlerp(&interpolated, &rotations[cursor], &rotations[cursor + 1], k);
+                    node->setRotation(interpolated);
+                }
+
+                if (channels & HasScale)
+                {
+                    kmVec3 interpolated;
+                    kmVec3Lerp(&interpolated, &scales[cursor], &scales[cursor + 1], k);
+                    node->setScale(interpolated);
+                }
+            }
+        };
 
         Action(const String &name, const String &path, Main &main);
         virtual ~Action() = default;
@@ -62,11 +129,18 @@ namespace lite3dpp
         { return mMinFrame; }
         inline float getMaxFrame() const
         { return mMaxFrame; }
+        inline const Track &getTrack() const
+        { return mTrack; }
+        inline const stl<Track>::vector &getBoneTracks() const
+        { return mBoneTracks; }
 
         std::unique_ptr<ActionClip> playAction(SceneNodeBase &node, bool cycle);
         std::unique_ptr<ActionClip> playAction(MeshSceneNode &node, bool cycle);
-        FramePair getFramePairByTime(float time) const;
-        FramePair getFramePairBoneByTime(float time, const String &boneName) const;
+        // Index in getBoneTracks or -1 if the bone is not animated, resolve it once per clip 
+        int32_t getBoneTrackIndex(const String &boneName) const;
+
+        // Sorted key frames to track
+        static void compileTrack(const stl<KeyFrame>::vector &keyFrames, Track &track);
 
     protected:
 
@@ -74,12 +148,12 @@ namespace lite3dpp
         virtual void unloadImpl() override;
 
         static void loadKeyFrames(const ConfigurationReader &config, stl<KeyFrame>::vector &keyFrames);
-        FramePair getFramePairByTime(float time, const stl<KeyFrame>::vector &frames) const;
 
     protected:
 
-        stl<KeyFrame>::vector mKeyFrames;
-        stl<String, stl<KeyFrame>::vector>::unordered_map mSkeletonKeyFrames;
+        Track mTrack;
+        stl<Track>::vector mBoneTracks;
+        stl<String, int32_t>::unordered_map mBoneTrackIndices;
         float mMinFrame = 0;
         float mMaxFrame = 0;
     };
@@ -50,17 +50,16 @@ namespace lite3dpp
 
     protected:
 
+        // Animated bone resolved once at clip creation
+        struct BoneBinding
+        {
+            SkeletonBone *bone;
+            uint32_t track;
+            uint32_t cursor;
+        };
+
         virtual void timerTick(lite3d_timer *timerid) override;
-        // Interpolate between two frames, node may be SceneNode, Bone or something else with 
-        // get/set Position Rotation Scale
-        template<class Node, class FramePair>
-        void interpolate(Node *node, const FramePair& framePair);
-        template<class Node, class KeyFrame>
-        kmVec3 consolidatePosition(Node *node, const KeyFrame *keyFrame, bool &updated);
-        template<class Node, class KeyFrame>
-        kmQuaternion consolidateRotation(Node *node, const KeyFrame *keyFrame, bool &updated);
-        template<class Node, class KeyFrame>
-        kmVec3 consolidateScale(Node *node, const KeyFrame *keyFrame, bool &updated);
+        void sample();
 
     protected:
 
@@ -73,6 +72,8 @@ namespace lite3dpp
         kmQuaternion mInitialRotation;
         kmVec3 mInitialScale;
         float mTime = 0.0f;
+        uint32_t mCursor = 0;
+        stl<BoneBinding>::vector mBoneBindings;
         ActionClipState mState = ActionClipState::STOPPED;
         
     };
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_buffer_base.h>
+
+namespace lite3dpp
+{
+    // Dirty bit per element of CPU copy of GPU buffer. Changed elements are uploaded
+    // by contiguous ranges, short clean gaps are uploaded together with neighbours
+    // because one bigger setData is cheaper than two small ones.
+    class LITE3DPP_EXPORT BufferDirtyRanges
+    {
+    public:
+
+        static const constexpr size_t DefaultMaxGap = 4;
+
+        // Range of elements
+        struct Range
+        {
+            size_t first;
+            size_t count;
+        };
+
+        struct Stats
+        {
+            uint64_t bytesUploaded = 0;
+            uint64_t uploads = 0;
+            uint64_t flushes = 0;
+            size_t lastBytesUploaded = 0;
+        };
+
+        explicit BufferDirtyRanges(size_t elementSize, size_t maxGap = DefaultMaxGap);
+
+        // New elements are clean, dirty bits of removed elements are dropped
+        void resize(size_t elements);
+        void markDirty(size_t first, size_t count = 1);
+        void markAllDirty();
+        bool isDirty(size_t element) const;
+        void clear();
+
+        inline bool hasDirty() const
+        { return mDirtyBegin < mDirtyEnd; }
+        inline size_t size() const
+        { return mSize; }
+        inline size_t elementSize() const
+        { return mElementSize; }
+        inline size_t bytesHeld() const
+        { return mSize * mElementSize; }
+        inline const Stats &getStats() const
+        { return mStats; }
+
+        // Merged ranges of current dirty elements
+        const stl<Range>::vector &buildRanges();
+        // One setData per range from CPU copy, all elements become clean. Returns uploaded bytes
+        size_t flush(BufferBase &buffer, const void *shadow);
+
+    private:
+
+        size_t findNext(size_t from, bool dirty) const;
+
+        size_t mElementSize;
+        size_t mMaxGap;
+        size_t mSize = 0;
+        // Bounds of dirty elements, bits outside are always zero
+        size_t mDirtyBegin = 0;
+        size_t mDirtyEnd = 0;
+        stl<uint64_t>::vector mBits;
+        stl<Range>::vector mRanges;
+        Stats mStats;
+    };
+}
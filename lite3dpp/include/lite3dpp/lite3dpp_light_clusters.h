@@ -0,0 +1,150 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_manageable.h>
+
+namespace lite3dpp
+{
+    // Light source volume in camera view space
+    struct ClusterLight
+    {
+        kmVec3 position;
+        // Zero radius means the light affects every cluster, e.g. directional light
+        float radius;
+        // Spot light axis and half of outer cone, coneSin == 0 for point lights
+        kmVec3 direction;
+        float coneCos;
+        float coneSin;
+        // Index of the light in the light parameters buffer
+        int32_t index;
+    };
+
+    struct ClusterBox
+    {
+        kmVec3 min;
+        kmVec3 max;
+        kmVec3 center;
+        float radius;
+    };
+
+    // Froxel grid of perspective camera, lights are binned into view space AABBs of clusters.
+    // Result is one block of ints ready for SSBO upload:
+    //   ivec4 (tilesX, tilesY, slices, globalCount), vec4 (sliceScale, sliceBias, tanHalfX, tanHalfY),
+    //   (offset, count) pair for every cluster, indexes list which starts from global lights.
+    // Cluster of fragment: slice = log(viewDepth) * sliceScale + sliceBias, tiles from view space xy / depth.
+    class LITE3DPP_EXPORT LightClusterGrid : public Noncopiable
+    {
+    public:
+
+        static const constexpr uint32_t HeaderSize = 8;
+        // Binning is not split between threads for less lights
+        static const constexpr size_t ParallelMinLights = 1024;
+
+        LightClusterGrid(uint32_t tilesX, uint32_t tilesY, uint32_t slices);
+        ~LightClusterGrid();
+
+        // Boxes are recalculated only if parameters are changed, fovy in degrees
+        void setupPerspective(float znear, float zfar, float fovy, float aspect);
+        // threads == 0 means all hardware threads
+        void build(const ClusterLight *lights, size_t count, uint32_t threads = 1);
+
+        inline uint32_t getTilesX() const
+        { return mTilesX; }
+        inline uint32_t getTilesY() const
+        { return mTilesY; }
+        inline uint32_t getSlices() const
+        { return mSlices; }
+        inline uint32_t clustersCount() const
+        { return mTilesX * mTilesY * mSlices; }
+        inline uint32_t clusterIndex(uint32_t x, uint32_t y, uint32_t z) const
+        { return (z * mTilesY + y) * mTilesX + x; }
+
+        ClusterBox getClusterBox(uint32_t cluster) const;
+        inline uint32_t getGlobalCount() const
+        { return static_cast<uint32_t>(mData[3]); }
+        // Offset of cluster lights in indexes list
+        inline uint32_t getClusterOffset(uint32_t cluster) const
+        { return static_cast<uint32_t>(mData[HeaderSize + cluster * 2]); }
+        inline uint32_t getClusterCount(uint32_t cluster) const
+        { return static_cast<uint32_t>(mData[HeaderSize + cluster * 2 + 1]); }
+        inline const int32_t *getIndexes() const
+        { return mData.data() + HeaderSize + clustersCount() * 2; }
+        inline size_t getIndexesCount() const
+        { return mData.size() - HeaderSize - clustersCount() * 2; }
+
+        inline const stl<int32_t>::vector &getData() const
+        { return mData; }
+        // Light of last build got into at least one cluster or is global
+        inline bool isLightVisible(size_t light) const
+        { return mVisible[light] != 0; }
+
+        // Reference test of the light against cluster box, same result as SIMD path
+        static bool intersects(const ClusterLight &light, const ClusterBox &box);
+
+    private:
+
+        struct Bin
+        {
+            stl<uint32_t>::vector clusters;
+            stl<int32_t>::vector lights;
+            stl<int32_t>::vector global;
+            stl<uint32_t>::vector counts;
+        };
+
+        void binLights(const ClusterLight *lights, size_t count, uint8_t *visible, Bin &bin) const;
+        bool binLight(const ClusterLight &light, Bin &bin) const;
+        void runParallel(uint32_t threads, const std::function<void(uint32_t)> &job);
+        void workerLoop(uint32_t workerIndex, uint64_t generation);
+        void testRow(const ClusterLight &light, uint32_t first, uint32_t count, Bin &bin) const;
+
+    private:
+
+        uint32_t mTilesX;
+        uint32_t mTilesY;
+        uint32_t mSlices;
+        float mProjection[4] = {};
+        // Cluster boxes, SoA for SIMD tests, padded for 4-wide loads
+        stl<float>::vector mMinX, mMinY, mMinZ;
+        stl<float>::vector mMaxX, mMaxY, mMaxZ;
+        stl<float>::vector mCenterX, mCenterY, mCenterZ, mRadius;
+        // Box ranges along each axis, x/y per slice, used to find candidate clusters
+        stl<float>::vector mSliceMinZ, mSliceMaxZ;
+        stl<float>::vector mTileMinX, mTileMaxX;
+        stl<float>::vector mTileMinY, mTileMaxY;
+        stl<int32_t>::vector mData;
+        stl<uint8_t>::vector mVisible;
+        stl<Bin>::vector mBins;
+
+        std::vector<std::thread> mWorkers;
+        std::mutex mLock;
+        std::condition_variable mWake;
+        std::condition_variable mDone;
+        const std::function<void(uint32_t)> *mJob = nullptr;
+        uint32_t mJobThreads = 0;
+        uint32_t mPending = 0;
+        uint64_t mGeneration = 0;
+        bool mStop = false;
+    };
+}
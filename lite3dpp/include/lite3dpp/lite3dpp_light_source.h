@@ -111,6 +111,8 @@ namespace lite3dpp
 
         void translateToWorld(const kmMat4 &worldMatrix);
         void writeToBuffer(BufferBase &buffer);
+        inline const lite3d_light_params &getWorldParams() const
+        { return mLightSourceWorld.params; }
         lite3d_bounding_vol getBoundingVolumeWorld() const;
         lite3d_bounding_vol getBoundingVolume() const;
 
@@ -29,6 +29,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <lite3d/lite3d_alloc.h>
 #include <lite3dpp/lite3dpp_common.h>
 
 namespace lite3dpp
@@ -74,6 +75,43 @@ namespace lite3dpp
         Noncopiable& operator=(const Noncopiable&) = delete;
     };
 
+    /* Allocates from the per-thread frame arena, memory stays valid until the end of the next frame, 
+     * deallocation is a noop. Use it for transient containers only and reserve them up front, 
+     * every reallocation leaves the old block in the arena. */
+    template<class T>
+    class FrameStlAllocator
+    {
+    public:
+
+        using value_type = T;
+
+        FrameStlAllocator() noexcept = default;
+        template<class U>
+        FrameStlAllocator(const FrameStlAllocator<U> &) noexcept 
+        {}
+
+        T *allocate(size_t n)
+        {
+            void *mem = lite3d_frame_alloc(sizeof(T) * n);
+            if (!mem)
+            {
+                throw std::bad_alloc();
+            }
+
+            return static_cast<T *>(mem);
+        }
+
+        void deallocate(T *, size_t) noexcept
+        {}
+
+        template<class U>
+        bool operator==(const FrameStlAllocator<U> &) const noexcept
+        { return true; }
+        template<class U>
+        bool operator!=(const FrameStlAllocator<U> &) const noexcept
+        { return false; }
+    };
+
 #ifdef LITE3DPP_USE_STL_ALLOCATOR
     
     template<class T>
@@ -114,6 +152,7 @@ namespace lite3dpp
             ManageableStlAllocator<std::pair<const T, Y>>>;
         using unordered_set = std::unordered_set<T, std::hash<T>, std::equal_to<T>, 
             ManageableStlAllocator<T>>;
+        using frame_vector = std::vector<T, FrameStlAllocator<T>>;
     };
 
     using String = std::basic_string<char, char_traits<char>, ManageableStlAllocator<char>>;
@@ -137,6 +176,7 @@ namespace lite3dpp
         using stack = std::stack<T>;
         using unordered_map = std::unordered_map<T, Y>;
         using unordered_set = std::unordered_set<T>;
+        using frame_vector = std::vector<T, FrameStlAllocator<T>>;
     };
     
     using String = std::string;
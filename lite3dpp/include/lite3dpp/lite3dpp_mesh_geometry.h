@@ -0,0 +1,63 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3d/lite3d_mesh_codec.h>
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_manageable.h>
+
+namespace lite3dpp
+{
+    // Host copy of .m mesh geometry: vertex positions and indexes only, without GL buffers.
+    // Decoding does not touch GL context, so it may be done in worker thread or without window.
+    class LITE3DPP_EXPORT MeshGeometry : public Noncopiable
+    {
+    public:
+
+        using Ptr = std::shared_ptr<MeshGeometry>;
+        using Chunk = lite3d_mesh_m_geometry_chunk;
+
+        MeshGeometry(const String &name, const void *buffer, size_t size);
+        ~MeshGeometry();
+
+        inline const String &getName() const
+        { return mName; }
+        inline uint32_t chunksCount() const
+        { return mGeometry.chunksCount; }
+        const Chunk &getChunk(uint32_t index) const;
+        inline uint32_t verticesCount() const
+        { return mGeometry.verticesCount; }
+        inline uint32_t indexesCount() const
+        { return mGeometry.indexesCount; }
+        // 3 floats per vertex
+        inline const float *positions() const
+        { return mGeometry.positions; }
+        inline const uint32_t *indexes() const
+        { return mGeometry.indexes; }
+        // Positions and indexes of chunk, indexes are relative to first vertex of chunk
+        const float *chunkPositions(uint32_t index) const;
+        const uint32_t *chunkIndexes(uint32_t index) const;
+        // FNV-1a of chunks, positions and indexes, the same geometry gives the same hash on any run
+        uint64_t contentHash() const;
+
+    private:
+
+        String mName;
+        lite3d_mesh_m_geometry mGeometry;
+    };
+}
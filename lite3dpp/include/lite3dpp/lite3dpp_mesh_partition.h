@@ -43,6 +43,15 @@ namespace lite3dpp
         { return mUsageMode; }
 
         void extend(size_t extendVertexSize, size_t extendIndexSize);
+        // Место чанка освобождается для последующих append/loadMesh
+        void remove(lite3d_mesh_chunk *chunk);
+        // Сдвигает данные чанков в начало буферов, свободное место собирается в конце
+        void compact();
+
+        inline const lite3d_range_allocator &getVertexRanges() const
+        { return mPartition.vertexRanges; }
+        inline const lite3d_range_allocator &getIndexRanges() const
+        { return mPartition.indexRanges; }
 
         lite3d_mesh_chunk *append(const VertexArrayWrap &vertices, const IndexArrayWrap &indices, 
             const BufferLayout &layout);
@@ -127,6 +127,19 @@ namespace lite3dpp
 
         virtual void updatePosition(SceneNodeBase *node) {}
         virtual void updateRotation(SceneNodeBase *node) {}
+        /* Позиция и вращение заданы вместе (SceneNodeBase::setTransform) */
+        virtual void updateTransform(SceneNodeBase *node) 
+        { 
+            updatePosition(node);
+            updateRotation(node);
+        }
+        /* Пакет трансформаций (SceneNodeTransformBatch): все узлы пакета уже записаны, 
+           наблюдатель получает один вызов со своими узлами */
+        virtual void updateTransforms(SceneNodeBase *const *nodes, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+                updateTransform(nodes[i]);
+        }
         virtual void updateScale(SceneNodeBase *node) {}
         virtual void updateSkeletonPose(SceneNodeBase *node) {}
     };
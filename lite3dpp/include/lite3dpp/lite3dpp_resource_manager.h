@@ -17,6 +17,7 @@
 *******************************************************************************/
 #pragma once
 
+#include <lite3d/lite3d_alloc.h>
 #include <lite3d/lite3d_pack.h>
 
 #include <lite3dpp/lite3dpp_manageable.h>
@@ -58,6 +59,11 @@ namespace lite3dpp
             uint32_t meshPartitionsLoadedCount;
             uint32_t actionsCount;
             size_t totalCachedFilesMemSize;
+            /* lite3d memory statistic, zero if built without LITE3D_WITH_MEMORY_STATS */
+            lite3d_memory_stats heapMem;
+            lite3d_memory_stats poolsMem[LITE3D_POOL_MAX];
+            /* memory allocated during resource loading and still alive, by resource type */
+            size_t resourcesMem[AbstractResource::ACTION + 1];
         } ResourceManagerStats;
 
         template<class T>
@@ -145,6 +151,7 @@ namespace lite3dpp
 
         String generateResourceName();
         AbstractResource *fetchResource(const String &key);
+        void releaseSceneTemplates();
         virtual void loadResource(const String &name, 
             const String &path,
             std::shared_ptr<AbstractResource> resource);
@@ -24,6 +24,8 @@
 #include <lite3dpp/lite3dpp_scene_object.h>
 #include <lite3dpp/lite3dpp_camera.h>
 #include <lite3dpp/lite3dpp_light_source.h>
+#include <lite3dpp/lite3dpp_light_clusters.h>
+#include <lite3dpp/lite3dpp_buffer_dirty_ranges.h>
 #include <lite3dpp/lite3dpp_observer.h>
 #include <lite3dpp/lite3dpp_texture_buffer.h>
 
@@ -37,11 +39,13 @@ namespace lite3dpp
 
         static const constexpr uint32_t InitialLightCount = 10;
         static const constexpr uint32_t MaxLightCount = 512;
+        static const constexpr uint32_t MaxClusteredLightCount = 16384;
 
         using SceneObjects = stl<String, SceneObject::Ptr>::unordered_map;
+        using SceneTemplates = stl<String, std::unique_ptr<SceneObjectTemplate>>::unordered_map;
         using SceneLights = stl<LightSceneNode *>::unordered_set;
         using SceneCameras = stl<String, Camera*>::unordered_map;
-        using LightsIndexesStore = stl<int32_t>::vector;
+        using LightsIndexesStore = stl<int32_t>::frame_vector;
 
         Scene(const String &name, 
             const String &path, Main &main);
@@ -57,6 +61,13 @@ namespace lite3dpp
             SceneObjectBase *parent = nullptr, const kmVec3 &initialPosition = KM_VEC3_ZERO, 
             const kmQuaternion &initialRotation = KM_QUATERNION_IDENTITY, const kmVec3 &initialScale = KM_VEC3_ONE);
 
+        /* Шаблон обьекта разбирается при первом обращении и дальше берется из кеша сцены */
+        const SceneObjectTemplate &getTemplate(const String &templatePath);
+        /* Сброс разобранных шаблонов, нужен при выгрузке ресурсов, на которые они ссылаются */
+        void releaseTemplates();
+        inline size_t templatesCount() const
+        { return mTemplates.size(); }
+
         void attachCamera(Camera* camera, SceneObjectBase *parent = nullptr);
         void detachCamera(Camera* camera);
         SceneObject *getObject(const String &name) const;
@@ -82,6 +93,16 @@ namespace lite3dpp
             return mLightingIndexBuffer;
         }
 
+        inline BufferBase *getLightClusterBuffer()
+        {
+            return mLightingClusterBuffer;
+        }
+
+        inline const BufferDirtyRanges &getLightParamsDirtyRanges() const
+        {
+            return mLightParamsDirty;
+        }
+
     protected:
 
         virtual void loadFromConfigImpl(const ConfigurationReader &helper) override;
@@ -90,6 +111,8 @@ namespace lite3dpp
         void setupCallbacks();
         void rebuildLightingBuffer();
         void validateLightingBuffer(const Camera &camera);
+        bool validateLightClusters(const Camera &camera, LightsIndexesStore &lightsIndexes);
+        void writeLightParams(const LightSource &light);
         void addLightSource(LightSceneNode *node);
         void removeLightSource(LightSceneNode *node);
         
@@ -127,14 +150,21 @@ namespace lite3dpp
 
         lite3d_scene mScene;
         SceneObjects mObjects;
+        SceneTemplates mTemplates;
         SceneLights mLights;
         SceneCameras mCameras;
         VBOResource *mLightingParamsBuffer = nullptr;
         VBOResource *mLightingIndexBuffer = nullptr;
         VBOResource *mInvocationBuffer = nullptr;
         VBOResource *mInvocationIndexBuffer = nullptr;
-        LightsIndexesStore mLightsIndexes;
+        VBOResource *mLightingClusterBuffer = nullptr;
+        // CPU копия параметров источников, в GPU заливаются только измененные
+        stl<lite3d_light_params>::vector mLightParams;
+        BufferDirtyRanges mLightParamsDirty;
         uint32_t mMaxLightsCount; 
+        std::unique_ptr<LightClusterGrid> mLightClusters;
+        String mLightClustersCamera;
+        uint32_t mLightClustersThreads = 1;
     };
 }
 
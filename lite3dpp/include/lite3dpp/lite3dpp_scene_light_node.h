@@ -29,6 +29,7 @@ namespace lite3dpp
         using Ptr = std::shared_ptr<LightSceneNode>;
         
         LightSceneNode(const ConfigurationReader &json, SceneNodeBase *parent, Scene *scene);
+        LightSceneNode(const SceneNodePrototype &prototype, SceneNodeBase *parent, Scene *scene);
         ~LightSceneNode();
 
         inline LightSource *getLight()
@@ -30,6 +30,7 @@ namespace lite3dpp
         using Ptr = std::shared_ptr<MeshSceneNode>;
         
         MeshSceneNode(const ConfigurationReader &json, SceneNodeBase *parent, Scene *scene);
+        MeshSceneNode(const SceneNodePrototype &prototype, SceneNodeBase *parent, Scene *scene);
         
         inline Mesh *getMesh()
         { return mMesh; }
@@ -39,6 +40,13 @@ namespace lite3dpp
         { return mSkeleton.get(); }
         inline void instances(uint32_t count)
         { mInstances = count; }
+        inline uint32_t getInstances() const
+        { return mInstances; }
+        // Множитель допустимой ошибки уровня детализации, 0 - всегда полная детализация
+        inline void setLodBias(float bias)
+        { getPtr()->lodBias = bias; }
+        inline float getLodBias() const
+        { return getPtr()->lodBias; }
         
         void setSkeletonBufferIndex(int32_t index);
         void applyMaterial(uint32_t materialID, Material *material);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <lite3dpp/lite3dpp_scene_node_base.h>
+#include <lite3dpp/lite3dpp_scene_object_template.h>
 
 namespace lite3dpp
 {
@@ -28,6 +29,7 @@ namespace lite3dpp
         using Ptr = std::shared_ptr<SceneNode>;
 
         SceneNode(const ConfigurationReader &json, SceneNodeBase *parent, Scene *scene);
+        SceneNode(const SceneNodePrototype &prototype, SceneNodeBase *parent, Scene *scene);
         virtual ~SceneNode();
 
     protected:
@@ -66,6 +66,8 @@ namespace lite3dpp
         void rotateY(float angleDelta);
         void rotateX(float angleDelta);
         void rotateZ(float angleDelta);
+        /* Позиция и вращение разом, наблюдатели получают одно уведомление updateTransform */
+        void setTransform(const kmVec3 &position, const kmQuaternion &quat);
         
         void setScale(const kmVec3 &scale);
         const kmVec3 &getScale() const;
@@ -129,4 +131,42 @@ namespace lite3dpp
         std::unique_ptr<ActionClip> mClip;
         stl<String, Action *>::unordered_map mActions;
     };
+
+    /* Пакетная запись трансформаций узлов (например после шага физики): сначала пишутся все узлы, 
+       затем каждый наблюдатель получает один вызов updateTransforms со своими узлами пакета. 
+       Буферы переиспользуются, в установившемся режиме apply не выделяет память */
+    class LITE3DPP_EXPORT SceneNodeTransformBatch : public Noncopiable
+    {
+    public:
+
+        inline void add(SceneNodeBase *node, const kmVec3 &position, const kmQuaternion &quat)
+        { mRecords.push_back({ node, position, quat }); }
+        inline size_t size() const
+        { return mRecords.size(); }
+        inline bool empty() const
+        { return mRecords.empty(); }
+
+        void apply();
+        void clear();
+
+    private:
+
+        struct Record
+        {
+            SceneNodeBase *node;
+            kmVec3 position;
+            kmQuaternion rotation;
+        };
+
+        struct Notify
+        {
+            SceneNodeObserver *observer;
+            size_t record;
+        };
+
+        stl<Record>::vector mRecords;
+        /* Пары наблюдатель - запись, сортируются по наблюдателю */
+        stl<Notify>::vector mNotifies;
+        stl<SceneNodeBase *>::vector mObserverNodes;
+    };
 }
@@ -20,7 +20,7 @@
 #include <lite3dpp/lite3dpp_scene_object_base.h>
 #include <lite3dpp/lite3dpp_scene_mesh_node.h>
 #include <lite3dpp/lite3dpp_scene_light_node.h>
-#include <lite3dpp/lite3dpp_scene_light_node.h>
+#include <lite3dpp/lite3dpp_scene_object_template.h>
 
 
 namespace lite3dpp
@@ -53,10 +53,15 @@ namespace lite3dpp
         MeshSceneNode* getMeshNode(const String &name) const;
 
         void loadFromTemplate(const ConfigurationReader& conf) override;
+        /* Создание узлов из разобранного шаблона, результат тот же, что у загрузки из json */
+        virtual void loadFromTemplate(const SceneObjectTemplate &objectTemplate);
 
         virtual SceneNode* addNode(const ConfigurationReader &nodeconf, SceneNodeBase *parent);
         virtual MeshSceneNode* addMeshNode(const ConfigurationReader &nodeconf, SceneNodeBase *parent);
         virtual LightSceneNode* addLightNode(const ConfigurationReader &nodeconf, SceneNodeBase *parent);
+        virtual SceneNode* addNode(const SceneNodePrototype &prototype, SceneNodeBase *parent);
+        virtual MeshSceneNode* addMeshNode(const SceneNodePrototype &prototype, SceneNodeBase *parent);
+        virtual LightSceneNode* addLightNode(const SceneNodePrototype &prototype, SceneNodeBase *parent);
         
         void removeNode(const String &name);
         void removeMeshNode(const String &name);
@@ -67,6 +72,7 @@ namespace lite3dpp
     protected:
         
         virtual SceneNode* createNode(const ConfigurationReader &conf, SceneNodeBase *parent);
+        virtual SceneNode* createNode(const SceneNodePrototype &prototype, SceneNodeBase *parent);
         void setupNodes(const stl<ConfigurationReader>::vector &nodesRange, SceneNodeBase *parent);
 
     protected:
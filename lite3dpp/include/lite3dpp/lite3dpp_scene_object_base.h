@@ -61,6 +61,7 @@ namespace lite3dpp
         virtual void rotateY(float angleDelta);
         virtual void rotateX(float angleDelta);
         virtual void rotateZ(float angleDelta);
+        virtual void setTransform(const kmVec3 &position, const kmQuaternion &quat);
 
         virtual kmVec3 transformCoordToWorld(const kmVec3 &point);
         virtual kmVec3 transformVecToWorld(const kmVec3 &vec);
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3dpp/lite3dpp_config_reader.h>
+
+namespace lite3dpp
+{
+    /* Узел шаблона с уже найденными ресурсами. Тип узла выбирается как в SceneObject::createNode, 
+       json узла остается для полей, которые читаются при создании (Light, Skeleton, узлы наследников). */
+    struct LITE3DPP_EXPORT SceneNodePrototype
+    {
+        enum NodeType
+        {
+            TypeNode,
+            TypeMesh,
+            TypeLight
+        };
+
+        SceneNodePrototype(Main &main, const ConfigurationReader &nodeJson);
+
+        ConfigurationReader json;
+        String name;
+        NodeType type = TypeNode;
+        /* Индекс родителя в SceneObjectTemplate::getNodes, -1 у корня */
+        int32_t parent = -1;
+        bool frustumTest = true;
+        kmVec3 position = KM_VEC3_ZERO;
+        kmQuaternion rotation = KM_QUATERNION_IDENTITY;
+        kmVec3 scale = KM_VEC3_ONE;
+        stl<Action *>::vector actions;
+        uint32_t instances = 1;
+        Mesh *mesh = nullptr;
+        stl<uint32_t, Material *>::unordered_map materials;
+    };
+
+    /* Шаблон обьекта, разобранный один раз: узлы лежат плоским массивом в порядке создания 
+       (родитель раньше детей, как при обходе json), ресурсы узлов уже найдены.
+       Указатели на ресурсы действительны пока ресурсы не выгружены, поэтому ResourceManager 
+       сбрасывает шаблоны всех сцен при выгрузке меша, материала или действия. */
+    class LITE3DPP_EXPORT SceneObjectTemplate : public Noncopiable
+    {
+    public:
+
+        using Nodes = stl<SceneNodePrototype>::vector;
+
+        SceneObjectTemplate(Main &main, const String &templatePath);
+        SceneObjectTemplate(Main &main, const char *data, size_t size);
+
+        inline const String &getPath() const
+        { return mPath; }
+        inline const Nodes &getNodes() const
+        { return mNodes; }
+        /* Весь json шаблона */
+        inline const ConfigurationReader &getJson() const
+        { return mJson; }
+
+    private:
+
+        SceneObjectTemplate(Main &main, const String &templatePath, const std::string_view &data);
+        void compile(Main &main);
+        void compileNodes(Main &main, const stl<ConfigurationReader>::vector &nodes, int32_t parent);
+
+        String mPath;
+        ConfigurationReader mJson;
+        Nodes mNodes;
+    };
+}
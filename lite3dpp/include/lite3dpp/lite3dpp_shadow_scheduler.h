@@ -0,0 +1,108 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3dpp/lite3dpp_shadow_visibility.h>
+
+namespace lite3dpp
+{
+    // Chooses which of pending shadow maps are redrawn this frame. Priority of shadow grows with
+    // screen coverage, closeness to camera, movement and frames it waits for update. At most
+    // MaxUpdatesPerFrame layers are redrawn and their estimated cost has to fit in BudgetMs.
+    // Shadow waiting MaxStaleFrames frames is forced out of budget, so every shadow is updated
+    // not later than MaxStaleFrames + ceil(pending / MaxUpdatesPerFrame) frames.
+    // Deterministic: same inputs give same choice, ties are resolved by smaller index.
+    class LITE3DPP_EXPORT ShadowUpdateScheduler : public Noncopiable
+    {
+    public:
+
+        using CasterMask = ShadowVisibility::CasterMask;
+
+        struct Config
+        {
+            // 0 - no limit
+            uint32_t maxUpdatesPerFrame = 0;
+            // 0 - no limit
+            float budgetMs = 0.0f;
+            uint32_t maxStaleFrames = 8;
+            // Cost of one layer before first measurement
+            float initialLayerCostMs = 0.25f;
+            float coverageWeight = 4.0f;
+            float distanceWeight = 2.0f;
+            // Distance where distance term is half of its weight
+            float distanceScale = 50.0f;
+            float movementWeight = 2.0f;
+            // Per frame of waiting
+            float ageWeight = 1.0f;
+        };
+
+        // Input state of shadow caster for the frame
+        struct LightState
+        {
+            // Shadow map is invalid and light is visible
+            bool pending = false;
+            // Light or shadow casters seen by it moved since previous frame
+            bool moving = false;
+            // Part of screen covered by light influence, 0..1
+            float coverage = 0.0f;
+            float distance = 0.0f;
+        };
+
+        struct LightStats
+        {
+            float priority = 0.0f;
+            // Frames shadow waits for update now
+            uint32_t staleFrames = 0;
+            // The longest wait ever
+            uint32_t maxStaleFrames = 0;
+            uint64_t updates = 0;
+            // Frames when shadow was pending and was not updated
+            uint64_t deferrals = 0;
+        };
+
+        ShadowUpdateScheduler() = default;
+        explicit ShadowUpdateScheduler(const Config &config);
+
+        void setConfig(const Config &config);
+        inline const Config &getConfig() const
+        { return mConfig; }
+
+        // Returns lights to update this frame
+        const CasterMask &schedule(const LightState *lights, uint32_t count);
+        // Measured time of updating layers, used as cost estimate of next frames
+        void reportCost(float milliseconds, uint32_t layers);
+
+        inline float getLayerCostMs() const
+        { return mLayerCostMs; }
+        inline const CasterMask &getScheduled() const
+        { return mScheduled; }
+        inline uint32_t lightsCount() const
+        { return static_cast<uint32_t>(mStats.size()); }
+        const LightStats &getLightStats(uint32_t index) const;
+
+        float priority(const LightState &light, uint32_t staleFrames) const;
+
+    private:
+
+        Config mConfig;
+        float mLayerCostMs = mConfig.initialLayerCostMs;
+        CasterMask mScheduled;
+        stl<LightStats>::vector mStats;
+        stl<uint32_t>::vector mOrder;
+    };
+}
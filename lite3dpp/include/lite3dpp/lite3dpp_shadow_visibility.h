@@ -0,0 +1,152 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <bitset>
+#include <lite3d/lite3d_frustum.h>
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_manageable.h>
+
+namespace lite3dpp
+{
+    // CPU side of shadow maps update: which scene pieces are seen by which shadow camera and
+    // which shadow map layers have to be redrawn.
+    // Pieces are kept in sparse uniform grid by sphere center, shadow camera checks only cells
+    // inside AABB of its frustum. Visibility of piece is a bit mask by caster index, it is kept
+    // between passes and is recalculated only for moved pieces and for casters with changed matrix.
+    // Static pieces may be cached in separate shadow map layers (static pass), then main pass
+    // draws only dynamic pieces above the copy of cached layer.
+    class LITE3DPP_EXPORT ShadowVisibility : public Noncopiable
+    {
+    public:
+
+        static const constexpr uint32_t MaxCasters = 256;
+        static const constexpr float DefaultCellSize = 32.0f;
+
+        using CasterMask = std::bitset<MaxCasters>;
+
+        enum class Pass
+        {
+            None,
+            // Static pieces into cached layers
+            Static,
+            // Everything (without cache) or dynamic pieces only (with cache)
+            Main
+        };
+
+        struct Stats
+        {
+            // Piece against frustum tests during last pass
+            uint64_t frustumTests = 0;
+            // Pieces added or moved during last pass
+            uint32_t piecesUpdated = 0;
+        };
+
+        explicit ShadowVisibility(float cellSize = DefaultCellSize);
+
+        // Matrix of shadow camera, visibility column of the caster is recalculated if matrix is changed
+        void setCaster(uint32_t index, const kmMat4 &projView);
+        void setStaticCache(bool enabled);
+
+        // Light moved, both cached and final layers are invalid
+        void invalidateCaster(uint32_t index);
+        // Dynamic piece moved, final layers are invalid
+        void invalidateCasters(const CasterMask &mask);
+        void validateCaster(uint32_t index);
+        bool isInvalidated(uint32_t index) const;
+        bool isStaticInvalidated(uint32_t index) const;
+        // Casters invalidated by movement since last reset
+        inline const CasterMask &changedCasters() const
+        { return mChanged; }
+        inline void resetChanged()
+        { mChanged.reset(); }
+
+        // Start pass, returns casters which layers will be drawn, only active casters are taken.
+        // Pass is not started if there is nothing to draw
+        const CasterMask &beginPass(Pass pass, const CasterMask &active);
+        // Visibility of piece, new and moved pieces are updated here.
+        // Returns true if piece have to be drawn in current pass
+        bool approve(const lite3d_bounding_vol *vol, bool dynamic, CasterMask &visibleFrom);
+        // Drawn layers become valid, pieces not seen during the pass are forgotten
+        void endPass();
+
+        inline uint32_t castersCount() const
+        { return static_cast<uint32_t>(mCasters.size()); }
+        inline size_t piecesCount() const
+        { return mPieces.size(); }
+        inline bool staticCache() const
+        { return mStaticCache; }
+        inline const CasterMask &passCasters() const
+        { return mPassMask; }
+        inline const Stats &getStats() const
+        { return mStats; }
+
+        // AABB of frustum in world space by corners of clip cube
+        static void frustumBounds(const kmMat4 &projView, kmVec3 &vmin, kmVec3 &vmax);
+
+    private:
+
+        struct Caster
+        {
+            kmMat4 projView;
+            lite3d_frustum frustum;
+            kmVec3 vmin, vmax;
+            // Matrix was set at least once
+            bool valid = false;
+            // Column of visibility have to be recalculated before pass
+            bool changed = false;
+        };
+
+        struct Piece
+        {
+            const lite3d_bounding_vol *key;
+            lite3d_bounding_vol vol;
+            CasterMask mask;
+            uint64_t cell;
+            uint32_t slot;
+            uint64_t lastPass;
+            bool dynamic;
+        };
+
+        // Cell of huge and unbounded pieces, they are checked by every caster
+        static const constexpr uint64_t LargeCell = ~uint64_t(0);
+
+        uint64_t cellOf(const lite3d_bounding_vol &vol) const;
+        void cellInsert(uint32_t piece);
+        void cellErase(uint32_t piece);
+        bool testPiece(const Caster &caster, const Piece &piece);
+        CasterMask testAll(const Piece &piece);
+        void refreshCaster(uint32_t index);
+        void removePiece(uint32_t piece);
+        void invalidateByPiece(const CasterMask &mask, bool dynamic);
+
+        float mCellSize;
+        bool mStaticCache = false;
+        stl<Caster>::vector mCasters;
+        stl<Piece>::vector mPieces;
+        stl<const lite3d_bounding_vol *, uint32_t>::unordered_map mPieceByVol;
+        stl<uint64_t, stl<uint32_t>::vector>::unordered_map mCells;
+        CasterMask mInvalidated;
+        CasterMask mStaticInvalidated;
+        CasterMask mPassMask;
+        CasterMask mChanged;
+        Pass mPass = Pass::None;
+        uint64_t mPassCounter = 0;
+        Stats mStats;
+    };
+}
@@ -42,6 +42,8 @@ namespace lite3dpp
         { return mBones.size(); }
         inline Bones &getBones() 
         { return mBones; }
+        inline SkeletonPose &getPose()
+        { return mPose; }
         inline const BonesTransformData &getTransformData() const
         { return mBonesTransformData; }
         inline void setBufferIndex(int32_t index)
@@ -51,7 +53,8 @@ namespace lite3dpp
     private:
 
         void loadVertexGroups(const ConfigurationReader& conf);
-        void loadBone(SkeletonBone *parent, const ConfigurationReader& conf);
+        void loadBone(int32_t parent, const ConfigurationReader& conf);
+        void updatePalette();
 
     private:
 
@@ -59,6 +62,7 @@ namespace lite3dpp
         int32_t mBufferIndex = 0;
         BonesTransformData mBonesTransformData;
         VertexGroups mVertexGroups;
+        SkeletonPose mPose;
         Bones mBones;
     };
 }
@@ -19,52 +19,32 @@
 
 #include <lite3dpp/lite3dpp_common.h>
 #include <lite3dpp/lite3dpp_manageable.h>
+#include <lite3dpp/lite3dpp_skeleton_pose.h>
 
 namespace lite3dpp
 {
+    // Named handle of a bone in the skeleton pose
     class LITE3DPP_EXPORT SkeletonBone
     {
     public:
 
-        using ChildBones = stl<SkeletonBone *>::vector;
-
-        SkeletonBone(const String &name, 
-            SkeletonBone *parent,
-            kmMat4 *matrixBuffer, 
-            const kmVec3 &head,
-            kmScalar lenght,
-            const kmQuaternion &restPoseRotation);
+        SkeletonBone(const String &name, SkeletonPose &pose, int32_t index);
 
         inline const String &getName() const 
         { return mName; }
+        inline int32_t getIndex() const
+        { return mIndex; }
         void setPosition(const kmVec3 &position);
         const kmVec3& getPosition() const;
         void setRotation(const kmQuaternion &rotation);
         const kmQuaternion& getRotation() const;
         void setScale(const kmVec3 &scale);
         const kmVec3 &getScale() const;
-        inline bool isEmptyParent() const
-        { return !mParent; }
-
-        void addChildBone(SkeletonBone *bone);
-        void recalculateRecursive(bool force = false);
-        void resetToRestPose();
 
     private:
 
         String mName;
-        SkeletonBone *mParent;
-        kmMat4 *mTransformFromRest;
-        float mLength;
-        kmMat4 mTransform;
-        kmMat4 mRestPoseTransform;
-        kmMat4 mRestPoseTransformInverse;
-        kmVec3 mPosition;
-        kmVec3 mRestPosePosition;
-        kmQuaternion mRotation;
-        kmQuaternion mRestPoseRotation;
-        kmVec3 mScale = KM_VEC3_ONE;
-        ChildBones mChildBones;
-        bool mNeedRecalc = true;
+        SkeletonPose &mPose;
+        int32_t mIndex;
     };
 }
@@ -20,6 +20,7 @@
 #include <lite3dpp/lite3dpp_common.h>
 #include <lite3dpp/lite3dpp_scene_mesh_node.h>
 #include <lite3dpp/lite3dpp_ssbo.h>
+#include <lite3dpp/lite3dpp_buffer_dirty_ranges.h>
 
 namespace lite3dpp
 {
@@ -33,17 +34,26 @@ namespace lite3dpp
         void unregisterSceneNode(MeshSceneNode *node);
         void unregisterAll();
 
+        // Changed matrices are copied to CPU side buffer, upload happens in flush
         void updateData(size_t index, const Skeleton::BonesTransformData &data);
+        // Upload changed bones once per frame by merged ranges
+        void flush();
         SSBO &getBuffer();
 
+        inline const BufferDirtyRanges &getDirtyRanges() const
+        { return mDirty; }
+
     private:
 
         bool tryReuseRemoved(size_t sizeBytes);
+        void resizeShadow();
 
         Main &mMain;
         SSBO *mGlobalSkeletonBuffer = nullptr;
         stl<MeshSceneNode *>::unordered_set mNodes;
         size_t mUnusedBytes = 0;
         size_t mAllocatedBytes = 0;
+        Skeleton::BonesTransformData mShadow;
+        BufferDirtyRanges mDirty;
     };
 }
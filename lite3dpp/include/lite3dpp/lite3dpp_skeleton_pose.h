@@ -0,0 +1,122 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_manageable.h>
+
+namespace lite3dpp
+{
+    // Bones flattened in parent first order with local transforms in SoA arrays,
+    // the whole hierarchy is computed by one linear sweep without recursion
+    class LITE3DPP_EXPORT SkeletonPose
+    {
+    public:
+
+        using Matrices = stl<kmMat4>::vector;
+
+        // Parent must be added before its children, -1 for root bones.
+        // paletteIndex is the vertex group of the bone or -1 if it has no vertices
+        int32_t addBone(int32_t parent, const kmVec3 &head, kmScalar length,
+            const kmQuaternion &restPoseRotation, int32_t paletteIndex);
+
+        // Pose is relative to the bone rest pose
+        void setPosition(int32_t bone, const kmVec3 &position);
+        void setRotation(int32_t bone, const kmQuaternion &rotation);
+        void setScale(int32_t bone, const kmVec3 &scale);
+        inline const kmVec3 &getPosition(int32_t bone) const
+        { return mPositions[bone]; }
+        inline const kmQuaternion &getRotation(int32_t bone) const
+        { return mRotations[bone]; }
+        inline const kmVec3 &getScale(int32_t bone) const
+        { return mScales[bone]; }
+
+        void resetToRestPose();
+        void recalculate();
+
+        inline size_t getBonesCount() const
+        { return mParents.size(); }
+        // Bone skeleton space transforms
+        inline const Matrices &getTransforms() const
+        { return mTransforms; }
+        // Final bone matrices, transform from rest pose, by bone index
+        inline const Matrices &getSkinning() const
+        { return mSkinning; }
+        // Copy skinning matrices to palette ordered by vertex groups
+        void writePalette(kmMat4 *palette, size_t paletteSize) const;
+
+    private:
+
+        friend class SkeletonPoseBatch;
+
+        void recalculateTransforms();
+
+    private:
+
+        stl<int32_t>::vector mParents;
+        stl<int32_t>::vector mPaletteIndices;
+        stl<kmScalar>::vector mLengths;
+        stl<kmVec3>::vector mRestPosePositions;
+        stl<kmQuaternion>::vector mRestPoseRotations;
+        stl<kmVec3>::vector mPositions;
+        stl<kmQuaternion>::vector mRotations;
+        stl<kmVec3>::vector mScales;
+        stl<uint8_t>::vector mDirty;
+        Matrices mRestPoseTransforms;
+        Matrices mRestPoseTransformsInverse;
+        Matrices mTransforms;
+        Matrices mSkinning;
+    };
+
+    // Poses of one skeleton, e.g. all instances of a mesh, calculated together. Matrices are stored
+    // bone major, so every bone is combined with its parent for all poses by one array multiply and
+    // skinning of the whole combined palette is one more array multiply. Poses are not changed,
+    // dirty flags are ignored and every bone is recalculated.
+    class LITE3DPP_EXPORT SkeletonPoseBatch
+    {
+    public:
+
+        using Matrices = SkeletonPose::Matrices;
+
+        // All poses must have the same bones as the first one
+        void recalculate(const SkeletonPose *const *poses, size_t count);
+
+        inline size_t getPosesCount() const
+        { return mPosesCount; }
+        inline size_t getBonesCount() const
+        { return mParents.size(); }
+        // Final bone matrix of the pose, same as SkeletonPose::getSkinning after its recalculate
+        inline const kmMat4 &getSkinning(size_t pose, int32_t bone) const
+        { return mSkinning[bone * mPosesCount + pose]; }
+        // Palettes of all poses one after another, paletteSize matrices each, ordered by vertex groups
+        void writePalettes(kmMat4 *palettes, size_t paletteSize) const;
+
+    private:
+
+        void setSkeleton(const SkeletonPose &pose, size_t count);
+
+        size_t mPosesCount = 0;
+        stl<int32_t>::vector mParents;
+        stl<int32_t>::vector mPaletteIndices;
+        // Bone major: bone i of pose n is at [i * posesCount + n]
+        Matrices mRestPoseTransformsInverse;
+        Matrices mTransforms;
+        Matrices mSkinning;
+        Matrices mLocal;
+    };
+}
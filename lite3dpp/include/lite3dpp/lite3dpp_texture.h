@@ -83,6 +83,10 @@ namespace lite3dpp
 
         void setPixels(int8_t level, const PixelsData &pixels);
         void setPixels(int8_t level, const void *pixels);
+        /* Part of level, pixels are tightly packed rows of the rectangle. 
+           Rows of 1 and 2 byte formats must be multiple of 4 bytes (GL_UNPACK_ALIGNMENT) */
+        void setPixels(int8_t level, int32_t x, int32_t y, int32_t width, int32_t height, 
+            const void *pixels, int32_t layer = 0);
 
         void getCompressedPixels(int8_t level, PixelsData &pixels) const;
         void getCompressedPixels(int8_t level, void *pixels) const;
@@ -103,6 +107,9 @@ namespace lite3dpp
         { return mTexture.imageWidth; }
         inline int32_t getDepth() const
         { return mTexture.imageDepth; }
+        /* Bytes passed to setPixels since load */
+        inline uint64_t getUploadedBytes() const
+        { return mUploadedBytes; }
 
     protected:
 
@@ -114,6 +121,7 @@ namespace lite3dpp
 
         bool mModified;
         LayersData mLayersBackup;
+        uint64_t mUploadedBytes = 0;
     };
 }
 
@@ -47,7 +47,10 @@ namespace lite3dpp
     {
         mMinFrame = config.getDouble(L"MinFrame");
         mMaxFrame = config.getDouble(L"MaxFrame");
-        loadKeyFrames(config.getObject(L"Frames"), mKeyFrames);
+
+        stl<KeyFrame>::vector keyFrames;
+        loadKeyFrames(config.getObject(L"Frames"), keyFrames);
+        compileTrack(keyFrames, mTrack);
 
         config.getObject(L"SkeletonFrames").enumerateObjects([this](const WString &name, const ConfigurationReader &boneCfg)
         {
@@ -57,13 +60,20 @@ namespace lite3dpp
             if (boneKeyFrames.size() > 0)
             {
                 String boneName(name.begin(), name.end());
-                mSkeletonKeyFrames[boneName] = boneKeyFrames;
+                auto inserted = mBoneTrackIndices.emplace(boneName, static_cast<int32_t>(mBoneTracks.size()));
+                if (inserted.second)
+                    mBoneTracks.emplace_back();
+                compileTrack(boneKeyFrames, mBoneTracks[inserted.first->second]);
             }
         });
     }
 
     void Action::unloadImpl()
-    {}
+    {
+        mTrack = Track();
+        mBoneTracks.clear();
+        mBoneTrackIndices.clear();
+    }
 
     void Action::loadKeyFrames(const ConfigurationReader &config, stl<KeyFrame>::vector &keyFrames)
     {
@@ -100,45 +110,77 @@ namespace lite3dpp
         std::sort(keyFrames.begin(), keyFrames.end());
     }
 
-    Action::FramePair Action::getFramePairByTime(float time, const stl<KeyFrame>::vector &frames) const
+    void Action::compileTrack(const stl<KeyFrame>::vector &keyFrames, Track &track)
     {
-        // Кадров вообще нет, не должно быть такого
-        if (frames.size() == 0)
+        const size_t count = keyFrames.size();
+        track = Track();
+        track.times.resize(count);
+        track.translations.resize(count);
+        track.rotations.resize(count);
+        track.scales.resize(count);
+
+        // Каналы, которых нет в кадре, потом заполним значениями соседних кадров
+        stl<uint8_t>::vector keyChannels(count, 0);
+        for (size_t i = 0; i < count; ++i)
         {
-            return std::make_pair(nullptr, nullptr); 
-        }
-
-        // ищем ближайший следующий кадр
-        KeyFrame marker = {time}; 
-        auto frameIt = std::upper_bound(frames.begin(), frames.end(), marker);
+            track.times[i] = keyFrames[i].frameNo;
+            for (const auto &channel : keyFrames[i].channels)
+            {
+                switch (std::get<0>(channel))
+                {
+                case KeyFrame::Channel::Location:
+                    track.translations[i] = std::get<1>(channel).position;
+                    keyChannels[i] |= Track::HasLocation;
+                    break;
+                case KeyFrame::Channel::Rotation:
+                    track.rotations[i] = std::get<1>(channel).rotation;
+                    keyChannels[i] |= Track::HasRotation;
+                    break;
+                case KeyFrame::Channel::Scale:
+                    track.scales[i] = std::get<1>(channel).scale;
+                    keyChannels[i] |= Track::HasScale;
+                    break;
+                }
+            }
 
-        // Время вышло за пределы анимации
-        if (frameIt == frames.end())
-        {
-            return std::make_pair(&frames.back(), nullptr); 
-        }
-        // Анимация еще не наступила
-        else if (frameIt == frames.begin())
-        {
-            return std::make_pair(nullptr, &frames.front()); 
+            track.channels |= keyChannels[i];
         }
 
-        return std::make_pair(&(*std::prev(frameIt)), &(*frameIt));
-    }
+        auto fillGaps = [&keyChannels, count](uint8_t flag, auto &values)
+        {
+            // Forward pass takes the previous key value, backward pass fills the head
+            for (size_t i = 1; i < count; ++i)
+            {
+                if (!(keyChannels[i] & flag) && (keyChannels[i - 1] & flag))
+                {
+                    values[i] = values[i - 1];
+                    keyChannels[i] |= flag;
+                }
+            }
 
-    Action::FramePair Action::getFramePairByTime(float time) const
-    {
-        return getFramePairByTime(time, mKeyFrames);
+            for (size_t i = count - 1; i > 0; --i)
+            {
+                if (!(keyChannels[i - 1] & flag) && (keyChannels[i] & flag))
+                {
+                    values[i - 1] = values[i];
+                    keyChannels[i - 1] |= flag;
+                }
+            }
+        };
+
+        if (count == 0)
+            return;
+        if (track.channels & Track::HasLocation)
+            fillGaps(Track::HasLocation, track.translations);
+        if (track.channels & Track::HasRotation)
+            fillGaps(Track::HasRotation, track.rotations);
+        if (track.channels & Track::HasScale)
+            fillGaps(Track::HasScale, track.scales);
     }
 
-    Action::FramePair Action::getFramePairBoneByTime(float time, const String &boneName) const
+    int32_t Action::getBoneTrackIndex(const String &boneName) const
     {
-        const auto &boneKeyFrames = mSkeletonKeyFrames.find(boneName);
-        if (boneKeyFrames != mSkeletonKeyFrames.end())
-        {
-            return getFramePairByTime(time, boneKeyFrames->second);
-        }
-
-        return std::make_pair(nullptr, nullptr); 
+        auto it = mBoneTrackIndices.find(boneName);
+        return it != mBoneTrackIndices.end() ? it->second : -1;
     }
 }
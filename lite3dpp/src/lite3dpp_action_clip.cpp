@@ -36,122 +36,35 @@ namespace lite3dpp
         mInitialPosition = node.getPosition();
         mInitialRotation = node.getRotation();
         mInitialScale = node.getScale();
-    }
-
-    ActionClip::~ActionClip()
-    {
-        mMain.removeObserver(this);
-    }
-
-    template<class Node, class KeyFrame>
-    kmVec3 ActionClip::consolidatePosition(Node *node, const KeyFrame *keyFrame, bool &updated)
-    {
-        updated = false;
-        for (const auto &channel : keyFrame->channels)
-        {
-            switch (std::get<0>(channel))
-            {
-                case Action::KeyFrame::Channel::Location:
-                    updated = true;
-                    return std::get<1>(channel).position;
-                default:
-                    break;
-            }
-        }
 
-        return node->getPosition();
-    }
-
-    template<class Node, class KeyFrame>
-    kmQuaternion ActionClip::consolidateRotation(Node *node, const KeyFrame *keyFrame, bool &updated)
-    {
-        updated = false;
-        for (const auto &channel : keyFrame->channels)
+        if (mSkeleton)
         {
-            switch (std::get<0>(channel))
+            for (auto &bone : mSkeleton->getBones())
             {
-                case Action::KeyFrame::Channel::Rotation:
-                    updated = true;
-                    return std::get<1>(channel).rotation;
-                default:
-                    break;
+                int32_t track = mAction.getBoneTrackIndex(bone.first);
+                if (track >= 0)
+                    mBoneBindings.push_back({ &bone.second, static_cast<uint32_t>(track), 0 });
             }
         }
-
-        return node->getRotation();
     }
 
-    template<class Node, class KeyFrame>
-    kmVec3 ActionClip::consolidateScale(Node *node, const KeyFrame *keyFrame, bool &updated)
+    ActionClip::~ActionClip()
     {
-        updated = false;
-        for (const auto &channel : keyFrame->channels)
-        {
-            switch (std::get<0>(channel))
-            {
-                case Action::KeyFrame::Channel::Scale:
-                    updated = true;
-                    return std::get<1>(channel).scale;
-                default:
-                    break;
-            }
-        }
-
-        return node->getScale();
+        mMain.removeObserver(this);
     }
 
-    template<class Node, class FramePair>
-    void ActionClip::interpolate(Node *node, const FramePair &framePair)
+    void ActionClip::sample()
     {
-        // Еще не дошли до первого ключевого кадра
-        if (!framePair.first && framePair.second)
-        {
-            bool updated = false;
-            node->setPosition(consolidatePosition(node, framePair.second, updated));
-            node->setRotation(consolidateRotation(node, framePair.second, updated));
-            node->setScale(consolidateScale(node, framePair.second, updated));
-        }
-        // Последний ключевой кадр и дальше
-        else if (framePair.first && !framePair.second)
-        {
-            bool updated = false;
-            node->setPosition(consolidatePosition(node, framePair.first, updated));
-            node->setRotation(consolidateRotation(node, framePair.first, updated));
-            node->setScale(consolidateScale(node, framePair.first, updated));
-        }
-        // Между 2мя кадрами 
-        else if (framePair.first && framePair.second)
+        mAction.getTrack().apply(&mNode, mTime, mCursor);
+        if (mSkeleton)
         {
-            float k = (mTime - framePair.first->frameNo) / 
-                (framePair.second->frameNo - framePair.first->frameNo);
-
-            bool updatedLeft = false, updatedRight = false;
-            auto positionLeft = consolidatePosition(node, framePair.first, updatedLeft);
-            auto positionRight = consolidatePosition(node, framePair.second, updatedRight);
-            if (updatedLeft || updatedRight)
+            const auto &boneTracks = mAction.getBoneTracks();
+            for (auto &binding : mBoneBindings)
             {
-                kmVec3 interpolated;
-                kmVec3Lerp(&interpolated, &positionLeft, &positionRight, k);
-                node->setPosition(interpolated);
+                boneTracks[binding.track].apply(binding.bone, mTime, binding.cursor);
             }
 
-            auto rotationLeft = consolidateRotation(node, framePair.first, updatedLeft);
-            auto rotationRight = consolidateRotation(node, framePair.second, updatedRight);
-            if (updatedLeft || updatedRight)
-            {
-                kmQuaternion interpolated;
-                kmQuaternionSlerp(&interpolated, &rotationLeft, &rotationRight, k);
-                node->setRotation(interpolated);
-            }
-
-            auto scaleLeft = consolidateScale(node, framePair.first, updatedLeft);
-            auto scaleRight = consolidateScale(node, framePair.second, updatedRight);
-            if (updatedLeft || updatedRight)
-            {
-                kmVec3 interpolated;
-                kmVec3Lerp(&interpolated, &scaleLeft, &scaleRight, k);
-                node->setScale(interpolated);
-            }
+            mSkeleton->recalculate();
         }
     }
 
@@ -176,16 +89,7 @@ namespace lite3dpp
             // Сколько реальных кадров прошло с прошлого вызова таймера 
             mTime += static_cast<float>(static_cast<double>(timer->deltaMcs) / (timer->interval * 1000.0));
             
-            interpolate(&mNode, mAction.getFramePairByTime(mTime));
-            if (mSkeleton)
-            {
-                for (auto &bone : mSkeleton->getBones())
-                {
-                    interpolate(&bone.second, mAction.getFramePairBoneByTime(mTime, bone.first));
-                }
-
-                mSkeleton->recalculate();
-            }
+            sample();
         }
     }
 
@@ -0,0 +1,173 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_buffer_dirty_ranges.h>
+
+#include <algorithm>
+#include <bit>
+#include <SDL_assert.h>
+
+namespace lite3dpp
+{
+    BufferDirtyRanges::BufferDirtyRanges(size_t elementSize, size_t maxGap) :
+        mElementSize(elementSize),
+        mMaxGap(maxGap)
+    {
+        SDL_assert(elementSize > 0);
+    }
+
+    void BufferDirtyRanges::resize(size_t elements)
+    {
+        if (elements < mSize)
+        {
+            // Биты за новым концом сбрасываются, чтобы слова за границей оставались чистыми
+            for (size_t i = elements; i < std::min(mSize, (elements + 63) & ~size_t(63)); ++i)
+                mBits[i / 64] &= ~(uint64_t(1) << (i % 64));
+            mDirtyEnd = std::min(mDirtyEnd, elements);
+            mDirtyBegin = std::min(mDirtyBegin, mDirtyEnd);
+        }
+
+        mSize = elements;
+        mBits.resize((elements + 63) / 64, 0);
+    }
+
+    void BufferDirtyRanges::markDirty(size_t first, size_t count)
+    {
+        SDL_assert(first + count <= mSize);
+        if (count == 0)
+            return;
+
+        const size_t last = first + count;
+        for (size_t i = first; i < last;)
+        {
+            // целые слова без цикла по битам
+            if (i % 64 == 0 && last - i >= 64)
+            {
+                mBits[i / 64] = ~uint64_t(0);
+                i += 64;
+            }
+            else
+            {
+                mBits[i / 64] |= uint64_t(1) << (i % 64);
+                i++;
+            }
+        }
+
+        if (!hasDirty())
+        {
+            mDirtyBegin = first;
+            mDirtyEnd = last;
+        }
+        else
+        {
+            mDirtyBegin = std::min(mDirtyBegin, first);
+            mDirtyEnd = std::max(mDirtyEnd, last);
+        }
+    }
+
+    void BufferDirtyRanges::markAllDirty()
+    {
+        markDirty(0, mSize);
+    }
+
+    bool BufferDirtyRanges::isDirty(size_t element) const
+    {
+        SDL_assert(element < mSize);
+        return (mBits[element / 64] >> (element % 64)) & 1;
+    }
+
+    void BufferDirtyRanges::clear()
+    {
+        if (hasDirty())
+        {
+            std::fill(mBits.begin() + mDirtyBegin / 64, mBits.begin() + (mDirtyEnd + 63) / 64, 0);
+        }
+
+        mDirtyBegin = mDirtyEnd = 0;
+    }
+
+    size_t BufferDirtyRanges::findNext(size_t from, bool dirty) const
+    {
+        size_t word = from / 64;
+        const size_t endWord = (mDirtyEnd + 63) / 64;
+        if (word >= endWord)
+            return mDirtyEnd;
+
+        // Биты до from отбрасываются маской
+        uint64_t bits = (dirty ? mBits[word] : ~mBits[word]) & (~uint64_t(0) << (from % 64));
+        while (bits == 0)
+        {
+            if (++word >= endWord)
+                return mDirtyEnd;
+            bits = dirty ? mBits[word] : ~mBits[word];
+        }
+
+        return std::min(word * 64 + std::countr_zero(bits), mDirtyEnd);
+    }
+
+    const stl<BufferDirtyRanges::Range>::vector &BufferDirtyRanges::buildRanges()
+    {
+        mRanges.clear();
+
+        for (size_t i = mDirtyBegin; hasDirty() && i < mDirtyEnd;)
+        {
+            size_t first = findNext(i, true);
+            if (first >= mDirtyEnd)
+                break;
+
+            size_t end = findNext(first, false);
+            if (!mRanges.empty() && first - (mRanges.back().first + mRanges.back().count) <= mMaxGap)
+            {
+                mRanges.back().count = end - mRanges.back().first;
+            }
+            else
+            {
+                mRanges.push_back({ first, end - first });
+            }
+
+            i = end;
+        }
+
+        return mRanges;
+    }
+
+    size_t BufferDirtyRanges::flush(BufferBase &buffer, const void *shadow)
+    {
+        size_t bytes = 0;
+
+        if (hasDirty())
+        {
+            SDL_assert(shadow);
+            SDL_assert(bytesHeld() <= buffer.bufferSizeBytes());
+
+            for (const Range &range : buildRanges())
+            {
+                buffer.setData(static_cast<const uint8_t *>(shadow) + range.first * mElementSize,
+                    range.first * mElementSize, range.count * mElementSize);
+                bytes += range.count * mElementSize;
+                mStats.uploads++;
+            }
+
+            clear();
+        }
+
+        mStats.flushes++;
+        mStats.bytesUploaded += bytes;
+        mStats.lastBytesUploaded = bytes;
+        return bytes;
+    }
+}
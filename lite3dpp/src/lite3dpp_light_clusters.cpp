@@ -0,0 +1,412 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_light_clusters.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <SDL_assert.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define LITE3DPP_CLUSTERS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace lite3dpp
+{
+    LightClusterGrid::LightClusterGrid(uint32_t tilesX, uint32_t tilesY, uint32_t slices) :
+        mTilesX(std::max(tilesX, 1u)),
+        mTilesY(std::max(tilesY, 1u)),
+        mSlices(std::max(slices, 1u))
+    {
+        mData.assign(HeaderSize + clustersCount() * 2, 0);
+    }
+
+    LightClusterGrid::~LightClusterGrid()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mStop = true;
+        }
+
+        mWake.notify_all();
+        for (auto &worker : mWorkers)
+            worker.join();
+    }
+
+    void LightClusterGrid::setupPerspective(float znear, float zfar, float fovy, float aspect)
+    {
+        SDL_assert(znear > 0.0f && zfar > znear);
+
+        if (mProjection[0] == znear && mProjection[1] == zfar && mProjection[2] == fovy &&
+            mProjection[3] == aspect)
+            return;
+
+        mProjection[0] = znear;
+        mProjection[1] = zfar;
+        mProjection[2] = fovy;
+        mProjection[3] = aspect;
+
+        const float tanHalfY = std::tan(kmDegreesToRadians(fovy) * 0.5f);
+        const float tanHalfX = tanHalfY * aspect;
+        const float depthRatio = std::log(zfar / znear);
+        const uint32_t clusters = clustersCount();
+
+        // Дополнительные 4 элемента чтобы SIMD мог читать хвост последней строки
+        for (auto array : { &mMinX, &mMinY, &mMinZ, &mMaxX, &mMaxY, &mMaxZ,
+            &mCenterX, &mCenterY, &mCenterZ, &mRadius })
+            array->assign(clusters + 4, 0.0f);
+
+        mSliceMinZ.resize(mSlices);
+        mSliceMaxZ.resize(mSlices);
+        mTileMinX.resize(mSlices * mTilesX);
+        mTileMaxX.resize(mSlices * mTilesX);
+        mTileMinY.resize(mSlices * mTilesY);
+        mTileMaxY.resize(mSlices * mTilesY);
+
+        // Экспоненциальное разбиение по глубине, кластеры примерно кубические на любой дистанции
+        for (uint32_t z = 0; z < mSlices; ++z)
+        {
+            float d0 = z == 0 ? znear : znear * std::exp(depthRatio * z / mSlices);
+            float d1 = z + 1 == mSlices ? zfar : znear * std::exp(depthRatio * (z + 1) / mSlices);
+
+            mSliceMinZ[z] = -d1;
+            mSliceMaxZ[z] = -d0;
+
+            // Границы тайла на ближней и дальней плоскости слоя, ящик охватывает обе
+            for (uint32_t x = 0; x < mTilesX; ++x)
+            {
+                float n0 = -1.0f + 2.0f * x / mTilesX, n1 = -1.0f + 2.0f * (x + 1) / mTilesX;
+                mTileMinX[z * mTilesX + x] = std::min(n0 * d0, n0 * d1) * tanHalfX;
+                mTileMaxX[z * mTilesX + x] = std::max(n1 * d0, n1 * d1) * tanHalfX;
+            }
+
+            for (uint32_t y = 0; y < mTilesY; ++y)
+            {
+                float n0 = -1.0f + 2.0f * y / mTilesY, n1 = -1.0f + 2.0f * (y + 1) / mTilesY;
+                mTileMinY[z * mTilesY + y] = std::min(n0 * d0, n0 * d1) * tanHalfY;
+                mTileMaxY[z * mTilesY + y] = std::max(n1 * d0, n1 * d1) * tanHalfY;
+            }
+
+            for (uint32_t y = 0; y < mTilesY; ++y)
+            {
+                for (uint32_t x = 0; x < mTilesX; ++x)
+                {
+                    uint32_t c = clusterIndex(x, y, z);
+                    mMinX[c] = mTileMinX[z * mTilesX + x];
+                    mMaxX[c] = mTileMaxX[z * mTilesX + x];
+                    mMinY[c] = mTileMinY[z * mTilesY + y];
+                    mMaxY[c] = mTileMaxY[z * mTilesY + y];
+                    mMinZ[c] = mSliceMinZ[z];
+                    mMaxZ[c] = mSliceMaxZ[z];
+
+                    float hx = (mMaxX[c] - mMinX[c]) * 0.5f;
+                    float hy = (mMaxY[c] - mMinY[c]) * 0.5f;
+                    float hz = (mMaxZ[c] - mMinZ[c]) * 0.5f;
+                    mCenterX[c] = mMinX[c] + hx;
+                    mCenterY[c] = mMinY[c] + hy;
+                    mCenterZ[c] = mMinZ[c] + hz;
+                    mRadius[c] = std::sqrt(hx * hx + hy * hy + hz * hz);
+                }
+            }
+        }
+
+        float sliceParams[4] = {
+            mSlices / depthRatio,
+            -(mSlices * std::log(znear)) / depthRatio,
+            tanHalfX,
+            tanHalfY
+        };
+
+        mData[0] = static_cast<int32_t>(mTilesX);
+        mData[1] = static_cast<int32_t>(mTilesY);
+        mData[2] = static_cast<int32_t>(mSlices);
+        memcpy(&mData[4], sliceParams, sizeof(sliceParams));
+    }
+
+    ClusterBox LightClusterGrid::getClusterBox(uint32_t cluster) const
+    {
+        SDL_assert(cluster < clustersCount() && !mMinX.empty());
+
+        ClusterBox box;
+        box.min = { mMinX[cluster], mMinY[cluster], mMinZ[cluster] };
+        box.max = { mMaxX[cluster], mMaxY[cluster], mMaxZ[cluster] };
+        box.center = { mCenterX[cluster], mCenterY[cluster], mCenterZ[cluster] };
+        box.radius = mRadius[cluster];
+        return box;
+    }
+
+    bool LightClusterGrid::intersects(const ClusterLight &light, const ClusterBox &box)
+    {
+        if (light.radius <= 0.0f)
+            return true;
+
+        // Расстояние от центра сферы до ящика
+        float dx = std::max(std::max(box.min.x - light.position.x, 0.0f), light.position.x - box.max.x);
+        float dy = std::max(std::max(box.min.y - light.position.y, 0.0f), light.position.y - box.max.y);
+        float dz = std::max(std::max(box.min.z - light.position.z, 0.0f), light.position.z - box.max.z);
+        if ((dx * dx + dy * dy) + dz * dz > light.radius * light.radius)
+            return false;
+
+        if (light.coneSin <= 0.0f)
+            return true;
+
+        // Конус прожектора против описанной сферы кластера
+        float vx = box.center.x - light.position.x;
+        float vy = box.center.y - light.position.y;
+        float vz = box.center.z - light.position.z;
+        float lenSq = (vx * vx + vy * vy) + vz * vz;
+        float v1 = (vx * light.direction.x + vy * light.direction.y) + vz * light.direction.z;
+        float distClosest = light.coneCos * std::sqrt(std::max(lenSq - v1 * v1, 0.0f)) - v1 * light.coneSin;
+
+        return !(distClosest > box.radius || v1 > box.radius + light.radius || v1 < -box.radius);
+    }
+
+    void LightClusterGrid::testRow(const ClusterLight &light, uint32_t first, uint32_t count, Bin &bin) const
+    {
+#ifdef LITE3DPP_CLUSTERS_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 px = _mm_set1_ps(light.position.x), py = _mm_set1_ps(light.position.y),
+            pz = _mm_set1_ps(light.position.z), radius = _mm_set1_ps(light.radius),
+            radiusSq = _mm_set1_ps(light.radius * light.radius);
+        const __m128 dirX = _mm_set1_ps(light.direction.x), dirY = _mm_set1_ps(light.direction.y),
+            dirZ = _mm_set1_ps(light.direction.z), coneCos = _mm_set1_ps(light.coneCos),
+            coneSin = _mm_set1_ps(light.coneSin);
+        const bool spot = light.coneSin > 0.0f;
+
+        for (uint32_t i = 0; i < count; i += 4)
+        {
+            const uint32_t c = first + i;
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&mMinX[c]), px), zero),
+                _mm_sub_ps(px, _mm_loadu_ps(&mMaxX[c])));
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&mMinY[c]), py), zero),
+                _mm_sub_ps(py, _mm_loadu_ps(&mMaxY[c])));
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&mMinZ[c]), pz), zero),
+                _mm_sub_ps(pz, _mm_loadu_ps(&mMaxZ[c])));
+            __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, radiusSq));
+
+            if (mask && spot)
+            {
+                __m128 boxRadius = _mm_loadu_ps(&mRadius[c]);
+                __m128 vx = _mm_sub_ps(_mm_loadu_ps(&mCenterX[c]), px);
+                __m128 vy = _mm_sub_ps(_mm_loadu_ps(&mCenterY[c]), py);
+                __m128 vz = _mm_sub_ps(_mm_loadu_ps(&mCenterZ[c]), pz);
+                __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+                __m128 v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, dirX), _mm_mul_ps(vy, dirY)), _mm_mul_ps(vz, dirZ));
+                __m128 distClosest = _mm_sub_ps(_mm_mul_ps(coneCos,
+                    _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lenSq, _mm_mul_ps(v1, v1)), zero))), _mm_mul_ps(v1, coneSin));
+                __m128 culled = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(distClosest, boxRadius),
+                    _mm_cmpgt_ps(v1, _mm_add_ps(boxRadius, radius))),
+                    _mm_cmplt_ps(v1, _mm_sub_ps(zero, boxRadius)));
+                mask &= ~_mm_movemask_ps(culled);
+            }
+
+            if (count - i < 4)
+                mask &= (1 << (count - i)) - 1;
+
+            for (uint32_t lane = 0; mask; ++lane, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    bin.clusters.push_back(c + lane);
+                    bin.lights.push_back(light.index);
+                    bin.counts[c + lane]++;
+                }
+            }
+        }
+#else
+        for (uint32_t cluster = first; cluster < first + count; ++cluster)
+        {
+            if (intersects(light, getClusterBox(cluster)))
+            {
+                bin.clusters.push_back(cluster);
+                bin.lights.push_back(light.index);
+                bin.counts[cluster]++;
+            }
+        }
+#endif
+    }
+
+    bool LightClusterGrid::binLight(const ClusterLight &light, Bin &bin) const
+    {
+        if (light.radius <= 0.0f)
+        {
+            bin.global.push_back(light.index);
+            return true;
+        }
+
+        const size_t hits = bin.clusters.size();
+        const float r = light.radius;
+        // Диапазоны ящиков вдоль осей монотонны, кандидаты ищутся бинарным поиском,
+        // кластер вне диапазона не может пересекать сферу
+        for (uint32_t z = 0; z < mSlices; ++z)
+        {
+            if (mSliceMaxZ[z] < light.position.z - r)
+                break;
+            if (mSliceMinZ[z] > light.position.z + r)
+                continue;
+
+            const float *minX = &mTileMinX[z * mTilesX], *maxX = &mTileMaxX[z * mTilesX];
+            const float *minY = &mTileMinY[z * mTilesY], *maxY = &mTileMaxY[z * mTilesY];
+            uint32_t x0 = static_cast<uint32_t>(std::lower_bound(maxX, maxX + mTilesX, light.position.x - r) - maxX);
+            uint32_t x1 = static_cast<uint32_t>(std::upper_bound(minX, minX + mTilesX, light.position.x + r) - minX);
+            uint32_t y0 = static_cast<uint32_t>(std::lower_bound(maxY, maxY + mTilesY, light.position.y - r) - maxY);
+            uint32_t y1 = static_cast<uint32_t>(std::upper_bound(minY, minY + mTilesY, light.position.y + r) - minY);
+
+            if (x0 >= x1)
+                continue;
+
+            for (uint32_t y = y0; y < y1; ++y)
+                testRow(light, clusterIndex(x0, y, z), x1 - x0, bin);
+        }
+
+        return bin.clusters.size() > hits;
+    }
+
+    void LightClusterGrid::binLights(const ClusterLight *lights, size_t count, uint8_t *visible, Bin &bin) const
+    {
+        bin.clusters.clear();
+        bin.lights.clear();
+        bin.global.clear();
+        bin.counts.assign(clustersCount(), 0);
+
+        for (size_t i = 0; i < count; ++i)
+            visible[i] = binLight(lights[i], bin) ? 1 : 0;
+    }
+
+    void LightClusterGrid::build(const ClusterLight *lights, size_t count, uint32_t threads)
+    {
+        SDL_assert(!mMinX.empty());
+        SDL_assert(lights || count == 0);
+
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        if (count < ParallelMinLights)
+            threads = 1;
+
+        if (mBins.size() < threads)
+            mBins.resize(threads);
+        mVisible.resize(count);
+
+        // Каждый поток разбирает свой непрерывный отрезок источников, порядок
+        // индексов в кластере получается тем же, что и в одном потоке
+        if (threads == 1)
+        {
+            binLights(lights, count, mVisible.data(), mBins[0]);
+        }
+        else
+        {
+            runParallel(threads, [this, lights, count, threads](uint32_t t)
+            {
+                size_t begin = count * t / threads, end = count * (t + 1) / threads;
+                binLights(lights + begin, end - begin, mVisible.data() + begin, mBins[t]);
+            });
+        }
+
+        const uint32_t clusters = clustersCount();
+        size_t globalCount = 0, total = 0;
+        for (uint32_t t = 0; t < threads; ++t)
+            globalCount += mBins[t].global.size();
+
+        // Префиксная сумма, счетчики потоков превращаются в позиции записи
+        total = globalCount;
+        for (uint32_t c = 0; c < clusters; ++c)
+        {
+            size_t offset = total;
+            for (uint32_t t = 0; t < threads; ++t)
+            {
+                uint32_t hits = mBins[t].counts[c];
+                mBins[t].counts[c] = static_cast<uint32_t>(total);
+                total += hits;
+            }
+
+            mData[HeaderSize + c * 2] = static_cast<int32_t>(offset);
+            mData[HeaderSize + c * 2 + 1] = static_cast<int32_t>(total - offset);
+        }
+
+        mData[3] = static_cast<int32_t>(globalCount);
+        mData.resize(HeaderSize + clusters * 2 + total);
+
+        int32_t *indexes = mData.data() + HeaderSize + clusters * 2;
+        for (uint32_t t = 0; t < threads; ++t)
+        {
+            std::copy(mBins[t].global.begin(), mBins[t].global.end(), indexes);
+            indexes += mBins[t].global.size();
+        }
+
+        auto scatter = [this, clusters](uint32_t t)
+        {
+            int32_t *list = mData.data() + HeaderSize + clusters * 2;
+            Bin &bin = mBins[t];
+            for (size_t i = 0; i < bin.clusters.size(); ++i)
+                list[bin.counts[bin.clusters[i]]++] = bin.lights[i];
+        };
+
+        if (threads == 1)
+            scatter(0);
+        else
+            runParallel(threads, scatter);
+    }
+
+    void LightClusterGrid::runParallel(uint32_t threads, const std::function<void(uint32_t)> &job)
+    {
+        std::unique_lock<std::mutex> lock(mLock);
+        while (mWorkers.size() + 1 < threads)
+        {
+            mWorkers.emplace_back(&LightClusterGrid::workerLoop, this,
+                static_cast<uint32_t>(mWorkers.size()), mGeneration);
+        }
+
+        mJob = &job;
+        mJobThreads = threads;
+        mPending = threads - 1;
+        mGeneration++;
+        lock.unlock();
+        mWake.notify_all();
+
+        job(0);
+
+        lock.lock();
+        mDone.wait(lock, [this] { return mPending == 0; });
+        mJob = nullptr;
+    }
+
+    void LightClusterGrid::workerLoop(uint32_t workerIndex, uint64_t generation)
+    {
+        std::unique_lock<std::mutex> lock(mLock);
+        for (;;)
+        {
+            mWake.wait(lock, [this, generation] { return mStop || mGeneration != generation; });
+            if (mStop)
+                return;
+
+            generation = mGeneration;
+            if (workerIndex + 1 >= mJobThreads)
+                continue;
+
+            const std::function<void(uint32_t)> *job = mJob;
+            lock.unlock();
+            (*job)(workerIndex + 1);
+            lock.lock();
+
+            if (--mPending == 0)
+                mDone.notify_one();
+        }
+    }
+}
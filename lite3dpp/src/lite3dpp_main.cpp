@@ -69,6 +69,10 @@ namespace lite3dpp
         mSettings.logLevel = mConfig->getInt(L"LogLevel", LITE3D_LOGLEVEL_ERROR);
         mSettings.logMuteStd = mConfig->getBool(L"logMuteStd", false) ? LITE3D_TRUE : LITE3D_FALSE;
         mSettings.logFlushAlways = mConfig->getBool(L"LogFlushAlways", false) ? LITE3D_TRUE : LITE3D_FALSE;
+        mSettings.logAsync = mConfig->getBool(L"LogAsync", true) ? LITE3D_TRUE : LITE3D_FALSE;
+        mSettings.logQueueSize = mConfig->getInt(L"LogQueueSize", LITE3D_LOG_QUEUE_DEFAULT);
+        mSettings.logOverflowPolicy = mConfig->getString(L"LogOverflow", "block") == "drop" ? 
+            LITE3D_LOG_OVERFLOW_DROP : LITE3D_LOG_OVERFLOW_BLOCK;
         mConfig->getString(L"LogFile").copy(mSettings.logFile, sizeof(mSettings.logFile)-1);
 
         if (mConfig->getBool(L"Minidump", false))
@@ -292,6 +296,8 @@ namespace lite3dpp
         {
             Main *mainObj = reinterpret_cast<Main *> (userdata);
             LITE3D_EXT_OBSERVER_NOTIFY(mainObj, frameBegin);
+            // анимация скелетов обновлена в таймерах и frameBegin, заливаем изменения до отрисовки
+            mainObj->getSkeletonBuffer().flush();
         }
         catch (std::exception &ex)
         {
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_mesh_geometry.h>
+
+#include <SDL_assert.h>
+
+namespace lite3dpp
+{
+    static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    MeshGeometry::MeshGeometry(const String &name, const void *buffer, size_t size) : 
+        mName(name)
+    {
+        if (!buffer || !lite3d_mesh_m_decode_geometry(&mGeometry, buffer, size))
+        {
+            LITE3D_THROW(mName << ": failed to decode mesh geometry");
+        }
+    }
+
+    MeshGeometry::~MeshGeometry()
+    {
+        lite3d_mesh_m_geometry_purge(&mGeometry);
+    }
+
+    const MeshGeometry::Chunk &MeshGeometry::getChunk(uint32_t index) const
+    {
+        SDL_assert(index < mGeometry.chunksCount);
+        return mGeometry.chunks[index];
+    }
+
+    const float *MeshGeometry::chunkPositions(uint32_t index) const
+    {
+        return mGeometry.positions + static_cast<size_t>(getChunk(index).verticesOffset) * 3;
+    }
+
+    const uint32_t *MeshGeometry::chunkIndexes(uint32_t index) const
+    {
+        return mGeometry.indexes + getChunk(index).indexesOffset;
+    }
+
+    uint64_t MeshGeometry::contentHash() const
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (uint32_t i = 0; i < mGeometry.chunksCount; ++i)
+        {
+            hash = fnv1a(hash, &mGeometry.chunks[i].verticesCount, sizeof(uint32_t));
+            hash = fnv1a(hash, &mGeometry.chunks[i].indexesCount, sizeof(uint32_t));
+        }
+
+        hash = fnv1a(hash, mGeometry.positions, sizeof(float) * 3 * mGeometry.verticesCount);
+        return fnv1a(hash, mGeometry.indexes, sizeof(uint32_t) * mGeometry.indexesCount);
+    }
+}
@@ -159,6 +159,29 @@ namespace lite3dpp
         }
     }
 
+    void MeshPartition::remove(lite3d_mesh_chunk *chunk)
+    {
+        SDL_assert(chunk);
+        if (chunk->mesh != &mPartition)
+        {
+            LITE3D_THROW(getName() << ": chunk does not belong to the partition");
+        }
+
+        lite3d_mesh_chunk_remove(chunk);
+    }
+
+    void MeshPartition::compact()
+    {
+        if (!lite3d_mesh_compact(&mPartition))
+        {
+            LITE3D_THROW(getName() << ": failed to compact mesh partition");
+        }
+
+        SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Partition's %s compacted, vertices %zu/%zu bytes, indexes %zu/%zu bytes",
+            getName().c_str(), mPartition.vertexRanges.usedBytes, mPartition.vertexRanges.capacity,
+            mPartition.indexRanges.usedBytes, mPartition.indexRanges.capacity);
+    }
+
     void MeshPartition::warmUpMemory()
     {
         auto vb = vertexBuffer();
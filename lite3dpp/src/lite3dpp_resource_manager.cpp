@@ -73,8 +73,19 @@ namespace lite3dpp
         const void *buffer, size_t size,
         std::shared_ptr<AbstractResource> resource)
     {
-        /* load resource from memory chunk */
-        resource->load(buffer, size);
+        /* load resource from memory chunk, allocations are accounted to the resource type */
+        uint8_t prevTag = lite3d_memory_set_tag(static_cast<uint8_t>(resource->getType()));
+        try
+        {
+            resource->load(buffer, size);
+        }
+        catch (...)
+        {
+            lite3d_memory_set_tag(prevTag);
+            throw;
+        }
+
+        lite3d_memory_set_tag(prevTag);
         /* just insert resource */
         if (!mResources.emplace(name, resource).second)
         {
@@ -84,6 +95,8 @@ namespace lite3dpp
 
     void ResourceManager::releaseAllResources()
     {
+        releaseSceneTemplates();
+
         Resources::iterator it = mResources.begin();
         for(; it != mResources.end(); ++it)
         {
@@ -98,8 +111,27 @@ namespace lite3dpp
         Resources::iterator it;
         if((it = mResources.find(name)) != mResources.end())
         {
+            auto type = it->second->getType();
             it->second->unload();
             mResources.erase(it);
+
+            /* шаблоны обьектов сцен держат указатели на меши, материалы и действия */
+            if (type == AbstractResource::MESH || type == AbstractResource::MATERIAL || 
+                type == AbstractResource::ACTION)
+            {
+                releaseSceneTemplates();
+            }
+        }
+    }
+
+    void ResourceManager::releaseSceneTemplates()
+    {
+        for (auto &resource : mResources)
+        {
+            if (resource.second->getType() == AbstractResource::SCENE)
+            {
+                static_cast<Scene *>(resource.second.get())->releaseTemplates();
+            }
         }
     }
     
@@ -202,6 +234,19 @@ namespace lite3dpp
             }
         }
 
+        lite3d_memory_get_pool_stats(LITE3D_POOL_HEAP, &stats.heapMem);
+        for (uint8_t i = 0; i < LITE3D_POOL_MAX; ++i)
+        {
+            lite3d_memory_get_pool_stats(i, &stats.poolsMem[i]);
+        }
+
+        for (uint8_t i = AbstractResource::MESH; i <= AbstractResource::ACTION; ++i)
+        {
+            lite3d_memory_stats tagStats;
+            if (lite3d_memory_get_tag_stats(i, &tagStats))
+                stats.resourcesMem[i] = tagStats.usedBytes;
+        }
+
         return stats;
     }
 
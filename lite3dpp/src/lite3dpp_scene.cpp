@@ -16,6 +16,7 @@
  *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
  *******************************************************************************/
 #include <algorithm>
+#include <cstring>
 
 #include <SDL_log.h>
 #include <SDL_assert.h>
@@ -29,7 +30,8 @@ namespace lite3dpp
         const String &path, Main &main) : 
         ConfigurableResource(name, path, main, AbstractResource::SCENE),
         mLightingParamsBuffer(nullptr),
-        mLightingIndexBuffer(nullptr)
+        mLightingIndexBuffer(nullptr),
+        mLightParamsDirty(sizeof(lite3d_light_params))
     {
         addObserver(this);
     }
@@ -84,6 +86,10 @@ namespace lite3dpp
 
         setupCallbacks();
 
+        // Допустимая ошибка уровня детализации в долях высоты экрана, по умолчанию около пикселя при 1080p
+        mScene.lodMaxError = helper.getDouble(L"LodMaxError", mScene.lodMaxError);
+        mScene.lodHysteresis = helper.getDouble(L"LodHysteresis", mScene.lodHysteresis);
+
         String lightingTechnique = helper.getString(L"LightingTechnique", "none");
         if (lightingTechnique != "none")
         {
@@ -122,6 +128,28 @@ namespace lite3dpp
                 LITE3D_THROW("Unknown lighting technique '" << lightingTechnique << "' method, scene '" << getName() << "'");
             }
 
+            // Кластерное освещение, источники распределяются по ячейкам пирамиды видимости камеры
+            if (helper.has(L"LightClusters"))
+            {
+                if (lightingTechnique != "SSBO")
+                {
+                    LITE3D_THROW("Light clusters require SSBO lighting technique, scene '" << getName() << "'");
+                }
+
+                ConfigurationReader clustersConfig = helper.getObject(L"LightClusters");
+                mLightClusters = std::make_unique<LightClusterGrid>(
+                    static_cast<uint32_t>(clustersConfig.getInt(L"TilesX", 16)),
+                    static_cast<uint32_t>(clustersConfig.getInt(L"TilesY", 9)),
+                    static_cast<uint32_t>(clustersConfig.getInt(L"Slices", 24)));
+                mLightClustersThreads = static_cast<uint32_t>(clustersConfig.getInt(L"Threads", 0));
+                mLightClustersCamera = clustersConfig.getString(L"Camera");
+                mLightingClusterBuffer = getMain().getResourceManager().
+                    queryResourceFromJson<SSBO>(getName() + "_lightingClusterBuffer",
+                    "{\"Dynamic\": true}");
+
+                mMaxLightsCount = std::min(MaxClusteredLightCount, static_cast<uint32_t>(SSBOMaxSize / sizeof(lite3d_light_params)));
+            }
+
             mLightingParamsBuffer->extendBufferBytes(sizeof(lite3d_light_params) * InitialLightCount);
             mLightingIndexBuffer->extendBufferBytes(sizeof(LightsIndexesStore::value_type) * (InitialLightCount + 1));
             LightsIndexesStore::value_type initialZero = 0;
@@ -150,6 +178,16 @@ namespace lite3dpp
             mLightingIndexBuffer = nullptr;
         }
 
+        if (mLightingClusterBuffer)
+        {
+            getMain().getResourceManager().releaseResource(mLightingClusterBuffer->getName());
+            mLightingClusterBuffer = nullptr;
+        }
+
+        mLightClusters.reset();
+        mLightParams.clear();
+        mLightParamsDirty.resize(0);
+
         if (mInvocationBuffer)
         {
             getMain().getResourceManager().releaseResource(mInvocationBuffer->getName());
@@ -164,6 +202,7 @@ namespace lite3dpp
 
         detachAllCameras();
         removeAllObjects();
+        releaseTemplates();
         lite3d_scene_purge(&mScene);
     }
 
@@ -174,8 +213,9 @@ namespace lite3dpp
         if(mObjects.find(name) != mObjects.end())
             LITE3D_THROW(name << " make object failed.. already exist");
 
+        const SceneObjectTemplate &objectTemplate = getTemplate(templatePath);
         SceneObject::Ptr sceneObject = createObject(name, parent, initialPosition, initialRotation, initialScale);
-        sceneObject->loadFromTemplateFromFile(templatePath);
+        sceneObject->loadFromTemplate(objectTemplate);
         mObjects.emplace(name, sceneObject);
         return sceneObject.get();
     }
@@ -193,6 +233,22 @@ namespace lite3dpp
         return sceneObject.get();
     }
 
+    const SceneObjectTemplate &Scene::getTemplate(const String &templatePath)
+    {
+        auto it = mTemplates.find(templatePath);
+        if (it == mTemplates.end())
+        {
+            it = mTemplates.emplace(templatePath, std::make_unique<SceneObjectTemplate>(getMain(), templatePath)).first;
+        }
+
+        return *it->second;
+    }
+
+    void Scene::releaseTemplates()
+    {
+        mTemplates.clear();
+    }
+
     SceneObject *Scene::getObject(const String &name) const
     {
         SceneObjects::const_iterator it;
@@ -230,10 +286,17 @@ namespace lite3dpp
                 mLightingParamsBuffer->bufferSizeBytes());
         }
 
+        size_t oldCount = mLightParams.size();
+        mLightParams.resize(mLightingParamsBuffer->bufferSizeBytes() / sizeof(lite3d_light_params));
+        mLightParamsDirty.resize(mLightParams.size());
+        // содержимое новой части буфера не определено
+        if (mLightParams.size() > oldCount)
+            mLightParamsDirty.markDirty(oldCount, mLightParams.size() - oldCount);
+
         for (auto &light : mLights)
         {
             light->getLight()->index(i++);
-            light->getLight()->writeToBuffer(*mLightingParamsBuffer);
+            writeLightParams(*light->getLight());
         }
     }
     
@@ -249,44 +312,137 @@ namespace lite3dpp
                 mLightingIndexBuffer->bufferSizeBytes());
         }
 
-        mLightsIndexes.clear();
-        mLightsIndexes.emplace_back(0); // reserve first index for size
+        // списки живут один кадр, память берется из арены кадра
+        LightsIndexesStore lightsIndexes;
+        lightsIndexes.reserve(mLights.size()+1);
+        lightsIndexes.emplace_back(0); // reserve first index for size
         
         bool anyValidated = false;
-        for (auto &light : mLights)
+        if (mLightClusters && camera.getPtr()->isOrtho == LITE3D_FALSE &&
+            (mLightClustersCamera.empty() || mLightClustersCamera == camera.getName()))
         {
-            if (!light->getLight()->enabled())
-                continue;
-            
-            if (light->needRecalcToWorld())
+            anyValidated = validateLightClusters(camera, lightsIndexes);
+        }
+        else
+        {
+            for (auto &light : mLights)
             {
-                light->translateToWorld();
-                light->getLight()->writeToBuffer(*mLightingParamsBuffer);
-                anyValidated = true;
-            }
+                if (!light->getLight()->enabled())
+                    continue;
 
-            if (light->getLight()->getType() == LightSourceFlags::TypeDirectional || 
-                !light->frustumTest() || 
-                camera.inFrustum(*light->getLight()))
-            {
-                light->setVisible(true);
-                mLightsIndexes.emplace_back(light->getLight()->index());
-            }
-            else
-            {
-                light->setVisible(false);
+                if (light->needRecalcToWorld())
+                {
+                    light->translateToWorld();
+                    writeLightParams(*light->getLight());
+                    anyValidated = true;
+                }
+
+                if (light->getLight()->getType() == LightSourceFlags::TypeDirectional || 
+                    !light->frustumTest() || 
+                    camera.inFrustum(*light->getLight()))
+                {
+                    light->setVisible(true);
+                    lightsIndexes.emplace_back(light->getLight()->index());
+                }
+                else
+                {
+                    light->setVisible(false);
+                }
             }
         }
         
+        // parameters of changed lights, one upload per range
+        mLightParamsDirty.flush(*mLightingParamsBuffer, mLightParams.data());
+
         // the first index contain indexes count, max 16k
-        mLightsIndexes[0] = static_cast<int32_t>(mLightsIndexes.size()-1);
+        lightsIndexes[0] = static_cast<int32_t>(lightsIndexes.size()-1);
         // upload indexes
-        mLightingIndexBuffer->setData(&mLightsIndexes[0], 0, mLightsIndexes.size() * sizeof(LightsIndexesStore::value_type));
+        mLightingIndexBuffer->setData(&lightsIndexes[0], 0, lightsIndexes.size() * sizeof(LightsIndexesStore::value_type));
 
         if (anyValidated)
             Material::setIntGlobalParameter(getName() + "_numLights", static_cast<int32_t>(mLights.size()));
     }
     
+    bool Scene::validateLightClusters(const Camera &camera, LightsIndexesStore &lightsIndexes)
+    {
+        const auto &projection = camera.getPtr()->projectionParams;
+        const kmMat4 &view = camera.getViewMatrix();
+        bool anyValidated = false;
+
+        mLightClusters->setupPerspective(projection.znear, projection.zfar, projection.fovy, projection.aspect);
+        stl<ClusterLight>::frame_vector clusterLights;
+        stl<LightSceneNode *>::frame_vector clusterNodes;
+        clusterLights.reserve(mLights.size());
+        clusterNodes.reserve(mLights.size());
+
+        for (auto &node : mLights)
+        {
+            LightSource *light = node->getLight();
+            if (!light->enabled())
+                continue;
+
+            if (node->needRecalcToWorld())
+            {
+                node->translateToWorld();
+                writeLightParams(*light);
+                anyValidated = true;
+            }
+
+            // Направленный свет и источники без проверки видимости попадают во все кластеры
+            ClusterLight clusterLight = {};
+            clusterLight.index = light->index();
+            if (light->getType() != LightSourceFlags::TypeDirectional && node->frustumTest())
+            {
+                kmVec3Transform(&clusterLight.position, &light->getWorldPosition(), &view);
+                clusterLight.radius = std::max(light->getInfluenceDistance(), std::numeric_limits<float>::min());
+
+                if (light->getType() == LightSourceFlags::TypeSpot && light->getAngleOuterCone() < kmPI)
+                {
+                    kmVec3TransformNormal(&clusterLight.direction, &light->getWorldDirection(), &view);
+                    kmVec3Normalize(&clusterLight.direction, &clusterLight.direction);
+                    clusterLight.coneCos = std::cos(light->getAngleOuterCone() / 2);
+                    clusterLight.coneSin = std::sin(light->getAngleOuterCone() / 2);
+                }
+            }
+
+            clusterLights.emplace_back(clusterLight);
+            clusterNodes.emplace_back(node);
+        }
+
+        mLightClusters->build(clusterLights.data(), clusterLights.size(), mLightClustersThreads);
+
+        for (size_t i = 0; i < clusterNodes.size(); ++i)
+        {
+            bool visible = mLightClusters->isLightVisible(i);
+            clusterNodes[i]->setVisible(visible);
+            if (visible)
+                lightsIndexes.emplace_back(clusterLights[i].index);
+        }
+
+        // upload whole grid by one call
+        const auto &data = mLightClusters->getData();
+        size_t dataSize = data.size() * sizeof(int32_t);
+        if (mLightingClusterBuffer->bufferSizeBytes() < dataSize)
+        {
+            mLightingClusterBuffer->extendBufferBytes(dataSize - mLightingClusterBuffer->bufferSizeBytes());
+        }
+
+        mLightingClusterBuffer->setData(data.data(), 0, dataSize);
+        // Шейдер ищет кластер фрагмента по той же матрице вида, по которой строилась сетка
+        Material::setFloatm4GlobalParameter("CameraView", view);
+        return anyValidated;
+    }
+
+    void Scene::writeLightParams(const LightSource &light)
+    {
+        SDL_assert(static_cast<size_t>(light.index()) < mLightParams.size());
+        if (memcmp(&mLightParams[light.index()], &light.getWorldParams(), sizeof(lite3d_light_params)) == 0)
+            return;
+
+        mLightParams[light.index()] = light.getWorldParams();
+        mLightParamsDirty.markDirty(light.index());
+    }
+
     SceneObject::Ptr Scene::createObject(const String &name, SceneObjectBase *parent, const kmVec3 &initialPosition, 
         const kmQuaternion &initialRotation, const kmVec3 &initialScale)
     {
@@ -412,6 +568,10 @@ namespace lite3dpp
                 }
                 if (renderTargetJson.getBool(L"FrustumCulling", true))
                     renderFlags |= LITE3D_RENDER_FRUSTUM_CULLING;
+                if (renderTargetJson.getBool(L"ClusterCulling", false))
+                    renderFlags |= LITE3D_RENDER_CLUSTER_CULLING;
+                if (renderTargetJson.getBool(L"LevelOfDetail", false))
+                    renderFlags |= LITE3D_RENDER_LOD;
                 if (renderTargetJson.getBool(L"CustomVisibilityCheck", false))
                     renderFlags |= LITE3D_RENDER_CUSTOM_VISIBILITY_CHECK;
                 if (renderTargetJson.getBool(L"SortOpaqueToNear", false))
@@ -23,10 +23,14 @@
 namespace lite3dpp
 {
     LightSceneNode::LightSceneNode(const ConfigurationReader &json, SceneNodeBase *parent, Scene *scene) : 
-        SceneNode(json, parent, scene)
+        LightSceneNode(SceneNodePrototype(scene->getMain(), json), parent, scene)
+    {}
+
+    LightSceneNode::LightSceneNode(const SceneNodePrototype &prototype, SceneNodeBase *parent, Scene *scene) : 
+        SceneNode(prototype, parent, scene)
     {
         /* setup object lighting */
-        auto lightHelper = json.getObject(L"Light");
+        auto lightHelper = prototype.json.getObject(L"Light");
         if (!lightHelper.isEmpty())
         {
             mLight = std::make_unique<LightSource>(lightHelper);
@@ -24,43 +24,35 @@
 namespace lite3dpp
 {
     MeshSceneNode::MeshSceneNode(const ConfigurationReader &json, SceneNodeBase *parent, Scene *scene) : 
-        SceneNode(json, parent, scene)
+        MeshSceneNode(SceneNodePrototype(scene->getMain(), json), parent, scene)
+    {}
+
+    MeshSceneNode::MeshSceneNode(const SceneNodePrototype &prototype, SceneNodeBase *parent, Scene *scene) : 
+        SceneNode(prototype, parent, scene)
     {
-        instances(json.getInt(L"Instances", 1));
+        instances(prototype.instances);
+        setLodBias(prototype.json.getDouble(L"LodBias", 1.0f));
         SDL_assert(getMain());
 
-        auto meshHelper = json.getObject(L"Mesh");
-        if (!meshHelper.isEmpty())
+        if (prototype.mesh)
         {
-            setMesh(getMain()->getResourceManager().queryResource<Mesh>(
-                meshHelper.getString(L"Name"),
-                meshHelper.getString(L"Mesh")));
-
-            stl<uint32_t, Material *>::unordered_map materials;
-            for (auto &matMap : meshHelper.getObjects(L"MaterialMapping"))
-            {
-                materials[matMap.getInt(L"MaterialIndex")] = 
-                    getMain()->getMaterialFactory().createMaterial(
-                        matMap.getObject(L"Material").getString(L"Type"),
-                        matMap.getObject(L"Material").getString(L"Name"),
-                        matMap.getObject(L"Material").getString(L"Material"));
-            }
+            setMesh(prototype.mesh);
 
             for (size_t i = 0; i < mMesh->chunksCount(); ++i)
             {
                 auto chunk = mMesh->getChunk(i);
-                auto materialReplacedIt = materials.find(chunk.chunk->materialIndex);
-                Material *material = materialReplacedIt != materials.end() ? materialReplacedIt->second : chunk.material;
+                auto materialReplacedIt = prototype.materials.find(chunk.chunk->materialIndex);
+                Material *material = materialReplacedIt != prototype.materials.end() ? materialReplacedIt->second : chunk.material;
                 if (material)
                 {
                     applyMaterial(chunk, material);
                 }
             }
 
-            if (json.has(L"Skeleton") && json.has(L"VertexGroups"))
+            if (prototype.json.has(L"Skeleton") && prototype.json.has(L"VertexGroups"))
             {
                 mSkeleton = std::make_unique<Skeleton>(*this);
-                mSkeleton->loadFromJson(json);
+                mSkeleton->loadFromJson(prototype.json);
             }
         }
     }
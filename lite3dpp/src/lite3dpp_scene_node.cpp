@@ -24,7 +24,17 @@
 
 namespace lite3dpp
 {
+    static Main &sceneMain(Scene *scene)
+    {
+        SDL_assert(scene);
+        return scene->getMain();
+    }
+
     SceneNode::SceneNode(const ConfigurationReader &json, SceneNodeBase *parent, Scene *scene) : 
+        SceneNode(SceneNodePrototype(sceneMain(scene), json), parent, scene)
+    {}
+
+    SceneNode::SceneNode(const SceneNodePrototype &prototype, SceneNodeBase *parent, Scene *scene) : 
         SceneNodeBase(&mNode)
     {
         SDL_assert(scene);
@@ -32,23 +42,14 @@ namespace lite3dpp
         lite3d_scene_node_init(&mNode);
         mNode.userdata = static_cast<SceneNodeBase *>(this);
 
-        setName(json.getString(L"Name"));
-        if (getName().size() == 0)
-            LITE3D_THROW("SceneNode with empty name is not allowed..");
-
-        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION,
-            "Parsing node '%s' ...", getName().c_str());
-        
-        frustumTest(json.getBool(L"FrustumTest", true));
-        setPosition(json.getVec3(L"Position"));
-        setRotation(json.getQuaternion(L"Rotation"));
-        setScale(json.getVec3(L"Scale", KM_VEC3_ONE));
+        setName(prototype.name);
+        frustumTest(prototype.frustumTest);
+        setPosition(prototype.position);
+        setRotation(prototype.rotation);
+        setScale(prototype.scale);
 
-        for (auto &actionCfg : json.getObjects(L"Actions"))
+        for (Action *action : prototype.actions)
         {
-            auto action = scene->getMain().getResourceManager().queryResource<Action>(actionCfg.getString(L"Name"), 
-                actionCfg.getString(L"Action"));
-
             mActions[action->getName()] = action;
         }
 
@@ -17,6 +17,7 @@
  *******************************************************************************/
 #include <lite3dpp/lite3dpp_scene_node_base.h>
 
+#include <algorithm>
 #include <SDL_assert.h>
 #include <SDL_log.h>
 
@@ -186,6 +187,52 @@ namespace lite3dpp
         LITE3D_OBSERVER_NOTIFY_1(updateRotation, this);
     }
 
+    void SceneNodeBase::setTransform(const kmVec3 &position, const kmQuaternion &quat)
+    {
+        SDL_assert(mNodePtr);
+        lite3d_scene_node_set_transform(mNodePtr, &position, &quat);
+        LITE3D_OBSERVER_NOTIFY_1(updateTransform, this);
+    }
+
+    void SceneNodeTransformBatch::apply()
+    {
+        for (const auto &record : mRecords)
+        {
+            SDL_assert(record.node && record.node->getPtr());
+            lite3d_scene_node_set_transform(record.node->getPtr(), &record.position, &record.rotation);
+        }
+
+        for (size_t i = 0; i < mRecords.size(); ++i)
+        {
+            for (auto observer : mRecords[i].node->getObservers())
+                mNotifies.push_back({ observer, i });
+        }
+
+        std::sort(mNotifies.begin(), mNotifies.end(), [](const Notify &a, const Notify &b)
+        {
+            return a.observer != b.observer ? std::less<SceneNodeObserver *>()(a.observer, b.observer) : 
+                a.record < b.record;
+        });
+
+        for (size_t begin = 0, end = 0; begin < mNotifies.size(); begin = end)
+        {
+            mObserverNodes.clear();
+            for (end = begin; end < mNotifies.size() && mNotifies[end].observer == mNotifies[begin].observer; ++end)
+                mObserverNodes.push_back(mRecords[mNotifies[end].record].node);
+
+            mNotifies[begin].observer->updateTransforms(mObserverNodes.data(), mObserverNodes.size());
+        }
+
+        clear();
+    }
+
+    void SceneNodeTransformBatch::clear()
+    {
+        mRecords.clear();
+        mNotifies.clear();
+        mObserverNodes.clear();
+    }
+
     SceneNodeBase *SceneNodeBase::getParent()
     {
         SDL_assert(mNodePtr);
@@ -50,6 +50,32 @@ namespace lite3dpp
         scale(mInitialScale);
     }
 
+    void SceneObject::loadFromTemplate(const SceneObjectTemplate &objectTemplate)
+    {
+        const auto &prototypes = objectTemplate.getNodes();
+        if (prototypes.empty())
+            return;
+
+        SDL_assert(getScene());
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Loading object '%s' to scene '%s' ...", 
+            getName().c_str(), getScene()->getName().c_str());
+
+        /* Родитель всегда создан раньше, индексы шаблона совпадают с индексами nodes */
+        stl<SceneNodeBase *>::vector nodes(prototypes.size(), nullptr);
+        for (size_t i = 0; i < prototypes.size(); ++i)
+        {
+            const SceneNodePrototype &prototype = prototypes[i];
+            SceneNodeBase *parent = prototype.parent < 0 ? 
+                (getParent() ? getParent()->getRoot() : nullptr) : nodes[prototype.parent];
+            nodes[i] = createNode(prototype, parent);
+        }
+
+        setRoot(nodes.front());
+        setPosition(mInitialPosition);
+        setRotation(mInitialRotation);
+        scale(mInitialScale);
+    }
+
     void SceneObject::setupNodes(const stl<ConfigurationReader>::vector &nodesRange, SceneNodeBase *parent)
     {
         for (const ConfigurationReader &nodeHelper : nodesRange)
@@ -100,9 +126,37 @@ namespace lite3dpp
         return addNode(conf, parent);
     }
 
+    SceneNode* SceneObject::createNode(const SceneNodePrototype &prototype, SceneNodeBase *parent)
+    {
+        switch (prototype.type)
+        {
+        case SceneNodePrototype::TypeMesh:
+            return addMeshNode(prototype, parent);
+        case SceneNodePrototype::TypeLight:
+            return addLightNode(prototype, parent);
+        default:
+            return addNode(prototype, parent);
+        }
+    }
+
     SceneNode* SceneObject::addNode(const ConfigurationReader &conf, SceneNodeBase *parent)
     {
-        auto node = std::make_shared<SceneNode>(conf, parent, getScene());
+        return addNode(SceneNodePrototype(getMain(), conf), parent);
+    }
+
+    MeshSceneNode* SceneObject::addMeshNode(const ConfigurationReader &conf, SceneNodeBase *parent)
+    {
+        return addMeshNode(SceneNodePrototype(getMain(), conf), parent);
+    }
+
+    LightSceneNode* SceneObject::addLightNode(const ConfigurationReader &conf, SceneNodeBase *parent)
+    {
+        return addLightNode(SceneNodePrototype(getMain(), conf), parent);
+    }
+
+    SceneNode* SceneObject::addNode(const SceneNodePrototype &prototype, SceneNodeBase *parent)
+    {
+        auto node = std::make_shared<SceneNode>(prototype, parent, getScene());
         if (mNodes.count(node->getName()))
             LITE3D_THROW("SceneNode '" << node->getName() << "' already exists..");
 
@@ -110,9 +164,9 @@ namespace lite3dpp
         return node.get();
     }
 
-    MeshSceneNode* SceneObject::addMeshNode(const ConfigurationReader &conf, SceneNodeBase *parent)
+    MeshSceneNode* SceneObject::addMeshNode(const SceneNodePrototype &prototype, SceneNodeBase *parent)
     {
-        auto meshNode = std::make_shared<MeshSceneNode>(conf, parent, getScene());
+        auto meshNode = std::make_shared<MeshSceneNode>(prototype, parent, getScene());
         if (mNodes.count(meshNode->getName()))
             LITE3D_THROW("MeshNode '" << meshNode->getName() << "' already exists..");
 
@@ -121,9 +175,9 @@ namespace lite3dpp
         return meshNode.get();
     }
 
-    LightSceneNode* SceneObject::addLightNode(const ConfigurationReader &conf, SceneNodeBase *parent)
+    LightSceneNode* SceneObject::addLightNode(const SceneNodePrototype &prototype, SceneNodeBase *parent)
     {
-        auto lightNode = std::make_shared<LightSceneNode>(conf, parent, getScene());
+        auto lightNode = std::make_shared<LightSceneNode>(prototype, parent, getScene());
         if (mNodes.count(lightNode->getName()))
             LITE3D_THROW("LightSource '" << lightNode->getName() << " already exists..");
 
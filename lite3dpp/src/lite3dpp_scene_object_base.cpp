@@ -151,6 +151,12 @@ namespace lite3dpp
         getRoot()->setRotation(quat);
     }
 
+    void SceneObjectBase::setTransform(const kmVec3 &position, const kmQuaternion &quat)
+    {
+        SDL_assert(getRoot());
+        getRoot()->setTransform(position, quat);
+    }
+
     void SceneObjectBase::rotate(const kmQuaternion &quat)
     {
         SDL_assert(getRoot());
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_scene_object_template.h>
+
+#include <SDL_log.h>
+#include <SDL_assert.h>
+
+#include <lite3dpp/lite3dpp_main.h>
+
+namespace lite3dpp
+{
+    SceneNodePrototype::SceneNodePrototype(Main &main, const ConfigurationReader &nodeJson) : 
+        json(nodeJson)
+    {
+        name = json.getString(L"Name");
+        if (name.size() == 0)
+            LITE3D_THROW("SceneNode with empty name is not allowed..");
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION,
+            "Parsing node '%s' ...", name.c_str());
+
+        type = json.has(L"Mesh") ? TypeMesh : (json.has(L"Light") ? TypeLight : TypeNode);
+        frustumTest = json.getBool(L"FrustumTest", true);
+        position = json.getVec3(L"Position");
+        rotation = json.getQuaternion(L"Rotation");
+        scale = json.getVec3(L"Scale", KM_VEC3_ONE);
+
+        for (auto &actionCfg : json.getObjects(L"Actions"))
+        {
+            actions.push_back(main.getResourceManager().queryResource<Action>(actionCfg.getString(L"Name"), 
+                actionCfg.getString(L"Action")));
+        }
+
+        instances = json.getInt(L"Instances", 1);
+        auto meshHelper = json.getObject(L"Mesh");
+        if (!meshHelper.isEmpty())
+        {
+            mesh = main.getResourceManager().queryResource<Mesh>(
+                meshHelper.getString(L"Name"),
+                meshHelper.getString(L"Mesh"));
+
+            for (auto &matMap : meshHelper.getObjects(L"MaterialMapping"))
+            {
+                materials[matMap.getInt(L"MaterialIndex")] = 
+                    main.getMaterialFactory().createMaterial(
+                        matMap.getObject(L"Material").getString(L"Type"),
+                        matMap.getObject(L"Material").getString(L"Name"),
+                        matMap.getObject(L"Material").getString(L"Material"));
+            }
+        }
+    }
+
+    static std::string_view loadTemplateFile(Main &main, const String &templatePath)
+    {
+        size_t fileSize = 0;
+        const void *fileData = main.getResourceManager().loadFileToMemory(templatePath, &fileSize);
+        return std::string_view(static_cast<const char *>(fileData), fileSize);
+    }
+
+    SceneObjectTemplate::SceneObjectTemplate(Main &main, const String &templatePath) : 
+        SceneObjectTemplate(main, templatePath, loadTemplateFile(main, templatePath))
+    {}
+
+    SceneObjectTemplate::SceneObjectTemplate(Main &main, const char *data, size_t size) : 
+        SceneObjectTemplate(main, String(), std::string_view(data, size))
+    {}
+
+    SceneObjectTemplate::SceneObjectTemplate(Main &main, const String &templatePath, const std::string_view &data) : 
+        mPath(templatePath),
+        mJson(data.data(), data.size())
+    {
+        compile(main);
+    }
+
+    void SceneObjectTemplate::compile(Main &main)
+    {
+        ConfigurationReader rootNodeHelper = mJson.getObject(L"Root");
+        if (rootNodeHelper.isEmpty())
+            return;
+
+        mNodes.emplace_back(main, rootNodeHelper);
+        compileNodes(main, rootNodeHelper.getObjects(L"Nodes"), 0);
+    }
+
+    void SceneObjectTemplate::compileNodes(Main &main, const stl<ConfigurationReader>::vector &nodes, int32_t parent)
+    {
+        for (const ConfigurationReader &nodeHelper : nodes)
+        {
+            if (nodeHelper.isEmpty())
+                continue;
+
+            int32_t index = static_cast<int32_t>(mNodes.size());
+            mNodes.emplace_back(main, nodeHelper);
+            mNodes.back().parent = parent;
+            compileNodes(main, nodeHelper.getObjects(L"Nodes"), index);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_shadow_scheduler.h>
+
+#include <algorithm>
+#include <SDL_assert.h>
+
+namespace lite3dpp
+{
+    ShadowUpdateScheduler::ShadowUpdateScheduler(const Config &config)
+    {
+        setConfig(config);
+    }
+
+    void ShadowUpdateScheduler::setConfig(const Config &config)
+    {
+        mConfig = config;
+        mLayerCostMs = config.initialLayerCostMs;
+    }
+
+    float ShadowUpdateScheduler::priority(const LightState &light, uint32_t staleFrames) const
+    {
+        return mConfig.coverageWeight * std::clamp(light.coverage, 0.0f, 1.0f) +
+            mConfig.distanceWeight / (1.0f + std::max(light.distance, 0.0f) / mConfig.distanceScale) +
+            (light.moving ? mConfig.movementWeight : 0.0f) +
+            mConfig.ageWeight * static_cast<float>(staleFrames);
+    }
+
+    const ShadowUpdateScheduler::CasterMask &ShadowUpdateScheduler::schedule(const LightState *lights, uint32_t count)
+    {
+        SDL_assert(count <= ShadowVisibility::MaxCasters);
+        SDL_assert(lights || count == 0);
+
+        mStats.resize(count);
+        mScheduled.reset();
+        mOrder.clear();
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (lights[i].pending)
+            {
+                mStats[i].priority = priority(lights[i], mStats[i].staleFrames);
+                mOrder.push_back(i);
+            }
+            else
+            {
+                mStats[i].priority = 0.0f;
+                mStats[i].staleFrames = 0;
+            }
+        }
+
+        // Сначала просроченные (дольше ждавшие первыми), потом по приоритету, при равенстве по индексу
+        auto forced = [this](uint32_t index) { return mStats[index].staleFrames >= mConfig.maxStaleFrames; };
+        std::sort(mOrder.begin(), mOrder.end(), [this, &forced](uint32_t a, uint32_t b)
+        {
+            if (forced(a) != forced(b))
+                return forced(a);
+            if (forced(a) && mStats[a].staleFrames != mStats[b].staleFrames)
+                return mStats[a].staleFrames > mStats[b].staleFrames;
+            if (mStats[a].priority != mStats[b].priority)
+                return mStats[a].priority > mStats[b].priority;
+            return a < b;
+        });
+
+        uint32_t limit = mConfig.maxUpdatesPerFrame > 0 ? mConfig.maxUpdatesPerFrame : count;
+        uint32_t selected = 0;
+        float spent = 0.0f;
+        for (uint32_t index : mOrder)
+        {
+            if (selected == limit)
+                break;
+
+            // Хотя бы одна карта за кадр обновляется всегда, иначе маленький бюджет остановит все тени
+            if (!forced(index) && mConfig.budgetMs > 0.0f && selected > 0 && spent + mLayerCostMs > mConfig.budgetMs)
+                break;
+
+            mScheduled.set(index);
+            spent += mLayerCostMs;
+            selected++;
+        }
+
+        for (uint32_t index : mOrder)
+        {
+            LightStats &stats = mStats[index];
+            if (mScheduled.test(index))
+            {
+                stats.updates++;
+                stats.staleFrames = 0;
+            }
+            else
+            {
+                stats.deferrals++;
+                stats.staleFrames++;
+                stats.maxStaleFrames = std::max(stats.maxStaleFrames, stats.staleFrames);
+            }
+        }
+
+        return mScheduled;
+    }
+
+    void ShadowUpdateScheduler::reportCost(float milliseconds, uint32_t layers)
+    {
+        if (layers == 0)
+            return;
+
+        // Сглаживание, чтобы один медленный кадр не выключал тени на следующих
+        mLayerCostMs = mLayerCostMs * 0.8f + (milliseconds / static_cast<float>(layers)) * 0.2f;
+    }
+
+    const ShadowUpdateScheduler::LightStats &ShadowUpdateScheduler::getLightStats(uint32_t index) const
+    {
+        SDL_assert(index < mStats.size());
+        return mStats[index];
+    }
+}
@@ -0,0 +1,415 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_shadow_visibility.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <SDL_assert.h>
+
+namespace lite3dpp
+{
+    // Ключ ячейки: три координаты по 21 биту со смещением, старший бит всегда ноль
+    static const constexpr int64_t CellBias = 1 << 20;
+    static const constexpr uint64_t CellMask = (uint64_t(1) << 21) - 1;
+
+    static inline int64_t cellCoord(float value, float cellSize)
+    {
+        auto coord = static_cast<int64_t>(std::floor(value / cellSize));
+        return std::clamp<int64_t>(coord, -CellBias, CellBias - 1);
+    }
+
+    static inline uint64_t cellKey(int64_t x, int64_t y, int64_t z)
+    {
+        return (uint64_t(x + CellBias) & CellMask) |
+            ((uint64_t(y + CellBias) & CellMask) << 21) |
+            ((uint64_t(z + CellBias) & CellMask) << 42);
+    }
+
+    ShadowVisibility::ShadowVisibility(float cellSize) :
+        mCellSize(cellSize)
+    {
+        SDL_assert(cellSize > 0.0f);
+    }
+
+    void ShadowVisibility::setCaster(uint32_t index, const kmMat4 &projView)
+    {
+        if (index >= MaxCasters)
+        {
+            LITE3D_THROW("Shadow caster index " << index << " is out of limit " << MaxCasters);
+        }
+
+        for (uint32_t i = static_cast<uint32_t>(mCasters.size()); i <= index; ++i)
+        {
+            mCasters.emplace_back();
+            invalidateCaster(i);
+        }
+
+        Caster &caster = mCasters[index];
+        if (caster.valid && memcmp(&caster.projView, &projView, sizeof(kmMat4)) == 0)
+        {
+            return;
+        }
+
+        caster.projView = projView;
+        caster.valid = caster.changed = true;
+        lite3d_frustum_compute(&caster.frustum, &projView);
+        frustumBounds(projView, caster.vmin, caster.vmax);
+    }
+
+    void ShadowVisibility::setStaticCache(bool enabled)
+    {
+        mStaticCache = enabled;
+        // Кеш надо будет построить заново
+        for (uint32_t i = 0; i < mCasters.size(); ++i)
+        {
+            invalidateCaster(i);
+        }
+    }
+
+    void ShadowVisibility::invalidateCaster(uint32_t index)
+    {
+        SDL_assert(index < MaxCasters);
+        mInvalidated.set(index);
+        mStaticInvalidated.set(index);
+        mChanged.set(index);
+    }
+
+    void ShadowVisibility::invalidateCasters(const CasterMask &mask)
+    {
+        mInvalidated |= mask;
+        mChanged |= mask;
+    }
+
+    void ShadowVisibility::validateCaster(uint32_t index)
+    {
+        SDL_assert(index < MaxCasters);
+        mInvalidated.reset(index);
+        mStaticInvalidated.reset(index);
+    }
+
+    bool ShadowVisibility::isInvalidated(uint32_t index) const
+    {
+        SDL_assert(index < MaxCasters);
+        return mInvalidated.test(index);
+    }
+
+    bool ShadowVisibility::isStaticInvalidated(uint32_t index) const
+    {
+        SDL_assert(index < MaxCasters);
+        return mStaticInvalidated.test(index);
+    }
+
+    const ShadowVisibility::CasterMask &ShadowVisibility::beginPass(Pass pass, const CasterMask &active)
+    {
+        SDL_assert(pass != Pass::None);
+        SDL_assert(pass == Pass::Main || mStaticCache);
+
+        mPass = pass;
+        mPassCounter++;
+        mStats = Stats();
+        mPassMask = (pass == Pass::Static ? mStaticInvalidated : mInvalidated) & active;
+        if (mPassMask.none())
+        {
+            // Рисовать нечего, проход не начинается
+            mPass = Pass::None;
+        }
+
+        // Колонки видимости пересчитываются только для камер, матрица которых поменялась
+        for (uint32_t i = 0; i < mCasters.size(); ++i)
+        {
+            if (mCasters[i].changed)
+            {
+                refreshCaster(i);
+            }
+        }
+
+        return mPassMask;
+    }
+
+    bool ShadowVisibility::approve(const lite3d_bounding_vol *vol, bool dynamic, CasterMask &visibleFrom)
+    {
+        SDL_assert(vol);
+        SDL_assert(mPass != Pass::None);
+
+        auto it = mPieceByVol.find(vol);
+        uint32_t index;
+        if (it == mPieceByVol.end())
+        {
+            index = static_cast<uint32_t>(mPieces.size());
+            Piece &piece = mPieces.emplace_back();
+            piece.key = vol;
+            piece.vol = *vol;
+            cellInsert(index);
+            mPieceByVol.emplace(vol, index);
+        }
+        else
+        {
+            index = it->second;
+            Piece &piece = mPieces[index];
+            if (memcmp(&piece.vol, vol, sizeof(lite3d_bounding_vol)) == 0)
+            {
+                piece.lastPass = mPassCounter;
+                piece.dynamic = dynamic;
+                visibleFrom = piece.mask;
+                return (!mStaticCache || (mPass == Pass::Static) != dynamic) && (piece.mask & mPassMask).any();
+            }
+
+            cellErase(index);
+            piece.vol = *vol;
+            cellInsert(index);
+        }
+
+        // Новая или сдвинутая часть сцены: тени на старом и новом месте надо перерисовать.
+        // Камеры текущего прохода ее и так нарисуют, в кеше статики - только статическую часть
+        Piece &piece = mPieces[index];
+        CasterMask oldMask = piece.mask;
+        piece.mask = testAll(piece);
+        piece.lastPass = mPassCounter;
+        mStats.piecesUpdated++;
+
+        piece.dynamic = dynamic;
+        invalidateByPiece(oldMask | piece.mask, dynamic);
+
+        visibleFrom = piece.mask;
+        return (!mStaticCache || (mPass == Pass::Static) != dynamic) && (piece.mask & mPassMask).any();
+    }
+
+    void ShadowVisibility::invalidateByPiece(const CasterMask &mask, bool dynamic)
+    {
+        mChanged |= mask;
+        if (mStaticCache && !dynamic)
+        {
+            mStaticInvalidated |= mask & ~(mPass == Pass::Static ? mPassMask : CasterMask());
+        }
+        else
+        {
+            mInvalidated |= mask & ~(mPass == Pass::Main ? mPassMask : CasterMask());
+        }
+    }
+
+    void ShadowVisibility::endPass()
+    {
+        SDL_assert(mPass != Pass::None);
+
+        if (mPass == Pass::Static)
+        {
+            // Кеш готов, итоговые слои надо собрать из него заново
+            mStaticInvalidated &= ~mPassMask;
+            mInvalidated |= mPassMask;
+        }
+        else
+        {
+            mInvalidated &= ~mPassMask;
+            if (!mStaticCache)
+            {
+                mStaticInvalidated &= ~mPassMask;
+            }
+        }
+
+        mPass = Pass::None;
+        // Части сцены, которых не было в этом проходе, удалены или выключены
+        for (uint32_t i = 0; i < mPieces.size();)
+        {
+            if (mPieces[i].lastPass != mPassCounter)
+            {
+                // Тень пропавшего объекта надо стереть
+                invalidateByPiece(mPieces[i].mask, mPieces[i].dynamic);
+                removePiece(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void ShadowVisibility::frustumBounds(const kmMat4 &projView, kmVec3 &vmin, kmVec3 &vmax)
+    {
+        kmMat4 inverse;
+        kmMat4Inverse(&inverse, &projView);
+
+        vmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+        vmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (int i = 0; i < 8; ++i)
+        {
+            kmVec3 corner = { i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f };
+            kmVec3 world;
+            kmVec3TransformCoord(&world, &corner, &inverse);
+            vmin = { std::min(vmin.x, world.x), std::min(vmin.y, world.y), std::min(vmin.z, world.z) };
+            vmax = { std::max(vmax.x, world.x), std::max(vmax.y, world.y), std::max(vmax.z, world.z) };
+        }
+    }
+
+    uint64_t ShadowVisibility::cellOf(const lite3d_bounding_vol &vol) const
+    {
+        // Не настроенный объем виден всегда, большие объемы не влезают в соседние ячейки
+        if (vol.radius <= 0.0f || vol.radius > mCellSize)
+            return LargeCell;
+
+        return cellKey(cellCoord(vol.sphereCenter.x, mCellSize), cellCoord(vol.sphereCenter.y, mCellSize),
+            cellCoord(vol.sphereCenter.z, mCellSize));
+    }
+
+    void ShadowVisibility::cellInsert(uint32_t index)
+    {
+        Piece &piece = mPieces[index];
+        piece.cell = cellOf(piece.vol);
+        auto &cell = mCells[piece.cell];
+        piece.slot = static_cast<uint32_t>(cell.size());
+        cell.push_back(index);
+    }
+
+    void ShadowVisibility::cellErase(uint32_t index)
+    {
+        const Piece &piece = mPieces[index];
+        auto it = mCells.find(piece.cell);
+        SDL_assert(it != mCells.end());
+        auto &cell = it->second;
+        SDL_assert(cell[piece.slot] == index);
+
+        cell[piece.slot] = cell.back();
+        mPieces[cell[piece.slot]].slot = piece.slot;
+        cell.pop_back();
+        if (cell.empty())
+        {
+            mCells.erase(it);
+        }
+    }
+
+    void ShadowVisibility::removePiece(uint32_t index)
+    {
+        cellErase(index);
+        mPieceByVol.erase(mPieces[index].key);
+
+        uint32_t last = static_cast<uint32_t>(mPieces.size() - 1);
+        if (index != last)
+        {
+            // Последняя часть переезжает на место удаленной
+            mPieces[index] = mPieces[last];
+            mCells[mPieces[index].cell][mPieces[index].slot] = index;
+            mPieceByVol[mPieces[index].key] = index;
+        }
+
+        mPieces.pop_back();
+    }
+
+    bool ShadowVisibility::testPiece(const Caster &caster, const Piece &piece)
+    {
+        if (!caster.valid)
+            return false;
+
+        mStats.frustumTests++;
+        // Сначала AABB фрустума: отсекает и то, что пропускают плоскости у углов фрустума,
+        // поэтому результат не зависит от того, через сетку найден обьект или нет
+        const kmVec3 &c = piece.vol.sphereCenter;
+        float r = piece.vol.radius;
+        if (r > 0.0f && (c.x + r < caster.vmin.x || c.x - r > caster.vmax.x || c.y + r < caster.vmin.y ||
+            c.y - r > caster.vmax.y || c.z + r < caster.vmin.z || c.z - r > caster.vmax.z))
+        {
+            return false;
+        }
+
+        return lite3d_frustum_test(&caster.frustum, &piece.vol) == LITE3D_TRUE;
+    }
+
+    ShadowVisibility::CasterMask ShadowVisibility::testAll(const Piece &piece)
+    {
+        CasterMask mask;
+        for (uint32_t i = 0; i < mCasters.size(); ++i)
+        {
+            if (testPiece(mCasters[i], piece))
+            {
+                mask.set(i);
+            }
+        }
+
+        return mask;
+    }
+
+    void ShadowVisibility::refreshCaster(uint32_t index)
+    {
+        Caster &caster = mCasters[index];
+        caster.changed = false;
+
+        for (auto &piece : mPieces)
+        {
+            piece.mask.reset(index);
+        }
+
+        auto testCell = [this, &caster, index](const stl<uint32_t>::vector &cell)
+        {
+            for (uint32_t pieceIndex : cell)
+            {
+                if (testPiece(caster, mPieces[pieceIndex]))
+                {
+                    mPieces[pieceIndex].mask.set(index);
+                }
+            }
+        };
+
+        auto large = mCells.find(LargeCell);
+        if (large != mCells.end())
+        {
+            testCell(large->second);
+        }
+
+        // Центр части сцены, задевающей AABB фрустума, лежит не дальше радиуса (не больше ячейки) от него
+        int64_t from[3] = { cellCoord(caster.vmin.x - mCellSize, mCellSize), cellCoord(caster.vmin.y - mCellSize, mCellSize),
+            cellCoord(caster.vmin.z - mCellSize, mCellSize) };
+        int64_t to[3] = { cellCoord(caster.vmax.x + mCellSize, mCellSize), cellCoord(caster.vmax.y + mCellSize, mCellSize),
+            cellCoord(caster.vmax.z + mCellSize, mCellSize) };
+        double rangeCells = double(to[0] - from[0] + 1) * double(to[1] - from[1] + 1) * double(to[2] - from[2] + 1);
+
+        if (rangeCells > static_cast<double>(mCells.size()))
+        {
+            // Фрустум больше занятой части сетки, проще пройти по занятым ячейкам
+            for (const auto &cell : mCells)
+            {
+                if (cell.first == LargeCell)
+                    continue;
+
+                int64_t x = static_cast<int64_t>(cell.first & CellMask) - CellBias;
+                int64_t y = static_cast<int64_t>((cell.first >> 21) & CellMask) - CellBias;
+                int64_t z = static_cast<int64_t>((cell.first >> 42) & CellMask) - CellBias;
+                if (x >= from[0] && x <= to[0] && y >= from[1] && y <= to[1] && z >= from[2] && z <= to[2])
+                {
+                    testCell(cell.second);
+                }
+            }
+
+            return;
+        }
+
+        for (int64_t z = from[2]; z <= to[2]; ++z)
+        {
+            for (int64_t y = from[1]; y <= to[1]; ++y)
+            {
+                for (int64_t x = from[0]; x <= to[0]; ++x)
+                {
+                    auto it = mCells.find(cellKey(x, y, z));
+                    if (it != mCells.end())
+                    {
+                        testCell(it->second);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -42,7 +42,7 @@ namespace lite3dpp
         mBonesTransformData.resize(mVertexGroups.size());
     }
 
-    void Skeleton::loadBone(SkeletonBone *parent, const ConfigurationReader& conf)
+    void Skeleton::loadBone(int32_t parent, const ConfigurationReader& conf)
     {
         String boneName = conf.getString(L"Name");
         auto indexIt = mVertexGroups.find(boneName);
@@ -52,22 +52,22 @@ namespace lite3dpp
                 boneName.c_str(), mNode.getName().c_str());
         }
 
-        auto inserted = mBones.try_emplace(boneName, 
-            boneName,
-            parent,
-            indexIt == mVertexGroups.end() ? nullptr : &mBonesTransformData[indexIt->second],
-            conf.getVec3(L"Head"),
-            conf.getDouble(L"Length"),
-            conf.getQuaternion(L"Rotation"));
-
-        if (!inserted.second)
+        if (mBones.count(boneName) > 0)
         {
             LITE3D_THROW("Duplicate bone name '" << boneName << "'. Mesh '" << mNode.getName() << "'");
         }
 
+        // Дети добавляются после родителя, порядок в позе всегда parent first
+        int32_t index = mPose.addBone(parent,
+            conf.getVec3(L"Head"),
+            conf.getDouble(L"Length"),
+            conf.getQuaternion(L"Rotation"),
+            indexIt == mVertexGroups.end() ? -1 : indexIt->second);
+        mBones.try_emplace(boneName, boneName, mPose, index);
+
         for (const auto &boneCfg : conf.getObjects(L"Bones"))
         {
-            loadBone(&inserted.first->second, boneCfg);
+            loadBone(index, boneCfg);
         }
     }
 
@@ -78,35 +78,32 @@ namespace lite3dpp
         loadVertexGroups(conf);
         for (const auto &boneCfg : conf.getObjects(L"Skeleton"))
         {
-            loadBone(nullptr, boneCfg);
+            loadBone(-1, boneCfg);
         }
 
+        // Rest pose palette
+        mPose.writePalette(mBonesTransformData.data(), mBonesTransformData.size());
+
         mNode.getMain()->getSkeletonBuffer().registerSceneNode(&mNode);
         LITE3D_EXT_OBSERVER_NOTIFY_1(&mNode, updateSkeletonPose, &mNode);
     }
 
-    void Skeleton::resetToRestPose()
+    void Skeleton::updatePalette()
     {
-        for (auto &bone : mBones)
-        {
-            bone.second.resetToRestPose();
-        }
-
+        mPose.writePalette(mBonesTransformData.data(), mBonesTransformData.size());
         mNode.getMain()->getSkeletonBuffer().updateData(mBufferIndex, getTransformData());
         LITE3D_EXT_OBSERVER_NOTIFY_1(&mNode, updateSkeletonPose, &mNode);
     }
 
-    void Skeleton::recalculate()
+    void Skeleton::resetToRestPose()
     {
-        for (auto &bone : mBones)
-        {
-            if (bone.second.isEmptyParent())
-            {
-                bone.second.recalculateRecursive();
-            }
-        }
+        mPose.resetToRestPose();
+        updatePalette();
+    }
 
-        mNode.getMain()->getSkeletonBuffer().updateData(mBufferIndex, getTransformData());
-        LITE3D_EXT_OBSERVER_NOTIFY_1(&mNode, updateSkeletonPose, &mNode);
+    void Skeleton::recalculate()
+    {
+        mPose.recalculate();
+        updatePalette();
     }
 }
@@ -19,121 +19,39 @@
 
 namespace lite3dpp
 {
-    SkeletonBone::SkeletonBone(const String &name, 
-        SkeletonBone *parent, 
-        kmMat4 *matrixBuffer, 
-        const kmVec3 &head,
-        kmScalar lenght,
-        const kmQuaternion &restPoseRotation) : 
+    SkeletonBone::SkeletonBone(const String &name, SkeletonPose &pose, int32_t index) : 
         mName(name),
-        mParent(parent),
-        mTransformFromRest(matrixBuffer),
-        mLength(lenght),
-        mRestPoseRotation(restPoseRotation)
-    {
-        mRestPosePosition = head;
-        mRestPosePosition.y += parent ? parent->mLength : 0.0f;
-        // Caclulate bone rest pose local transform
-        kmMat4 translate;
-        kmMat4Translation(&translate, mRestPosePosition.x, mRestPosePosition.y, mRestPosePosition.z);
-        kmMat4RotationQuaternion(&mRestPoseTransform, &mRestPoseRotation);
-        kmMat4Multiply(&mRestPoseTransform, &translate, &mRestPoseTransform);
-        // Caclulate bone rest pose skeleton space transform
-        if (parent)
-        {
-            kmMat4Multiply(&mRestPoseTransform, &parent->mRestPoseTransform, &mRestPoseTransform);
-            parent->addChildBone(this);
-        }
-        // Caclulate bone rest pose skeleton space inverse transform
-        if (!kmMat4Inverse(&mRestPoseTransformInverse, &mRestPoseTransform))
-        {
-            mRestPoseTransformInverse = mRestPoseTransform;
-        }
-
-        resetToRestPose();
-    }
+        mPose(pose),
+        mIndex(index)
+    {}
 
     void SkeletonBone::setPosition(const kmVec3 &position)
     {
-        kmVec3Add(&mPosition, &mRestPosePosition, &position);
-        mNeedRecalc = true;
+        mPose.setPosition(mIndex, position);
     }
 
     const kmVec3& SkeletonBone::getPosition() const
     {
-        return mPosition;
+        return mPose.getPosition(mIndex);
     }
 
     void SkeletonBone::setRotation(const kmQuaternion &rotation)
     {
-        kmQuaternionMultiply(&mRotation, &mRestPoseRotation, &rotation);
-        mNeedRecalc = true;
+        mPose.setRotation(mIndex, rotation);
     }
 
     const kmQuaternion& SkeletonBone::getRotation() const
     {
-        return mRotation;
+        return mPose.getRotation(mIndex);
     }
 
     void SkeletonBone::setScale(const kmVec3 &scale)
     {
-        mScale = scale;
-        mNeedRecalc = true;
+        mPose.setScale(mIndex, scale);
     }
 
     const kmVec3 &SkeletonBone::getScale() const
     {
-        return mScale;
-    }
-
-    void SkeletonBone::addChildBone(SkeletonBone *bone)
-    {
-        mChildBones.emplace_back(bone);
-    }
-
-    void SkeletonBone::recalculateRecursive(bool force)
-    {
-        if (mNeedRecalc || force)
-        {
-            // Caclulate bone local transform
-            kmMat4 translate;
-            kmMat4TranslationScale(&translate, &mPosition, &mScale);
-            kmMat4RotationQuaternion(&mTransform, &mRotation);
-            kmMat4Multiply(&mTransform, &translate, &mTransform);
-         
-            // Caclulate bone skeleton space transform
-            if (mParent)
-            {
-                kmMat4Multiply(&mTransform, &mParent->mTransform, &mTransform);
-            }
-
-            if (mTransformFromRest)
-            {
-                // Final bone transform matrix, will be loaded to GPU
-                kmMat4Multiply(mTransformFromRest, &mTransform, &mRestPoseTransformInverse);
-            }
-
-            mNeedRecalc = false;
-            force = true;
-        }
-
-        for (SkeletonBone *bone : mChildBones)
-        {
-            bone->recalculateRecursive(force);
-        }
-    }
-
-    void SkeletonBone::resetToRestPose()
-    {
-        mPosition = mRestPosePosition;
-        mRotation = mRestPoseRotation;
-        mScale = KM_VEC3_ONE;
-        mNeedRecalc = true;
-
-        mTransform = mRestPoseTransform;
-        if (mTransformFromRest)
-        {
-            kmMat4Identity(mTransformFromRest);
-        }
+        return mPose.getScale(mIndex);
     }
 }
@@ -18,12 +18,14 @@
 #include <lite3dpp/lite3dpp_skeleton_buffer.h>
 #include <lite3dpp/lite3dpp_main.h>
 
+#include <cstring>
 #include <SDL_assert.h>
 
 namespace lite3dpp
 {
     SkeletonBuffer::SkeletonBuffer(Main &main) : 
-        mMain(main)
+        mMain(main),
+        mDirty(sizeof(Skeleton::BonesTransformData::value_type))
     {}
 
     SSBO &SkeletonBuffer::getBuffer()
@@ -86,6 +88,7 @@ namespace lite3dpp
 
                 mGlobalSkeletonBuffer->extendBufferBytes(sizeBytes);
                 mAllocatedBytes += sizeBytes;
+                resizeShadow();
             }
 
             node->setSkeletonBufferIndex(static_cast<int32_t>(bufferIndex));
@@ -119,16 +122,42 @@ namespace lite3dpp
         }
 
         mNodes.clear();
+        mShadow.clear();
+        mDirty.resize(0);
     }
 
-    void SkeletonBuffer::updateData(size_t index, const Skeleton::BonesTransformData &data)
+    void SkeletonBuffer::resizeShadow()
     {
-        size_t offset = index * sizeof(Skeleton::BonesTransformData::value_type);
-        size_t dataSize = data.size() * sizeof(Skeleton::BonesTransformData::value_type);
+        size_t oldCount = mShadow.size();
+        size_t count = mGlobalSkeletonBuffer->bufferSizeBytes() / sizeof(Skeleton::BonesTransformData::value_type);
+        mShadow.resize(count);
+        mDirty.resize(count);
+        // содержимое новой части буфера не определено
+        if (count > oldCount)
+            mDirty.markDirty(oldCount, count - oldCount);
+    }
 
+    void SkeletonBuffer::updateData(size_t index, const Skeleton::BonesTransformData &data)
+    {
         SDL_assert(mGlobalSkeletonBuffer);
-        SDL_assert((offset + dataSize) <= mGlobalSkeletonBuffer->bufferSizeBytes());
+        SDL_assert((index + data.size()) <= mShadow.size());
 
-        mGlobalSkeletonBuffer->setData(&data[0], offset, dataSize);
+        // Неподвижные кости не перезаливаются
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            if (memcmp(&mShadow[index + i], &data[i], sizeof(Skeleton::BonesTransformData::value_type)) != 0)
+            {
+                mShadow[index + i] = data[i];
+                mDirty.markDirty(index + i);
+            }
+        }
+    }
+
+    void SkeletonBuffer::flush()
+    {
+        if (mGlobalSkeletonBuffer && mDirty.hasDirty())
+        {
+            mDirty.flush(*mGlobalSkeletonBuffer, mShadow.data());
+        }
     }
 }
@@ -0,0 +1,224 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp/lite3dpp_skeleton_pose.h>
+
+#include <algorithm>
+#include <SDL_assert.h>
+
+namespace lite3dpp
+{
+    // Local transform is translate * scale * rotation
+    static inline void localTransform(kmMat4 &transform, const kmVec3 &position, const kmQuaternion &rotation,
+        const kmVec3 &scale)
+    {
+        kmMat4RotationQuaternion(&transform, &rotation);
+        for (int c = 0; c < 3; ++c)
+        {
+            transform.mat[c * 4 + 0] *= scale.x;
+            transform.mat[c * 4 + 1] *= scale.y;
+            transform.mat[c * 4 + 2] *= scale.z;
+        }
+
+        transform.mat[12] = position.x;
+        transform.mat[13] = position.y;
+        transform.mat[14] = position.z;
+    }
+
+    int32_t SkeletonPose::addBone(int32_t parent, const kmVec3 &head, kmScalar length,
+        const kmQuaternion &restPoseRotation, int32_t paletteIndex)
+    {
+        SDL_assert(parent < static_cast<int32_t>(mParents.size()));
+
+        kmVec3 restPosePosition = head;
+        restPosePosition.y += parent >= 0 ? mLengths[parent] : 0.0f;
+        // Caclulate bone rest pose local transform
+        kmMat4 translate, restPoseTransform, restPoseTransformInverse;
+        kmMat4Translation(&translate, restPosePosition.x, restPosePosition.y, restPosePosition.z);
+        kmMat4RotationQuaternion(&restPoseTransform, &restPoseRotation);
+        kmMat4Multiply(&restPoseTransform, &translate, &restPoseTransform);
+        // Caclulate bone rest pose skeleton space transform
+        if (parent >= 0)
+        {
+            kmMat4Multiply(&restPoseTransform, &mRestPoseTransforms[parent], &restPoseTransform);
+        }
+        // Caclulate bone rest pose skeleton space inverse transform
+        if (!kmMat4Inverse(&restPoseTransformInverse, &restPoseTransform))
+        {
+            restPoseTransformInverse = restPoseTransform;
+        }
+
+        mParents.push_back(parent);
+        mPaletteIndices.push_back(paletteIndex);
+        mLengths.push_back(length);
+        mRestPosePositions.push_back(restPosePosition);
+        mRestPoseRotations.push_back(restPoseRotation);
+        mPositions.push_back(restPosePosition);
+        mRotations.push_back(restPoseRotation);
+        mScales.push_back(KM_VEC3_ONE);
+        mDirty.push_back(1);
+        mRestPoseTransforms.push_back(restPoseTransform);
+        mRestPoseTransformsInverse.push_back(restPoseTransformInverse);
+        mTransforms.push_back(restPoseTransform);
+        mSkinning.emplace_back();
+        kmMat4Identity(&mSkinning.back());
+
+        return static_cast<int32_t>(mParents.size() - 1);
+    }
+
+    void SkeletonPose::setPosition(int32_t bone, const kmVec3 &position)
+    {
+        kmVec3Add(&mPositions[bone], &mRestPosePositions[bone], &position);
+        mDirty[bone] = 1;
+    }
+
+    void SkeletonPose::setRotation(int32_t bone, const kmQuaternion &rotation)
+    {
+        kmQuaternionMultiply(&mRotations[bone], &mRestPoseRotations[bone], &rotation);
+        mDirty[bone] = 1;
+    }
+
+    void SkeletonPose::setScale(int32_t bone, const kmVec3 &scale)
+    {
+        mScales[bone] = scale;
+        mDirty[bone] = 1;
+    }
+
+    void SkeletonPose::resetToRestPose()
+    {
+        mPositions = mRestPosePositions;
+        mRotations = mRestPoseRotations;
+        std::fill(mScales.begin(), mScales.end(), KM_VEC3_ONE);
+        std::fill(mDirty.begin(), mDirty.end(), 1);
+        mTransforms = mRestPoseTransforms;
+        for (auto &skinning : mSkinning)
+        {
+            kmMat4Identity(&skinning);
+        }
+    }
+
+    void SkeletonPose::recalculateTransforms()
+    {
+        const size_t count = mParents.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const int32_t parent = mParents[i];
+            // Parent is always before the child, its flag is already propagated
+            if (parent >= 0 && mDirty[parent])
+                mDirty[i] = 1;
+            if (!mDirty[i])
+                continue;
+
+            kmMat4 &transform = mTransforms[i];
+            localTransform(transform, mPositions[i], mRotations[i], mScales[i]);
+
+            if (parent >= 0)
+            {
+                kmMat4MultiplyArray(&transform, &mTransforms[parent], &transform, 1);
+            }
+        }
+
+        std::fill(mDirty.begin(), mDirty.end(), 0);
+    }
+
+    void SkeletonPose::recalculate()
+    {
+        recalculateTransforms();
+        kmMat4MultiplyArray(mSkinning.data(), mTransforms.data(), mRestPoseTransformsInverse.data(), mSkinning.size());
+    }
+
+    void SkeletonPose::writePalette(kmMat4 *palette, size_t paletteSize) const
+    {
+        for (size_t i = 0; i < mPaletteIndices.size(); ++i)
+        {
+            const int32_t index = mPaletteIndices[i];
+            if (index >= 0 && static_cast<size_t>(index) < paletteSize)
+                palette[index] = mSkinning[i];
+        }
+    }
+
+    void SkeletonPoseBatch::setSkeleton(const SkeletonPose &pose, size_t count)
+    {
+        const size_t bones = pose.getBonesCount();
+        // Rest pose inverse is repeated for every pose, rebuilt only when the skeleton or poses count changes
+        bool same = mPosesCount == count && mParents == pose.mParents && mPaletteIndices == pose.mPaletteIndices;
+        for (size_t i = 0; same && i < bones; ++i)
+        {
+            same = kmMat4AreEqual(&mRestPoseTransformsInverse[i * count], &pose.mRestPoseTransformsInverse[i]);
+        }
+
+        if (same)
+            return;
+
+        mPosesCount = count;
+        mParents = pose.mParents;
+        mPaletteIndices = pose.mPaletteIndices;
+        mRestPoseTransformsInverse.resize(bones * count);
+        mTransforms.resize(bones * count);
+        mSkinning.resize(bones * count);
+        mLocal.resize(count);
+        for (size_t i = 0; i < bones; ++i)
+        {
+            std::fill_n(mRestPoseTransformsInverse.begin() + i * count, count, pose.mRestPoseTransformsInverse[i]);
+        }
+    }
+
+    void SkeletonPoseBatch::recalculate(const SkeletonPose *const *poses, size_t count)
+    {
+        if (count == 0)
+        {
+            mPosesCount = 0;
+            return;
+        }
+
+        setSkeleton(*poses[0], count);
+        const size_t bones = mParents.size();
+        for (size_t i = 0; i < bones; ++i)
+        {
+            const int32_t parent = mParents[i];
+            kmMat4 *transforms = &mTransforms[i * count];
+            // Root bones are written in place, children are combined with parents of all poses at once
+            kmMat4 *local = parent >= 0 ? mLocal.data() : transforms;
+            for (size_t n = 0; n < count; ++n)
+            {
+                const SkeletonPose &pose = *poses[n];
+                SDL_assert(pose.getBonesCount() == bones);
+                localTransform(local[n], pose.mPositions[i], pose.mRotations[i], pose.mScales[i]);
+            }
+
+            if (parent >= 0)
+            {
+                kmMat4MultiplyArray(transforms, &mTransforms[parent * count], local, count);
+            }
+        }
+
+        kmMat4MultiplyArray(mSkinning.data(), mTransforms.data(), mRestPoseTransformsInverse.data(), mSkinning.size());
+    }
+
+    void SkeletonPoseBatch::writePalettes(kmMat4 *palettes, size_t paletteSize) const
+    {
+        for (size_t i = 0; i < mPaletteIndices.size(); ++i)
+        {
+            const int32_t index = mPaletteIndices[i];
+            if (index < 0 || static_cast<size_t>(index) >= paletteSize)
+                continue;
+
+            for (size_t n = 0; n < mPosesCount; ++n)
+                palettes[n * paletteSize + index] = mSkinning[i * mPosesCount + n];
+        }
+    }
+}
@@ -17,6 +17,7 @@
  *******************************************************************************/
 #include <algorithm>
 #include <SDL_log.h>
+#include <SDL_assert.h>
 
 #include <lite3dpp/lite3dpp_main.h>
 #include <lite3dpp/lite3dpp_texture.h>
@@ -344,14 +345,29 @@ namespace lite3dpp
 
     void TextureImage::setPixels(int8_t level, const void *pixels)
     {
+        int32_t width = lite3d_texture_unit_get_level_width(&mTexture, level, 0);
+        int32_t height = lite3d_texture_unit_get_level_height(&mTexture, level, 0);
+        int32_t depth = lite3d_texture_unit_get_level_depth(&mTexture, level, 0);
         if(!lite3d_texture_unit_set_pixels(&mTexture, 0, 0, 0,
-            lite3d_texture_unit_get_level_width(&mTexture, level, 0), 
-            lite3d_texture_unit_get_level_height(&mTexture, level, 0), 
-            lite3d_texture_unit_get_level_depth(&mTexture, level, 0), 
-            level, 0, pixels))
+            width, height, depth, level, 0, pixels))
             LITE3D_THROW("Could`n set level " << level << " for texture ");
 
         mModified = true;
+        mUploadedBytes += static_cast<uint64_t>(width) * height * std::max(depth, 1) * mTexture.imageBPP;
+    }
+
+    void TextureImage::setPixels(int8_t level, int32_t x, int32_t y, int32_t width, int32_t height, 
+        const void *pixels, int32_t layer)
+    {
+        SDL_assert(x >= 0 && y >= 0 && width > 0 && height > 0);
+        SDL_assert(x + width <= lite3d_texture_unit_get_level_width(&mTexture, level, 0));
+        SDL_assert(y + height <= lite3d_texture_unit_get_level_height(&mTexture, level, 0));
+
+        if(!lite3d_texture_unit_set_pixels(&mTexture, x, y, layer, width, height, 1, level, 0, pixels))
+            LITE3D_THROW("Could`n set region of level " << level << " for texture " << getName());
+
+        mModified = true;
+        mUploadedBytes += static_cast<uint64_t>(width) * height * mTexture.imageBPP;
     }
 
     void TextureImage::getCompressedPixels(int8_t level, PixelsData &pixels) const
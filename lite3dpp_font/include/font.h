@@ -187,7 +187,8 @@ namespace nw
             void deselect();
 
             Rect<int> rect();
-            void render(Texture& _texture);
+            // Returns bounds of touched pixels, also marked dirty in _texture
+            Rect<int> render(Texture& _texture);
 
         private:
             void validate();
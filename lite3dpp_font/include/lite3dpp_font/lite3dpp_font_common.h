@@ -40,4 +40,5 @@ namespace nw
     class Font;
     class Text;
     class Texture;
+    class DirtyRects;
 }
\ No newline at end of file
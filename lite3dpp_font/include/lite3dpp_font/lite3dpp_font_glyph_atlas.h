@@ -0,0 +1,217 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_texture.h>
+#include <lite3dpp_font/lite3dpp_font_common.h>
+
+namespace lite3dpp
+{
+    namespace lite3dpp_font
+    {
+        struct AtlasRect
+        {
+            int32_t x = 0;
+            int32_t y = 0;
+            int32_t width = 0;
+            int32_t height = 0;
+
+            inline bool empty() const
+            { return width <= 0 || height <= 0; }
+            /* Прямоугольник, покрывающий оба */
+            void merge(const AtlasRect &rect);
+        };
+
+        /* Упаковка прямоугольников полками: полка получает высоту первого глифа, следующие глифы 
+           кладутся в полку с наименьшей лишней высотой, новая полка открывается под последней. 
+           Глифы одного шрифта мало отличаются по высоте, поэтому потери площади небольшие. */
+        class LITE3DPP_FONT_EXPORT ShelfPacker
+        {
+        public:
+
+            ShelfPacker(int32_t width, int32_t height, int32_t padding = 1);
+
+            /* false если места нет */
+            bool insert(int32_t width, int32_t height, AtlasRect &rect);
+            void clear();
+
+            inline int32_t getWidth() const
+            { return mWidth; }
+            inline int32_t getHeight() const
+            { return mHeight; }
+            inline size_t shelvesCount() const
+            { return mShelves.size(); }
+            inline uint64_t usedArea() const
+            { return mUsedArea; }
+
+        private:
+
+            struct Shelf
+            {
+                int32_t y;
+                int32_t height;
+                int32_t x;
+            };
+
+            int32_t mWidth;
+            int32_t mHeight;
+            int32_t mPadding;
+            int32_t mNextY = 0;
+            uint64_t mUsedArea = 0;
+            stl<Shelf>::vector mShelves;
+        };
+
+        struct GlyphInfo
+        {
+            /* Место в странице, пустой у пробелов */
+            AtlasRect rect;
+            uint32_t page = 0;
+            /* От пера до левого края и от базовой линии до верхнего края битмапа, пиксели */
+            int32_t bearingX = 0;
+            int32_t bearingY = 0;
+            float advance = 0.0f;
+        };
+
+        /* CPU часть атласа: 8-битные страницы покрытия, упаковка и грязные области страниц.
+           Грязная область выровнена по 4 пикселя по x, чтобы строки выгрузки были выровнены по 4 байта. */
+        class LITE3DPP_FONT_EXPORT GlyphAtlasPages : public Noncopiable
+        {
+        public:
+
+            GlyphAtlasPages(int32_t pageSize, uint32_t maxPages, int32_t padding = 1);
+
+            /* Копирует битмап глифа в страницу, nullptr если все страницы заполнены */
+            const GlyphInfo *add(uint32_t key, const uint8_t *bitmap, int32_t width, int32_t height, int32_t pitch,
+                int32_t bearingX, int32_t bearingY, float advance);
+            const GlyphInfo *find(uint32_t key) const;
+            void clear();
+
+            inline int32_t getPageSize() const
+            { return mPageSize; }
+            inline uint32_t pagesCount() const
+            { return static_cast<uint32_t>(mPages.size()); }
+            inline uint32_t getMaxPages() const
+            { return mMaxPages; }
+            inline size_t glyphsCount() const
+            { return mGlyphs.size(); }
+
+            const uint8_t *pageData(uint32_t page) const;
+            const AtlasRect &dirtyRect(uint32_t page) const;
+            bool hasDirty() const;
+            void clearDirty();
+            /* Строки прямоугольника страницы подряд, для выгрузки части текстуры */
+            void copyRect(uint32_t page, const AtlasRect &rect, stl<uint8_t>::vector &out) const;
+
+        private:
+
+            struct Page
+            {
+                Page(int32_t size, int32_t padding) : 
+                    packer(size, size, padding)
+                {}
+
+                ShelfPacker packer;
+                stl<uint8_t>::vector pixels;
+                AtlasRect dirty;
+            };
+
+            void markDirty(Page &page, const AtlasRect &rect);
+
+            int32_t mPageSize;
+            uint32_t mMaxPages;
+            int32_t mPadding;
+            stl<Page>::vector mPages;
+            stl<uint32_t, GlyphInfo>::unordered_map mGlyphs;
+        };
+
+        /* Источник метрик глифов для раскладки текста */
+        class LITE3DPP_FONT_EXPORT GlyphSource
+        {
+        public:
+
+            virtual ~GlyphSource() = default;
+
+            /* nullptr если глифа нет и добавить его некуда */
+            virtual const GlyphInfo *glyph(char32_t codepoint) = 0;
+            virtual float kerning(char32_t left, char32_t right)
+            { return 0.0f; }
+            virtual float lineHeight() const = 0;
+            virtual float ascender() const = 0;
+            virtual int32_t pageSize() const = 0;
+        };
+
+        /* Атлас глифов шрифта: глифы растеризуются один раз через кеш FTC в страницы 
+           текстуры 2D_ARRAY (формат RED), изменения выгружаются только грязными прямоугольниками. */
+        class LITE3DPP_FONT_EXPORT GlyphAtlas : public GlyphSource, public Noncopiable
+        {
+        public:
+
+            struct Stats
+            {
+                uint64_t glyphsRasterized = 0;
+                uint64_t glyphsMissing = 0;
+                uint64_t uploads = 0;
+                uint64_t bytesUploaded = 0;
+            };
+
+            GlyphAtlas(Main &main, const String &name, const String &fontPath, int32_t fontSize, 
+                int32_t pageSize = 512, uint32_t maxPages = 4);
+            ~GlyphAtlas();
+
+            /* nullptr если глифа нет в шрифте или он не поместился в атлас, результат запоминается */
+            const GlyphInfo *glyph(char32_t codepoint) override;
+            float kerning(char32_t left, char32_t right) override;
+            inline float lineHeight() const override
+            { return mLineHeight; }
+            inline float ascender() const override
+            { return mAscender; }
+            inline int32_t pageSize() const override
+            { return mPages.getPageSize(); }
+
+            /* Выгрузка грязных прямоугольников страниц, возвращает число байт */
+            size_t uploadChanges();
+
+            inline TextureImage *getTexture()
+            { return mTexture; }
+            inline const GlyphAtlasPages &getPages() const
+            { return mPages; }
+            inline const Stats &getStats() const
+            { return mStats; }
+
+        private:
+
+            const GlyphInfo *missing(char32_t codepoint);
+
+        private:
+
+            static nw::FontLib gFontLib;
+            Main &mMain;
+            GlyphAtlasPages mPages;
+            stl<uint8_t>::vector mFontBuffer;
+            std::unique_ptr<nw::Font> mFont;
+            TextureImage *mTexture = nullptr;
+            float mLineHeight = 0.0f;
+            float mAscender = 0.0f;
+            stl<uint8_t>::vector mUploadBuffer;
+            /* Глифы, которые не удалось растеризовать или разместить, повторно не пробуем */
+            stl<char32_t>::unordered_set mMissing;
+            Stats mStats;
+        };
+    }
+}
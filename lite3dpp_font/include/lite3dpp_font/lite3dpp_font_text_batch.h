@@ -0,0 +1,117 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <string_view>
+
+#include <lite3dpp/lite3dpp_buffer_dirty_ranges.h>
+#include <lite3dpp_font/lite3dpp_font_glyph_atlas.h>
+
+namespace lite3dpp
+{
+    namespace lite3dpp_font
+    {
+        /* Один глиф текста, экземпляр квада. Раскладка std430: шейдер читает массив из SSBO по gl_InstanceID */
+        struct GlyphQuad
+        {
+            /* x, y левого верхнего угла, ширина, высота в пикселях, y вниз */
+            kmVec4 rect;
+            /* u0, v0, u1, v1 в странице атласа */
+            kmVec4 uv;
+            /* RGBA8 */
+            uint32_t color;
+            uint32_t page;
+            uint32_t padding[2];
+        };
+
+        static_assert(sizeof(GlyphQuad) == 48, "GlyphQuad must match std430 layout");
+
+        class LITE3DPP_FONT_EXPORT TextLayout
+        {
+        public:
+
+            static uint32_t packColor(const kmVec4 &color);
+
+            /* Раскладка utf-8 строки в кварды начиная с pos (левый верхний угол), 
+               maxWidth > 0 переносит строку на глифе, не влезающем в ширину.
+               Возвращает число квадов, не больше capacity. Пробелы квадов не дают. */
+            static size_t layout(GlyphSource &source, const std::string_view &text, const kmVec2 &pos, 
+                uint32_t color, float maxWidth, GlyphQuad *quads, size_t capacity);
+        };
+
+        /* Поток квадов многих надписей. Надпись занимает постоянный отрезок из maxGlyphs квадов, 
+           поэтому смена текста пересчитывает и выгружает только отрезок этой надписи. 
+           Неиспользуемые квады нулевого размера, рисуется quadsCount экземпляров одного квада. */
+        class LITE3DPP_FONT_EXPORT TextBatch : public Noncopiable
+        {
+        public:
+
+            using LabelId = uint32_t;
+
+            struct Stats
+            {
+                uint64_t labelsChanged = 0;
+                uint64_t labelsUnchanged = 0;
+                uint64_t glyphsLaidOut = 0;
+            };
+
+            explicit TextBatch(GlyphSource &source);
+
+            LabelId addLabel(uint32_t maxGlyphs);
+            /* Пересчитывает надпись только если изменились текст, позиция, цвет или ширина */
+            void setLabel(LabelId label, const std::string_view &text, const kmVec2 &pos, const kmVec4 &color, 
+                float maxWidth = 0.0f);
+            void hideLabel(LabelId label);
+
+            inline const stl<GlyphQuad>::vector &getQuads() const
+            { return mQuads; }
+            inline uint32_t quadsCount() const
+            { return static_cast<uint32_t>(mQuads.size()); }
+            inline const BufferDirtyRanges &getDirtyRanges() const
+            { return mDirty; }
+            inline const Stats &getStats() const
+            { return mStats; }
+
+            /* Выгрузка измененных отрезков, буфер растет при добавлении надписей. Возвращает число байт */
+            size_t upload(BufferBase &buffer);
+
+        private:
+
+            struct Label
+            {
+                uint32_t first;
+                uint32_t capacity;
+                uint32_t used = 0;
+                String text;
+                kmVec2 pos = KM_VEC2_ZERO;
+                uint32_t color = 0;
+                float maxWidth = 0.0f;
+                bool visible = false;
+            };
+
+            void replaceQuads(Label &label, size_t count);
+
+            GlyphSource &mSource;
+            stl<Label>::vector mLabels;
+            stl<GlyphQuad>::vector mQuads;
+            stl<GlyphQuad>::vector mScratch;
+            BufferDirtyRanges mDirty;
+            Stats mStats;
+        };
+    }
+}
@@ -28,17 +28,31 @@ namespace lite3dpp
         {
         public:
 
+            struct Stats
+            {
+                /* Вызовы setPixels */
+                uint64_t uploads = 0;
+                uint64_t bytesUploaded = 0;
+                /* Сколько заняли бы те же обновления при выгрузке всего уровня 0 */
+                uint64_t fullLevelBytes = 0;
+            };
+
             FontTexture(const String &name,
                 const String &path, Main &main);
 
             ~FontTexture();
             
+            /* Тем же цветом очищаются только места, где был текст */
             void clean(const kmVec4 &color);
             void clean();
+            /* Выгружает только измененные прямоугольники и пересчитывает мипы только в них */
             void uploadChanges();
 
             void drawText(const std::string_view &text, const kmVec2 &pos, const kmVec4 &color);
 
+            inline const Stats &getStats() const
+            { return mStats; }
+
         protected:
 
             virtual void loadFromConfigImpl(const ConfigurationReader &helper) override;
@@ -52,6 +66,19 @@ namespace lite3dpp
             std::unique_ptr<nw::Text> mText;
             std::unique_ptr<nw::Texture> mTexBuf;
             stl<uint8_t>::vector mFontBuffer; 
+
+            void uploadRect(int8_t level, const nw::Texture &source, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+            void rebuildMips();
+
+            /* Копии уровней мипов 1..N в памяти, из них считаются измененные области */
+            stl<std::unique_ptr<nw::Texture>>::vector mMips;
+            bool mMipsValid = false;
+            /* Где нарисован текст после последней очистки */
+            std::unique_ptr<nw::DirtyRects> mDrawn;
+            kmVec4 mBlankColor = KM_VEC4_ZERO;
+            bool mBlankValid = false;
+            stl<uint8_t>::vector mStaging;
+            Stats mStats;
         };
     }
 }
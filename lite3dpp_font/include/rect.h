@@ -24,6 +24,12 @@ namespace nw
                 && y1 == 0;
         }
 
+        // Inclusive bounds, x1 < x0 means no pixels
+        bool empty() const
+        {
+            return x1 < x0 || y1 < y0;
+        }
+
         bool inside(T _x, T _y) const
         {
             return _x >= x0 && _x <= x1
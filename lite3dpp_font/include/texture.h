@@ -1,6 +1,7 @@
 #ifndef NWE_TEXTURE_H
 #define NWE_TEXTURE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <vector>
 
@@ -31,6 +32,30 @@ namespace nw
         }
     };
 
+    // Union of changed areas as a few rectangles. Touching or overlapping rectangles
+    // are merged, above MaxRects the pair with the smallest bounding growth is merged.
+    class DirtyRects
+    {
+        public:
+            typedef std::vector<Rect<int> > Rects;
+            static const size_t MaxRects = 8;
+
+        private:
+            Rects m_rects;
+
+        public:
+            void add(const Rect<int>& _rect);
+            void clear();
+
+            bool empty() const;
+            const Rects& rects() const;
+            // Pixels covered by rectangles, rectangles never overlap
+            size_t area() const;
+            Rect<int> bounds() const;
+
+            static size_t area(const Rect<int>& _rect);
+    };
+
     class Texture
     {
         public:
@@ -40,6 +65,7 @@ namespace nw
             int m_width;
             int m_height;
             Data m_data;
+            DirtyRects m_dirty;
 
         public:
             Texture();
@@ -58,6 +84,13 @@ namespace nw
             RGBA& pixel(int _x, int _y);
 
             void sub(const Texture& _texture, int _x, int _y);
+            // Box filter of _src area (inclusive, in _src pixels) into this texture of half size
+            void downsample(const Texture& _src, const Rect<int>& _srcRect);
+
+            // Changed areas since clearDirty, fill/sub/downsample/Text::render mark them
+            void markDirty(const Rect<int>& _rect);
+            const DirtyRects& dirty() const;
+            void clearDirty();
 
             bool operator==(const Texture& _r);
             bool operator!=(const Texture& _r);
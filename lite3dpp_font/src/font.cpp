@@ -25,7 +25,9 @@ namespace
         nw::RGBA color;
         nw::Texture* pTexture;
         const nw::Rect<int>* pRect;
-        User() : pos(0, 0), color(), pTexture(NULL), pRect(NULL) {}
+        // Bounds of touched pixels
+        nw::Rect<int> drawn;
+        User() : pos(0, 0), color(), pTexture(NULL), pRect(NULL), drawn(0, 0, -1, -1) {}
     };
 
     void RasterCallback(
@@ -45,6 +47,16 @@ namespace
             if (!pUser->pTexture || py < 0 || py >= pUser->pTexture->height())
                 continue;
 
+            int x0 = std::max(0, pSpan->x + pUser->pos.x);
+            int x1 = std::min(pUser->pTexture->width() - 1, pSpan->x + pSpan->len - 1 + pUser->pos.x);
+            if (x0 <= x1)
+            {
+                if (pUser->drawn.empty())
+                    pUser->drawn.set(x0, py, x1, py);
+                else
+                    pUser->drawn.include(x0, py, x1, py);
+            }
+
             for (int x = 0; x < pSpan->len; ++x)
             {
                 int px = pSpan->x + x + pUser->pos.x;
@@ -499,7 +511,7 @@ namespace nw
         return ret;
     }
 
-    void Text::render(Texture& _texture)
+    Rect<int> Text::render(Texture& _texture)
     {
         validate();
 
@@ -555,6 +567,9 @@ namespace nw
                 &reinterpret_cast<FT_OutlineGlyph>(*it)->outline,
                 &params);
         }
+
+        _texture.markDirty(user.drawn);
+        return user.drawn;
     }
 
     void Text::validate()
@@ -0,0 +1,367 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <font.h>
+
+#include <algorithm>
+#include <cstring>
+#include <SDL_assert.h>
+#include <SDL_log.h>
+
+#include <lite3dpp/lite3dpp_main.h>
+#include <lite3dpp/lite3dpp_config_writer.h>
+#include <lite3dpp_font/lite3dpp_font_glyph_atlas.h>
+
+nw::FontLib lite3dpp::lite3dpp_font::GlyphAtlas::gFontLib;
+
+namespace lite3dpp
+{
+    namespace lite3dpp_font
+    {
+        void AtlasRect::merge(const AtlasRect &rect)
+        {
+            if (rect.empty())
+                return;
+            if (empty())
+            {
+                *this = rect;
+                return;
+            }
+
+            int32_t x1 = std::max(x + width, rect.x + rect.width);
+            int32_t y1 = std::max(y + height, rect.y + rect.height);
+            x = std::min(x, rect.x);
+            y = std::min(y, rect.y);
+            width = x1 - x;
+            height = y1 - y;
+        }
+
+        ShelfPacker::ShelfPacker(int32_t width, int32_t height, int32_t padding) : 
+            mWidth(width),
+            mHeight(height),
+            mPadding(padding)
+        {
+            SDL_assert(width > 0 && height > 0 && padding >= 0);
+        }
+
+        bool ShelfPacker::insert(int32_t width, int32_t height, AtlasRect &rect)
+        {
+            rect = AtlasRect();
+            if (width <= 0 || height <= 0)
+                return true;
+
+            int32_t paddedWidth = width + mPadding, paddedHeight = height + mPadding;
+            if (paddedWidth > mWidth)
+                return false;
+
+            Shelf *best = nullptr;
+            for (auto &shelf : mShelves)
+            {
+                if (shelf.height >= paddedHeight && mWidth - shelf.x >= paddedWidth && 
+                    (!best || shelf.height < best->height))
+                {
+                    best = &shelf;
+                }
+            }
+
+            /* Мелкий глиф в высокой полке теряет площадь, лучше открыть новую пока есть место */
+            bool newShelfFits = mNextY + paddedHeight <= mHeight;
+            if (!best || (best->height > paddedHeight + paddedHeight / 2 && newShelfFits))
+            {
+                if (!newShelfFits)
+                    return false;
+
+                mShelves.push_back({ mNextY, paddedHeight, 0 });
+                mNextY += paddedHeight;
+                best = &mShelves.back();
+            }
+
+            rect = { best->x, best->y, width, height };
+            best->x += paddedWidth;
+            mUsedArea += static_cast<uint64_t>(width) * height;
+            return true;
+        }
+
+        void ShelfPacker::clear()
+        {
+            mShelves.clear();
+            mNextY = 0;
+            mUsedArea = 0;
+        }
+
+        GlyphAtlasPages::GlyphAtlasPages(int32_t pageSize, uint32_t maxPages, int32_t padding) : 
+            mPageSize(pageSize),
+            mMaxPages(maxPages),
+            mPadding(padding)
+        {
+            SDL_assert(pageSize > 0 && (pageSize % 4) == 0);
+            SDL_assert(maxPages > 0);
+        }
+
+        const GlyphInfo *GlyphAtlasPages::add(uint32_t key, const uint8_t *bitmap, int32_t width, int32_t height, 
+            int32_t pitch, int32_t bearingX, int32_t bearingY, float advance)
+        {
+            auto it = mGlyphs.find(key);
+            if (it != mGlyphs.end())
+                return &it->second;
+
+            GlyphInfo info;
+            info.bearingX = bearingX;
+            info.bearingY = bearingY;
+            info.advance = advance;
+
+            if (width > 0 && height > 0)
+            {
+                SDL_assert(bitmap);
+                uint32_t pageIndex = 0;
+                for (; pageIndex < mPages.size(); ++pageIndex)
+                {
+                    if (mPages[pageIndex].packer.insert(width, height, info.rect))
+                        break;
+                }
+
+                if (pageIndex == mPages.size())
+                {
+                    if (mPages.size() == mMaxPages)
+                        return nullptr;
+
+                    mPages.emplace_back(mPageSize, mPadding);
+                    mPages.back().pixels.assign(static_cast<size_t>(mPageSize) * mPageSize, 0);
+                    if (!mPages.back().packer.insert(width, height, info.rect))
+                    {
+                        /* глиф больше страницы */
+                        mPages.pop_back();
+                        return nullptr;
+                    }
+                }
+
+                Page &page = mPages[pageIndex];
+                info.page = pageIndex;
+                for (int32_t row = 0; row < height; ++row)
+                {
+                    /* у FreeType отрицательный pitch значит строки снизу вверх */
+                    const uint8_t *src = pitch >= 0 ? bitmap + static_cast<ptrdiff_t>(row) * pitch : 
+                        bitmap + static_cast<ptrdiff_t>(height - 1 - row) * -pitch;
+                    std::memcpy(&page.pixels[static_cast<size_t>(info.rect.y + row) * mPageSize + info.rect.x], src, width);
+                }
+
+                markDirty(page, info.rect);
+            }
+
+            return &mGlyphs.emplace(key, info).first->second;
+        }
+
+        const GlyphInfo *GlyphAtlasPages::find(uint32_t key) const
+        {
+            auto it = mGlyphs.find(key);
+            return it != mGlyphs.end() ? &it->second : nullptr;
+        }
+
+        void GlyphAtlasPages::clear()
+        {
+            mPages.clear();
+            mGlyphs.clear();
+        }
+
+        const uint8_t *GlyphAtlasPages::pageData(uint32_t page) const
+        {
+            SDL_assert(page < mPages.size());
+            return mPages[page].pixels.data();
+        }
+
+        const AtlasRect &GlyphAtlasPages::dirtyRect(uint32_t page) const
+        {
+            SDL_assert(page < mPages.size());
+            return mPages[page].dirty;
+        }
+
+        bool GlyphAtlasPages::hasDirty() const
+        {
+            return std::any_of(mPages.begin(), mPages.end(), [](const Page &page) { return !page.dirty.empty(); });
+        }
+
+        void GlyphAtlasPages::clearDirty()
+        {
+            for (auto &page : mPages)
+                page.dirty = AtlasRect();
+        }
+
+        void GlyphAtlasPages::copyRect(uint32_t page, const AtlasRect &rect, stl<uint8_t>::vector &out) const
+        {
+            SDL_assert(page < mPages.size());
+            SDL_assert(rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= mPageSize && rect.y + rect.height <= mPageSize);
+            out.resize(static_cast<size_t>(rect.width) * rect.height);
+            for (int32_t row = 0; row < rect.height; ++row)
+            {
+                std::memcpy(&out[static_cast<size_t>(row) * rect.width], 
+                    &mPages[page].pixels[static_cast<size_t>(rect.y + row) * mPageSize + rect.x], rect.width);
+            }
+        }
+
+        void GlyphAtlasPages::markDirty(Page &page, const AtlasRect &rect)
+        {
+            AtlasRect aligned;
+            aligned.x = rect.x & ~3;
+            aligned.y = rect.y;
+            aligned.width = std::min((rect.x + rect.width + 3) & ~3, mPageSize) - aligned.x;
+            aligned.height = rect.height;
+            page.dirty.merge(aligned);
+        }
+
+        GlyphAtlas::GlyphAtlas(Main &main, const String &name, const String &fontPath, int32_t fontSize, 
+            int32_t pageSize, uint32_t maxPages) : 
+            mMain(main),
+            mPages(pageSize, maxPages)
+        {
+            const lite3d_file *fontFile = mMain.getResourceManager().loadFileToMemory(fontPath);
+            mFontBuffer.assign(static_cast<const uint8_t *>(fontFile->fileBuff), 
+                static_cast<const uint8_t *>(fontFile->fileBuff) + fontFile->fileSize);
+            mFont = std::make_unique<nw::Font>(gFontLib, fontPath, mFontBuffer.data(), 
+                static_cast<signed long>(mFontBuffer.size()), fontSize);
+
+            FT_Size size;
+            if (FTC_Manager_LookupSize(gFontLib.manager(), const_cast<FTC_Scaler>(&mFont->scaler()), &size) == 0)
+            {
+                mLineHeight = size->metrics.height / 64.0f;
+                mAscender = size->metrics.ascender / 64.0f;
+            }
+            else
+            {
+                mLineHeight = mAscender = static_cast<float>(fontSize);
+            }
+
+            ConfigurationWriter textureConfig;
+            textureConfig.set(L"TextureType", "2D_ARRAY")
+                .set(L"Width", pageSize)
+                .set(L"Height", pageSize)
+                .set(L"Depth", static_cast<int32_t>(maxPages))
+                .set(L"Filtering", "Linear")
+                .set(L"Wrapping", "ClampToEdge")
+                .set(L"Compression", false)
+                .set(L"TextureFormat", "RED")
+                .set(L"InternalFormat", "R8");
+
+            mTexture = mMain.getResourceManager().queryResourceFromJson<TextureImage>(name + ".texture", 
+                textureConfig.write());
+        }
+
+        GlyphAtlas::~GlyphAtlas()
+        {
+            if (mTexture)
+                mMain.getResourceManager().releaseResource(mTexture->getName());
+        }
+
+        const GlyphInfo *GlyphAtlas::glyph(char32_t codepoint)
+        {
+            if (auto info = mPages.find(codepoint))
+                return info;
+            if (mMissing.count(codepoint))
+                return nullptr;
+
+            FT_UInt index = FT_Get_Char_Index(mFont->face(), codepoint);
+            FT_Glyph glyph;
+            if (FTC_ImageCache_LookupScaler(gFontLib.imageCache(), const_cast<FTC_Scaler>(&mFont->scaler()), 
+                FT_LOAD_RENDER, index, &glyph, NULL) != 0)
+            {
+                return missing(codepoint);
+            }
+
+            /* Глиф принадлежит кешу, контурный переводим в битмап на копии */
+            bool owned = false;
+            if (glyph->format != FT_GLYPH_FORMAT_BITMAP)
+            {
+                FT_Glyph copy;
+                if (FT_Glyph_Copy(glyph, &copy) != 0)
+                    return missing(codepoint);
+                /* при ошибке исходный глиф не освобождается */
+                if (FT_Glyph_To_Bitmap(&copy, FT_RENDER_MODE_NORMAL, nullptr, 1) != 0)
+                {
+                    FT_Done_Glyph(copy);
+                    return missing(codepoint);
+                }
+
+                glyph = copy;
+                owned = true;
+            }
+
+            auto bitmapGlyph = reinterpret_cast<FT_BitmapGlyph>(glyph);
+            const FT_Bitmap &bitmap = bitmapGlyph->bitmap;
+            const GlyphInfo *info = nullptr;
+            if (bitmap.pixel_mode == FT_PIXEL_MODE_GRAY || bitmap.rows == 0 || bitmap.width == 0)
+            {
+                info = mPages.add(codepoint, bitmap.buffer, static_cast<int32_t>(bitmap.width), 
+                    static_cast<int32_t>(bitmap.rows), bitmap.pitch, bitmapGlyph->left, bitmapGlyph->top, 
+                    glyph->advance.x / 65536.0f);
+            }
+
+            if (owned)
+                FT_Done_Glyph(glyph);
+
+            if (!info)
+            {
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "GlyphAtlas: no place for glyph 0x%x", 
+                    static_cast<uint32_t>(codepoint));
+                return missing(codepoint);
+            }
+
+            mStats.glyphsRasterized++;
+            return info;
+        }
+
+        const GlyphInfo *GlyphAtlas::missing(char32_t codepoint)
+        {
+            mMissing.insert(codepoint);
+            mStats.glyphsMissing++;
+            return nullptr;
+        }
+
+        float GlyphAtlas::kerning(char32_t left, char32_t right)
+        {
+            if (!mFont->hasKerning())
+                return 0.0f;
+
+            FT_Vector delta;
+            if (FT_Get_Kerning(mFont->face(), FT_Get_Char_Index(mFont->face(), left), 
+                FT_Get_Char_Index(mFont->face(), right), FT_KERNING_DEFAULT, &delta) != 0)
+                return 0.0f;
+
+            return delta.x / 64.0f;
+        }
+
+        size_t GlyphAtlas::uploadChanges()
+        {
+            SDL_assert(mTexture);
+            size_t bytes = 0;
+            for (uint32_t page = 0; page < mPages.pagesCount(); ++page)
+            {
+                const AtlasRect &rect = mPages.dirtyRect(page);
+                if (rect.empty())
+                    continue;
+
+                mPages.copyRect(page, rect, mUploadBuffer);
+                mTexture->setPixels(0, rect.x, rect.y, rect.width, rect.height, mUploadBuffer.data(), page);
+
+                bytes += mUploadBuffer.size();
+                mStats.uploads++;
+            }
+
+            mPages.clearDirty();
+            mStats.bytesUploaded += bytes;
+            return bytes;
+        }
+    }
+}
@@ -0,0 +1,210 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp_font/lite3dpp_font_text_batch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <SDL_assert.h>
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push 
+#pragma GCC diagnostic ignored "-Wshadow"
+#   include <utf8.h>
+#pragma GCC diagnostic pop
+#else
+#   include <utf8.h>
+#endif
+
+namespace lite3dpp
+{
+    namespace lite3dpp_font
+    {
+        uint32_t TextLayout::packColor(const kmVec4 &color)
+        {
+            auto channel = [](float value) 
+            { 
+                return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); 
+            };
+
+            return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+        }
+
+        size_t TextLayout::layout(GlyphSource &source, const std::string_view &text, const kmVec2 &pos, 
+            uint32_t color, float maxWidth, GlyphQuad *quads, size_t capacity)
+        {
+            SDL_assert(quads || capacity == 0);
+            const float texel = 1.0f / static_cast<float>(source.pageSize());
+            float penX = pos.x;
+            float baseline = pos.y + source.ascender();
+            char32_t prev = 0;
+            size_t count = 0;
+
+            auto it = text.begin();
+            while (it != text.end() && count < capacity)
+            {
+                char32_t codepoint;
+                try
+                {
+                    codepoint = utf8::next(it, text.end());
+                }
+                catch (const utf8::exception &)
+                {
+                    /* Битая строка, показываем то что успели разобрать */
+                    break;
+                }
+
+                if (codepoint == '\n')
+                {
+                    penX = pos.x;
+                    baseline += source.lineHeight();
+                    prev = 0;
+                    continue;
+                }
+
+                const GlyphInfo *glyph = source.glyph(codepoint);
+                if (!glyph)
+                {
+                    prev = 0;
+                    continue;
+                }
+
+                if (prev)
+                    penX += source.kerning(prev, codepoint);
+
+                if (maxWidth > 0.0f && penX > pos.x && penX + glyph->advance > pos.x + maxWidth)
+                {
+                    penX = pos.x;
+                    baseline += source.lineHeight();
+                }
+
+                if (!glyph->rect.empty())
+                {
+                    GlyphQuad &quad = quads[count++];
+                    quad.rect.x = std::round(penX) + static_cast<float>(glyph->bearingX);
+                    quad.rect.y = std::round(baseline) - static_cast<float>(glyph->bearingY);
+                    quad.rect.z = static_cast<float>(glyph->rect.width);
+                    quad.rect.w = static_cast<float>(glyph->rect.height);
+                    quad.uv.x = glyph->rect.x * texel;
+                    quad.uv.y = glyph->rect.y * texel;
+                    quad.uv.z = (glyph->rect.x + glyph->rect.width) * texel;
+                    quad.uv.w = (glyph->rect.y + glyph->rect.height) * texel;
+                    quad.color = color;
+                    quad.page = glyph->page;
+                    quad.padding[0] = quad.padding[1] = 0;
+                }
+
+                penX += glyph->advance;
+                prev = codepoint;
+            }
+
+            return count;
+        }
+
+        TextBatch::TextBatch(GlyphSource &source) : 
+            mSource(source),
+            mDirty(sizeof(GlyphQuad))
+        {}
+
+        TextBatch::LabelId TextBatch::addLabel(uint32_t maxGlyphs)
+        {
+            Label label;
+            label.first = static_cast<uint32_t>(mQuads.size());
+            label.capacity = maxGlyphs;
+            mLabels.push_back(label);
+
+            mQuads.resize(mQuads.size() + maxGlyphs, GlyphQuad{});
+            mDirty.resize(mQuads.size());
+            if (maxGlyphs > 0)
+                mDirty.markDirty(label.first, maxGlyphs);
+            return static_cast<LabelId>(mLabels.size() - 1);
+        }
+
+        void TextBatch::setLabel(LabelId id, const std::string_view &text, const kmVec2 &pos, const kmVec4 &color, 
+            float maxWidth)
+        {
+            SDL_assert(id < mLabels.size());
+            Label &label = mLabels[id];
+            uint32_t packedColor = TextLayout::packColor(color);
+            if (label.visible && label.color == packedColor && label.maxWidth == maxWidth && 
+                label.pos.x == pos.x && label.pos.y == pos.y && label.text == text)
+            {
+                mStats.labelsUnchanged++;
+                return;
+            }
+
+            label.visible = true;
+            label.color = packedColor;
+            label.maxWidth = maxWidth;
+            label.pos = pos;
+            label.text.assign(text);
+
+            mScratch.resize(label.capacity);
+            size_t count = TextLayout::layout(mSource, text, pos, packedColor, maxWidth, mScratch.data(), label.capacity);
+            replaceQuads(label, count);
+            mStats.labelsChanged++;
+            mStats.glyphsLaidOut += count;
+        }
+
+        void TextBatch::hideLabel(LabelId id)
+        {
+            SDL_assert(id < mLabels.size());
+            Label &label = mLabels[id];
+            if (!label.visible)
+                return;
+
+            label.visible = false;
+            label.text.clear();
+            replaceQuads(label, 0);
+        }
+
+        void TextBatch::replaceQuads(Label &label, size_t count)
+        {
+            static const GlyphQuad empty = {};
+            size_t touched = std::max<size_t>(count, label.used);
+            for (size_t i = 0; i < touched; ++i)
+            {
+                const GlyphQuad &quad = i < count ? mScratch[i] : empty;
+                GlyphQuad &target = mQuads[label.first + i];
+                /* Обычно меняется пара цифр, остальные глифы надписи на месте и не выгружаются */
+                if (std::memcmp(&target, &quad, sizeof(GlyphQuad)) != 0)
+                {
+                    target = quad;
+                    mDirty.markDirty(label.first + i);
+                }
+            }
+
+            label.used = static_cast<uint32_t>(count);
+        }
+
+        size_t TextBatch::upload(BufferBase &buffer)
+        {
+            size_t required = mQuads.size() * sizeof(GlyphQuad);
+            if (buffer.bufferSizeBytes() < required)
+            {
+                buffer.extendBufferBytes(required - buffer.bufferSizeBytes());
+                mDirty.markAllDirty();
+            }
+
+            if (!mDirty.hasDirty())
+                return 0;
+
+            return mDirty.flush(buffer, mQuads.data());
+        }
+    }
+}
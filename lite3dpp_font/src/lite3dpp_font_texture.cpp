@@ -15,6 +15,9 @@
  *	You should have received a copy of the GNU General Public License
  *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
  *******************************************************************************/
+#include <algorithm>
+#include <cstring>
+
 #include <font.h>
 #include <texture.h>
 #include <log/logger.h>
@@ -65,7 +68,8 @@ namespace lite3dpp
         FontTexture::FontTexture(const String &name,
             const String &path, Main &main) : 
             TextureImage(name, path, main),
-            mTexBuf(new nw::Texture())
+            mTexBuf(new nw::Texture()),
+            mDrawn(new nw::DirtyRects())
         {
             gFontLib.setLogger(&gFontLibLogger);
         }
@@ -103,6 +107,8 @@ namespace lite3dpp
                 mText->setLogger(&gFontLibLogger);
                 mTexBuf->resize(getWidth(), getHeight());
             }
+
+            mMipsValid = false;
         }
         
         void FontTexture::reloadFromConfigImpl(const ConfigurationReader &helper)
@@ -117,21 +123,114 @@ namespace lite3dpp
         
         void FontTexture::clean(const kmVec4 &color)
         {
-            mTexBuf->fill(nw::RGBA(color.x * 255,
+            nw::RGBA blank(color.x * 255,
                 color.y * 255, 
                 color.z * 255, 
-                color.w * 255));
+                color.w * 255);
+
+            if (mBlankValid && std::memcmp(&mBlankColor, &color, sizeof(kmVec4)) == 0)
+            {
+                /* Вне нарисованного текста буфер уже этого цвета */
+                for (const auto &rect : mDrawn->rects())
+                    mTexBuf->fill(blank, rect);
+            }
+            else
+            {
+                mTexBuf->fill(blank);
+                mBlankColor = color;
+                mBlankValid = true;
+            }
+
+            mDrawn->clear();
         }
             
         void FontTexture::clean()
         {
             clean(getJson().getVec4(L"BlankColor"));
         }
+
+        void FontTexture::uploadRect(int8_t level, const nw::Texture &source, int32_t x0, int32_t y0, 
+            int32_t x1, int32_t y1)
+        {
+            int32_t width = x1 - x0 + 1, height = y1 - y0 + 1;
+            size_t rowSize = width * sizeof(nw::RGBA);
+            mStaging.resize(rowSize * height);
+            for (int32_t row = 0; row < height; ++row)
+            {
+                std::memcpy(&mStaging[row * rowSize], &source.data()[(y0 + row) * source.width() + x0], rowSize);
+            }
+
+            setPixels(level, x0, y0, width, height, mStaging.data());
+            mStats.uploads++;
+            mStats.bytesUploaded += mStaging.size();
+        }
+
+        void FontTexture::rebuildMips()
+        {
+            mMips.resize(getTotalLevels() - 1);
+            const nw::Texture *source = mTexBuf.get();
+            for (size_t i = 0; i < mMips.size(); ++i)
+            {
+                if (!mMips[i])
+                    mMips[i].reset(new nw::Texture());
+
+                mMips[i]->resize(std::max(1, source->width() / 2), std::max(1, source->height() / 2));
+                mMips[i]->downsample(*source, nw::Rect<int>(0, 0, source->width() - 1, source->height() - 1));
+                mMips[i]->clearDirty();
+                source = mMips[i].get();
+            }
+
+            mMipsValid = true;
+        }
         
         void FontTexture::uploadChanges()
         {
-            setPixels(0, &mTexBuf->data()[0]);
-            generateMipmaps();
+            const nw::DirtyRects &dirty = mTexBuf->dirty();
+            if (dirty.empty())
+                return;
+
+            size_t levelPixels = static_cast<size_t>(mTexBuf->width()) * mTexBuf->height();
+            mStats.fullLevelBytes += levelPixels * sizeof(nw::RGBA);
+
+            /* Изменилась большая часть: одна выгрузка и мипы на GPU дешевле */
+            if (dirty.area() * 2 >= levelPixels)
+            {
+                setPixels(0, &mTexBuf->data()[0]);
+                generateMipmaps();
+                mStats.uploads++;
+                mStats.bytesUploaded += levelPixels * sizeof(nw::RGBA);
+                mMipsValid = false;
+                mTexBuf->clearDirty();
+                return;
+            }
+
+            int8_t levels = getTotalLevels();
+            if (levels > 1 && !mMipsValid)
+                rebuildMips();
+
+            /* Копии мипов актуальны вне области, поэтому пиксель уровня пересчитывается 
+               только если изменилась его четверка пикселей предыдущего уровня */
+            for (const auto &rect : dirty.rects())
+            {
+                int32_t x0 = rect.x0, y0 = rect.y0, x1 = rect.x1, y1 = rect.y1;
+                uploadRect(0, *mTexBuf, x0, y0, x1, y1);
+
+                const nw::Texture *source = mTexBuf.get();
+                for (int8_t level = 1; level < levels; ++level)
+                {
+                    nw::Texture &mip = *mMips[level - 1];
+                    mip.downsample(*source, nw::Rect<int>(x0, y0, x1, y1));
+                    x0 = std::min(x0 / 2, mip.width() - 1);
+                    y0 = std::min(y0 / 2, mip.height() - 1);
+                    x1 = std::min(x1 / 2, mip.width() - 1);
+                    y1 = std::min(y1 / 2, mip.height() - 1);
+                    uploadRect(level, mip, x0, y0, x1, y1);
+                    mip.clearDirty();
+                    source = &mip;
+                }
+            }
+
+            mTexBuf->clearDirty();
         }
         
         void FontTexture::drawText(const std::string_view &text, const kmVec2 &pos, const kmVec4 &color)
@@ -146,8 +245,7 @@ namespace lite3dpp
                 color.z * 255, 
                 color.w * 255));
             mText->setText(text);
-            mText->render(*mTexBuf);
+            mDrawn->add(mText->render(*mTexBuf));
         }
     }
 }
-
@@ -7,6 +7,127 @@
 
 namespace nw
 {
+    namespace
+    {
+        bool touches(const Rect<int>& _a, const Rect<int>& _b)
+        {
+            return _a.x0 <= _b.x1 + 1 && _b.x0 <= _a.x1 + 1
+                && _a.y0 <= _b.y1 + 1 && _b.y0 <= _a.y1 + 1;
+        }
+
+        Rect<int> clip(const Rect<int>& _rect, int _width, int _height)
+        {
+            return Rect<int>(
+                std::max(0, _rect.x0),
+                std::max(0, _rect.y0),
+                std::min(_width - 1, _rect.x1),
+                std::min(_height - 1, _rect.y1));
+        }
+    }
+
+    void DirtyRects::add(const Rect<int>& _rect)
+    {
+        if (_rect.empty())
+        {
+            return;
+        }
+
+        // Growing rectangle may reach the ones checked before, so start over after every merge
+        Rect<int> merged(_rect);
+        for (size_t i = 0; i < m_rects.size();)
+        {
+            if (touches(m_rects[i], merged))
+            {
+                merged.include(m_rects[i].x0, m_rects[i].y0, m_rects[i].x1, m_rects[i].y1);
+                m_rects.erase(m_rects.begin() + static_cast<std::ptrdiff_t>(i));
+                i = 0;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        m_rects.push_back(merged);
+
+        if (m_rects.size() <= MaxRects)
+        {
+            return;
+        }
+
+        size_t bestA = 0, bestB = 1;
+        size_t bestGrowth = static_cast<size_t>(-1);
+        for (size_t a = 0; a < m_rects.size(); ++a)
+        {
+            for (size_t b = a + 1; b < m_rects.size(); ++b)
+            {
+                Rect<int> bounds(m_rects[a]);
+                bounds.include(m_rects[b].x0, m_rects[b].y0, m_rects[b].x1, m_rects[b].y1);
+                size_t growth = area(bounds) - area(m_rects[a]) - area(m_rects[b]);
+                if (growth < bestGrowth)
+                {
+                    bestGrowth = growth;
+                    bestA = a;
+                    bestB = b;
+                }
+            }
+        }
+
+        Rect<int> bounds(m_rects[bestA]);
+        bounds.include(m_rects[bestB].x0, m_rects[bestB].y0, m_rects[bestB].x1, m_rects[bestB].y1);
+        m_rects.erase(m_rects.begin() + static_cast<std::ptrdiff_t>(bestB));
+        m_rects.erase(m_rects.begin() + static_cast<std::ptrdiff_t>(bestA));
+        add(bounds);
+    }
+
+    void DirtyRects::clear()
+    {
+        m_rects.clear();
+    }
+
+    bool DirtyRects::empty() const
+    {
+        return m_rects.empty();
+    }
+
+    const DirtyRects::Rects& DirtyRects::rects() const
+    {
+        return m_rects;
+    }
+
+    size_t DirtyRects::area() const
+    {
+        size_t result = 0;
+        for (Rects::const_iterator it = m_rects.begin(); it != m_rects.end(); ++it)
+        {
+            result += area(*it);
+        }
+        return result;
+    }
+
+    Rect<int> DirtyRects::bounds() const
+    {
+        if (m_rects.empty())
+        {
+            return Rect<int>(0, 0, -1, -1);
+        }
+
+        Rect<int> result(m_rects.front());
+        for (Rects::const_iterator it = m_rects.begin(); it != m_rects.end(); ++it)
+        {
+            result.include(it->x0, it->y0, it->x1, it->y1);
+        }
+        return result;
+    }
+
+    size_t DirtyRects::area(const Rect<int>& _rect)
+    {
+        if (_rect.empty())
+        {
+            return 0;
+        }
+        return static_cast<size_t>(_rect.x1 - _rect.x0 + 1) * static_cast<size_t>(_rect.y1 - _rect.y0 + 1);
+    }
+
     Texture::Texture() :
         m_width(0),
         m_height(0),
@@ -51,11 +172,14 @@ namespace nw
         m_width = _width;
         m_height = _height;
         m_data.resize(static_cast<size_t>(m_width) * static_cast<size_t>(m_height));
+        m_dirty.clear();
+        markDirty(Rect<int>(0, 0, m_width - 1, m_height - 1));
     }
 
     void Texture::fill(const RGBA& _color)
     {
         std::fill(m_data.begin(), m_data.end(), _color);
+        markDirty(Rect<int>(0, 0, m_width - 1, m_height - 1));
     }
 
     void Texture::fill(const RGBA& _color, const Rect<int>& _rect)
@@ -71,6 +195,8 @@ namespace nw
                 m_data.begin() + static_cast<size_t>(y * m_width + xm),
                 _color);
         }
+
+        markDirty(_rect);
     }
 
     RGBA& Texture::pixel(int _x, int _y)
@@ -97,6 +223,57 @@ namespace nw
                 bg.a = (bg.a * (255 - fg.a) + fg.a * fg.a) / 255;
             }
         }
+
+        markDirty(Rect<int>(_x, _y, _x + _texture.width() - 1, _y + _texture.height() - 1));
+    }
+
+    void Texture::downsample(const Texture& _src, const Rect<int>& _srcRect)
+    {
+        Rect<int> srcRect = clip(_srcRect, _src.width(), _src.height());
+        if (srcRect.empty())
+        {
+            return;
+        }
+
+        Rect<int> rect = clip(Rect<int>(srcRect.x0 / 2, srcRect.y0 / 2, srcRect.x1 / 2, srcRect.y1 / 2),
+            m_width, m_height);
+        for (int y = rect.y0; y <= rect.y1; ++y)
+        {
+            int sy0 = std::min(y * 2, _src.height() - 1);
+            int sy1 = std::min(y * 2 + 1, _src.height() - 1);
+            for (int x = rect.x0; x <= rect.x1; ++x)
+            {
+                int sx0 = std::min(x * 2, _src.width() - 1);
+                int sx1 = std::min(x * 2 + 1, _src.width() - 1);
+                const RGBA& p00 = _src.data()[sy0 * _src.width() + sx0];
+                const RGBA& p01 = _src.data()[sy0 * _src.width() + sx1];
+                const RGBA& p10 = _src.data()[sy1 * _src.width() + sx0];
+                const RGBA& p11 = _src.data()[sy1 * _src.width() + sx1];
+
+                RGBA& dst = pixel(x, y);
+                dst.r = static_cast<uint8_t>((p00.r + p01.r + p10.r + p11.r + 2) / 4);
+                dst.g = static_cast<uint8_t>((p00.g + p01.g + p10.g + p11.g + 2) / 4);
+                dst.b = static_cast<uint8_t>((p00.b + p01.b + p10.b + p11.b + 2) / 4);
+                dst.a = static_cast<uint8_t>((p00.a + p01.a + p10.a + p11.a + 2) / 4);
+            }
+        }
+
+        markDirty(rect);
+    }
+
+    void Texture::markDirty(const Rect<int>& _rect)
+    {
+        m_dirty.add(clip(_rect, m_width, m_height));
+    }
+
+    const DirtyRects& Texture::dirty() const
+    {
+        return m_dirty;
+    }
+
+    void Texture::clearDirty()
+    {
+        m_dirty.clear();
     }
 
 
@@ -18,8 +18,10 @@
 #pragma once
 
 #include <lite3dpp/lite3dpp_common.h>
-#include <lite3dpp/lite3dpp_mesh.h>
+#include <lite3dpp/lite3dpp_config_reader.h>
+#include <lite3dpp/lite3dpp_mesh_geometry.h>
 #include <lite3dpp_physics/lite3dpp_physics_common.h>
+#include <lite3dpp_physics/lite3dpp_physics_shape_cache.h>
 
 namespace lite3dpp {
 namespace lite3dpp_phisics {
@@ -38,14 +40,15 @@ namespace lite3dpp_phisics {
             CollisionShapeTypeMaxCount
         };
 
-        PhysicsTriangleCollisionShape(Main &main, const std::string_view& name, TriangleCollisionShapeType type);
+        PhysicsTriangleCollisionShape(const std::string_view& name, TriangleCollisionShapeType type);
         ~PhysicsTriangleCollisionShape();
 
         btCollisionShape *getCollisionShape();
         inline const String &getName() const
         { return mName; }
 
-        void loadShape(const ConfigurationReader& conf);
+        /* Не обращается к GL, может выполняться в рабочем потоке */
+        void loadShape(const ConfigurationReader& conf, const MeshGeometry::Ptr &geometry, PhysicsShapeCache &cache);
         /* GimpactTriangleMesh поддерживает изменение геомерии на лету. 
            Для этого предлагается получить буферы с верщшинами и индексами вызывав 
            getCollisionMeshVertexData и getCollisionMeshIndexData, провести 
@@ -54,25 +57,30 @@ namespace lite3dpp_phisics {
 
     private:
 
-        void setupConvexHullCollisionShape(const ConfigurationReader& conf);
-        void setupStaticTriangleMeshCollisionShape(const ConfigurationReader& conf);
+        void setupConvexHullCollisionShape(const ConfigurationReader& conf, PhysicsShapeCache &cache);
+        void setupStaticTriangleMeshCollisionShape(const ConfigurationReader& conf, PhysicsShapeCache &cache);
         void setupGimpactTriangleMeshCollisionShape(const ConfigurationReader& conf);
-        void setupTriangleMeshArray(const ConfigurationReader& conf);
-        size_t validateChunkAndCalcVertexOffset(const lite3d_mesh_chunk *chunk);
+        void setupTriangleMeshArray(const MeshGeometry::Ptr &geometry);
         void purgeMeshData();
 
     private:
 
-        Main &mMain;
+        struct AlignedDeleter
+        {
+            void operator()(uint8_t *ptr) const;
+        };
+
         String mName;
         TriangleCollisionShapeType mCollisionShapeType;
+        /* BVH загруженный из кэша живет прямо в этом буфере, форма им не владеет */
+        std::unique_ptr<uint8_t, AlignedDeleter> mBvhData;
         std::unique_ptr<btCollisionShape> mCollisionShape;
         std::unique_ptr<btTriangleIndexVertexArray> mCollisionMeshInfo;
-        stl<BufferData>::vector mCollisionMeshVertexData;
-        stl<BufferData>::vector mCollisionMeshIndexData;
+        /* Общая для всех типов форм, построенных по одному мешу */
+        MeshGeometry::Ptr mCollisionMeshGeometry;
     };
 
-    class PhysicsCollisionShapeManager : public Noncopiable
+    class LITE3DPP_PHYSICS_EXPORT PhysicsCollisionShapeManager : public Noncopiable
     {
     public:
 
@@ -88,6 +96,13 @@ namespace lite3dpp_phisics {
         PhysicsTriangleCollisionShape *getCollisionShapeItem(PhysicsTriangleCollisionShape::TriangleCollisionShapeType type,
             const String& name);
 
+        /* Декодированная геометрия меша по пути к его конфигу, пока она используется формами, 
+           повторно не загружается */
+        MeshGeometry::Ptr getMeshGeometry(const String& meshPath);
+
+        inline PhysicsShapeCache &getShapeCache()
+        { return mShapeCache; }
+
         void clearCache();
         void removeCollisionShapeItem(PhysicsTriangleCollisionShape::TriangleCollisionShapeType type,
             const String& name);
@@ -96,5 +111,7 @@ namespace lite3dpp_phisics {
 
         Main &mMain;
         CollisionsShapeCacheByType mCache;
+        stl<String, std::weak_ptr<MeshGeometry>>::unordered_map mGeometryCache;
+        PhysicsShapeCache mShapeCache;
     };
 }}
\ No newline at end of file
@@ -17,23 +17,38 @@
  *******************************************************************************/
 #pragma once
 
+#include <lite3dpp_physics/lite3dpp_physics_common.h>
 #include <lite3dpp_physics/lite3dpp_physics_bullet.h>
 
 namespace lite3dpp {
 namespace lite3dpp_phisics {
 
-    class PhysicsObjectMotionState : public btMotionState
+    class PhysicsSimulation;
+
+    class LITE3DPP_PHYSICS_EXPORT PhysicsObjectMotionState : public btMotionState
     {
     public:
 
-        PhysicsObjectMotionState(SceneObject *o);
+        PhysicsObjectMotionState(SceneObject *o, PhysicsSimulation *simulation = nullptr);
 
         void getWorldTransform(btTransform& worldTrans) const override;
         //Bullet only calls the update of worldtransform for active objects
         void setWorldTransform(const btTransform& worldTrans) override;
 
+        /* Асинхронная симуляция: запомнить положение кинематического обьекта для потока симуляции */
+        void captureKinematic();
+        /* Асинхронная симуляция: положение между двумя последними шагами в сцену, 
+           false если обьект не двигался на шаге stepIndex и поставлен в последнее положение */
+        bool applyInterpolated(uint64_t stepIndex, float factor);
+
     private:
 
         SceneObject *mSceneObject;
+        PhysicsSimulation *mSimulation;
+        btTransform mPrevTransform;
+        btTransform mTransform;
+        uint64_t mStepIndex = 0;
+        bool mQueued = false;
+        bool mKinematicCaptured = false;
     };
 }}
@@ -22,6 +22,7 @@
 #include <lite3dpp/lite3dpp_scene.h>
 #include <lite3dpp_physics/lite3dpp_physics_scene_object.h>
 #include <lite3dpp_physics/lite3dpp_physics_collision_shape_manager.h>
+#include <lite3dpp_physics/lite3dpp_physics_simulation.h>
 
 namespace lite3dpp {
 namespace lite3dpp_phisics {
@@ -36,7 +37,8 @@ namespace lite3dpp_phisics {
         PhysicsScene(const String &name, const String &path, Main &main);
         ~PhysicsScene();
 
-        inline btDiscreteDynamicsWorld *getWorld() { return mWorld.get(); } 
+        inline btDiscreteDynamicsWorld *getWorld() { return mSimulation ? mSimulation->getWorld() : nullptr; } 
+        inline PhysicsSimulation *getSimulation() { return mSimulation.get(); }
 
         PhysicsSceneObject *addPhysicsObject(const String &name, const String &templatePath, 
             SceneObject *parent = nullptr, const kmVec3 &initialPosition = KM_VEC3_ZERO, 
@@ -54,21 +56,14 @@ namespace lite3dpp_phisics {
 
         virtual void loadFromConfigImpl(const ConfigurationReader &conf) override;
         virtual void unloadImpl() override;
-        virtual void createCollisionConfiguration(const ConfigurationReader &conf);
-        virtual void createCollisionSolver(const ConfigurationReader &conf);
+        virtual PhysicsSimulation::Config simulationConfig(const ConfigurationReader &conf);
         virtual void frameEnd() override;
         virtual SceneObject::Ptr createObject(const String &name, SceneObjectBase *parent, const kmVec3 &initialPosition, 
             const kmQuaternion &initialRotation, const kmVec3 &initialScale) override;
 
     protected:
 
-        std::unique_ptr<btCollisionConfiguration> mCollisionConfig;
-        std::unique_ptr<btCollisionDispatcher> mCollisionDispatcher;
-        std::unique_ptr<btBroadphaseInterface> mBroadphase;
-        std::unique_ptr<btConstraintSolver> mConstraintSolver;
-        std::unique_ptr<btDiscreteDynamicsWorld> mWorld;
-        int mMaxSubStepCount = MaxSubStepCount;
-        float mFixedTimeStep = FixedTimeStep;
+        std::unique_ptr<PhysicsSimulation> mSimulation;
         std::chrono::steady_clock::time_point mLastSimulationTime;
         PhysicsCollisionShapeManager mCollisionShapeManager;
     };
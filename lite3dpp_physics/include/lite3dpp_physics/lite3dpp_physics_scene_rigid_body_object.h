@@ -20,6 +20,7 @@
 #include <lite3dpp_physics/lite3dpp_physics_scene_object.h>
 #include <lite3dpp_physics/lite3dpp_physics_scene_node.h>
 #include <lite3dpp_physics/lite3dpp_physics_motion_state.h>
+#include <lite3dpp_physics/lite3dpp_physics_simulation.h>
 
 namespace lite3dpp {
 namespace lite3dpp_phisics {
@@ -35,6 +36,7 @@ namespace lite3dpp_phisics {
         ~PhysicsRigidBodySceneObject();
 
         void loadFromTemplate(const ConfigurationReader& conf) override;
+        void loadFromTemplate(const SceneObjectTemplate &objectTemplate) override;
 
         virtual SceneNode* addCollisiuonShapeNode(const ConfigurationReader &nodeconf, SceneNodeBase *parent);
 
@@ -46,6 +48,8 @@ namespace lite3dpp_phisics {
     protected:
         
         SceneNode* createNode(const ConfigurationReader &conf, SceneNodeBase *parent) override;
+        SceneNode* createNode(const SceneNodePrototype &prototype, SceneNodeBase *parent) override;
+        void setupRigidBody(const ConfigurationReader& conf);
         btTransform calcRelativeTransform(const SceneNodeBase *node);
         /* Используется если нужно совместить начало координат локальной системы обьекта с центром масс в 
            случае если задана опция пересчета центра масс */
@@ -56,7 +60,7 @@ namespace lite3dpp_phisics {
 
         std::unique_ptr<btRigidBody> mBody;
         std::unique_ptr<btCompoundShape> mCompoundCollisionShape;
-        btDiscreteDynamicsWorld *mWorld;
+        PhysicsSimulation *mSimulation;
         CollisionNodes mCollisionNodes;
         PhysicsObjectMotionState mMotionState;
     };
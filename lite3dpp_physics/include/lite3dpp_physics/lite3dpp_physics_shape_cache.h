@@ -0,0 +1,63 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <lite3dpp/lite3dpp_common.h>
+#include <lite3dpp/lite3dpp_buffer_wrapper.h>
+#include <lite3dpp_physics/lite3dpp_physics_common.h>
+
+namespace lite3dpp {
+namespace lite3dpp_phisics {
+
+    /* Дисковый кэш построенных коллизионных форм (BVH, выпуклые оболочки).
+       Ключ: хэш содержимого меша, тип формы и margin. Файл кэша также хранит версию bullet 
+       и размеры btScalar и указателя, при несовпадении запись считается промахом и перезаписывается */
+    class LITE3DPP_PHYSICS_EXPORT PhysicsShapeCache : public Noncopiable
+    {
+    public:
+
+        struct Stats
+        {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            uint32_t stored = 0;
+        };
+
+        /* пустой путь выключает кэш */
+        void setDirectory(const String &directory);
+        inline const String &getDirectory() const
+        { return mDirectory; }
+        inline bool isEnabled() const
+        { return !mDirectory.empty(); }
+
+        bool load(uint64_t contentHash, uint32_t shapeType, float margin, BufferData &payload);
+        void store(uint64_t contentHash, uint32_t shapeType, float margin, const void *payload, size_t size);
+
+        inline const Stats &getStats() const
+        { return mStats; }
+
+    private:
+
+        String cacheFilePath(uint64_t contentHash, uint32_t shapeType, float margin) const;
+
+    private:
+
+        String mDirectory;
+        Stats mStats;
+    };
+}}
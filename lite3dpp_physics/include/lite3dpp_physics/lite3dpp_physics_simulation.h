@@ -0,0 +1,136 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <lite3dpp/lite3dpp_scene_object.h>
+#include <lite3dpp_physics/lite3dpp_physics_common.h>
+
+class btDefaultCollisionConfiguration;
+class btTransform;
+class btConstraintSolverPoolMt;
+
+namespace lite3dpp {
+namespace lite3dpp_phisics {
+
+    class PhysicsObjectMotionState;
+
+    /* Мир bullet и его шаг по времени.
+       Режимы:
+       - обычный: stepSimulation в потоке рендера, bullet сам интерполирует motion states;
+       - Multithreaded: btDiscreteDynamicsWorldMt, пул солверов и планировщик задач bullet с Workers потоками;
+       - AsyncStep: шаги фиксированной длины выполняются в отдельном потоке, пока рендерится кадр. 
+         Motion states хранят трансформации двух последних шагов, сцена получает интерполяцию между ними.
+       В AsyncStep мир можно менять только после wait (getWorld ждет сам) */
+    class LITE3DPP_PHYSICS_EXPORT PhysicsSimulation : public Noncopiable
+    {
+    public:
+
+        struct Config
+        {
+            float fixedTimeStep = 1.0f / 60.0f;
+            int maxSubSteps = 10;
+            bool latencyInterpolation = false;
+            bool multithreaded = false;
+            /* 0 - все аппаратные потоки */
+            uint32_t workers = 0;
+            /* 0 - по солверу на поток */
+            uint32_t solverPoolSize = 0;
+            bool asyncStep = false;
+            /* Трансформации активных тел копируются в массив и применяются к сцене после шага: 
+               сначала записываются все узлы, затем наблюдатели уведомляются один раз на пакет */
+            bool batchTransforms = true;
+        };
+
+        explicit PhysicsSimulation(const Config &config);
+        ~PhysicsSimulation();
+
+        btDiscreteDynamicsWorld *getWorld();
+        inline const Config &getConfig() const
+        { return mConfig; }
+        /* false если bullet собран без поддержки потоков */
+        inline bool isMultithreaded() const
+        { return mMultithreaded; }
+        inline bool isAsync() const
+        { return mConfig.asyncStep; }
+
+        /* Простой режим: шаг сразу. AsyncStep: применяет к сцене результат прошлого шага 
+           и запускает симуляцию elapsedSec в потоке симуляции */
+        void step(float elapsedSec);
+        /* Дождаться шага в потоке симуляции */
+        void wait();
+
+        /* Положение между двумя последними шагами 0..1 (AsyncStep) */
+        inline float getInterpolationFactor() const
+        { return mAccumulator / mConfig.fixedTimeStep; }
+        /* Число выполненных фиксированных шагов (AsyncStep) */
+        inline uint64_t getStepIndex() const
+        { return mStepIndex; }
+        /* Время последнего вызова stepSimulation, мс */
+        inline float getLastStepMs() const
+        { return mLastStepMs; }
+
+        /* Вызывается из потока симуляции, когда bullet передает новую трансформацию */
+        void motionStateMoved(PhysicsObjectMotionState *state);
+        /* Простой режим с batchTransforms: трансформация тела до конца шага */
+        void recordTransform(SceneObject *object, const btTransform &transform);
+        /* Трансформацию кинематических тел bullet читает в потоке симуляции, 
+           поэтому она снимается со сцены перед каждым запуском */
+        void addKinematic(PhysicsObjectMotionState *state);
+        void removeMotionState(PhysicsObjectMotionState *state);
+
+    private:
+
+        void createWorld();
+        void simulate(float elapsedSec);
+        void synchronizeMotionStates();
+        void applyTransforms();
+        void threadLoop();
+
+    private:
+
+        Config mConfig;
+        bool mMultithreaded = false;
+        std::unique_ptr<btDefaultCollisionConfiguration> mCollisionConfig;
+        std::unique_ptr<btCollisionDispatcher> mCollisionDispatcher;
+        std::unique_ptr<btBroadphaseInterface> mBroadphase;
+        std::unique_ptr<btConstraintSolverPoolMt> mSolverPool;
+        std::unique_ptr<btConstraintSolver> mConstraintSolver;
+        std::unique_ptr<btDiscreteDynamicsWorld> mWorld;
+
+        float mAccumulator = 0.0f;
+        uint64_t mStepIndex = 0;
+        float mLastStepMs = 0.0f;
+
+        /* motion states двигавшиеся в потоке симуляции и еще не ставшие на место в сцене */
+        stl<PhysicsObjectMotionState *>::vector mInterpolated;
+        stl<PhysicsObjectMotionState *>::vector mKinematic;
+        SceneNodeTransformBatch mTransforms;
+
+        std::thread mThread;
+        std::mutex mLock;
+        std::condition_variable mWake;
+        std::condition_variable mDone;
+        bool mHasJob = false;
+        bool mStop = false;
+        float mJobElapsed = 0.0f;
+    };
+}}
@@ -17,6 +17,7 @@
  *******************************************************************************/
 #include <lite3dpp_physics/lite3dpp_physics_collision_shape_manager.h>
 
+#include <cstring>
 #include <SDL_assert.h>
 #include <lite3dpp_physics/lite3dpp_physics_bullet.h>
 #include <lite3dpp/lite3dpp_main.h>
@@ -48,8 +49,9 @@ namespace lite3dpp_phisics {
             }
         }
 
-        auto shapeItem = std::make_shared<PhysicsTriangleCollisionShape>(mMain, name, type);
-        shapeItem->loadShape(collisionShapeConf);
+        auto shapeItem = std::make_shared<PhysicsTriangleCollisionShape>(name, type);
+        shapeItem->loadShape(collisionShapeConf, 
+            getMeshGeometry(collisionShapeConf.getObject(L"CollisionMesh").getString(L"Mesh")), mShapeCache);
 
         mCache[type].emplace(name, shapeItem);
         return shapeItem->getCollisionShape();
@@ -73,12 +75,40 @@ namespace lite3dpp_phisics {
         return nullptr;
     }
 
+    MeshGeometry::Ptr PhysicsCollisionShapeManager::getMeshGeometry(const String& path)
+    {
+        auto geometryIt = mGeometryCache.find(path);
+        if (geometryIt != mGeometryCache.end())
+        {
+            if (auto geometry = geometryIt->second.lock())
+            {
+                return geometry;
+            }
+        }
+
+        /* путь указывает на конфиг меша, геометрию берем прямо из его .m файла */
+        size_t fileSize = 0;
+        const void *fileData = mMain.getResourceManager().loadFileToMemory(path, &fileSize);
+        ConfigurationReader meshConf(static_cast<const char *>(fileData), fileSize);
+        if (meshConf.getString(L"Codec") != "m")
+        {
+            LITE3D_THROW("Collision mesh '" << path << "': only 'm' codec supported");
+        }
+
+        fileData = mMain.getResourceManager().loadFileToMemory(meshConf.getString(L"Model"), &fileSize);
+        auto geometry = std::make_shared<MeshGeometry>(path, fileData, fileSize);
+        mGeometryCache[path] = geometry;
+        return geometry;
+    }
+
     void PhysicsCollisionShapeManager::clearCache()
     {
         for (auto &itemType : mCache)
         {
             itemType.clear();
         }
+
+        mGeometryCache.clear();
     }
 
     void PhysicsCollisionShapeManager::removeCollisionShapeItem(PhysicsTriangleCollisionShape::TriangleCollisionShapeType type,
@@ -96,9 +126,8 @@ namespace lite3dpp_phisics {
         }
     }
 
-    PhysicsTriangleCollisionShape::PhysicsTriangleCollisionShape(Main &main, const std::string_view& name, 
+    PhysicsTriangleCollisionShape::PhysicsTriangleCollisionShape(const std::string_view& name, 
         TriangleCollisionShapeType type) : 
-        mMain(main),
         mName(name),
         mCollisionShapeType(type)
     {}
@@ -106,25 +135,32 @@ namespace lite3dpp_phisics {
     PhysicsTriangleCollisionShape::~PhysicsTriangleCollisionShape()
     {
         mCollisionShape.reset();
+        mBvhData.reset();
         purgeMeshData();
     }
 
+    void PhysicsTriangleCollisionShape::AlignedDeleter::operator()(uint8_t *ptr) const
+    {
+        btAlignedFree(ptr);
+    }
+
     btCollisionShape *PhysicsTriangleCollisionShape::getCollisionShape()
     {
         SDL_assert(mCollisionShape);
         return mCollisionShape.get();
     }
 
-    void PhysicsTriangleCollisionShape::loadShape(const ConfigurationReader& conf)
+    void PhysicsTriangleCollisionShape::loadShape(const ConfigurationReader& conf, const MeshGeometry::Ptr &geometry,
+        PhysicsShapeCache &cache)
     {
-        setupTriangleMeshArray(conf);
+        setupTriangleMeshArray(geometry);
         switch (mCollisionShapeType)
         {
             case ConvexHull:
-                setupConvexHullCollisionShape(conf);
+                setupConvexHullCollisionShape(conf, cache);
                 break;
             case StaticTriangleMesh:
-                setupStaticTriangleMeshCollisionShape(conf);
+                setupStaticTriangleMeshCollisionShape(conf, cache);
                 break;
             case GimpactTriangleMesh:
                 setupGimpactTriangleMeshCollisionShape(conf);
@@ -137,98 +173,108 @@ namespace lite3dpp_phisics {
         }
     }
 
-    size_t PhysicsTriangleCollisionShape::validateChunkAndCalcVertexOffset(const lite3d_mesh_chunk *chunk)
+    void PhysicsTriangleCollisionShape::setupTriangleMeshArray(const MeshGeometry::Ptr &geometry)
     {
-        size_t offset = 0;
-        if (!chunk->hasIndexes)
-        {
-            LITE3D_THROW("Not indexed mesh '" << getName() << "', only indexed meshes supported");
-        }
-
-        const lite3d_vao_layout *layout = static_cast<const lite3d_vao_layout *>(chunk->layout.data);
-        for (uint32_t i = 0; i < chunk->layout.size; ++i)
-        {
-            if (layout[i].binding != LITE3D_BUFFER_BINDING_VERTEX)
-            {
-                offset += layout[i].count * sizeof(float);
-            }
-            else
-            {
-                return offset;
-            }
-        }
-
-        LITE3D_THROW("Vertex data not found for mesh '" << getName() << "'...");
-        return 0;
-    }
-    
-    void PhysicsTriangleCollisionShape::setupTriangleMeshArray(const ConfigurationReader& conf)
-    {
-        /* load collision mesh into GPU memory */
-        auto rawMesh = mMain.getResourceManager().queryResource<Mesh>(getName(),
-            conf.getObject(L"CollisionMesh").getString(L"Mesh"));
-
-        if (rawMesh->chunksCount() == 0)
+        SDL_assert(geometry);
+        if (geometry->chunksCount() == 0)
         {
             LITE3D_THROW("Collision mesh '" << getName() << "' is empty...");
         }
 
+        mCollisionMeshGeometry = geometry;
         mCollisionMeshInfo = std::make_unique<btTriangleIndexVertexArray>();
-        mCollisionMeshVertexData.resize(rawMesh->chunksCount());
-        mCollisionMeshIndexData.resize(rawMesh->chunksCount());
 
-        for (size_t i = 0; i < rawMesh->chunksCount(); ++i)
+        for (uint32_t i = 0; i < geometry->chunksCount(); ++i)
         {
-            auto chunkEntity = rawMesh->getChunk(i);
-
-            /* load chunk from GPU to host memory */
-            rawMesh->getPartition()->vertexBuffer().getDataBuffer(mCollisionMeshVertexData[i], 
-                chunkEntity.chunk->vao.verticesOffset,
-                chunkEntity.chunk->vao.verticesSize);
-                
-            rawMesh->getPartition()->indexBuffer().getDataBuffer(mCollisionMeshIndexData[i], 
-                chunkEntity.chunk->vao.indexesOffset,
-                chunkEntity.chunk->vao.indexesSize);
-
-            /* calc vertices offset inside chunk */
-            auto vertexOffset = validateChunkAndCalcVertexOffset(chunkEntity.chunk);
+            const auto &chunk = geometry->getChunk(i);
+            if (chunk.indexesCount == 0)
+            {
+                LITE3D_THROW("Not indexed mesh '" << getName() << "', only indexed meshes supported");
+            }
 
+            /* bullet только читает вершины и индексы, геометрию можно разделять между формами */
             btIndexedMesh triangleArrayChunk;
             triangleArrayChunk.m_indexType = PHY_ScalarType::PHY_INTEGER;
-            triangleArrayChunk.m_numTriangles = chunkEntity.chunk->vao.elementsCount;
-            triangleArrayChunk.m_triangleIndexBase = &mCollisionMeshIndexData[i][0];
+            triangleArrayChunk.m_numTriangles = chunk.indexesCount / 3;
+            triangleArrayChunk.m_triangleIndexBase = reinterpret_cast<const unsigned char *>(geometry->chunkIndexes(i));
             triangleArrayChunk.m_triangleIndexStride = sizeof(int32_t) * 3;
-            triangleArrayChunk.m_numVertices = chunkEntity.chunk->vao.verticesCount;
-            triangleArrayChunk.m_vertexBase = &mCollisionMeshVertexData[i][vertexOffset];
-            triangleArrayChunk.m_vertexStride = chunkEntity.chunk->vertexStride;
+            triangleArrayChunk.m_numVertices = chunk.verticesCount;
+            triangleArrayChunk.m_vertexBase = reinterpret_cast<const unsigned char *>(geometry->chunkPositions(i));
+            triangleArrayChunk.m_vertexStride = sizeof(float) * 3;
             mCollisionMeshInfo->addIndexedMesh(triangleArrayChunk);
         }
     }
 
-    void PhysicsTriangleCollisionShape::setupConvexHullCollisionShape(const ConfigurationReader& conf)
+    void PhysicsTriangleCollisionShape::setupConvexHullCollisionShape(const ConfigurationReader& conf, 
+        PhysicsShapeCache &cache)
     {
         SDL_assert(mCollisionMeshInfo);
-        /* build optimize hull */
-        btConvexTriangleMeshShape convexTriangleShape(mCollisionMeshInfo.get());
-        btShapeHull hullOptimizer(&convexTriangleShape);
-        hullOptimizer.buildHull(conf.getDouble(L"Margin", 0.5));
-
-        /* load hull to shape */
-        auto convexHullShape = std::make_unique<btConvexHullShape>();
-        for (int i = 0; i < hullOptimizer.numIndices(); ++i)
+        float margin = static_cast<float>(conf.getDouble(L"Margin", 0.5));
+        uint64_t contentHash = cache.isEnabled() ? mCollisionMeshGeometry->contentHash() : 0;
+
+        /* точки оболочки из кэша или строим оптимизированную оболочку */
+        BufferData points;
+        if (!cache.load(contentHash, ConvexHull, margin, points) || points.size() % (sizeof(btScalar) * 3) != 0)
         {
-            convexHullShape->addPoint(hullOptimizer.getVertexPointer()[hullOptimizer.getIndexPointer()[i]]);
+            btConvexTriangleMeshShape convexTriangleShape(mCollisionMeshInfo.get());
+            btShapeHull hullOptimizer(&convexTriangleShape);
+            hullOptimizer.buildHull(margin);
+
+            points.resize(hullOptimizer.numVertices() * sizeof(btScalar) * 3);
+            btScalar *point = reinterpret_cast<btScalar *>(points.data());
+            for (int i = 0; i < hullOptimizer.numVertices(); ++i, point += 3)
+            {
+                point[0] = hullOptimizer.getVertexPointer()[i].x();
+                point[1] = hullOptimizer.getVertexPointer()[i].y();
+                point[2] = hullOptimizer.getVertexPointer()[i].z();
+            }
+
+            cache.store(contentHash, ConvexHull, margin, points.data(), points.size());
         }
 
-        mCollisionShape = std::move(convexHullShape);
+        mCollisionShape = std::make_unique<btConvexHullShape>(reinterpret_cast<const btScalar *>(points.data()), 
+            static_cast<int>(points.size() / (sizeof(btScalar) * 3)), static_cast<int>(sizeof(btScalar) * 3));
         /* vertex data not needed yet */
         purgeMeshData();
     }
 
-    void PhysicsTriangleCollisionShape::setupStaticTriangleMeshCollisionShape(const ConfigurationReader& conf)
+    void PhysicsTriangleCollisionShape::setupStaticTriangleMeshCollisionShape(const ConfigurationReader& conf,
+        PhysicsShapeCache &cache)
     {
         SDL_assert(mCollisionMeshInfo);
-        mCollisionShape = std::make_unique<btBvhTriangleMeshShape>(mCollisionMeshInfo.get(), true, true);
+        uint64_t contentHash = cache.isEnabled() ? mCollisionMeshGeometry->contentHash() : 0;
+
+        /* quantized BVH из кэша загружается на месте в выровненный буфер, без перестроения */
+        BufferData bvhData;
+        if (cache.load(contentHash, StaticTriangleMesh, 0.0f, bvhData))
+        {
+            mBvhData.reset(static_cast<uint8_t *>(btAlignedAlloc(bvhData.size(), 16)));
+            std::memcpy(mBvhData.get(), bvhData.data(), bvhData.size());
+            btOptimizedBvh *bvh = btOptimizedBvh::deSerializeInPlace(mBvhData.get(), 
+                static_cast<unsigned>(bvhData.size()), false);
+            if (bvh)
+            {
+                auto shape = std::make_unique<btBvhTriangleMeshShape>(mCollisionMeshInfo.get(), true, false);
+                shape->setOptimizedBvh(bvh);
+                mCollisionShape = std::move(shape);
+                return;
+            }
+
+            mBvhData.reset();
+        }
+
+        auto shape = std::make_unique<btBvhTriangleMeshShape>(mCollisionMeshInfo.get(), true, true);
+        if (cache.isEnabled() && shape->getOptimizedBvh())
+        {
+            unsigned bvhSize = shape->getOptimizedBvh()->calculateSerializeBufferSize();
+            std::unique_ptr<uint8_t, AlignedDeleter> serialized(static_cast<uint8_t *>(btAlignedAlloc(bvhSize, 16)));
+            if (shape->getOptimizedBvh()->serializeInPlace(serialized.get(), bvhSize, false))
+            {
+                cache.store(contentHash, StaticTriangleMesh, 0.0f, serialized.get(), bvhSize);
+            }
+        }
+
+        mCollisionShape = std::move(shape);
     }
 
     void PhysicsTriangleCollisionShape::setupGimpactTriangleMeshCollisionShape(const ConfigurationReader& conf)
@@ -240,8 +286,8 @@ namespace lite3dpp_phisics {
 
     void PhysicsTriangleCollisionShape::purgeMeshData()
     {
-        mCollisionMeshVertexData.clear();
-        mCollisionMeshIndexData.clear();
+        mCollisionMeshInfo.reset();
+        mCollisionMeshGeometry.reset();
     }
 
     void PhysicsTriangleCollisionShape::updateBounds()
@@ -18,17 +18,26 @@
 #include <lite3dpp_physics/lite3dpp_physics_motion_state.h>
 
 #include <SDL_assert.h>
+#include <lite3dpp_physics/lite3dpp_physics_simulation.h>
 
 namespace lite3dpp {
 namespace lite3dpp_phisics {
 
-PhysicsObjectMotionState::PhysicsObjectMotionState(SceneObject *o) : 
-    mSceneObject(o)
+PhysicsObjectMotionState::PhysicsObjectMotionState(SceneObject *o, PhysicsSimulation *simulation) : 
+    mSceneObject(o),
+    mSimulation(simulation)
 {}
 
 void PhysicsObjectMotionState::getWorldTransform(btTransform& worldTrans) const
 {
     SDL_assert(mSceneObject);
+    /* В асинхронном режиме вызывается из потока симуляции, сцену в это время меняет поток рендера */
+    if (mKinematicCaptured)
+    {
+        worldTrans = mTransform;
+        return;
+    }
+
     worldTrans.setOrigin(BulletUtils::convert(mSceneObject->getPosition()));
     worldTrans.setRotation(BulletUtils::convert(mSceneObject->getRotation()));
 }
@@ -36,8 +45,56 @@ void PhysicsObjectMotionState::getWorldTransform(btTransform& worldTrans) const
 void PhysicsObjectMotionState::setWorldTransform(const btTransform& worldTrans)
 {
     SDL_assert(mSceneObject);
-    mSceneObject->setPosition(BulletUtils::convert(worldTrans.getOrigin()));
-    mSceneObject->setRotation(BulletUtils::convert(worldTrans.getRotation()));
+    if (!mSimulation || (!mSimulation->isAsync() && !mSimulation->getConfig().batchTransforms))
+    {
+        mSceneObject->setPosition(BulletUtils::convert(worldTrans.getOrigin()));
+        mSceneObject->setRotation(BulletUtils::convert(worldTrans.getRotation()));
+        return;
+    }
+
+    if (!mSimulation->isAsync())
+    {
+        mSimulation->recordTransform(mSceneObject, worldTrans);
+        return;
+    }
+
+    /* Кинематическим обьектом управляет сцена */
+    if (mKinematicCaptured)
+        return;
+
+    /* Поток симуляции: сцену не трогаем, запоминаем два последних шага */
+    mPrevTransform = mQueued ? mTransform : worldTrans;
+    mTransform = worldTrans;
+    mStepIndex = mSimulation->getStepIndex();
+    if (!mQueued)
+    {
+        mQueued = true;
+        mSimulation->motionStateMoved(this);
+    }
+}
+
+void PhysicsObjectMotionState::captureKinematic()
+{
+    SDL_assert(mSceneObject);
+    mTransform.setOrigin(BulletUtils::convert(mSceneObject->getPosition()));
+    mTransform.setRotation(BulletUtils::convert(mSceneObject->getRotation()));
+    mKinematicCaptured = true;
+}
+
+bool PhysicsObjectMotionState::applyInterpolated(uint64_t stepIndex, float factor)
+{
+    SDL_assert(mSceneObject);
+    if (mStepIndex != stepIndex)
+    {
+        mSceneObject->setTransform(BulletUtils::convert(mTransform.getOrigin()), 
+            BulletUtils::convert(mTransform.getRotation()));
+        mQueued = false;
+        return false;
+    }
+
+    mSceneObject->setTransform(BulletUtils::convert(mPrevTransform.getOrigin().lerp(mTransform.getOrigin(), factor)),
+        BulletUtils::convert(mPrevTransform.getRotation().slerp(mTransform.getRotation(), factor)));
+    return true;
 }
 
 }}
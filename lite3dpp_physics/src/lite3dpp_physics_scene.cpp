@@ -40,73 +40,69 @@ namespace lite3dpp_phisics {
     {
         auto physicsConfig = conf.getObject(L"Physics");
 
-        createCollisionConfiguration(physicsConfig);
-        createCollisionSolver(physicsConfig);
-        mBroadphase = std::make_unique<btDbvtBroadphase>();
-        mWorld = std::make_unique<btDiscreteDynamicsWorld>(mCollisionDispatcher.get(), mBroadphase.get(), 
-            mConstraintSolver.get(), mCollisionConfig.get());
-
+        mSimulation = std::make_unique<PhysicsSimulation>(simulationConfig(physicsConfig));
         setGravity(physicsConfig.getVec3(L"Gravity"));
-        mWorld->setLatencyMotionStateInterpolation(physicsConfig.getBool(L"LatencyMotionStateInterpolation", false));
-        mMaxSubStepCount = physicsConfig.getInt(L"MaxSubStepCount", MaxSubStepCount);
-        if (physicsConfig.has(L"ManualFixedStepIntervalMs"))
+
+        /* каталог для готовых BVH и выпуклых оболочек, без него формы строятся при каждом запуске */
+        mCollisionShapeManager.getShapeCache().setDirectory(physicsConfig.getString(L"ShapeCache", ""));
+
+        Scene::loadFromConfigImpl(conf);
+        mLastSimulationTime = std::chrono::steady_clock::now();
+    }
+
+    PhysicsSimulation::Config PhysicsScene::simulationConfig(const ConfigurationReader &conf)
+    {
+        PhysicsSimulation::Config config;
+        config.latencyInterpolation = conf.getBool(L"LatencyMotionStateInterpolation", false);
+        config.maxSubSteps = conf.getInt(L"MaxSubStepCount", MaxSubStepCount);
+        config.fixedTimeStep = FixedTimeStep;
+        if (conf.has(L"ManualFixedStepIntervalMs"))
         {
-            mFixedTimeStep = physicsConfig.getInt(L"ManualFixedStepIntervalMs") / 1000.0f;
+            config.fixedTimeStep = conf.getInt(L"ManualFixedStepIntervalMs") / 1000.0f;
         }
         else
         {
             auto defaultFixedIntervalTimer = getMain().getFixedUpdateTimer();
             if (defaultFixedIntervalTimer)
             {
-                mFixedTimeStep = defaultFixedIntervalTimer->interval / 1000.0f;
+                config.fixedTimeStep = defaultFixedIntervalTimer->interval / 1000.0f;
             }
         }
 
-        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(mWorld->getDispatcher()));
-
-        Scene::loadFromConfigImpl(conf);
-        mLastSimulationTime = std::chrono::steady_clock::now();
+        /* btDiscreteDynamicsWorldMt, если bullet собран с BT_THREADSAFE */
+        config.multithreaded = conf.getBool(L"Multithreaded", false);
+        config.workers = static_cast<uint32_t>(conf.getInt(L"Workers", 0));
+        config.solverPoolSize = static_cast<uint32_t>(conf.getInt(L"SolverPoolSize", 0));
+        /* Симуляция в своем потоке параллельно с рендером, сцена видит результат с задержкой в кадр */
+        config.asyncStep = conf.getBool(L"AsyncStep", false);
+        config.batchTransforms = conf.getBool(L"BatchTransformSync", true);
+        return config;
     }
 
     void PhysicsScene::setGravity(const kmVec3 &gravity)
     {
-        SDL_assert(mWorld);
-        mWorld->setGravity(BulletUtils::convert(gravity));
+        SDL_assert(mSimulation);
+        mSimulation->getWorld()->setGravity(BulletUtils::convert(gravity));
     }
 
     void PhysicsScene::unloadImpl()
     {
         Scene::unloadImpl();
         mCollisionShapeManager.clearCache();
-        mWorld.reset();
-        mBroadphase.reset();
-        mConstraintSolver.reset();
-        mCollisionDispatcher.reset();
-        mCollisionConfig.reset();
-    }
-
-    void PhysicsScene::createCollisionConfiguration(const ConfigurationReader &conf)
-    {
-        mCollisionConfig = std::make_unique<btDefaultCollisionConfiguration>();
-    }
-
-    void PhysicsScene::createCollisionSolver(const ConfigurationReader &conf)
-    {
-        mCollisionDispatcher = std::make_unique<btCollisionDispatcher>(mCollisionConfig.get());
-        mConstraintSolver = std::make_unique<btSequentialImpulseConstraintSolver>();
+        mSimulation.reset();
     }
 
     void PhysicsScene::frameEnd()
     {
         /* run simulation at the end of the frame */
-        if (mWorld)
+        if (mSimulation)
         {
             auto timeNow = std::chrono::steady_clock::now();
             btScalar elapsedSec = std::chrono::duration_cast<std::chrono::microseconds>(timeNow - 
                 mLastSimulationTime).count() / 1000000.0f;
 
             mLastSimulationTime = timeNow;
-            mWorld->stepSimulation(elapsedSec, mMaxSubStepCount, mFixedTimeStep);
+            mSimulation->step(elapsedSec);
         }
     }
 
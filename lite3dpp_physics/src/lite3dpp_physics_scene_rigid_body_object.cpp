@@ -27,17 +27,19 @@ namespace lite3dpp_phisics {
     PhysicsRigidBodySceneObject::PhysicsRigidBodySceneObject(const String &name, Scene *scene, Main *main, 
         SceneObjectBase *parent, const kmVec3 &initialPosition, const kmQuaternion &initialRotation, const kmVec3 &initialScale) : 
         PhysicsSceneObject(name, scene, main, parent, initialPosition, initialRotation, initialScale),
-        mWorld(static_cast<PhysicsScene *>(scene)->getWorld()),
-        mMotionState(this)
+        mSimulation(static_cast<PhysicsScene *>(scene)->getSimulation()),
+        mMotionState(this, mSimulation)
     {}
 
     PhysicsRigidBodySceneObject::~PhysicsRigidBodySceneObject()
     {
-        SDL_assert(mWorld);
+        SDL_assert(mSimulation);
 
         if (mBody)
         {
-            mWorld->removeRigidBody(mBody.get());
+            /* getWorld дождется шага симуляции, если он идет в другом потоке */
+            mSimulation->getWorld()->removeRigidBody(mBody.get());
+            mSimulation->removeMotionState(&mMotionState);
         }
 
         mCompoundCollisionShape.reset();
@@ -45,9 +47,20 @@ namespace lite3dpp_phisics {
 
     void PhysicsRigidBodySceneObject::loadFromTemplate(const ConfigurationReader& conf)
     {
-        SDL_assert(mWorld);
+        SDL_assert(mSimulation);
         SceneObject::loadFromTemplate(conf);
+        setupRigidBody(conf);
+    }
+
+    void PhysicsRigidBodySceneObject::loadFromTemplate(const SceneObjectTemplate &objectTemplate)
+    {
+        SDL_assert(mSimulation);
+        SceneObject::loadFromTemplate(objectTemplate);
+        setupRigidBody(objectTemplate.getJson());
+    }
 
+    void PhysicsRigidBodySceneObject::setupRigidBody(const ConfigurationReader& conf)
+    {
         ConfigurationReader physicsConfig = conf.getObject(L"Root").getObject(L"Physics");
         if (physicsConfig.isEmpty())
             return;
@@ -120,7 +133,11 @@ namespace lite3dpp_phisics {
 
         collisionShape->setUserPointer(this);
         mBody->setUserPointer(this);
-        mWorld->addRigidBody(mBody.get());
+        mSimulation->getWorld()->addRigidBody(mBody.get());
+        if (mBodyType == BodyKinematic && mSimulation->isAsync())
+        {
+            mSimulation->addKinematic(&mMotionState);
+        }
 
         if (physicsConfig.has(L"Gravity"))
         {
@@ -194,6 +211,16 @@ namespace lite3dpp_phisics {
         return SceneObject::createNode(conf, parent);
     }
 
+    SceneNode* PhysicsRigidBodySceneObject::createNode(const SceneNodePrototype &prototype, SceneNodeBase *parent)
+    {
+        if (prototype.json.has(L"CollisionShape"))
+        {
+            return addCollisiuonShapeNode(prototype.json, parent);
+        }
+
+        return SceneObject::createNode(prototype, parent);
+    }
+
     void PhysicsRigidBodySceneObject::fillRigidBodyInfo(btRigidBody::btRigidBodyConstructionInfo &info, 
         const ConfigurationReader& conf)
     {
@@ -210,23 +237,28 @@ namespace lite3dpp_phisics {
     void PhysicsRigidBodySceneObject::applyCentralImpulse(const kmVec3 &impulse)
     {
         SDL_assert(mBody);
+        mSimulation->wait();
         mBody->applyCentralImpulse(BulletUtils::convert(impulse));
     }
 
     void PhysicsRigidBodySceneObject::applyImpulse(const kmVec3 &impulse, const kmVec3 &relativeOffset)
     {
         SDL_assert(mBody);
+        mSimulation->wait();
         mBody->applyImpulse(BulletUtils::convert(impulse), BulletUtils::convert(relativeOffset));
     }
 
     void PhysicsRigidBodySceneObject::setLinearVelocity(const kmVec3 &velocity)
     {
         SDL_assert(mBody);
+        mSimulation->wait();
         mBody->setLinearVelocity(BulletUtils::convert(velocity));
     }
 
     kmVec3 PhysicsRigidBodySceneObject::getLinearVelocity() const 
     {
+        SDL_assert(mBody);
+        mSimulation->wait();
         return BulletUtils::convert(mBody->getLinearVelocity());
     }
 }}
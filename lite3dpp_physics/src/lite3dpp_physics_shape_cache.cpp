@@ -0,0 +1,165 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp_physics/lite3dpp_physics_shape_cache.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <SDL_log.h>
+#include <SDL_rwops.h>
+#include <lite3dpp_physics/lite3dpp_physics_bullet.h>
+
+namespace lite3dpp {
+namespace lite3dpp_phisics {
+
+    static const constexpr uint32_t ShapeCacheSignature = 0x4C335343; /* L3SC */
+    static const constexpr uint32_t ShapeCacheVersion = 1;
+
+#pragma pack(push, 1)
+    struct ShapeCacheHeader
+    {
+        uint32_t signature;
+        uint32_t version;
+        uint32_t bulletVersion;
+        uint16_t scalarSize;
+        uint16_t pointerSize;
+        uint64_t contentHash;
+        uint32_t shapeType;
+        float margin;
+        uint64_t payloadSize;
+    };
+#pragma pack(pop)
+
+    static ShapeCacheHeader makeHeader(uint64_t contentHash, uint32_t shapeType, float margin, uint64_t payloadSize)
+    {
+        ShapeCacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.signature = ShapeCacheSignature;
+        header.version = ShapeCacheVersion;
+        header.bulletVersion = BT_BULLET_VERSION;
+        header.scalarSize = sizeof(btScalar);
+        header.pointerSize = sizeof(void *);
+        header.contentHash = contentHash;
+        header.shapeType = shapeType;
+        header.margin = margin;
+        header.payloadSize = payloadSize;
+        return header;
+    }
+
+    void PhysicsShapeCache::setDirectory(const String &directory)
+    {
+        mDirectory = directory;
+        if (mDirectory.empty())
+            return;
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(mDirectory.c_str()), error);
+        if (error)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Collision shape cache '%s' disabled: %s", 
+                mDirectory.c_str(), error.message().c_str());
+            mDirectory.clear();
+        }
+    }
+
+    String PhysicsShapeCache::cacheFilePath(uint64_t contentHash, uint32_t shapeType, float margin) const
+    {
+        uint32_t marginBits;
+        std::memcpy(&marginBits, &margin, sizeof(marginBits));
+
+        char fileName[64];
+        std::snprintf(fileName, sizeof(fileName), "%016llx_%u_%08x.shape", 
+            static_cast<unsigned long long>(contentHash), shapeType, marginBits);
+        return (std::filesystem::path(mDirectory.c_str()) / fileName).string().c_str();
+    }
+
+    bool PhysicsShapeCache::load(uint64_t contentHash, uint32_t shapeType, float margin, BufferData &payload)
+    {
+        if (!isEnabled())
+            return false;
+
+        auto path = cacheFilePath(contentHash, shapeType, margin);
+        SDL_RWops *desc = SDL_RWFromFile(path.c_str(), "rb");
+        if (!desc)
+        {
+            mStats.misses++;
+            return false;
+        }
+
+        ShapeCacheHeader header, expected = makeHeader(contentHash, shapeType, margin, 0);
+        bool valid = SDL_RWread(desc, &header, sizeof(header), 1) == 1;
+        expected.payloadSize = header.payloadSize;
+        valid = valid && std::memcmp(&header, &expected, sizeof(header)) == 0 && 
+            header.payloadSize > 0 && 
+            static_cast<uint64_t>(SDL_RWsize(desc)) == sizeof(header) + header.payloadSize;
+
+        if (valid)
+        {
+            payload.resize(static_cast<size_t>(header.payloadSize));
+            valid = SDL_RWread(desc, payload.data(), payload.size(), 1) == 1;
+        }
+
+        SDL_RWclose(desc);
+        if (!valid)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Collision shape cache '%s' is outdated", path.c_str());
+            payload.clear();
+            mStats.misses++;
+            return false;
+        }
+
+        mStats.hits++;
+        return true;
+    }
+
+    void PhysicsShapeCache::store(uint64_t contentHash, uint32_t shapeType, float margin, const void *payload, size_t size)
+    {
+        if (!isEnabled() || size == 0)
+            return;
+
+        auto path = cacheFilePath(contentHash, shapeType, margin);
+        /* пишем во временный файл, чтобы прерванная запись не оставила битый кэш */
+        auto tmpPath = path + ".tmp";
+        SDL_RWops *desc = SDL_RWFromFile(tmpPath.c_str(), "wb");
+        if (!desc)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Collision shape cache '%s': open failed", tmpPath.c_str());
+            return;
+        }
+
+        ShapeCacheHeader header = makeHeader(contentHash, shapeType, margin, size);
+        bool written = SDL_RWwrite(desc, &header, sizeof(header), 1) == 1 && 
+            SDL_RWwrite(desc, payload, size, 1) == 1;
+        SDL_RWclose(desc);
+
+        std::error_code error;
+        if (written)
+        {
+            std::filesystem::rename(std::filesystem::path(tmpPath.c_str()), std::filesystem::path(path.c_str()), error);
+        }
+
+        if (!written || error)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Collision shape cache '%s': write failed", path.c_str());
+            std::filesystem::remove(std::filesystem::path(tmpPath.c_str()), error);
+            return;
+        }
+
+        mStats.stored++;
+    }
+}}
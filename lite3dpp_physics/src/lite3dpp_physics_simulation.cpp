@@ -0,0 +1,280 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <lite3dpp_physics/lite3dpp_physics_simulation.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <SDL_log.h>
+#include <SDL_assert.h>
+#include <lite3dpp_physics/lite3dpp_physics_motion_state.h>
+
+#if BT_BULLET_VERSION >= 287
+#   include <LinearMath/btThreads.h>
+#   include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#   include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#   include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#   define LITE3DPP_PHYSICS_MT
+#endif
+
+namespace lite3dpp {
+namespace lite3dpp_phisics {
+
+#ifdef LITE3DPP_PHYSICS_MT
+    /* Планировщик задач в bullet глобальный, создается один раз на процесс */
+    static btITaskScheduler *taskScheduler(uint32_t workers)
+    {
+        static std::unique_ptr<btITaskScheduler> defaultScheduler(btCreateDefaultTaskScheduler());
+        btITaskScheduler *scheduler = defaultScheduler.get();
+        if (!scheduler)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "PhysicsSimulation: bullet built without threads support, "
+                "multithreaded world disabled");
+            return nullptr;
+        }
+
+        int threads = workers > 0 ? static_cast<int>(workers) : static_cast<int>(std::thread::hardware_concurrency());
+        scheduler->setNumThreads(std::clamp(threads, 1, scheduler->getMaxNumThreads()));
+        btSetTaskScheduler(scheduler);
+        return scheduler;
+    }
+#endif
+
+    PhysicsSimulation::PhysicsSimulation(const Config &config) : 
+        mConfig(config)
+    {
+        SDL_assert(mConfig.fixedTimeStep > 0.0f);
+        createWorld();
+
+        if (mConfig.asyncStep)
+        {
+            /* Точные трансформации последнего шага, интерполяция между шагами делается при передаче в сцену */
+            mWorld->setLatencyMotionStateInterpolation(true);
+            mThread = std::thread(&PhysicsSimulation::threadLoop, this);
+        }
+        else
+        {
+            mWorld->setLatencyMotionStateInterpolation(mConfig.latencyInterpolation);
+        }
+    }
+
+    PhysicsSimulation::~PhysicsSimulation()
+    {
+        if (mThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                mStop = true;
+            }
+
+            mWake.notify_one();
+            mThread.join();
+        }
+
+        mWorld.reset();
+        mConstraintSolver.reset();
+        mSolverPool.reset();
+        mBroadphase.reset();
+        mCollisionDispatcher.reset();
+        mCollisionConfig.reset();
+    }
+
+    void PhysicsSimulation::createWorld()
+    {
+        mBroadphase = std::make_unique<btDbvtBroadphase>();
+
+#ifdef LITE3DPP_PHYSICS_MT
+        if (mConfig.multithreaded && taskScheduler(mConfig.workers))
+        {
+            /* Пулы по умолчанию малы для параллельного поиска контактов */
+            btDefaultCollisionConstructionInfo constructionInfo;
+            constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 80000;
+            constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+            mCollisionConfig = std::make_unique<btDefaultCollisionConfiguration>(constructionInfo);
+            mCollisionDispatcher = std::make_unique<btCollisionDispatcherMt>(mCollisionConfig.get(), 40);
+
+            int poolSize = mConfig.solverPoolSize > 0 ? static_cast<int>(mConfig.solverPoolSize) : 
+                btGetTaskScheduler()->getNumThreads();
+            mSolverPool = std::make_unique<btConstraintSolverPoolMt>(poolSize);
+            mConstraintSolver = std::make_unique<btSequentialImpulseConstraintSolverMt>();
+            mWorld = std::make_unique<btDiscreteDynamicsWorldMt>(mCollisionDispatcher.get(), mBroadphase.get(),
+                mSolverPool.get(), mConstraintSolver.get(), mCollisionConfig.get());
+            mMultithreaded = true;
+
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "PhysicsSimulation: multithreaded world, %d threads, %d solvers",
+                btGetTaskScheduler()->getNumThreads(), poolSize);
+        }
+#else
+        if (mConfig.multithreaded)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "PhysicsSimulation: bullet %d has no multithreaded world",
+                BT_BULLET_VERSION);
+        }
+#endif
+
+        if (!mWorld)
+        {
+            mCollisionConfig = std::make_unique<btDefaultCollisionConfiguration>();
+            mCollisionDispatcher = std::make_unique<btCollisionDispatcher>(mCollisionConfig.get());
+            mConstraintSolver = std::make_unique<btSequentialImpulseConstraintSolver>();
+            mWorld = std::make_unique<btDiscreteDynamicsWorld>(mCollisionDispatcher.get(), mBroadphase.get(), 
+                mConstraintSolver.get(), mCollisionConfig.get());
+        }
+
+        btGImpactCollisionAlgorithm::registerAlgorithm(mCollisionDispatcher.get());
+    }
+
+    btDiscreteDynamicsWorld *PhysicsSimulation::getWorld()
+    {
+        wait();
+        return mWorld.get();
+    }
+
+    void PhysicsSimulation::step(float elapsedSec)
+    {
+        SDL_assert(mWorld);
+        if (!mConfig.asyncStep)
+        {
+            auto start = std::chrono::steady_clock::now();
+            mWorld->stepSimulation(elapsedSec, mConfig.maxSubSteps, mConfig.fixedTimeStep);
+            applyTransforms();
+            mLastStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return;
+        }
+
+        /* Результат прошлого запуска уходит в сцену, пока поток симуляции считает следующий */
+        wait();
+        synchronizeMotionStates();
+
+        for (auto state : mKinematic)
+        {
+            state->captureKinematic();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mJobElapsed = elapsedSec;
+            mHasJob = true;
+        }
+
+        mWake.notify_one();
+    }
+
+    void PhysicsSimulation::wait()
+    {
+        if (!mThread.joinable())
+            return;
+
+        std::unique_lock<std::mutex> lock(mLock);
+        mDone.wait(lock, [this] { return !mHasJob; });
+    }
+
+    void PhysicsSimulation::simulate(float elapsedSec)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mAccumulator += elapsedSec;
+        int steps = 0;
+        while (mAccumulator >= mConfig.fixedTimeStep && steps < mConfig.maxSubSteps)
+        {
+            ++mStepIndex;
+            ++steps;
+            mAccumulator -= mConfig.fixedTimeStep;
+            mWorld->stepSimulation(mConfig.fixedTimeStep, 0, mConfig.fixedTimeStep);
+        }
+
+        /* Не успели, отставание отбрасываем, иначе каждый следующий кадр будет еще тяжелее */
+        if (mAccumulator >= mConfig.fixedTimeStep)
+        {
+            mAccumulator = std::fmod(mAccumulator, mConfig.fixedTimeStep);
+        }
+
+        mLastStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void PhysicsSimulation::synchronizeMotionStates()
+    {
+        float factor = getInterpolationFactor();
+        /* Остановившиеся ставятся в последнее положение и выходят из списка */
+        mInterpolated.erase(std::remove_if(mInterpolated.begin(), mInterpolated.end(), [this, factor](PhysicsObjectMotionState *state)
+        {
+            return !state->applyInterpolated(mStepIndex, factor);
+        }), mInterpolated.end());
+    }
+
+    void PhysicsSimulation::recordTransform(SceneObject *object, const btTransform &transform)
+    {
+        SDL_assert(object && object->getRoot());
+        mTransforms.add(object->getRoot(), BulletUtils::convert(transform.getOrigin()), 
+            BulletUtils::convert(transform.getRotation()));
+    }
+
+    void PhysicsSimulation::applyTransforms()
+    {
+        /* bullet передает только активные тела, спящие сюда не попадают */
+        mTransforms.apply();
+    }
+
+    void PhysicsSimulation::threadLoop()
+    {
+        for (;;)
+        {
+            float elapsedSec;
+            {
+                std::unique_lock<std::mutex> lock(mLock);
+                mWake.wait(lock, [this] { return mHasJob || mStop; });
+                if (mStop)
+                    break;
+                elapsedSec = mJobElapsed;
+            }
+
+            simulate(elapsedSec);
+
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                mHasJob = false;
+            }
+
+            mDone.notify_all();
+        }
+    }
+
+    void PhysicsSimulation::motionStateMoved(PhysicsObjectMotionState *state)
+    {
+        /* Поток рендера трогает список только после wait, состояние попадает в него один раз до остановки */
+        mInterpolated.push_back(state);
+    }
+
+    void PhysicsSimulation::addKinematic(PhysicsObjectMotionState *state)
+    {
+        wait();
+        state->captureKinematic();
+        mKinematic.push_back(state);
+    }
+
+    void PhysicsSimulation::removeMotionState(PhysicsObjectMotionState *state)
+    {
+        wait();
+        auto erase = [state](stl<PhysicsObjectMotionState *>::vector &list)
+        {
+            list.erase(std::remove(list.begin(), list.end(), state), list.end());
+        };
+
+        erase(mInterpolated);
+        erase(mKinematic);
+    }
+}}
@@ -17,6 +17,8 @@
  *******************************************************************************/
 #pragma once 
 
+#include <lite3d/lite3d_readback.h>
+#include <lite3d/lite3d_luminance.h>
 #include <lite3dpp/lite3dpp_main.h>
 #include <lite3dpp_pipeline/lite3dpp_pipeline_common.h>
 
@@ -34,7 +36,9 @@ public:
     TextureRenderTarget &getRenderTarget();
     TextureImage &getLastTexture();
     TextureImage &getMiddleTexture();
-    kmVec3 getLumaAverage() const;
+    /* Гистограмма яркости по последнему завершенному чтению средней текстуры, GPU не ожидается.
+     * Каждый вызов запрашивает новое чтение, false если нового результата еще нет */
+    bool getLuminanceHistogram(lite3d_luminance_histogram &histogram);
 
 private:
 
@@ -58,7 +62,9 @@ private:
     TextureImage *mMiddleTexture = nullptr;
     int mChainState = 0;
     float mBloomRadius = 0.005;
-    mutable PixelsData mBloomPixels;
+    PixelsData mBloomPixels;
+    lite3d_readback mLumaReadback = {};
+    bool mLumaReadbackAsync = false;
 };
 
 }}
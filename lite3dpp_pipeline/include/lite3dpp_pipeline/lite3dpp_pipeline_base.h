@@ -69,6 +69,7 @@ namespace lite3dpp_pipeline {
         void createSkyBoxMesh();
         void createBigTriangleMesh();
         void updateExposure();
+        void adaptExposure(float dt);
 
     protected:
 
@@ -87,12 +88,18 @@ namespace lite3dpp_pipeline {
         Material *mPostProcessStageMaterial = nullptr;
         Material *mSkyBoxStageMaterial = nullptr;
         stl<String>::list mResourcesList;
-        PixelsData mBloomPixels;
 
         float mRandomSeed;
         float mExposureMax = 1.0;
         float mExposureMin = 1.0;
         float mExposureBase = 1.0;
+        float mExposureLowPercentile = 0.5;
+        float mExposureHighPercentile = 0.95;
+        float mAdaptSpeedUp = 3.0;
+        float mAdaptSpeedDown = 1.0;
+        float mLuminance = 0.0;
+        float mLuminanceTarget = 0.0;
+        lite3d_luminance_histogram mLuminanceHistogram = {};
         bool mDynamicExposureEnabled = false;
     };
 }}
@@ -17,7 +17,9 @@
  *******************************************************************************/
 #pragma once 
 
+#include <chrono>
 #include <lite3dpp/lite3dpp_main.h>
+#include <lite3dpp/lite3dpp_shadow_scheduler.h>
 #include <lite3dpp_pipeline/lite3dpp_pipeline_common.h>
 
 namespace lite3dpp {
@@ -28,6 +30,7 @@ class LITE3DPP_PIPELINE_EXPORT ShadowManager : public RenderTargetObserver, publ
 public:
 
     using IndexVector = stl<int32_t>::vector;
+    using CasterMask = ShadowVisibility::CasterMask;
 
 public:
 
@@ -36,7 +39,7 @@ public:
     public:
         
         ShadowCaster(Main& main, const String& name, LightSceneNode* node, 
-            const lite3d_camera::projectionParamsStruct &params);
+            const lite3d_camera::projectionParamsStruct &params, ShadowVisibility &visibility, uint32_t index);
 
         kmMat4 getMatrix();
 
@@ -50,25 +53,32 @@ public:
             return mShadowCamera;
         }
 
+        inline uint32_t getIndex() const
+        {
+            return mIndex;
+        }
+
         inline bool invalidated() const
         {
-            return mInvalidated;
+            return mVisibility.isInvalidated(mIndex);
         }
 
         inline void validate()
         {
-            mInvalidated = false;
+            mVisibility.validateCaster(mIndex);
         }
 
         inline void invalidate()
         {
-            mInvalidated = true;
+            mVisibility.invalidateCaster(mIndex);
         }
 
     private:
 
         void updatePosition(SceneNodeBase *node) override;
         void updateRotation(SceneNodeBase *node) override;
+        void updateTransform(SceneNodeBase *node) override;
+        void updateTransforms(SceneNodeBase *const *nodes, size_t count) override;
         void updateScale(SceneNodeBase *node) override;
         void updateSkeletonPose(SceneNodeBase *node) override;
 
@@ -76,30 +86,33 @@ public:
 
         LightSceneNode* mLightNode = nullptr;
         Camera* mShadowCamera = nullptr;
-        bool mInvalidated = true;
+        ShadowVisibility &mVisibility;
+        uint32_t mIndex;
     };
 
     class LITE3DPP_PIPELINE_EXPORT VisibilityHintNode : public SceneNodeObserver
     {
     public:
     
-        using ShadowCasters = stl<ShadowCaster *>::vector;
-
-        VisibilityHintNode(SceneNodeBase *node);
+        VisibilityHintNode(ShadowVisibility &visibility, SceneNodeBase *node);
 
         void resetVision();
-        void setVisibleFrom(ShadowCaster* sc);
+        void setVisibleFrom(const CasterMask &casters);
 
     private:
 
         void updatePosition(SceneNodeBase *node) override;
         void updateRotation(SceneNodeBase *node) override;
+        void updateTransform(SceneNodeBase *node) override;
+        void updateTransforms(SceneNodeBase *const *nodes, size_t count) override;
         void updateScale(SceneNodeBase *node) override;
         void updateSkeletonPose(SceneNodeBase *node) override;
         void invalidate();
 
+        ShadowVisibility &mVisibility;
         SceneNodeBase *mNode = nullptr;
-        ShadowCasters mVisibility;
+        // Источники света, которым была видна нода в последнем проходе
+        CasterMask mVisibleFrom;
     };
 
     ShadowManager(Main& main, const String& pipelineName, const ConfigurationReader& pipelineConf);
@@ -111,17 +124,41 @@ public:
     VisibilityHintNode* registerHintNodeRecursive(SceneNodeBase *node);
     void unregisterHintNode(SceneNodeBase *node);
     void unregisterHintNodeRecursive(SceneNodeBase *node);
+    // Камера, по которой считается приоритет обновления теней
+    void setViewCamera(Camera *camera);
 
     inline RenderTarget& getShadowPass()
     {
         return *mShadowPass;
     }
 
+    // nullptr если кеш статических теней выключен
+    inline RenderTarget* getStaticShadowPass()
+    {
+        return mStaticShadowPass;
+    }
+
     inline Texture* getShadowMapTexture()
     {
         return mShadowMap;
     }
 
+    inline Texture* getStaticShadowMapTexture()
+    {
+        return mStaticShadowMap;
+    }
+
+    inline const ShadowVisibility& getVisibility() const
+    {
+        return mVisibility;
+    }
+
+    // Счетчики устаревания теней по источникам света
+    inline const ShadowUpdateScheduler& getScheduler() const
+    {
+        return mScheduler;
+    }
+
     inline VBOResource* getShadowMatrixBuffer()
     {
         return mShadowMatrixBuffer;
@@ -150,6 +187,10 @@ protected:
         lite3d_bounding_vol *boundingVol, Camera *camera) override;
 
     void createShadowRenderTarget(const String& pipelineName);
+    void createStaticShadowRenderTarget(const String& pipelineName);
+    void restoreStaticLayers();
+    void scheduleUpdates(const CasterMask &active);
+    ShadowUpdateScheduler::LightState lightState(uint32_t index, bool active) const;
     void createAuxiliaryBuffers(const String& pipelineName);
     void calculateLimits();
 
@@ -159,13 +200,22 @@ private:
     uint32_t mShadowsCastersMaxCount;
     uint32_t mWidth, mHeight;
     RenderTarget* mShadowPass = nullptr;
+    RenderTarget* mStaticShadowPass = nullptr;
     Texture* mShadowMap = nullptr;
+    Texture* mStaticShadowMap = nullptr;
     VBOResource* mShadowMatrixBuffer = nullptr;
     VBOResource* mShadowIndexBuffer = nullptr;
     IndexVector mHostShadowIndexes;
     stl<std::unique_ptr<ShadowCaster>>::vector mShadowCasters;
     stl<SceneNodeBase *, std::shared_ptr<VisibilityHintNode>>::unordered_map mVisibilityHintNodes;
     lite3d_camera::projectionParamsStruct mProjection = {};
+    ShadowVisibility mVisibility;
+    bool mStaticCache = false;
+    ShadowVisibility::Pass mCurrentPass = ShadowVisibility::Pass::None;
+    ShadowUpdateScheduler mScheduler;
+    stl<ShadowUpdateScheduler::LightState>::vector mLightStates;
+    Camera *mViewCamera = nullptr;
+    std::chrono::steady_clock::time_point mPassStart;
     Scene *mCleanStage = nullptr;
     Material *mCleanStageMaterial = nullptr;
 };
@@ -37,6 +37,11 @@ namespace lite3dpp_pipeline {
 
     BloomEffect::~BloomEffect()
     {
+        if (mLumaReadbackAsync)
+        {
+            lite3d_readback_purge(&mLumaReadback);
+        }
+
         if (mBloomRernderer)
         {
             mMain.getResourceManager().releaseResource(mBloomRernderer->getName());
@@ -97,6 +102,9 @@ namespace lite3dpp_pipeline {
 
         initTextureChain();
         initBoomScene();
+
+        /* Без pixel pack буферов и fence объектов яркость читается синхронно */
+        mLumaReadbackAsync = lite3d_readback_init(&mLumaReadback, LITE3D_READBACK_DEPTH_DEFAULT);
     }
 
     bool BloomEffect::beginDrawBatch(Scene *scene, SceneNode *node, lite3d_mesh_chunk *meshChunk, Material *material)
@@ -240,20 +248,32 @@ namespace lite3dpp_pipeline {
         }
     }
 
-    kmVec3 BloomEffect::getLumaAverage() const
+    bool BloomEffect::getLuminanceHistogram(lite3d_luminance_histogram &histogram)
     {
         SDL_assert(mMiddleTexture);
-        mMiddleTexture->getPixels(0, mBloomPixels);
+        const void *texels;
+        size_t size;
 
-        auto it = mBloomPixels.cbegin();
-        kmVec3 lumaAverage = KM_VEC3_ZERO;
-        for (; it != mBloomPixels.cend(); it += sizeof(kmVec3))
+        if (mLumaReadbackAsync)
+        {
+            bool updated = lite3d_readback_poll(&mLumaReadback);
+            lite3d_readback_request_texture(&mLumaReadback, mMiddleTexture->getPtr(), 0);
+            if (!updated)
+            {
+                return false;
+            }
+
+            texels = lite3d_readback_result(&mLumaReadback, &size);
+        }
+        else
         {
-            const kmVec3 *texel = reinterpret_cast<const kmVec3 *>(&(*it));
-            kmVec3Add(&lumaAverage, &lumaAverage, texel);
+            mMiddleTexture->getPixels(0, mBloomPixels);
+            texels = mBloomPixels.data();
+            size = mBloomPixels.size();
         }
 
-        kmVec3Scale(&lumaAverage, &lumaAverage, 1.0f / (mBloomPixels.size() / (3 * sizeof(float))));
-        return lumaAverage;
+        /* Средняя текстура в формате RGB32F */
+        return lite3d_luminance_histogram_build(&histogram, texels, size / (3 * sizeof(float)),
+            LITE3D_LUMINANCE_RGB_FLOAT) == LITE3D_TRUE;
     }
 }}
@@ -23,6 +23,9 @@
 namespace lite3dpp {
 namespace lite3dpp_pipeline {
 
+    // Длина вектора серого RGB с единичной яркостью, прежняя нормировка экспозиции
+    static constexpr float RgbLengthPerLuminance = 1.7320508f;
+
     PipelineBase::PipelineBase(const String &name, const String &path, Main &main) : 
         ConfigurableResource(name, path, main, AbstractResource::PIPELINE)
     {
@@ -198,6 +201,7 @@ namespace lite3dpp_pipeline {
         {
             SDL_assert(mMainScene);
             mMainScene->addObserver(mShadowManager.get());
+            mShadowManager->setViewCamera(mMainCamera);
         }
 
         /* Для обновления параметров шейдеров */
@@ -272,7 +276,8 @@ namespace lite3dpp_pipeline {
             .set(L"RenderBlend", false)
             .set(L"RenderOpaque", true);
 
-        depthPassGeneratedConfig.set(L"RenderInstancing", pipelineConfig.getBool(L"Instancing", true));
+        depthPassGeneratedConfig.set(L"RenderInstancing", pipelineConfig.getBool(L"Instancing", true))
+            .set(L"LevelOfDetail", pipelineConfig.getBool(L"LevelOfDetail", false));
         if (pipelineConfig.getBool(L"OcclusionCulling", true))
         {
             depthPassGeneratedConfig.set(L"OcclusionQuery", true)
@@ -295,16 +300,23 @@ namespace lite3dpp_pipeline {
         mShadowManager = std::make_unique<ShadowManager>(getMain(), getName(), pipelineConfig);
         mShadowManager->initialize(getName(), pipelineConfig.getString(L"ShaderPackage"));
 
-        sceneGenerator.addRenderTarget(cameraName, mShadowManager->getShadowPass().getName(), ConfigurationWriter()
-            .set(L"Priority", static_cast<int>(RenderPassStagePriority::ShadowBuildStage))
-            .set(L"TexturePass", static_cast<int>(TexturePassTypes::ShadowPass))
-            .set(L"DepthTest", true)
-            .set(L"ColorOutput", false)
-            .set(L"DepthOutput", true)
-            .set(L"RenderBlend", false)
-            .set(L"RenderOpaque", true)
-            .set(L"CustomVisibilityCheck", true)
-            .set(L"RenderInstancing", pipelineConfig.getBool(L"Instancing", true)));
+        /* Кеш статических теней рисуется той же сценой, отбор обьектов делает ShadowManager */
+        for (auto rt : { &mShadowManager->getShadowPass(), mShadowManager->getStaticShadowPass() })
+        {
+            if (!rt)
+                continue;
+
+            sceneGenerator.addRenderTarget(cameraName, rt->getName(), ConfigurationWriter()
+                .set(L"Priority", static_cast<int>(RenderPassStagePriority::ShadowBuildStage))
+                .set(L"TexturePass", static_cast<int>(TexturePassTypes::ShadowPass))
+                .set(L"DepthTest", true)
+                .set(L"ColorOutput", false)
+                .set(L"DepthOutput", true)
+                .set(L"RenderBlend", false)
+                .set(L"RenderOpaque", true)
+                .set(L"CustomVisibilityCheck", true)
+                .set(L"RenderInstancing", pipelineConfig.getBool(L"Instancing", true)));
+        }
     }
     
     void PipelineBase::constructBloomPass(const ConfigurationReader &pipelineConfig, const String &cameraName)
@@ -398,6 +410,14 @@ namespace lite3dpp_pipeline {
             mExposureMax = dynamicExposureConfig.getDouble(L"ExposureMax", 1.0);
             mExposureMin = dynamicExposureConfig.getDouble(L"ExposureMin", 1.0);
             mExposureBase = dynamicExposureConfig.getDouble(L"ExposureBase", 1.0);
+            // Доли самых темных и самых ярких пикселей которые не учитываются в средней яркости
+            mExposureLowPercentile = dynamicExposureConfig.getDouble(L"LowPercentile", mExposureLowPercentile);
+            mExposureHighPercentile = dynamicExposureConfig.getDouble(L"HighPercentile", mExposureHighPercentile);
+            // Скорость адаптации при увеличении и уменьшении яркости сцены
+            mAdaptSpeedUp = dynamicExposureConfig.getDouble(L"AdaptSpeedUp", mAdaptSpeedUp);
+            mAdaptSpeedDown = dynamicExposureConfig.getDouble(L"AdaptSpeedDown", mAdaptSpeedDown);
+            lite3d_luminance_histogram_init(&mLuminanceHistogram, LITE3D_LUMINANCE_LOG2_MIN_DEFAULT,
+                LITE3D_LUMINANCE_LOG2_MAX_DEFAULT);
         }
     }
 
@@ -549,31 +569,46 @@ namespace lite3dpp_pipeline {
             return;
         }
 
-        mBloomEffect->getMiddleTexture().getPixels(0, mBloomPixels);
+        /* Гистограмма чтения запрошенного несколько кадров назад, кадр не ждет GPU */
+        if (!mBloomEffect->getLuminanceHistogram(mLuminanceHistogram))
+        {
+            return;
+        }
+
+        auto luminance = lite3d_luminance_histogram_average(&mLuminanceHistogram,
+            mExposureLowPercentile, mExposureHighPercentile);
+        if (luminance > 0.0f)
+        {
+            mLuminanceTarget = luminance;
+        }
+    }
 
-        auto it = mBloomPixels.begin();
-        kmVec3 rgbAverage = KM_VEC3_ZERO;
-        for (; it != mBloomPixels.end(); )
+    void PipelineBase::adaptExposure(float dt)
+    {
+        if (!mPostProcessStageMaterial || !mDynamicExposureEnabled || mLuminanceTarget <= 0.0f)
         {
-            rgbAverage.x += *reinterpret_cast<float *>(&(*it)); it += sizeof(float);
-            rgbAverage.y += *reinterpret_cast<float *>(&(*it)); it += sizeof(float);
-            rgbAverage.z += *reinterpret_cast<float *>(&(*it)); it += sizeof(float);
+            return;
         }
 
-        kmVec3Scale(&rgbAverage, &rgbAverage, 1.0f / (mBloomPixels.size() / (3 * sizeof(float))));
-        auto exposure = mExposureBase / kmVec3Length(&rgbAverage);
+        mLuminance = lite3d_luminance_adapt(mLuminance, mLuminanceTarget, dt, mAdaptSpeedUp, mAdaptSpeedDown);
+        // ExposureBase в конфигах подобран под длину среднего RGB, у серого цвета она в sqrt(3) раз 
+        // больше яркости Rec.709, приводим яркость к той же шкале
+        auto exposure = mExposureBase / (mLuminance * RgbLengthPerLuminance);
         exposure = std::max(mExposureMin, std::min(mExposureMax, exposure));
         mPostProcessStageMaterial->setFloatParameter(static_cast<int>(TexturePassTypes::RenderPass), "Exposure", exposure);
     }
 
     void PipelineBase::frameBegin()
     {
-        // Обновление экспозиции каждые 10 кадров
+        // Обновление целевой яркости каждые 10 кадров
         auto renderStats = getMain().getRenderStats();
         if ((renderStats->framesCount % 10) == 0)
         {
             updateExposure();
         }
+
+        // Экспозиция плавно подстраивается каждый кадр
+        adaptExposure(renderStats->lastFrameMs / 1000.0f);
     }
 
     bool PipelineBase::beginSceneRender(Scene *scene, Camera *camera)
@@ -77,6 +77,8 @@ namespace lite3dpp_pipeline {
             .set(L"RenderBlend", false)
             .set(L"RenderOpaque", true)
             .set(L"OcclusionCulling", pipelineConfig.getBool(L"OcclusionCulling", true))
+            .set(L"ClusterCulling", pipelineConfig.getBool(L"ClusterCulling", false))
+            .set(L"LevelOfDetail", pipelineConfig.getBool(L"LevelOfDetail", false))
             .set(L"RenderInstancing", pipelineConfig.getBool(L"Instancing", true)));
 
         sceneGenerator.addRenderTarget(cameraName, mCombinePass->getName(), ConfigurationWriter()
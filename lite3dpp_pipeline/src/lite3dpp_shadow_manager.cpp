@@ -18,16 +18,20 @@
 #include <lite3dpp_pipeline/lite3dpp_shadow_manager.h>
 
 #include <algorithm>
+#include <cmath>
 #include <SDL_assert.h>
+#include <SDL_log.h>
 #include <lite3dpp_pipeline/lite3dpp_generator.h>
 
 namespace lite3dpp {
 namespace lite3dpp_pipeline {
 
     ShadowManager::ShadowCaster::ShadowCaster(Main& main, const String& name, LightSceneNode* node, 
-        const lite3d_camera::projectionParamsStruct &params) : 
+        const lite3d_camera::projectionParamsStruct &params, ShadowVisibility &visibility, uint32_t index) : 
         mLightNode(node),
-        mShadowCamera(main.addCamera(name))
+        mShadowCamera(main.addCamera(name)),
+        mVisibility(visibility),
+        mIndex(index)
     {
         SDL_assert(node);
         // Ставим перспективу сразу при инициализации, считаем что конус источника света не меняется 
@@ -64,6 +68,16 @@ namespace lite3dpp_pipeline {
         invalidate();
     }
 
+    void ShadowManager::ShadowCaster::updateTransform(SceneNodeBase *node)
+    {
+        invalidate();
+    }
+
+    void ShadowManager::ShadowCaster::updateTransforms(SceneNodeBase *const *nodes, size_t count)
+    {
+        invalidate();
+    }
+
     void ShadowManager::ShadowCaster::updateScale(SceneNodeBase *node)
     {
         invalidate();
@@ -74,7 +88,8 @@ namespace lite3dpp_pipeline {
         invalidate();
     }
 
-    ShadowManager::VisibilityHintNode::VisibilityHintNode(SceneNodeBase *node) : 
+    ShadowManager::VisibilityHintNode::VisibilityHintNode(ShadowVisibility &visibility, SceneNodeBase *node) : 
+        mVisibility(visibility),
         mNode(node)
     {
         SDL_assert(mNode);
@@ -83,23 +98,18 @@ namespace lite3dpp_pipeline {
 
     void ShadowManager::VisibilityHintNode::resetVision()
     {
-        mVisibility.clear();
+        mVisibleFrom.reset();
     }
 
-    void ShadowManager::VisibilityHintNode::setVisibleFrom(ShadowCaster* sc)
+    void ShadowManager::VisibilityHintNode::setVisibleFrom(const CasterMask &casters)
     {
-        if (std::find(mVisibility.begin(), mVisibility.end(), sc) == mVisibility.end())
-        {
-            mVisibility.emplace_back(sc);
-        }
+        mVisibleFrom |= casters;
     }
 
     void ShadowManager::VisibilityHintNode::invalidate()
     {
-        for (auto shadowCaster: mVisibility)
-        {
-            shadowCaster->invalidate();
-        }
+        // Динамический обьект: кеш статики остается валидным
+        mVisibility.invalidateCasters(mVisibleFrom);
     }
 
     void ShadowManager::VisibilityHintNode::updatePosition(SceneNodeBase *node)
@@ -112,6 +122,16 @@ namespace lite3dpp_pipeline {
         invalidate();
     }
 
+    void ShadowManager::VisibilityHintNode::updateTransform(SceneNodeBase *node)
+    {
+        invalidate();
+    }
+
+    void ShadowManager::VisibilityHintNode::updateTransforms(SceneNodeBase *const *nodes, size_t count)
+    {
+        invalidate();
+    }
+
     void ShadowManager::VisibilityHintNode::updateScale(SceneNodeBase *node)
     {
         invalidate();
@@ -123,10 +143,30 @@ namespace lite3dpp_pipeline {
     }
 
     ShadowManager::ShadowManager(Main& main, const String& pipelineName, const ConfigurationReader& conf) : 
-        mMain(main)
+        mMain(main),
+        mVisibility(conf.getObject(L"ShadowMaps").getDouble(L"CellSize", ShadowVisibility::DefaultCellSize))
     {
         auto shadowConf = conf.getObject(L"ShadowMaps");
         mShadowsCastersMaxCount = shadowConf.getInt(L"MaxCount", 1);
+        mStaticCache = shadowConf.getBool(L"StaticCache", false);
+
+        // Без настроек обновляются все невалидные тени каждый кадр, как раньше
+        ShadowUpdateScheduler::Config schedulerConfig;
+        if (shadowConf.has(L"Scheduler"))
+        {
+            auto schedulerConf = shadowConf.getObject(L"Scheduler");
+            schedulerConfig.maxUpdatesPerFrame = schedulerConf.getInt(L"MaxUpdatesPerFrame", 0);
+            schedulerConfig.budgetMs = schedulerConf.getDouble(L"BudgetMs", 0.0);
+            schedulerConfig.maxStaleFrames = schedulerConf.getInt(L"MaxStaleFrames", schedulerConfig.maxStaleFrames);
+            schedulerConfig.initialLayerCostMs = schedulerConf.getDouble(L"InitialLayerCostMs", 
+                schedulerConfig.initialLayerCostMs);
+            schedulerConfig.coverageWeight = schedulerConf.getDouble(L"CoverageWeight", schedulerConfig.coverageWeight);
+            schedulerConfig.distanceWeight = schedulerConf.getDouble(L"DistanceWeight", schedulerConfig.distanceWeight);
+            schedulerConfig.distanceScale = schedulerConf.getDouble(L"DistanceScale", schedulerConfig.distanceScale);
+            schedulerConfig.movementWeight = schedulerConf.getDouble(L"MovementWeight", schedulerConfig.movementWeight);
+            schedulerConfig.ageWeight = schedulerConf.getDouble(L"AgeWeight", schedulerConfig.ageWeight);
+        }
+        mScheduler.setConfig(schedulerConfig);
         // Важно выделить вектор заранее, чтобы реалокаций небыло
         mShadowCasters.reserve(mShadowsCastersMaxCount);
         mWidth = shadowConf.getInt(L"Width", 1024);
@@ -157,11 +197,21 @@ namespace lite3dpp_pipeline {
             mMain.getResourceManager().releaseResource(mShadowPass->getName());
         }
 
+        if (mStaticShadowPass)
+        {
+            mMain.getResourceManager().releaseResource(mStaticShadowPass->getName());
+        }
+
         if (mShadowMap)
         {
             mMain.getResourceManager().releaseResource(mShadowMap->getName());
         }
 
+        if (mStaticShadowMap)
+        {
+            mMain.getResourceManager().releaseResource(mStaticShadowMap->getName());
+        }
+
         if (mShadowMatrixBuffer)
         {
             mMain.getResourceManager().releaseResource(mShadowMatrixBuffer->getName());
@@ -182,7 +232,7 @@ namespace lite3dpp_pipeline {
 
         auto index = static_cast<uint32_t>(mShadowCasters.size());
         mShadowCasters.emplace_back(std::make_unique<ShadowCaster>(mMain, lightNode->getName() + std::to_string(index), 
-            lightNode, mProjection));
+            lightNode, mProjection, mVisibility, index));
         // Запишем в источник света индекс его теневой матрицы в UBO
         lightNode->getLight()->setShadowIndex(index);
         lightNode->getLight()->setFlag(LightSourceFlags::CastShadow);
@@ -206,7 +256,7 @@ namespace lite3dpp_pipeline {
             return it->second.get();
         }
 
-        auto hintPtr = std::make_shared<VisibilityHintNode>(node);
+        auto hintPtr = std::make_shared<VisibilityHintNode>(mVisibility, node);
         mVisibilityHintNodes.emplace(node, hintPtr);
         return hintPtr.get();
     }
@@ -252,19 +302,91 @@ namespace lite3dpp_pipeline {
         mVisibilityHintNodes.erase(it);
     }
 
+    void ShadowManager::setViewCamera(Camera *camera)
+    {
+        mViewCamera = camera;
+    }
+
+    ShadowUpdateScheduler::LightState ShadowManager::lightState(uint32_t index, bool active) const
+    {
+        ShadowUpdateScheduler::LightState state;
+        state.pending = active && (mVisibility.isInvalidated(index) || 
+            (mStaticCache && mVisibility.isStaticInvalidated(index)));
+        state.moving = mVisibility.changedCasters().test(index);
+        state.coverage = 1.0f;
+
+        // Направленный свет накрывает весь экран
+        const auto light = mShadowCasters[index]->getNode()->getLight();
+        if (!mViewCamera || light->getType() == LightSourceFlags::TypeDirectional)
+        {
+            return state;
+        }
+
+        kmVec3 viewPos;
+        kmVec3MultiplyMat4(&viewPos, &light->getWorldPosition(), &mViewCamera->getViewMatrix());
+        state.distance = kmVec3Length(&viewPos);
+
+        // Доля экрана по угловому размеру сферы влияния света
+        float radius = light->getInfluenceDistance();
+        const auto &params = mViewCamera->getPtr()->projectionParams;
+        if (!mViewCamera->getPtr()->isOrtho && state.distance > radius && params.fovy > 0.0f)
+        {
+            float size = radius / (state.distance * std::tan(kmDegreesToRadians(params.fovy) * 0.5f));
+            state.coverage = std::min(size * size, 1.0f);
+        }
+
+        return state;
+    }
+
+    void ShadowManager::scheduleUpdates(const CasterMask &active)
+    {
+        mLightStates.resize(mShadowCasters.size());
+        for (uint32_t index = 0; index < mShadowCasters.size(); ++index)
+        {
+            mLightStates[index] = lightState(index, active.test(index));
+        }
+
+        mVisibility.resetChanged();
+        mScheduler.schedule(mLightStates.data(), static_cast<uint32_t>(mLightStates.size()));
+    }
+
     bool ShadowManager::beginUpdate(RenderTarget *rt)
     { 
         SDL_assert(mShadowMatrixBuffer);
         SDL_assert(mShadowIndexBuffer);
 
-        mHostShadowIndexes.resize(1, 0); // Reserve 0 index for size
-        // Обновим матрицы по всем источникам отбрасывающим тень которые влияют на текущий кадр
+        CasterMask active;
+        // Обновим матрицы по всем источникам отбрасывающим тень, видимость обьектов пересчитается
+        // только для источников, матрица которых поменялась
         for (uint32_t index = 0; index < mShadowCasters.size(); ++index)
         {
             auto &shadowCaster = mShadowCasters[index];
-            auto mat = shadowCaster->getMatrix();
-            if (shadowCaster->invalidated() && shadowCaster->getNode()->isVisible())
+            mVisibility.setCaster(index, shadowCaster->getMatrix());
+            if (shadowCaster->getNode()->isVisible())
             {
+                active.set(index);
+            }
+        }
+
+        // Какие тени обновлять решается раз за кадр, на первом теневом проходе
+        if (rt == (mStaticShadowPass ? mStaticShadowPass : mShadowPass))
+        {
+            scheduleUpdates(active);
+        }
+
+        // Остальные невалидные тени ждут своей очереди
+        active &= mScheduler.getScheduled();
+
+        // Сначала перерисовываем кеш статики, потом итоговые карты
+        mCurrentPass = rt == mStaticShadowPass ? ShadowVisibility::Pass::Static : ShadowVisibility::Pass::Main;
+        const auto &passCasters = mVisibility.beginPass(mCurrentPass, active);
+
+        mHostShadowIndexes.resize(1, 0); // Reserve 0 index for size
+        for (uint32_t index = 0; index < mShadowCasters.size(); ++index)
+        {
+            if (passCasters.test(index))
+            {
+                auto mat = mShadowCasters[index]->getCamera()->getProjViewMatrix();
                 mShadowMatrixBuffer->setElement<kmMat4>(index, &mat);
                 mHostShadowIndexes.emplace_back(index);
             }
@@ -274,17 +396,60 @@ namespace lite3dpp_pipeline {
         // Если тени перересовывать не надо то просто переходим к следующией RT
         if (mHostShadowIndexes.size() == 1)
         {
+            mCurrentPass = ShadowVisibility::Pass::None;
             return false;
         }
 
         mShadowIndexBuffer->setData(&mHostShadowIndexes[0], 0, mHostShadowIndexes.size() * sizeof(IndexVector::value_type));
+
+        // Подчистим списки источников света для которых эта нода видима перед проверкой фрустума.
+        for (auto& node: mVisibilityHintNodes)
+        {
+            node.second->resetVision();
+        }
+
+        if (mCurrentPass == ShadowVisibility::Pass::Main && mStaticCache)
+        {
+            restoreStaticLayers();
+        }
+
+        mPassStart = std::chrono::steady_clock::now();
         return true;
     }
 
+    void ShadowManager::restoreStaticLayers()
+    {
+        SDL_assert(mStaticShadowMap);
+        // Слои копируются на GPU сериями соседних индексов, очистка итоговых карт при этом не нужна
+        for (size_t i = 1; i < mHostShadowIndexes.size();)
+        {
+            size_t j = i + 1;
+            while (j < mHostShadowIndexes.size() && mHostShadowIndexes[j] == mHostShadowIndexes[j - 1] + 1)
+            {
+                j++;
+            }
+
+            if (!lite3d_texture_unit_copy_layers(mStaticShadowMap->getPtr(), mShadowMap->getPtr(), 0,
+                mHostShadowIndexes[i], mHostShadowIndexes[i], static_cast<int32_t>(j - i)))
+            {
+                LITE3D_THROW("Failed to restore static shadow layers " << mHostShadowIndexes[i] << ".." 
+                    << mHostShadowIndexes[j - 1]);
+            }
+
+            i = j;
+        }
+    }
+
     bool ShadowManager::beginSceneRender(Scene *scene, Camera *camera)
     {
         if (scene == mCleanStage)
         {
+            // С кешем статики итоговые слои уже восстановлены копированием, чистить нечего
+            if (mCurrentPass == ShadowVisibility::Pass::Main && mStaticCache)
+            {
+                return false;
+            }
+
             // Так как мы используем texture_array для хранения теневых карт мы в режиме layered render мы не можем подчистить
             // отдельную карту теней, а перерисовываем мы не все. Для очистки только нужных теневых карт используем предварительный 
             // проход с BigTriangle (сцена shadow_clean) устанавливающий во все фрагменты теневого буфера значение 1.0, но дело в том что его надо 
@@ -303,11 +468,6 @@ namespace lite3dpp_pipeline {
         if (scene == mCleanStage)
         {
             RenderTarget::depthTestFunc(RenderTarget::TestFuncLEqual);
-            // Подчистим списки источников света для которых эта нода видима перед проверкой фрустума.
-            for (auto& node: mVisibilityHintNodes)
-            {
-                node.second->resetVision();
-            }
         }
     }
 
@@ -315,25 +475,21 @@ namespace lite3dpp_pipeline {
     bool ShadowManager::customVisibilityCheck(Scene *scene, SceneNodeBase *node, lite3d_mesh_chunk *meshChunk, Material *material, 
         lite3d_bounding_vol *boundingVol, Camera *camera)
     {
+        if (mCurrentPass == ShadowVisibility::Pass::None)
+        {
+            return false;
+        }
+
         auto it = mVisibilityHintNodes.find(node);
         VisibilityHintNode* dnode = it != mVisibilityHintNodes.end() ? it->second.get() : nullptr;
 
-        bool isVisible = false;
-        for (auto& shadowCaster: mShadowCasters)
+        // Маска источников света берется из сетки, обьекты проверяются заново только если сдвинулись
+        CasterMask visibleFrom;
+        bool isVisible = mVisibility.approve(boundingVol, dnode != nullptr, visibleFrom);
+        if (dnode)
         {
-            if (shadowCaster->getCamera()->inFrustum(*boundingVol))
-            {
-                if (dnode)
-                {
-                    // Текущая нода видима для этого истоника света, запомним это
-                    dnode->setVisibleFrom(shadowCaster.get());
-                }
-
-                if (shadowCaster->invalidated())
-                {
-                    isVisible = true;
-                }
-            }
+            // Текущая нода видима для этих истоников света, запомним это
+            dnode->setVisibleFrom(visibleFrom);
         }
 
         return isVisible;
@@ -342,9 +498,13 @@ namespace lite3dpp_pipeline {
     void ShadowManager::postUpdate(RenderTarget *rt)
     {
         // Валидейтим только перересованные тени, остальные будут перерисованы потом когда попадут в область видимости
-        for (size_t i = 1; i < mHostShadowIndexes.size(); ++i)
+        if (mCurrentPass != ShadowVisibility::Pass::None)
         {
-            mShadowCasters[mHostShadowIndexes[i]]->validate();
+            // Время отправки команд на CPU, GPU время без timer query неизвестно, но растет с ним вместе
+            std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - mPassStart;
+            mScheduler.reportCost(elapsed.count(), static_cast<uint32_t>(mHostShadowIndexes.size() - 1));
+            mVisibility.endPass();
+            mCurrentPass = ShadowVisibility::Pass::None;
         }
     }
 
@@ -376,7 +536,7 @@ namespace lite3dpp_pipeline {
         uint32_t b = maxGeometryOutputVertices / 3;
         uint32_t c = UBOMaxSize / sizeof(kmMat4);
 
-        uint32_t shadowCastersLimit = std::min(std::min(a, b), c);
+        uint32_t shadowCastersLimit = std::min({ a, b, c, ShadowVisibility::MaxCasters });
 
         if (mShadowsCastersMaxCount > shadowCastersLimit)
         {
@@ -420,21 +580,77 @@ namespace lite3dpp_pipeline {
         mShadowPass->addObserver(this);
     }
 
+    void ShadowManager::createStaticShadowRenderTarget(const String& pipelineName)
+    {
+        // Кеш статических теней: такой же массив слоев, итоговые слои собираются из него копированием на GPU
+        auto staticShadowMapName = pipelineName + "_StaticShadowMap.texture";
+        ConfigurationWriter shadowTextureConfig;
+        shadowTextureConfig.set(L"TextureType", "2D_SHADOW_ARRAY")
+            .set(L"Filtering", "Linear")
+            .set(L"Wrapping", "ClampToEdge")
+            .set(L"Compression", false)
+            .set(L"TextureFormat", "DEPTH")
+            .set(L"Height", mHeight)
+            .set(L"Width", mWidth)
+            .set(L"Depth", mShadowsCastersMaxCount);
+
+        mStaticShadowMap = mMain.getResourceManager().queryResourceFromJson<TextureImage>(staticShadowMapName, 
+            shadowTextureConfig.write());
+
+        // RT с тем же приоритетом добавляется перед уже существующим, поэтому кеш обновляется раньше итоговых карт
+        ConfigurationWriter shadowRenderTargetConfig;
+        shadowRenderTargetConfig.set(L"Width", mWidth)
+            .set(L"Height", mHeight)
+            .set(L"BackgroundColor", kmVec4 { 0.0f, 0.0f, 0.0f, 1.0f })
+            .set(L"Priority", static_cast<int>(RenderPassPriority::ShadowMap))
+            .set(L"CleanColorBuf", false)
+            .set(L"CleanDepthBuf", false)
+            .set(L"CleanStencilBuf", false)
+            .set(L"LayeredFramebuffer", true)
+            .set(L"DepthAttachments", ConfigurationWriter()
+                .set(L"TextureName", staticShadowMapName));
+
+        mStaticShadowPass = mMain.getResourceManager().queryResourceFromJson<TextureRenderTarget>(
+            pipelineName + "_StaticShadowPass", shadowRenderTargetConfig.write());
+        mStaticShadowPass->addObserver(this);
+    }
+
     void ShadowManager::initialize(const String& pipelineName, const String& shaderPackage)
     {
         createAuxiliaryBuffers(pipelineName);
         createShadowRenderTarget(pipelineName);
 
+        if (mStaticCache && !lite3d_texture_unit_copy_support())
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "ShadowManager: static shadows cache is disabled, "
+                "texture copy is not supported");
+            mStaticCache = false;
+        }
+
+        if (mStaticCache)
+        {
+            createStaticShadowRenderTarget(pipelineName);
+        }
+
+        mVisibility.setStaticCache(mStaticCache);
+
         // Создание специальной сцены для предварительной частичной очистки теневых карт которые надо перерисовать в текущем кадре.
+        // С кешем статики она же чистит перестраиваемые слои кеша.
         BigTriSceneGenerator stageGenerator;
-        stageGenerator.addRenderTarget(mShadowPass->getName(), ConfigurationWriter()
-            .set(L"Priority", static_cast<int>(RenderPassStagePriority::ShadowCleanStage))
-            .set(L"TexturePass", static_cast<int>(TexturePassTypes::ShadowPass))
-            .set(L"DepthTest", true)
-            .set(L"ColorOutput", false)
-            .set(L"DepthOutput", true)
-            .set(L"RenderBlend", false)
-            .set(L"RenderOpaque", true));
+        for (auto rt : { mShadowPass, mStaticShadowPass })
+        {
+            if (!rt)
+                continue;
+
+            stageGenerator.addRenderTarget(rt->getName(), ConfigurationWriter()
+                .set(L"Priority", static_cast<int>(RenderPassStagePriority::ShadowCleanStage))
+                .set(L"TexturePass", static_cast<int>(TexturePassTypes::ShadowPass))
+                .set(L"DepthTest", true)
+                .set(L"ColorOutput", false)
+                .set(L"DepthOutput", true)
+                .set(L"RenderBlend", false)
+                .set(L"RenderOpaque", true));
+        }
             
         mCleanStage = mMain.getResourceManager().queryResourceFromJson<Scene>(pipelineName + "_ShadowCleanStage",
             stageGenerator.generate().write());
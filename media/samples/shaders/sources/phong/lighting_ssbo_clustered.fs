@@ -0,0 +1,84 @@
+#include "samples:shaders/sources/common/common_inc.glsl"
+
+layout(std430) readonly buffer lightSources
+{
+    LightSource lights[];
+};
+
+/*
+ * Light grid of main camera (Scene "LightClusters" option):
+ * [0..3] tilesX, tilesY, slices, global lights count
+ * [4..7] slice scale, slice bias, tan of half fov x, tan of half fov y (float bits)
+ * then offset and count pair for every cluster, then indexes list with global lights first
+ */
+layout(std430) readonly buffer lightClusters
+{
+    int clusterData[];
+};
+
+/* view matrix of the camera the grid was built for, the scene sets it as global parameter */
+uniform mat4 CameraView;
+
+vec3 phong_blinn_single(vec3 lightDir, vec3 eyeDir, vec3 normal, in LightSource source,
+    float specularFactor, float wrapAroundFactor, float specPower, inout vec3 linearSpec);
+
+int cluster_of_fragment(vec3 fragPos)
+{
+    ivec3 size = ivec3(clusterData[0], clusterData[1], clusterData[2]);
+    vec4 params = intBitsToFloat(ivec4(clusterData[4], clusterData[5], clusterData[6], clusterData[7]));
+    vec3 viewPos = (CameraView * vec4(fragPos, 1.0)).xyz;
+    float depth = max(-viewPos.z, 1e-4);
+
+    ivec3 cluster;
+    cluster.xy = ivec2((viewPos.xy / (depth * params.zw) * 0.5 + 0.5) * vec2(size.xy));
+    cluster.z = int(log(depth) * params.x + params.y);
+    cluster = clamp(cluster, ivec3(0), size - 1);
+
+    return (cluster.z * size.y + cluster.y) * size.x + cluster.x;
+}
+
+vec3 calc_lighting(vec3 fragPos,
+    vec3 fragNormal, vec3 eye, float specularFactor,
+    float wrapAroundFactor, float specPower, inout vec3 linearSpec)
+{
+    vec3 linear = vec3(0.0);
+    vec3 lightDir = vec3(0.0);
+
+    /* calculate direction from fragment to eye */
+    vec3 eyeDir = normalize(eye - fragPos);
+
+    int cluster = cluster_of_fragment(fragPos);
+    int indexesBegin = 8 + clusterData[0] * clusterData[1] * clusterData[2] * 2;
+    int globalCount = clusterData[3];
+    int clusterOffset = clusterData[8 + cluster * 2];
+    int count = globalCount + clusterData[8 + cluster * 2 + 1];
+
+    for(int i = 0; i < count; i++)
+    {
+        /* global lights first, then lights of the cluster */
+        int index = clusterData[indexesBegin + (i < globalCount ? i : clusterOffset + i - globalCount)];
+        LightSource light = lights[index];
+
+        if (!hasFlag(light.flags, LITE3D_LIGHT_ENABLED))
+            continue;
+
+        /* Read Position and check distance for spot and point light only */
+        if (hasFlag(light.flags, LITE3D_LIGHT_POINT) || hasFlag(light.flags, LITE3D_LIGHT_SPOT))
+        {
+            /* calculate direction from fragment to light */
+            lightDir = light.position.xyz - fragPos;
+            /* distance to light */
+            float dist = length(lightDir);
+            /* check light distance */
+            if (dist > light.influenceDistance)
+                continue;
+        }
+
+        vec3 curSpec = vec3(0.0);
+        linear += phong_blinn_single(lightDir, eyeDir, fragNormal, light,
+            specularFactor, wrapAroundFactor, specPower, curSpec);
+        linearSpec += curSpec;
+    }
+
+    return linear;
+}
@@ -0,0 +1,12 @@
+uniform sampler2DArray GlyphAtlas;
+
+in vec3 uv;
+in vec4 color;
+out vec4 fragcolor;
+
+void main()
+{
+    // atlas keeps glyph coverage only, color comes from the quad
+    float coverage = texture(GlyphAtlas, uv).r;
+    fragcolor = vec4(color.rgb, color.a * coverage);
+}
\ No newline at end of file
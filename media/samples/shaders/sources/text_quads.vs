@@ -0,0 +1,36 @@
+layout(location = 0) in vec4 v;
+layout(location = 1) in vec2 tc;
+
+// TextBatch: one glyph per instance, unused slots have zero size
+struct GlyphQuad
+{
+    vec4 rect;
+    vec4 uv;
+    uint color;
+    uint page;
+    uint padding0;
+    uint padding1;
+};
+
+layout(std430) readonly buffer glyphQuads 
+{
+    GlyphQuad quads[];
+};
+
+out vec3 uv;
+out vec4 color;
+
+// common functions
+vec4 rtransform(vec4 v1);
+
+void main()
+{
+    GlyphQuad quad = quads[gl_InstanceID];
+    // rect is in pixels with y down, atlas rows are stored top to bottom,
+    // quad mesh is a plane with tc (0, 0) at the top left corner
+    vec2 corner = tc;
+    vec2 pos = quad.rect.xy + quad.rect.zw * corner;
+    uv = vec3(mix(quad.uv.xy, quad.uv.zw, corner), float(quad.page));
+    color = unpackUnorm4x8(quad.color);
+    gl_Position = rtransform(vec4(pos.x, -pos.y, 0.0, 1.0));
+}
@@ -95,6 +95,15 @@ void Sample::initGui()
     mHelpTexture = mMain.getResourceManager().
         queryResource<lite3dpp_font::FontTexture>("arial512x512.texture",
         "samples:textures/json/arial512x512.json");
+    /* stat overlay texture is a blank panel only, text is drawn over it by glyph quads */
+    mStatTexture->clean();
+    mStatTexture->uploadChanges();
+
+    /* atlas texture and quads buffer are bound by stat_text.material, create them before the scene */
+    mStatFont = std::make_unique<lite3dpp_font::GlyphAtlas>(mMain, "StatFont", "samples:fonts/arial.ttf", 12, 256, 1);
+    mStatText = std::make_unique<lite3dpp_font::TextBatch>(*mStatFont);
+    mStatQuads = mMain.getResourceManager().queryResourceFromJson<SSBO>("StatTextQuads",
+        "{\"Dynamic\": true}");
     
     mGuiScene = mMain.getResourceManager().queryResource<Scene>("GUI",
         "samples:scenes/gui.json");
@@ -102,6 +111,8 @@ void Sample::initGui()
     mGuiCamera = getMain().getCamera("GuiCamera");
     mStatOverlay = mGuiScene->getObject("StatOverlay");
     mHelpOverlay = mGuiScene->getObject("HelpOverlay");
+    /* one label takes all glyph instances of the text node */
+    mStatLabel = mStatText->addLabel(static_cast<MeshSceneNode *>(mStatOverlay->getNode("Text.node"))->getInstances());
     setGuiSize(mMainWindow->width(), mMainWindow->height());
     
     mStatTimer = mMain.addTimer("StatTimer", 500);
@@ -118,6 +129,13 @@ void Sample::init()
     mMain.showSystemCursor(false);
 }
 
+void Sample::shut()
+{
+    /* atlas releases its texture, do it before main releases all resources */
+    mStatText.reset();
+    mStatFont.reset();
+}
+
 void Sample::fixedUpdateTimerTick(int32_t firedPerRound, uint64_t deltaMcs, float deltaRetard)
 {}
 
@@ -272,7 +290,7 @@ void Sample::setFullscreen(bool fullscreen)
 
 void Sample::updateGui()
 {
-    SDL_assert(mStatTexture);
+    SDL_assert(mStatText);
     SDL_assert(mHelpTexture);
     const lite3d_render_stats *renderStats = mMain.getRenderStats();
     
@@ -287,9 +305,10 @@ void Sample::updateGui()
             renderStats->lastFPS, renderStats->lastFrameMs, renderStats->drawCalls, 
             renderStats->totalPieces, renderStats->trianglesRendered);
 
-        mStatTexture->clean();
-        mStatTexture->drawText(strbuf, textPos, textColor);
-        mStatTexture->uploadChanges();
+        /* only glyphs of the changed label and new glyphs of the atlas are uploaded */
+        mStatText->setLabel(mStatLabel, strbuf, kmVec2 { 14.0f, 12.0f }, textColor);
+        mStatText->upload(*mStatQuads);
+        mStatFont->uploadChanges();
     }
 
     if (mHelpOverlay->isEnabled())
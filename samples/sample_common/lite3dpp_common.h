@@ -22,6 +22,7 @@
 
 #include <lite3dpp/lite3dpp_main.h>
 #include <lite3dpp_font/lite3dpp_font_texture.h>
+#include <lite3dpp_font/lite3dpp_font_text_batch.h>
 
 namespace lite3dpp {
 namespace samples {
@@ -44,6 +45,7 @@ public:
     Sample(const std::string_view &sampleHelpString = "");
 
     void init() override;
+    void shut() override;
     void timerTick(lite3d_timer *timerid) override;
     void processEvent(SDL_Event *e) override;
     void frameEnd() override;
@@ -97,6 +99,10 @@ private:
     WindowRenderTarget *mMainWindow = nullptr;
     lite3dpp_font::FontTexture *mStatTexture = nullptr;
     lite3dpp_font::FontTexture *mHelpTexture = nullptr;
+    std::unique_ptr<lite3dpp_font::GlyphAtlas> mStatFont;
+    std::unique_ptr<lite3dpp_font::TextBatch> mStatText;
+    lite3dpp_font::TextBatch::LabelId mStatLabel = 0;
+    SSBO *mStatQuads = nullptr;
     lite3d_timer *mStatTimer = nullptr;
     kmVec2 mWCenter = KM_VEC2_ZERO;
     std::optional<kmVec2> mCameraAngles;
@@ -16,6 +16,9 @@
  *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
  *******************************************************************************/
 #include <ctime>
+#include <chrono>
+#include <filesystem>
+#include <SDL_log.h>
 
 #include <sample_common/lite3dpp_common.h>
 #include <lite3dpp_physics/lite3dpp_physics_scene.h>
@@ -28,7 +31,8 @@ static const char *helpString =
     "Press 'e' to drop compound coss body\n"
     "Press 'x' to drop compound Z body\n"
     "Press 'q' to drop compound T body\n"
-    "Press 'r' to show/hide coord arrows\n";
+    "Press 'r' to show/hide coord arrows\n"
+    "Press 'b' to benchmark collision shape cache\n";
 
 class BoxesColliderSample : public Sample
 {
@@ -87,6 +91,10 @@ public:
                 
                 mCubes.push_back(newObject);
             }
+            else if (e->key.keysym.sym == SDLK_b)
+            {
+                benchmarkShapeCache();
+            }
             else if (e->key.keysym.sym == SDLK_r)
             {
                 mArrowsEnabled = !mArrowsEnabled;
@@ -101,10 +109,73 @@ public:
         }
     }
     
+    // Время создания коллизионных форм: без кэша (cold) и из заполненного кэша (warm)
+    void benchmarkShapeCache()
+    {
+        using lite3dpp_phisics::PhysicsTriangleCollisionShape;
+        static const char *meshes[] = {
+            "samples:models/json/ComplexShape.json",
+            "samples:models/json/SKL_Robot.json",
+            "samples:models/json/minigun.json",
+            "samples:models/json/plasmagun.json",
+            "samples:models/json/battery.json"
+        };
+
+        auto &shapeManager = mScene->getCollisionShapeManager();
+        auto &shapeCache = shapeManager.getShapeCache();
+        String cacheDirectory = shapeCache.getDirectory();
+        /* отдельный каталог бенчмарка внутри настроенного кэша, иначе во временном каталоге */
+        std::error_code error;
+        std::filesystem::path benchDirectory = cacheDirectory.empty() ? 
+            std::filesystem::temp_directory_path(error) / "lite3d" : std::filesystem::path(cacheDirectory.c_str());
+        if (error)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Collision shapes benchmark skipped: %s", error.message().c_str());
+            return;
+        }
+        String benchCacheDirectory = (benchDirectory / "shapes_bench").string().c_str();
+
+        for (auto type : { PhysicsTriangleCollisionShape::ConvexHull, PhysicsTriangleCollisionShape::StaticTriangleMesh })
+        {
+            double coldMs = 0.0, warmMs = 0.0;
+            for (const char *mesh : meshes)
+            {
+                ConfigurationWriter collisionMesh;
+                collisionMesh.set(L"Name", String("ShapeCacheBench_") + mesh);
+                collisionMesh.set(L"Mesh", mesh);
+                ConfigurationWriter shapeConfig;
+                shapeConfig.set(L"CollisionMesh", collisionMesh);
+                String json = shapeConfig.write();
+                ConfigurationReader conf(json.data(), json.size());
+                String name = conf.getObject(L"CollisionMesh").getString(L"Name");
+
+                auto measure = [&]()
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    shapeManager.getCollisionShape(type, conf);
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+                    shapeManager.removeCollisionShapeItem(type, name);
+                    return std::chrono::duration<double, std::milli>(elapsed).count();
+                };
+
+                shapeCache.setDirectory("");
+                coldMs += measure();
+                shapeCache.setDirectory(benchCacheDirectory);
+                measure();
+                warmMs += measure();
+            }
+
+            SDL_Log("Collision shapes %s: cold %.3f ms, warm %.3f ms", 
+                type == PhysicsTriangleCollisionShape::ConvexHull ? "ConvexHull" : "StaticTriangleMesh", coldMs, warmMs);
+        }
+
+        shapeCache.setDirectory(cacheDirectory);
+    }
+
 private:
 
     stl<SceneObject *>::list mCubes;
-    Scene *mScene = nullptr;
+    lite3dpp_phisics::PhysicsScene *mScene = nullptr;
     int mBoxCounter = 0;
     bool mArrowsEnabled = true;
 
@@ -0,0 +1,263 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <iostream>
+#include <string.h>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_array.h>
+
+/* Growth as it was done before realloc support, used as the benchmark baseline */
+static void *legacy_array_add(lite3d_array *a)
+{
+    if (a->size == a->capacity)
+    {
+        void *pnew;
+        size_t s = a->capacity << 1;
+
+        if (!(pnew = lite3d_malloc(s * a->elemSize)))
+            return NULL;
+
+        memcpy(pnew, a->data, a->size * a->elemSize);
+        lite3d_free(a->data);
+        a->data = pnew;
+        a->capacity = s;
+    }
+
+    a->size++;
+    return lite3d_array_get(a, a->size - 1);
+}
+
+class Array_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    template<class F>
+    static void measure(const char *name, size_t queueSize, F func)
+    {
+        const int frames = 2000;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i)
+            func(queueSize);
+        auto mcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << name << " queue " << queueSize << ": " << mcs << " mcs per " << frames << " frames" << std::endl;
+    }
+};
+
+TEST_F(Array_Test, GrowAndShrink)
+{
+    lite3d_array arr;
+    lite3d_array_init(&arr, sizeof(uint32_t), 0);
+    EXPECT_EQ(arr.capacity, 0u);
+
+    for (uint32_t i = 0; i < 1000; ++i)
+        LITE3D_ARR_ADD_ELEM(&arr, uint32_t, i);
+
+    EXPECT_EQ(arr.size, 1000u);
+    EXPECT_EQ(arr.capacity, 1024u);
+    for (uint32_t i = 0; i < 1000; ++i)
+        EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint32_t, i), i);
+
+    lite3d_array_clean(&arr);
+    EXPECT_EQ(arr.size, 0u);
+    EXPECT_EQ(arr.capacity, 1024u);
+
+    LITE3D_ARR_ADD_ELEM(&arr, uint32_t, 7);
+    EXPECT_TRUE(lite3d_array_shrink(&arr));
+    EXPECT_EQ(arr.capacity, 1u);
+    EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint32_t, 0), 7u);
+
+    EXPECT_TRUE(lite3d_array_reserve(&arr, 100));
+    EXPECT_EQ(arr.capacity, 100u);
+    EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint32_t, 0), 7u);
+
+    lite3d_array_purge(&arr);
+    EXPECT_TRUE(arr.data == NULL);
+    EXPECT_EQ(arr.capacity, 0u);
+}
+
+TEST_F(Array_Test, InlineStorage)
+{
+    lite3d_array arr;
+    uint64_t storage[4];
+    lite3d_array_init_inline(&arr, sizeof(uint64_t), storage, 4);
+
+    for (uint64_t i = 0; i < 4; ++i)
+        LITE3D_ARR_ADD_ELEM(&arr, uint64_t, i);
+    EXPECT_EQ(arr.data, (void *)storage);
+
+    /* spill to heap */
+    LITE3D_ARR_ADD_ELEM(&arr, uint64_t, 4);
+    EXPECT_NE(arr.data, (void *)storage);
+    EXPECT_EQ(arr.capacity, 8u);
+    for (uint64_t i = 0; i < 5; ++i)
+        EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint64_t, i), i);
+
+    /* back to inline storage */
+    lite3d_array_remove(&arr, 4);
+    EXPECT_TRUE(lite3d_array_shrink(&arr));
+    EXPECT_EQ(arr.data, (void *)storage);
+    EXPECT_EQ(arr.capacity, 4u);
+    for (uint64_t i = 0; i < 4; ++i)
+        EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint64_t, i), i);
+
+    lite3d_array_purge(&arr);
+    EXPECT_EQ(arr.data, (void *)storage);
+    EXPECT_EQ(arr.size, 0u);
+}
+
+TEST_F(Array_Test, BulkAppend)
+{
+    lite3d_array arr;
+    uint32_t src[100];
+    for (uint32_t i = 0; i < 100; ++i)
+        src[i] = i;
+
+    lite3d_array_init(&arr, sizeof(uint32_t), 2);
+    LITE3D_ARR_ADD_ELEM(&arr, uint32_t, 1000);
+    uint32_t *first = static_cast<uint32_t *>(lite3d_array_append(&arr, src, 100));
+    ASSERT_TRUE(first != NULL);
+    EXPECT_EQ(first, LITE3D_ARR_GET_FIRST(&arr, uint32_t) + 1);
+    EXPECT_EQ(arr.size, 101u);
+    EXPECT_EQ(arr.capacity, 128u);
+    EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint32_t, 0), 1000u);
+    for (uint32_t i = 0; i < 100; ++i)
+        EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint32_t, i + 1), i);
+
+    /* uninitialized append */
+    EXPECT_TRUE(lite3d_array_append(&arr, NULL, 27) != NULL);
+    EXPECT_EQ(arr.size, 128u);
+    EXPECT_EQ(arr.capacity, 128u);
+
+    lite3d_array_purge(&arr);
+}
+
+TEST_F(Array_Test, FrameStorage)
+{
+    lite3d_array arr;
+    lite3d_frame_arena_next();
+    ASSERT_TRUE(lite3d_array_init_frame(&arr, sizeof(uint32_t), 4));
+    EXPECT_EQ(arr.capacity, 4u);
+
+    for (uint32_t i = 0; i < 100; ++i)
+        LITE3D_ARR_ADD_ELEM(&arr, uint32_t, i);
+
+    EXPECT_EQ(arr.size, 100u);
+    EXPECT_EQ(arr.capacity, 128u);
+    for (uint32_t i = 0; i < 100; ++i)
+        EXPECT_EQ(LITE3D_ARR_ELEM(&arr, uint32_t, i), i);
+
+    /* next frame starts from the capacity reached by the previous one */
+    void *prev = arr.data;
+    lite3d_frame_arena_next();
+    ASSERT_TRUE(lite3d_array_init_frame(&arr, sizeof(uint32_t), arr.capacity));
+    EXPECT_NE(arr.data, prev);
+    EXPECT_EQ(arr.capacity, 128u);
+    EXPECT_EQ(arr.size, 0u);
+
+    /* memory belongs to the arena */
+    lite3d_array_purge(&arr);
+    EXPECT_TRUE(arr.data == NULL);
+}
+
+TEST_F(Array_Test, PerfomanceColdQueue)
+{
+    /* Queue created, filled and destroyed every frame */
+    for (size_t queueSize : { 16, 256, 4096 })
+    {
+        measure("legacy  cold", queueSize, [](size_t count)
+        {
+            lite3d_array arr;
+            lite3d_array_init(&arr, sizeof(void *), 2);
+            for (size_t i = 0; i < count; ++i)
+                *static_cast<size_t *>(legacy_array_add(&arr)) = i;
+            lite3d_array_purge(&arr);
+        });
+
+        measure("realloc cold", queueSize, [](size_t count)
+        {
+            lite3d_array arr;
+            lite3d_array_init(&arr, sizeof(void *), 2);
+            for (size_t i = 0; i < count; ++i)
+                LITE3D_ARR_ADD_ELEM(&arr, size_t, i);
+            lite3d_array_purge(&arr);
+        });
+
+        measure("inline  cold", queueSize, [](size_t count)
+        {
+            lite3d_array arr;
+            void *storage[64];
+            lite3d_array_init_inline(&arr, sizeof(void *), storage, 64);
+            for (size_t i = 0; i < count; ++i)
+                LITE3D_ARR_ADD_ELEM(&arr, size_t, i);
+            lite3d_array_purge(&arr);
+        });
+
+        measure("bulk    cold", queueSize, [](size_t count)
+        {
+            lite3d_array arr;
+            size_t batch[64];
+            lite3d_array_init(&arr, sizeof(void *), 2);
+            for (size_t i = 0; i < count; i += 64)
+            {
+                size_t n = std::min<size_t>(64, count - i);
+                for (size_t j = 0; j < n; ++j)
+                    batch[j] = i + j;
+                lite3d_array_append(&arr, batch, n);
+            }
+            lite3d_array_purge(&arr);
+        });
+    }
+}
+
+TEST_F(Array_Test, PerfomanceSteadyQueue)
+{
+    /* Queue lives between frames and only cleaned, like the scene stages */
+    for (size_t queueSize : { 16, 256, 4096 })
+    {
+        lite3d_array arr;
+        lite3d_array_init(&arr, sizeof(void *), 2);
+        measure("add     steady", queueSize, [&arr](size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+                LITE3D_ARR_ADD_ELEM(&arr, size_t, i);
+            lite3d_array_clean(&arr);
+        });
+
+        measure("bulk    steady", queueSize, [&arr](size_t count)
+        {
+            size_t batch[64];
+            for (size_t i = 0; i < count; i += 64)
+            {
+                size_t n = std::min<size_t>(64, count - i);
+                for (size_t j = 0; j < n; ++j)
+                    batch[j] = i + j;
+                lite3d_array_append(&arr, batch, n);
+            }
+            lite3d_array_clean(&arr);
+        });
+
+        lite3d_array_purge(&arr);
+    }
+}
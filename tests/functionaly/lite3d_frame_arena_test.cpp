@@ -0,0 +1,230 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL_thread.h>
+
+#include "lite3d_common_test.h"
+#include <lite3d/lite3d_alloc.h>
+#include <lite3dpp/lite3dpp_manageable.h>
+
+static std::atomic<int64_t> gHeapAllocations(0);
+
+static void *counting_malloc(size_t size)
+{
+    gHeapAllocations++;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *p, size_t size)
+{
+    gHeapAllocations++;
+    return realloc(p, size);
+}
+
+class FrameArena_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+};
+
+TEST_F(FrameArena_Test, LifetimeAndReuse)
+{
+    lite3d_frame_arena_next();
+    uint32_t *prev = static_cast<uint32_t *>(lite3d_frame_alloc(sizeof(uint32_t) * 100));
+    ASSERT_TRUE(prev != NULL);
+    EXPECT_EQ(reinterpret_cast<size_t>(prev) % LITE3D_FRAME_ARENA_ALIGN, 0u);
+    for (uint32_t i = 0; i < 100; ++i)
+        prev[i] = i;
+
+    /* data of the previous frame is still alive */
+    lite3d_frame_arena_next();
+    uint32_t *cur = static_cast<uint32_t *>(lite3d_frame_calloc(sizeof(uint32_t) * 100));
+    ASSERT_TRUE(cur != NULL);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(prev[i], i);
+        EXPECT_EQ(cur[i], 0u);
+    }
+
+    /* two frames later the memory is reused */
+    lite3d_frame_arena_next();
+    EXPECT_EQ(lite3d_frame_alloc(sizeof(uint32_t) * 100), static_cast<void *>(prev));
+}
+
+TEST_F(FrameArena_Test, HighWaterAndSteadyState)
+{
+    lite3d_frame_arena_stats stats;
+    int32_t heapAllocations = 0;
+
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        lite3d_frame_arena_next();
+        /* 300 kb at peak, overflows the default block */
+        for (int i = 0; i < 30 + (frame % 3) * 5; ++i)
+            ASSERT_TRUE(lite3d_frame_alloc(8 * 1024) != NULL);
+
+        if (frame == 10)
+        {
+            lite3d_frame_arena_get_stats(&stats);
+            heapAllocations = stats.heapAllocations;
+        }
+    }
+
+    lite3d_frame_arena_next();
+    lite3d_frame_arena_get_stats(&stats);
+    EXPECT_EQ(stats.heapAllocations, heapAllocations);
+    EXPECT_EQ(stats.lastFrameBytes, 30u * 8 * 1024);
+    EXPECT_GE(stats.highWaterBytes, 40u * 8 * 1024);
+    EXPECT_EQ(stats.frameBytes, 0u);
+}
+
+TEST_F(FrameArena_Test, FrameVector)
+{
+    lite3d_frame_arena_stats stats;
+    lite3d_frame_arena_next();
+
+    lite3dpp::stl<int32_t>::frame_vector indexes;
+    indexes.reserve(1000);
+    for (int32_t i = 0; i < 1500; ++i)
+        indexes.emplace_back(i);
+
+    /* both blocks, before and after regrowth, are taken from the arena */
+    lite3d_frame_arena_get_stats(&stats);
+    EXPECT_GE(stats.frameBytes, (1000u + 2000u) * sizeof(int32_t));
+    EXPECT_EQ(reinterpret_cast<size_t>(indexes.data()) % LITE3D_FRAME_ARENA_ALIGN, 0u);
+    for (int32_t i = 0; i < 1500; ++i)
+        EXPECT_EQ(indexes[i], i);
+}
+
+TEST_F(FrameArena_Test, CleanupWithLiveThread)
+{
+    struct ThreadState
+    {
+        SDL_sem *allocated;
+        SDL_sem *cleaned;
+        void *mem;
+    } state;
+
+    state.allocated = SDL_CreateSemaphore(0);
+    state.cleaned = SDL_CreateSemaphore(0);
+    state.mem = NULL;
+
+    SDL_Thread *thread = SDL_CreateThread([](void *userdata) -> int
+    {
+        ThreadState *state = static_cast<ThreadState *>(userdata);
+        state->mem = lite3d_frame_alloc(1024);
+        SDL_SemPost(state->allocated);
+        SDL_SemWait(state->cleaned);
+        /* arena of this thread outlives the cleanup, it is freed on thread exit */
+        memset(lite3d_frame_alloc(1024), 0, 1024);
+        return 0;
+    }, "frame_arena_test", &state);
+
+    ASSERT_TRUE(thread != NULL);
+    SDL_SemWait(state.allocated);
+    EXPECT_TRUE(state.mem != NULL);
+    lite3d_frame_alloc(1024);
+
+    lite3d_memory_cleanup();
+    lite3d_memory_init(NULL);
+    SDL_SemPost(state.cleaned);
+    SDL_WaitThread(thread, NULL);
+
+    /* this thread gets new arena */
+    lite3d_frame_arena_next();
+    EXPECT_TRUE(lite3d_frame_alloc(1024) != NULL);
+
+    SDL_DestroySemaphore(state.allocated);
+    SDL_DestroySemaphore(state.cleaned);
+}
+
+class FrameArenaLoop_Test : public Lite3dCommon
+{
+public:
+
+    FrameArenaLoop_Test()
+    {
+        settings().userAllocator.mallocf = counting_malloc;
+        settings().userAllocator.freef = free;
+        settings().userAllocator.reallocf = counting_realloc;
+        settings().renderLisneters.preRender = [](void *) -> int { return LITE3D_TRUE; };
+        settings().renderLisneters.postFrame = postFrame;
+    }
+
+    static int postFrame(void *userdata)
+    {
+        static int frame = 0;
+        static int64_t steadyAllocations = 0;
+        static uint8_t *transients[2] = { NULL, NULL };
+        static size_t sizes[2] = { 0, 0 };
+
+        /* some transient data per frame, tagged by the frame number */
+        size_t size = 64 * 1024 + (frame % 4) * 1024;
+        uint8_t *transient = static_cast<uint8_t *>(lite3d_frame_alloc(size));
+        EXPECT_TRUE(transient != NULL);
+        if (!transient)
+            return LITE3D_FALSE;
+        memset(transient, frame & 0xff, size);
+
+        /* data of the previous frame is untouched and does not overlap the current one */
+        if (transients[1])
+        {
+            EXPECT_TRUE(transient + size <= transients[1] || transients[1] + sizes[1] <= transient);
+            size_t damaged = 0;
+            for (size_t i = 0; i < sizes[1]; ++i)
+                damaged += transients[1][i] != ((frame - 1) & 0xff);
+            EXPECT_EQ(damaged, 0u);
+        }
+
+        /* in steady state the buffer of the frame before previous is reused from its start */
+        if (frame >= 10)
+        {
+            EXPECT_EQ(transient, transients[0]);
+        }
+
+        transients[0] = transients[1];
+        sizes[0] = sizes[1];
+        transients[1] = transient;
+        sizes[1] = size;
+        frame++;
+
+        if (frame == 10)
+        {
+            steadyAllocations = gHeapAllocations;
+        }
+        else if (frame == 50)
+        {
+            EXPECT_EQ(gHeapAllocations, steadyAllocations);
+            return LITE3D_FALSE;
+        }
+
+        return LITE3D_TRUE;
+    }
+};
+
+TEST_F(FrameArenaLoop_Test, NoHeapAllocationsInSteadyFrame)
+{
+    EXPECT_TRUE(main());
+}
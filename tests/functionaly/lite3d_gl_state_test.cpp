@@ -0,0 +1,194 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_gl_state.h>
+
+/* records calls which would reach the driver */
+static std::vector<std::string> gCalls;
+
+static void mock_active_texture(uint32_t unit)
+{
+    gCalls.push_back("active " + std::to_string(unit));
+}
+
+static void mock_bind_texture(uint32_t target, uint32_t textureID)
+{
+    gCalls.push_back("texture " + std::to_string(target) + " " + std::to_string(textureID));
+}
+
+static void mock_bind_buffer_base(uint8_t kind, uint32_t index, uint32_t bufferID)
+{
+    gCalls.push_back("buffer " + std::to_string(kind) + " " + std::to_string(index) + " " +
+        std::to_string(bufferID));
+}
+
+class GLState_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    void SetUp() override
+    {
+        static const lite3d_gl_state_backend backend = {
+            mock_active_texture,
+            mock_bind_texture,
+            mock_bind_buffer_base
+        };
+
+        lite3d_gl_state_set_backend(&backend);
+        lite3d_gl_state_stats_reset();
+        gCalls.clear();
+    }
+
+    void TearDown() override
+    {
+        lite3d_gl_state_set_backend(NULL);
+    }
+
+    lite3d_gl_state_stats stats()
+    {
+        lite3d_gl_state_stats s;
+        lite3d_gl_state_get_stats(&s);
+        return s;
+    }
+};
+
+static const uint32_t TEX_2D = 0x0DE1;
+static const uint32_t TEX_3D = 0x806F;
+
+TEST_F(GLState_Test, TextureBindings)
+{
+    lite3d_gl_state_bind_texture(0, TEX_2D, 5);
+    lite3d_gl_state_bind_texture(1, TEX_2D, 6);
+    /* same textures again, e.g. next pass of the same material */
+    lite3d_gl_state_bind_texture(0, TEX_2D, 5);
+    lite3d_gl_state_bind_texture(1, TEX_2D, 6);
+    /* same id on another target must be bound */
+    lite3d_gl_state_bind_texture(1, TEX_3D, 6);
+    /* active unit is already 1 */
+    lite3d_gl_state_bind_texture_active(TEX_3D, 6);
+    lite3d_gl_state_bind_texture_active(TEX_2D, 7);
+
+    std::vector<std::string> expected = {
+        "active 0", "texture 3553 5",
+        "active 1", "texture 3553 6",
+        "texture 32879 6",
+        "texture 3553 7"
+    };
+    EXPECT_EQ(gCalls, expected);
+    EXPECT_EQ(stats().textureBinds, 4);
+    EXPECT_EQ(stats().textureBindsAvoided, 3);
+
+    /* upload on unit 1 replaced its binding, unit 1 must be rebound */
+    gCalls.clear();
+    lite3d_gl_state_bind_texture(1, TEX_3D, 6);
+    lite3d_gl_state_bind_texture(0, TEX_2D, 5);
+    expected = { "texture 32879 6" };
+    EXPECT_EQ(gCalls, expected);
+}
+
+TEST_F(GLState_Test, ForgetDeletedObjects)
+{
+    lite3d_gl_state_bind_texture(2, TEX_2D, 9);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_UNIFORM, 0, 3);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_STORAGE, 0, 3);
+    /* uniform and storage bindings are independent */
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_UNIFORM, 0, 3);
+    EXPECT_EQ(stats().bufferBinds, 2);
+    EXPECT_EQ(stats().bufferBindsAvoided, 1);
+
+    /* ids are reused by driver after delete */
+    lite3d_gl_state_forget_texture(9);
+    lite3d_gl_state_forget_buffer(3);
+    gCalls.clear();
+    lite3d_gl_state_bind_texture(2, TEX_2D, 9);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_UNIFORM, 0, 3);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_STORAGE, 0, 3);
+
+    std::vector<std::string> expected = {
+        "texture 3553 9", "buffer 0 0 3", "buffer 1 0 3"
+    };
+    EXPECT_EQ(gCalls, expected);
+
+    /* bindings out of shadow range are passed through */
+    gCalls.clear();
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_UNIFORM, LITE3D_GL_STATE_BUFFER_BINDINGS_MAX, 1);
+    lite3d_gl_state_bind_buffer_base(LITE3D_GL_STATE_BUFFER_UNIFORM, LITE3D_GL_STATE_BUFFER_BINDINGS_MAX, 1);
+    EXPECT_EQ(gCalls.size(), 2u);
+
+    lite3d_gl_state_invalidate();
+    gCalls.clear();
+    lite3d_gl_state_bind_texture(2, TEX_2D, 9);
+    expected = { "active 2", "texture 3553 9" };
+    EXPECT_EQ(gCalls, expected);
+}
+
+TEST_F(GLState_Test, UniformValues)
+{
+    lite3d_array cache;
+    memset(&cache, 0, sizeof(cache));
+    float vec[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+    int32_t sampler = 3;
+
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, 7, vec, sizeof(vec)));
+    EXPECT_FALSE(lite3d_gl_state_uniform_changed(&cache, 7, vec, sizeof(vec)));
+    vec[3] = 5.0f;
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, 7, vec, sizeof(vec)));
+    /* same bytes of different size are not the same value */
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, 7, vec, sizeof(float) * 3));
+
+    /* fresh location is always sent, even with zero value */
+    sampler = 0;
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, 2, &sampler, sizeof(sampler)));
+    EXPECT_FALSE(lite3d_gl_state_uniform_changed(&cache, 2, &sampler, sizeof(sampler)));
+
+    /* not cached locations */
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, -1, &sampler, sizeof(sampler)));
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, LITE3D_GL_STATE_UNIFORM_LOCATION_MAX, &sampler, sizeof(sampler)));
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, LITE3D_GL_STATE_UNIFORM_LOCATION_MAX, &sampler, sizeof(sampler)));
+    EXPECT_EQ(cache.size, 8u);
+
+    /* program relinked */
+    lite3d_array_clean(&cache);
+    EXPECT_TRUE(lite3d_gl_state_uniform_changed(&cache, 2, &sampler, sizeof(sampler)));
+
+    EXPECT_EQ(stats().uniforms, 8);
+    EXPECT_EQ(stats().uniformsAvoided, 2);
+    lite3d_array_purge(&cache);
+}
+
+TEST_F(GLState_Test, StateChanges)
+{
+    lite3d_gl_state_count_state(LITE3D_TRUE);
+    lite3d_gl_state_count_state(LITE3D_FALSE);
+    lite3d_gl_state_count_state(LITE3D_FALSE);
+    EXPECT_EQ(stats().stateChanges, 1);
+    EXPECT_EQ(stats().stateChangesAvoided, 2);
+
+    lite3d_gl_state_stats_reset();
+    EXPECT_EQ(stats().stateChanges, 0);
+    EXPECT_EQ(stats().stateChangesAvoided, 0);
+}
@@ -0,0 +1,229 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <SDL_log.h>
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_logger.h>
+
+static const char *LogFile = "lite3d_logger_test.log";
+
+class Logger_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    void SetUp() override
+    {
+        std::remove(LogFile);
+        lite3d_logger_get_stats(&mBefore);
+    }
+
+    void TearDown() override
+    {
+        release();
+        std::remove(LogFile);
+    }
+
+    void setup(bool async, uint32_t queueSize, int policy, bool flushAlways = false)
+    {
+        mActive = true;
+        lite3d_logger_setup(LogFile);
+        lite3d_logger_set_logParams(LITE3D_LOGLEVEL_INFO, flushAlways, LITE3D_TRUE);
+        if (async)
+        {
+            ASSERT_TRUE(lite3d_logger_start_async(queueSize, policy));
+        }
+    }
+
+    /* every producer writes messages "<thread>:<index>" */
+    static void produce(int threads, int messages)
+    {
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t)
+        {
+            producers.emplace_back([t, messages]()
+            {
+                for (int i = 0; i < messages; ++i)
+                    SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "producer %d:%d payload payload payload", t, i);
+            });
+        }
+
+        for (auto &producer : producers)
+            producer.join();
+    }
+
+    void release()
+    {
+        if (mActive)
+            lite3d_logger_release();
+        mActive = false;
+    }
+
+    lite3d_logger_stats delta()
+    {
+        lite3d_logger_stats stats;
+        lite3d_logger_get_stats(&stats);
+        stats.queued -= mBefore.queued;
+        stats.written -= mBefore.written;
+        stats.dropped -= mBefore.dropped;
+        stats.blocked -= mBefore.blocked;
+        return stats;
+    }
+
+    lite3d_logger_stats mBefore;
+    bool mActive = false;
+};
+
+TEST_F(Logger_Test, AsyncKeepsEveryMessage)
+{
+    const int threads = 4, messages = 3000;
+    setup(true, 64, LITE3D_LOG_OVERFLOW_BLOCK);
+    produce(threads, messages);
+    lite3d_logger_flush();
+
+    lite3d_logger_stats stats = delta();
+    EXPECT_EQ(stats.queued, threads * messages);
+    EXPECT_EQ(stats.written, threads * messages);
+    EXPECT_EQ(stats.dropped, 0);
+
+    /* order of messages of one producer is kept */
+    std::vector<int> next(threads, 0);
+    std::ifstream log(LogFile);
+    std::string line;
+    int lines = 0;
+    while (std::getline(log, line))
+    {
+        int t, i;
+        size_t pos = line.find("producer ");
+        ASSERT_NE(pos, std::string::npos) << line;
+        ASSERT_EQ(sscanf(line.c_str() + pos, "producer %d:%d", &t, &i), 2);
+        ASSERT_EQ(next[t], i);
+        next[t]++;
+        lines++;
+    }
+
+    EXPECT_EQ(lines, threads * messages);
+}
+
+TEST_F(Logger_Test, DropPolicyCountsLostMessages)
+{
+    const int threads = 4, messages = 2000;
+    setup(true, 4, LITE3D_LOG_OVERFLOW_DROP);
+    produce(threads, messages);
+    lite3d_logger_flush();
+
+    lite3d_logger_stats stats = delta();
+    EXPECT_EQ(stats.queued + stats.dropped, threads * messages);
+    EXPECT_EQ(stats.written, stats.queued);
+    EXPECT_EQ(stats.blocked, 0);
+
+    /* messages logged after release are written directly */
+    release();
+    SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "after release");
+    EXPECT_EQ(delta().queued, stats.queued);
+}
+
+TEST_F(Logger_Test, AsyncKeepsLongMessages)
+{
+    /* shader info logs are usually longer than a few hundred bytes */
+    std::string message(SDL_MAX_LOG_MESSAGE - 1, 'x');
+    message.replace(message.size() - 4, 4, "tail");
+    setup(true, 8, LITE3D_LOG_OVERFLOW_BLOCK);
+    SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s", message.c_str());
+    release();
+
+    std::ifstream log(LogFile);
+    std::string line;
+    ASSERT_TRUE(std::getline(log, line));
+    EXPECT_NE(line.find(message), std::string::npos);
+}
+
+TEST_F(Logger_Test, ReleaseWhileProducing)
+{
+    std::atomic_bool stop(false);
+    std::vector<std::thread> producers;
+    /* no log file, producers may outlive it */
+    mActive = true;
+    lite3d_logger_setup(NULL);
+    lite3d_logger_set_logParams(LITE3D_LOGLEVEL_INFO, LITE3D_FALSE, LITE3D_TRUE);
+    ASSERT_TRUE(lite3d_logger_start_async(16, LITE3D_LOG_OVERFLOW_BLOCK));
+
+    for (int t = 0; t < 4; ++t)
+    {
+        producers.emplace_back([t, &stop]()
+        {
+            for (int i = 0; !stop; ++i)
+                SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "producer %d:%d", t, i);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    /* queue is released while producers still log, they switch to direct output */
+    release();
+    stop = true;
+    for (auto &producer : producers)
+        producer.join();
+
+    lite3d_logger_stats stats = delta();
+    EXPECT_GT(stats.queued, 0);
+    EXPECT_EQ(stats.written, stats.queued);
+}
+
+TEST_F(Logger_Test, PerfomanceProducers)
+{
+    const int messages = 20000;
+
+    for (int threads : { 1, 2, 4, 8 })
+    {
+        double rate[2];
+        for (int async = 0; async < 2; ++async)
+        {
+            /* flush is enabled in sample configs */
+            setup(async, LITE3D_LOG_QUEUE_DEFAULT, LITE3D_LOG_OVERFLOW_BLOCK, true);
+            auto begin = std::chrono::steady_clock::now();
+            produce(threads, messages);
+            /* producers time only, writer continues in background */
+            auto producersTime = std::chrono::steady_clock::now() - begin;
+            release();
+            std::remove(LogFile);
+
+            rate[async] = threads * messages /
+                std::chrono::duration_cast<std::chrono::duration<double>>(producersTime).count();
+        }
+
+        std::cout << threads << " producers: sync " << static_cast<int64_t>(rate[0]) << " msg/s, async "
+            << static_cast<int64_t>(rate[1]) << " msg/s" << std::endl;
+    }
+
+    lite3d_logger_stats stats = delta();
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(stats.written, stats.queued);
+}
@@ -0,0 +1,244 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_luminance.h>
+
+class Luminance_Test : public ::testing::Test
+{
+protected:
+
+    void SetUp() override
+    {
+        lite3d_luminance_histogram_init(&mHistogram, LITE3D_LUMINANCE_LOG2_MIN_DEFAULT,
+            LITE3D_LUMINANCE_LOG2_MAX_DEFAULT);
+    }
+
+    static float binSize()
+    {
+        return (LITE3D_LUMINANCE_LOG2_MAX_DEFAULT - LITE3D_LUMINANCE_LOG2_MIN_DEFAULT) / LITE3D_LUMINANCE_BINS;
+    }
+
+    /* gray luminance at center of the bin */
+    static float binCenter(int bin)
+    {
+        return std::exp2(LITE3D_LUMINANCE_LOG2_MIN_DEFAULT + (bin + 0.5f) * binSize());
+    }
+
+    static void addTexel(std::vector<float> &image, float r, float g, float b, int channels)
+    {
+        image.push_back(r);
+        image.push_back(g);
+        image.push_back(b);
+        if (channels == 4)
+            image.push_back(1.0f);
+    }
+
+    /* normal numbers and zero only, enough for test images */
+    static uint16_t toHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+        if (exponent <= 0)
+            return static_cast<uint16_t>((bits >> 16) & 0x8000);
+        /* round mantissa to nearest */
+        uint32_t half = ((bits >> 16) & 0x8000) | (exponent << 10) | ((bits & 0x7fffff) >> 13);
+        return static_cast<uint16_t>(half + ((bits >> 12) & 1));
+    }
+
+    lite3d_luminance_histogram mHistogram;
+};
+
+TEST_F(Luminance_Test, BinsOfKnownLuminance)
+{
+    /* odd texel count covers scalar tail after SIMD blocks */
+    const int texels = 1001;
+    std::mt19937 rnd(7);
+    std::vector<uint32_t> expected(LITE3D_LUMINANCE_BINS, 0);
+
+    for (int channels : { 3, 4 })
+    {
+        std::vector<float> image;
+        std::fill(expected.begin(), expected.end(), 0);
+        for (int i = 0; i < texels; ++i)
+        {
+            int bin = rnd() % LITE3D_LUMINANCE_BINS;
+            float luma = binCenter(bin);
+            expected[bin]++;
+            addTexel(image, luma, luma, luma, channels);
+        }
+
+        ASSERT_TRUE(lite3d_luminance_histogram_build(&mHistogram, image.data(), texels,
+            channels == 3 ? LITE3D_LUMINANCE_RGB_FLOAT : LITE3D_LUMINANCE_RGBA_FLOAT));
+        EXPECT_EQ(mHistogram.count, static_cast<uint32_t>(texels));
+        EXPECT_EQ(std::vector<uint32_t>(mHistogram.bins, mHistogram.bins + LITE3D_LUMINANCE_BINS), expected);
+
+        /* same image in half floats */
+        std::vector<uint16_t> halfs;
+        for (float v : image)
+            halfs.push_back(toHalf(v));
+
+        ASSERT_TRUE(lite3d_luminance_histogram_build(&mHistogram, halfs.data(), texels,
+            channels == 3 ? LITE3D_LUMINANCE_RGB_HALF : LITE3D_LUMINANCE_RGBA_HALF));
+        EXPECT_EQ(std::vector<uint32_t>(mHistogram.bins, mHistogram.bins + LITE3D_LUMINANCE_BINS), expected);
+    }
+}
+
+TEST_F(Luminance_Test, OutOfRangeTexels)
+{
+    std::vector<float> image;
+    addTexel(image, 0.0f, 0.0f, 0.0f, 3);
+    addTexel(image, -5.0f, 1.0f, 1.0f, 3);
+    addTexel(image, std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f, 3);
+    addTexel(image, 1e10f, 1e10f, 1e10f, 3);
+    addTexel(image, std::numeric_limits<float>::infinity(), 0.0f, 0.0f, 3);
+
+    ASSERT_TRUE(lite3d_luminance_histogram_build(&mHistogram, image.data(), 5, LITE3D_LUMINANCE_RGB_FLOAT));
+    EXPECT_EQ(mHistogram.bins[0], 3u);
+    EXPECT_EQ(mHistogram.bins[LITE3D_LUMINANCE_BINS - 1], 2u);
+    EXPECT_FALSE(lite3d_luminance_histogram_build(&mHistogram, image.data(), 5, 0));
+}
+
+TEST_F(Luminance_Test, PercentileAverage)
+{
+    const int texels = 4096;
+    std::vector<float> image;
+
+    /* dark room with few very bright lamps */
+    for (int i = 0; i < texels; ++i)
+    {
+        float luma = (i % 50) == 0 ? 5000.0f : 0.25f;
+        addTexel(image, luma, luma, luma, 3);
+    }
+
+    ASSERT_TRUE(lite3d_luminance_histogram_build(&mHistogram, image.data(), texels, LITE3D_LUMINANCE_RGB_FLOAT));
+    /* plain mean is about 100, lamps are clipped by high percentile */
+    float average = lite3d_luminance_histogram_average(&mHistogram, 0.5f, 0.95f);
+    EXPECT_NEAR(std::log2(average), std::log2(0.25f), binSize());
+    /* without clipping lamps pull average up */
+    EXPECT_GT(lite3d_luminance_histogram_average(&mHistogram, 0.0f, 1.0f), average * 1.1f);
+
+    /* log uniform gradient from 1/16 to 16 has geometric mean 1 */
+    image.clear();
+    for (int i = 0; i < texels; ++i)
+    {
+        float luma = std::exp2(-4.0f + 8.0f * (i + 0.5f) / texels);
+        addTexel(image, luma, luma, luma, 3);
+    }
+
+    ASSERT_TRUE(lite3d_luminance_histogram_build(&mHistogram, image.data(), texels, LITE3D_LUMINANCE_RGB_FLOAT));
+    EXPECT_NEAR(std::log2(lite3d_luminance_histogram_average(&mHistogram, 0.0f, 1.0f)), 0.0f, binSize() / 2);
+    /* upper half of gradient */
+    EXPECT_NEAR(std::log2(lite3d_luminance_histogram_average(&mHistogram, 0.5f, 1.0f)), 2.0f, binSize() / 2);
+
+    lite3d_luminance_histogram_init(&mHistogram, -10.0f, 10.0f);
+    EXPECT_EQ(lite3d_luminance_histogram_average(&mHistogram, 0.0f, 1.0f), 0.0f);
+}
+
+TEST_F(Luminance_Test, Adaptation)
+{
+    /* first value is taken as is */
+    EXPECT_EQ(lite3d_luminance_adapt(0.0f, 2.0f, 0.016f, 3.0f, 1.0f), 2.0f);
+
+    float up = 1.0f, down = 1.0f;
+    for (int frame = 0; frame < 30; ++frame)
+    {
+        float nextUp = lite3d_luminance_adapt(up, 2.0f, 0.016f, 3.0f, 1.0f);
+        float nextDown = lite3d_luminance_adapt(down, 0.5f, 0.016f, 3.0f, 1.0f);
+        EXPECT_GT(nextUp, up);
+        EXPECT_LE(nextUp, 2.0f);
+        EXPECT_LT(nextDown, down);
+        up = nextUp;
+        down = nextDown;
+    }
+
+    /* eyes adapt to bright light faster: same part of the way is passed quicker */
+    EXPECT_GT((up - 1.0f) / 1.0f, (1.0f - down) / 0.5f);
+    EXPECT_EQ(lite3d_luminance_adapt(1.0f, 2.0f, 0.0f, 3.0f, 1.0f), 1.0f);
+}
+
+/* bloom middle texture of 1080p window and whole 1080p frame */
+TEST_F(Luminance_Test, PerfomanceHistogram)
+{
+    std::mt19937 rnd(1);
+    std::uniform_real_distribution<float> dist(0.0f, 8.0f);
+
+    for (int texels : { 240 * 135, 1920 * 1080 })
+    {
+        std::vector<float> image(texels * 3);
+        for (auto &v : image)
+            v = dist(rnd);
+
+        const int runs = texels > 100000 ? 5 : 100;
+        volatile float sink = 0.0f;
+
+        auto begin = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; ++run)
+        {
+            /* previous plain mean of RGB */
+            float sum[3] = { 0.0f, 0.0f, 0.0f };
+            for (int i = 0; i < texels; ++i)
+            {
+                sum[0] += image[i * 3];
+                sum[1] += image[i * 3 + 1];
+                sum[2] += image[i * 3 + 2];
+            }
+            sink = sink + sum[0] + sum[1] + sum[2];
+        }
+        auto meanTime = std::chrono::steady_clock::now() - begin;
+
+        begin = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; ++run)
+        {
+            /* reference histogram with libm log2 */
+            uint32_t bins[LITE3D_LUMINANCE_BINS] = {};
+            for (int i = 0; i < texels; ++i)
+            {
+                float luma = 0.2126f * image[i * 3] + 0.7152f * image[i * 3 + 1] + 0.0722f * image[i * 3 + 2];
+                float t = (std::log2(std::max(luma, 1e-30f)) - LITE3D_LUMINANCE_LOG2_MIN_DEFAULT) / binSize();
+                bins[static_cast<int>(std::min(std::max(t, 0.0f), LITE3D_LUMINANCE_BINS - 1.0f))]++;
+            }
+            sink = sink + bins[0];
+        }
+        auto scalarTime = std::chrono::steady_clock::now() - begin;
+
+        begin = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; ++run)
+        {
+            lite3d_luminance_histogram_build(&mHistogram, image.data(), texels, LITE3D_LUMINANCE_RGB_FLOAT);
+            sink = sink + lite3d_luminance_histogram_average(&mHistogram, 0.5f, 0.95f);
+        }
+        auto histogramTime = std::chrono::steady_clock::now() - begin;
+
+        EXPECT_EQ(mHistogram.count, static_cast<uint32_t>(texels));
+
+        auto mpix = [texels, runs](auto d) {
+            return texels * runs / std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(d).count(); };
+        std::cout << texels << " texels: plain mean " << mpix(meanTime) << " Mpix/s, scalar histogram "
+            << mpix(scalarTime) << " Mpix/s, histogram " << mpix(histogramTime) << " Mpix/s" << std::endl;
+    }
+}
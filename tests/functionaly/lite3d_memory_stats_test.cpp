@@ -0,0 +1,116 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+
+class MemoryStats_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+};
+
+#ifdef LITE3D_WITH_MEMORY_STATS
+
+TEST_F(MemoryStats_Test, PoolCounters)
+{
+    lite3d_memory_stats before, after;
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_NO4, &before));
+
+    void *chunks[10];
+    for (int i = 0; i < 10; ++i)
+        chunks[i] = lite3d_malloc_pooled(LITE3D_POOL_NO4, 1000);
+
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_NO4, &after));
+    EXPECT_EQ(after.usedBytes, before.usedBytes + 10000);
+    EXPECT_EQ(after.allocations, before.allocations + 10);
+    EXPECT_GE(after.peakBytes, after.usedBytes);
+    EXPECT_GE(after.reservedBytes, after.usedBytes);
+
+    for (int i = 0; i < 10; ++i)
+        lite3d_free_pooled(LITE3D_POOL_NO4, chunks[i]);
+
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_NO4, &after));
+    EXPECT_EQ(after.usedBytes, before.usedBytes);
+    EXPECT_EQ(after.frees, before.frees + 10);
+    EXPECT_GE(after.peakBytes, before.usedBytes + 10000);
+}
+
+TEST_F(MemoryStats_Test, HeapRealloc)
+{
+    lite3d_memory_stats before, after;
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_HEAP, &before));
+
+    uint8_t *mem = static_cast<uint8_t *>(lite3d_calloc(100));
+    ASSERT_TRUE(mem != NULL);
+    mem[99] = 42;
+    mem = static_cast<uint8_t *>(lite3d_realloc(mem, 1000));
+    ASSERT_TRUE(mem != NULL);
+    EXPECT_EQ(mem[99], 42);
+
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_HEAP, &after));
+    EXPECT_EQ(after.usedBytes, before.usedBytes + 1000);
+
+    lite3d_free(mem);
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_HEAP, &after));
+    EXPECT_EQ(after.usedBytes, before.usedBytes);
+}
+
+TEST_F(MemoryStats_Test, TagsAndFrames)
+{
+    lite3d_memory_stats tagStats, poolStats;
+    uint8_t prevTag = lite3d_memory_set_tag(5);
+
+    lite3d_memory_stats_frame();
+    void *first = lite3d_malloc_pooled(LITE3D_POOL_NO5, 64);
+    void *second = lite3d_malloc(128);
+    EXPECT_EQ(lite3d_memory_set_tag(prevTag), 5);
+
+    ASSERT_TRUE(lite3d_memory_get_tag_stats(5, &tagStats));
+    EXPECT_EQ(tagStats.usedBytes, 192u);
+
+    /* counters of the finished frame */
+    lite3d_memory_stats_frame();
+    ASSERT_TRUE(lite3d_memory_get_tag_stats(5, &tagStats));
+    ASSERT_TRUE(lite3d_memory_get_pool_stats(LITE3D_POOL_NO5, &poolStats));
+    EXPECT_EQ(tagStats.frameAllocations, 2u);
+    EXPECT_EQ(poolStats.frameAllocations, 1u);
+
+    /* freed memory is accounted to the allocation tag */
+    lite3d_free_pooled(LITE3D_POOL_NO5, first);
+    lite3d_free(second);
+    ASSERT_TRUE(lite3d_memory_get_tag_stats(5, &tagStats));
+    EXPECT_EQ(tagStats.usedBytes, 0u);
+    EXPECT_EQ(tagStats.frees, 2u);
+}
+
+#else
+
+TEST_F(MemoryStats_Test, CompiledOut)
+{
+    lite3d_memory_stats stats;
+    EXPECT_FALSE(lite3d_memory_get_pool_stats(LITE3D_POOL_HEAP, &stats));
+    EXPECT_FALSE(lite3d_memory_get_tag_stats(LITE3D_MEMORY_TAG_DEFAULT, &stats));
+    EXPECT_EQ(lite3d_memory_set_tag(5), LITE3D_MEMORY_TAG_DEFAULT);
+}
+
+#endif
@@ -0,0 +1,334 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_pack.h>
+#include <lite3d/lite3d_mesh_codec.h>
+#include <lite3d/lite3d_mesh_cluster.h>
+
+using Triangle = std::array<uint32_t, 3>;
+
+// Треугольник с первой наименьшей вершиной, порядок обхода сохраняется
+static Triangle canonical(const uint32_t *tri)
+{
+    uint32_t first = tri[0] <= tri[1] && tri[0] <= tri[2] ? 0 : (tri[1] <= tri[2] ? 1 : 2);
+    return { tri[first], tri[(first + 1) % 3], tri[(first + 2) % 3] };
+}
+
+static const kmVec3 &position(const float *positions, uint32_t index)
+{
+    return *reinterpret_cast<const kmVec3 *>(positions + index * 3);
+}
+
+class MeshCluster_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    void SetUp() override
+    {
+        memset(&mSource, 0, sizeof(mSource));
+        memset(&mGeometry, 0, sizeof(mGeometry));
+        mPack = lite3d_pack_open("tests/", 0, 1000000);
+        ASSERT_TRUE(mPack != nullptr);
+        mFile = lite3d_pack_file_load(mPack, "meshes/VURmCorner_ubr.m");
+        ASSERT_TRUE(mFile != nullptr);
+        ASSERT_TRUE(lite3d_mesh_m_decode_geometry(&mSource, mFile->fileBuff, mFile->fileSize));
+        ASSERT_TRUE(lite3d_mesh_m_build_clusters(mFile->fileBuff, mFile->fileSize, LITE3D_CLUSTER_MAX_VERTICES,
+            LITE3D_CLUSTER_MAX_TRIANGLES, &mClustered, &mClusteredSize));
+        ASSERT_TRUE(lite3d_mesh_m_decode_geometry(&mGeometry, mClustered, mClusteredSize));
+    }
+
+    void TearDown() override
+    {
+        lite3d_mesh_m_geometry_purge(&mSource);
+        lite3d_mesh_m_geometry_purge(&mGeometry);
+        if (mClustered)
+            lite3d_free(mClustered);
+        if (mPack)
+            lite3d_pack_close(mPack);
+    }
+
+    /* 
+     * Каждый треугольник, видимый с eye (лицевой и не за одной из плоскостей frustum), 
+     * должен попасть в диапазоны, возвращает число отсеченных кластеров
+     */
+    static uint32_t checkConservative(const float *positions, const uint32_t *indexes, uint32_t indexesCount,
+        const lite3d_mesh_cluster *clusters, uint32_t clustersCount, const kmMat4 &world, 
+        const kmVec3 &eye, const lite3d_frustum *frustum)
+    {
+        lite3d_mesh_cluster_cull_params params;
+        lite3d_mesh_cluster_cull_stats stats;
+        lite3d_array ranges;
+
+        memset(&params, 0, sizeof(params));
+        params.frustum = frustum;
+        params.worldMatrix = &world;
+        params.eyePosition = &eye;
+        lite3d_array_init(&ranges, sizeof(lite3d_mesh_index_range), 8);
+        uint32_t visible = lite3d_mesh_clusters_cull(clusters, clustersCount, &params, &ranges, &stats);
+        EXPECT_EQ(visible + stats.frustumCulled + stats.backfaceCulled + stats.occlusionCulled, clustersCount);
+        EXPECT_EQ(stats.rangesCount, ranges.size);
+        EXPECT_LE(ranges.size, visible);
+
+        std::vector<uint8_t> drawn(indexesCount / 3, 0);
+        uint32_t drawnIndexes = 0, end = 0;
+        lite3d_mesh_index_range *range;
+        LITE3D_ARR_FOREACH(&ranges, lite3d_mesh_index_range, range)
+        {
+            // Диапазоны упорядочены, не пересекаются и соседние уже слиты
+            EXPECT_TRUE(end == 0 || range->indexesOffset > end);
+            EXPECT_EQ(range->indexesOffset % 3, 0u);
+            EXPECT_LE(range->indexesOffset + range->indexesCount, indexesCount);
+            for (uint32_t i = range->indexesOffset; i < range->indexesOffset + range->indexesCount; i += 3)
+                drawn[i / 3] = 1;
+            end = range->indexesOffset + range->indexesCount;
+            drawnIndexes += range->indexesCount;
+        }
+        EXPECT_EQ(drawnIndexes, stats.indexesVisible);
+        lite3d_array_purge(&ranges);
+
+        for (uint32_t t = 0; t < indexesCount / 3; ++t)
+        {
+            kmVec3 p[3], e1, e2, n, toEye;
+            for (uint32_t k = 0; k < 3; ++k)
+                kmVec3Transform(&p[k], &position(positions, indexes[t * 3 + k]), &world);
+
+            kmVec3Cross(&n, kmVec3Subtract(&e1, &p[1], &p[0]), kmVec3Subtract(&e2, &p[2], &p[0]));
+            kmVec3Subtract(&toEye, &eye, &p[0]);
+            if (kmVec3Dot(&toEye, &n) <= 1e-5f * kmVec3Length(&n) * kmVec3Length(&toEye))
+                continue;
+
+            bool outside = false;
+            for (uint32_t plane = 0; frustum && plane < 6 && !outside; ++plane)
+            {
+                outside = kmPlaneDistance(&frustum->clipPlains[plane], &p[0]) < -1e-4f &&
+                    kmPlaneDistance(&frustum->clipPlains[plane], &p[1]) < -1e-4f &&
+                    kmPlaneDistance(&frustum->clipPlains[plane], &p[2]) < -1e-4f;
+            }
+
+            if (!outside && !drawn[t])
+            {
+                ADD_FAILURE() << "visible triangle " << t << " is culled";
+                break;
+            }
+        }
+
+        return clustersCount - visible;
+    }
+
+    lite3d_pack *mPack = nullptr;
+    lite3d_file *mFile = nullptr;
+    lite3d_mesh_m_geometry mSource;
+    lite3d_mesh_m_geometry mGeometry;
+    void *mClustered = nullptr;
+    size_t mClusteredSize = 0;
+};
+
+TEST_F(MeshCluster_Test, BuildFromFile)
+{
+    ASSERT_EQ(mGeometry.chunksCount, mSource.chunksCount);
+    ASSERT_EQ(mGeometry.verticesCount, mSource.verticesCount);
+    ASSERT_EQ(mGeometry.indexesCount, mSource.indexesCount);
+    EXPECT_TRUE(std::equal(mSource.positions, mSource.positions + mSource.verticesCount * 3, mGeometry.positions));
+    EXPECT_GT(mGeometry.clustersCount, mGeometry.chunksCount);
+
+    for (uint32_t c = 0; c < mGeometry.chunksCount; ++c)
+    {
+        const auto &chunk = mGeometry.chunks[c];
+        const float *positions = mGeometry.positions + chunk.verticesOffset * 3;
+        const uint32_t *indexes = mGeometry.indexes + chunk.indexesOffset;
+        ASSERT_GT(chunk.clustersCount, 0u);
+
+        // Кластеры идут подряд и покрывают все индексы чанка
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < chunk.clustersCount; ++i)
+        {
+            const auto &cluster = mGeometry.clusters[chunk.clustersOffset + i];
+            ASSERT_EQ(cluster.indexesOffset, next);
+            ASSERT_GT(cluster.indexesCount, 0u);
+            ASSERT_EQ(cluster.indexesCount % 3, 0u);
+            ASSERT_LE(cluster.indexesCount, LITE3D_CLUSTER_MAX_TRIANGLES * 3u);
+            next += cluster.indexesCount;
+
+            std::set<uint32_t> vertices(indexes + cluster.indexesOffset, indexes + next);
+            ASSERT_LE(vertices.size(), static_cast<size_t>(LITE3D_CLUSTER_MAX_VERTICES));
+            for (uint32_t v : vertices)
+            {
+                kmVec3 delta;
+                ASSERT_LE(kmVec3Length(kmVec3Subtract(&delta, &position(positions, v), &cluster.center)),
+                    cluster.radius * 1.0001f + 1e-5f);
+            }
+
+            ASSERT_LE(cluster.coneCutoff, 1.0f);
+        }
+        ASSERT_EQ(next, chunk.indexesCount);
+
+        // Те же треугольники с тем же обходом, изменился лишь порядок
+        std::multiset<Triangle> before, after;
+        for (uint32_t i = 0; i < chunk.indexesCount; i += 3)
+        {
+            before.insert(canonical(mSource.indexes + mSource.chunks[c].indexesOffset + i));
+            after.insert(canonical(indexes + i));
+        }
+        ASSERT_EQ(before, after);
+    }
+
+    // Повторная сборка заменяет секцию кластеров, а не добавляет еще одну
+    void *rebuilt = nullptr;
+    size_t rebuiltSize = 0;
+    ASSERT_TRUE(lite3d_mesh_m_build_clusters(mClustered, mClusteredSize, LITE3D_CLUSTER_MAX_VERTICES,
+        LITE3D_CLUSTER_MAX_TRIANGLES, &rebuilt, &rebuiltSize));
+    EXPECT_EQ(rebuiltSize, mClusteredSize);
+    lite3d_free(rebuilt);
+
+    // Файл без кластеров читается как раньше
+    EXPECT_EQ(mSource.clustersCount, 0u);
+    EXPECT_EQ(mSource.clusters, nullptr);
+}
+
+TEST_F(MeshCluster_Test, CullConservative)
+{
+    kmVec3 vmin = position(mGeometry.positions, 0), vmax = vmin;
+    for (uint32_t v = 0; v < mGeometry.verticesCount; ++v)
+    {
+        const kmVec3 &p = position(mGeometry.positions, v);
+        vmin = { std::min(vmin.x, p.x), std::min(vmin.y, p.y), std::min(vmin.z, p.z) };
+        vmax = { std::max(vmax.x, p.x), std::max(vmax.y, p.y), std::max(vmax.z, p.z) };
+    }
+
+    kmMat4 scale, rotation, translation, world, view, projection, clip;
+    kmVec3 axis = { 0.3f, 1.0f, -0.2f }, up = { 0.0f, 1.0f, 0.0f };
+    kmMat4Scaling(&scale, 1.5f, 0.7f, 1.2f);
+    kmMat4RotationAxisAngle(&rotation, kmVec3Normalize(&axis, &axis), 0.7f);
+    kmMat4Translation(&translation, 10.0f, -3.0f, 4.0f);
+    kmMat4Multiply(&world, &rotation, &scale);
+    kmMat4Multiply(&world, &translation, &world);
+
+    kmVec3 center = { (vmin.x + vmax.x) * 0.5f, (vmin.y + vmax.y) * 0.5f, (vmin.z + vmax.z) * 0.5f }, delta;
+    float radius = kmVec3Length(kmVec3Subtract(&delta, &vmax, &center)) * 1.5f;
+    kmVec3Transform(&center, &center, &world);
+
+    std::mt19937 rnd(49);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    uint32_t culled = 0, total = 0;
+    for (int i = 0; i < 24; ++i)
+    {
+        kmVec3 dir = { unit(rnd), unit(rnd), unit(rnd) }, eye, target, offset;
+        kmVec3Normalize(&dir, &dir);
+        kmVec3Add(&eye, &center, kmVec3Scale(&dir, &dir, radius * (0.3f + 1.5f * (unit(rnd) + 1.0f))));
+        offset = { unit(rnd) * radius * 0.5f, unit(rnd) * radius * 0.5f, unit(rnd) * radius * 0.5f };
+        kmVec3Add(&target, &center, &offset);
+
+        lite3d_frustum frustum;
+        kmMat4LookAt(&view, &eye, &target, &up);
+        kmMat4PerspectiveProjection(&projection, 50.0f, 1.5f, 0.1f, radius * 10.0f);
+        kmMat4Multiply(&clip, &projection, &view);
+        lite3d_frustum_compute(&frustum, &clip);
+
+        for (uint32_t c = 0; c < mGeometry.chunksCount; ++c)
+        {
+            const auto &chunk = mGeometry.chunks[c];
+            culled += checkConservative(mGeometry.positions + chunk.verticesOffset * 3, 
+                mGeometry.indexes + chunk.indexesOffset, chunk.indexesCount, 
+                mGeometry.clusters + chunk.clustersOffset, chunk.clustersCount, world, eye, &frustum);
+            total += chunk.clustersCount;
+            if (HasFailure())
+                return;
+        }
+    }
+
+    // Отсечение действительно работает
+    EXPECT_GT(culled, total / 10);
+}
+
+TEST_F(MeshCluster_Test, BackfaceCones)
+{
+    // UV сфера с внешними нормалями, снаружи видна лишь половина
+    const uint32_t rings = 48, segments = 96;
+    std::vector<float> positions;
+    std::vector<uint32_t> indexes;
+    for (uint32_t r = 0; r <= rings; ++r)
+    {
+        float theta = static_cast<float>(M_PI) * r / rings;
+        for (uint32_t s = 0; s <= segments; ++s)
+        {
+            float phi = 2.0f * static_cast<float>(M_PI) * s / segments;
+            positions.insert(positions.end(), { std::sin(theta) * std::cos(phi), std::cos(theta), 
+                -std::sin(theta) * std::sin(phi) });
+        }
+    }
+    for (uint32_t r = 0; r < rings; ++r)
+    {
+        for (uint32_t s = 0; s < segments; ++s)
+        {
+            uint32_t a = r * (segments + 1) + s, b = a + segments + 1;
+            indexes.insert(indexes.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+
+    lite3d_array clusters;
+    lite3d_array_init(&clusters, sizeof(lite3d_mesh_cluster), 16);
+    ASSERT_TRUE(lite3d_mesh_clusters_build(positions.data(), sizeof(kmVec3), static_cast<uint32_t>(positions.size() / 3),
+        indexes.data(), static_cast<uint32_t>(indexes.size()), LITE3D_CLUSTER_MAX_VERTICES, LITE3D_CLUSTER_MAX_TRIANGLES, 
+        &clusters));
+    // Лимит по вершинам не дает набрать полный кластер, но не дробит сетку мелко
+    EXPECT_LT(clusters.size, indexes.size() / 3 / 40);
+
+    kmMat4 world;
+    kmMat4Identity(&world);
+    for (kmVec3 eye : { kmVec3{ 0.0f, 0.0f, 4.0f }, kmVec3{ 3.0f, 2.0f, -1.0f }, kmVec3{ 0.0f, -20.0f, 0.0f } })
+    {
+        uint32_t culled = checkConservative(positions.data(), indexes.data(), static_cast<uint32_t>(indexes.size()),
+            static_cast<lite3d_mesh_cluster *>(clusters.data), static_cast<uint32_t>(clusters.size), world, eye, nullptr);
+        EXPECT_GT(culled, clusters.size / 4);
+    }
+
+    // Без проверок видно все, соседние кластеры слиты в одну команду
+    lite3d_mesh_cluster_cull_params params;
+    lite3d_mesh_cluster_cull_stats stats;
+    lite3d_array ranges;
+    memset(&params, 0, sizeof(params));
+    lite3d_array_init(&ranges, sizeof(lite3d_mesh_index_range), 1);
+    EXPECT_EQ(lite3d_mesh_clusters_cull(static_cast<lite3d_mesh_cluster *>(clusters.data), 
+        static_cast<uint32_t>(clusters.size), &params, &ranges, &stats), clusters.size);
+    ASSERT_EQ(ranges.size, 1u);
+    EXPECT_EQ(LITE3D_ARR_GET_FIRST(&ranges, lite3d_mesh_index_range)->indexesCount, indexes.size());
+
+    // Окклюзия отсекает то, что прошло остальные проверки
+    params.occlusionTest = [](const kmVec3 *center, float, void *) -> int { return center->x < 0.0f; };
+    lite3d_array_clean(&ranges);
+    uint32_t visible = lite3d_mesh_clusters_cull(static_cast<lite3d_mesh_cluster *>(clusters.data),
+        static_cast<uint32_t>(clusters.size), &params, &ranges, &stats);
+    EXPECT_GT(stats.occlusionCulled, 0u);
+    EXPECT_EQ(visible + stats.occlusionCulled, clusters.size);
+
+    lite3d_array_purge(&ranges);
+    lite3d_array_purge(&clusters);
+}
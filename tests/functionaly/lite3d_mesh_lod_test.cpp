@@ -0,0 +1,414 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_pack.h>
+#include <lite3d/lite3d_mesh_codec.h>
+#include <lite3d/lite3d_mesh_cluster.h>
+#include <lite3d/lite3d_mesh_lod.h>
+
+static const kmVec3 &position(const float *positions, uint32_t index)
+{
+    return *reinterpret_cast<const kmVec3 *>(positions + index * 3);
+}
+
+// Замкнутая сфера без швов: общие вершины на полюсах и на стыке по долготе
+static void closedSphere(uint32_t rings, uint32_t segments, std::vector<float> &positions, std::vector<uint32_t> &indexes)
+{
+    positions = { 0.0f, 1.0f, 0.0f };
+    for (uint32_t r = 1; r < rings; ++r)
+    {
+        float theta = static_cast<float>(M_PI) * r / rings;
+        for (uint32_t s = 0; s < segments; ++s)
+        {
+            float phi = 2.0f * static_cast<float>(M_PI) * s / segments;
+            positions.insert(positions.end(), { std::sin(theta) * std::cos(phi), std::cos(theta), 
+                -std::sin(theta) * std::sin(phi) });
+        }
+    }
+    positions.insert(positions.end(), { 0.0f, -1.0f, 0.0f });
+
+    const uint32_t bottom = static_cast<uint32_t>(positions.size() / 3) - 1;
+    auto ring = [segments](uint32_t r, uint32_t s) { return 1 + (r - 1) * segments + s % segments; };
+    indexes.clear();
+    for (uint32_t s = 0; s < segments; ++s)
+    {
+        indexes.insert(indexes.end(), { 0, ring(1, s), ring(1, s + 1) });
+        for (uint32_t r = 1; r + 1 < rings; ++r)
+            indexes.insert(indexes.end(), { ring(r, s), ring(r + 1, s), ring(r, s + 1), 
+                ring(r, s + 1), ring(r + 1, s), ring(r + 1, s + 1) });
+        indexes.insert(indexes.end(), { ring(rings - 1, s), bottom, ring(rings - 1, s + 1) });
+    }
+}
+
+static kmVec3 triangleNormal(const float *positions, const uint32_t *tri)
+{
+    kmVec3 e1, e2, n;
+    kmVec3Subtract(&e1, &position(positions, tri[1]), &position(positions, tri[0]));
+    kmVec3Subtract(&e2, &position(positions, tri[2]), &position(positions, tri[0]));
+    return *kmVec3Cross(&n, &e1, &e2);
+}
+
+// Расстояние от точки до треугольника по ближайшей точке (Ericson, Real-Time Collision Detection)
+static float pointTriangleDistance(const kmVec3 &p, const kmVec3 &a, const kmVec3 &b, const kmVec3 &c)
+{
+    kmVec3 ab, ac, ap, bp, cp, closest, delta;
+    kmVec3Subtract(&ab, &b, &a);
+    kmVec3Subtract(&ac, &c, &a);
+    kmVec3Subtract(&ap, &p, &a);
+    float d1 = kmVec3Dot(&ab, &ap), d2 = kmVec3Dot(&ac, &ap);
+    kmVec3Subtract(&bp, &p, &b);
+    float d3 = kmVec3Dot(&ab, &bp), d4 = kmVec3Dot(&ac, &bp);
+    kmVec3Subtract(&cp, &p, &c);
+    float d5 = kmVec3Dot(&ab, &cp), d6 = kmVec3Dot(&ac, &cp);
+    float va = d3 * d6 - d5 * d4, vb = d5 * d2 - d1 * d6, vc = d1 * d4 - d3 * d2;
+
+    auto lerp = [](const kmVec3 &from, const kmVec3 &to, float t) 
+    { return kmVec3{ from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t, from.z + (to.z - from.z) * t }; };
+
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        closest = a;
+    else if (d3 >= 0.0f && d4 <= d3)
+        closest = b;
+    else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        closest = lerp(a, b, d1 / (d1 - d3));
+    else if (d6 >= 0.0f && d5 <= d6)
+        closest = c;
+    else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        closest = lerp(a, c, d2 / (d2 - d6));
+    else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        closest = lerp(b, c, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    else
+    {
+        float denom = 1.0f / (va + vb + vc);
+        closest = { a.x + ab.x * vb * denom + ac.x * vc * denom, a.y + ab.y * vb * denom + ac.y * vc * denom,
+            a.z + ab.z * vb * denom + ac.z * vc * denom };
+    }
+
+    return kmVec3Length(kmVec3Subtract(&delta, &p, &closest));
+}
+
+// Наибольшее расстояние от вершин исходной сетки до упрощенной поверхности
+static float maxDeviation(const std::vector<float> &positions, const uint32_t *indexes, uint32_t indexesCount)
+{
+    float result = 0.0f;
+    for (uint32_t v = 0; v < positions.size() / 3; ++v)
+    {
+        float nearest = FLT_MAX;
+        for (uint32_t i = 0; i < indexesCount; i += 3)
+        {
+            nearest = std::min(nearest, pointTriangleDistance(position(positions.data(), v), 
+                position(positions.data(), indexes[i]), position(positions.data(), indexes[i + 1]),
+                position(positions.data(), indexes[i + 2])));
+        }
+        result = std::max(result, nearest);
+    }
+
+    return result;
+}
+
+static void checkIndexes(const uint32_t *indexes, uint32_t indexesCount, uint32_t verticesCount)
+{
+    ASSERT_EQ(indexesCount % 3, 0u);
+    for (uint32_t i = 0; i < indexesCount; i += 3)
+    {
+        ASSERT_LT(indexes[i], verticesCount);
+        ASSERT_LT(indexes[i + 1], verticesCount);
+        ASSERT_LT(indexes[i + 2], verticesCount);
+        ASSERT_TRUE(indexes[i] != indexes[i + 1] && indexes[i + 1] != indexes[i + 2] && indexes[i] != indexes[i + 2]);
+    }
+}
+
+class MeshLod_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    static uint32_t countSwitches(const lite3d_mesh_lod *lods, uint32_t lodsCount, const std::vector<float> &projected, 
+        float hysteresis, uint32_t &level)
+    {
+        uint32_t switches = 0;
+        for (float p : projected)
+        {
+            uint32_t next = lite3d_mesh_lod_select(lods, lodsCount, 1.0f, p, 0.001f, hysteresis, level);
+            switches += next != level;
+            level = next;
+        }
+
+        return switches;
+    }
+};
+
+TEST_F(MeshLod_Test, SimplifySphereErrorBound)
+{
+    std::vector<float> positions;
+    std::vector<uint32_t> indexes;
+    closedSphere(24, 48, positions, indexes);
+    const uint32_t verticesCount = static_cast<uint32_t>(positions.size() / 3);
+    const uint32_t indexesCount = static_cast<uint32_t>(indexes.size());
+    std::vector<uint32_t> result(indexesCount);
+
+    float previousError = 0.0f;
+    uint32_t resultCount = 0;
+    for (float ratio : { 0.5f, 0.25f, 0.1f, 0.03f })
+    {
+        uint32_t target = static_cast<uint32_t>(indexesCount * ratio);
+        float error = -1.0f;
+        ASSERT_TRUE(lite3d_mesh_simplify(positions.data(), sizeof(kmVec3), verticesCount, indexes.data(), indexesCount,
+            target, FLT_MAX, result.data(), &resultCount, &error));
+        checkIndexes(result.data(), resultCount, verticesCount);
+        if (HasFatalFailure())
+            return;
+
+        // Цель достигнута, ошибка растет вместе с упрощением
+        EXPECT_LE(resultCount, target);
+        EXPECT_GE(error, previousError);
+        previousError = error;
+
+        // Сфера остается выпуклой, треугольники не перевернуты
+        for (uint32_t i = 0; i < resultCount; i += 3)
+        {
+            kmVec3 n = triangleNormal(positions.data(), &result[i]);
+            ASSERT_GT(kmVec3Dot(&n, &position(positions.data(), result[i])), 0.0f);
+        }
+
+        // Ошибка квадрик - среднее по плоскостям, реальное отклонение ограничено ей с небольшим запасом
+        float deviation = maxDeviation(positions, result.data(), resultCount);
+        EXPECT_LE(deviation, error * 3.0f + 1e-4f) << "ratio " << ratio;
+        EXPECT_GT(deviation, 0.0f);
+
+        // Измеренное отклонение совпадает с полным перебором
+        float measured = -1.0f;
+        ASSERT_TRUE(lite3d_mesh_deviation(positions.data(), sizeof(kmVec3), verticesCount, indexes.data(), indexesCount,
+            result.data(), resultCount, &measured));
+        EXPECT_NEAR(measured, deviation, 1e-5f) << "ratio " << ratio;
+    }
+
+    // Ограничение по ошибке останавливает упрощение раньше цели
+    const float targetError = 0.01f;
+    float error = -1.0f;
+    ASSERT_TRUE(lite3d_mesh_simplify(positions.data(), sizeof(kmVec3), verticesCount, indexes.data(), indexesCount,
+        0, targetError, result.data(), &resultCount, &error));
+    EXPECT_LE(error, targetError);
+    EXPECT_GT(resultCount, 0u);
+    EXPECT_LT(resultCount, indexesCount);
+    EXPECT_LE(maxDeviation(positions, result.data(), resultCount), targetError * 3.0f + 1e-4f);
+
+    // Без допустимой ошибки ничего не меняется
+    ASSERT_TRUE(lite3d_mesh_simplify(positions.data(), sizeof(kmVec3), verticesCount, indexes.data(), indexesCount,
+        0, 0.0f, result.data(), &resultCount, &error));
+    EXPECT_EQ(resultCount, indexesCount);
+    EXPECT_EQ(error, 0.0f);
+}
+
+TEST_F(MeshLod_Test, SimplifyKeepsBordersAndSeams)
+{
+    // Плоская сетка с открытой границей и швом текстурных координат посередине
+    const uint32_t size = 33, seam = size / 2;
+    std::vector<float> positions;
+    std::vector<uint32_t> indexes, seamCopies(size);
+    for (uint32_t y = 0; y < size; ++y)
+        for (uint32_t x = 0; x < size; ++x)
+            positions.insert(positions.end(), { static_cast<float>(x) / (size - 1), static_cast<float>(y) / (size - 1), 0.0f });
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        seamCopies[y] = static_cast<uint32_t>(positions.size() / 3);
+        positions.insert(positions.end(), { positions[(y * size + seam) * 3], positions[(y * size + seam) * 3 + 1], 0.0f });
+    }
+
+    auto vertex = [&](uint32_t x, uint32_t y, bool right) { return right && x == seam ? seamCopies[y] : y * size + x; };
+    for (uint32_t y = 0; y + 1 < size; ++y)
+    {
+        for (uint32_t x = 0; x + 1 < size; ++x)
+        {
+            bool right = x >= seam;
+            indexes.insert(indexes.end(), { vertex(x, y, right), vertex(x + 1, y, right), vertex(x + 1, y + 1, right),
+                vertex(x, y, right), vertex(x + 1, y + 1, right), vertex(x, y + 1, right) });
+        }
+    }
+
+    const uint32_t verticesCount = static_cast<uint32_t>(positions.size() / 3);
+    std::vector<uint32_t> result(indexes.size());
+    uint32_t resultCount = 0;
+    float error = -1.0f;
+    ASSERT_TRUE(lite3d_mesh_simplify(positions.data(), sizeof(kmVec3), verticesCount, indexes.data(), 
+        static_cast<uint32_t>(indexes.size()), 0, 1e-4f, result.data(), &resultCount, &error));
+    checkIndexes(result.data(), resultCount, verticesCount);
+    EXPECT_LE(error, 1e-4f);
+    EXPECT_LT(resultCount, indexes.size() / 5);
+
+    // Площадь сохранена, значит нет дыр и перекрытий, все треугольники смотрят вверх
+    float area = 0.0f;
+    for (uint32_t i = 0; i < resultCount; i += 3)
+    {
+        kmVec3 n = triangleNormal(positions.data(), &result[i]);
+        EXPECT_GT(n.z, 0.0f);
+        area += n.z * 0.5f;
+    }
+    EXPECT_NEAR(area, 1.0f, 1e-4f);
+
+    // Вершины границы и обе стороны шва остались на месте
+    std::set<uint32_t> used(result.begin(), result.begin() + resultCount);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        for (uint32_t v : { i, (size - 1) * size + i, i * size, i * size + size - 1, i * size + seam, seamCopies[i] })
+            EXPECT_TRUE(used.count(v)) << "vertex " << v;
+    }
+}
+
+TEST_F(MeshLod_Test, SelectHysteresis)
+{
+    const lite3d_mesh_lod lods[] = { { 0, 0, 0.01f }, { 0, 0, 0.03f }, { 0, 0, 0.1f } };
+    uint32_t level = 0;
+
+    // Вблизи полная детализация, вдали самый грубый уровень
+    EXPECT_EQ(lite3d_mesh_lod_select(lods, 3, 1.0f, FLT_MAX, 0.001f, 0.25f, 3), 0u);
+    EXPECT_EQ(lite3d_mesh_lod_select(lods, 3, 1.0f, 0.0f, 0.001f, 0.25f, 0), 3u);
+    EXPECT_EQ(lite3d_mesh_lod_select(lods, 0, 1.0f, 0.0f, 0.001f, 0.25f, 2), 0u);
+    EXPECT_EQ(lite3d_mesh_lod_select(lods, 3, 1.0f, 0.0f, 0.001f, 0.25f, 7), 3u);
+
+    // Удаление: уровень только грубеет, видимая ошибка выбранного уровня не выше допустимой
+    std::vector<float> projected;
+    for (float p = 1.0f; p > 0.001f; p *= 0.97f)
+        projected.push_back(p);
+    for (float p : projected)
+    {
+        uint32_t next = lite3d_mesh_lod_select(lods, 3, 1.0f, p, 0.001f, 0.25f, level);
+        ASSERT_GE(next, level);
+        ASSERT_TRUE(next == 0 || lods[next - 1].error * p <= 0.001f);
+        level = next;
+    }
+    EXPECT_EQ(level, 3u);
+
+    // Приближение: уточняется сразу, как только ошибка стала заметной
+    std::reverse(projected.begin(), projected.end());
+    for (float p : projected)
+    {
+        uint32_t next = lite3d_mesh_lod_select(lods, 3, 1.0f, p, 0.001f, 0.25f, level);
+        ASSERT_LE(next, level);
+        ASSERT_TRUE(next == 0 || lods[next - 1].error * p <= 0.001f);
+        level = next;
+    }
+    EXPECT_EQ(level, 0u);
+
+    // Дрожание размера вокруг порога первого уровня (0.1) меньше гистерезиса не вызывает переключений
+    std::vector<float> jitter;
+    for (int i = 0; i < 200; ++i)
+        jitter.push_back(0.1f * (1.0f + ((i * 7919) % 17 - 8) * 0.01f));
+    level = 0;
+    EXPECT_LE(countSwitches(lods, 3, jitter, 0.25f, level), 1u);
+    level = 0;
+    EXPECT_GT(countSwitches(lods, 3, jitter, 0.0f, level), 10u);
+}
+
+TEST_F(MeshLod_Test, BuildFromFile)
+{
+    lite3d_pack *pack = lite3d_pack_open("tests/", 0, 1000000);
+    ASSERT_TRUE(pack != nullptr);
+    lite3d_file *file = lite3d_pack_file_load(pack, "meshes/VURmCorner_ubr.m");
+    ASSERT_TRUE(file != nullptr);
+
+    lite3d_mesh_m_geometry source, geometry, clustered;
+    void *lodBuffer = nullptr, *clusterBuffer = nullptr, *rebuilt = nullptr;
+    size_t lodBufferSize = 0, clusterBufferSize = 0, rebuiltSize = 0;
+    ASSERT_TRUE(lite3d_mesh_m_decode_geometry(&source, file->fileBuff, file->fileSize));
+    ASSERT_TRUE(lite3d_mesh_m_build_lods(file->fileBuff, file->fileSize, 3, LITE3D_LOD_DEFAULT_REDUCTION,
+        LITE3D_LOD_DEFAULT_MAX_ERROR, &lodBuffer, &lodBufferSize));
+    ASSERT_TRUE(lite3d_mesh_m_decode_geometry(&geometry, lodBuffer, lodBufferSize));
+    EXPECT_EQ(source.lodsCount, 0u);
+    EXPECT_GT(geometry.lodsCount, 0u);
+    ASSERT_EQ(geometry.chunksCount, source.chunksCount);
+    EXPECT_TRUE(std::equal(source.positions, source.positions + source.verticesCount * 3, geometry.positions));
+
+    for (uint32_t c = 0; c < geometry.chunksCount; ++c)
+    {
+        const auto &chunk = geometry.chunks[c];
+        const uint32_t *indexes = geometry.indexes + chunk.indexesOffset;
+        ASSERT_EQ(chunk.indexesCount, source.chunks[c].indexesCount);
+        EXPECT_TRUE(std::equal(indexes, indexes + chunk.indexesCount, source.indexes + source.chunks[c].indexesOffset));
+        ASSERT_LE(chunk.lodsCount, 3u);
+
+        // Уровни лежат подряд за LOD0, становятся меньше, ошибка растет в пределах допустимой
+        uint32_t next = chunk.indexesCount, previousCount = chunk.indexesCount;
+        float previousError = 0.0f;
+        for (uint32_t l = 0; l < chunk.lodsCount; ++l)
+        {
+            const auto &lod = geometry.lods[chunk.lodsOffset + l];
+            ASSERT_EQ(lod.indexesOffset, next);
+            ASSERT_LT(lod.indexesCount, previousCount);
+            ASSERT_GE(lod.error, previousError);
+            ASSERT_LE(lod.error, LITE3D_LOD_DEFAULT_MAX_ERROR * chunk.boundingVol.radius);
+            checkIndexes(indexes + lod.indexesOffset, lod.indexesCount, chunk.verticesCount);
+            if (HasFatalFailure())
+                return;
+
+            // Ошибка уровня - измеренное отклонение, выбор уровня может считать ее точной границей
+            std::vector<float> chunkPositions(geometry.positions + chunk.verticesOffset * 3, 
+                geometry.positions + (chunk.verticesOffset + chunk.verticesCount) * 3);
+            EXPECT_GE(lod.error + 1e-5f, maxDeviation(chunkPositions, indexes + lod.indexesOffset, lod.indexesCount));
+            next += lod.indexesCount;
+            previousCount = lod.indexesCount;
+            previousError = lod.error;
+        }
+    }
+
+    // Кластеры и уровни строятся в любом порядке и не теряют друг друга
+    ASSERT_TRUE(lite3d_mesh_m_build_clusters(lodBuffer, lodBufferSize, LITE3D_CLUSTER_MAX_VERTICES,
+        LITE3D_CLUSTER_MAX_TRIANGLES, &clusterBuffer, &clusterBufferSize));
+    ASSERT_TRUE(lite3d_mesh_m_decode_geometry(&clustered, clusterBuffer, clusterBufferSize));
+    EXPECT_GT(clustered.clustersCount, 0u);
+    ASSERT_EQ(clustered.lodsCount, geometry.lodsCount);
+    EXPECT_EQ(clustered.indexesCount, geometry.indexesCount);
+    for (uint32_t c = 0; c < geometry.chunksCount; ++c)
+    {
+        const auto &chunk = geometry.chunks[c];
+        const uint32_t *lodIndexes = geometry.indexes + chunk.indexesOffset + chunk.indexesCount;
+        uint32_t lodIndexesCount = geometry.indexesCount - chunk.indexesOffset - chunk.indexesCount;
+        if (c + 1 < geometry.chunksCount)
+            lodIndexesCount = geometry.chunks[c + 1].indexesOffset - chunk.indexesOffset - chunk.indexesCount;
+        EXPECT_TRUE(std::equal(lodIndexes, lodIndexes + lodIndexesCount, 
+            clustered.indexes + clustered.chunks[c].indexesOffset + chunk.indexesCount));
+    }
+
+    // Повторная генерация заменяет уровни и сохраняет кластеры
+    ASSERT_TRUE(lite3d_mesh_m_build_lods(clusterBuffer, clusterBufferSize, 3, LITE3D_LOD_DEFAULT_REDUCTION,
+        LITE3D_LOD_DEFAULT_MAX_ERROR, &rebuilt, &rebuiltSize));
+    lite3d_mesh_m_geometry_purge(&clustered);
+    ASSERT_TRUE(lite3d_mesh_m_decode_geometry(&clustered, rebuilt, rebuiltSize));
+    EXPECT_GT(clustered.clustersCount, 0u);
+    EXPECT_EQ(clustered.lodsCount, geometry.lodsCount);
+    EXPECT_EQ(rebuiltSize, clusterBufferSize);
+
+    lite3d_mesh_m_geometry_purge(&clustered);
+    lite3d_mesh_m_geometry_purge(&geometry);
+    lite3d_mesh_m_geometry_purge(&source);
+    lite3d_free(rebuilt);
+    lite3d_free(clusterBuffer);
+    lite3d_free(lodBuffer);
+    lite3d_pack_close(pack);
+}
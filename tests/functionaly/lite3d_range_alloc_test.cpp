@@ -0,0 +1,274 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <iostream>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_range_alloc.h>
+#include <lite3d/lite3d_mesh_loader.h>
+
+#include "lite3d_common_test.h"
+
+class RangeAlloc_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    void SetUp() override
+    {
+        lite3d_range_allocator_init(&mAllocator);
+    }
+
+    void TearDown() override
+    {
+        lite3d_range_allocator_purge(&mAllocator);
+    }
+
+    /* allocate with geometric growth like the mesh does */
+    size_t alloc(size_t size, size_t align)
+    {
+        size_t offset;
+        if (!lite3d_range_alloc(&mAllocator, size, align, &offset))
+        {
+            EXPECT_TRUE(lite3d_range_allocator_grow(&mAllocator,
+                lite3d_range_allocator_grow_capacity(&mAllocator, size, align)));
+            EXPECT_TRUE(lite3d_range_alloc(&mAllocator, size, align, &offset));
+        }
+
+        return offset;
+    }
+
+    /* free list is sorted, coalesced and matches the shadow map */
+    void checkFreeList(const std::vector<uint8_t> &busy)
+    {
+        size_t freeBytes = 0, pos = 0;
+        lite3d_range *range;
+        LITE3D_ARR_FOREACH(&mAllocator.freeRanges, lite3d_range, range)
+        {
+            ASSERT_GT(range->size, 0u);
+            if (pos > 0)
+            {
+                ASSERT_GT(range->offset, pos) << "ranges are not sorted or not coalesced";
+            }
+            for (size_t i = pos; i < range->offset; ++i)
+                ASSERT_TRUE(busy[i]) << "lost free byte at " << i;
+            for (size_t i = range->offset; i < range->offset + range->size; ++i)
+                ASSERT_FALSE(busy[i]) << "free range overlaps allocation at " << i;
+            pos = range->offset + range->size;
+            freeBytes += range->size;
+        }
+
+        ASSERT_LE(pos, mAllocator.capacity);
+        ASSERT_EQ(freeBytes + mAllocator.usedBytes, mAllocator.capacity);
+    }
+
+    lite3d_range_allocator mAllocator;
+};
+
+TEST_F(RangeAlloc_Test, AlignAndCoalesce)
+{
+    ASSERT_TRUE(lite3d_range_allocator_grow(&mAllocator, 120));
+    size_t a = alloc(10, 1), b = alloc(24, 12), c = alloc(20, 4);
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 12u);
+    EXPECT_EQ(c, 36u);
+    /* gap after first allocation is reused */
+    EXPECT_EQ(alloc(2, 2), 10u);
+
+    lite3d_range_free(&mAllocator, b, 24);
+    lite3d_range_free(&mAllocator, c, 20);
+    EXPECT_EQ(mAllocator.freeRanges.size, 1u);
+    EXPECT_EQ(lite3d_range_allocator_max_free(&mAllocator), 108u);
+    lite3d_range_free(&mAllocator, a, 10);
+    lite3d_range_free(&mAllocator, 10, 2);
+    EXPECT_EQ(mAllocator.freeRanges.size, 1u);
+    EXPECT_EQ(mAllocator.usedBytes, 0u);
+    EXPECT_EQ(mAllocator.bytesCopied, 0u);
+}
+
+TEST_F(RangeAlloc_Test, Fuzz)
+{
+    struct Block { size_t offset, size; };
+    std::mt19937 rnd(1234);
+    std::vector<Block> blocks;
+    std::vector<uint8_t> busy;
+
+    for (int step = 0; step < 20000; ++step)
+    {
+        if (blocks.empty() || rnd() % 100 < 55)
+        {
+            size_t align = 1 + rnd() % 48;
+            size_t size = 1 + rnd() % 500;
+            size_t offset = alloc(size, align);
+            ASSERT_EQ(offset % align, 0u);
+            busy.resize(mAllocator.capacity, 0);
+            for (size_t i = offset; i < offset + size; ++i)
+            {
+                ASSERT_FALSE(busy[i]) << "double allocation at " << i;
+                busy[i] = 1;
+            }
+            blocks.push_back({ offset, size });
+        }
+        else
+        {
+            size_t index = rnd() % blocks.size();
+            Block block = blocks[index];
+            blocks[index] = blocks.back();
+            blocks.pop_back();
+            std::fill(busy.begin() + block.offset, busy.begin() + block.offset + block.size, 0);
+            lite3d_range_free(&mAllocator, block.offset, block.size);
+        }
+
+        if (step % 97 == 0)
+            checkFreeList(busy);
+
+        /* compaction: pack blocks to the start */
+        if (step % 5000 == 4999)
+        {
+            size_t used = 0;
+            std::fill(busy.begin(), busy.end(), 0);
+            for (auto &block : blocks)
+            {
+                block.offset = used;
+                std::fill(busy.begin() + used, busy.begin() + used + block.size, 1);
+                used += block.size;
+            }
+            ASSERT_TRUE(lite3d_range_allocator_reset(&mAllocator, mAllocator.capacity, used));
+            checkFreeList(busy);
+        }
+    }
+
+    checkFreeList(busy);
+    for (const auto &block : blocks)
+        lite3d_range_free(&mAllocator, block.offset, block.size);
+    EXPECT_EQ(mAllocator.usedBytes, 0u);
+    EXPECT_EQ(mAllocator.freeRanges.size, 1u);
+}
+
+TEST_F(RangeAlloc_Test, PerfomanceGrowth)
+{
+    const int chunks = 2000;
+    const size_t stride = 32;
+    std::mt19937 rnd(42);
+    size_t exactCopied = 0, exactSize = 0;
+
+    for (int i = 0; i < chunks; ++i)
+    {
+        size_t size = stride * (100 + rnd() % 2000);
+        /* exact growth copies the whole buffer on every append */
+        exactCopied += exactSize;
+        exactSize += size;
+        alloc(size, stride);
+    }
+
+    EXPECT_EQ(mAllocator.usedBytes, exactSize);
+    EXPECT_LE(mAllocator.bytesCopied, 2 * mAllocator.capacity);
+    EXPECT_LE(mAllocator.capacity, 2 * exactSize + 2 * stride * 2100);
+
+    std::cout << chunks << " chunks, " << exactSize << " bytes: exact growth copied " << exactCopied
+        << " bytes, geometric growth copied " << mAllocator.bytesCopied << " bytes in " << mAllocator.grows
+        << " grows, capacity " << mAllocator.capacity << " bytes" << std::endl;
+}
+
+class MeshChunkPlacement_Test : public Lite3dCommon
+{
+public:
+
+    static constexpr uint32_t verticesCount = 4;
+
+    static std::vector<float> makeVertices(float tag)
+    {
+        std::vector<float> vertices(verticesCount * 3);
+        for (size_t i = 0; i < vertices.size(); ++i)
+            vertices[i] = tag + (float)i;
+        return vertices;
+    }
+
+    static lite3d_mesh_chunk *lastChunk(lite3d_mesh *mesh)
+    {
+        return LITE3D_MEMBERCAST(lite3d_mesh_chunk, lite3d_list_last_link(&mesh->chunks), link);
+    }
+
+    /* chunk placed below the first one after remove must not get negative base vertex */
+    static int removeAppendMultidraw(void *userdata)
+    {
+        const lite3d_vao_layout layout[] = { { LITE3D_BUFFER_BINDING_VERTEX, 3 } };
+        const uint32_t stride = 3 * sizeof(float);
+        lite3d_mesh mesh;
+        std::vector<lite3d_mesh_chunk *> chunks;
+
+        EXPECT_TRUE(lite3d_mesh_init(&mesh, LITE3D_VBO_STATIC_DRAW) == LITE3D_TRUE);
+        for (int i = 0; i < 3; ++i)
+        {
+            auto vertices = makeVertices(100.0f * i);
+            EXPECT_TRUE(lite3d_mesh_append_from_memory(&mesh, vertices.data(), verticesCount, layout, 1) == LITE3D_TRUE);
+            chunks.push_back(lastChunk(&mesh));
+        }
+
+        EXPECT_EQ(mesh.baseChunk, chunks[0]);
+        lite3d_mesh_chunk_remove(chunks[0]);
+        EXPECT_EQ(mesh.baseChunk, chunks[1]);
+
+        auto vertices = makeVertices(1000.0f);
+        EXPECT_TRUE(lite3d_mesh_append_from_memory(&mesh, vertices.data(), verticesCount, layout, 1) == LITE3D_TRUE);
+        chunks[0] = lastChunk(&mesh);
+        /* freed range at the start of buffer is reused */
+        EXPECT_EQ(chunks[0]->vao.verticesOffset, 0u);
+        EXPECT_EQ(mesh.baseChunk, chunks[0]);
+
+        std::vector<float> buffer(mesh.vertexBuffer.size / sizeof(float));
+        EXPECT_TRUE(lite3d_vbo_get_buffer(&mesh.vertexBuffer, buffer.data(), 0, mesh.vertexBuffer.size) == LITE3D_TRUE);
+
+        /* list order is 1, 2, 0 now, queue it as is */
+        lite3d_mesh_queue_chunk(chunks[1]);
+        lite3d_mesh_queue_chunk(chunks[2]);
+        lite3d_mesh_queue_chunk(chunks[0]);
+        EXPECT_EQ(mesh.drawQueue.size, 3u);
+
+        for (size_t i = 0; i < mesh.drawQueue.size; ++i)
+        {
+            lite3d_mesh_chunk *chunk = chunks[(i + 1) % 3];
+            lite3d_multidraw_command *command = static_cast<lite3d_multidraw_command *>(lite3d_array_get(&mesh.drawQueue, i));
+            EXPECT_EQ(command->count, verticesCount);
+            /* first vertex is counted from the bound base chunk and points to the chunk data */
+            EXPECT_EQ(mesh.baseChunk->vao.verticesOffset + (size_t)command->first * stride, chunk->vao.verticesOffset);
+            auto expected = makeVertices(chunk == chunks[0] ? 1000.0f : 100.0f * ((i + 1) % 3));
+            EXPECT_EQ(memcmp(&buffer[(mesh.baseChunk->vao.verticesOffset / stride + command->first) * 3],
+                expected.data(), verticesCount * stride), 0);
+        }
+
+        lite3d_mesh_queue_clean(&mesh);
+        lite3d_mesh_chunk_remove(chunks[0]);
+        EXPECT_EQ(mesh.baseChunk, chunks[1]);
+        EXPECT_TRUE(lite3d_mesh_compact(&mesh) == LITE3D_TRUE);
+        EXPECT_EQ(mesh.baseChunk, chunks[1]);
+        EXPECT_EQ(chunks[1]->vao.verticesOffset, 0u);
+
+        lite3d_mesh_purge(&mesh);
+        /* quit immediatly */
+        return LITE3D_FALSE;
+    }
+};
+
+LITE3D_GTEST_DECLARE(MeshChunkPlacement_Test, RemoveAppendMultidraw, MeshChunkPlacement_Test::removeAppendMultidraw)
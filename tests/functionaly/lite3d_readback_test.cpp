@@ -0,0 +1,219 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_readback.h>
+
+/*
+ * GPU model: every copy stores source level as buffer content,
+ * fence is signaled after given number of frames
+ */
+struct MockGPU
+{
+    uint32_t nextBuffer = 1;
+    std::map<uint32_t, std::vector<uint8_t>> buffers;
+    std::map<intptr_t, int> fences;
+    intptr_t nextFence = 1;
+    int frame = 0;
+    int fenceDelay = 2;
+    int reads = 0;
+    int copies = 0;
+};
+
+static MockGPU gGPU;
+
+static uint32_t mock_buffer_create(size_t size)
+{
+    gGPU.buffers[gGPU.nextBuffer].resize(size);
+    return gGPU.nextBuffer++;
+}
+
+static void mock_buffer_delete(uint32_t bufferID)
+{
+    EXPECT_EQ(gGPU.buffers.erase(bufferID), 1u);
+}
+
+static int mock_copy(const lite3d_readback_source *source, uint32_t bufferID)
+{
+    auto &buffer = gGPU.buffers.at(bufferID);
+    EXPECT_GE(buffer.size(), source->size);
+    std::fill(buffer.begin(), buffer.begin() + source->size, static_cast<uint8_t>(source->level));
+    gGPU.copies++;
+    return LITE3D_TRUE;
+}
+
+static void *mock_fence_insert()
+{
+    gGPU.fences[gGPU.nextFence] = gGPU.frame + gGPU.fenceDelay;
+    return reinterpret_cast<void *>(gGPU.nextFence++);
+}
+
+static int mock_fence_signaled(void *fence)
+{
+    return gGPU.fences.at(reinterpret_cast<intptr_t>(fence)) <= gGPU.frame;
+}
+
+static void mock_fence_delete(void *fence)
+{
+    EXPECT_EQ(gGPU.fences.erase(reinterpret_cast<intptr_t>(fence)), 1u);
+}
+
+static int mock_buffer_read(uint32_t bufferID, void *data, size_t size)
+{
+    auto &buffer = gGPU.buffers.at(bufferID);
+    memcpy(data, buffer.data(), size);
+    gGPU.reads++;
+    return LITE3D_TRUE;
+}
+
+class Readback_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    void SetUp() override
+    {
+        static const lite3d_readback_backend backend = {
+            mock_buffer_create,
+            mock_buffer_delete,
+            mock_copy,
+            mock_fence_insert,
+            mock_fence_signaled,
+            mock_fence_delete,
+            mock_buffer_read
+        };
+
+        gGPU = MockGPU();
+        lite3d_readback_set_backend(&backend);
+        ASSERT_TRUE(lite3d_readback_init(&mReadback, 3));
+    }
+
+    void TearDown() override
+    {
+        lite3d_readback_purge(&mReadback);
+        /* all GPU objects are released */
+        EXPECT_TRUE(gGPU.buffers.empty());
+        EXPECT_TRUE(gGPU.fences.empty());
+        lite3d_readback_set_backend(NULL);
+    }
+
+    /* level is used as marker of request */
+    int request(int8_t marker, size_t size = 16)
+    {
+        lite3d_readback_source source = {};
+        source.level = marker;
+        source.size = size;
+        return lite3d_readback_request(&mReadback, &source);
+    }
+
+    int resultMarker()
+    {
+        size_t size;
+        const uint8_t *result = static_cast<const uint8_t *>(lite3d_readback_result(&mReadback, &size));
+        return result ? result[size - 1] : -1;
+    }
+
+    lite3d_readback mReadback;
+};
+
+TEST_F(Readback_Test, ResultArrivesLater)
+{
+    EXPECT_EQ(lite3d_readback_result(&mReadback, NULL), nullptr);
+
+    /* request every frame, GPU finishes copy two frames later */
+    for (int8_t frame = 0; frame < 10; ++frame)
+    {
+        gGPU.frame = frame;
+        bool updated = lite3d_readback_poll(&mReadback);
+        EXPECT_TRUE(request(frame));
+
+        if (frame < 2)
+        {
+            EXPECT_FALSE(updated);
+            EXPECT_EQ(resultMarker(), -1);
+        }
+        else
+        {
+            EXPECT_TRUE(updated);
+            EXPECT_EQ(resultMarker(), frame - 2);
+            EXPECT_EQ(mReadback.latency, 2u);
+        }
+    }
+
+    /* buffers are reused, no allocations after warm up */
+    EXPECT_EQ(gGPU.nextBuffer, 4u);
+    EXPECT_EQ(mReadback.skipped, 0u);
+    EXPECT_EQ(mReadback.requested, 10u);
+    EXPECT_EQ(mReadback.completed, 8u);
+}
+
+TEST_F(Readback_Test, FullRingSkipsRequests)
+{
+    gGPU.fenceDelay = 100;
+    EXPECT_TRUE(request(1));
+    EXPECT_TRUE(request(2));
+    EXPECT_TRUE(request(3));
+    /* CPU must not wait for stalled GPU */
+    EXPECT_FALSE(request(4));
+    EXPECT_FALSE(lite3d_readback_poll(&mReadback));
+    EXPECT_EQ(mReadback.skipped, 1u);
+    EXPECT_EQ(gGPU.copies, 3);
+
+    /* purge with pending copies releases fences in TearDown */
+}
+
+TEST_F(Readback_Test, OnlyLatestIsRead)
+{
+    gGPU.fenceDelay = 5;
+    request(1);
+    gGPU.frame = 1;
+    request(2);
+    gGPU.frame = 2;
+    request(3);
+
+    /* first two copies are finished */
+    gGPU.frame = 6;
+    EXPECT_TRUE(lite3d_readback_poll(&mReadback));
+    EXPECT_EQ(resultMarker(), 2);
+    EXPECT_EQ(gGPU.reads, 1);
+    EXPECT_EQ(mReadback.pending, 1u);
+    EXPECT_EQ(mReadback.completed, 2u);
+
+    /* nothing new, old result is kept */
+    EXPECT_FALSE(lite3d_readback_poll(&mReadback));
+    EXPECT_EQ(resultMarker(), 2);
+
+    /* bigger request replaces buffer of the slot */
+    EXPECT_TRUE(request(4, 64));
+    gGPU.frame = 20;
+    EXPECT_TRUE(lite3d_readback_poll(&mReadback));
+    size_t size;
+    lite3d_readback_result(&mReadback, &size);
+    EXPECT_EQ(size, 64u);
+    EXPECT_EQ(resultMarker(), 4);
+    EXPECT_EQ(mReadback.pending, 0u);
+}
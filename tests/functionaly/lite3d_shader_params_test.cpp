@@ -0,0 +1,231 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_alloc.h>
+#include <lite3d/lite3d_shader_program.h>
+
+class ShaderParams_Test : public ::testing::Test
+{
+protected:
+
+    static void SetUpTestCase()
+    {
+        lite3d_memory_init(NULL);
+    }
+
+    void SetUp() override
+    {
+        /* program is not linked, binding table is filled by test */
+        memset(&mProgram, 0, sizeof(mProgram));
+        mProgram.success = LITE3D_TRUE;
+        mProgram.linkId = 1;
+        lite3d_shader_parameters_init(&mParams);
+        lite3d_gl_state_stats_reset();
+    }
+
+    void TearDown() override
+    {
+        lite3d_shader_parameters_remove_all(&mParams);
+        lite3d_array_purge(&mProgram.bindings);
+        lite3d_array_purge(&mProgram.uniformCache);
+    }
+
+    lite3d_shader_parameter *addParameter(const std::string &name, uint8_t type)
+    {
+        mParameters.emplace_back(new lite3d_shader_parameter);
+        lite3d_shader_parameter *param = mParameters.back().get();
+        lite3d_shader_parameter_init(param);
+        name.copy(param->name, sizeof(param->name) - 1);
+        param->type = type;
+        lite3d_shader_parameters_add(&mParams, param);
+        return param;
+    }
+
+    lite3d_shader_parameter_container *container(size_t index)
+    {
+        return LITE3D_ARR_ELEM(&mParams.applyTable, lite3d_shader_parameter_container *, index);
+    }
+
+    lite3d_shader_program mProgram;
+    lite3d_shader_parameters mParams;
+    std::vector<std::unique_ptr<lite3d_shader_parameter>> mParameters;
+};
+
+TEST_F(ShaderParams_Test, BindingTable)
+{
+    EXPECT_TRUE(lite3d_shader_program_add_binding(&mProgram, "roughness", LITE3D_SHADER_BINDING_UNIFORM, 4, 0x1406, 1));
+    EXPECT_TRUE(lite3d_shader_program_add_binding(&mProgram, "lights[0]", LITE3D_SHADER_BINDING_UNIFORM, 10, 0x8B52, 8));
+    EXPECT_TRUE(lite3d_shader_program_add_binding(&mProgram, "Material", LITE3D_SHADER_BINDING_UNIFORM_BLOCK, 0, 0, 1));
+    EXPECT_TRUE(lite3d_shader_program_add_binding(&mProgram, "Material", LITE3D_SHADER_BINDING_STORAGE_BLOCK, 2, 0, 1));
+    EXPECT_TRUE(lite3d_shader_program_add_binding(&mProgram, "albedo", LITE3D_SHADER_BINDING_UNIFORM, 0, 0x8B5E, 1));
+
+    const lite3d_shader_binding *binding;
+    binding = lite3d_shader_program_find_binding(&mProgram,
+        lite3d_shader_parameter_name_hash("lights"), LITE3D_SHADER_BINDING_UNIFORM);
+    ASSERT_TRUE(binding);
+    EXPECT_EQ(binding->location, 10);
+    EXPECT_EQ(binding->size, 8);
+
+    binding = lite3d_shader_program_find_binding(&mProgram,
+        lite3d_shader_parameter_name_hash("Material"), LITE3D_SHADER_BINDING_STORAGE_BLOCK);
+    ASSERT_TRUE(binding);
+    EXPECT_EQ(binding->location, 2);
+    EXPECT_FALSE(lite3d_shader_program_find_binding(&mProgram,
+        lite3d_shader_parameter_name_hash("Material"), LITE3D_SHADER_BINDING_UNIFORM));
+    EXPECT_FALSE(lite3d_shader_program_find_binding(&mProgram,
+        lite3d_shader_parameter_name_hash("metallic"), LITE3D_SHADER_BINDING_UNIFORM));
+
+    /* same key twice means names are not distinguishable by hash */
+    EXPECT_TRUE(lite3d_shader_program_add_binding(&mProgram, "roughness", LITE3D_SHADER_BINDING_UNIFORM, 5, 0x1406, 1));
+    binding = lite3d_shader_program_find_binding(&mProgram,
+        lite3d_shader_parameter_name_hash("roughness"), LITE3D_SHADER_BINDING_UNIFORM);
+    ASSERT_TRUE(binding);
+    EXPECT_EQ(binding->location, LITE3D_SHADER_BINDING_COLLISION);
+
+    /* table is sorted */
+    const lite3d_shader_binding *prev = NULL;
+    LITE3D_ARR_FOREACH(&mProgram.bindings, const lite3d_shader_binding, binding)
+    {
+        if (prev)
+        {
+            EXPECT_TRUE(prev->nameHash < binding->nameHash ||
+                (prev->nameHash == binding->nameHash && prev->kind < binding->kind));
+        }
+        prev = binding;
+    }
+}
+
+TEST_F(ShaderParams_Test, CompileParameters)
+{
+    lite3d_shader_program_add_binding(&mProgram, "roughness", LITE3D_SHADER_BINDING_UNIFORM, 4, 0x1406, 1);
+    lite3d_shader_program_add_binding(&mProgram, "Material", LITE3D_SHADER_BINDING_UNIFORM_BLOCK, 1, 0, 1);
+    addParameter("roughness", LITE3D_SHADER_PARAMETER_FLOAT);
+    addParameter("Material", LITE3D_SHADER_PARAMETER_UBO);
+    addParameter("lights[2]", LITE3D_SHADER_PARAMETER_FLOATV4);
+
+    lite3d_shader_program_compile_parameters(&mProgram, &mParams);
+    ASSERT_EQ(mParams.applyTable.size, 3u);
+    EXPECT_EQ(mParams.compiledProgram, &mProgram);
+    EXPECT_EQ(container(0)->location, 4);
+    EXPECT_EQ(container(1)->location, 1);
+    EXPECT_EQ(container(1)->binding, -1);
+    /* not in table, resolved by name on first use */
+    EXPECT_EQ(container(2)->location, -1);
+
+    EXPECT_EQ(lite3d_shader_parameters_get(&mParams, "Material"), mParameters[1].get());
+    EXPECT_EQ(lite3d_shader_parameters_get(&mParams, "material"), nullptr);
+
+    /* table is compiled again after parameters changed */
+    EXPECT_TRUE(lite3d_shader_parameters_remove(&mParams, "Material"));
+    EXPECT_EQ(mParams.compiledProgram, nullptr);
+}
+
+/*
+ * CPU cost of applying PBR material with 64 parameters when values are not changed,
+ * samplers are not included because texture units need GL context
+ */
+TEST_F(ShaderParams_Test, PerfomanceApply)
+{
+    const int paramsCount = 64, frames = 20000;
+    const uint8_t types[] = { LITE3D_SHADER_PARAMETER_FLOAT, LITE3D_SHADER_PARAMETER_FLOATV3,
+        LITE3D_SHADER_PARAMETER_FLOATV4, LITE3D_SHADER_PARAMETER_FLOATM4 };
+    std::vector<std::string> names;
+
+    for (int i = 0; i < paramsCount; ++i)
+    {
+        /* names with common prefix like real material */
+        names.push_back("material.pbrParameter" + std::to_string(i));
+        lite3d_shader_parameter *param = addParameter(names.back(), types[i % 4]);
+        kmMat4Identity(&param->parameter.valmat4);
+        lite3d_shader_program_add_binding(&mProgram, names.back().c_str(), LITE3D_SHADER_BINDING_UNIFORM,
+            i, 0, 1);
+    }
+
+    lite3d_shader_program_compile_parameters(&mProgram, &mParams);
+    /* values are already in GL, no glUniform calls expected */
+    for (int i = 0; i < paramsCount; ++i)
+    {
+        static const size_t sizes[] = { sizeof(float), sizeof(kmVec3), sizeof(kmVec4), sizeof(kmMat4) };
+        ASSERT_EQ(container(i)->location, i);
+        lite3d_gl_state_uniform_changed(&mProgram.uniformCache, i, &mParameters[i]->parameter, sizes[i % 4]);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    /* previous way: walk the list and dispatch every container */
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (lite3d_list_node *node = mParams.parameters.l.next; node != &mParams.parameters.l; node = node->next)
+        {
+            lite3d_shader_program_uniform_set(&mProgram,
+                LITE3D_MEMBERCAST(lite3d_shader_parameter_container, node, parameterLink));
+        }
+    }
+    auto listTime = std::chrono::steady_clock::now() - begin;
+
+    begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+        lite3d_shader_program_apply_parameters(&mProgram, &mParams, LITE3D_TRUE);
+    auto tableTime = std::chrono::steady_clock::now() - begin;
+
+    /* lookup by name, e.g. material parameter setters */
+    size_t found = 0;
+    begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames / 10; ++frame)
+    {
+        for (const auto &name : names)
+        {
+            for (lite3d_list_node *node = mParams.parameters.l.next; node != &mParams.parameters.l; node = node->next)
+            {
+                if (strcmp(LITE3D_MEMBERCAST(lite3d_shader_parameter_container, node, parameterLink)->parameter->name,
+                    name.c_str()) == 0)
+                {
+                    found++;
+                    break;
+                }
+            }
+        }
+    }
+    auto strcmpTime = std::chrono::steady_clock::now() - begin;
+
+    begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames / 10; ++frame)
+    {
+        for (const auto &name : names)
+            found += lite3d_shader_parameters_get(&mParams, name.c_str()) != NULL;
+    }
+    auto hashTime = std::chrono::steady_clock::now() - begin;
+
+    EXPECT_EQ(found, 2u * paramsCount * (frames / 10));
+
+    lite3d_gl_state_stats stats;
+    lite3d_gl_state_get_stats(&stats);
+    EXPECT_EQ(stats.uniforms, paramsCount);
+
+    auto ns = [](auto d, int count) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / count; };
+    std::cout << paramsCount << " parameters, apply per pass: list " << ns(listTime, frames)
+        << " ns, compiled table " << ns(tableTime, frames) << " ns; lookup of all names: strcmp "
+        << ns(strcmpTime, frames / 10) << " ns, hashed " << ns(hashTime, frames / 10) << " ns" << std::endl;
+}
@@ -0,0 +1,189 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_action.h>
+
+using lite3dpp::Action;
+using lite3dpp::String;
+using lite3dpp::stl;
+
+struct TestBone
+{
+    void setPosition(const kmVec3 &p) { position = p; }
+    void setRotation(const kmQuaternion &q) { rotation = q; }
+    void setScale(const kmVec3 &s) { scale = s; }
+
+    kmVec3 position = KM_VEC3_ZERO;
+    kmQuaternion rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+    kmVec3 scale = KM_VEC3_ONE;
+};
+
+/* Key frames lookup and interpolation as it was done before tracks, used as the benchmark baseline */
+static void legacy_sample(TestBone *bone, float time, const stl<Action::KeyFrame>::vector &frames)
+{
+    Action::KeyFrame marker = { time };
+    auto it = std::upper_bound(frames.begin(), frames.end(), marker);
+    const Action::KeyFrame *left = it == frames.begin() ? &frames.front() : &(*std::prev(it));
+    const Action::KeyFrame *right = it == frames.end() ? &frames.back() : &(*it);
+    float k = left == right ? 0.0f : (time - left->frameNo) / (right->frameNo - left->frameNo);
+
+    auto channel = [](const Action::KeyFrame *frame, Action::KeyFrame::Channel ch)
+    {
+        for (const auto &c : frame->channels)
+            if (std::get<0>(c) == ch)
+                return std::get<1>(c);
+        return Action::KeyFrame::ChannelValue {};
+    };
+
+    auto l = channel(left, Action::KeyFrame::Channel::Location);
+    auto r = channel(right, Action::KeyFrame::Channel::Location);
+    kmVec3Lerp(&bone->position, &l.position, &r.position, k);
+    l = channel(left, Action::KeyFrame::Channel::Rotation);
+    r = channel(right, Action::KeyFrame::Channel::Rotation);
+    kmQuaternionSlerp(&bone->rotation, &l.rotation, &r.rotation, k);
+    l = channel(left, Action::KeyFrame::Channel::Scale);
+    r = channel(right, Action::KeyFrame::Channel::Scale);
+    kmVec3Lerp(&bone->scale, &l.scale, &r.scale, k);
+}
+
+class Action_Test : public ::testing::Test
+{
+protected:
+
+    static const int BonesCount = 100;
+    static const int SkeletonsCount = 100;
+    static const int KeysCount = 60;
+
+    void SetUp() override
+    {
+        for (int b = 0; b < BonesCount; ++b)
+        {
+            stl<Action::KeyFrame>::vector frames;
+            for (int k = 0; k < KeysCount; ++k)
+            {
+                Action::KeyFrame frame;
+                Action::KeyFrame::ChannelValue value = {};
+                frame.frameNo = static_cast<float>(k * 2);
+
+                value.position = { float(b), float(k), float(b + k) };
+                frame.channels.emplace_back(std::make_tuple(Action::KeyFrame::Channel::Location, value));
+                kmVec3 axis = { 0.0f, 1.0f, 0.0f };
+                kmQuaternionRotationAxisAngle(&value.rotation, &axis, 0.05f * k + 0.01f * b);
+                frame.channels.emplace_back(std::make_tuple(Action::KeyFrame::Channel::Rotation, value));
+                value.scale = { 1.0f + 0.01f * k, 1.0f, 1.0f };
+                frame.channels.emplace_back(std::make_tuple(Action::KeyFrame::Channel::Scale, value));
+                frames.push_back(frame);
+            }
+
+            String name = "bone" + std::to_string(b);
+            mBoneNames.push_back(name);
+            mLegacyFrames[name] = frames;
+            mTracks.emplace_back();
+            Action::compileTrack(frames, mTracks.back());
+        }
+    }
+
+    stl<String>::vector mBoneNames;
+    stl<String, stl<Action::KeyFrame>::vector>::unordered_map mLegacyFrames;
+    stl<Action::Track>::vector mTracks;
+};
+
+TEST_F(Action_Test, TrackMatchesKeyFrames)
+{
+    TestBone legacy, compiled;
+    uint32_t cursor = 0;
+
+    /* forward, across the last key and back to start like a cycled clip */
+    for (float time : { -1.0f, 0.0f, 0.5f, 2.0f, 3.3f, 57.9f, 117.5f, 118.0f, 130.0f, 1.0f, 7.25f })
+    {
+        legacy_sample(&legacy, time, mLegacyFrames[mBoneNames[7]]);
+        mTracks[7].apply(&compiled, time, cursor);
+
+        EXPECT_NEAR(legacy.position.x, compiled.position.x, 1e-5f);
+        EXPECT_NEAR(legacy.position.y, compiled.position.y, 1e-5f);
+        EXPECT_NEAR(legacy.position.z, compiled.position.z, 1e-5f);
+        EXPECT_NEAR(legacy.rotation.y, compiled.rotation.y, 1e-5f);
+        EXPECT_NEAR(legacy.rotation.w, compiled.rotation.w, 1e-5f);
+        EXPECT_NEAR(legacy.scale.x, compiled.scale.x, 1e-5f);
+    }
+}
+
+TEST_F(Action_Test, MissingChannelsFilled)
+{
+    stl<Action::KeyFrame>::vector frames(3);
+    Action::KeyFrame::ChannelValue value = {};
+    frames[0].frameNo = 0.0f;
+    frames[1].frameNo = 1.0f;
+    frames[2].frameNo = 2.0f;
+    value.position = { 1.0f, 0.0f, 0.0f };
+    frames[1].channels.emplace_back(std::make_tuple(Action::KeyFrame::Channel::Location, value));
+    value.position = { 3.0f, 0.0f, 0.0f };
+    frames[2].channels.emplace_back(std::make_tuple(Action::KeyFrame::Channel::Location, value));
+
+    Action::Track track;
+    Action::compileTrack(frames, track);
+    EXPECT_EQ(track.channels, Action::Track::HasLocation);
+    EXPECT_EQ(track.translations[0].x, 1.0f);
+
+    TestBone bone;
+    uint32_t cursor = 0;
+    track.apply(&bone, 1.5f, cursor);
+    EXPECT_EQ(cursor, 1u);
+    EXPECT_FLOAT_EQ(bone.position.x, 2.0f);
+    /* untouched channels */
+    EXPECT_EQ(bone.scale.x, 1.0f);
+}
+
+TEST_F(Action_Test, PerfomanceSkeletons)
+{
+    const int ticks = 200;
+    stl<TestBone>::vector bones(SkeletonsCount * BonesCount);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        for (int s = 0; s < SkeletonsCount; ++s)
+        {
+            float time = std::fmod(tick * 0.5f + s, 120.0f);
+            for (int b = 0; b < BonesCount; ++b)
+                legacy_sample(&bones[s * BonesCount + b], time, mLegacyFrames.find(mBoneNames[b])->second);
+        }
+    }
+    auto legacyMcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    /* per skeleton instance cursors */
+    stl<uint32_t>::vector cursors(SkeletonsCount * BonesCount, 0);
+    begin = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        for (int s = 0; s < SkeletonsCount; ++s)
+        {
+            float time = std::fmod(tick * 0.5f + s, 120.0f);
+            for (int b = 0; b < BonesCount; ++b)
+                mTracks[b].apply(&bones[s * BonesCount + b], time, cursors[s * BonesCount + b]);
+        }
+    }
+    auto tracksMcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << SkeletonsCount << " skeletons x " << BonesCount << " bones, " << ticks << " ticks: key frames "
+        << legacyMcs << " mcs, tracks " << tracksMcs << " mcs" << std::endl;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_buffer_dirty_ranges.h>
+
+using namespace lite3dpp;
+
+// Buffer in memory, records every upload
+class MemoryBuffer : public BufferBase
+{
+public:
+
+    explicit MemoryBuffer(size_t size) :
+        mData(size, 0)
+    {}
+
+    size_t bufferSizeBytes() const override
+    { return mData.size(); }
+    void extendBufferBytes(size_t addsize) override
+    { mData.resize(mData.size() + addsize); }
+    void setBufferSizeBytes(size_t size) override
+    { mData.resize(size); }
+    void setData(const void *buffer, size_t offset, size_t size) override
+    {
+        ASSERT_LE(offset + size, mData.size());
+        memcpy(mData.data() + offset, buffer, size);
+        uploads.emplace_back(offset, size);
+    }
+    void replaceData(const void *buffer, size_t size) override
+    { setData(buffer, 0, size); }
+    void getData(void *buffer, size_t offset, size_t size) const override
+    { memcpy(buffer, mData.data() + offset, size); }
+    BufferScopedMapper map(BufferScopedMapper::BufferScopedMapperLockType) override
+    { LITE3D_THROW("map is not supported"); }
+    bool valid() const override
+    { return true; }
+
+    std::vector<uint8_t> mData;
+    std::vector<std::pair<size_t, size_t>> uploads;
+};
+
+using Ranges = std::vector<std::pair<size_t, size_t>>;
+
+static Ranges toPairs(const stl<BufferDirtyRanges::Range>::vector &ranges)
+{
+    Ranges result;
+    for (const auto &range : ranges)
+        result.emplace_back(range.first, range.count);
+    return result;
+}
+
+TEST(BufferDirtyRanges_Test, MergeWithGap)
+{
+    BufferDirtyRanges dirty(16, 2);
+    dirty.resize(300);
+    EXPECT_FALSE(dirty.hasDirty());
+    EXPECT_TRUE(dirty.buildRanges().empty());
+
+    dirty.markDirty(5);
+    dirty.markDirty(7);        // gap 1, merged
+    dirty.markDirty(10, 2);    // gap 2, merged
+    dirty.markDirty(20);       // gap 8, new range
+    dirty.markDirty(62, 5);    // crosses word boundary
+    dirty.markDirty(128, 128); // whole words
+    dirty.markDirty(299);
+
+    EXPECT_TRUE(dirty.isDirty(7));
+    EXPECT_FALSE(dirty.isDirty(6));
+    EXPECT_EQ(toPairs(dirty.buildRanges()),
+        (Ranges{ { 5, 7 }, { 20, 1 }, { 62, 5 }, { 128, 128 }, { 299, 1 } }));
+
+    dirty.clear();
+    EXPECT_FALSE(dirty.hasDirty());
+    EXPECT_FALSE(dirty.isDirty(200));
+    EXPECT_TRUE(dirty.buildRanges().empty());
+
+    // Без допуска соседние по одному элементу диапазоны не сливаются
+    BufferDirtyRanges exact(4, 0);
+    exact.resize(10);
+    exact.markDirty(1);
+    exact.markDirty(3);
+    exact.markDirty(4);
+    EXPECT_EQ(toPairs(exact.buildRanges()), (Ranges{ { 1, 1 }, { 3, 2 } }));
+}
+
+TEST(BufferDirtyRanges_Test, RandomAgainstReference)
+{
+    std::mt19937 rnd(3);
+    for (int iteration = 0; iteration < 200; ++iteration)
+    {
+        size_t size = 1 + rnd() % 500, maxGap = rnd() % 6;
+        BufferDirtyRanges dirty(8, maxGap);
+        std::vector<bool> bits(size, false);
+        dirty.resize(size);
+
+        for (int mark = rnd() % 20; mark > 0; --mark)
+        {
+            size_t first = rnd() % size, count = 1 + rnd() % std::min<size_t>(size - first, 70);
+            dirty.markDirty(first, count);
+            std::fill(bits.begin() + first, bits.begin() + first + count, true);
+        }
+
+        // Эталон: серии грязных элементов, слитые через короткие промежутки
+        Ranges expected;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (!bits[i])
+                continue;
+            size_t end = i;
+            while (end < size && bits[end])
+                end++;
+            if (!expected.empty() && i - (expected.back().first + expected.back().second) <= maxGap)
+                expected.back().second = end - expected.back().first;
+            else
+                expected.emplace_back(i, end - i);
+            i = end;
+        }
+
+        ASSERT_EQ(toPairs(dirty.buildRanges()), expected) << "iteration " << iteration;
+    }
+}
+
+TEST(BufferDirtyRanges_Test, Resize)
+{
+    BufferDirtyRanges dirty(4);
+    dirty.resize(100);
+    dirty.markDirty(90, 10);
+    dirty.markDirty(10);
+
+    dirty.resize(95);
+    EXPECT_EQ(toPairs(dirty.buildRanges()), (Ranges{ { 10, 1 }, { 90, 5 } }));
+
+    // Выросшая часть чистая, даже если раньше там были грязные элементы
+    dirty.resize(70);
+    dirty.resize(128);
+    EXPECT_FALSE(dirty.isDirty(90));
+    EXPECT_EQ(toPairs(dirty.buildRanges()), (Ranges{ { 10, 1 } }));
+    EXPECT_EQ(dirty.bytesHeld(), 128u * 4u);
+}
+
+TEST(BufferDirtyRanges_Test, FlushUploadsChangedElements)
+{
+    std::vector<uint32_t> shadow(256);
+    MemoryBuffer buffer(shadow.size() * sizeof(uint32_t));
+    BufferDirtyRanges dirty(sizeof(uint32_t), 1);
+    dirty.resize(shadow.size());
+
+    for (size_t i : { 3, 4, 6, 100, 255 })
+    {
+        shadow[i] = static_cast<uint32_t>(i);
+        dirty.markDirty(i);
+    }
+
+    EXPECT_EQ(dirty.flush(buffer, shadow.data()), (4u + 1u + 1u) * sizeof(uint32_t));
+    EXPECT_EQ(buffer.uploads, (Ranges{ { 12, 16 }, { 400, 4 }, { 1020, 4 } }));
+    EXPECT_EQ(memcmp(buffer.mData.data(), shadow.data(), buffer.mData.size()), 0);
+    EXPECT_FALSE(dirty.hasDirty());
+
+    // Нечего заливать
+    buffer.uploads.clear();
+    EXPECT_EQ(dirty.flush(buffer, shadow.data()), 0u);
+    EXPECT_TRUE(buffer.uploads.empty());
+
+    const auto &stats = dirty.getStats();
+    EXPECT_EQ(stats.flushes, 2u);
+    EXPECT_EQ(stats.uploads, 3u);
+    EXPECT_EQ(stats.bytesUploaded, 24u);
+    EXPECT_EQ(stats.lastBytesUploaded, 0u);
+    EXPECT_EQ(dirty.bytesHeld(), 1024u);
+}
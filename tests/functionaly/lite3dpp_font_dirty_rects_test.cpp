@@ -0,0 +1,242 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <font.h>
+#include <texture.h>
+
+using namespace nw;
+
+static bool covered(const DirtyRects &dirty, int x, int y)
+{
+    for (const auto &rect : dirty.rects())
+    {
+        if (rect.inside(x, y))
+            return true;
+    }
+    return false;
+}
+
+static bool touching(const Rect<int> &a, const Rect<int> &b)
+{
+    return a.x0 <= b.x1 + 1 && b.x0 <= a.x1 + 1 && a.y0 <= b.y1 + 1 && b.y0 <= a.y1 + 1;
+}
+
+TEST(FontDirtyRects_Test, Merge)
+{
+    DirtyRects dirty;
+    EXPECT_TRUE(dirty.empty());
+    dirty.add(Rect<int>(5, 5, 4, 10));
+    EXPECT_TRUE(dirty.empty());
+
+    dirty.add(Rect<int>(0, 0, 9, 9));
+    dirty.add(Rect<int>(10, 0, 19, 9));   // вплотную, сливается
+    dirty.add(Rect<int>(100, 100, 109, 109));
+    ASSERT_EQ(dirty.rects().size(), 2u);
+    EXPECT_EQ(dirty.area(), 300u);
+
+    // Связывает оба, сливаются цепочкой
+    dirty.add(Rect<int>(15, 5, 105, 105));
+    ASSERT_EQ(dirty.rects().size(), 1u);
+    EXPECT_EQ(dirty.bounds().x0, 0);
+    EXPECT_EQ(dirty.bounds().x1, 109);
+
+    dirty.clear();
+    for (int i = 0; i < 20; ++i)
+        dirty.add(Rect<int>(i * 50, 0, i * 50 + 9, 9));
+    EXPECT_LE(dirty.rects().size(), DirtyRects::MaxRects);
+    EXPECT_EQ(dirty.bounds().x1, 959);
+}
+
+TEST(FontDirtyRects_Test, RandomCoverage)
+{
+    std::mt19937 rnd(11);
+    for (int iteration = 0; iteration < 100; ++iteration)
+    {
+        DirtyRects dirty;
+        std::vector<bool> bits(128 * 128, false);
+        for (int add = 1 + rnd() % 30; add > 0; --add)
+        {
+            int x = rnd() % 120, y = rnd() % 120;
+            Rect<int> rect(x, y, x + rnd() % 8, y + rnd() % 8);
+            dirty.add(rect);
+            for (int py = rect.y0; py <= rect.y1; ++py)
+                for (int px = rect.x0; px <= rect.x1; ++px)
+                    bits[py * 128 + px] = true;
+        }
+
+        ASSERT_LE(dirty.rects().size(), DirtyRects::MaxRects);
+        for (size_t a = 0; a < dirty.rects().size(); ++a)
+            for (size_t b = a + 1; b < dirty.rects().size(); ++b)
+                ASSERT_FALSE(touching(dirty.rects()[a], dirty.rects()[b]));
+
+        size_t marked = 0;
+        for (int y = 0; y < 128; ++y)
+        {
+            for (int x = 0; x < 128; ++x)
+            {
+                if (bits[y * 128 + x])
+                {
+                    marked++;
+                    ASSERT_TRUE(covered(dirty, x, y)) << x << "," << y << " iteration " << iteration;
+                }
+            }
+        }
+        EXPECT_GE(dirty.area(), marked);
+    }
+}
+
+TEST(FontDirtyRects_Test, TextureMarks)
+{
+    Texture texture(64, 32);
+    ASSERT_EQ(texture.dirty().rects().size(), 1u);
+    EXPECT_EQ(texture.dirty().area(), 64u * 32u);
+
+    texture.clearDirty();
+    texture.fill(RGBA(1, 2, 3), Rect<int>(-5, 10, 3, 12));
+    ASSERT_EQ(texture.dirty().rects().size(), 1u);
+    EXPECT_EQ(texture.dirty().rects()[0].x0, 0);
+    EXPECT_EQ(texture.dirty().area(), 4u * 3u);
+
+    texture.clearDirty();
+    Texture glyph(4, 4);
+    texture.sub(glyph, 62, 30);
+    EXPECT_EQ(texture.dirty().area(), 2u * 2u);
+
+    texture.clearDirty();
+    texture.fill(RGBA());
+    EXPECT_EQ(texture.dirty().area(), 64u * 32u);
+}
+
+TEST(FontDirtyRects_Test, MipRegion)
+{
+    // Пересчет мипов по изменениям дает то же, что полный пересчет
+    std::mt19937 rnd(3);
+    Texture base(37, 20);
+    for (auto &pixel : base.data())
+        pixel = RGBA(rnd() % 256, rnd() % 256, rnd() % 256, rnd() % 256);
+
+    std::vector<Texture> mips;
+    mips.reserve(8);
+    for (const Texture *source = &base; source->width() > 1 || source->height() > 1; source = &mips.back())
+    {
+        mips.emplace_back(std::max(1, source->width() / 2), std::max(1, source->height() / 2));
+        mips.back().downsample(*source, Rect<int>(0, 0, source->width() - 1, source->height() - 1));
+    }
+
+    for (int change = 0; change < 50; ++change)
+    {
+        int x = rnd() % 37, y = rnd() % 20;
+        base.clearDirty();
+        base.fill(RGBA(rnd() % 256, 0, 255, rnd() % 256), Rect<int>(x, y, x + rnd() % 5, y + rnd() % 5));
+
+        Rect<int> region = base.dirty().rects()[0];
+        const Texture *source = &base;
+        for (auto &mip : mips)
+        {
+            mip.downsample(*source, region);
+            region = Rect<int>(region.x0 / 2, region.y0 / 2, region.x1 / 2, region.y1 / 2);
+            source = &mip;
+        }
+    }
+
+    const Texture *source = &base;
+    for (auto &mip : mips)
+    {
+        Texture full(mip.width(), mip.height());
+        full.downsample(*source, Rect<int>(0, 0, source->width() - 1, source->height() - 1));
+        ASSERT_TRUE(full == mip) << mip.width() << "x" << mip.height();
+        source = &mip;
+    }
+}
+
+TEST(FontDirtyRects_Test, TextRenderRect)
+{
+    FontLib lib;
+    Font font(lib, "samples/fonts/arial.ttf", 14);
+    Text text(font, "Frame 1234\nSecond line");
+    text.setPos(20, 30);
+    text.setWidth(200);
+    text.setColor(RGBA(255, 255, 255));
+
+    Texture texture(256, 128);
+    Texture before(texture);
+    texture.clearDirty();
+    Rect<int> drawn = text.render(texture);
+    ASSERT_FALSE(drawn.empty());
+
+    size_t changed = 0;
+    for (int y = 0; y < texture.height(); ++y)
+    {
+        for (int x = 0; x < texture.width(); ++x)
+        {
+            if (texture.pixel(x, y) == before.pixel(x, y))
+                continue;
+            changed++;
+            ASSERT_TRUE(drawn.inside(x, y));
+            ASSERT_TRUE(covered(texture.dirty(), x, y));
+        }
+    }
+
+    EXPECT_GT(changed, 0u);
+    EXPECT_LT(texture.dirty().area(), 256u * 128u / 4);
+}
+
+TEST(FontDirtyRects_Test, PerfomanceCounterUpdate)
+{
+    FontLib lib;
+    Font font(lib, "samples/fonts/arial.ttf", 16);
+    Text label(font, "Label"), counter(font, "");
+    label.setColor(RGBA(255, 255, 255));
+    counter.setColor(RGBA(255, 255, 0));
+    label.setPos(10, 10);
+    counter.setPos(10, 300);
+    label.setWidth(400);
+    counter.setWidth(400);
+
+    const int frames = 200;
+    Texture texture(512, 512);
+    DirtyRects drawn;
+    size_t dirtyBytes = 0, fullBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        // Как FontTexture: очистка только нарисованного, текст, выгрузка измененного
+        texture.clearDirty();
+        for (const auto &rect : drawn.rects())
+            texture.fill(RGBA(), rect);
+        drawn.clear();
+
+        label.setText("Static title");
+        drawn.add(label.render(texture));
+        counter.setText("FPS: " + std::to_string(60 + frame % 7));
+        drawn.add(counter.render(texture));
+
+        dirtyBytes += texture.dirty().area() * sizeof(RGBA);
+        fullBytes += texture.data().size() * sizeof(RGBA);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "frames: " << frames << ", time: " << ms / frames << " ms/frame, dirty upload: " 
+        << dirtyBytes / frames << " bytes/frame, full upload: " << fullBytes / frames << " bytes/frame" << std::endl;
+    EXPECT_LT(dirtyBytes * 20, fullBytes);
+}
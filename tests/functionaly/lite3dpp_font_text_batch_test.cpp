@@ -0,0 +1,301 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp_font/lite3dpp_font_text_batch.h>
+
+using namespace lite3dpp;
+using namespace lite3dpp::lite3dpp_font;
+
+// Глифы без FreeType: битмап заполнен кодом символа, размеры зависят от кода
+class FakeGlyphSource : public GlyphSource
+{
+public:
+
+    explicit FakeGlyphSource(int32_t pageSize = 256, uint32_t maxPages = 2) :
+        pages(pageSize, maxPages)
+    {}
+
+    const GlyphInfo *glyph(char32_t codepoint) override
+    {
+        if (auto found = pages.find(codepoint))
+            return found;
+        if (codepoint == ' ')
+            return pages.add(codepoint, nullptr, 0, 0, 0, 0, 0, 4.0f);
+
+        int32_t width = 5 + codepoint % 3, height = 8 + codepoint % 4;
+        std::vector<uint8_t> bitmap(width * height, static_cast<uint8_t>(codepoint));
+        return pages.add(codepoint, bitmap.data(), width, height, width, 1, height - 2, width + 2.0f);
+    }
+
+    float kerning(char32_t left, char32_t right) override
+    { return left == 'A' && right == 'V' ? -2.0f : 0.0f; }
+    float lineHeight() const override
+    { return 14.0f; }
+    float ascender() const override
+    { return 10.0f; }
+    int32_t pageSize() const override
+    { return pages.getPageSize(); }
+
+    GlyphAtlasPages pages;
+};
+
+class QuadsBuffer : public BufferBase
+{
+public:
+
+    size_t bufferSizeBytes() const override
+    { return mData.size(); }
+    void extendBufferBytes(size_t addsize) override
+    { mData.resize(mData.size() + addsize); }
+    void setBufferSizeBytes(size_t size) override
+    { mData.resize(size); }
+    void setData(const void *buffer, size_t offset, size_t size) override
+    {
+        ASSERT_LE(offset + size, mData.size());
+        memcpy(mData.data() + offset, buffer, size);
+    }
+    void replaceData(const void *buffer, size_t size) override
+    { setData(buffer, 0, size); }
+    void getData(void *buffer, size_t offset, size_t size) const override
+    { memcpy(buffer, mData.data() + offset, size); }
+    BufferScopedMapper map(BufferScopedMapper::BufferScopedMapperLockType) override
+    { LITE3D_THROW("map is not supported"); }
+    bool valid() const override
+    { return true; }
+
+    std::vector<uint8_t> mData;
+};
+
+static bool overlaps(const AtlasRect &a, const AtlasRect &b, int32_t padding)
+{
+    return a.x < b.x + b.width + padding && b.x < a.x + a.width + padding &&
+        a.y < b.y + b.height + padding && b.y < a.y + a.height + padding;
+}
+
+TEST(GlyphAtlas_Test, ShelfPacking)
+{
+    ShelfPacker packer(128, 128, 1);
+    std::mt19937 rnd(5);
+    std::vector<AtlasRect> placed;
+
+    for (;;)
+    {
+        AtlasRect rect;
+        int32_t width = 4 + rnd() % 12, height = 10 + rnd() % 6;
+        if (!packer.insert(width, height, rect))
+            break;
+
+        ASSERT_EQ(rect.width, width);
+        ASSERT_EQ(rect.height, height);
+        ASSERT_GE(rect.x, 0);
+        ASSERT_GE(rect.y, 0);
+        ASSERT_LE(rect.x + rect.width, 128);
+        ASSERT_LE(rect.y + rect.height, 128);
+        for (const auto &other : placed)
+            ASSERT_FALSE(overlaps(rect, other, 1));
+        placed.push_back(rect);
+    }
+
+    // Глифы одной высоты занимают большую часть страницы
+    EXPECT_GT(placed.size(), 60u);
+    EXPECT_GT(packer.usedArea(), 128u * 128u / 2);
+
+    packer.clear();
+    AtlasRect rect;
+    EXPECT_TRUE(packer.insert(10, 10, rect));
+    EXPECT_EQ(rect.x, 0);
+    EXPECT_EQ(rect.y, 0);
+    EXPECT_FALSE(packer.insert(200, 10, rect));
+}
+
+TEST(GlyphAtlas_Test, PagesAndDirtyRects)
+{
+    GlyphAtlasPages pages(64, 2);
+    std::vector<uint8_t> bitmap(7 * 9, 0xAB);
+
+    const GlyphInfo *glyph = pages.add(1, bitmap.data(), 7, 9, 7, 0, 9, 8.0f);
+    ASSERT_NE(glyph, nullptr);
+    EXPECT_EQ(pages.add(1, bitmap.data(), 7, 9, 7, 0, 9, 8.0f), glyph);
+    EXPECT_EQ(pages.pagesCount(), 1u);
+    EXPECT_EQ(pages.pageData(0)[glyph->rect.y * 64 + glyph->rect.x], 0xAB);
+
+    // Грязная область выровнена по 4 пикселя по x и покрывает глиф
+    const AtlasRect &dirty = pages.dirtyRect(0);
+    EXPECT_EQ(dirty.x % 4, 0);
+    EXPECT_EQ(dirty.width % 4, 0);
+    EXPECT_LE(dirty.x, glyph->rect.x);
+    EXPECT_GE(dirty.x + dirty.width, glyph->rect.x + glyph->rect.width);
+    EXPECT_EQ(dirty.height, 9);
+
+    // Отрицательный pitch: первая строка в памяти нижняя
+    std::vector<uint8_t> bottomUp(7 * 9);
+    for (int row = 0; row < 9; ++row)
+        memset(&bottomUp[row * 7], row, 7);
+    const GlyphInfo *second = pages.add(2, bottomUp.data(), 7, 9, -7, 0, 9, 8.0f);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(pages.pageData(0)[second->rect.y * 64 + second->rect.x], 8);
+    EXPECT_EQ(pages.pageData(0)[(second->rect.y + 8) * 64 + second->rect.x], 0);
+
+    stl<uint8_t>::vector copy;
+    pages.copyRect(0, pages.dirtyRect(0), copy);
+    EXPECT_EQ(copy.size(), static_cast<size_t>(pages.dirtyRect(0).width * pages.dirtyRect(0).height));
+
+    pages.clearDirty();
+    EXPECT_FALSE(pages.hasDirty());
+    EXPECT_EQ(pages.find(2), second);
+    EXPECT_EQ(pages.find(3), nullptr);
+
+    // Переполнение: вторая страница, потом отказ
+    uint32_t key = 10;
+    while (pages.add(key, bitmap.data(), 7, 9, 7, 0, 9, 8.0f))
+        key++;
+    EXPECT_EQ(pages.pagesCount(), 2u);
+    EXPECT_TRUE(pages.hasDirty());
+    EXPECT_EQ(pages.find(key), nullptr);
+    EXPECT_EQ(pages.add(1000, bitmap.data(), 100, 9, 100, 0, 9, 8.0f), nullptr);
+}
+
+TEST(GlyphAtlas_Test, Layout)
+{
+    FakeGlyphSource source;
+    std::vector<GlyphQuad> quads(32);
+    kmVec2 pos = { 10.0f, 20.0f };
+
+    size_t count = TextLayout::layout(source, "AB C", pos, 0xffffffffu, 0.0f, quads.data(), quads.size());
+    ASSERT_EQ(count, 3u);
+    const GlyphInfo *a = source.glyph('A'), *b = source.glyph('B'), *c = source.glyph('C');
+    EXPECT_FLOAT_EQ(quads[0].rect.x, 10.0f + a->bearingX);
+    EXPECT_FLOAT_EQ(quads[0].rect.y, 20.0f + 10.0f - a->bearingY);
+    EXPECT_FLOAT_EQ(quads[0].rect.z, static_cast<float>(a->rect.width));
+    EXPECT_FLOAT_EQ(quads[1].rect.x, 10.0f + a->advance + b->bearingX);
+    EXPECT_FLOAT_EQ(quads[2].rect.x, 10.0f + a->advance + b->advance + 4.0f + c->bearingX);
+    EXPECT_FLOAT_EQ(quads[0].uv.x, a->rect.x / 256.0f);
+    EXPECT_FLOAT_EQ(quads[0].uv.w, (a->rect.y + a->rect.height) / 256.0f);
+    EXPECT_EQ(quads[2].color, 0xffffffffu);
+
+    // Кернинг
+    count = TextLayout::layout(source, "AV", pos, 0, 0.0f, quads.data(), quads.size());
+    ASSERT_EQ(count, 2u);
+    EXPECT_FLOAT_EQ(quads[1].rect.x, 10.0f + a->advance - 2.0f + source.glyph('V')->bearingX);
+
+    // Перевод строки и перенос по ширине
+    count = TextLayout::layout(source, "A\nA", pos, 0, 0.0f, quads.data(), quads.size());
+    ASSERT_EQ(count, 2u);
+    EXPECT_FLOAT_EQ(quads[1].rect.x, quads[0].rect.x);
+    EXPECT_FLOAT_EQ(quads[1].rect.y, quads[0].rect.y + 14.0f);
+
+    count = TextLayout::layout(source, "AAAA", pos, 0, a->advance * 2.5f, quads.data(), quads.size());
+    ASSERT_EQ(count, 4u);
+    EXPECT_FLOAT_EQ(quads[2].rect.x, quads[0].rect.x);
+    EXPECT_FLOAT_EQ(quads[2].rect.y, quads[0].rect.y + 14.0f);
+
+    // utf-8, ограничение числа квадов и битая строка
+    count = TextLayout::layout(source, "\xd0\xaf\xd0\xb1", pos, 0, 0.0f, quads.data(), quads.size());
+    ASSERT_EQ(count, 2u);
+    EXPECT_NE(source.pages.find(0x42f), nullptr);
+    EXPECT_EQ(TextLayout::layout(source, "ABCDEF", pos, 0, 0.0f, quads.data(), 3), 3u);
+    EXPECT_EQ(TextLayout::layout(source, "AB\xff" "CD", pos, 0, 0.0f, quads.data(), quads.size()), 2u);
+
+    kmVec4 color = { 1.0f, 0.0f, 0.5f, 1.0f };
+    EXPECT_EQ(TextLayout::packColor(color), 0xff8000ffu);
+}
+
+TEST(GlyphAtlas_Test, TextBatchChanges)
+{
+    FakeGlyphSource source;
+    TextBatch batch(source);
+    QuadsBuffer buffer;
+    kmVec4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+    kmVec2 pos = { 0.0f, 0.0f };
+
+    auto fps = batch.addLabel(16);
+    auto title = batch.addLabel(8);
+    EXPECT_EQ(batch.quadsCount(), 24u);
+
+    batch.setLabel(fps, "FPS: 60", pos, white);
+    batch.setLabel(title, "Title", pos, white);
+    EXPECT_EQ(batch.upload(buffer), 24u * sizeof(GlyphQuad));
+    EXPECT_EQ(memcmp(buffer.mData.data(), batch.getQuads().data(), buffer.mData.size()), 0);
+
+    // Тот же текст ничего не выгружает
+    batch.setLabel(fps, "FPS: 60", pos, white);
+    EXPECT_EQ(batch.getStats().labelsUnchanged, 1u);
+    EXPECT_EQ(batch.upload(buffer), 0u);
+
+    // Смена одной цифры меняет один квад
+    batch.setLabel(fps, "FPS: 61", pos, white);
+    EXPECT_FALSE(batch.getDirtyRanges().isDirty(0));
+    EXPECT_TRUE(batch.getDirtyRanges().isDirty(5));
+    EXPECT_EQ(batch.upload(buffer), sizeof(GlyphQuad));
+    EXPECT_EQ(memcmp(buffer.mData.data(), batch.getQuads().data(), buffer.mData.size()), 0);
+
+    // Короткий текст обнуляет хвост, скрытие обнуляет всю надпись
+    batch.setLabel(fps, "FPS", pos, white);
+    EXPECT_EQ(batch.getQuads()[4].rect.z, 0.0f);
+    batch.hideLabel(title);
+    batch.upload(buffer);
+    for (uint32_t i = 16; i < 24; ++i)
+        EXPECT_EQ(batch.getQuads()[i].rect.z, 0.0f);
+    EXPECT_EQ(memcmp(buffer.mData.data(), batch.getQuads().data(), buffer.mData.size()), 0);
+
+    // Новая надпись увеличивает буфер
+    auto extra = batch.addLabel(4);
+    batch.setLabel(extra, "x", pos, white);
+    EXPECT_EQ(batch.upload(buffer), 28u * sizeof(GlyphQuad));
+    EXPECT_EQ(buffer.bufferSizeBytes(), 28u * sizeof(GlyphQuad));
+}
+
+TEST(GlyphAtlas_Test, PerfomanceTextBatch)
+{
+    const uint32_t labelsCount = 10000, frames = 20;
+    FakeGlyphSource source(512, 4);
+    TextBatch batch(source);
+    QuadsBuffer buffer;
+    kmVec4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    for (uint32_t i = 0; i < labelsCount; ++i)
+        batch.addLabel(16);
+
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        for (uint32_t i = 0; i < labelsCount; ++i)
+        {
+            kmVec2 pos = { static_cast<float>(i % 100) * 80.0f, static_cast<float>(i / 100) * 16.0f };
+            batch.setLabel(i, "HP: " + std::to_string(100 + (frame + i) % 50), pos, white);
+        }
+        bytes += batch.upload(buffer);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Старый путь растеризует каждую строку в свою текстуру 128x16 RGBA
+    size_t rasterBytes = static_cast<size_t>(labelsCount) * frames * 128 * 16 * 4;
+    std::cout << "labels: " << labelsCount << ", frames: " << frames << ", time: " << ms / frames 
+        << " ms/frame, quads uploaded: " << bytes / 1024 << " KiB, raster strings: " 
+        << rasterBytes / 1024 << " KiB, glyphs in atlas: " << source.pages.glyphsCount() << std::endl;
+
+    EXPECT_LT(bytes, rasterBytes / 10);
+    EXPECT_EQ(memcmp(buffer.mData.data(), batch.getQuads().data(), buffer.mData.size()), 0);
+}
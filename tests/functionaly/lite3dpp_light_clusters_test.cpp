@@ -0,0 +1,210 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_light_clusters.h>
+
+using namespace lite3dpp;
+
+class LightClusters_Test : public ::testing::Test
+{
+protected:
+
+    LightClusters_Test() :
+        mGrid(16, 9, 24)
+    {
+        mGrid.setupPerspective(0.5f, 500.0f, 60.0f, 16.0f / 9.0f);
+    }
+
+    // Random point and spot lights inside view frustum and around it
+    static std::vector<ClusterLight> randomLights(size_t count, uint32_t seed)
+    {
+        std::mt19937 rnd(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> depth(0.0f, 520.0f);
+        std::uniform_real_distribution<float> range(0.5f, 30.0f);
+        std::uniform_real_distribution<float> angle(0.05f, 1.5f);
+        std::vector<ClusterLight> lights(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            ClusterLight &light = lights[i];
+            float z = depth(rnd);
+            light.position = { unit(rnd) * z, unit(rnd) * z * 0.6f, -z + 10.0f };
+            light.radius = range(rnd);
+            light.coneCos = light.coneSin = 0.0f;
+            light.direction = { 0.0f, 0.0f, -1.0f };
+            light.index = static_cast<int32_t>(i);
+
+            if (i % 2)
+            {
+                kmVec3 dir = { unit(rnd), unit(rnd), unit(rnd) };
+                kmVec3Normalize(&light.direction, &dir);
+                float halfAngle = angle(rnd);
+                light.coneCos = std::cos(halfAngle);
+                light.coneSin = std::sin(halfAngle);
+            }
+        }
+
+        return lights;
+    }
+
+    // Lists of clusters by straight test of every light against every cluster
+    std::vector<std::vector<int32_t>> bruteForce(const std::vector<ClusterLight> &lights)
+    {
+        std::vector<std::vector<int32_t>> result(mGrid.clustersCount());
+        for (uint32_t c = 0; c < mGrid.clustersCount(); ++c)
+        {
+            ClusterBox box = mGrid.getClusterBox(c);
+            for (const auto &light : lights)
+            {
+                if (light.radius > 0.0f && LightClusterGrid::intersects(light, box))
+                    result[c].push_back(light.index);
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<int32_t> clusterLights(uint32_t cluster)
+    {
+        const int32_t *indexes = mGrid.getIndexes();
+        return std::vector<int32_t>(indexes + mGrid.getClusterOffset(cluster),
+            indexes + mGrid.getClusterOffset(cluster) + mGrid.getClusterCount(cluster));
+    }
+
+    LightClusterGrid mGrid;
+};
+
+TEST_F(LightClusters_Test, Layout)
+{
+    EXPECT_EQ(mGrid.clustersCount(), 16u * 9u * 24u);
+
+    // Соседние слои стыкуются, первый начинается у ближней плоскости
+    EXPECT_FLOAT_EQ(mGrid.getClusterBox(mGrid.clusterIndex(0, 0, 0)).max.z, -0.5f);
+    EXPECT_FLOAT_EQ(mGrid.getClusterBox(mGrid.clusterIndex(0, 0, 23)).min.z, -500.0f);
+    for (uint32_t z = 1; z < 24; ++z)
+    {
+        EXPECT_EQ(mGrid.getClusterBox(mGrid.clusterIndex(3, 4, z - 1)).min.z,
+            mGrid.getClusterBox(mGrid.clusterIndex(3, 4, z)).max.z);
+    }
+
+    // Индекс слоя из глубины по параметрам заголовка, как в шейдере
+    float params[4];
+    memcpy(params, &mGrid.getData()[4], sizeof(params));
+    for (uint32_t z = 0; z < 24; ++z)
+    {
+        ClusterBox box = mGrid.getClusterBox(mGrid.clusterIndex(0, 0, z));
+        float depth = -(box.min.z + box.max.z) * 0.5f;
+        EXPECT_EQ(static_cast<uint32_t>(std::log(depth) * params[0] + params[1]), z);
+    }
+}
+
+TEST_F(LightClusters_Test, SameAsBruteForce)
+{
+    auto lights = randomLights(3000, 11);
+    auto expected = bruteForce(lights);
+    std::vector<bool> visible(lights.size(), false);
+    for (const auto &list : expected)
+        for (int32_t index : list)
+            visible[index] = true;
+
+    for (uint32_t threads : { 1u, 4u })
+    {
+        mGrid.build(lights.data(), lights.size(), threads);
+        EXPECT_EQ(mGrid.getGlobalCount(), 0u);
+
+        size_t total = 0;
+        for (uint32_t c = 0; c < mGrid.clustersCount(); ++c)
+        {
+            ASSERT_EQ(clusterLights(c), expected[c]) << "cluster " << c << ", threads " << threads;
+            total += expected[c].size();
+        }
+
+        EXPECT_EQ(mGrid.getIndexesCount(), total);
+        for (size_t i = 0; i < lights.size(); ++i)
+            EXPECT_EQ(mGrid.isLightVisible(i), visible[i]) << "light " << i;
+    }
+}
+
+TEST_F(LightClusters_Test, GlobalLights)
+{
+    auto lights = randomLights(10, 3);
+    lights[2].radius = 0.0f;
+    lights[7].radius = 0.0f;
+
+    mGrid.build(lights.data(), lights.size());
+    ASSERT_EQ(mGrid.getGlobalCount(), 2u);
+    EXPECT_TRUE(mGrid.isLightVisible(2));
+    EXPECT_EQ(mGrid.getIndexes()[0], 2);
+    EXPECT_EQ(mGrid.getIndexes()[1], 7);
+
+    for (uint32_t c = 0; c < mGrid.clustersCount(); ++c)
+    {
+        EXPECT_GE(mGrid.getClusterOffset(c), 2u);
+        for (int32_t index : clusterLights(c))
+        {
+            EXPECT_NE(index, 2);
+            EXPECT_NE(index, 7);
+        }
+    }
+
+    // Пустой список после заполненного
+    mGrid.build(nullptr, 0);
+    EXPECT_EQ(mGrid.getGlobalCount(), 0u);
+    EXPECT_EQ(mGrid.getIndexesCount(), 0u);
+    EXPECT_EQ(mGrid.getClusterCount(0), 0u);
+}
+
+TEST_F(LightClusters_Test, PerfomanceBuild)
+{
+    auto lights = randomLights(10000, 5);
+    std::vector<std::vector<int32_t>> expected;
+
+    auto begin = std::chrono::steady_clock::now();
+    expected = bruteForce(lights);
+    auto bruteTime = std::chrono::steady_clock::now() - begin;
+
+    const int runs = 20;
+    auto measure = [&](uint32_t threads)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; ++run)
+            mGrid.build(lights.data(), lights.size(), threads);
+        return (std::chrono::steady_clock::now() - begin) / runs;
+    };
+
+    auto singleTime = measure(1);
+    auto multiTime = measure(0);
+
+    for (uint32_t c = 0; c < mGrid.clustersCount(); ++c)
+        ASSERT_EQ(clusterLights(c), expected[c]);
+
+    auto ms = [](auto d) {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(d).count(); };
+    std::cout << lights.size() << " lights, " << mGrid.clustersCount() << " clusters, "
+        << mGrid.getIndexesCount() << " indexes: brute force " << ms(bruteTime) << " ms, 1 thread "
+        << ms(singleTime) << " ms, " << std::thread::hardware_concurrency() << " threads "
+        << ms(multiTime) << " ms" << std::endl;
+}
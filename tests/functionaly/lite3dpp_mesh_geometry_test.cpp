@@ -0,0 +1,120 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3d/lite3d_pack.h>
+#include <lite3dpp/lite3dpp_mesh_geometry.h>
+
+using namespace lite3dpp;
+
+class MeshGeometry_Test : public ::testing::Test
+{
+protected:
+
+    void SetUp() override
+    {
+        mPack = lite3d_pack_open("tests/", 0, 1000000);
+        ASSERT_TRUE(mPack != nullptr);
+        mFile = lite3d_pack_file_load(mPack, "meshes/VURmCorner_ubr.m");
+        ASSERT_TRUE(mFile != nullptr);
+    }
+
+    void TearDown() override
+    {
+        if (mPack)
+            lite3d_pack_close(mPack);
+    }
+
+    lite3d_pack *mPack = nullptr;
+    lite3d_file *mFile = nullptr;
+};
+
+TEST_F(MeshGeometry_Test, DecodeWithoutGL)
+{
+    MeshGeometry geometry("VURmCorner_ubr", mFile->fileBuff, mFile->fileSize);
+    ASSERT_GT(geometry.chunksCount(), 0u);
+
+    uint32_t vertices = 0, indexes = 0;
+    for (uint32_t i = 0; i < geometry.chunksCount(); ++i)
+    {
+        const auto &chunk = geometry.getChunk(i);
+        EXPECT_EQ(chunk.verticesOffset, vertices);
+        EXPECT_EQ(chunk.indexesOffset, indexes);
+        EXPECT_EQ(chunk.indexesCount % 3, 0u);
+        vertices += chunk.verticesCount;
+        indexes += chunk.indexesCount;
+
+        // Позиции взяты из нужного атрибута: лежат внутри bounding box чанка
+        kmVec3 bbmin = chunk.boundingVol.box[0], bbmax = chunk.boundingVol.box[0];
+        for (const auto &corner : chunk.boundingVol.box)
+        {
+            bbmin = { std::min(bbmin.x, corner.x), std::min(bbmin.y, corner.y), std::min(bbmin.z, corner.z) };
+            bbmax = { std::max(bbmax.x, corner.x), std::max(bbmax.y, corner.y), std::max(bbmax.z, corner.z) };
+        }
+
+        const float *positions = geometry.chunkPositions(i);
+        for (uint32_t v = 0; v < chunk.verticesCount; ++v, positions += 3)
+        {
+            ASSERT_GE(positions[0], bbmin.x - 0.01f);
+            ASSERT_GE(positions[1], bbmin.y - 0.01f);
+            ASSERT_GE(positions[2], bbmin.z - 0.01f);
+            ASSERT_LE(positions[0], bbmax.x + 0.01f);
+            ASSERT_LE(positions[1], bbmax.y + 0.01f);
+            ASSERT_LE(positions[2], bbmax.z + 0.01f);
+        }
+
+        const uint32_t *chunkIndexes = geometry.chunkIndexes(i);
+        for (uint32_t j = 0; j < chunk.indexesCount; ++j)
+        {
+            ASSERT_LT(chunkIndexes[j], chunk.verticesCount);
+        }
+    }
+
+    EXPECT_EQ(geometry.verticesCount(), vertices);
+    EXPECT_EQ(geometry.indexesCount(), indexes);
+}
+
+TEST_F(MeshGeometry_Test, Malformed)
+{
+    // Обрезанный файл не должен читаться за пределами буфера
+    EXPECT_THROW(MeshGeometry("truncated", mFile->fileBuff, mFile->fileSize / 2), std::runtime_error);
+    EXPECT_THROW(MeshGeometry("header", mFile->fileBuff, 8), std::runtime_error);
+
+    std::vector<uint8_t> broken(static_cast<const uint8_t *>(mFile->fileBuff),
+        static_cast<const uint8_t *>(mFile->fileBuff) + mFile->fileSize);
+    broken[0] ^= 0xff;
+    EXPECT_THROW(MeshGeometry("signature", broken.data(), broken.size()), std::runtime_error);
+}
+
+TEST_F(MeshGeometry_Test, ContentHash)
+{
+    // Ключ кэша коллизионных форм: одинаков для одинаковой геометрии и разный для разной
+    MeshGeometry first("first", mFile->fileBuff, mFile->fileSize);
+    MeshGeometry second("second", mFile->fileBuff, mFile->fileSize);
+    EXPECT_EQ(first.contentHash(), second.contentHash());
+
+    lite3d_pack *samplesPack = lite3d_pack_open("samples/", 0, 1000000);
+    ASSERT_TRUE(samplesPack != nullptr);
+    lite3d_file *cubeFile = lite3d_pack_file_load(samplesPack, "models/meshes/cube.m");
+    ASSERT_TRUE(cubeFile != nullptr);
+    MeshGeometry cube("cube", cubeFile->fileBuff, cubeFile->fileSize);
+    EXPECT_NE(first.contentHash(), cube.contentHash());
+    lite3d_pack_close(samplesPack);
+}
@@ -0,0 +1,283 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifdef INCLUDE_BULLET
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp_physics/lite3dpp_physics_bullet.h>
+#include <lite3dpp_physics/lite3dpp_physics_simulation.h>
+#include <lite3dpp_physics/lite3dpp_physics_motion_state.h>
+
+using namespace lite3dpp;
+using namespace lite3dpp::lite3dpp_phisics;
+
+// Куча шаров над плоскостью, без сцены и motion states
+class PhysicsSimulationWorld
+{
+public:
+
+    PhysicsSimulationWorld(const PhysicsSimulation::Config &config, int bodiesCount) :
+        mSimulation(config),
+        mSphere(0.5f),
+        mGround(btVector3(0, 0, 1), 0)
+    {
+        auto world = mSimulation.getWorld();
+        world->setGravity(btVector3(0, 0, -9.8f));
+
+        btRigidBody::btRigidBodyConstructionInfo groundInfo(0.0f, nullptr, &mGround);
+        mBodies.emplace_back(std::make_unique<btRigidBody>(groundInfo));
+        world->addRigidBody(mBodies.back().get());
+
+        btVector3 inertia(0, 0, 0);
+        mSphere.calculateLocalInertia(1.0f, inertia);
+        const int side = 32;
+        for (int i = 0; i < bodiesCount; ++i)
+        {
+            btTransform transform;
+            transform.setIdentity();
+            // Слоями с небольшим сдвигом, чтобы шары падали друг на друга не ровными столбами
+            transform.setOrigin(btVector3((i % side) * 1.1f + (i / (side * side)) * 0.3f, 
+                ((i / side) % side) * 1.1f, 1.0f + (i / (side * side)) * 1.2f));
+            btRigidBody::btRigidBodyConstructionInfo info(1.0f, nullptr, &mSphere, inertia);
+            info.m_startWorldTransform = transform;
+            mBodies.emplace_back(std::make_unique<btRigidBody>(info));
+            world->addRigidBody(mBodies.back().get());
+        }
+    }
+
+    ~PhysicsSimulationWorld()
+    {
+        auto world = mSimulation.getWorld();
+        for (auto &body : mBodies)
+            world->removeRigidBody(body.get());
+    }
+
+    std::vector<btScalar> positions()
+    {
+        mSimulation.wait();
+        std::vector<btScalar> result;
+        for (size_t i = 1; i < mBodies.size(); ++i)
+        {
+            const btVector3 &origin = mBodies[i]->getWorldTransform().getOrigin();
+            result.insert(result.end(), { origin.x(), origin.y(), origin.z() });
+        }
+
+        return result;
+    }
+
+    PhysicsSimulation mSimulation;
+    btSphereShape mSphere;
+    btStaticPlaneShape mGround;
+    std::vector<std::unique_ptr<btRigidBody>> mBodies;
+};
+
+static PhysicsSimulation::Config fixedConfig()
+{
+    PhysicsSimulation::Config config;
+    config.fixedTimeStep = 1.0f / 64.0f;
+    config.maxSubSteps = 1;
+    return config;
+}
+
+TEST(PhysicsSimulation_Test, Deterministic)
+{
+    PhysicsSimulationWorld first(fixedConfig(), 2000), second(fixedConfig(), 2000);
+    for (int i = 0; i < 120; ++i)
+    {
+        first.mSimulation.step(1.0f / 64.0f);
+        second.mSimulation.step(1.0f / 64.0f);
+    }
+
+    auto a = first.positions(), b = second.positions();
+    ASSERT_EQ(a.size(), b.size());
+    EXPECT_EQ(std::memcmp(a.data(), b.data(), a.size() * sizeof(btScalar)), 0);
+}
+
+TEST(PhysicsSimulation_Test, AsyncAccumulator)
+{
+    auto config = fixedConfig();
+    config.maxSubSteps = 4;
+    config.asyncStep = true;
+    PhysicsSimulationWorld world(config, 16);
+    auto &simulation = world.mSimulation;
+    ASSERT_TRUE(simulation.isAsync());
+
+    // Половина шага: шага нет, позиция между шагами 0.5
+    simulation.step(1.0f / 128.0f);
+    simulation.wait();
+    EXPECT_EQ(simulation.getStepIndex(), 0u);
+    EXPECT_FLOAT_EQ(simulation.getInterpolationFactor(), 0.5f);
+
+    simulation.step(1.0f / 128.0f);
+    simulation.wait();
+    EXPECT_EQ(simulation.getStepIndex(), 1u);
+    EXPECT_FLOAT_EQ(simulation.getInterpolationFactor(), 0.0f);
+
+    simulation.step(3.0f / 128.0f);
+    simulation.wait();
+    EXPECT_EQ(simulation.getStepIndex(), 2u);
+    EXPECT_FLOAT_EQ(simulation.getInterpolationFactor(), 0.5f);
+
+    // Долгий кадр упирается в maxSubSteps, отставание не копится
+    simulation.step(1.0f);
+    simulation.wait();
+    EXPECT_EQ(simulation.getStepIndex(), 6u);
+    EXPECT_LT(simulation.getInterpolationFactor(), 1.0f);
+
+    auto start = world.positions();
+    for (int i = 0; i < 64; ++i)
+        simulation.step(1.0f / 64.0f);
+    auto end = world.positions();
+    // Шары падали
+    EXPECT_LT(end[2], start[2]);
+}
+
+TEST(PhysicsSimulation_Test, PerfomanceStress)
+{
+    const int bodiesCount = 10000;
+    const int steps = 60;
+    float msPerStep[2];
+    for (int mt = 0; mt < 2; ++mt)
+    {
+        auto config = fixedConfig();
+        config.multithreaded = mt == 1;
+        PhysicsSimulationWorld world(config, bodiesCount);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < steps; ++i)
+            world.mSimulation.step(1.0f / 64.0f);
+        msPerStep[mt] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / steps;
+
+        // Никто не провалился сквозь пол
+        auto positions = world.positions();
+        for (size_t i = 2; i < positions.size(); i += 3)
+            ASSERT_GT(positions[i], 0.0f);
+
+        if (mt == 1 && !world.mSimulation.isMultithreaded())
+            msPerStep[1] = -1.0f;
+    }
+
+    std::cout << bodiesCount << " bodies: single thread " << msPerStep[0] << " ms per step, multithreaded "
+        << msPerStep[1] << " ms per step" << std::endl;
+}
+
+// Один наблюдатель на корнях всех тел, как менеджер теней
+class MovedObserver : public SceneNodeObserver
+{
+public:
+
+    void updatePosition(SceneNodeBase *node) override
+    { positions++; }
+    void updateRotation(SceneNodeBase *node) override
+    { rotations++; }
+    void updateTransforms(SceneNodeBase *const *nodes, size_t count) override
+    {
+        batches++;
+        nodesMoved += count;
+    }
+
+    size_t positions = 0;
+    size_t rotations = 0;
+    size_t batches = 0;
+    size_t nodesMoved = 0;
+};
+
+// Передача трансформаций bullet в сцену через motion states: 
+// по телу (setPosition и setRotation) и пакетом PhysicsSimulation (batchTransforms)
+TEST(PhysicsSimulation_Test, PerfomanceBatchApply)
+{
+    const size_t bodies = 10000;
+    const int steps = 100;
+
+    Main main;
+    Scene scene("BatchScene", "", main);
+    ASSERT_TRUE(lite3d_scene_init(scene.getPtr(), 0));
+    std::string json = "{\"Root\":{\"Name\":\"Root\"}}";
+    SceneObjectTemplate objectTemplate(main, json.c_str(), json.size());
+
+    MovedObserver observer;
+    std::vector<std::unique_ptr<SceneObject>> objects;
+    std::vector<btTransform> transforms(bodies);
+    for (size_t i = 0; i < bodies; ++i)
+    {
+        objects.emplace_back(std::make_unique<SceneObject>("Body" + std::to_string(i), &scene, &main, nullptr, 
+            KM_VEC3_ZERO, KM_QUATERNION_IDENTITY, KM_VEC3_ONE));
+        objects.back()->loadFromTemplate(objectTemplate);
+        objects.back()->getRoot()->addObserver(&observer);
+        transforms[i].setRotation(btQuaternion(btVector3(0, 0, 1), 0.001f * (i % 1000)));
+    }
+
+    auto run = [&](bool batch)
+    {
+        auto config = fixedConfig();
+        config.batchTransforms = batch;
+        PhysicsSimulation simulation(config);
+        std::vector<std::unique_ptr<btMotionState>> states;
+        for (auto &object : objects)
+            states.emplace_back(std::make_unique<PhysicsObjectMotionState>(object.get(), &simulation));
+
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; ++step)
+        {
+            // Так bullet отдает активные тела в конце шага
+            for (size_t i = 0; i < bodies; ++i)
+            {
+                transforms[i].setOrigin(btVector3(static_cast<btScalar>(i), static_cast<btScalar>(step), 1));
+                states[i]->setWorldTransform(transforms[i]);
+            }
+            // Мир пустой, шаг нулевой: остается только применение пакета
+            simulation.step(0.0f);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double perBodyMs = run(false);
+    EXPECT_EQ(observer.positions, bodies * steps);
+    EXPECT_EQ(observer.rotations, bodies * steps);
+    EXPECT_EQ(observer.batches, 0u);
+
+    std::vector<kmVec3> expected;
+    for (auto &object : objects)
+    {
+        expected.push_back(object->getPosition());
+        object->setTransform(KM_VEC3_ZERO, KM_QUATERNION_IDENTITY);
+    }
+
+    observer = MovedObserver();
+    double batchMs = run(true);
+    EXPECT_EQ(observer.positions, 0u);
+    EXPECT_EQ(observer.rotations, 0u);
+    EXPECT_EQ(observer.batches, static_cast<size_t>(steps));
+    EXPECT_EQ(observer.nodesMoved, bodies * steps);
+    for (size_t i = 0; i < bodies; ++i)
+        ASSERT_TRUE(kmVec3AreEqual(&objects[i]->getPosition(), &expected[i]));
+
+    for (auto &object : objects)
+        object->getRoot()->removeObserver(&observer);
+
+    std::cout << bodies << " bodies, " << steps << " steps: per body " << perBodyMs << " ms, batch " 
+        << batchMs << " ms, notifications " << bodies * steps * 2 << " vs " << observer.batches << std::endl;
+}
+
+#endif
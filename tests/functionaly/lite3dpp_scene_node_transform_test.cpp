@@ -0,0 +1,158 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_scene_node_base.h>
+
+using namespace lite3dpp;
+
+class CountingObserver : public SceneNodeObserver
+{
+public:
+
+    void updatePosition(SceneNodeBase *node) override
+    { positions++; }
+    void updateRotation(SceneNodeBase *node) override
+    { rotations++; }
+
+    int positions = 0;
+    int rotations = 0;
+};
+
+class TransformObserver : public CountingObserver
+{
+public:
+
+    void updateTransform(SceneNodeBase *node) override
+    { transforms++; }
+
+    int transforms = 0;
+};
+
+// Узлы без сцены, как корни обьектов с физикой
+class SceneNodeTransform_Test : public ::testing::Test
+{
+protected:
+
+    void createNodes(size_t count)
+    {
+        mNodes.resize(count);
+        mObservers.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            lite3d_scene_node_init(&mNodes[i]);
+            mWrappers.emplace_back(std::make_unique<SceneNodeBase>(&mNodes[i]));
+            mWrappers.back()->addObserver(&mObservers[i]);
+        }
+    }
+
+    std::vector<lite3d_scene_node> mNodes;
+    std::vector<std::unique_ptr<SceneNodeBase>> mWrappers;
+    std::vector<TransformObserver> mObservers;
+};
+
+TEST_F(SceneNodeTransform_Test, SetTransform)
+{
+    createNodes(1);
+    kmVec3 position = { 1.0f, 2.0f, 3.0f };
+    kmQuaternion rotation;
+    kmQuaternionRotationPitchYawRoll(&rotation, 0.1f, 0.2f, 0.3f);
+
+    mNodes[0].recalc = LITE3D_FALSE;
+    mWrappers[0]->setTransform(position, rotation);
+    EXPECT_TRUE(kmVec3AreEqual(&mWrappers[0]->getPosition(), &position));
+    EXPECT_TRUE(kmQuaternionAreEqual(&mWrappers[0]->getRotation(), &rotation));
+    EXPECT_EQ(mNodes[0].recalc, LITE3D_TRUE);
+    // Одно уведомление вместо двух
+    EXPECT_EQ(mObservers[0].transforms, 1);
+    EXPECT_EQ(mObservers[0].positions, 0);
+    EXPECT_EQ(mObservers[0].rotations, 0);
+
+    // Наблюдатель без updateTransform получает старые уведомления
+    CountingObserver legacy;
+    mWrappers[0]->addObserver(&legacy);
+    mWrappers[0]->setTransform(position, rotation);
+    EXPECT_EQ(legacy.positions, 1);
+    EXPECT_EQ(legacy.rotations, 1);
+    mWrappers[0]->removeObserver(&legacy);
+}
+
+// Общий наблюдатель многих узлов, как менеджер теней
+class BatchObserver : public SceneNodeObserver
+{
+public:
+
+    void updateTransforms(SceneNodeBase *const *nodes, size_t count) override
+    {
+        batches++;
+        received.assign(nodes, nodes + count);
+    }
+
+    int batches = 0;
+    std::vector<SceneNodeBase *> received;
+};
+
+TEST_F(SceneNodeTransform_Test, TransformBatch)
+{
+    createNodes(3);
+    BatchObserver shared;
+    mWrappers[0]->addObserver(&shared);
+    mWrappers[2]->addObserver(&shared);
+    CountingObserver legacy;
+    mWrappers[1]->addObserver(&legacy);
+
+    SceneNodeTransformBatch batch;
+    kmQuaternion rotation;
+    kmQuaternionRotationPitchYawRoll(&rotation, 0.1f, 0.2f, 0.3f);
+    for (size_t i = 0; i < mNodes.size(); ++i)
+    {
+        mNodes[i].recalc = LITE3D_FALSE;
+        batch.add(mWrappers[i].get(), { static_cast<float>(i), 1.0f, 2.0f }, rotation);
+    }
+
+    EXPECT_EQ(batch.size(), 3u);
+    batch.apply();
+    EXPECT_TRUE(batch.empty());
+
+    for (size_t i = 0; i < mNodes.size(); ++i)
+    {
+        kmVec3 position = { static_cast<float>(i), 1.0f, 2.0f };
+        EXPECT_TRUE(kmVec3AreEqual(&mNodes[i].position, &position));
+        EXPECT_TRUE(kmQuaternionAreEqual(&mNodes[i].rotation, &rotation));
+        EXPECT_EQ(mNodes[i].recalc, LITE3D_TRUE);
+        // Наблюдатель без updateTransforms получает updateTransform на каждый свой узел
+        EXPECT_EQ(mObservers[i].transforms, 1);
+    }
+
+    // Один вызов на пакет со всеми узлами наблюдателя в порядке добавления
+    EXPECT_EQ(shared.batches, 1);
+    ASSERT_EQ(shared.received.size(), 2u);
+    EXPECT_EQ(shared.received[0], mWrappers[0].get());
+    EXPECT_EQ(shared.received[1], mWrappers[2].get());
+    EXPECT_EQ(legacy.positions, 1);
+    EXPECT_EQ(legacy.rotations, 1);
+
+    // Пустой пакет никого не уведомляет
+    batch.apply();
+    EXPECT_EQ(shared.batches, 1);
+
+    mWrappers[0]->removeObserver(&shared);
+    mWrappers[2]->removeObserver(&shared);
+    mWrappers[1]->removeObserver(&legacy);
+}
@@ -0,0 +1,197 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_main.h>
+#include <lite3dpp/lite3dpp_scene.h>
+#include <lite3dpp/lite3dpp_scene_mesh_node.h>
+
+using namespace lite3dpp;
+
+// Шаблон без ресурсов: дерево узлов с разными трансформациями, 
+// каждый третий внук - меш-узел без меша (Instances и LodBias)
+static std::string makeTemplateJson(int children, int grandchildren)
+{
+    auto node = [](const std::string &name, int index, const std::string &nodes)
+    {
+        std::string json = "{\"Name\":\"" + name + "\",\"Position\":[" + std::to_string(index) + ".5,1.0,-" + 
+            std::to_string(index * 2) + ".0],\"Rotation\":[0.0,0.38268343,0.0,0.92387953],\"Scale\":[1.0," + 
+            std::to_string(1 + index % 3) + ".0,1.0]";
+        if (index % 4 == 1)
+            json += ",\"FrustumTest\":false";
+        if (name.find('.') != std::string::npos && index % 3 == 2)
+            json += ",\"Mesh\":{},\"Instances\":" + std::to_string(index + 2) + ",\"LodBias\":0.5";
+        if (!nodes.empty())
+            json += ",\"Nodes\":[" + nodes + "]";
+        return json + "}";
+    };
+
+    std::string nodes;
+    for (int i = 0; i < children; ++i)
+    {
+        std::string subnodes;
+        for (int j = 0; j < grandchildren; ++j)
+            subnodes += (j ? "," : "") + node("Child" + std::to_string(i) + "." + std::to_string(j), i + j, "");
+        nodes += (i ? "," : "") + node("Child" + std::to_string(i), i, subnodes);
+    }
+
+    return "{\"Root\":" + node("Root", 0, nodes) + "}";
+}
+
+class SceneObjectTemplate_Test : public ::testing::Test
+{
+protected:
+
+    void SetUp() override
+    {
+        ASSERT_TRUE(lite3d_scene_init(mScene.getPtr(), 0));
+    }
+
+    SceneObject::Ptr createObject(const String &name)
+    {
+        return std::make_shared<SceneObject>(name, &mScene, &mMain, nullptr, KM_VEC3_ZERO, 
+            KM_QUATERNION_IDENTITY, KM_VEC3_ONE);
+    }
+
+    static String parentName(SceneNode *node)
+    {
+        auto parent = node->getParent();
+        return parent ? parent->getName() : String();
+    }
+
+    Main mMain;
+    Scene mScene { "TemplateScene", "", mMain };
+};
+
+TEST_F(SceneObjectTemplate_Test, SameAsJson)
+{
+    std::string json = makeTemplateJson(4, 3);
+    SceneObjectTemplate objectTemplate(mMain, json.c_str(), json.size());
+
+    // Плоский массив: корень первым, родитель раньше детей
+    const auto &prototypes = objectTemplate.getNodes();
+    ASSERT_EQ(prototypes.size(), 1u + 4u + 4u * 3u);
+    EXPECT_EQ(prototypes[0].name, "Root");
+    EXPECT_EQ(prototypes[0].parent, -1);
+    EXPECT_EQ(prototypes[1].name, "Child0");
+    EXPECT_EQ(prototypes[2].name, "Child0.0");
+    EXPECT_EQ(prototypes[2].parent, 1);
+    for (size_t i = 1; i < prototypes.size(); ++i)
+        EXPECT_LT(prototypes[i].parent, static_cast<int32_t>(i));
+
+    auto fromJson = createObject("FromJson");
+    fromJson->loadFromTemplate(ConfigurationReader(json.c_str(), json.size()));
+    auto fromTemplate = createObject("FromTemplate");
+    fromTemplate->loadFromTemplate(objectTemplate);
+
+    ASSERT_EQ(fromJson->getNodes().size(), fromTemplate->getNodes().size());
+    EXPECT_EQ(fromTemplate->getRoot()->getName(), "Root");
+    for (const auto &entry : fromJson->getNodes())
+    {
+        SceneNode *expected = entry.second.get();
+        SceneNode *actual = fromTemplate->getNode(entry.first);
+        ASSERT_NE(actual, nullptr) << entry.first;
+
+        EXPECT_EQ(parentName(actual), parentName(expected));
+        EXPECT_TRUE(kmVec3AreEqual(&actual->getPosition(), &expected->getPosition()));
+        EXPECT_TRUE(kmQuaternionAreEqual(&actual->getRotation(), &expected->getRotation()));
+        EXPECT_TRUE(kmVec3AreEqual(&actual->getScale(), &expected->getScale()));
+        EXPECT_EQ(actual->frustumTest(), expected->frustumTest());
+    }
+
+    ASSERT_FALSE(fromJson->getMeshNodes().empty());
+    ASSERT_EQ(fromJson->getMeshNodes().size(), fromTemplate->getMeshNodes().size());
+    for (const auto &entry : fromJson->getMeshNodes())
+    {
+        MeshSceneNode *expected = entry.second.get();
+        MeshSceneNode *actual = fromTemplate->getMeshNode(entry.first);
+        ASSERT_NE(actual, nullptr) << entry.first;
+
+        EXPECT_GT(expected->getInstances(), 1u);
+        EXPECT_EQ(actual->getInstances(), expected->getInstances());
+        EXPECT_FLOAT_EQ(expected->getLodBias(), 0.5f);
+        EXPECT_FLOAT_EQ(actual->getLodBias(), expected->getLodBias());
+    }
+
+    // Публичный конструктор меш-узла из json должен давать то же, что и прототип
+    std::string meshJson = "{\"Name\":\"Mesh\",\"Mesh\":{},\"Instances\":7,\"LodBias\":0.25}";
+    MeshSceneNode meshNode(ConfigurationReader(meshJson.c_str(), meshJson.size()), nullptr, &mScene);
+    EXPECT_EQ(meshNode.getInstances(), 7u);
+    EXPECT_FLOAT_EQ(meshNode.getLodBias(), 0.25f);
+
+    // Экземпляры независимы
+    auto second = createObject("Second");
+    second->loadFromTemplate(objectTemplate);
+    kmVec3 moved = { 10.0f, 0.0f, 0.0f };
+    second->getNode("Child1")->setPosition(moved);
+    EXPECT_FALSE(kmVec3AreEqual(&fromTemplate->getNode("Child1")->getPosition(), &moved));
+}
+
+TEST_F(SceneObjectTemplate_Test, DuplicateNodeName)
+{
+    std::string json = "{\"Root\":{\"Name\":\"Root\",\"Nodes\":[{\"Name\":\"A\"},{\"Name\":\"A\"}]}}";
+    SceneObjectTemplate objectTemplate(mMain, json.c_str(), json.size());
+    auto object = createObject("Duplicate");
+    EXPECT_ANY_THROW(object->loadFromTemplate(objectTemplate));
+
+    std::string empty = "{}";
+    SceneObjectTemplate emptyTemplate(mMain, empty.c_str(), empty.size());
+    EXPECT_TRUE(emptyTemplate.getNodes().empty());
+}
+
+TEST_F(SceneObjectTemplate_Test, PerfomanceSpawn)
+{
+    const int objects = 1000;
+    std::string json = makeTemplateJson(6, 3);
+
+    auto measure = [this, objects](const auto &load)
+    {
+        std::vector<SceneObject::Ptr> spawned;
+        spawned.reserve(objects);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < objects; ++i)
+        {
+            spawned.emplace_back(createObject("Prop" + std::to_string(i)));
+            load(*spawned.back());
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Как loadFromTemplateFromFile: разбор json на каждый экземпляр
+    double jsonMs = measure([&json](SceneObject &object)
+    {
+        object.loadFromTemplate(ConfigurationReader(json.c_str(), json.size()));
+    });
+
+    // Как Scene::addObject: шаблон разбирается при первом создании и дальше берется из кэша
+    std::unique_ptr<SceneObjectTemplate> objectTemplate;
+    double templateMs = measure([this, &json, &objectTemplate](SceneObject &object)
+    {
+        if (!objectTemplate)
+            objectTemplate = std::make_unique<SceneObjectTemplate>(mMain, json.c_str(), json.size());
+        object.loadFromTemplate(*objectTemplate);
+    });
+
+    std::cout << "objects: " << objects << ", nodes per object: 25, json: " << jsonMs << " ms, template: " 
+        << templateMs << " ms" << std::endl;
+}
@@ -0,0 +1,173 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_shadow_scheduler.h>
+
+using namespace lite3dpp;
+using LightState = ShadowUpdateScheduler::LightState;
+
+static std::vector<LightState> randomStates(std::mt19937 &rnd, size_t count, float pendingChance)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<LightState> lights(count);
+    for (auto &light : lights)
+    {
+        light.pending = unit(rnd) < pendingChance;
+        light.moving = unit(rnd) < 0.3f;
+        light.coverage = unit(rnd) * unit(rnd);
+        light.distance = unit(rnd) * 300.0f;
+    }
+
+    return lights;
+}
+
+TEST(ShadowScheduler_Test, TopPriorityWithinLimit)
+{
+    ShadowUpdateScheduler::Config config;
+    config.maxUpdatesPerFrame = 2;
+    ShadowUpdateScheduler scheduler(config);
+
+    std::vector<LightState> lights(5);
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        lights[i].pending = true;
+        lights[i].distance = 100.0f;
+        lights[i].coverage = 0.1f * i;
+    }
+    lights[4].pending = false;
+
+    // Самые большие на экране из ожидающих
+    auto scheduled = scheduler.schedule(lights.data(), lights.size());
+    EXPECT_EQ(scheduled.count(), 2u);
+    EXPECT_TRUE(scheduled.test(3));
+    EXPECT_TRUE(scheduled.test(2));
+    EXPECT_EQ(scheduler.getLightStats(0).staleFrames, 1u);
+    EXPECT_EQ(scheduler.getLightStats(4).staleFrames, 0u);
+
+    // Обновленные больше не ждут, ждавшие кадр поднимаются в очереди
+    lights[2].pending = lights[3].pending = false;
+    scheduled = scheduler.schedule(lights.data(), lights.size());
+    EXPECT_TRUE(scheduled.test(0));
+    EXPECT_TRUE(scheduled.test(1));
+    EXPECT_EQ(scheduler.getLightStats(0).updates, 1u);
+    EXPECT_EQ(scheduler.getLightStats(0).deferrals, 1u);
+    EXPECT_EQ(scheduler.getLightStats(0).maxStaleFrames, 1u);
+
+    // Движение и близость важнее при равном покрытии
+    lights.assign(3, LightState());
+    for (auto &light : lights)
+    {
+        light.pending = true;
+        light.distance = 200.0f;
+    }
+    lights[1].moving = true;
+    lights[2].distance = 10.0f;
+    config.maxUpdatesPerFrame = 1;
+    scheduler.setConfig(config);
+    EXPECT_TRUE(scheduler.schedule(lights.data(), lights.size()).test(1));
+    lights[1].pending = false;
+    EXPECT_TRUE(scheduler.schedule(lights.data(), lights.size()).test(2));
+}
+
+TEST(ShadowScheduler_Test, Budget)
+{
+    ShadowUpdateScheduler::Config config;
+    config.budgetMs = 1.0f;
+    config.initialLayerCostMs = 0.25f;
+    ShadowUpdateScheduler scheduler(config);
+
+    std::vector<LightState> lights(10);
+    for (auto &light : lights)
+        light.pending = true;
+
+    EXPECT_EQ(scheduler.schedule(lights.data(), lights.size()).count(), 4u);
+
+    // Дорогой кадр уменьшает число обновлений, но одно обновление за кадр есть всегда
+    for (int i = 0; i < 20; ++i)
+        scheduler.reportCost(10.0f, 2);
+    EXPECT_GT(scheduler.getLayerCostMs(), 1.0f);
+    EXPECT_EQ(scheduler.schedule(lights.data(), lights.size()).count(), 1u);
+
+    // Без ожидающих ничего не выбирается
+    for (auto &light : lights)
+        light.pending = false;
+    EXPECT_TRUE(scheduler.schedule(lights.data(), lights.size()).none());
+    EXPECT_EQ(scheduler.getLightStats(9).staleFrames, 0u);
+}
+
+TEST(ShadowScheduler_Test, StarvationFree)
+{
+    const uint32_t lightsCount = 24;
+    for (uint32_t limit : { 1u, 2u, 5u })
+    {
+        ShadowUpdateScheduler::Config config;
+        config.maxUpdatesPerFrame = limit;
+        config.budgetMs = 0.5f;
+        config.maxStaleFrames = 6;
+        ShadowUpdateScheduler scheduler(config);
+        std::mt19937 rnd(limit);
+
+        // Худший случай: все тени ждут всегда, у первых огромный приоритет
+        const uint32_t bound = config.maxStaleFrames + (lightsCount + limit - 1) / limit;
+        std::vector<uint32_t> waiting(lightsCount, 0);
+        for (int frame = 0; frame < 2000; ++frame)
+        {
+            auto lights = randomStates(rnd, lightsCount, 1.0f);
+            lights[0].coverage = lights[1].coverage = 1.0f;
+            lights[0].moving = lights[1].moving = true;
+            lights[0].distance = lights[1].distance = 0.0f;
+
+            auto scheduled = scheduler.schedule(lights.data(), lightsCount);
+            ASSERT_GE(scheduled.count(), 1u);
+            ASSERT_LE(scheduled.count(), limit);
+            for (uint32_t i = 0; i < lightsCount; ++i)
+            {
+                waiting[i] = scheduled.test(i) ? 0 : waiting[i] + 1;
+                ASSERT_LT(waiting[i], bound) << "light " << i << ", limit " << limit << ", frame " << frame;
+                ASSERT_EQ(scheduler.getLightStats(i).staleFrames, waiting[i]);
+            }
+        }
+
+        for (uint32_t i = 0; i < lightsCount; ++i)
+        {
+            EXPECT_GT(scheduler.getLightStats(i).updates, 0u);
+            EXPECT_LT(scheduler.getLightStats(i).maxStaleFrames, bound);
+        }
+    }
+}
+
+TEST(ShadowScheduler_Test, Deterministic)
+{
+    ShadowUpdateScheduler::Config config;
+    config.maxUpdatesPerFrame = 3;
+    config.budgetMs = 2.0f;
+    ShadowUpdateScheduler first(config), second(config);
+    std::mt19937 rnd(17);
+
+    for (int frame = 0; frame < 500; ++frame)
+    {
+        auto lights = randomStates(rnd, 40, 0.6f);
+        float cost = static_cast<float>(rnd() % 100) / 50.0f;
+        ASSERT_EQ(first.schedule(lights.data(), lights.size()), second.schedule(lights.data(), lights.size()));
+        first.reportCost(cost, 3);
+        second.reportCost(cost, 3);
+    }
+}
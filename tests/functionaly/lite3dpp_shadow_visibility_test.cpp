@@ -0,0 +1,319 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_shadow_visibility.h>
+
+using namespace lite3dpp;
+using CasterMask = ShadowVisibility::CasterMask;
+
+class ShadowVisibility_Test : public ::testing::Test
+{
+protected:
+
+    static lite3d_bounding_vol box(const kmVec3 &center, float half)
+    {
+        lite3d_bounding_vol vol;
+        kmVec3 vmin = { center.x - half, center.y - half, center.z - half };
+        kmVec3 vmax = { center.x + half, center.y + half, center.z + half };
+        lite3d_bounding_vol_setup(&vol, &vmin, &vmax);
+        return vol;
+    }
+
+    // Spot light camera at position looking at target
+    static kmMat4 spotMatrix(const kmVec3 &eye, const kmVec3 &target, float fov, float zfar)
+    {
+        kmMat4 proj, view, projView;
+        // Свет смотрит почти вниз, вверх камеры по Z
+        kmVec3 up = { 0.0f, 0.0f, 1.0f };
+        kmMat4PerspectiveProjection(&proj, fov, 1.0f, 1.0f, zfar);
+        kmMat4LookAt(&view, &eye, &target, &up);
+        kmMat4Multiply(&projView, &proj, &view);
+        return projView;
+    }
+
+    static std::vector<lite3d_bounding_vol> randomPieces(size_t count, uint32_t seed)
+    {
+        std::mt19937 rnd(seed);
+        std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> size(0.5f, 20.0f);
+        std::vector<lite3d_bounding_vol> pieces;
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Немного огромных обьектов вроде пола
+            float half = i % 500 == 0 ? 800.0f : size(rnd);
+            pieces.push_back(box({ pos(rnd), pos(rnd) * 0.1f, pos(rnd) }, half));
+        }
+
+        return pieces;
+    }
+
+    static std::vector<kmMat4> randomCasters(size_t count, uint32_t seed)
+    {
+        std::mt19937 rnd(seed);
+        std::uniform_real_distribution<float> pos(-900.0f, 900.0f);
+        std::uniform_real_distribution<float> angle(30.0f, 120.0f);
+        std::vector<kmMat4> casters;
+        for (size_t i = 0; i < count; ++i)
+        {
+            kmVec3 eye = { pos(rnd), 150.0f, pos(rnd) };
+            kmVec3 target = { eye.x + pos(rnd) * 0.1f, 0.0f, eye.z + pos(rnd) * 0.1f };
+            casters.push_back(spotMatrix(eye, target, angle(rnd), 300.0f));
+        }
+
+        return casters;
+    }
+
+    // Маска по прямой проверке каждого обьекта каждой камерой: AABB фрустума, потом плоскости
+    static CasterMask bruteForce(const std::vector<kmMat4> &casters, const lite3d_bounding_vol &vol)
+    {
+        CasterMask mask;
+        for (size_t i = 0; i < casters.size(); ++i)
+        {
+            kmVec3 vmin, vmax;
+            ShadowVisibility::frustumBounds(casters[i], vmin, vmax);
+            const kmVec3 &c = vol.sphereCenter;
+            if (c.x + vol.radius < vmin.x || c.x - vol.radius > vmax.x || c.y + vol.radius < vmin.y ||
+                c.y - vol.radius > vmax.y || c.z + vol.radius < vmin.z || c.z - vol.radius > vmax.z)
+                continue;
+
+            lite3d_frustum frustum;
+            lite3d_frustum_compute(&frustum, &casters[i]);
+            if (lite3d_frustum_test(&frustum, &vol))
+                mask.set(i);
+        }
+
+        return mask;
+    }
+
+    static CasterMask all(uint32_t count)
+    {
+        CasterMask mask;
+        for (uint32_t i = 0; i < count; ++i)
+            mask.set(i);
+        return mask;
+    }
+
+    void setCasters(const std::vector<kmMat4> &casters)
+    {
+        for (uint32_t i = 0; i < casters.size(); ++i)
+            mVisibility.setCaster(i, casters[i]);
+    }
+
+    ShadowVisibility mVisibility;
+};
+
+TEST_F(ShadowVisibility_Test, SameAsBruteForce)
+{
+    auto pieces = randomPieces(3000, 7);
+    auto casters = randomCasters(12, 9);
+    setCasters(casters);
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        mVisibility.beginPass(ShadowVisibility::Pass::Main, all(casters.size()));
+        for (size_t i = 0; i < pieces.size(); ++i)
+        {
+            CasterMask visibleFrom;
+            mVisibility.approve(&pieces[i], false, visibleFrom);
+            ASSERT_EQ(visibleFrom, bruteForce(casters, pieces[i])) << "piece " << i << ", frame " << frame;
+        }
+        mVisibility.endPass();
+
+        // Двигаем часть обьектов и одну камеру
+        for (size_t i = frame; i < pieces.size(); i += 7)
+            pieces[i] = box({ pieces[i].sphereCenter.x + 40.0f, pieces[i].sphereCenter.y, pieces[i].sphereCenter.z }, 5.0f);
+        casters[frame] = spotMatrix({ 10.0f * frame, 100.0f, 0.0f }, { 0.0f, 0.0f, 50.0f }, 90.0f, 500.0f);
+        setCasters(casters);
+        mVisibility.invalidateCasters(all(casters.size()));
+    }
+
+    EXPECT_EQ(mVisibility.piecesCount(), pieces.size());
+}
+
+TEST_F(ShadowVisibility_Test, Invalidation)
+{
+    // Две камеры смотрят в разные стороны
+    mVisibility.setCaster(0, spotMatrix({ 0.0f, 50.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, 60.0f, 100.0f));
+    mVisibility.setCaster(1, spotMatrix({ 500.0f, 50.0f, 0.0f }, { 500.0f, 0.0f, 0.0f }, 60.0f, 100.0f));
+    auto first = box({ 0.0f, 0.0f, 0.0f }, 2.0f);
+    auto second = box({ 500.0f, 0.0f, 0.0f }, 2.0f);
+    CasterMask visibleFrom, active = all(2);
+
+    // Первый кадр рисует все
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active), active);
+    EXPECT_TRUE(mVisibility.approve(&first, false, visibleFrom));
+    EXPECT_EQ(visibleFrom, CasterMask(1));
+    EXPECT_TRUE(mVisibility.approve(&second, false, visibleFrom));
+    EXPECT_EQ(visibleFrom, CasterMask(2));
+    mVisibility.endPass();
+    EXPECT_FALSE(mVisibility.isInvalidated(0));
+    EXPECT_FALSE(mVisibility.isInvalidated(1));
+
+    // Ничего не поменялось - проход не начинается
+    EXPECT_TRUE(mVisibility.beginPass(ShadowVisibility::Pass::Main, active).none());
+
+    // Динамический обьект ушел из первой камеры во вторую: первая перерисовывается сейчас,
+    // вторая в следующем кадре, так как в текущий проход уже не попала
+    mVisibility.invalidateCasters(CasterMask(1));
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active), CasterMask(1));
+    first = box({ 500.0f, 0.0f, 5.0f }, 2.0f);
+    EXPECT_FALSE(mVisibility.approve(&first, true, visibleFrom));
+    EXPECT_EQ(visibleFrom, CasterMask(2));
+    EXPECT_FALSE(mVisibility.approve(&second, false, visibleFrom));
+    mVisibility.endPass();
+    EXPECT_FALSE(mVisibility.isInvalidated(0));
+    EXPECT_TRUE(mVisibility.isInvalidated(1));
+
+    // Неактивная камера ждет, пока не станет видна
+    EXPECT_TRUE(mVisibility.beginPass(ShadowVisibility::Pass::Main, CasterMask(1)).none());
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active), CasterMask(2));
+    EXPECT_TRUE(mVisibility.approve(&first, true, visibleFrom));
+    EXPECT_TRUE(mVisibility.approve(&second, false, visibleFrom));
+    mVisibility.endPass();
+
+    // Обьект пропал со сцены - его тень надо стереть
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active).count(), 0u);
+    mVisibility.invalidateCaster(0);
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active), CasterMask(1));
+    mVisibility.approve(&second, false, visibleFrom);
+    mVisibility.endPass();
+    EXPECT_EQ(mVisibility.piecesCount(), 1u);
+    EXPECT_TRUE(mVisibility.isInvalidated(1));
+}
+
+TEST_F(ShadowVisibility_Test, StaticCache)
+{
+    mVisibility.setStaticCache(true);
+    mVisibility.setCaster(0, spotMatrix({ 0.0f, 50.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, 60.0f, 100.0f));
+    auto wall = box({ 0.0f, 0.0f, 0.0f }, 5.0f);
+    auto player = box({ 3.0f, 0.0f, 0.0f }, 1.0f);
+    CasterMask visibleFrom, active = all(1);
+
+    // Кеш статики содержит только статику
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Static, active), active);
+    EXPECT_TRUE(mVisibility.approve(&wall, false, visibleFrom));
+    EXPECT_FALSE(mVisibility.approve(&player, true, visibleFrom));
+    mVisibility.endPass();
+    EXPECT_FALSE(mVisibility.isStaticInvalidated(0));
+    EXPECT_TRUE(mVisibility.isInvalidated(0));
+
+    // Итоговая карта: копия кеша плюс динамика
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active), active);
+    EXPECT_FALSE(mVisibility.approve(&wall, false, visibleFrom));
+    EXPECT_TRUE(mVisibility.approve(&player, true, visibleFrom));
+    mVisibility.endPass();
+    EXPECT_FALSE(mVisibility.isInvalidated(0));
+
+    // Движение динамики кеш не трогает
+    mVisibility.invalidateCasters(visibleFrom);
+    EXPECT_TRUE(mVisibility.beginPass(ShadowVisibility::Pass::Static, active).none());
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active), active);
+    player = box({ 4.0f, 0.0f, 0.0f }, 1.0f);
+    EXPECT_FALSE(mVisibility.approve(&wall, false, visibleFrom));
+    EXPECT_TRUE(mVisibility.approve(&player, true, visibleFrom));
+    mVisibility.endPass();
+    EXPECT_FALSE(mVisibility.isStaticInvalidated(0));
+
+    // Сдвинутая статика перестраивает кеш в следующем кадре
+    EXPECT_TRUE(mVisibility.beginPass(ShadowVisibility::Pass::Static, active).none());
+    wall = box({ 1.0f, 0.0f, 0.0f }, 5.0f);
+    EXPECT_EQ(mVisibility.beginPass(ShadowVisibility::Pass::Main, active).count(), 0u);
+    mVisibility.invalidateCasters(active);
+    mVisibility.beginPass(ShadowVisibility::Pass::Main, active);
+    EXPECT_FALSE(mVisibility.approve(&wall, false, visibleFrom));
+    EXPECT_TRUE(mVisibility.approve(&player, true, visibleFrom));
+    mVisibility.endPass();
+    EXPECT_TRUE(mVisibility.isStaticInvalidated(0));
+
+    // Сдвинутый свет перестраивает и кеш и итог
+    mVisibility.setCaster(0, spotMatrix({ 0.0f, 60.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, 60.0f, 100.0f));
+    mVisibility.invalidateCaster(0);
+    EXPECT_TRUE(mVisibility.isStaticInvalidated(0));
+    EXPECT_TRUE(mVisibility.isInvalidated(0));
+}
+
+TEST_F(ShadowVisibility_Test, PerfomanceUpdate)
+{
+    auto pieces = randomPieces(10000, 3);
+    auto casters = randomCasters(32, 4);
+    std::vector<CasterMask> expected(pieces.size());
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pieces.size(); ++i)
+        expected[i] = bruteForce(casters, pieces[i]);
+    auto bruteTime = std::chrono::steady_clock::now() - begin;
+
+    auto frame = [&](bool moveCaster, uint64_t &tests)
+    {
+        if (moveCaster)
+        {
+            // Один источник света ходит каждый кадр
+            std::swap(casters[0], casters[1]);
+            setCasters(casters);
+        }
+
+        mVisibility.invalidateCasters(all(casters.size()));
+        mVisibility.beginPass(ShadowVisibility::Pass::Main, all(casters.size()));
+        CasterMask visibleFrom;
+        for (auto &piece : pieces)
+            mVisibility.approve(&piece, false, visibleFrom);
+        tests += mVisibility.getStats().frustumTests;
+        mVisibility.endPass();
+    };
+
+    uint64_t buildTests = 0;
+    setCasters(casters);
+    begin = std::chrono::steady_clock::now();
+    frame(false, buildTests);
+    auto buildTime = std::chrono::steady_clock::now() - begin;
+
+    const int runs = 20;
+    uint64_t staticTests = 0, movingTests = 0;
+    begin = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; ++run)
+        frame(false, staticTests);
+    auto staticTime = (std::chrono::steady_clock::now() - begin) / runs;
+
+    begin = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; ++run)
+        frame(true, movingTests);
+    auto movingTime = (std::chrono::steady_clock::now() - begin) / runs;
+
+    // После четного числа обменов камеры на исходных местах
+    mVisibility.invalidateCasters(all(casters.size()));
+    mVisibility.beginPass(ShadowVisibility::Pass::Main, all(casters.size()));
+    for (size_t i = 0; i < pieces.size(); ++i)
+    {
+        CasterMask visibleFrom;
+        mVisibility.approve(&pieces[i], false, visibleFrom);
+        ASSERT_EQ(visibleFrom, expected[i]) << "piece " << i;
+    }
+    mVisibility.endPass();
+
+    auto ms = [](auto d) {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(d).count(); };
+    std::cout << pieces.size() << " pieces, " << casters.size() << " casters: brute force " << ms(bruteTime)
+        << " ms (" << pieces.size() * casters.size() << " tests), first pass " << ms(buildTime) << " ms ("
+        << buildTests << " tests), static frame " << ms(staticTime) << " ms (" << staticTests / runs
+        << " tests), one moving light " << ms(movingTime) << " ms (" << movingTests / runs << " tests)" << std::endl;
+}
@@ -0,0 +1,314 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include <lite3dpp/lite3dpp_skeleton_pose.h>
+
+using lite3dpp::SkeletonPose;
+using lite3dpp::SkeletonPoseBatch;
+using lite3dpp::stl;
+
+/* Recursive bone as it was before the flat pose, used as the reference and benchmark baseline */
+struct LegacyBone
+{
+    LegacyBone(LegacyBone *parent, kmMat4 *out, const kmVec3 &head, float length, const kmQuaternion &rot) :
+        parent(parent), out(out), length(length), restPoseRotation(rot)
+    {
+        restPosePosition = head;
+        restPosePosition.y += parent ? parent->length : 0.0f;
+        kmMat4 translate;
+        kmMat4Translation(&translate, restPosePosition.x, restPosePosition.y, restPosePosition.z);
+        kmMat4RotationQuaternion(&restPoseTransform, &restPoseRotation);
+        kmMat4Multiply(&restPoseTransform, &translate, &restPoseTransform);
+        if (parent)
+        {
+            kmMat4Multiply(&restPoseTransform, &parent->restPoseTransform, &restPoseTransform);
+            parent->children.push_back(this);
+        }
+        kmMat4Inverse(&restPoseTransformInverse, &restPoseTransform);
+        position = restPosePosition;
+        rotation = restPoseRotation;
+    }
+
+    void set(const kmVec3 &p, const kmQuaternion &q, const kmVec3 &s)
+    {
+        kmVec3Add(&position, &restPosePosition, &p);
+        kmQuaternionMultiply(&rotation, &restPoseRotation, &q);
+        scale = s;
+        needRecalc = true;
+    }
+
+    void recalculateRecursive(bool force = false)
+    {
+        if (needRecalc || force)
+        {
+            kmMat4 translate;
+            kmMat4TranslationScale(&translate, &position, &scale);
+            kmMat4RotationQuaternion(&transform, &rotation);
+            kmMat4Multiply(&transform, &translate, &transform);
+            if (parent)
+                kmMat4Multiply(&transform, &parent->transform, &transform);
+            kmMat4Multiply(out, &transform, &restPoseTransformInverse);
+            needRecalc = false;
+            force = true;
+        }
+
+        for (LegacyBone *bone : children)
+            bone->recalculateRecursive(force);
+    }
+
+    LegacyBone *parent;
+    kmMat4 *out;
+    float length;
+    kmVec3 restPosePosition, position;
+    kmQuaternion restPoseRotation, rotation;
+    kmVec3 scale = KM_VEC3_ONE;
+    kmMat4 transform, restPoseTransform, restPoseTransformInverse;
+    stl<LegacyBone *>::vector children;
+    bool needRecalc = true;
+};
+
+class Skeleton_Test : public ::testing::Test
+{
+protected:
+
+    static const int BonesCount = 100;
+
+    /* Branchy hierarchy, every bone has a vertex group in reversed order */
+    void build(SkeletonPose &pose, stl<std::unique_ptr<LegacyBone>>::vector &legacy, stl<kmMat4>::vector &palette)
+    {
+        palette.resize(BonesCount);
+        for (int i = 0; i < BonesCount; ++i)
+        {
+            int32_t parent = i == 0 ? -1 : (i - 1) / 3;
+            kmVec3 head = { 0.1f * (i % 5), 0.2f, 0.05f * (i % 3) };
+            kmVec3 axis = { 0.3f, 1.0f, 0.2f };
+            kmQuaternion rot;
+            kmVec3Normalize(&axis, &axis);
+            kmQuaternionRotationAxisAngle(&rot, &axis, 0.1f * i);
+
+            pose.addBone(parent, head, 0.5f + 0.01f * i, rot, BonesCount - 1 - i);
+            legacy.emplace_back(std::make_unique<LegacyBone>(parent >= 0 ? legacy[parent].get() : nullptr,
+                &palette[BonesCount - 1 - i], head, 0.5f + 0.01f * i, rot));
+        }
+    }
+
+    static void animate(int frame, int bone, kmVec3 &p, kmQuaternion &q, kmVec3 &s)
+    {
+        kmVec3 axis = { 1.0f, 0.0f, 0.0f };
+        p = { 0.01f * frame, 0.0f, 0.02f * bone };
+        kmQuaternionRotationAxisAngle(&q, &axis, 0.03f * (frame + bone));
+        s = { 1.0f, 1.0f + 0.001f * frame, 1.0f };
+    }
+};
+
+TEST_F(Skeleton_Test, MultiplyArrayMatchesScalar)
+{
+    kmMat4 a[3], b[3], out[3], expected;
+    for (int m = 0; m < 3; ++m)
+        for (int i = 0; i < 16; ++i)
+        {
+            a[m].mat[i] = 0.5f * i - m;
+            b[m].mat[i] = 1.0f / (i + 1) + m;
+        }
+
+    kmMat4MultiplyArray(out, a, b, 3);
+    for (int m = 0; m < 3; ++m)
+    {
+        kmMat4Multiply(&expected, &a[m], &b[m]);
+        for (int i = 0; i < 16; ++i)
+            EXPECT_NEAR(out[m].mat[i], expected.mat[i], 1e-5f);
+    }
+
+    /* in place */
+    kmMat4MultiplyArray(a, a, b, 3);
+    EXPECT_NEAR(a[2].mat[7], out[2].mat[7], 1e-5f);
+}
+
+TEST_F(Skeleton_Test, PoseMatchesRecursive)
+{
+    SkeletonPose pose;
+    stl<std::unique_ptr<LegacyBone>>::vector legacy;
+    stl<kmMat4>::vector legacyPalette, palette(BonesCount);
+    build(pose, legacy, legacyPalette);
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        /* only a part of bones is animated every frame */
+        for (int i = frame % 2; i < BonesCount; i += 2)
+        {
+            kmVec3 p, s;
+            kmQuaternion q;
+            animate(frame, i, p, q, s);
+            pose.setPosition(i, p);
+            pose.setRotation(i, q);
+            pose.setScale(i, s);
+            legacy[i]->set(p, q, s);
+        }
+
+        pose.recalculate();
+        legacy[0]->recalculateRecursive();
+        pose.writePalette(palette.data(), palette.size());
+
+        for (int b = 0; b < BonesCount; ++b)
+            for (int i = 0; i < 16; ++i)
+                ASSERT_NEAR(palette[b].mat[i], legacyPalette[b].mat[i], 1e-4f) << "bone " << b << " frame " << frame;
+    }
+
+    pose.resetToRestPose();
+    pose.recalculate();
+    for (const auto &skinning : pose.getSkinning())
+        for (int i = 0; i < 16; ++i)
+            EXPECT_NEAR(skinning.mat[i], (i % 5) == 0 ? 1.0f : 0.0f, 1e-4f);
+}
+
+TEST_F(Skeleton_Test, BatchMatchesPose)
+{
+    const int instances = 5;
+    stl<std::unique_ptr<SkeletonPose>>::vector poses;
+    stl<const SkeletonPose *>::vector posesPtr;
+    stl<stl<std::unique_ptr<LegacyBone>>::vector>::vector legacy(instances);
+    stl<stl<kmMat4>::vector>::vector palettes(instances);
+    for (int n = 0; n < instances; ++n)
+    {
+        poses.emplace_back(std::make_unique<SkeletonPose>());
+        posesPtr.push_back(poses.back().get());
+        build(*poses.back(), legacy[n], palettes[n]);
+    }
+
+    SkeletonPoseBatch batch;
+    stl<kmMat4>::vector combined(instances * BonesCount);
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        /* every instance has its own animation, a part of bones is animated every frame */
+        for (int n = 0; n < instances; ++n)
+            for (int i = (frame + n) % 2; i < BonesCount; i += 2)
+            {
+                kmVec3 p, s;
+                kmQuaternion q;
+                animate(frame + 10 * n, i, p, q, s);
+                poses[n]->setPosition(i, p);
+                poses[n]->setRotation(i, q);
+                poses[n]->setScale(i, s);
+            }
+
+        batch.recalculate(posesPtr.data(), posesPtr.size());
+        batch.writePalettes(combined.data(), BonesCount);
+        ASSERT_EQ(batch.getPosesCount(), static_cast<size_t>(instances));
+        ASSERT_EQ(batch.getBonesCount(), static_cast<size_t>(BonesCount));
+
+        for (int n = 0; n < instances; ++n)
+        {
+            poses[n]->recalculate();
+            poses[n]->writePalette(palettes[n].data(), palettes[n].size());
+            for (int b = 0; b < BonesCount; ++b)
+                for (int i = 0; i < 16; ++i)
+                {
+                    ASSERT_NEAR(combined[n * BonesCount + b].mat[i], palettes[n][b].mat[i], 1e-5f) 
+                        << "instance " << n << " palette " << b << " frame " << frame;
+                    ASSERT_NEAR(batch.getSkinning(n, b).mat[i], poses[n]->getSkinning()[b].mat[i], 1e-5f)
+                        << "instance " << n << " bone " << b << " frame " << frame;
+                }
+        }
+    }
+}
+
+TEST_F(Skeleton_Test, PerfomanceInstances)
+{
+    const int instances = 100, frames = 100;
+    stl<std::unique_ptr<SkeletonPose>>::vector poses;
+    stl<const SkeletonPose *>::vector posesPtr;
+    stl<stl<std::unique_ptr<LegacyBone>>::vector>::vector legacy(instances);
+    stl<stl<kmMat4>::vector>::vector palettes(instances);
+
+    for (int n = 0; n < instances; ++n)
+    {
+        poses.emplace_back(std::make_unique<SkeletonPose>());
+        posesPtr.push_back(poses.back().get());
+        build(*poses.back(), legacy[n], palettes[n]);
+    }
+
+    /* animation is sampled up front, only pose calculation is measured */
+    struct Sample { kmVec3 p; kmQuaternion q; kmVec3 s; };
+    stl<Sample>::vector samples(frames * BonesCount);
+    for (int frame = 0; frame < frames; ++frame)
+        for (int i = 0; i < BonesCount; ++i)
+        {
+            Sample &sample = samples[frame * BonesCount + i];
+            animate(frame, i, sample.p, sample.q, sample.s);
+        }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+        for (int n = 0; n < instances; ++n)
+        {
+            for (int i = 0; i < BonesCount; ++i)
+            {
+                const Sample &sample = samples[frame * BonesCount + i];
+                legacy[n][i]->set(sample.p, sample.q, sample.s);
+            }
+            legacy[n][0]->recalculateRecursive();
+        }
+    auto legacyMcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (int n = 0; n < instances; ++n)
+            for (int i = 0; i < BonesCount; ++i)
+            {
+                const Sample &sample = samples[frame * BonesCount + i];
+                poses[n]->setPosition(i, sample.p);
+                poses[n]->setRotation(i, sample.q);
+                poses[n]->setScale(i, sample.s);
+            }
+
+        for (int n = 0; n < instances; ++n)
+        {
+            poses[n]->recalculate();
+            poses[n]->writePalette(palettes[n].data(), palettes[n].size());
+        }
+    }
+    auto poseMcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    /* same animation, palettes of all instances by one batched call */
+    SkeletonPoseBatch batch;
+    stl<kmMat4>::vector combined(instances * BonesCount);
+    begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (int n = 0; n < instances; ++n)
+            for (int i = 0; i < BonesCount; ++i)
+            {
+                const Sample &sample = samples[frame * BonesCount + i];
+                poses[n]->setPosition(i, sample.p);
+                poses[n]->setRotation(i, sample.q);
+                poses[n]->setScale(i, sample.s);
+            }
+
+        batch.recalculate(posesPtr.data(), posesPtr.size());
+        batch.writePalettes(combined.data(), BonesCount);
+    }
+    auto batchMcs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << instances << " skeletons x " << BonesCount << " bones, " << frames << " frames: recursive "
+        << legacyMcs << " mcs, flat pose " << poseMcs << " mcs, batch " << batchMcs << " mcs" << std::endl;
+}
@@ -0,0 +1,393 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include <SDL_log.h>
+
+#include <lite3d/lite3d_mesh_assimp_loader.h>
+#include <lite3dpp/lite3dpp_config_writer.h>
+
+#include <mtool/mtool_batch_converter.h>
+#include <mtool/mtool_utils.h>
+
+static const char *ManifestFileName = "mtool_manifest.json";
+
+BatchConverterCommand::BatchConverterCommand() : 
+    mThreads(0),
+    mIncremental(false),
+    mOptionsHash(0)
+{}
+
+#ifdef INCLUDE_ASSIMP
+void BatchConverterCommand::runImpl()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    makeFolders(mGenOptions.outputFolder);
+    collectInputs();
+    assignObjectNames();
+    mOptionsHash = optionsHash();
+    if (mIncremental)
+        loadManifest();
+
+    WorkerPool pool(mThreads);
+    mWriter.reset(new OutputWriter(mGenOptions.outputFolder, &pool));
+    mWriter->skipUnchanged(mIncremental);
+
+    /* импорт опережает конвертацию не больше чем на окно, разобранные сцены занимают много памяти */
+    const size_t window = pool.threadsCount() * 2;
+    size_t next = 0;
+    auto submitNext = [this, &pool, &next]()
+    {
+        Input &input = mInputs[next++];
+        input.imported = pool.submit([this, &input]() { importInput(input, true); });
+    };
+
+    while (next < mInputs.size() && next < window)
+        submitNext();
+
+    uint32_t converted = 0, skipped = 0, failed = 0;
+    for (auto &input : mInputs)
+    {
+        input.imported.get();
+        if (next < mInputs.size())
+            submitNext();
+
+        if (input.skipped)
+        {
+            const ManifestEntry &previous = mPrevious.at(input.path);
+            for (const auto &output : previous.outputs)
+                mWriter->addExisting(output);
+
+            mCurrent[input.path] = previous;
+            printf("Skip %s, not changed\n", input.path.c_str());
+            skipped++;
+            continue;
+        }
+
+        if (convertInput(input))
+            converted++;
+        else
+            failed++;
+    }
+
+    /* 
+     * Skipped input may refer to a file of other input by deduplication, e.g. a shared mesh. 
+     * When that input changed, the file has new content now and the skipped one is converted too.
+     */
+    for (bool replaced = true; replaced;)
+    {
+        replaced = false;
+        for (auto &input : mInputs)
+        {
+            if (!input.skipped || !outputsReplaced(mCurrent.at(input.path)))
+                continue;
+
+            printf("Outputs of %s were replaced\n", input.path.c_str());
+            mCurrent.erase(input.path);
+            input.skipped = false;
+            skipped--;
+            replaced = true;
+
+            importInput(input, false);
+            if (convertInput(input))
+                converted++;
+            else
+                failed++;
+        }
+    }
+
+    mWriter->flush();
+    OutputWriter::Stats stats = mWriter->getStats();
+    mWriter.reset();
+    saveManifest();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("\nModels: %zu, converted: %u, skipped: %u, failed: %u\n", mInputs.size(), converted, skipped, failed);
+    printf("Files written: %u (%llu bytes), unchanged: %u, deduplicated: %u\n", stats.written, 
+        static_cast<unsigned long long>(stats.bytesWritten), stats.unchanged, stats.deduplicated);
+    printf("Threads: %u, time: %.2f s\n", pool.threadsCount(), seconds);
+
+    if (failed > 0)
+        LITE3D_THROW(failed << " of " << mInputs.size() << " models failed to convert");
+}
+
+void BatchConverterCommand::collectInputs()
+{
+    std::error_code error;
+    std::filesystem::path source(mBatchSource.c_str());
+    lite3dpp::stl<lite3dpp::String>::vector paths;
+
+    if (std::filesystem::is_directory(source, error))
+    {
+        std::filesystem::recursive_directory_iterator it(source, error), end;
+        for (; !error && it != end; it.increment(error))
+        {
+            if (!it->is_regular_file(error))
+                continue;
+
+            std::string extension = it->path().extension().string();
+            if (!extension.empty() && lite3d_assimp_extension_supported(extension.c_str()))
+                paths.emplace_back(it->path().generic_string().c_str());
+        }
+
+        if (error)
+            LITE3D_THROW("Unable to read folder " << mBatchSource << ": " << error.message());
+
+        /* порядок обхода папки не определен, а от порядка зависят общие меши и имена */
+        std::sort(paths.begin(), paths.end());
+    }
+    else
+    {
+        /* список: путь к модели на строку, относительно папки списка, # - комментарий */
+        lite3dpp::stl<uint8_t>::vector list;
+        if (!Utils::loadFile(mBatchSource, list))
+            LITE3D_THROW("Unable to read model list " << mBatchSource);
+
+        lite3dpp::String text(list.begin(), list.end());
+        size_t lineBegin = 0;
+        while (lineBegin < text.size())
+        {
+            size_t lineEnd = std::min(text.find('\n', lineBegin), text.size());
+            lite3dpp::String line = text.substr(lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
+
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == lite3dpp::String::npos || line[first] == '#')
+                continue;
+            line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+
+            std::filesystem::path path(line.c_str());
+            if (path.is_relative())
+                path = source.parent_path() / path;
+            paths.emplace_back(path.generic_string().c_str());
+        }
+    }
+
+    if (paths.empty())
+        LITE3D_THROW("No models found in " << mBatchSource);
+
+    for (const auto &path : paths)
+    {
+        mInputs.emplace_back();
+        mInputs.back().path = path;
+    }
+}
+
+bool BatchConverterCommand::convertInput(Input &input)
+{
+    if (!input.error.empty())
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: %s", input.path.c_str(), input.error.c_str());
+        return false;
+    }
+
+    printf("Converting %s as %s\n", input.path.c_str(), input.objectName.c_str());
+    GeneratorOptions options = mGenOptions;
+    options.objectName = input.objectName;
+    options.scope = input.objectName;
+    bool result = true;
+
+    try
+    {
+        convertScene(input.scene, options);
+        mCurrent[input.path] = ManifestEntry { input.hash, mWriter->takeSaved() };
+    }
+    catch (std::exception &ex)
+    {
+        /* в манифест не попадает, при следующем запуске сконвертируется заново */
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: %s", input.path.c_str(), ex.what());
+        mWriter->takeSaved();
+        result = false;
+    }
+
+    lite3d_assimp_scene_release(input.scene);
+    input.scene = nullptr;
+    return result;
+}
+
+void BatchConverterCommand::importInput(Input &input, bool allowSkip)
+{
+    lite3dpp::stl<uint8_t>::vector data;
+    if (!Utils::loadFile(input.path, data))
+    {
+        input.error = "unable to read file";
+        return;
+    }
+
+    /* имя объекта и опции входят в хэш, их смена тоже требует конвертации */
+    input.hash = Utils::contentHash(input.objectName.data(), input.objectName.size(), mOptionsHash);
+    input.hash = Utils::contentHash(data.data(), data.size(), input.hash);
+
+    if (mIncremental && allowSkip)
+    {
+        auto previous = mPrevious.find(input.path);
+        if (previous != mPrevious.end() && previous->second.hash == input.hash && outputsExist(previous->second))
+        {
+            input.skipped = true;
+            return;
+        }
+    }
+
+    input.scene = lite3d_assimp_scene_import(data.data(), data.size(), input.path.c_str(), loadFlags());
+    if (!input.scene)
+        input.error = "Assimp import failed";
+}
+#else
+void BatchConverterCommand::runImpl()
+{
+    LITE3D_THROW("If you want to use converter, please, recompile with Assimp support!");
+}
+#endif
+
+void BatchConverterCommand::assignObjectNames()
+{
+    lite3dpp::stl<lite3dpp::String, uint32_t>::unordered_map stems;
+    lite3dpp::stl<lite3dpp::String>::unordered_set used;
+
+    for (const auto &input : mInputs)
+        stems[Utils::getFileNameWithoutExt(input.path)]++;
+
+    for (auto &input : mInputs)
+    {
+        /* у gltf моделей часто одинаковые имена файлов, различаем по папке */
+        std::filesystem::path path(input.path.c_str());
+        lite3dpp::String name = Utils::getFileNameWithoutExt(input.path);
+        if (stems[name] > 1 && !path.parent_path().filename().empty())
+            name = lite3dpp::String(path.parent_path().filename().string().c_str()) + "_" + name;
+
+        lite3dpp::String unique = name;
+        for (int i = 2; used.count(unique) > 0; ++i)
+            unique = name + "_" + std::to_string(i).c_str();
+
+        used.insert(unique);
+        input.objectName = unique;
+    }
+}
+
+uint64_t BatchConverterCommand::optionsHash() const
+{
+    lite3dpp::Stringstream options;
+    options << LITE3D_VERSION_STRING << ' ' << mOptimizeMesh << mFlipUV << mGenerateJson << mBuildClusters << 
+        ' ' << mLodLevels << ' ' << mGenOptions.useDifTexNameAsMatName << mGenOptions.nodeUniqName << ' ' << 
+        mGenOptions.packname << ' ' << mGenOptions.texPackname << ' ' << mGenOptions.imgPackname << ' ' << 
+        mGenOptions.matPackname << ' ' << mGenOptions.nodePackname << ' ' << mGenOptions.meshPackname;
+
+    lite3dpp::String str = options.str();
+    return Utils::contentHash(str.data(), str.size());
+}
+
+bool BatchConverterCommand::outputsExist(const ManifestEntry &entry) const
+{
+    return std::all_of(entry.outputs.begin(), entry.outputs.end(), [this](const OutputWriter::Entry &output)
+    {
+        return Utils::fileExists(Utils::makeFullPath(mGenOptions.outputFolder, output.path));
+    });
+}
+
+bool BatchConverterCommand::outputsReplaced(const ManifestEntry &entry) const
+{
+    return std::any_of(entry.outputs.begin(), entry.outputs.end(), [this](const OutputWriter::Entry &output)
+    {
+        return mWriter->replaced(output);
+    });
+}
+
+void BatchConverterCommand::loadManifest()
+{
+    lite3dpp::String path = Utils::makeFullPath(mGenOptions.outputFolder, ManifestFileName);
+    if (!Utils::fileExists(path))
+        return;
+
+    try
+    {
+        lite3dpp::ConfigurationReader manifest(path);
+        for (const auto &input : manifest.getObjects(L"Inputs"))
+        {
+            ManifestEntry entry;
+            entry.hash = Utils::hashFromString(input.getString(L"Hash"));
+            for (const auto &output : input.getObjects(L"Outputs"))
+                entry.outputs.push_back({ output.getString(L"Path"), Utils::hashFromString(output.getString(L"Hash")) });
+
+            mPrevious[input.getString(L"Path")] = entry;
+        }
+    }
+    catch (std::exception &ex)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s ignored: %s", path.c_str(), ex.what());
+        mPrevious.clear();
+    }
+}
+
+void BatchConverterCommand::saveManifest()
+{
+    lite3dpp::stl<lite3dpp::ConfigurationWriter>::vector inputs;
+    for (const auto &current : mCurrent)
+    {
+        lite3dpp::stl<lite3dpp::ConfigurationWriter>::vector outputs;
+        for (const auto &output : current.second.outputs)
+        {
+            lite3dpp::ConfigurationWriter outputConfig;
+            outputConfig.set(L"Path", output.path);
+            outputConfig.set(L"Hash", Utils::hashToString(output.hash));
+            outputs.push_back(outputConfig);
+        }
+
+        lite3dpp::ConfigurationWriter inputConfig;
+        inputConfig.set(L"Path", current.first);
+        inputConfig.set(L"Hash", Utils::hashToString(current.second.hash));
+        inputConfig.set(L"Outputs", outputs);
+        inputs.push_back(inputConfig);
+    }
+
+    lite3dpp::ConfigurationWriter manifest;
+    manifest.set(L"Inputs", inputs);
+    Utils::saveTextFile(manifest.write(), Utils::makeFullPath(mGenOptions.outputFolder, ManifestFileName));
+}
+
+void BatchConverterCommand::parseCommandLineImpl(int argc, char *args[])
+{
+    ConverterCommand::parseCommandLineImpl(argc, args);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(args[i], "-i") == 0)
+        {
+            if ((i + 1) < argc && args[i + 1][0] != '-')
+                mBatchSource.assign(args[i + 1]);
+            else
+                LITE3D_THROW("Missing input folder or list");
+        }
+        else if (strcmp(args[i], "-t") == 0)
+        {
+            if ((i + 1) < argc && args[i + 1][0] != '-')
+                mThreads = static_cast<uint32_t>(std::max(atoi(args[i + 1]), 0));
+            else
+                LITE3D_THROW("Missing threads count");
+        }
+        else if (strcmp(args[i], "-inc") == 0)
+        {
+            mIncremental = true;
+        }
+    }
+
+    if (mBatchSource.empty())
+        LITE3D_THROW("Missing input folder or list");
+}
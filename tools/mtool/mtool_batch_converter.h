@@ -0,0 +1,80 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <mtool/mtool_converter.h>
+
+/* Converts every model of folder or list file into one output folder. 
+   Reading, Assimp import and postprocess (optimize) run on worker pool, 
+   meshes are built and encoded in main thread in input order, so outputs 
+   do not depend on threads count. Identical meshes and generated json are 
+   saved once. With -inc inputs unchanged since previous run are skipped, 
+   unless a file they refer to was rewritten with other content. */
+class BatchConverterCommand : public ConverterCommand
+{
+public:
+
+    BatchConverterCommand();
+
+protected:
+
+    virtual void runImpl() override;
+    virtual void parseCommandLineImpl(int argc, char *args[]) override;
+
+private:
+
+    struct Input
+    {
+        lite3dpp::String path;
+        lite3dpp::String objectName;
+        uint64_t hash = 0;
+        bool skipped = false;
+        const aiScene *scene = nullptr;
+        lite3dpp::String error;
+        std::future<void> imported;
+    };
+
+    struct ManifestEntry
+    {
+        uint64_t hash = 0;
+        lite3dpp::stl<OutputWriter::Entry>::vector outputs;
+    };
+
+    void collectInputs();
+    void assignObjectNames();
+    uint64_t optionsHash() const;
+    /* worker thread, unchanged input is skipped when allowed */
+    void importInput(Input &input, bool allowSkip);
+    /* main thread, releases imported scene */
+    bool convertInput(Input &input);
+    bool outputsExist(const ManifestEntry &entry) const;
+    /* some output was saved in this run with other content */
+    bool outputsReplaced(const ManifestEntry &entry) const;
+
+    void loadManifest();
+    void saveManifest();
+
+    lite3dpp::String mBatchSource;
+    uint32_t mThreads;
+    bool mIncremental;
+    uint64_t mOptionsHash;
+    /* deque: elements stay in place while workers fill them */
+    std::deque<Input> mInputs;
+    lite3dpp::stl<lite3dpp::String, ManifestEntry>::unordered_map mPrevious;
+    lite3dpp::stl<lite3dpp::String, ManifestEntry>::map mCurrent;
+};
@@ -15,10 +15,13 @@
  *	You should have received a copy of the GNU General Public License
  *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
  *******************************************************************************/
+#include <algorithm>
 #include <SDL_assert.h>
 #include <SDL_log.h>
 
 #include <lite3d/lite3d_mesh_codec.h>
+#include <lite3d/lite3d_mesh_cluster.h>
+#include <lite3d/lite3d_mesh_lod.h>
 #include <lite3d/lite3d_mesh_assimp_loader.h>
 
 #include <mtool/mtool_converter.h>
@@ -86,20 +89,50 @@ void ConverterCommand::entry_on_light(const char *lightName,
 ConverterCommand::ConverterCommand() : 
     mOptimizeMesh(false),
     mFlipUV(false),
-    mGenerateJson(false)
+    mGenerateJson(false),
+    mBuildClusters(false),
+    mLodLevels(0)
 {}
 
+uint32_t ConverterCommand::loadFlags() const
+{
+    uint32_t flags = 0;
+    if (mOptimizeMesh)
+        flags |= LITE3D_OPTIMIZE_MESH_FLAG;
+    if (mFlipUV)
+        flags |= LITE3D_FLIP_UV_FLAG;
+
+    return flags;
+}
+
 #ifdef INCLUDE_ASSIMP
 void ConverterCommand::runImpl()
 {
-    uint32_t loadFlags = 0;
     makeFolders(mGenOptions.outputFolder);
+    mWriter.reset(new OutputWriter(mGenOptions.outputFolder));
 
-    if (mOptimizeMesh)
-        loadFlags |= LITE3D_OPTIMIZE_MESH_FLAG;
-    if (mFlipUV)
-        loadFlags |= LITE3D_FLIP_UV_FLAG;
+    const lite3d_file *file = mMain.getResourceManager().loadFileToMemory(mInputFilePath);
+    const aiScene *scene = file->isLoaded ? 
+        lite3d_assimp_scene_import(file->fileBuff, file->fileSize, file->name, loadFlags()) : NULL;
+    if (!scene)
+        LITE3D_THROW("Assimp failed to load file '" << mInputFilePath << "'");
 
+    try
+    {
+        convertScene(scene, mGenOptions);
+    }
+    catch (...)
+    {
+        lite3d_assimp_scene_release(scene);
+        throw;
+    }
+
+    lite3d_assimp_scene_release(scene);
+    mWriter->flush();
+}
+
+void ConverterCommand::convertScene(const aiScene *scene, const GeneratorOptions &options)
+{
     lite3d_assimp_loader_ctx ctx;
     ctx.onAllocMesh = entry_alloc_mesh;
     ctx.onMesh = entry_on_mesh;
@@ -109,20 +142,26 @@ void ConverterCommand::runImpl()
     ctx.onLight = entry_on_light;
     ctx.userdata = this;
 
+    SDL_assert(mWriter);
+    mSceneOptions = options;
     if(mGenerateJson)
-        mGenerator.reset(new JsonGenerator(mGenOptions));
+        mGenerator.reset(new JsonGenerator(options, *mWriter));
     else 
         mGenerator.reset(new NullGenerator());
 
-    if(!lite3d_assimp_mesh_load_recursive(
-        mMain.getResourceManager().loadFileToMemory(mInputFilePath), ctx, loadFlags))
-        LITE3D_THROW("Assimp failed to load file '" << mInputFilePath << "'");
+    if(!lite3d_assimp_scene_load_recursive(scene, ctx))
+        LITE3D_THROW("Assimp failed to load scene of '" << options.objectName << "'");
 }
 #else
 void ConverterCommand::runImpl()
 {
     LITE3D_THROW("If you want to use converter, please, recompile with Assimp support!");
 }
+
+void ConverterCommand::convertScene(const aiScene *scene, const GeneratorOptions &options)
+{
+    LITE3D_THROW("If you want to use converter, please, recompile with Assimp support!");
+}
 #endif
 
 void ConverterCommand::parseCommandLineImpl(int argc, char *args[])
@@ -163,6 +202,20 @@ void ConverterCommand::parseCommandLineImpl(int argc, char *args[])
         {
             mFlipUV = true;
         }
+        else if (strcmp(args[i], "-cl") == 0)
+        {
+            mBuildClusters = true;
+        }
+        else if (strcmp(args[i], "-lod") == 0)
+        {
+            if ((i + 1) < argc && args[i + 1][0] != '-')
+                mLodLevels = static_cast<uint32_t>(std::max(atoi(args[i + 1]), 0));
+            else
+                LITE3D_THROW("Missing levels of detail count");
+
+            if (mLodLevels == 0 || mLodLevels > LITE3D_LOD_MAX_LEVELS)
+                LITE3D_THROW("Levels of detail count must be from 1 to " << LITE3D_LOD_MAX_LEVELS);
+        }
         else if (strcmp(args[i], "-j") == 0)
         {
             mGenerateJson = true;
@@ -220,32 +273,70 @@ void ConverterCommand::parseCommandLineImpl(int argc, char *args[])
     }
 }
 
-void ConverterCommand::convertMesh(lite3d_mesh *mesh, const lite3dpp::String &savePath)
+lite3dpp::String ConverterCommand::convertMesh(lite3d_mesh *mesh, const lite3dpp::String &relativePath)
 {
-    if(!mesh)
-        return;
-
+    lite3dpp::String savedPath = relativePath;
     size_t encodeBufferSize = lite3d_mesh_m_encode_size(mesh);
     void *encodeBuffer = lite3d_malloc(encodeBufferSize);
+    void *processedBuffer = NULL;
+    size_t processedBufferSize = 0;
     if (!lite3d_mesh_m_encode(mesh, encodeBuffer, encodeBufferSize))
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: encode failed..",
             LITE3D_CURRENT_FUNCTION);
+        lite3d_free(encodeBuffer);
+        return savedPath;
+    }
+
+    // Каждый шаг берет результат предыдущего, при ошибке шаг пропускается
+    if (mBuildClusters)
+    {
+        if (!lite3d_mesh_m_build_clusters(encodeBuffer, encodeBufferSize, LITE3D_CLUSTER_MAX_VERTICES,
+            LITE3D_CLUSTER_MAX_TRIANGLES, &processedBuffer, &processedBufferSize))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: cluster build failed, '%s' is saved without clusters..",
+                LITE3D_CURRENT_FUNCTION, relativePath.c_str());
+        }
+        else
+        {
+            lite3d_free(encodeBuffer);
+            encodeBuffer = processedBuffer;
+            encodeBufferSize = processedBufferSize;
+        }
     }
-    else
+
+    if (mLodLevels > 0)
     {
-        Utils::saveFile(encodeBuffer, encodeBufferSize, savePath);
+        if (!lite3d_mesh_m_build_lods(encodeBuffer, encodeBufferSize, mLodLevels, LITE3D_LOD_DEFAULT_REDUCTION,
+            LITE3D_LOD_DEFAULT_MAX_ERROR, &processedBuffer, &processedBufferSize))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: LOD build failed, '%s' is saved without levels of detail..",
+                LITE3D_CURRENT_FUNCTION, relativePath.c_str());
+        }
+        else
+        {
+            lite3d_free(encodeBuffer);
+            encodeBuffer = processedBuffer;
+            encodeBufferSize = processedBufferSize;
+        }
     }
 
+    savedPath = mWriter->save(encodeBuffer, encodeBufferSize, relativePath, true);
     lite3d_free(encodeBuffer);
-    lite3d_mesh_purge(mesh);
+    return savedPath;
 }
 
 void ConverterCommand::processMesh(lite3d_mesh *mesh, const kmMat4 *transform, const lite3dpp::String &name)
 {
-    lite3dpp::String relativeMeshPath = Utils::makeRelativePath("models/meshes/", Utils::extractMeshName(name), "m");
-    lite3dpp::String fullMeshPath = Utils::makeFullPath(mGenOptions.outputFolder, relativeMeshPath);
-    
-    mGenerator->generateNode(mesh, name, transform, mesh != NULL);
-    convertMesh(mesh, fullMeshPath);
+    lite3dpp::String relativeMeshPath = Utils::makeRelativePath("models/meshes/", 
+        mSceneOptions.scoped(Utils::extractMeshName(name)), "m");
+
+    /* сначала кодируем: одинаковые меши ссылаются на первый сохраненный файл */
+    if (mesh)
+        relativeMeshPath = convertMesh(mesh, relativeMeshPath);
+
+    mGenerator->generateNode(mesh, name, transform, mesh != NULL, relativeMeshPath);
+
+    if (mesh)
+        lite3d_mesh_purge(mesh);
 }
\ No newline at end of file
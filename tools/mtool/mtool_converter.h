@@ -20,6 +20,8 @@
 #include <mtool/mtool_command.h>
 #include <mtool/mtool_generator.h>
 
+struct aiScene;
+
 class ConverterCommand : public Command
 {
 public:
@@ -31,6 +33,11 @@ protected:
     virtual void runImpl() override;
     virtual void parseCommandLineImpl(int argc, char *args[]) override;
 
+    uint32_t loadFlags() const;
+    /* Builds meshes from imported scene and saves them with generated json, 
+       GL buffers are used, so main thread only */
+    void convertScene(const aiScene *scene, const GeneratorOptions &options);
+
 private:
 
     static void entry_on_mesh(lite3d_mesh *mesh, const kmMat4 *transform, const char *name, void *userdata);
@@ -55,15 +62,24 @@ private:
         void *userdata);
 
     void processMesh(lite3d_mesh *mesh, const kmMat4 *transform, const lite3dpp::String &name);
-    void convertMesh(lite3d_mesh *mesh, const lite3dpp::String &savePath);
+    /* returns path of saved mesh, identical meshes are saved once */
+    lite3dpp::String convertMesh(lite3d_mesh *mesh, const lite3dpp::String &relativePath);
 
-private:
+protected:
 
     lite3dpp::String mInputFilePath;
     bool mOptimizeMesh;
     bool mFlipUV;
     bool mGenerateJson;
+    bool mBuildClusters;
+    uint32_t mLodLevels;
+    GeneratorOptions mGenOptions;
+    std::unique_ptr<OutputWriter> mWriter;
+
+private:
+
     lite3d_mesh mMesh;
     std::unique_ptr<Generator> mGenerator;
-    GeneratorOptions mGenOptions;
-};
+    /* опции текущей сцены */
+    GeneratorOptions mSceneOptions;
+};
\ No newline at end of file
@@ -28,6 +28,11 @@ GeneratorOptions::GeneratorOptions() :
     nodeUniqName(false)
 {}
 
+lite3dpp::String GeneratorOptions::scoped(const lite3dpp::String &name) const
+{
+    return scope.empty() ? name : scope + "_" + name;
+}
+
 Generator::Generator(const GeneratorOptions &options) :
     mOptions(options)
 {
@@ -54,7 +59,7 @@ NullGenerator::NullGenerator() :
 {}
 
 void NullGenerator::generateNode(const lite3d_mesh *mesh, const lite3dpp::String &name, const kmMat4 *transform,
-    bool meshExist)
+    bool meshExist, const lite3dpp::String &relativeMeshPath)
 {}
 
 void NullGenerator::pushNodeTree()
@@ -80,17 +85,17 @@ void NullGenerator::generateLight(const lite3dpp::String &lightName,
     const lite3d_light_params *params)
 {}
 
-JsonGenerator::JsonGenerator(const GeneratorOptions &options) :
+JsonGenerator::JsonGenerator(const GeneratorOptions &options, OutputWriter &writer) :
     Generator(options),
-    mNodeCounter(0)
+    mNodeCounter(0),
+    mWriter(writer)
 {}
 
 void JsonGenerator::generateNode(const lite3d_mesh *mesh, const lite3dpp::String &name, const kmMat4 *transform,
-    bool meshExist)
+    bool meshExist, const lite3dpp::String &relativeMeshPath)
 {
-    lite3dpp::String relativeMeshPath = Utils::makeRelativePath("models/meshes/", Utils::extractMeshName(name), "m");
-    lite3dpp::String relativeMeshConfigPath = Utils::makeRelativePath("models/json/", Utils::extractMeshName(name), "json");
-    lite3dpp::String fullMeshConfigPath = Utils::makeFullPath(mOptions.outputFolder, relativeMeshConfigPath);
+    lite3dpp::String meshName = mOptions.scoped(Utils::extractMeshName(name));
+    lite3dpp::String relativeMeshConfigPath = Utils::makeRelativePath("models/json/", meshName, "json");
 
     lite3dpp::ConfigurationWriter nodeConfig;
     nodeConfig.set(L"Name", name + (meshExist && mOptions.nodeUniqName ? std::to_string(++mNodeCounter) : "") + ".node");
@@ -124,11 +129,11 @@ void JsonGenerator::generateNode(const lite3d_mesh *mesh, const lite3dpp::String
         meshConfig.set(L"MaterialMapping", matMapping);
 
         lite3dpp::ConfigurationWriter nodeMeshConfig;
-        nodeMeshConfig.set(L"Name", Utils::extractMeshName(name) + ".mesh");
+        nodeMeshConfig.set(L"Name", meshName + ".mesh");
         nodeMeshConfig.set(L"Mesh", mOptions.meshPackname + relativeMeshConfigPath);
         nodeConfig.set(L"Mesh", nodeMeshConfig);
 
-        Utils::saveTextFile(meshConfig.write(), fullMeshConfigPath);
+        mWriter.saveText(meshConfig.write(), relativeMeshConfigPath);
     }
 
     generatePositionRotation(nodeConfig, transform);
@@ -178,8 +183,7 @@ void JsonGenerator::popNodeTree()
             lite3dpp::ConfigurationWriter objectConfig;
             objectConfig.set(L"Root", rootObject);
 
-            Utils::saveTextFile(objectConfig.write(),
-                Utils::makeFullPath(mOptions.outputFolder, Utils::makeRelativePath("objects/", mOptions.objectName, "json")));
+            mWriter.saveText(objectConfig.write(), Utils::makeRelativePath("objects/", mOptions.objectName, "json"));
         }
     }
 }
@@ -251,12 +255,13 @@ void JsonGenerator::generateMaterial(const lite3dpp::String &name,
         matName = Utils::getFileNameWithoutExt(diffuseTextureFile);
     }
 
-    lite3dpp::String matFull = Utils::makeFullPath(mOptions.outputFolder, Utils::makeRelativePath("materials/", matName, "json"));
+    matName = mOptions.scoped(matName);
+
     lite3dpp::ConfigurationWriter material;
 
     material.set(L"Uniforms", uniforms);
     material.set(L"Passes", passes);
-    Utils::saveTextFile(material.write(), matFull);
+    mWriter.saveText(material.write(), Utils::makeRelativePath("materials/", matName, "json"));
 
     mMaterials.emplace(matIdx, matName);
 }
@@ -267,12 +272,12 @@ void JsonGenerator::generateUniformSampler(lite3dpp::stl<lite3dpp::Configuration
         return;
 
     lite3dpp::ConfigurationWriter param;
-    lite3dpp::String texRel = Utils::makeRelativePath("textures/json/", Utils::getFileNameWithoutExt(fileName), "json");
-    lite3dpp::String texFull = Utils::makeFullPath(mOptions.outputFolder, texRel);
+    lite3dpp::String texName = mOptions.scoped(Utils::getFileNameWithoutExt(fileName));
+    lite3dpp::String texRel = Utils::makeRelativePath("textures/json/", texName, "json");
     
     param.set(L"Name", "diffuseSampler");
     param.set(L"Type", "sampler");
-    param.set(L"TextureName", Utils::getFileNameWithoutExt(fileName) + ".texture");
+    param.set(L"TextureName", texName + ".texture");
     param.set(L"TexturePath", mOptions.texPackname + texRel);
     uniforms.push_back(param);
     
@@ -284,7 +289,7 @@ void JsonGenerator::generateUniformSampler(lite3dpp::stl<lite3dpp::Configuration
         texture.set(L"Image", mOptions.imgPackname + Utils::makeRelativePath("textures/images/", Utils::getFileNameWithoutExt(fileName), Utils::getFileExt(fileName)));
         texture.set(L"ImageFormat", Utils::getFileExt(fileName));
     
-        Utils::saveTextFile(texture.write(), texFull);
+        mWriter.saveText(texture.write(), texRel);
     }
 }
 
@@ -19,15 +19,21 @@
 
 #include <mtool/mtool_command.h>
 #include <lite3dpp/lite3dpp_config_writer.h>
+#include <mtool/mtool_output_writer.h>
 
 class GeneratorOptions
 {
 public:
     
     GeneratorOptions();
+
+    /* имя меша, материала или текстуры с префиксом scope */
+    lite3dpp::String scoped(const lite3dpp::String &name) const;
     
     lite3dpp::String outputFolder;
     lite3dpp::String objectName;
+    /* в пакетном режиме у каждого входа свой префикс, одноименные ресурсы разных файлов не перезаписывают друг друга */
+    lite3dpp::String scope;
     lite3dpp::String texPackname;
     lite3dpp::String imgPackname;
     lite3dpp::String matPackname;
@@ -47,8 +53,9 @@ public:
     Generator(const GeneratorOptions &options);
     virtual ~Generator() = default;
 
+    /* relativeMeshPath - where converted mesh is saved */
     virtual void generateNode(const lite3d_mesh *mesh, const lite3dpp::String &name, const kmMat4 *transform,
-        bool meshExist) = 0;
+        bool meshExist, const lite3dpp::String &relativeMeshPath) = 0;
     /* make child node and go to it */
     virtual void pushNodeTree() = 0;
     /* go to parent node */
@@ -81,7 +88,7 @@ public:
     NullGenerator();
 
     virtual void generateNode(const lite3d_mesh *mesh, const lite3dpp::String &name, const kmMat4 *transform,
-        bool meshExist) override;
+        bool meshExist, const lite3dpp::String &relativeMeshPath) override;
     /* make child node and go to it */
     virtual void pushNodeTree() override;
     /* go to parent node */
@@ -107,10 +114,10 @@ class JsonGenerator : public Generator
 {
 public:
 
-    JsonGenerator(const GeneratorOptions &options);
+    JsonGenerator(const GeneratorOptions &options, OutputWriter &writer);
 
     virtual void generateNode(const lite3d_mesh *mesh, const lite3dpp::String &name, const kmMat4 *transform,
-        bool meshExist) override;
+        bool meshExist, const lite3dpp::String &relativeMeshPath) override;
     /* make child node and go to it */
     virtual void pushNodeTree() override;
     /* go to parent node */
@@ -141,4 +148,5 @@ private:
     lite3dpp::stl<lite3dpp::stl<lite3dpp::ConfigurationWriter>::vector>::stack mNodesStack;
     lite3dpp::stl<uint32_t, lite3dpp::String>::map mMaterials;
     int mNodeCounter;
+    OutputWriter &mWriter;
 };
\ No newline at end of file
@@ -97,7 +97,15 @@ void MeshInfoCommand::printInfo(const lite3d_file *meshFile)
         printf("\tElements count: %d\n", meshChunk->vao.indexesCount / 3);
         printf("\tVertices offset: 0x%zx\n", meshChunk->vao.verticesOffset);
         printf("\tIndices offset: 0x%zx\n", meshChunk->vao.indexesOffset);
-        printf("\tIndex size: 4 bytes\n\n");
+        printf("\tIndex size: 4 bytes\n");
+        printf("\tClusters count: %u\n", meshChunk->clustersCount);
+        printf("\tLOD count: %u\n", meshChunk->lodsCount);
+        for (i = 0; i < meshChunk->lodsCount; ++i)
+        {
+            printf("\t\tLOD %u: %u elements, error %f\n", i + 1, meshChunk->lods[i].indexesCount / 3,
+                meshChunk->lods[i].error);
+        }
+        printf("\n");
 
         printf("\tFORMAT\n");
         printf("\tLoc\tType\t\tData\tOffset\n");
@@ -20,6 +20,7 @@
 
 #include <lite3d/lite3d_main.h>
 #include <mtool/mtool_converter.h>
+#include <mtool/mtool_batch_converter.h>
 #include <mtool/mtool_m_info.h>
 #include <mtool/mtool_create_dirs.h>
 
@@ -27,7 +28,8 @@ static void print_help_and_exit()
 {
     printf("Usage: \n");
     printf("\n\t-p\tview m file content \n\t-i\tinput file \n");
-    printf("\n\t-c\tconvert file \n\t-i\tinput file \n\t-o\toutput folder \n\t-O\toptimize mesh \n\t-F\tflip UVs \n\t-j\tgenerate json \n\t-oname\tobject name \n\t-[img|mesh|tex|mat|node]pkg \n\t-matastex \n");
+    printf("\n\t-c\tconvert file \n\t-i\tinput file \n\t-o\toutput folder \n\t-O\toptimize mesh \n\t-F\tflip UVs \n\t-cl\tsplit meshes to clusters for cluster culling \n\t-lod N\tgenerate N levels of detail \n\t-j\tgenerate json \n\t-oname\tobject name \n\t-[img|mesh|tex|mat|node]pkg \n\t-matastex \n");
+    printf("\n\t-b\tconvert all models of folder or list file (one path per line) \n\t-i\tinput folder or list \n\t-o\toutput folder \n\t-t\tthreads, 0 - all cores \n\t-inc\tskip models not changed since previous run \n\t\tand options of -c \n");
     printf("\n\t-d\tcreate directories \n\t-o\toutput folder\n\n");
     exit(1);
 }
@@ -56,6 +58,11 @@ int main(int argc, char *args[])
             command.reset(new ConverterCommand());
             break;
         }
+        else if (strcmp(args[i], "-b") == 0)
+        {
+            command.reset(new BatchConverterCommand());
+            break;
+        }
         else if (strcmp(args[i], "-d") == 0)
         {
             command.reset(new CreateDirsCommand());
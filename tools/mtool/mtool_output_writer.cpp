@@ -0,0 +1,203 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <SDL_log.h>
+
+#include <mtool/mtool_output_writer.h>
+#include <mtool/mtool_utils.h>
+
+OutputWriter::OutputWriter(const lite3dpp::String &outputFolder, WorkerPool *pool) : 
+    mOutputFolder(outputFolder),
+    mPool(pool)
+{}
+
+OutputWriter::~OutputWriter()
+{
+    /* задачи ссылаются на this, дожидаемся их даже при ошибке */
+    for (auto &pending : mPending)
+        pending.second.wait();
+    for (auto &done : mDone)
+        done.wait();
+}
+
+lite3dpp::String OutputWriter::save(const void *buffer, size_t size, const lite3dpp::String &relativePath, 
+    bool deduplicate)
+{
+    /* размер в хэше, чтобы разные по длине файлы точно различались */
+    uint64_t hash = Utils::contentHash(&size, sizeof(size), Utils::contentHash(buffer, size));
+
+    if (deduplicate)
+    {
+        auto content = mContent.find(hash);
+        if (content != mContent.end() && content->second != relativePath)
+        {
+            mDeduplicated++;
+            mSavedSinceTake.push_back({ content->second, hash });
+            return content->second;
+        }
+    }
+
+    auto saved = mSaved.find(relativePath);
+    if (saved != mSaved.end())
+    {
+        if (saved->second == hash)
+        {
+            mDeduplicated++;
+            mSavedSinceTake.push_back({ relativePath, hash });
+            return relativePath;
+        }
+
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s: overwritten with different content", relativePath.c_str());
+        auto content = mContent.find(saved->second);
+        if (content != mContent.end() && content->second == relativePath)
+            mContent.erase(content);
+    }
+
+    /* kept file gets new content, old content is not there anymore */
+    auto kept = mKept.find(relativePath);
+    if (kept != mKept.end())
+    {
+        auto content = mContent.find(kept->second);
+        if (kept->second != hash && content != mContent.end() && content->second == relativePath)
+            mContent.erase(content);
+        mKept.erase(kept);
+    }
+
+    mSaved[relativePath] = hash;
+    if (deduplicate)
+        mContent.emplace(hash, relativePath);
+    mSavedSinceTake.push_back({ relativePath, hash });
+
+    auto content = std::make_shared<lite3dpp::stl<uint8_t>::vector>(static_cast<const uint8_t *>(buffer), 
+        static_cast<const uint8_t *>(buffer) + size);
+    lite3dpp::String fullPath = Utils::makeFullPath(mOutputFolder, relativePath);
+    if (!mPool)
+    {
+        write(content, hash, fullPath);
+        return relativePath;
+    }
+
+    /* два задания в один файл не должны писать одновременно */
+    waitPending(relativePath);
+    mPending.emplace(relativePath, mPool->submit([this, content, hash, fullPath]()
+    {
+        write(content, hash, fullPath);
+    }));
+
+    return relativePath;
+}
+
+lite3dpp::String OutputWriter::saveText(const lite3dpp::String &text, const lite3dpp::String &relativePath)
+{
+    return save(text.data(), text.size(), relativePath);
+}
+
+void OutputWriter::write(const std::shared_ptr<lite3dpp::stl<uint8_t>::vector> &content, uint64_t hash, 
+    const lite3dpp::String &fullPath)
+{
+    if (mSkipUnchanged)
+    {
+        lite3dpp::stl<uint8_t>::vector existing;
+        if (Utils::loadFile(fullPath, existing) && existing.size() == content->size())
+        {
+            size_t size = existing.size();
+            if (Utils::contentHash(&size, sizeof(size), Utils::contentHash(existing.data(), size)) == hash)
+            {
+                mUnchanged++;
+                return;
+            }
+        }
+    }
+
+    Utils::saveFile(content->data(), content->size(), fullPath);
+    mWritten++;
+    mBytesWritten += content->size();
+}
+
+void OutputWriter::waitPending(const lite3dpp::String &relativePath)
+{
+    auto pending = mPending.find(relativePath);
+    if (pending != mPending.end())
+    {
+        pending->second.wait();
+        mDone.emplace_back(std::move(pending->second));
+        mPending.erase(pending);
+    }
+}
+
+void OutputWriter::addExisting(const Entry &entry)
+{
+    auto saved = mSaved.find(entry.path);
+    if (saved != mSaved.end())
+    {
+        /* already saved in this run, with other content it is not a target anymore */
+        if (saved->second == entry.hash)
+            mContent.emplace(entry.hash, entry.path);
+        return;
+    }
+
+    mKept.emplace(entry.path, entry.hash);
+    mContent.emplace(entry.hash, entry.path);
+}
+
+bool OutputWriter::replaced(const Entry &entry) const
+{
+    auto saved = mSaved.find(entry.path);
+    return saved != mSaved.end() && saved->second != entry.hash;
+}
+
+lite3dpp::stl<OutputWriter::Entry>::vector OutputWriter::takeSaved()
+{
+    lite3dpp::stl<Entry>::vector saved;
+    saved.swap(mSavedSinceTake);
+    return saved;
+}
+
+void OutputWriter::flush()
+{
+    for (auto &pending : mPending)
+        mDone.emplace_back(std::move(pending.second));
+    mPending.clear();
+
+    std::exception_ptr failure;
+    for (auto &done : mDone)
+    {
+        try
+        {
+            done.get();
+        }
+        catch (...)
+        {
+            if (!failure)
+                failure = std::current_exception();
+        }
+    }
+
+    mDone.clear();
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+OutputWriter::Stats OutputWriter::getStats() const
+{
+    Stats stats;
+    stats.written = mWritten;
+    stats.unchanged = mUnchanged;
+    stats.deduplicated = mDeduplicated;
+    stats.bytesWritten = mBytesWritten;
+    return stats;
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <atomic>
+
+#include <mtool/mtool_worker_pool.h>
+
+/* All converter outputs go through here. Paths are relative to output folder. 
+   Files are replaced atomically, identical content can be stored once. 
+   Called from main thread only, writing itself goes to pool when it is set. */
+class OutputWriter
+{
+public:
+
+    struct Entry
+    {
+        lite3dpp::String path;
+        uint64_t hash;
+    };
+
+    struct Stats
+    {
+        uint32_t written = 0;
+        /* file on disk already had the same content */
+        uint32_t unchanged = 0;
+        /* content saved earlier in this run */
+        uint32_t deduplicated = 0;
+        uint64_t bytesWritten = 0;
+    };
+
+    /* pool == nullptr - files are written synchronously */
+    OutputWriter(const lite3dpp::String &outputFolder, WorkerPool *pool = nullptr);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter &) = delete;
+    OutputWriter &operator=(const OutputWriter &) = delete;
+
+    /* With deduplicate, content saved earlier under another path is not written again, 
+       returned path is where content lives */
+    lite3dpp::String save(const void *buffer, size_t size, const lite3dpp::String &relativePath, 
+        bool deduplicate = false);
+    lite3dpp::String saveText(const lite3dpp::String &text, const lite3dpp::String &relativePath);
+
+    /* Compare with file on disk before writing, unchanged files keep their time stamps */
+    inline void skipUnchanged(bool flag)
+    { mSkipUnchanged = flag; }
+    /* File kept from previous run, target for deduplication until it is saved with other content */
+    void addExisting(const Entry &entry);
+    /* File was saved in this run with content other than entry hash */
+    bool replaced(const Entry &entry) const;
+    /* Outputs saved (or referenced by deduplication) since previous call */
+    lite3dpp::stl<Entry>::vector takeSaved();
+    /* Waits pending writes, rethrows the first failure */
+    void flush();
+
+    Stats getStats() const;
+    inline const lite3dpp::String &getOutputFolder() const
+    { return mOutputFolder; }
+
+private:
+
+    void write(const std::shared_ptr<lite3dpp::stl<uint8_t>::vector> &content, uint64_t hash, 
+        const lite3dpp::String &fullPath);
+    void waitPending(const lite3dpp::String &relativePath);
+
+    lite3dpp::String mOutputFolder;
+    WorkerPool *mPool;
+    bool mSkipUnchanged = false;
+    /* path -> hash of content saved in this run */
+    lite3dpp::stl<lite3dpp::String, uint64_t>::unordered_map mSaved;
+    /* path -> hash of file kept from previous run */
+    lite3dpp::stl<lite3dpp::String, uint64_t>::unordered_map mKept;
+    /* hash -> first path holding it */
+    lite3dpp::stl<uint64_t, lite3dpp::String>::unordered_map mContent;
+    lite3dpp::stl<Entry>::vector mSavedSinceTake;
+    lite3dpp::stl<lite3dpp::String, std::future<void>>::unordered_map mPending;
+    lite3dpp::stl<std::future<void>>::vector mDone;
+    std::atomic<uint32_t> mWritten = 0;
+    std::atomic<uint32_t> mUnchanged = 0;
+    std::atomic<uint64_t> mBytesWritten = 0;
+    uint32_t mDeduplicated = 0;
+};
@@ -18,6 +18,9 @@
 #define MAKE_PATH(folder, name) (folder + "/" + name).c_str()
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 
 #ifdef _MSC_VER
 #   include <Windows.h>
@@ -39,26 +42,79 @@ int Utils::mNonameCounter = 0;
 
 void Utils::saveFile(const void *buffer, size_t size, const lite3dpp::String &path)
 {
-    SDL_RWops *descr;
-    printf("Writing %s ... ", path.c_str());
-    fflush(stdout);
-
-    descr = SDL_RWFromFile(path.c_str(), "wb");
+    /* пишем во временный файл и переименовываем, прерванная конвертация не оставит половину файла */
+    lite3dpp::String tmpPath = path + ".tmp";
+    SDL_RWops *descr = SDL_RWFromFile(tmpPath.c_str(), "wb");
     if (!descr)
         LITE3D_THROW("Unable to open file " << path);
 
-    if (SDL_RWwrite(descr, buffer, size, 1) != 1)
+    if (size > 0 && SDL_RWwrite(descr, buffer, size, 1) != 1)
     {
         SDL_RWclose(descr);
+        std::remove(tmpPath.c_str());
         LITE3D_THROW("IO error.. " << path);
     }
 
     SDL_RWclose(descr);
 
-    printf("done\n");
+    std::error_code error;
+    std::filesystem::rename(std::filesystem::path(tmpPath.c_str()), std::filesystem::path(path.c_str()), error);
+    if (error)
+    {
+        std::remove(tmpPath.c_str());
+        LITE3D_THROW("Unable to replace file " << path << ": " << error.message());
+    }
+
+    /* одной строкой, файлы пишутся и из рабочих потоков */
+    printf("Writing %s ... done\n", path.c_str());
     fflush(stdout);
 }
 
+bool Utils::loadFile(const lite3dpp::String &path, lite3dpp::stl<uint8_t>::vector &buffer)
+{
+    SDL_RWops *descr = SDL_RWFromFile(path.c_str(), "rb");
+    if (!descr)
+        return false;
+
+    Sint64 size = SDL_RWsize(descr);
+    buffer.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    bool result = size >= 0 && (size == 0 || SDL_RWread(descr, buffer.data(), buffer.size(), 1) == 1);
+    SDL_RWclose(descr);
+
+    return result;
+}
+
+bool Utils::fileExists(const lite3dpp::String &path)
+{
+    std::error_code error;
+    return std::filesystem::is_regular_file(std::filesystem::path(path.c_str()), error);
+}
+
+uint64_t Utils::contentHash(const void *buffer, size_t size, uint64_t hash)
+{
+    /* FNV-1a */
+    const uint8_t *bytes = static_cast<const uint8_t *>(buffer);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+lite3dpp::String Utils::hashToString(uint64_t hash)
+{
+    char str[17] = {0};
+    snprintf(str, sizeof(str), "%016llx", static_cast<unsigned long long>(hash));
+    return str;
+}
+
+uint64_t Utils::hashFromString(const lite3dpp::String &str)
+{
+    return std::strtoull(str.c_str(), nullptr, 16);
+}
+
 void Utils::saveTextFile(const lite3dpp::String &text, const lite3dpp::String &path)
 {
     saveFile(text.data(), text.size(), path);
@@ -27,12 +27,19 @@ public:
     static lite3dpp::String makeFullPath(const lite3dpp::String &outputFolder, const lite3dpp::String &relative);
     static lite3dpp::String makeRelativePath(const lite3dpp::String &inpath, 
         const lite3dpp::String &name, const lite3dpp::String &ext);
+    /* atomic: written to temporary file, then renamed to path */
     static void saveFile(const void *buffer, size_t size, const lite3dpp::String &path);
+    static bool loadFile(const lite3dpp::String &path, lite3dpp::stl<uint8_t>::vector &buffer);
+    static bool fileExists(const lite3dpp::String &path);
     static void saveTextFile(const lite3dpp::String &text, const lite3dpp::String &path);
     static void makeFolder(const lite3dpp::String &outputFolder, const lite3dpp::String &name);
     static lite3dpp::String getFileExt(const lite3dpp::String &filePath);
     static lite3dpp::String getFileNameWithoutExt(const lite3dpp::String &filePath);
     static lite3dpp::String extractMeshName(const lite3dpp::String &nodeName);
+    /* FNV-1a, stable between runs, used for deduplication and incremental conversion */
+    static uint64_t contentHash(const void *buffer, size_t size, uint64_t hash = 0xcbf29ce484222325ull);
+    static lite3dpp::String hashToString(uint64_t hash);
+    static uint64_t hashFromString(const lite3dpp::String &str);
 private:
     static int mNonameCounter;
 };
\ No newline at end of file
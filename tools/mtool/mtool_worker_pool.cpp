@@ -0,0 +1,77 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include <algorithm>
+
+#include <mtool/mtool_worker_pool.h>
+
+WorkerPool::WorkerPool(uint32_t threads)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    mThreads.reserve(threads);
+    for (uint32_t i = 0; i < threads; ++i)
+        mThreads.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mStop = true;
+    }
+
+    mWakeup.notify_all();
+    for (auto &thread : mThreads)
+        thread.join();
+}
+
+std::future<void> WorkerPool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> result = packaged.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mTasks.emplace_back(std::move(packaged));
+    }
+
+    mWakeup.notify_one();
+    return result;
+}
+
+void WorkerPool::workerLoop()
+{
+    for (;;)
+    {
+        std::packaged_task<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mLock);
+            mWakeup.wait(lock, [this] { return mStop || !mTasks.empty(); });
+            /* оставшиеся задачи доделываются, их результатов может ждать главный поток */
+            if (mTasks.empty())
+                return;
+
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+ *	This file is part of lite3d (Light-weight 3d engine).
+ *	Copyright (C) 2025 Sirius (Korolev Nikita)
+ *
+ *	Lite3D is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	Lite3D is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with Lite3D.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <lite3dpp/lite3dpp_main.h>
+
+/* Fixed set of threads executing tasks in submit order. 
+   Tasks must not touch GL, the context belongs to main thread. */
+class WorkerPool
+{
+public:
+
+    /* 0 - one thread per hardware core */
+    explicit WorkerPool(uint32_t threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /* exception thrown by task is rethrown from future::get */
+    std::future<void> submit(std::function<void()> task);
+
+    inline uint32_t threadsCount() const
+    { return static_cast<uint32_t>(mThreads.size()); }
+
+private:
+
+    void workerLoop();
+
+    lite3dpp::stl<std::thread>::vector mThreads;
+    std::deque<std::packaged_task<void()>> mTasks;
+    std::mutex mLock;
+    std::condition_variable mWakeup;
+    bool mStop = false;
+};